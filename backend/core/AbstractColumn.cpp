@@ -0,0 +1,62 @@
+/***************************************************************************
+    File                 : AbstractColumn.cpp
+    Project              : SciDAVis
+    Description          : Interface definition for data with column logic
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "core/AbstractColumn.h"
+#include <string.h>
+
+void AbstractColumn::valuesAt(int first, int count, double * buffer) const
+{
+	const double * raw = rawValues();
+	if (raw && first >= 0 && first + count <= rowCount())
+	{
+		memmove(buffer, raw + first, count * sizeof(double));
+		return;
+	}
+	for(int i=0; i<count; i++)
+		buffer[i] = valueAt(first + i);
+}
+
+ValueSpan AbstractColumn::valueSpan(Interval<int> rows) const
+{
+	int first = qMax(rows.start(), 0);
+	int last = qMin(rows.end(), rowCount()-1);
+	if (first > last) return ValueSpan();
+
+	ValueSpan result;
+	const double * raw = rawValues();
+	if (raw)
+		result = ValueSpan(first, last-first+1, raw + first);
+	else
+	{
+		QVector<double> values(last-first+1);
+		valuesAt(first, values.size(), values.data());
+		result = ValueSpan(first, values);
+	}
+	result.setInvalid(invalidIntervals());
+	return result;
+}
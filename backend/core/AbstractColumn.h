@@ -36,6 +36,7 @@
 #include <QDate>
 #include <QTime>
 #include "lib/Interval.h"
+#include "lib/ValueSpan.h"
 #include "core/globals.h"
 #include "core/AbstractAspect.h"
 
@@ -275,6 +276,35 @@ class AbstractColumn : public AbstractAspect
 		virtual void replaceValues(int first, const QVector<double>& new_values) { Q_UNUSED(first) Q_UNUSED(new_values) };
 		//@}
 
+		//! \name bulk access functions
+		//@{
+		//! Return a pointer to the contiguous double storage of the column
+		/**
+		 * Columns which keep all their values in one contiguous block return a pointer
+		 * to the value of row 0, all others return 0. The pointer is only valid until
+		 * the column is changed the next time. Most code should use valueSpan() instead.
+		 * Use this only when dataType() is double
+		 */
+		virtual const double * rawValues() const { return 0; }
+		//! Copy the values of rows first..first+count-1 into 'buffer'
+		/**
+		 * 'buffer' must have room for 'count' doubles. The default implementation
+		 * copies from rawValues() if available and calls valueAt() for each row otherwise.
+		 * Use this only when dataType() is double
+		 */
+		virtual void valuesAt(int first, int count, double * buffer) const;
+		//! Return a read-only view of the values and validity of a range of rows
+		/**
+		 * The range is clipped to the rows actually containing data. If rawValues() is available,
+		 * the span references the column storage directly, otherwise valuesAt() is used to
+		 * materialize the requested rows.
+		 * Use this only when dataType() is double
+		 */
+		ValueSpan valueSpan(Interval<int> rows) const;
+		//! Overloaded function for convenience: return a view of all rows
+		ValueSpan valueSpan() const { return valueSpan(Interval<int>(0, rowCount()-1)); }
+		//@}
+
 	signals: 
 		//! Column plot designation will be changed
 		/**
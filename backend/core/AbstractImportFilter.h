@@ -72,12 +72,17 @@ class QIODevice;
  * this method is then used by ImportDialog instead of the auto-generated GUI. The filter still has
  * to inherit from QObject and use the Q_OBJECT macro, since otherwise there's no way of testing for
  * the presence of this method.
+ *
+ * Filters that may take a while can report their progress via progress() and should check
+ * wasCanceled() every now and then; if it returns true, importAspect() is expected to clean up
+ * and return 0. Both are optional; the kernel connects them to a progress dialog.
  */
 class AbstractImportFilter : public QObject
 {
 	Q_OBJECT
 
 	public:
+		AbstractImportFilter() : m_canceled(false) {}
 		virtual ~AbstractImportFilter() {}
 		//! Import an object from the specified device and convert it to an Aspect.
 		/**
@@ -92,6 +97,23 @@ class AbstractImportFilter : public QObject
 		QString nameAndPatterns() const {
 			return name() + " (*." + fileExtensions().join(" *.") + ")";
 		}
+		//! Whether cancel() was called since the last call to resetCanceled().
+		bool wasCanceled() const { return m_canceled; }
+
+	public slots:
+		//! Ask a running importAspect() to stop as soon as possible.
+		void cancel() { m_canceled = true; }
+
+	signals:
+		//! Emitted by importAspect() while reading; percent ranges from 0 to 100.
+		void progress(int percent);
+
+	protected:
+		//! To be called at the beginning of importAspect().
+		void resetCanceled() { m_canceled = false; }
+
+	private:
+		volatile bool m_canceled;
 };
 
 #endif // ifndef ABSTRACT_IMPORT_FILTER_H
@@ -28,6 +28,7 @@
  ***************************************************************************/
 
 #include "AbstractNonlinearFit.h"
+#include "lib/ParallelFor.h"
 
 #include <gsl/gsl_multifit_nlin.h>
 #include <gsl/gsl_multimin.h>
@@ -70,62 +71,132 @@ void AbstractNonlinearFit::setAlgorithm(Algorithm a)
 	exec(new FitSetAlgorithmCmd(this, a));
 }
 
+//! Runs AbstractNonlinearFit::evaluate() on a range of rows; used with parallelFor()
+class NonlinearFitKernel
+{
+	public:
+		NonlinearFitKernel(const AbstractNonlinearFit * fit, const gsl_vector * params,
+				gsl_vector * out_f, gsl_matrix * out_df)
+			: m_fit(fit), m_params(params), m_out_f(out_f), m_out_df(out_df) {}
+		void operator()(int first, int last) const {
+			m_fit->evaluate(m_params, first, last, m_out_f, m_out_df);
+		}
+
+	private:
+		const AbstractNonlinearFit * m_fit;
+		const gsl_vector * m_params;
+		gsl_vector * m_out_f;
+		gsl_matrix * m_out_df;
+};
+
+void AbstractNonlinearFit::fBatch(const gsl_vector * params, const double * x, double * out, int n) const
+{
+	for (int i=0; i<n; i++)
+		out[i] = f(params, x[i]);
+}
+
+void AbstractNonlinearFit::dfBatch(const gsl_vector * params, const double * x, double * out, int n) const
+{
+	int p = numParameters();
+	for (int i=0; i<n; i++) {
+		gsl_vector_view row_i = gsl_vector_view_array(out + i*p, p);
+		df(params, x[i], &row_i.vector);
+	}
+}
+
+void AbstractNonlinearFit::evaluate(const gsl_vector * params, int first, int last,
+		gsl_vector * out_f, gsl_matrix * out_df) const
+{
+	int n = last - first + 1;
+	if (n <= 0) return;
+	const double * x = m_x.constData() + first;
+	const double * y = m_y.constData() + first;
+	const double * w = m_weights.constData() + first;
+
+	if (out_f) {
+		// compute directly into the output vector if it is contiguous
+		QVector<double> buffer;
+		double * values;
+		if (out_f->stride == 1)
+			values = out_f->data + first;
+		else {
+			buffer.resize(n);
+			values = buffer.data();
+		}
+		fBatch(params, x, values, n);
+		for (int i=0; i<n; i++)
+			values[i] = (values[i] - y[i]) * w[i];
+		if (out_f->stride != 1)
+			for (int i=0; i<n; i++)
+				out_f->data[(first+i)*out_f->stride] = values[i];
+	}
+
+	if (out_df) {
+		int p = numParameters();
+		QVector<double> buffer;
+		double * rows;
+		if ((int)out_df->tda == p)
+			rows = out_df->data + first*p;
+		else {
+			buffer.resize(n*p);
+			rows = buffer.data();
+		}
+		dfBatch(params, x, rows, n);
+		for (int i=0; i<n; i++)
+			for (int j=0; j<p; j++)
+				rows[i*p+j] *= w[i];
+		if ((int)out_df->tda != p)
+			for (int i=0; i<n; i++)
+				for (int j=0; j<p; j++)
+					out_df->data[(first+i)*out_df->tda + j] = rows[i*p+j];
+	}
+}
+
+void AbstractNonlinearFit::evaluateAll(const gsl_vector * params, gsl_vector * out_f, gsl_matrix * out_df) const
+{
+	// below a few thousand points, starting threads costs more than it saves
+	parallelFor(0, m_input_points-1, NonlinearFitKernel(this, params, out_f, out_df), 4096);
+}
+
 int AbstractNonlinearFit::fitFunction(const gsl_vector * params, void * self, gsl_vector * out)
 {
 	AbstractNonlinearFit * me = static_cast<AbstractNonlinearFit*>(self);
-	const AbstractColumn * x = me->m_inputs.value(0);
-	const AbstractColumn * y = me->m_inputs.value(1);
-	if (!x || !y) return GSL_EINVAL;
-	int n = me->m_input_points;
-	for (int i=0; i<n; i++)
-		gsl_vector_set(out, i, (me->f(params, x->valueAt(i)) - y->valueAt(i)) / me->m_y_errors[i]);
+	if (me->m_x.size() < me->m_input_points) return GSL_EINVAL;
+	me->evaluateAll(params, out, 0);
 	return GSL_SUCCESS;
 }
 
 int AbstractNonlinearFit::fitFunctionDf(const gsl_vector * params, void * self, gsl_matrix * out)
 {
 	AbstractNonlinearFit * me = static_cast<AbstractNonlinearFit*>(self);
-	const AbstractColumn * x = me->m_inputs.value(0);
-	const AbstractColumn * y = me->m_inputs.value(1);
-	if (!x || !y) return GSL_EINVAL;
-	int n = me->m_input_points;
-	for (int i=0; i<n; i++) {
-		gsl_vector_view row_i = gsl_matrix_row(out, i);
-		me->df(params, x->valueAt(i), &row_i.vector);
-		gsl_vector_scale(&row_i.vector, 1.0/me->m_y_errors[i]);
-	}
+	if (me->m_x.size() < me->m_input_points) return GSL_EINVAL;
+	me->evaluateAll(params, 0, out);
 	return GSL_SUCCESS;
 }
 
 int AbstractNonlinearFit::fitFunctionFDf(const gsl_vector * params, void * self, gsl_vector * out_f, gsl_matrix * out_df)
 {
 	AbstractNonlinearFit * me = static_cast<AbstractNonlinearFit*>(self);
-	const AbstractColumn * x = me->m_inputs.value(0);
-	const AbstractColumn * y = me->m_inputs.value(1);
-	if (!x || !y) return GSL_EINVAL;
-	int n = me->m_input_points;
-	for (int i=0; i<n; i++) {
-		gsl_vector_set(out_f, i, (me->f(params, x->valueAt(i)) - y->valueAt(i)) / me->m_y_errors[i]);
-		gsl_vector_view row_i = gsl_matrix_row(out_df, i);
-		me->df(params, x->valueAt(i), &row_i.vector);
-		gsl_vector_scale(&row_i.vector, 1.0/me->m_y_errors[i]);
-	}
+	if (me->m_x.size() < me->m_input_points) return GSL_EINVAL;
+	me->evaluateAll(params, out_f, out_df);
 	return GSL_SUCCESS;
 }
 
 double AbstractNonlinearFit::multiminFunction(const gsl_vector * params, void * self)
 {
 	AbstractNonlinearFit * me = static_cast<AbstractNonlinearFit*>(self);
-	const AbstractColumn * x = me->m_inputs.value(0);
-	const AbstractColumn * y = me->m_inputs.value(1);
-	if (!x || !y) return GSL_EINVAL;
+	if (me->m_x.size() < me->m_input_points) return GSL_EINVAL;
 
-	double result = 0;
-	size_t i;
 	int n = me->m_input_points;
+	me->m_residuals.resize(n);
+	gsl_vector_view residuals = gsl_vector_view_array(me->m_residuals.data(), n);
+	me->evaluateAll(params, &residuals.vector, 0);
 
-	for (i=0; i<n; i++)
-		result += pow((me->f(params, x->valueAt(i)) - y->valueAt(i)) / me->m_y_errors[i], 2);
+	// sum up sequentially, so the result doesn't depend on the number of cores
+	double result = 0;
+	const double * r = me->m_residuals.constData();
+	for (int i=0; i<n; i++)
+		result += r[i] * r[i];
 
 	return result;
 }
@@ -134,9 +205,25 @@ void AbstractNonlinearFit::dataChanged(AbstractColumn* s)
 {
 	AbstractFit::dataChanged(s);
 
+	m_x.clear();
+	m_y.clear();
+	m_weights.clear();
+	m_residuals.clear();
+
 	if (numParameters() < 1) return;
 	if (m_input_points < numParameters()) return;
 
+	const AbstractColumn * x = m_inputs.value(0);
+	const AbstractColumn * y = m_inputs.value(1);
+	if (!x || !y) return;
+	m_x.resize(m_input_points);
+	m_y.resize(m_input_points);
+	m_weights.resize(m_input_points);
+	x->valuesAt(0, m_input_points, m_x.data());
+	y->valuesAt(0, m_input_points, m_y.data());
+	for (int i=0; i<m_input_points; i++)
+		m_weights[i] = 1.0/m_y_errors[i];
+
 	if (m_algorithm == NelderMeadSimplex)
 		fitGslMultimin();
 	else
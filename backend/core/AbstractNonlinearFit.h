@@ -32,6 +32,8 @@
 
 #include "AbstractFit.h"
 
+#include <QVector>
+
 class FitSetAlgorithmCmd;
 
 //! Base class for non-linear fitting (using GSL).
@@ -48,14 +50,15 @@ class FitSetAlgorithmCmd;
  * functions. We take a fully object-oriented approach here by setting having this
  * pointer point to an instance of AbstractNonlinearFit.
  *
- * In order to reduce code duplication and make the fitting code easier to understand, some
- * compromises have been made in terms of efficiency. While GSL routines allow a large degree
- * of optimization in the model computations (by reusing partial results), the signature
- * chosen for f() and df() doesn't allow this; and it means we need more functions calls,
- * some of which are virtual. Generally, the approach here is meant to be the most elegant
- * and simple; following the rule that premature optimization is the root of all evil.
- * TODO: run some benchmarks in order to decide whether we need optimizations, and where
- *       they make sense
+ * The solver callbacks never evaluate the model point by point. Whenever the input data
+ * changes, X, Y and the weights (1/error) are copied once into contiguous arrays; the
+ * callbacks then hand whole ranges of x values to fBatch() and dfBatch() and apply the
+ * weights in tight loops, splitting large data sets across all cores (see parallelFor()).
+ * The default implementations of fBatch() and dfBatch() simply call f() and df() for each
+ * point, so implementations only need to reimplement them if the model can be computed
+ * faster for many points at once (e.g. by reusing partial results).
+ * Since the batch methods are called concurrently for disjoint ranges, f(), df(), fBatch()
+ * and dfBatch() must be reentrant.
  */
 class AbstractNonlinearFit : public AbstractFit
 {
@@ -91,6 +94,17 @@ class AbstractNonlinearFit : public AbstractFit
 		virtual double f(const gsl_vector * params, double x) const = 0;
 		//! Given fit parameters, compute derivative of model function with respect to the parameters.
 		virtual void df(const gsl_vector * params, double x, gsl_vector * out) const = 0;
+		//! Compute the model function for the n values in x, storing them in out.
+		/**
+		 * The default implementation calls f() for each value.
+		 */
+		virtual void fBatch(const gsl_vector * params, const double * x, double * out, int n) const;
+		//! Compute the derivatives of the model function for the n values in x.
+		/**
+		 * out is a row-major n x numParameters() array; row i receives df(x[i]).
+		 * The default implementation calls df() for each value.
+		 */
+		virtual void dfBatch(const gsl_vector * params, const double * x, double * out, int n) const;
 
 		//! Fit function for GSL multifit routines.
 		/**
@@ -113,6 +127,14 @@ class AbstractNonlinearFit : public AbstractFit
 	private:
 		void fitGslMultimin();
 		void fitGslMultifit();
+		//! Compute weighted residuals and/or Jacobian for rows first..last
+		/**
+		 * Either of out_f and out_df may be 0. Only the rows first..last of the outputs are
+		 * written, so this may be called concurrently for disjoint ranges.
+		 */
+		void evaluate(const gsl_vector * params, int first, int last, gsl_vector * out_f, gsl_matrix * out_df) const;
+		//! Compute weighted residuals and/or Jacobian for all input points, using all cores
+		void evaluateAll(const gsl_vector * params, gsl_vector * out_f, gsl_matrix * out_df) const;
 
 		//! Fit algorithm to use.
 		Algorithm m_algorithm;
@@ -126,8 +148,18 @@ class AbstractNonlinearFit : public AbstractFit
 		int m_exit_status;
 		//! Number of iterations the last fit took.
 		int m_iterations;
+		//!\name Snapshot of the input data taken by dataChanged()
+		//@{
+		QVector<double> m_x;
+		QVector<double> m_y;
+		//! 1/m_y_errors[i]
+		QVector<double> m_weights;
+		//! Scratch space for the residuals in multiminFunction()
+		QVector<double> m_residuals;
+		//@}
 
 	friend class FitSetAlgorithmCmd;
+	friend class NonlinearFitKernel;
 };
 
 #endif // ifndef ABSTRACT_NONLINEAR_FIT_H
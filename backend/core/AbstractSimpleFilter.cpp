@@ -38,6 +38,12 @@ AbstractSimpleFilter::AbstractSimpleFilter()
 	addChild(m_output_column);
 }
 
+void AbstractSimpleFilter::valuesAt(int first, int count, double * buffer) const
+{
+	for(int i=0; i<count; i++)
+		buffer[i] = valueAt(first + i);
+}
+
 void AbstractSimpleFilter::clearMasks()
 {
 	emit m_output_column->maskingAboutToChange(m_output_column);
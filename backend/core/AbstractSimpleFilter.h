@@ -206,6 +206,18 @@ class AbstractSimpleFilter : public AbstractFilter
 		{
 			return m_inputs.value(0) ? m_inputs.at(0)->valueAt(row) : 0.0;
 		}
+		//! Return a pointer to contiguous double storage, see AbstractColumn::rawValues()
+		/**
+		 * Filters usually compute their values on demand, so the default returns 0.
+		 */
+		virtual const double * rawValues() const { return 0; }
+		//! Copy the values of rows first..first+count-1 into 'buffer'
+		/**
+		 * The default implementation materializes the chunk by calling valueAt() for each row,
+		 * so that filters which only reimplement valueAt() work unchanged. Filters which can
+		 * compute a whole block at once should reimplement this.
+		 */
+		virtual void valuesAt(int first, int count, double * buffer) const;
 
 		//!\name assuming a 1:1 correspondence between input and output rows
 		//@{
@@ -242,7 +254,7 @@ class AbstractSimpleFilter : public AbstractFilter
 		//! Return all intervals of invalid rows
 		virtual QList< Interval<int> > invalidIntervals() const 
 		{
-			return m_inputs.value(0) ? m_inputs.at(0)->maskedIntervals() : QList< Interval<int> >(); 
+			return m_inputs.value(0) ? m_inputs.at(0)->invalidIntervals() : QList< Interval<int> >(); 
 		}
 
 		//! \name XML related functions
@@ -299,6 +311,8 @@ class SimpleFilterColumn : public AbstractColumn
 		virtual QTime timeAt(int row) const { return m_owner->timeAt(row); }
 		virtual QDateTime dateTimeAt(int row) const { return m_owner->dateTimeAt(row); }
 		virtual double valueAt(int row) const { return m_owner->valueAt(row); }
+		virtual const double * rawValues() const { return m_owner->rawValues(); }
+		virtual void valuesAt(int first, int count, double * buffer) const { m_owner->valuesAt(first, count, buffer); }
 
 	private:
 		AbstractSimpleFilter *m_owner;
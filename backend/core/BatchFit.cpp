@@ -0,0 +1,133 @@
+/***************************************************************************
+    File                 : BatchFit.cpp
+    Project              : SciDAVis
+    Description          : Fit one model to many data sets, from several initial guesses
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "BatchFit.h"
+#include "lib/ParallelFor.h"
+
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_math.h>
+
+//! Runs the fits for a range of (data set, start) pairs; used with parallelFor()
+class BatchFitKernel
+{
+	public:
+		BatchFitKernel(const BatchFit *batch, FitSolver::Result *results)
+			: m_batch(batch), m_results(results) {}
+
+		void operator()(int first, int last) const
+		{
+			int p = m_batch->m_solver.numParameters();
+			QVector<double> initial(p);
+			gsl_rng *rng = gsl_rng_alloc(gsl_rng_mt19937);
+			for (int job=first; job<=last; job++)
+			{
+				const BatchFit::Dataset& data = m_batch->m_datasets.at(job / m_batch->m_starts);
+				int start = job % m_batch->m_starts;
+
+				for (int i=0; i<p; i++)
+					initial[i] = m_batch->m_initial_values[i];
+				if (start > 0)
+				{
+					gsl_rng_set(rng, job+1);
+					double spread = m_batch->m_spread;
+					for (int i=0; i<p; i++)
+					{
+						double u = 2*gsl_rng_uniform(rng) - 1;
+						if (initial[i] == 0)
+							initial[i] = spread*u;
+						else
+							initial[i] *= 1 + spread*u;
+					}
+				}
+
+				// the fit functions take non-const pointers, but never write to the data
+				m_results[job] = m_batch->m_solver.solve(data.x.size(),
+						const_cast<double*>(data.x.constData()), const_cast<double*>(data.y.constData()),
+						const_cast<double*>(data.sigma.constData()), initial.constData());
+			}
+			gsl_rng_free(rng);
+		}
+
+	private:
+		const BatchFit *m_batch;
+		FitSolver::Result *m_results;
+};
+
+BatchFit::BatchFit(const FitSolver& solver, const QVector<double>& initial_values)
+	: m_solver(solver), m_initial_values(initial_values), m_starts(1), m_spread(0.5)
+{
+	m_initial_values.resize(solver.numParameters());
+}
+
+bool BatchFit::addDataset(const QString& name, const QVector<double>& x, const QVector<double>& y,
+		const QVector<double>& sigma)
+{
+	Dataset data;
+	data.name = name;
+	data.x = x;
+	data.y = y;
+	data.sigma = sigma;
+	int n = qMin(x.size(), y.size());
+	data.x.resize(n);
+	data.y.resize(n);
+	if (data.sigma.size() != n)
+		data.sigma.fill(1.0, n);
+	m_datasets << data;
+	// FitSolver::solve() returns an error result for these
+	return n > 0 && n >= m_solver.numParameters();
+}
+
+void BatchFit::setStarts(int starts, double spread)
+{
+	m_starts = qMax(starts, 1);
+	m_spread = spread;
+}
+
+void BatchFit::run()
+{
+	int p = m_solver.numParameters();
+	QVector<FitSolver::Result> all(m_datasets.size() * m_starts);
+	parallelFor(0, all.size()-1, BatchFitKernel(this, all.data()));
+
+	// keep the best start for each data set
+	m_results.resize(m_datasets.size());
+	for (int d=0; d<m_datasets.size(); d++)
+	{
+		int best = d*m_starts;
+		for (int job=best+1; job<(d+1)*m_starts; job++)
+		{
+			const FitSolver::Result& r = all.at(job);
+			if (r.parameters.size() != p || !gsl_finite(r.chi_square))
+				continue;
+			if (all.at(best).parameters.size() != p || !gsl_finite(all.at(best).chi_square) ||
+					r.chi_square < all.at(best).chi_square)
+				best = job;
+		}
+		m_results[d] = all.at(best);
+	}
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+    File                 : BatchFit.h
+    Project              : SciDAVis
+    Description          : Fit one model to many data sets, from several initial guesses
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BATCHFIT_H
+#define BATCHFIT_H
+
+#include "FitSolver.h"
+
+#include <QList>
+
+//! Fit one model to many data sets, optionally from several initial guesses each
+/**
+ * BatchFit applies a FitSolver (the fit function and solver settings of a configured
+ * Fit, see Fit::batchFit(), or a user-defined function, see TableView::fitSelectedColumns())
+ * to any number of data sets. For each data set, the fit can be started from the initial
+ * guesses and from a number of random perturbations of them, keeping the result with the
+ * lowest chi^2; this helps models like MultiPeakFit or SigmoidalFit which tend to get
+ * stuck in local minima.
+ *
+ * All fits run concurrently on all available cores (see parallelFor()), each with its
+ * own GSL workspace.
+ *
+ * \code
+ * BatchFit batch = fit->batchFit(table, 0, y_columns);
+ * batch.setStarts(10);
+ * batch.run();
+ * fit->batchResultsTable(batch, tr("Results"));
+ * \endcode
+ */
+class BatchFit
+{
+	public:
+		//! Fit using 'solver', starting from 'initial_values' (one per parameter)
+		BatchFit(const FitSolver& solver, const QVector<double>& initial_values);
+
+		//! Add a data set; if 'sigma' is empty, all points are weighted equally
+		/**
+		 * Returns false if the data set has less points than the fit has parameters (or none);
+		 * it is added nevertheless, and its result() reports the error.
+		 */
+		bool addDataset(const QString& name, const QVector<double>& x, const QVector<double>& y,
+				const QVector<double>& sigma = QVector<double>());
+		int datasetCount() const {return m_datasets.size();};
+		QString datasetName(int index) const {return m_datasets.at(index).name;};
+		//! Number of points of data set 'index'
+		int datasetSize(int index) const {return m_datasets.at(index).x.size();};
+
+		//! Start each fit from 'starts' initial guesses
+		/**
+		 * The first start uses the initial guesses, the others multiply each of them by a
+		 * random factor between 1-spread and 1+spread (parameters guessed as 0 are set to
+		 * a random value between -spread and spread instead). The random numbers only
+		 * depend on the data set and start index, so results are reproducible.
+		 */
+		void setStarts(int starts, double spread = 0.5);
+
+		//! Run all fits; blocks until they are done
+		void run();
+
+		//! The best result for data set 'index'
+		const FitSolver::Result& result(int index) const {return m_results.at(index);};
+
+	private:
+		struct Dataset
+		{
+			QString name;
+			QVector<double> x;
+			QVector<double> y;
+			QVector<double> sigma;
+		};
+
+		FitSolver m_solver;
+		QVector<double> m_initial_values;
+		QList<Dataset> m_datasets;
+		int m_starts;
+		double m_spread;
+		//! Best result per data set
+		QVector<FitSolver::Result> m_results;
+
+		friend class BatchFitKernel;
+};
+
+#endif // ifndef BATCHFIT_H
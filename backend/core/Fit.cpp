@@ -69,66 +69,95 @@ Fit::Fit( ApplicationWindow *parent, Layer *layer, const char * name)
 	m_sort_data = true;
 }
 
-gsl_multifit_fdfsolver * Fit::fitGSL(gsl_multifit_function_fdf f, int &iterations, int &status)
+FitSolver Fit::solver() const
 {
-	const gsl_multifit_fdfsolver_type *T;
-	if (m_solver)
-		T = gsl_multifit_fdfsolver_lmder;
-	else
-		T = gsl_multifit_fdfsolver_lmsder;
+	FitSolver s(m_f, m_df, m_fdf, m_fsimplex, m_p);
+	s.setAlgorithm((FitSolver::Algorithm)m_solver);
+	s.setTolerance(m_tolerance);
+	s.setMaximumIterations(m_max_iterations);
+	if (m_f == user_f)
+		s.setUserFunction(m_formula, m_param_names);
+	return s;
+}
 
-	gsl_multifit_fdfsolver *s = gsl_multifit_fdfsolver_alloc (T, m_n, m_p);
-	gsl_multifit_fdfsolver_set (s, &f, m_param_init);
+BatchFit Fit::batchFit(Table *table, int x_column, const QList<int>& y_columns) const
+{
+	QVector<double> initial(m_p);
+	for (int i=0; i<m_p; i++)
+		initial[i] = gsl_vector_get(m_param_init, i);
+	BatchFit batch(solver(), initial);
 
-	size_t iter = 0;
-	do
+	Column *x_col = table->column(x_column);
+	if (!x_col) return batch;
+	foreach(int y_column, y_columns)
 	{
-		iter++;
-		status = gsl_multifit_fdfsolver_iterate (s);
-
-		if (status)
-			break;
-
-		status = gsl_multifit_test_delta (s->dx, s->x, m_tolerance, m_tolerance);
+		Column *y_col = table->column(y_column);
+		if (!y_col) continue;
+		QVector<double> x, y;
+		int rows = qMin(x_col->rowCount(), y_col->rowCount());
+		for (int i=0; i<rows; i++)
+		{
+			if (x_col->isInvalid(i) || y_col->isInvalid(i))
+				continue;
+			x << x_col->valueAt(i);
+			y << y_col->valueAt(i);
+		}
+		batch.addDataset(y_col->name(), x, y);
 	}
-	while (status == GSL_CONTINUE && (int)iter < m_max_iterations);
-
-	gsl_multifit_covar (s->J, 0.0, covar);
-	iterations = iter;
-	return s;
+	return batch;
 }
 
-gsl_multimin_fminimizer * Fit::fitSimplex(gsl_multimin_function f, int &iterations, int &status)
+Table* Fit::batchResultsTable(const BatchFit& batch, const QString& tableName)
 {
-	const gsl_multimin_fminimizer_type *T = gsl_multimin_fminimizer_nmsimplex;
-
-	//size of the simplex
-	gsl_vector *ss;
-	//initial vertex size vector
-	ss = gsl_vector_alloc (f.n);
-	//set all step sizes to 1 can be increased to converge faster
-	gsl_vector_set_all (ss,10.0);
-
-	gsl_multimin_fminimizer *s_min = gsl_multimin_fminimizer_alloc (T, f.n);
-	status = gsl_multimin_fminimizer_set (s_min, &f, m_param_init, ss);
-	double size;
-	size_t iter = 0;
-	do
+	ApplicationWindow *app = (ApplicationWindow *)parent();
+	Table *t = app->newTable(tableName, batch.datasetCount(), 2*m_p + 2);
+
+	QStringList header;
+	header << tr("Dataset");
+	for (int i=0; i<m_p; i++)
+		header << m_param_names[i] << m_param_names[i] + " " + tr("Error");
+	header << tr("Chi^2/doF");
+	t->setHeader(header);
+
+	// exponential fits and the like report transformed parameters; reuse
+	// storeCustomFitResults(), but leave our own results untouched
+	double *saved_results = new double[m_p];
+	for (int i=0; i<m_p; i++)
+		saved_results[i] = m_results[i];
+
+	for (int d=0; d<batch.datasetCount(); d++)
 	{
-		iter++;
-		status = gsl_multimin_fminimizer_iterate (s_min);
+		const FitSolver::Result& r = batch.result(d);
+		t->setText(d, 0, batch.datasetName(d));
+		if (r.parameters.size() != m_p)
+			continue;
 
-		if (status)
-			break;
-		size=gsl_multimin_fminimizer_size (s_min);
-		status = gsl_multimin_test_size (size, m_tolerance);
+		double *par = new double[m_p];
+		for (int i=0; i<m_p; i++)
+			par[i] = r.parameters[i];
+		storeCustomFitResults(par);
+		delete[] par;
+
+		double chi_2_dof = r.chi_square/(batch.datasetSize(d) - m_p);
+		for (int i=0; i<m_p; i++)
+		{
+			double error = sqrt(r.covariance[i*m_p+i]);
+			if (m_scale_errors)
+				error *= sqrt(chi_2_dof);
+			t->setText(d, 2*i+1, QLocale().toString(m_results[i], 'g', m_prec));
+			t->setText(d, 2*i+2, QLocale().toString(error, 'g', m_prec));
+		}
+		t->setText(d, 2*m_p+1, QLocale().toString(chi_2_dof, 'g', m_prec));
 	}
 
-	while (status == GSL_CONTINUE && (int)iter < m_max_iterations);
+	for (int i=0; i<m_p; i++)
+		m_results[i] = saved_results[i];
+	delete[] saved_results;
 
-	iterations = iter;
-	gsl_vector_free(ss);
-	return s_min;
+	for (int i=0; i<m_p; i++)
+		t->setColPlotDesignation(2*i+2, SciDAVis::yErr);
+	t->showNormal();
+	return t;
 }
 
 void Fit::setDataCurve(int curve, double start, double end)
@@ -432,52 +461,30 @@ void Fit::fit()
 
 	QApplication::setOverrideCursor(Qt::WaitCursor);
 
-	const char *function = m_formula.toAscii().constData();
-	QString names = m_param_names.join (",");
-	const char *parNames = names.toAscii().constData();
-
-	struct FitData m_data = {m_n, m_p, m_x, m_y, m_w, function, parNames};
-
-	int status, iterations = m_max_iterations;
-	double *par = new double[m_p];
-	if(m_solver == NelderMeadSimplex)
+	FitSolver::Result result = solver().solve(m_n, m_x, m_y, m_w, m_param_init->data);
+	if (!result.error.isEmpty())
 	{
-		gsl_multimin_function f;
-		f.f = m_fsimplex;
-		f.n = m_p;
-		f.params = &m_data;
-		gsl_multimin_fminimizer *s_min = fitSimplex(f, iterations, status);
-
-		for (int i=0; i<m_p; i++)
-			par[i]=gsl_vector_get(s_min->x, i);
-
-		// allocate memory and calculate covariance matrix based on residuals
-		gsl_matrix *J = gsl_matrix_alloc(m_n, m_p);
-		m_df(s_min->x,(void*)f.params, J);
-		gsl_multifit_covar (J, 0.0, covar);
-		chi_2 = s_min->fval;
-
-		// free previousely allocated memory
-		gsl_matrix_free (J);
-		gsl_multimin_fminimizer_free (s_min);
+		QApplication::restoreOverrideCursor();
+		QMessageBox::critical((ApplicationWindow *)parent(), tr("Input function error"), result.error);
+		return;
 	}
-	else
+	if (result.parameters.size() != m_p)
 	{
-		gsl_multifit_function_fdf f;
-		f.f = m_f;
-		f.df = m_df;
-		f.fdf = m_fdf;
-		f.n = m_n;
-		f.p = m_p;
-		f.params = &m_data;
-		gsl_multifit_fdfsolver *s = fitGSL(f, iterations, status);
-
-		for (int i=0; i<m_p; i++)
-			par[i]=gsl_vector_get(s->x, i);
+		QApplication::restoreOverrideCursor();
+		QMessageBox::critical((ApplicationWindow *)parent(), tr("Fit Error"),
+				tr("The fit could not be started: %1").arg(gsl_strerror(result.status)));
+		return;
+	}
 
-		chi_2 = pow(gsl_blas_dnrm2(s->f), 2.0);
-		gsl_multifit_fdfsolver_free(s);
+	int status = result.status, iterations = result.iterations;
+	double *par = new double[m_p];
+	for (int i=0; i<m_p; i++)
+	{
+		par[i] = result.parameters[i];
+		for (int j=0; j<m_p; j++)
+			gsl_matrix_set(covar, i, j, result.covariance[i*m_p+j]);
 	}
+	chi_2 = result.chi_square;
 
 	storeCustomFitResults(par);
 
@@ -33,6 +33,8 @@
 
 #include "ApplicationWindow.h"
 #include "Filter.h"
+#include "FitSolver.h"
+#include "BatchFit.h"
 
 #include <gsl/gsl_multifit_nlin.h>
 #include <gsl/gsl_multimin.h>
@@ -47,10 +49,10 @@ class Fit : public Filter
 
 	public:
 
-		typedef double (*fit_function_simplex)(const gsl_vector *, void *);
-		typedef int (*fit_function)(const gsl_vector *, void *, gsl_vector *);
-		typedef int (*fit_function_df)(const gsl_vector *, void *, gsl_matrix *);
-		typedef int (*fit_function_fdf)(const gsl_vector *, void *, gsl_vector *, gsl_matrix *);
+		typedef FitSolver::fit_function_simplex fit_function_simplex;
+		typedef FitSolver::fit_function fit_function;
+		typedef FitSolver::fit_function_df fit_function_df;
+		typedef FitSolver::fit_function_fdf fit_function_fdf;
 
 		enum Algorithm{ScaledLevenbergMarquardt, UnscaledLevenbergMarquardt, NelderMeadSimplex};
 		enum WeightingMethod{NoWeighting, Instrumental, Statistical, Dataset};
@@ -101,13 +103,19 @@ class Fit : public Filter
 		Table* parametersTable(const QString& tableName);
 		Matrix* covarianceMatrix(const QString& matrixName);
 
-	private:
-		//! Pointer to the GSL multifit minimizer (for simplex algorithm)
-		gsl_multimin_fminimizer * fitSimplex(gsl_multimin_function f, int &iterations, int &status);
+		//! Returns a solver for the current fit function and settings, which can be used off the GUI thread
+		FitSolver solver() const;
 
-		//! Pointer to the GSL multifit solver
-		gsl_multifit_fdfsolver * fitGSL(gsl_multifit_function_fdf f, int &iterations, int &status);
+		//! Returns a BatchFit using solver() and the initial guesses
+		/**
+		 * The batch gets one data set for each of 'y_columns', all sharing 'x_column';
+		 * rows where either value is invalid are skipped.
+		 */
+		BatchFit batchFit(Table *table, int x_column, const QList<int>& y_columns) const;
+		//! Writes parameters, errors and chi^2/dof of all data sets of 'batch' into a new table
+		Table* batchResultsTable(const BatchFit& batch, const QString& tableName);
 
+	private:
 		//! Customs and stores the fit results according to the derived class specifications. Used by exponential fits.
 		virtual void storeCustomFitResults(double *par);
 
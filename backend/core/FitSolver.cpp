@@ -0,0 +1,198 @@
+/***************************************************************************
+    File                 : FitSolver.cpp
+    Project              : SciDAVis
+    Description          : GUI-independent core of Fit
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "FitSolver.h"
+#include "analysis/fit_gsl.h"
+#include "core/MyParser.h"
+
+#include <QObject>
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_multifit_nlin.h>
+#include <gsl/gsl_multimin.h>
+#include <gsl/gsl_blas.h>
+#include <gsl/gsl_math.h>
+
+#include <math.h>
+
+FitSolver::FitSolver(fit_function f, fit_function_df df, fit_function_fdf fdf, fit_function_simplex fsimplex, int p)
+	: m_f(f), m_df(df), m_fdf(fdf), m_fsimplex(fsimplex), m_p(p),
+	m_algorithm(ScaledLevenbergMarquardt), m_tolerance(1e-4), m_max_iterations(1000)
+{
+}
+
+void FitSolver::setUserFunction(const QString& formula, const QStringList& parameter_names)
+{
+	m_formula = formula;
+	m_param_names = parameter_names;
+}
+
+FitSolver::Result FitSolver::solve(size_t n, double *X, double *Y, double *sigma, const double *initial) const
+{
+	Result result;
+
+	// GSL's default error handler would abort on these
+	if (n == 0 || n < (size_t)m_p)
+	{
+		result.error = QObject::tr("You need at least %1 data points for this fit operation.").arg(qMax(m_p, 1));
+		result.status = GSL_EINVAL;
+		return result;
+	}
+
+	UserFitFunction *function = 0;
+	if (!m_formula.isEmpty())
+	{
+		try
+		{
+			function = new UserFitFunction(m_formula, m_param_names);
+		}
+		catch(mu::ParserError &e)
+		{
+			result.error = QString::fromStdString(e.GetMsg());
+			result.status = GSL_EINVAL;
+			return result;
+		}
+	}
+	struct FitData data = {n, m_p, X, Y, sigma, function};
+
+	gsl_vector_const_view init = gsl_vector_const_view_array(initial, m_p);
+	gsl_matrix *covar = gsl_matrix_alloc(m_p, m_p);
+	result.parameters.resize(m_p);
+	gsl_vector_view par = gsl_vector_view_array(result.parameters.data(), m_p);
+	size_t iter = 0;
+	int status;
+
+	if (m_algorithm == NelderMeadSimplex)
+	{
+		gsl_multimin_function f;
+		f.f = m_fsimplex;
+		f.n = m_p;
+		f.params = &data;
+
+		//initial vertex size vector; can be increased to converge faster
+		gsl_vector *ss = gsl_vector_alloc(m_p);
+		gsl_vector_set_all(ss, 10.0);
+
+		// the simplex can't start from a non-finite value; check before GSL reports it as an error
+		gsl_multimin_fminimizer *s_min = 0;
+		if (!gsl_finite(m_fsimplex(&init.vector, &data)))
+			status = GSL_EBADFUNC;
+		else
+		{
+			s_min = gsl_multimin_fminimizer_alloc(gsl_multimin_fminimizer_nmsimplex, m_p);
+			status = s_min ? gsl_multimin_fminimizer_set(s_min, &f, &init.vector, ss) : GSL_ENOMEM;
+		}
+		if (status)
+		{
+			// e.g. the function can't be evaluated at the initial guesses
+			gsl_vector_free(ss);
+			if (s_min) gsl_multimin_fminimizer_free(s_min);
+			gsl_matrix_free(covar);
+			delete function;
+			result.parameters.clear();
+			result.status = status;
+			return result;
+		}
+		do
+		{
+			iter++;
+			status = gsl_multimin_fminimizer_iterate(s_min);
+			if (status)
+				break;
+			double size = gsl_multimin_fminimizer_size(s_min);
+			status = gsl_multimin_test_size(size, m_tolerance);
+		}
+		while (status == GSL_CONTINUE && (int)iter < m_max_iterations);
+
+		gsl_vector_memcpy(&par.vector, s_min->x);
+		result.chi_square = s_min->fval;
+
+		// calculate covariance matrix based on residuals
+		gsl_matrix *J = gsl_matrix_alloc(n, m_p);
+		m_df(s_min->x, &data, J);
+		gsl_multifit_covar(J, 0.0, covar);
+
+		gsl_matrix_free(J);
+		gsl_vector_free(ss);
+		gsl_multimin_fminimizer_free(s_min);
+	}
+	else
+	{
+		gsl_multifit_function_fdf f;
+		f.f = m_f;
+		f.df = m_df;
+		f.fdf = m_fdf;
+		f.n = n;
+		f.p = m_p;
+		f.params = &data;
+
+		const gsl_multifit_fdfsolver_type *T;
+		if (m_algorithm == ScaledLevenbergMarquardt)
+			T = gsl_multifit_fdfsolver_lmsder;
+		else
+			T = gsl_multifit_fdfsolver_lmder;
+
+		gsl_multifit_fdfsolver *s = gsl_multifit_fdfsolver_alloc(T, n, m_p);
+		status = s ? gsl_multifit_fdfsolver_set(s, &f, &init.vector) : GSL_EINVAL;
+		if (status)
+		{
+			if (s) gsl_multifit_fdfsolver_free(s);
+			gsl_matrix_free(covar);
+			delete function;
+			result.parameters.clear();
+			result.status = status;
+			return result;
+		}
+		do
+		{
+			iter++;
+			status = gsl_multifit_fdfsolver_iterate(s);
+			if (status)
+				break;
+			status = gsl_multifit_test_delta(s->dx, s->x, m_tolerance, m_tolerance);
+		}
+		while (status == GSL_CONTINUE && (int)iter < m_max_iterations);
+
+		gsl_vector_memcpy(&par.vector, s->x);
+		result.chi_square = pow(gsl_blas_dnrm2(s->f), 2.0);
+		gsl_multifit_covar(s->J, 0.0, covar);
+
+		gsl_multifit_fdfsolver_free(s);
+	}
+
+	result.iterations = iter;
+	result.status = status;
+	result.covariance.resize(m_p*m_p);
+	for (int i=0; i<m_p; i++)
+		for (int j=0; j<m_p; j++)
+			result.covariance[i*m_p+j] = gsl_matrix_get(covar, i, j);
+
+	gsl_matrix_free(covar);
+	delete function;
+	return result;
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+    File                 : FitSolver.h
+    Project              : SciDAVis
+    Description          : GUI-independent core of Fit
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FITSOLVER_H
+#define FITSOLVER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+
+//! GUI-independent core of Fit: runs a GSL solver on one data set
+/**
+ * A FitSolver only holds the fit function and the solver settings. Every call to solve()
+ * allocates its own GSL workspace (and, for user-defined functions, its own parser), so
+ * one instance can be used from several threads at once, as done by BatchFit.
+ */
+class FitSolver
+{
+	public:
+		typedef double (*fit_function_simplex)(const gsl_vector *, void *);
+		typedef int (*fit_function)(const gsl_vector *, void *, gsl_vector *);
+		typedef int (*fit_function_df)(const gsl_vector *, void *, gsl_matrix *);
+		typedef int (*fit_function_fdf)(const gsl_vector *, void *, gsl_vector *, gsl_matrix *);
+
+		//! Same order as Fit::Algorithm
+		enum Algorithm{ScaledLevenbergMarquardt, UnscaledLevenbergMarquardt, NelderMeadSimplex};
+
+		//! Outcome of a single fit
+		struct Result
+		{
+			Result() : chi_square(-1), iterations(0), status(0) {}
+			//! Fitted parameters (empty if the fit could not be started)
+			QVector<double> parameters;
+			//! Covariance matrix, row by row
+			QVector<double> covariance;
+			//! Sum of squares of the weighted residuals
+			double chi_square;
+			int iterations;
+			//! GSL status code of the last iteration
+			int status;
+			//! Error message if the fit function could not be parsed or there are too few points
+			QString error;
+		};
+
+		FitSolver(fit_function f, fit_function_df df, fit_function_fdf fdf, fit_function_simplex fsimplex, int p);
+
+		void setAlgorithm(Algorithm a){m_algorithm = a;};
+		void setTolerance(double eps){m_tolerance = eps;};
+		void setMaximumIterations(int iter){m_max_iterations = iter;};
+		//! Evaluate 'formula' (see UserFitFunction) instead of a built-in function
+		void setUserFunction(const QString& formula, const QStringList& parameter_names);
+
+		int numParameters() const {return m_p;};
+
+		//! Fit n points, starting from 'initial' (numParameters() values).
+		/**
+		 * Fails with an error if n is less than numParameters() or 0.
+		 */
+		Result solve(size_t n, double *X, double *Y, double *sigma, const double *initial) const;
+
+	private:
+		fit_function m_f;
+		fit_function_df m_df;
+		fit_function_fdf m_fdf;
+		fit_function_simplex m_fsimplex;
+		int m_p;
+		Algorithm m_algorithm;
+		double m_tolerance;
+		int m_max_iterations;
+		QString m_formula;
+		QStringList m_param_names;
+};
+
+#endif // ifndef FITSOLVER_H
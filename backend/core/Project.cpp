@@ -32,6 +32,7 @@
 #include "core/interfaces.h"
 #include "core/globals.h"
 #include "lib/XmlStreamReader.h"
+#include "lib/UndoPayload.h"
 #ifdef ACTIVATE_SCIDAVIS_SPECIFIC_CODE
 #include "core/ProjectWindow.h"
 #include "core/ProjectConfigPage.h"
@@ -68,6 +69,7 @@ class Project::Private
 #endif
 			scripting_engine(0),
 		 	file_name(QString()),
+			archive_file_name(QString()),
 
 #ifdef ACTIVATE_SCIDAVIS_SPECIFIC_CODE
 			version(SciDAVis::version()),
@@ -89,6 +91,7 @@ class Project::Private
 		QWidget * primary_view;
 		AbstractScriptingEngine * scripting_engine;
 		QString file_name;
+		QString archive_file_name;
 		int version;
 #ifndef ACTIVATE_SCIDAVIS_SPECIFIC_CODE
 		QString labPlot;
@@ -112,6 +115,7 @@ Project::Project(MainWin * mainWin)
 	QString engine_name = ScriptingEngineManager::instance()->engineNames()[0];
 	d->scripting_engine = ScriptingEngineManager::instance()->engine(engine_name);
 #endif
+	UndoMemory::instance()->setBudget(qint64(global("undo_memory_size").toInt()) << 20);
 }
 
 Project::~Project()
@@ -186,6 +190,7 @@ QString Project::configPageLabel()
 #endif
 
 CLASS_D_ACCESSOR_IMPL(Project, QString, fileName, FileName, file_name)
+CLASS_D_ACCESSOR_IMPL(Project, QString, archiveFileName, ArchiveFileName, archive_file_name)
 BASIC_D_ACCESSOR_IMPL(Project, int, version, Version, version)
 #ifndef ACTIVATE_SCIDAVIS_SPECIFIC_CODE
 CLASS_D_ACCESSOR_IMPL(Project, QString, labPlot, LabPlot, labPlot)
@@ -353,6 +358,11 @@ void Project::staticInit()
 	Project::setGlobalDefault("default_mdi_window_visibility", Project::folderOnly);
 	Project::setGlobalDefault("auto_save", true);
 	Project::setGlobalDefault("auto_save_interval", 15);
+	// memory used for columns of binary projects which are not read completely, see PageCache
+	Project::setGlobalDefault("map_project_files", true);
+	Project::setGlobalDefault("page_cache_size", 256);
+	// memory for the backup data of undo commands (in MiB), see UndoMemory
+	Project::setGlobalDefault("undo_memory_size", 256);
 	Project::setGlobalDefault("default_scripting_language", QString("muParser"));
 	// TODO: not really Project-specific; maybe put these somewhere else:
 	Project::setGlobalDefault("language", QString("en"));
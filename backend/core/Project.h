@@ -101,6 +101,12 @@ class Project : public Folder
 		void setMdiWindowVisibility(MdiWindowVisibility visibility);
 		MdiWindowVisibility mdiWindowVisibility() const;
 		CLASS_D_ACCESSOR_DECL(QString, fileName, FileName)
+		//! The binary project file the project was loaded from
+		/**
+		 * Columns may still read their data from this file (see ProjectArchive), so it must not
+		 * be overwritten in place. Empty if the project wasn't loaded from a binary file.
+		 */
+		CLASS_D_ACCESSOR_DECL(QString, archiveFileName, ArchiveFileName)
 		BASIC_D_ACCESSOR_DECL(int, version, Version)
 #ifndef ACTIVATE_SCIDAVIS_SPECIFIC_CODE
 		CLASS_D_ACCESSOR_DECL(QString, labPlot, LabPlot)
@@ -31,6 +31,7 @@
 #include "core/column/ColumnPrivate.h"
 #include "core/column/columncommands.h"
 #include "lib/XmlStreamReader.h"
+#include "lib/ProjectArchive.h"
 #include <QIcon>
 #include <QXmlStreamWriter>
 #include <QtDebug>
@@ -140,6 +141,12 @@ void Column::removeRows(int first, int count)
 		exec(new ColumnRemoveRowsCmd(m_column_private, first, count));
 }
 
+void Column::permuteRows(const QVector<int>& permutation)
+{
+	if(permutation.size() > 1)
+		exec(new ColumnPermuteRowsCmd(m_column_private, permutation));
+}
+
 void Column::setPlotDesignation(SciDAVis::PlotDesignation pd)
 {
 	if(pd != plotDesignation())
@@ -255,6 +262,12 @@ void Column::replaceValues(int first, const QVector<double>& new_values)
 		exec(new ColumnReplaceValuesCmd(m_column_private, first, new_values));
 }
 
+void Column::replaceValues(int first, const QVector<double>& new_values, const QList< Interval<int> >& invalid_rows)
+{
+	if (!new_values.isEmpty())
+		exec(new ColumnReplaceValuesCmd(m_column_private, first, new_values, invalid_rows));
+}
+
 QString Column::textAt(int row) const
 {
 	return m_column_private->textAt(row);
@@ -280,6 +293,16 @@ double Column::valueAt(int row) const
 	return m_column_private->valueAt(row);
 }
 
+const double * Column::rawValues() const
+{
+	return m_column_private->rawValues();
+}
+
+void Column::valuesAt(int first, int count, double * buffer) const
+{
+	m_column_private->valuesAt(first, count, buffer);
+}
+
 QIcon Column::icon() const
 {
 	switch(dataType())
@@ -326,6 +349,41 @@ void Column::save(QXmlStreamWriter * writer) const
 		writer->writeCharacters(formula(interval.start()));
 		writer->writeEndElement();
 	}
+	ProjectArchive * archive = qobject_cast<ProjectArchive *>(writer->device());
+	if (archive)
+	{
+		// binary project: store the data in a block and only the invalid intervals in XML
+		QByteArray bytes;
+		switch(dataType())
+		{
+			case SciDAVis::TypeDouble:
+				{
+					ValueSpan values = valueSpan();
+					bytes = ProjectArchive::encodeDoubles(values.data(), values.size());
+					break;
+				}
+			case SciDAVis::TypeQString:
+				bytes = ProjectArchive::encodeStrings(*static_cast< QStringList* >(m_column_private->dataPointer()));
+				break;
+			case SciDAVis::TypeQDateTime:
+				bytes = ProjectArchive::encodeDateTimes(*static_cast< QList<QDateTime>* >(m_column_private->dataPointer()));
+				break;
+		}
+		foreach(Interval<int> interval, invalidIntervals())
+		{
+			writer->writeStartElement("invalid");
+			writer->writeAttribute("start_row", QString::number(interval.start()));
+			writer->writeAttribute("end_row", QString::number(interval.end()));
+			writer->writeEndElement();
+		}
+		writer->writeStartElement("data");
+		writer->writeAttribute("rows", QString::number(rowCount()));
+		writer->writeAttribute("block", QString::number(archive->writeBlock(bytes)));
+		writer->writeEndElement();
+		writer->writeEndElement(); // "column"
+		return;
+	}
+
 	int i;
 	switch(dataType())
 	{
@@ -470,6 +528,10 @@ bool Column::load(XmlStreamReader * reader)
 					ret_val = XmlReadFormula(reader);
 				else if(reader->name() == "row")
 					ret_val = XmlReadRow(reader);
+				else if(reader->name() == "invalid")
+					ret_val = XmlReadInvalid(reader);
+				else if(reader->name() == "data")
+					ret_val = XmlReadData(reader);
 				else // unknown element
 				{
 					reader->raiseWarning(tr("unknown element '%1'").arg(reader->name().toString()));
@@ -525,6 +587,64 @@ bool Column::XmlReadMask(XmlStreamReader * reader)
 	return true;
 }
 
+bool Column::XmlReadInvalid(XmlStreamReader * reader)
+{
+	Q_ASSERT(reader->isStartElement() && reader->name() == "invalid");
+
+	bool ok1, ok2;
+	int start, end;
+	start = reader->readAttributeInt("start_row", &ok1);
+	end = reader->readAttributeInt("end_row", &ok2);
+	if(!ok1 || !ok2) 
+	{
+		reader->raiseError(tr("invalid or missing start or end row"));
+		return false;
+	}
+	setInvalid(Interval<int>(start,end));
+	if (!reader->skipToEndElement()) return false;
+
+	return true;
+}
+
+bool Column::XmlReadData(XmlStreamReader * reader)
+{
+	Q_ASSERT(reader->isStartElement() && reader->name() == "data");
+
+	ProjectArchive * archive = qobject_cast<ProjectArchive *>(reader->device());
+	if (!archive)
+	{
+		reader->raiseError(tr("data block reference outside of a binary project"));
+		return false;
+	}
+	bool ok1, ok2;
+	int rows = reader->readAttributeInt("rows", &ok1);
+	int block = reader->readAttributeInt("block", &ok2);
+	if(!ok1 || !ok2 || rows < 0 || block < 0 || block >= archive->blockCount())
+	{
+		reader->raiseError(tr("invalid or missing data block"));
+		return false;
+	}
+	m_column_private->setPendingData(archive->block(block), rows);
+	if (!reader->skipToEndElement()) return false;
+
+	return true;
+}
+
+void Column::releaseProjectFile()
+{
+	m_column_private->releasePendingData();
+}
+
+int Column::revision() const
+{
+	return m_column_private->revision();
+}
+
+bool Column::changedRows(int revision, QList< Interval<int> > *rows) const
+{
+	return m_column_private->changedRows(revision, rows);
+}
+
 bool Column::XmlReadFormula(XmlStreamReader * reader)
 {
 	Q_ASSERT(reader->isStartElement() && reader->name() == "formula");
@@ -147,6 +147,14 @@ class Column : public AbstractColumn
 		void insertRows(int before, int count);
 		//! Remove 'count' rows starting from row 'first'
 		void removeRows(int first, int count);
+		//! Reorder the rows 0 to permutation.size()-1
+		/**
+		 * Afterwards, row i contains the value, validity, masking and formula
+		 * that row permutation.at(i) had before. 'permutation' must contain each
+		 * of these rows exactly once and must not be longer than rowCount().
+		 * The undo command stores only the permutation.
+		 */
+		void permuteRows(const QVector<int>& permutation);
 		//! Return the column plot designation
 		SciDAVis::PlotDesignation plotDesignation() const;
 		//! Set the column plot designation
@@ -283,6 +291,17 @@ class Column : public AbstractColumn
 		void replaceDateTimes(int first, const QList<QDateTime>& new_values);
 		//! Return the double value in row 'row'
 		double valueAt(int row) const;
+		//! Return a pointer to the contiguous double storage
+		/**
+		 * Returns 0 if dataType() is not double or if the values are still in a project
+		 * file and not mapped into memory (see Column::Private::setPendingData()).
+		 */
+		const double * rawValues() const;
+		//! Copy the values of rows first..first+count-1 into 'buffer'
+		/**
+		 * Values still in a project file are read through the PageCache.
+		 */
+		void valuesAt(int first, int count, double * buffer) const;
 		//! Set the content of row 'row'
 		/**
 		 * Use this only when dataType() is double
@@ -293,6 +312,29 @@ class Column : public AbstractColumn
 		 * Use this only when dataType() is double
 		 */
 		virtual void replaceValues(int first, const QVector<double>& new_values);
+		//! Replace a range of values and mark some of the rows as invalid
+		/**
+		 * Same as replaceValues(first, new_values), but the rows in 'invalid_rows'
+		 * (absolute row numbers) are marked as invalid afterwards. This is done
+		 * in one undo step. Use this only when dataType() is double.
+		 */
+		void replaceValues(int first, const QVector<double>& new_values, const QList< Interval<int> >& invalid_rows);
+		//@}
+
+		//! \name Change tracking
+		//@{
+		//! Number of changes of cells, validity or masking so far
+		/**
+		 * Together with changedRows(), this allows caches of derived data (plots,
+		 * statistics) to catch up with a change without reading the whole column.
+		 */
+		int revision() const;
+		//! Append the rows changed after 'revision' to 'rows'
+		/**
+		 * Returns false if the changes since 'revision' are not known any more;
+		 * everything has to be read again then.
+		 */
+		bool changedRows(int revision, QList< Interval<int> > *rows) const;
 		//@}
 
 		//! \name XML related functions
@@ -301,6 +343,11 @@ class Column : public AbstractColumn
 		void save(QXmlStreamWriter * writer) const;
 		//! Load the column from XML
 		bool load(XmlStreamReader * reader);
+		//! Read data still kept in the project file into memory
+		/**
+		 * Afterwards, the column doesn't keep the file open (or mapped) anymore.
+		 */
+		void releaseProjectFile();
 	private:
 		//! Read XML input filter element
 		bool XmlReadInputFilter(XmlStreamReader * reader);
@@ -312,6 +359,10 @@ class Column : public AbstractColumn
 		bool XmlReadFormula(XmlStreamReader * reader);
 		//! Read XML row element
 		bool XmlReadRow(XmlStreamReader * reader);
+		//! Read XML invalid element (binary projects only)
+		bool XmlReadInvalid(XmlStreamReader * reader);
+		//! Read XML data element, which refers to a block of a binary project
+		bool XmlReadData(XmlStreamReader * reader);
 		//@}
 
 	signals:
@@ -348,6 +399,12 @@ class ColumnStringIO : public AbstractColumn
 			else
 				return m_owner->isInvalid(row);
 		}
+		virtual QList< Interval<int> > invalidIntervals() const {
+			if (m_setting)
+				return QList< Interval<int> >();
+			else
+				return m_owner->invalidIntervals();
+		}
 
 	private:
 		Column * m_owner;
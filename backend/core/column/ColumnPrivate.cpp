@@ -46,10 +46,14 @@
 #include <QString>
 #include <QStringList>
 #include <QtDebug>
+#include "lib/ProjectArchive.h"
+#include "lib/PageCache.h"
+#include <QMutexLocker>
+#include <string.h>
 
 
 Column::Private::Private(Column * owner, SciDAVis::ColumnMode mode)
- : m_owner(owner)
+ : m_owner(owner), m_pending_rows(0), m_paged_data(0), m_data_pending(0), m_revision(0)
 {
 	Q_ASSERT(owner != 0); // a Column::Private without owner is not allowed 
 					      // because the owner must become the parent aspect of the input and output filters
@@ -105,7 +109,7 @@ Column::Private::Private(Column * owner, SciDAVis::ColumnMode mode)
 
 Column::Private::Private(Column * owner, SciDAVis::ColumnDataType type, SciDAVis::ColumnMode mode, 
 	void * data, IntervalAttribute<bool> validity) 
-	: m_owner(owner)
+	: m_owner(owner), m_pending_rows(0), m_paged_data(0), m_data_pending(0), m_revision(0)
 {
 	m_data_type = type;
 	m_column_mode = mode;
@@ -153,6 +157,7 @@ Column::Private::Private(Column * owner, SciDAVis::ColumnDataType type, SciDAVis
 
 Column::Private::~Private()
 {
+	delete m_paged_data;
 	if (!m_data) return;
 
 	switch(m_data_type)
@@ -174,6 +179,7 @@ Column::Private::~Private()
 void Column::Private::setColumnMode(SciDAVis::ColumnMode mode)
 {
 	if (mode == m_column_mode) return;
+	releasePendingData();
 
 	void * old_data = m_data;
 	// remark: the deletion of the old data will be done in the dtor of a command
@@ -340,6 +346,7 @@ void Column::Private::setColumnMode(SciDAVis::ColumnMode mode)
 
 	if (filter_is_temporary) delete filter;
 
+	logChange(0, rowCount()-1);
 	emit m_owner->modeChanged(m_owner);
 }
 
@@ -366,6 +373,7 @@ void Column::Private::replaceModeData(SciDAVis::ColumnMode mode, SciDAVis::Colum
 
 	m_column_mode = mode;
 	m_data_type = type;
+	discardPendingData();
 	m_data = data;
 
 	in_filter->setName("InputFilter");
@@ -390,36 +398,39 @@ void Column::Private::replaceModeData(SciDAVis::ColumnMode mode, SciDAVis::Colum
 			break;
 	} 
 
+	int old_rows = rowCount();
 	m_validity = validity;
+	logChange(0, qMax(old_rows, rowCount())-1);
 	emit m_owner->modeChanged(m_owner);
 }
 
 void Column::Private::replaceData(void * data, IntervalAttribute<bool> validity)
 {
 	emit m_owner->dataAboutToChange(m_owner);
+	int old_rows = rowCount();
+	discardPendingData();
 	m_data = data;
 	m_validity = validity;
+	logChange(0, qMax(old_rows, rowCount())-1);
 	emit m_owner->dataChanged(m_owner);
 }
 
 bool Column::Private::copy(const AbstractColumn * other)
 {
 	if (other->dataType() != dataType()) return false;
+	releasePendingData();
 	int num_rows = other->rowCount();
 
 	emit m_owner->dataAboutToChange(m_owner);
+	int old_rows = rowCount();
 	resizeTo(num_rows); 
 
 	// copy the data
 	switch(m_data_type)
 	{
 		case SciDAVis::TypeDouble:
-			{
-				double * ptr = static_cast< QVector<double>* >(m_data)->data();
-				for(int i=0; i<num_rows; i++)
-					ptr[i] = other->valueAt(i);
-				break;
-			}
+			other->valuesAt(0, num_rows, static_cast< QVector<double>* >(m_data)->data());
+			break;
 		case SciDAVis::TypeQString:
 			{
 				for(int i=0; i<num_rows; i++)
@@ -436,6 +447,7 @@ bool Column::Private::copy(const AbstractColumn * other)
 	// copy the validity information
 	m_validity = other->invalidIntervals();
 
+	logChange(0, qMax(old_rows, num_rows)-1);
 	emit m_owner->dataChanged(m_owner);
 
 	return true;
@@ -444,9 +456,11 @@ bool Column::Private::copy(const AbstractColumn * other)
 bool Column::Private::copy(const AbstractColumn * source, int source_start, int dest_start, int num_rows)
 {
 	if (source->dataType() != dataType()) return false;
+	releasePendingData();
 	if (num_rows == 0) return true;
 
 	emit m_owner->dataAboutToChange(m_owner);
+	int old_rows = rowCount();
 	if (dest_start+1-rowCount() > 1)
 		m_validity.setValue(Interval<int>(rowCount(), dest_start-1), true);
 	if (dest_start + num_rows > rowCount())
@@ -456,12 +470,8 @@ bool Column::Private::copy(const AbstractColumn * source, int source_start, int
 	switch(m_data_type)
 	{
 		case SciDAVis::TypeDouble:
-			{
-				double * ptr = static_cast< QVector<double>* >(m_data)->data();
-				for(int i=0; i<num_rows; i++)
-					ptr[dest_start+i] = source->valueAt(source_start + i);
-				break;
-			}
+			source->valuesAt(source_start, num_rows, static_cast< QVector<double>* >(m_data)->data() + dest_start);
+			break;
 		case SciDAVis::TypeQString:
 				for(int i=0; i<num_rows; i++)
 					static_cast< QStringList* >(m_data)->replace(dest_start+i, source->textAt(source_start + i));
@@ -472,9 +482,9 @@ bool Column::Private::copy(const AbstractColumn * source, int source_start, int
 				break;
 	}
 	// copy the validity information
-	for(int i=0; i<num_rows; i++)
-		setInvalid(dest_start+i, source->isInvalid(source_start+i));
+	copyValidity(source->invalidIntervals(), source_start, dest_start, num_rows);
 
+	logChange(qMin(old_rows, dest_start), dest_start+num_rows-1);
 	emit m_owner->dataChanged(m_owner);
 
 	return true;
@@ -483,21 +493,20 @@ bool Column::Private::copy(const AbstractColumn * source, int source_start, int
 bool Column::Private::copy(const Private * other)
 {
 	if (other->dataType() != dataType()) return false;
+	releasePendingData();
 	int num_rows = other->rowCount();
 
 	emit m_owner->dataAboutToChange(m_owner);
+	int old_rows = rowCount();
 	resizeTo(num_rows); 
 
 	// copy the data
 	switch(m_data_type)
 	{
 		case SciDAVis::TypeDouble:
-			{
-				double * ptr = static_cast< QVector<double>* >(m_data)->data();
-				for(int i=0; i<num_rows; i++)
-					ptr[i] = other->valueAt(i);
-				break;
-			}
+			if (num_rows > 0)
+				other->valuesAt(0, num_rows, static_cast< QVector<double>* >(m_data)->data());
+			break;
 		case SciDAVis::TypeQString:
 			{
 				for(int i=0; i<num_rows; i++)
@@ -514,6 +523,7 @@ bool Column::Private::copy(const Private * other)
 	// copy the validity information
 	m_validity = other->invalidIntervals();
 
+	logChange(0, qMax(old_rows, num_rows)-1);
 	emit m_owner->dataChanged(m_owner);
 
 	return true;
@@ -522,9 +532,11 @@ bool Column::Private::copy(const Private * other)
 bool Column::Private::copy(const Private * source, int source_start, int dest_start, int num_rows)
 {
 	if (source->dataType() != dataType()) return false;
+	releasePendingData();
 	if (num_rows == 0) return true;
 
 	emit m_owner->dataAboutToChange(m_owner);
+	int old_rows = rowCount();
 	if (dest_start+1-rowCount() > 1)
 		m_validity.setValue(Interval<int>(rowCount(), dest_start-1), true);
 	if (dest_start + num_rows > rowCount())
@@ -536,8 +548,7 @@ bool Column::Private::copy(const Private * source, int source_start, int dest_st
 		case SciDAVis::TypeDouble:
 			{
 				double * ptr = static_cast< QVector<double>* >(m_data)->data();
-				for(int i=0; i<num_rows; i++)
-					ptr[dest_start+i] = source->valueAt(source_start + i);
+				source->valuesAt(source_start, num_rows, ptr + dest_start);
 				break;
 			}
 		case SciDAVis::TypeQString:
@@ -550,16 +561,30 @@ bool Column::Private::copy(const Private * source, int source_start, int dest_st
 				break;
 	}
 	// copy the validity information
-	for(int i=0; i<num_rows; i++)
-		setInvalid(dest_start+i, source->isInvalid(source_start+i));
+	copyValidity(source->invalidIntervals(), source_start, dest_start, num_rows);
 
+	logChange(qMin(old_rows, dest_start), dest_start+num_rows-1);
 	emit m_owner->dataChanged(m_owner);
 
 	return true;
 }
 
+void Column::Private::copyValidity(const QList< Interval<int> >& source_invalid, int source_start, int dest_start, int num_rows)
+{
+	Interval<int> source_rows(source_start, source_start+num_rows-1);
+	m_validity.setValue(Interval<int>(dest_start, dest_start+num_rows-1), false);
+	foreach(Interval<int> iv, source_invalid)
+	{
+		Interval<int> part = Interval<int>::intersection(iv, source_rows);
+		if (!part.isValid()) continue;
+		part.translate(dest_start - source_start);
+		m_validity.setValue(part, true);
+	}
+}
+
 int Column::Private::rowCount() const
 {
+	if (dataPending()) return m_pending_rows;
 	switch(m_data_type)
 	{
 		case SciDAVis::TypeDouble:
@@ -575,9 +600,14 @@ int Column::Private::rowCount() const
 
 void Column::Private::resizeTo(int new_size)
 {
+	releasePendingData();
 	int old_size = rowCount();
 	if (new_size == old_size) return;
+	resizeData(old_size, new_size);
+}
 
+void Column::Private::resizeData(int old_size, int new_size)
+{
 	switch(m_data_type)
 	{
 		case SciDAVis::TypeDouble:
@@ -618,6 +648,7 @@ void Column::Private::resizeTo(int new_size)
 
 void Column::Private::insertRows(int before, int count)
 {
+	releasePendingData();
 	if (count == 0) return;
 
 	emit m_owner->rowsAboutToBeInserted(m_owner, before, count);
@@ -642,12 +673,14 @@ void Column::Private::insertRows(int before, int count)
 					static_cast< QStringList* >(m_data)->insert(before, QString());
 				break;
 		}
+		logChange(before, rowCount()-1);
 	}
 	emit m_owner->rowsInserted(m_owner, before, count);
 }
 
 void Column::Private::removeRows(int first, int count)
 {
+	releasePendingData();
 	if (count == 0) return;
 
 	emit m_owner->rowsAboutToBeRemoved(m_owner, first, count);
@@ -657,6 +690,7 @@ void Column::Private::removeRows(int first, int count)
 
 	if (first < rowCount()) 
 	{
+		logChange(first, rowCount()-1);
 		int corrected_count = count;
 		if (first + count > rowCount()) 
 			corrected_count = rowCount() - first;
@@ -679,6 +713,113 @@ void Column::Private::removeRows(int first, int count)
 	emit m_owner->rowsRemoved(m_owner, first, count);
 }
 
+//! Last row covered by 'attribute', or -1
+static int attributeEnd(const IntervalAttribute<bool>& attribute)
+{
+	int end = -1;
+	foreach(Interval<int> i, attribute.intervals())
+		end = qMax(end, i.end());
+	return end;
+}
+
+//! Return the set rows of 'attribute' after reordering as in Column::Private::permuteRows()
+static IntervalAttribute<bool> permutedAttribute(const IntervalAttribute<bool>& attribute, const QVector<int>& permutation)
+{
+	QList< Interval<int> > intervals = attribute.intervals();
+	if (intervals.isEmpty())
+		return attribute;
+
+	int count = permutation.size();
+	IntervalAttribute<bool> result;
+	int start = -1;
+	for (int row=0; row<=count; row++)
+	{
+		bool set = row < count && attribute.isSet(permutation.at(row));
+		if (set && start < 0)
+			start = row;
+		else if (!set && start >= 0)
+		{
+			result.setValue(Interval<int>(start, row-1), true);
+			start = -1;
+		}
+	}
+	// rows behind the permuted range keep their state
+	foreach(Interval<int> i, intervals)
+		if (i.end() >= count)
+			result.setValue(Interval<int>(qMax(i.start(), count), i.end()), true);
+	return result;
+}
+
+void Column::Private::permuteRows(const QVector<int>& permutation)
+{
+	releasePendingData();
+	int count = permutation.size();
+	Q_ASSERT(count <= rowCount());
+	if (count < 2) return;
+
+	emit m_owner->dataAboutToChange(m_owner);
+	switch(m_data_type)
+	{
+		case SciDAVis::TypeDouble:
+			{
+				QVector<double> * values = static_cast< QVector<double>* >(m_data);
+				QVector<double> result(*values);
+				const double * source = values->constData();
+				double * dest = result.data();
+				for (int i=0; i<count; i++)
+					dest[i] = source[permutation.at(i)];
+				*values = result;
+				break;
+			}
+		case SciDAVis::TypeQString:
+			{
+				QStringList * texts = static_cast< QStringList* >(m_data);
+				QStringList result;
+				for (int i=0; i<count; i++)
+					result << texts->at(permutation.at(i));
+				result += texts->mid(count);
+				*texts = result;
+				break;
+			}
+		case SciDAVis::TypeQDateTime:
+			{
+				QList<QDateTime> * date_times = static_cast< QList<QDateTime>* >(m_data);
+				QList<QDateTime> result;
+				for (int i=0; i<count; i++)
+					result << date_times->at(permutation.at(i));
+				result += date_times->mid(count);
+				*date_times = result;
+				break;
+			}
+	}
+	m_validity = permutedAttribute(m_validity, permutation);
+
+	if (!m_formulas.intervals().isEmpty())
+	{
+		IntervalAttribute<QString> formulas;
+		for (int i=0; i<count; i++)
+		{
+			QString formula = m_formulas.value(permutation.at(i));
+			if (!formula.isEmpty())
+				formulas.setValue(i, formula);
+		}
+		foreach(Interval<int> i, m_formulas.intervals())
+			if (i.end() >= count)
+				formulas.setValue(Interval<int>(qMax(i.start(), count), i.end()), m_formulas.value(i.end()));
+		m_formulas = formulas;
+	}
+	logChange(0, count-1);
+	emit m_owner->dataChanged(m_owner);
+
+	if (!m_masking.intervals().isEmpty())
+	{
+		emit m_owner->maskingAboutToChange(m_owner);
+		m_masking = permutedAttribute(m_masking, permutation);
+		logChange(0, count-1);
+		emit m_owner->maskingChanged(m_owner);
+	}
+}
+
 void Column::Private::setPlotDesignation(SciDAVis::PlotDesignation pd)
 {
 	emit m_owner->plotDesignationAboutToChange(m_owner);
@@ -701,6 +842,7 @@ void Column::Private::clear()
 void Column::Private::clearValidity()
 {
 	emit m_owner->dataAboutToChange(m_owner);	
+	logChange(0, attributeEnd(m_validity));
 	m_validity.clear();
 	emit m_owner->dataChanged(m_owner);	
 }
@@ -708,6 +850,7 @@ void Column::Private::clearValidity()
 void Column::Private::clearMasks()
 {
 	emit m_owner->maskingAboutToChange(m_owner);	
+	logChange(0, attributeEnd(m_masking));
 	m_masking.clear();
 	emit m_owner->maskingChanged(m_owner);	
 }
@@ -716,6 +859,7 @@ void Column::Private::setInvalid(Interval<int> i, bool invalid)
 {
 	emit m_owner->dataAboutToChange(m_owner);	
 	m_validity.setValue(i, invalid);
+	logChange(i.start(), i.end());
 	emit m_owner->dataChanged(m_owner);	
 }
 
@@ -728,6 +872,7 @@ void Column::Private::setMasked(Interval<int> i, bool mask)
 {
 		emit m_owner->maskingAboutToChange(m_owner);	
 		m_masking.setValue(i, mask);
+		logChange(i.start(), i.end());
 		emit m_owner->maskingChanged(m_owner);	
 }
 
@@ -754,6 +899,7 @@ void Column::Private::clearFormulas()
 QString Column::Private::textAt(int row) const
 {
 	if (m_data_type != SciDAVis::TypeQString) return QString();
+	loadPendingData();
 	return static_cast< QStringList* >(m_data)->value(row);
 }
 
@@ -770,20 +916,60 @@ QTime Column::Private::timeAt(int row) const
 QDateTime Column::Private::dateTimeAt(int row) const
 {
 	if (m_data_type != SciDAVis::TypeQDateTime) return QDateTime();
+	loadPendingData();
 	return static_cast< QList<QDateTime>* >(m_data)->value(row);
 }
 
 double Column::Private::valueAt(int row) const
 {
 	if (m_data_type != SciDAVis::TypeDouble) return 0.0;
+	if (m_paged_data) return m_paged_data->value(row);
+	loadPendingData();
 	return static_cast< QVector<double>* >(m_data)->value(row);
 }
 
+const double * Column::Private::rawValues() const
+{
+	if (m_data_type != SciDAVis::TypeDouble) return 0;
+	if (m_paged_data)
+	{
+		if (m_paged_data->mappedData()) return m_paged_data->mappedData();
+		// don't read the whole column; valuesAt() goes through the PageCache instead
+		if (dataPending()) return 0;
+	}
+	loadPendingData();
+	return static_cast< QVector<double>* >(m_data)->constData();
+}
+
+void Column::Private::valuesAt(int first, int count, double * buffer) const
+{
+	if (m_data_type != SciDAVis::TypeDouble)
+	{
+		for(int i=0; i<count; i++)
+			buffer[i] = 0.0;
+		return;
+	}
+	if (m_paged_data)
+	{
+		m_paged_data->values(first, count, buffer);
+		return;
+	}
+	loadPendingData();
+	const QVector<double> * values = static_cast< QVector<double>* >(m_data);
+	if (first >= 0 && first + count <= values->size())
+		memmove(buffer, values->constData() + first, count * sizeof(double));
+	else
+		for(int i=0; i<count; i++)
+			buffer[i] = values->value(first + i);
+}
+
 void Column::Private::setTextAt(int row, const QString& new_value)
 {
 	if (m_data_type != SciDAVis::TypeQString) return;
+	releasePendingData();
 
 	emit m_owner->dataAboutToChange(m_owner);
+	logChange(qMin(row, rowCount()), row);
 	if (row >= rowCount())
 	{	
 		if (row+1-rowCount() > 1) // we are adding more than one row in resizeTo()
@@ -799,9 +985,11 @@ void Column::Private::setTextAt(int row, const QString& new_value)
 void Column::Private::replaceTexts(int first, const QStringList& new_values)
 {
 	if (m_data_type != SciDAVis::TypeQString) return;
+	releasePendingData();
 	
 	emit m_owner->dataAboutToChange(m_owner);
 	int num_rows = new_values.size();
+	logChange(qMin(first, rowCount()), first+num_rows-1);
 	if (first+1-rowCount() > 1)
 		m_validity.setValue(Interval<int>(rowCount(), first-1), true);
 	if (first + num_rows > rowCount())
@@ -830,8 +1018,10 @@ void Column::Private::setTimeAt(int row, const QTime& new_value)
 void Column::Private::setDateTimeAt(int row, const QDateTime& new_value)
 {
 	if (m_data_type != SciDAVis::TypeQDateTime) return;
+	releasePendingData();
 
 	emit m_owner->dataAboutToChange(m_owner);
+	logChange(qMin(row, rowCount()), row);
 	if (row >= rowCount())
 	{	
 		if (row+1-rowCount() > 1) // we are adding more than one row in resizeTo()
@@ -847,9 +1037,11 @@ void Column::Private::setDateTimeAt(int row, const QDateTime& new_value)
 void Column::Private::replaceDateTimes(int first, const QList<QDateTime>& new_values)
 {
 	if (m_data_type != SciDAVis::TypeQDateTime) return;
+	releasePendingData();
 	
 	emit m_owner->dataAboutToChange(m_owner);
 	int num_rows = new_values.size();
+	logChange(qMin(first, rowCount()), first+num_rows-1);
 	if (first+1-rowCount() > 1)
 		m_validity.setValue(Interval<int>(rowCount(), first-1), true);
 	if (first + num_rows > rowCount())
@@ -864,8 +1056,10 @@ void Column::Private::replaceDateTimes(int first, const QList<QDateTime>& new_va
 void Column::Private::setValueAt(int row, double new_value)
 {
 	if (m_data_type != SciDAVis::TypeDouble) return;
+	releasePendingData();
 
 	emit m_owner->dataAboutToChange(m_owner);
+	logChange(qMin(row, rowCount()), row);
 	if (row >= rowCount())
 	{	
 		if (row+1-rowCount() > 1) // we are adding more than one row in resizeTo()
@@ -881,9 +1075,11 @@ void Column::Private::setValueAt(int row, double new_value)
 void Column::Private::replaceValues(int first, const QVector<double>& new_values)
 {
 	if (m_data_type != SciDAVis::TypeDouble) return;
+	releasePendingData();
 	
 	emit m_owner->dataAboutToChange(m_owner);
 	int num_rows = new_values.size();
+	logChange(qMin(first, rowCount()), first+num_rows-1);
 	if (first+1-rowCount() > 1)
 		m_validity.setValue(Interval<int>(rowCount(), first-1), true);
 	if (first + num_rows > rowCount())
@@ -896,9 +1092,114 @@ void Column::Private::replaceValues(int first, const QVector<double>& new_values
 	emit m_owner->dataChanged(m_owner);
 }
 
+void Column::Private::logChange(int first, int last)
+{
+	// empty intervals are logged, too, so that each revision has an entry
+	m_revision++;
+	m_changes << Interval<int>(first, last);
+	while (m_changes.size() > ChangeLogSize)
+		m_changes.removeFirst();
+}
+
+bool Column::Private::changedRows(int revision, QList< Interval<int> > *rows) const
+{
+	int count = m_revision - revision;
+	if (count < 0 || count > m_changes.size())
+		return false;
+	for (int i=m_changes.size()-count; i<m_changes.size(); i++)
+		if (m_changes.at(i).isValid())
+			*rows << m_changes.at(i);
+	return true;
+}
+
+void * Column::Private::dataPointer() const
+{
+	releasePendingData();
+	return m_data;
+}
+
+void Column::Private::setPendingData(const ArchiveBlock & block, int rows)
+{
+	emit m_owner->dataAboutToChange(m_owner);
+	discardPendingData();
+	m_pending_data = block;
+	m_pending_rows = rows;
+	if (m_data_type == SciDAVis::TypeDouble && !block.isCompressed() && block.size() == qint64(rows) * qint64(sizeof(double)))
+	{
+		PageCache::instance()->setBudget(qint64(Column::global("page_cache_size").toInt()) << 20);
+		m_paged_data = new PagedDoubleData(block, Column::global("map_project_files").toBool());
+	}
+	m_data_pending.fetchAndStoreOrdered(block.isNull() ? 0 : 1);
+	logChange(0, qMax(m_pending_rows, rowCount())-1);
+	emit m_owner->dataChanged(m_owner);
+}
+
+void Column::Private::discardPendingData()
+{
+	QMutexLocker locker(&m_pending_mutex);
+	m_data_pending.fetchAndStoreRelease(0);
+	m_pending_data = ArchiveBlock();
+	delete m_paged_data;
+	m_paged_data = 0;
+}
+
+void Column::Private::releasePendingData() const
+{
+	loadPendingData();
+	if (!m_paged_data) return;
+	QMutexLocker locker(&m_pending_mutex);
+	delete m_paged_data;
+	m_paged_data = 0;
+}
+
+void Column::Private::readPendingData() const
+{
+	QMutexLocker locker(&m_pending_mutex);
+	// another thread may have read the data while we were waiting
+	if (!dataPending()) return;
+
+	if (m_paged_data)
+	{
+		// the data may well be in memory already; other threads keep reading m_paged_data
+		QVector<double> * values = static_cast< QVector<double>* >(m_data);
+		values->resize(m_paged_data->size());
+		m_paged_data->values(0, values->size(), values->data());
+		m_pending_data = ArchiveBlock();
+		m_data_pending.fetchAndStoreRelease(0);
+		return;
+	}
+
+	QByteArray bytes = m_pending_data.read();
+	if (bytes.isEmpty() && m_pending_data.size() > 0)
+		qWarning() << "Could not read the data of column" << name() << "from the project file.";
+	m_pending_data = ArchiveBlock();
+
+	int read_rows = 0;
+	switch(m_data_type)
+	{
+		case SciDAVis::TypeDouble:
+			*static_cast< QVector<double>* >(m_data) = ProjectArchive::decodeDoubles(bytes);
+			read_rows = static_cast< QVector<double>* >(m_data)->size();
+			break;
+		case SciDAVis::TypeQString:
+			*static_cast< QStringList* >(m_data) = ProjectArchive::decodeStrings(bytes);
+			read_rows = static_cast< QStringList* >(m_data)->size();
+			break;
+		case SciDAVis::TypeQDateTime:
+			*static_cast< QList<QDateTime>* >(m_data) = ProjectArchive::decodeDateTimes(bytes);
+			read_rows = static_cast< QList<QDateTime>* >(m_data)->size();
+			break;
+	}
+	// don't trust the file on the number of rows
+	if (read_rows != m_pending_rows)
+		const_cast<Private *>(this)->resizeData(read_rows, m_pending_rows);
+	m_data_pending.fetchAndStoreRelease(0);
+}
+
 void Column::Private::replaceMasking(IntervalAttribute<bool> masking)
 {
 	emit m_owner->maskingAboutToChange(m_owner);
+	logChange(0, qMax(attributeEnd(m_masking), attributeEnd(masking)));
 	m_masking = masking;
 	emit m_owner->maskingChanged(m_owner);
 }
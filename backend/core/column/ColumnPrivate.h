@@ -31,7 +31,11 @@
 #define COLUMNPRIVATE_H
 
 #include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
 #include "lib/IntervalAttribute.h"
+#include "lib/ProjectArchive.h"
+#include "lib/PagedDoubleData.h"
 #include "core/column/Column.h"
 class AbstractSimpleFilter;
 class QString;
@@ -129,10 +133,20 @@ class Column::Private
 		void insertRows(int before, int count);
 		//! Remove 'count' rows starting from row 'first'
 		void removeRows(int first, int count);
+		//! Reorder the rows 0 to permutation.size()-1
+		/**
+		 * Afterwards, row i contains the value, validity, masking and formula
+		 * that row permutation.at(i) had before. 'permutation' must contain
+		 * each of these rows exactly once and must not be longer than rowCount().
+		 * Rows behind the permuted range are not touched.
+		 */
+		void permuteRows(const QVector<int>& permutation);
 		//! Return the column name
 		const QString name() const {
 			return m_owner->name();
 		}
+		//! Return the column this object belongs to
+		Column * owner() const { return m_owner; }
 		//! Return the column plot designation
 		SciDAVis::PlotDesignation plotDesignation() const { return m_plot_designation; };
 		//! Set the column plot designation
@@ -144,7 +158,25 @@ class Column::Private
 		//! Clear the whole column
 		void clear();
 		//! Return the data pointer
-		void * dataPointer() const { return m_data; }
+		void * dataPointer() const;
+		//! Use the contents of 'block' as data, but don't read them before they're needed
+		/**
+		 * Used for loading binary projects, see ProjectArchive. 'rows' is reported by rowCount()
+		 * until the data is actually read (which happens on the first access to it).
+		 *
+		 * Uncompressed numeric data is not even read then: valueAt() and valuesAt() use a
+		 * PagedDoubleData on the block (depending on the global settings "map_project_files"
+		 * and "page_cache_size", in MiB), and rawValues() only returns the mapped file.
+		 * Only changing the data or accessing dataPointer() reads it into memory, which
+		 * usually happens through a column command.
+		 */
+		void setPendingData(const ArchiveBlock & block, int rows);
+		//! Read data attached by setPendingData() before changing it
+		/**
+		 * Also drops the PagedDoubleData, which would not reflect the changes. Only call
+		 * this from the thread owning the column.
+		 */
+		void releasePendingData() const;
 		//! Return the input filter (for string -> data type conversion)
 		AbstractSimpleFilter* inputFilter() const { return m_input_filter; }
 		//! Return the output filter (for data type -> string  conversion)
@@ -283,6 +315,13 @@ class Column::Private
 		void replaceDateTimes(int first, const QList<QDateTime>& new_values);
 		//! Return the double value in row 'row'
 		double valueAt(int row) const;
+		//! Return a pointer to the contiguous double storage
+		/**
+		 * Returns 0 if dataType() is not double or the values are only available page by page.
+		 */
+		const double * rawValues() const;
+		//! Copy the values of rows first..first+count-1 into 'buffer'
+		void valuesAt(int first, int count, double * buffer) const;
 		//! Set the content of row 'row'
 		/**
 		 * Use this only when dataType() is double
@@ -295,7 +334,39 @@ class Column::Private
 		void replaceValues(int first, const QVector<double>& new_values);
 		//@}
 
+		//! \name Change tracking
+		//@{
+		//! Number of changes of cells, validity or masking so far
+		int revision() const { return m_revision; }
+		//! Append the rows changed after 'revision' to 'rows'
+		/**
+		 * Removed and inserted rows count as changes of all rows behind them. Only the
+		 * last ChangeLogSize changes are remembered; returns false if the changes since
+		 * 'revision' are not known any more.
+		 */
+		bool changedRows(int revision, QList< Interval<int> > *rows) const;
+		//@}
+
 	private:
+		//! Read data attached by setPendingData(), if necessary
+		/**
+		 * Safe to call from several threads at once; PagedDoubleData stays available to readers.
+		 */
+		void loadPendingData() const { if (dataPending()) readPendingData(); }
+		//! Whether m_pending_data has yet to be read; once false, the data read is visible
+		bool dataPending() const { return !m_data_pending.testAndSetAcquire(0, 0); }
+		void readPendingData() const;
+		//! Resize m_data from 'old_size' to 'new_size' rows, without notifications
+		void resizeData(int old_size, int new_size);
+		//! Forget about data attached by setPendingData()
+		void discardPendingData();
+		//! Copy the validity of 'num_rows' rows given the invalid intervals of the source
+		void copyValidity(const QList< Interval<int> >& source_invalid, int source_start, int dest_start, int num_rows);
+		//! Record a change of rows first..last (see changedRows())
+		void logChange(int first, int last);
+		//! Number of changes kept for changedRows()
+		static const int ChangeLogSize = 64;
+
 		//! \name data members
 		//@{
 		//! Data type string
@@ -328,6 +399,24 @@ class Column::Private
 		int m_width;
 		//! The owner column
 		Column * m_owner;
+		//! Data not read yet, see setPendingData()
+		mutable ArchiveBlock m_pending_data;
+		//! Number of rows in m_pending_data
+		int m_pending_rows;
+		//! Read-only access to m_pending_data, if it contains uncompressed doubles
+		mutable PagedDoubleData * m_paged_data;
+		//! Non-zero while m_pending_data has yet to be read into m_data
+		/**
+		 * Cleared with release semantics after m_data has been filled, so threads seeing it
+		 * cleared through dataPending() also see the data.
+		 */
+		mutable QAtomicInt m_data_pending;
+		//! Serializes readPendingData()
+		mutable QMutex m_pending_mutex;
+		//! See revision()
+		int m_revision;
+		//! Rows touched by the last (up to ChangeLogSize) revisions, oldest first
+		QList< Interval<int> > m_changes;
 		//@}
 		
 };
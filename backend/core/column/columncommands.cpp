@@ -30,6 +30,74 @@
 #include "ColumnPrivate.h"
 #include "columncommands.h"
 
+//! Move the data of the backup column 'backup' of 'col' into 'payload'
+/**
+ * Backup columns are only needed while a command is executed or undone. In between, their
+ * data is kept in an UndoPayload, so it counts against the undo memory budget.
+ */
+static void storeBackup(Column::Private * col, Column::Private * backup, UndoPayload & payload)
+{
+	const QUndoStack * stack = col->owner()->undoStack();
+	switch(backup->dataType())
+	{
+		case SciDAVis::TypeDouble:
+			{
+				QVector<double> * data = static_cast< QVector<double>* >(backup->dataPointer());
+				payload.setValues(*data, stack);
+				data->clear();
+				break;
+			}
+		case SciDAVis::TypeQString:
+			{
+				QStringList * data = static_cast< QStringList* >(backup->dataPointer());
+				payload.setTexts(*data, stack);
+				data->clear();
+				break;
+			}
+		case SciDAVis::TypeQDateTime:
+			{
+				QList<QDateTime> * data = static_cast< QList<QDateTime>* >(backup->dataPointer());
+				payload.setDateTimes(*data, stack);
+				data->clear();
+				break;
+			}
+	}
+}
+
+//! Put the data saved by storeBackup() back into 'backup'
+static void loadBackup(Column::Private * backup, const UndoPayload & payload)
+{
+	switch(backup->dataType())
+	{
+		case SciDAVis::TypeDouble:
+			*static_cast< QVector<double>* >(backup->dataPointer()) = payload.values();
+			break;
+		case SciDAVis::TypeQString:
+			*static_cast< QStringList* >(backup->dataPointer()) = payload.texts();
+			break;
+		case SciDAVis::TypeQDateTime:
+			*static_cast< QList<QDateTime>* >(backup->dataPointer()) = payload.dateTimes();
+			break;
+	}
+}
+
+//! Drop the data loaded by loadBackup() again (it is still kept in the payload)
+static void releaseBackup(Column::Private * backup)
+{
+	switch(backup->dataType())
+	{
+		case SciDAVis::TypeDouble:
+			static_cast< QVector<double>* >(backup->dataPointer())->clear();
+			break;
+		case SciDAVis::TypeQString:
+			static_cast< QStringList* >(backup->dataPointer())->clear();
+			break;
+		case SciDAVis::TypeQDateTime:
+			static_cast< QList<QDateTime>* >(backup->dataPointer())->clear();
+			break;
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // class ColumnSetModeCmd
 ///////////////////////////////////////////////////////////////////////////
@@ -139,21 +207,25 @@ void ColumnFullCopyCmd::redo()
 	}
 	else
 	{
+		loadBackup(m_backup, m_backup_data);
 		// swap data + validity of orig. column and backup
 		IntervalAttribute<bool> val_temp = m_col->invalidIntervals();
 		void * data_temp = m_col->dataPointer();
 		m_col->replaceData(m_backup->dataPointer(), m_backup->validityAttribute());
 		m_backup->replaceData(data_temp, val_temp);
 	}
+	storeBackup(m_col, m_backup, m_backup_data);
 }
 
 void ColumnFullCopyCmd::undo()
 {
+	loadBackup(m_backup, m_backup_data);
 	// swap data + validity of orig. column and backup
 	IntervalAttribute<bool> val_temp = m_col->validityAttribute();
 	void * data_temp = m_col->dataPointer();
 	m_col->replaceData(m_backup->dataPointer(), m_backup->validityAttribute());
 	m_backup->replaceData(data_temp, val_temp);
+	storeBackup(m_col, m_backup, m_backup_data);
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -190,13 +262,22 @@ void ColumnPartialCopyCmd::redo()
 		m_col_backup->copy(m_col, m_dest_start, 0, m_num_rows);
 		m_old_row_count = m_col->rowCount();
 		m_old_validity = m_col->validityAttribute();
+		storeBackup(m_col, m_col_backup, m_col_backup_data);
 	}
+	else
+		loadBackup(m_src_backup, m_src_backup_data);
 	m_col->copy(m_src_backup, 0, m_dest_start, m_num_rows);
+	if (m_src_backup_data.isEmpty())
+		storeBackup(m_col, m_src_backup, m_src_backup_data);
+	else
+		releaseBackup(m_src_backup);
 }
 
 void ColumnPartialCopyCmd::undo()
 {
+	loadBackup(m_col_backup, m_col_backup_data);
 	m_col->copy(m_col_backup, 0, m_dest_start, m_num_rows);
+	releaseBackup(m_col_backup);
 	m_col->resizeTo(m_old_row_count);
 	m_col->replaceData(m_col->dataPointer(), m_old_validity);
 }
@@ -263,6 +344,7 @@ void ColumnRemoveRowsCmd::redo()
 		m_backup_owner = new Column("temp", m_col->columnMode());
 		m_backup = new Column::Private(m_backup_owner, m_col->columnMode()); 
 		m_backup->copy(m_col, m_first, 0, m_data_row_count);
+		storeBackup(m_col, m_backup, m_backup_data);
 		m_masking = m_col->maskingAttribute();
 		m_formulas = m_col->formulaAttribute();
 	}
@@ -272,7 +354,9 @@ void ColumnRemoveRowsCmd::redo()
 void ColumnRemoveRowsCmd::undo()
 {
 	m_col->insertRows(m_first, m_count);
+	loadBackup(m_backup, m_backup_data);
 	m_col->copy(m_backup, 0, m_first, m_data_row_count);
+	releaseBackup(m_backup);
 	m_col->resizeTo(m_old_size);
 	m_col->replaceMasking(m_masking);
 	m_col->replaceFormulas(m_formulas);
@@ -282,6 +366,36 @@ void ColumnRemoveRowsCmd::undo()
 // end of class ColumnRemoveRowsCmd
 ///////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////
+// class ColumnPermuteRowsCmd
+///////////////////////////////////////////////////////////////////////////
+ColumnPermuteRowsCmd::ColumnPermuteRowsCmd(Column::Private * col, const QVector<int>& permutation, QUndoCommand * parent )
+ : QUndoCommand( parent ), m_col(col), m_permutation(permutation)
+{
+	setText(QObject::tr("%1: reorder rows").arg(col->name()));
+}
+
+ColumnPermuteRowsCmd::~ColumnPermuteRowsCmd()
+{
+}
+
+void ColumnPermuteRowsCmd::redo()
+{
+	m_col->permuteRows(m_permutation);
+}
+
+void ColumnPermuteRowsCmd::undo()
+{
+	QVector<int> inverse(m_permutation.size());
+	for (int i=0; i<m_permutation.size(); i++)
+		inverse[m_permutation.at(i)] = i;
+	m_col->permuteRows(inverse);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// end of class ColumnPermuteRowsCmd
+///////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////
 // class ColumnSetPlotDesignationCmd
 ///////////////////////////////////////////////////////////////////////////
@@ -710,9 +824,10 @@ void ColumnSetDateTimeCmd::undo()
 // class ColumnReplaceTextsCmd
 ///////////////////////////////////////////////////////////////////////////
 ColumnReplaceTextsCmd::ColumnReplaceTextsCmd(Column::Private * col, int first, const QStringList& new_values, QUndoCommand * parent )
- : QUndoCommand( parent ), m_col(col), m_first(first), m_new_values(new_values)
+ : QUndoCommand( parent ), m_col(col), m_first(first)
 {
 	setText(QObject::tr("%1: replace the texts for rows %2 to %3").arg(col->name()).arg(first).arg(first + new_values.count() -1));
+	m_new_values.setTexts(new_values, col->owner()->undoStack());
 	m_copied = false;
 }
 
@@ -724,17 +839,18 @@ void ColumnReplaceTextsCmd::redo()
 {
 	if(!m_copied)
 	{
-		m_old_values = static_cast< QStringList* >(m_col->dataPointer())->mid(m_first, m_new_values.count());
+		m_old_values.setTexts(static_cast< QStringList* >(m_col->dataPointer())->mid(m_first, m_new_values.count()),
+				m_col->owner()->undoStack());
 		m_row_count = m_col->rowCount();
 		m_validity = m_col->validityAttribute();
 		m_copied = true;
 	}
-	m_col->replaceTexts(m_first, m_new_values);
+	m_col->replaceTexts(m_first, m_new_values.texts());
 }
 
 void ColumnReplaceTextsCmd::undo()
 {
-	m_col->replaceTexts(m_first, m_old_values);
+	m_col->replaceTexts(m_first, m_old_values.texts());
 	m_col->resizeTo(m_row_count);
 	m_col->replaceData(m_col->dataPointer(), m_validity);
 }
@@ -747,9 +863,19 @@ void ColumnReplaceTextsCmd::undo()
 // class ColumnReplaceValuesCmd
 ///////////////////////////////////////////////////////////////////////////
 ColumnReplaceValuesCmd::ColumnReplaceValuesCmd(Column::Private * col, int first, const QVector<double>& new_values, QUndoCommand * parent )
- : QUndoCommand( parent ), m_col(col), m_first(first), m_new_values(new_values)
+ : QUndoCommand( parent ), m_col(col), m_first(first)
+{
+	setText(QObject::tr("%1: replace the values for rows %2 to %3").arg(col->name()).arg(first).arg(first + new_values.count() -1));
+	m_new_values.setValues(new_values, col->owner()->undoStack());
+	m_copied = false;
+}
+
+ColumnReplaceValuesCmd::ColumnReplaceValuesCmd(Column::Private * col, int first, const QVector<double>& new_values,
+		const QList< Interval<int> >& invalid_rows, QUndoCommand * parent )
+ : QUndoCommand( parent ), m_col(col), m_first(first), m_invalid_rows(invalid_rows)
 {
 	setText(QObject::tr("%1: replace the values for rows %2 to %3").arg(col->name()).arg(first).arg(first + new_values.count() -1));
+	m_new_values.setValues(new_values, col->owner()->undoStack());
 	m_copied = false;
 }
 
@@ -761,17 +887,20 @@ void ColumnReplaceValuesCmd::redo()
 {
 	if(!m_copied)
 	{
-		m_old_values = static_cast< QVector<double>* >(m_col->dataPointer())->mid(m_first, m_new_values.count());
+		m_old_values.setValues(static_cast< QVector<double>* >(m_col->dataPointer())->mid(m_first, m_new_values.count()),
+				m_col->owner()->undoStack());
 		m_row_count = m_col->rowCount();
 		m_validity = m_col->validityAttribute();
 		m_copied = true;
 	}
-	m_col->replaceValues(m_first, m_new_values);
+	m_col->replaceValues(m_first, m_new_values.values());
+	foreach(Interval<int> i, m_invalid_rows)
+		m_col->setInvalid(i, true);
 }
 
 void ColumnReplaceValuesCmd::undo()
 {
-	m_col->replaceValues(m_first, m_old_values);
+	m_col->replaceValues(m_first, m_old_values.values());
 	m_col->resizeTo(m_row_count);
 	m_col->replaceData(m_col->dataPointer(), m_validity);
 }
@@ -784,9 +913,10 @@ void ColumnReplaceValuesCmd::undo()
 // class ColumnReplaceDateTimesCmd
 ///////////////////////////////////////////////////////////////////////////
 ColumnReplaceDateTimesCmd::ColumnReplaceDateTimesCmd(Column::Private * col, int first, const QList<QDateTime>& new_values, QUndoCommand * parent )
- : QUndoCommand( parent ), m_col(col), m_first(first), m_new_values(new_values)
+ : QUndoCommand( parent ), m_col(col), m_first(first)
 {
 	setText(QObject::tr("%1: replace the values for rows %2 to %3").arg(col->name()).arg(first).arg(first + new_values.count() -1));
+	m_new_values.setDateTimes(new_values, col->owner()->undoStack());
 	m_copied = false;
 }
 
@@ -798,17 +928,18 @@ void ColumnReplaceDateTimesCmd::redo()
 {
 	if(!m_copied)
 	{
-		m_old_values = static_cast< QList<QDateTime>* >(m_col->dataPointer())->mid(m_first, m_new_values.count());
+		m_old_values.setDateTimes(static_cast< QList<QDateTime>* >(m_col->dataPointer())->mid(m_first, m_new_values.count()),
+				m_col->owner()->undoStack());
 		m_row_count = m_col->rowCount();
 		m_validity = m_col->validityAttribute();
 		m_copied = true;
 	}
-	m_col->replaceDateTimes(m_first, m_new_values);
+	m_col->replaceDateTimes(m_first, m_new_values.dateTimes());
 }
 
 void ColumnReplaceDateTimesCmd::undo()
 {
-	m_col->replaceDateTimes(m_first, m_old_values);
+	m_col->replaceDateTimes(m_first, m_old_values.dateTimes());
 	m_col->replaceData(m_col->dataPointer(), m_validity);
 	m_col->resizeTo(m_row_count);
 }
@@ -35,6 +35,7 @@
 #include "Column.h"
 #include "core/AbstractSimpleFilter.h"
 #include "lib/IntervalAttribute.h"
+#include "lib/UndoPayload.h"
 
 ///////////////////////////////////////////////////////////////////////////
 // class ColumnSetModeCmd
@@ -121,6 +122,8 @@ private:
 	 * replacement without too much copying.
 	 */
 	Column * m_backup_owner;
+	//! The data of m_backup while it is not needed
+	UndoPayload m_backup_data;
 
 };
 ///////////////////////////////////////////////////////////////////////////
@@ -167,6 +170,10 @@ private:
 	 * Using a Column object as backup would lead to an inifinite loop.
 	 */
 	Column * m_src_backup_owner;
+	//! The data of m_col_backup while it is not needed
+	UndoPayload m_col_backup_data;
+	//! The data of m_src_backup while it is not needed
+	UndoPayload m_src_backup_data;
 	//! Start index in source column
 	int m_src_start;
 	//! Start index in destination column
@@ -250,6 +257,8 @@ private:
 	 * replacement without too much copying.
 	 */
 	Column * m_backup_owner;
+	//! The data of m_backup while it is not needed
+	UndoPayload m_backup_data;
 	//! Backup of the masking attribute
 	IntervalAttribute<bool> m_masking;
 	//! Backup of the formula attribute
@@ -259,6 +268,36 @@ private:
 // end of class ColumnRemoveRowsCmd
 ///////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////
+// class ColumnPermuteRowsCmd
+///////////////////////////////////////////////////////////////////////////
+//! Reorder the rows of a column (see Column::Private::permuteRows())
+/**
+ * Only the permutation is stored; undo applies its inverse.
+ */
+class ColumnPermuteRowsCmd : public QUndoCommand
+{
+public:
+	//! Ctor
+	ColumnPermuteRowsCmd(Column::Private * col, const QVector<int>& permutation, QUndoCommand * parent = 0 );
+	//! Dtor
+	~ColumnPermuteRowsCmd();
+
+	//! Execute the command
+	virtual void redo();
+	//! Undo the command
+	virtual void undo();
+
+private:
+	//! The private column data to modify
+	Column::Private * m_col;
+	//! Row i receives the contents of row m_permutation.at(i)
+	QVector<int> m_permutation;
+};
+///////////////////////////////////////////////////////////////////////////
+// end of class ColumnPermuteRowsCmd
+///////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////
 // class ColumnSetPlotDesignationCmd
 ///////////////////////////////////////////////////////////////////////////
@@ -675,9 +714,9 @@ private:
 	//! The first row to replace
 	int m_first;
 	//! The new values
-	QStringList m_new_values;
+	UndoPayload m_new_values;
 	//! The old values
-	QStringList m_old_values;
+	UndoPayload m_old_values;
 	//! Status flag
 	bool m_copied;
 	//! The old number of rows
@@ -699,6 +738,9 @@ class ColumnReplaceValuesCmd : public QUndoCommand
 public:
 	//! Ctor
 	ColumnReplaceValuesCmd(Column::Private * col, int first, const QVector<double>& new_values, QUndoCommand * parent = 0 );
+	//! Ctor; additionally marks the given rows as invalid
+	ColumnReplaceValuesCmd(Column::Private * col, int first, const QVector<double>& new_values,
+			const QList< Interval<int> >& invalid_rows, QUndoCommand * parent = 0 );
 	//! Dtor
 	~ColumnReplaceValuesCmd();
 
@@ -713,9 +755,11 @@ private:
 	//! The first row to replace
 	int m_first;
 	//! The new values
-	QVector<double> m_new_values;
+	UndoPayload m_new_values;
+	//! The rows to mark as invalid after replacing the values
+	QList< Interval<int> > m_invalid_rows;
 	//! The old values
-	QVector<double> m_old_values;
+	UndoPayload m_old_values;
 	//! Status flag
 	bool m_copied;
 	//! The old number of rows
@@ -751,9 +795,9 @@ private:
 	//! The first row to replace
 	int m_first;
 	//! The new values
-	QList<QDateTime> m_new_values;
+	UndoPayload m_new_values;
 	//! The old values
-	QList<QDateTime> m_old_values;
+	UndoPayload m_old_values;
 	//! Status flag
 	bool m_copied;
 	//! The old number of rows
@@ -49,6 +49,19 @@ class SimpleCopyThroughFilter : public AbstractSimpleFilter
 	Q_OBJECT
 
 	public:
+		//!\name bulk access
+		//@{
+		//! Pass the input storage through unaltered
+		virtual const double * rawValues() const { return m_inputs.value(0) ? m_inputs.at(0)->rawValues() : 0; }
+		virtual void valuesAt(int first, int count, double * buffer) const
+		{
+			if (m_inputs.value(0))
+				m_inputs.at(0)->valuesAt(first, count, buffer);
+			else
+				AbstractSimpleFilter::valuesAt(first, count, buffer);
+		}
+		//@}
+
 		//!\name Masking
 		//@{
 		//! Return whether a certain row is masked
@@ -0,0 +1,788 @@
+/***************************************************************************
+    File                 : FourierTransform.cpp
+    Project              : SciDAVis
+    Description          : Fast Fourier transforms with shared, cached plans
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "lib/FourierTransform.h"
+#include "lib/ParallelFor.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <gsl/gsl_fft_complex.h>
+#include <gsl/gsl_fft_real.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//! Complex transforms of at least this length are split into rows and columns on several cores
+static const int PARALLEL_SIZE = 1 << 17;
+//! Lengths with a prime factor larger than this are computed with Bluestein's algorithm
+static const int BLUESTEIN_PRIME = 31;
+//! Number of unused plans kept in the cache
+static const int MAX_UNUSED_PLANS = 16;
+//! Alignment of scratch buffers, in bytes
+static const int BUFFER_ALIGNMENT = 64;
+
+//! Allocate 'count' doubles aligned to BUFFER_ALIGNMENT
+static double * alignedAlloc(int count)
+{
+	char * raw = static_cast<char*>(malloc(count * sizeof(double) + BUFFER_ALIGNMENT));
+	if (!raw) return 0;
+	// malloc aligns to at least 8 bytes, so there is room for the original pointer
+	char * aligned = raw + BUFFER_ALIGNMENT - (reinterpret_cast<quintptr>(raw) % BUFFER_ALIGNMENT);
+	reinterpret_cast<char**>(aligned)[-1] = raw;
+	return reinterpret_cast<double*>(aligned);
+}
+
+static void alignedFree(double * buffer)
+{
+	if (buffer) free(reinterpret_cast<char**>(buffer)[-1]);
+}
+
+static int largestPrimeFactor(int n)
+{
+	int result = 1;
+	for (int p=2; p*p<=n; p++)
+		while (n % p == 0)
+		{
+			result = p;
+			n /= p;
+		}
+	return qMax(result, n);
+}
+
+static QMutex cache_mutex(QMutex::Recursive);
+static QHash<qint64, FourierPlan*> cached_plans;
+static quint64 use_counter = 0;
+
+static FourierPlan * acquirePlan(int n, bool parallel);
+static void releasePlan(FourierPlan * plan);
+static bool complexTransform(FourierPlan * plan, double * data, int sign, int stride = 1);
+
+//! Everything needed for transforms of one length
+/**
+ * The complex and the real part are set up independently on first use. All members are
+ * protected by cache_mutex; the transforms themselves only read the plan.
+ */
+struct FourierPlan
+{
+	enum ComplexMethod { MixedRadix, Bluestein, FourStep };
+	enum RealMethod { RealMixedRadix, RealPacked, RealViaComplex };
+
+	FourierPlan(int length, bool threads)
+		: n(length), parallel(threads), users(0), last_use(0),
+		complex_ready(false), real_ready(false), complex_ok(false), real_ok(false),
+		complex_table(0), real_table(0), halfcomplex_table(0),
+		sub(0), sub2(0), half(0), n1(0), n2(0), m(0), chirp(0), kernel(0), twiddle(0)
+	{
+	}
+
+	~FourierPlan()
+	{
+		if (complex_table) gsl_fft_complex_wavetable_free(complex_table);
+		if (real_table) gsl_fft_real_wavetable_free(real_table);
+		if (halfcomplex_table) gsl_fft_halfcomplex_wavetable_free(halfcomplex_table);
+		foreach(gsl_fft_complex_workspace * work, complex_work)
+			gsl_fft_complex_workspace_free(work);
+		foreach(gsl_fft_real_workspace * work, real_work)
+			gsl_fft_real_workspace_free(work);
+		foreach(double * buffer, buffers)
+			alignedFree(buffer);
+		foreach(double * buffer, convolution_buffers)
+			alignedFree(buffer);
+		alignedFree(chirp);
+		alignedFree(kernel);
+		alignedFree(twiddle);
+		if (sub) releasePlan(sub);
+		if (sub2) releasePlan(sub2);
+		if (half) releasePlan(half);
+	}
+
+	//! Whether transforms with this plan start threads of their own
+	bool threaded() const { return parallel && n >= PARALLEL_SIZE; }
+
+	//! Set up the complex transforms; returns false if memory is short
+	bool initComplex()
+	{
+		QMutexLocker locker(&cache_mutex);
+		if (complex_ready) return complex_ok;
+		complex_ready = true;
+
+		if (parallel && n >= PARALLEL_SIZE)
+		{
+			// split into n1 columns of length n2 with n1 close to sqrt(n)
+			for (int d = int(sqrt(double(n))); d >= 16; d--)
+				if (n % d == 0)
+				{
+					n1 = d;
+					n2 = n / d;
+					break;
+				}
+		}
+		if (n1 > 0)
+		{
+			complex_method = FourStep;
+			sub = acquirePlan(n1, false);
+			sub2 = acquirePlan(n2, false);
+			complex_ok = sub->initComplex() && sub2->initComplex();
+		}
+		else if (n > 2 * BLUESTEIN_PRIME && largestPrimeFactor(n) > BLUESTEIN_PRIME)
+		{
+			complex_method = Bluestein;
+			m = FourierTransform::nextFastSize(2*n - 1);
+			sub = acquirePlan(m, parallel);
+			chirp = alignedAlloc(2*n);
+			kernel = alignedAlloc(2*m);
+			if (!chirp || !kernel || !sub->initComplex()) return false;
+			// c_j = exp(-i pi j^2/n); j^2 is reduced modulo 2n to keep the angle accurate
+			for (int j=0; j<n; j++)
+			{
+				double angle = -M_PI * double((qint64(j) * j) % (2 * qint64(n))) / n;
+				chirp[2*j] = cos(angle);
+				chirp[2*j+1] = sin(angle);
+			}
+			// the convolution kernel is conj(c), wrapped around; its transform is kept
+			// with the normalization of the inverse transform folded in
+			memset(kernel, 0, 2*m*sizeof(double));
+			for (int j=0; j<n; j++)
+			{
+				kernel[2*j] = chirp[2*j] / m;
+				kernel[2*j+1] = -chirp[2*j+1] / m;
+				if (j > 0)
+				{
+					kernel[2*(m-j)] = kernel[2*j];
+					kernel[2*(m-j)+1] = kernel[2*j+1];
+				}
+			}
+			// transformed by a serial plan, since worker threads would block on cache_mutex
+			FourierPlan * serial = acquirePlan(m, false);
+			complex_ok = complexTransform(serial, kernel, -1);
+			releasePlan(serial);
+		}
+		else
+		{
+			complex_method = MixedRadix;
+			complex_table = gsl_fft_complex_wavetable_alloc(n);
+			complex_ok = complex_table != 0;
+		}
+		return complex_ok;
+	}
+
+	//! Set up the real transforms; returns false if memory is short
+	bool initReal()
+	{
+		QMutexLocker locker(&cache_mutex);
+		if (real_ready) return real_ok;
+		real_ready = true;
+
+		bool awkward = largestPrimeFactor(n) > BLUESTEIN_PRIME && n > 2 * BLUESTEIN_PRIME;
+		if (n % 2 == 0 && n >= 4 && (awkward || (parallel && n >= 2 * PARALLEL_SIZE)))
+		{
+			real_method = RealPacked;
+			half = acquirePlan(n/2, parallel);
+			twiddle = alignedAlloc(n);
+			if (!twiddle || !half->initComplex()) return false;
+			for (int k=0; k<n/2; k++)
+			{
+				twiddle[2*k] = cos(-2 * M_PI * k / n);
+				twiddle[2*k+1] = sin(-2 * M_PI * k / n);
+			}
+			real_ok = true;
+		}
+		else if (awkward)
+		{
+			real_method = RealViaComplex;
+			real_ok = initComplex();
+		}
+		else
+		{
+			real_method = RealMixedRadix;
+			real_table = gsl_fft_real_wavetable_alloc(n);
+			halfcomplex_table = gsl_fft_halfcomplex_wavetable_alloc(n);
+			real_ok = real_table && halfcomplex_table;
+		}
+		return real_ok;
+	}
+
+	gsl_fft_complex_workspace * takeComplexWorkspace()
+	{
+		QMutexLocker locker(&cache_mutex);
+		return complex_work.isEmpty() ? gsl_fft_complex_workspace_alloc(n) : complex_work.takeLast();
+	}
+
+	gsl_fft_real_workspace * takeRealWorkspace()
+	{
+		QMutexLocker locker(&cache_mutex);
+		return real_work.isEmpty() ? gsl_fft_real_workspace_alloc(n) : real_work.takeLast();
+	}
+
+	//! Take a scratch buffer of 2*n doubles
+	double * takeBuffer()
+	{
+		QMutexLocker locker(&cache_mutex);
+		return buffers.isEmpty() ? alignedAlloc(2*n) : buffers.takeLast();
+	}
+
+	//! Take a scratch buffer of 2*m doubles for the Bluestein convolution
+	double * takeConvolutionBuffer()
+	{
+		QMutexLocker locker(&cache_mutex);
+		return convolution_buffers.isEmpty() ? alignedAlloc(2*m) : convolution_buffers.takeLast();
+	}
+
+	void give(gsl_fft_complex_workspace * work)
+	{
+		QMutexLocker locker(&cache_mutex);
+		if (work) complex_work << work;
+	}
+
+	void give(gsl_fft_real_workspace * work)
+	{
+		QMutexLocker locker(&cache_mutex);
+		if (work) real_work << work;
+	}
+
+	void give(double * buffer)
+	{
+		QMutexLocker locker(&cache_mutex);
+		if (buffer) buffers << buffer;
+	}
+
+	void giveConvolutionBuffer(double * buffer)
+	{
+		QMutexLocker locker(&cache_mutex);
+		if (buffer) convolution_buffers << buffer;
+	}
+
+	int n;
+	bool parallel;
+	int users;
+	quint64 last_use;
+	bool complex_ready, real_ready, complex_ok, real_ok;
+	ComplexMethod complex_method;
+	RealMethod real_method;
+
+	//! GSL tables (mixed-radix methods)
+	gsl_fft_complex_wavetable * complex_table;
+	gsl_fft_real_wavetable * real_table;
+	gsl_fft_halfcomplex_wavetable * halfcomplex_table;
+	//! Pools of workspaces and scratch buffers
+	/**
+	 * The buffers are kept apart by size: the real transforms may set up a plan before
+	 * its complex part switches to Bluestein and m becomes known.
+	 */
+	QList<gsl_fft_complex_workspace*> complex_work;
+	QList<gsl_fft_real_workspace*> real_work;
+	QList<double*> buffers, convolution_buffers;
+
+	//! Plans used by Bluestein (sub, length m) and FourStep (sub: n1, sub2: n2)
+	FourierPlan * sub, * sub2;
+	//! Complex plan of length n/2 (RealPacked)
+	FourierPlan * half;
+	int n1, n2, m;
+	//! Bluestein chirp exp(-i pi j^2/n) and transformed convolution kernel
+	double * chirp, * kernel;
+	//! exp(-2 pi i k/n) for k < n/2 (RealPacked)
+	double * twiddle;
+};
+
+//! Drop unused plans until at most 'keep' of them are left, oldest first
+static void trimCache(int keep)
+{
+	QMutexLocker locker(&cache_mutex);
+	static bool trimming = false;
+	if (trimming) return;
+	trimming = true;
+	forever
+	{
+		int unused = 0;
+		FourierPlan * oldest = 0;
+		foreach(FourierPlan * plan, cached_plans)
+			if (plan->users == 0)
+			{
+				unused++;
+				if (!oldest || plan->last_use < oldest->last_use)
+					oldest = plan;
+			}
+		if (unused <= keep) break;
+		cached_plans.remove((qint64(oldest->n) << 1) | (oldest->parallel ? 1 : 0));
+		delete oldest; // may release sub plans, which become candidates in the next round
+	}
+	trimming = false;
+}
+
+static FourierPlan * acquirePlan(int n, bool parallel)
+{
+	QMutexLocker locker(&cache_mutex);
+#if QT_VERSION >= 0x040300
+	parallel = parallel && QThread::idealThreadCount() > 1;
+#else
+	parallel = false;
+#endif
+	qint64 key = (qint64(n) << 1) | (parallel ? 1 : 0);
+	FourierPlan * plan = cached_plans.value(key);
+	if (!plan)
+	{
+		plan = new FourierPlan(n, parallel);
+		cached_plans.insert(key, plan);
+	}
+	plan->users++;
+	plan->last_use = ++use_counter;
+	return plan;
+}
+
+static void releasePlan(FourierPlan * plan)
+{
+	QMutexLocker locker(&cache_mutex);
+	plan->users--;
+	trimCache(MAX_UNUSED_PLANS);
+}
+
+//! Transforms the columns of a four-step transform (n1 points, stride n2)
+class FourStepColumnsKernel
+{
+	public:
+		FourStepColumnsKernel(FourierPlan * plan, double * data, int sign)
+			: m_plan(plan), m_data(data), m_sign(sign) {}
+		void operator()(int first, int last) const
+		{
+			for (int j2=first; j2<=last; j2++)
+				complexTransform(m_plan->sub, m_data + 2*j2, m_sign, m_plan->n2);
+		}
+
+	private:
+		FourierPlan * m_plan;
+		double * m_data;
+		int m_sign;
+};
+
+//! Applies the twiddle factors to the rows of a four-step transform and transforms them
+class FourStepRowsKernel
+{
+	public:
+		FourStepRowsKernel(FourierPlan * plan, double * data, int sign)
+			: m_plan(plan), m_data(data), m_sign(sign) {}
+		void operator()(int first, int last) const
+		{
+			int n = m_plan->n, n2 = m_plan->n2;
+			for (int k1=first; k1<=last; k1++)
+			{
+				double * row = m_data + 2*k1*n2;
+				// w^(j2*k1) by recurrence, recomputed exactly every 64 points
+				double step_angle = m_sign * 2 * M_PI * k1 / n;
+				double step_re = cos(step_angle), step_im = sin(step_angle);
+				double w_re = 1, w_im = 0;
+				for (int j2=0; j2<n2; j2++)
+				{
+					if ((j2 & 63) == 0)
+					{
+						double angle = m_sign * 2 * M_PI * double((qint64(j2) * k1) % n) / n;
+						w_re = cos(angle);
+						w_im = sin(angle);
+					}
+					double re = row[2*j2], im = row[2*j2+1];
+					row[2*j2] = re * w_re - im * w_im;
+					row[2*j2+1] = re * w_im + im * w_re;
+					double next_re = w_re * step_re - w_im * step_im;
+					w_im = w_re * step_im + w_im * step_re;
+					w_re = next_re;
+				}
+				complexTransform(m_plan->sub2, row, m_sign);
+			}
+		}
+
+	private:
+		FourierPlan * m_plan;
+		double * m_data;
+		int m_sign;
+};
+
+//! Transposes the n1 x n2 result of a four-step transform into 'out'
+class FourStepTransposeKernel
+{
+	public:
+		FourStepTransposeKernel(const FourierPlan * plan, const double * data, double * out)
+			: m_plan(plan), m_data(data), m_out(out) {}
+		void operator()(int first, int last) const
+		{
+			int n1 = m_plan->n1, n2 = m_plan->n2;
+			for (int k1=first; k1<=last; k1++)
+				for (int k2=0; k2<n2; k2++)
+				{
+					m_out[2*(k1 + n1*k2)] = m_data[2*(k1*n2 + k2)];
+					m_out[2*(k1 + n1*k2)+1] = m_data[2*(k1*n2 + k2)+1];
+				}
+		}
+
+	private:
+		const FourierPlan * m_plan;
+		const double * m_data;
+		double * m_out;
+};
+
+//! Unnormalized complex transform (sign -1: forward, +1: backward) of n points at 'stride'
+static bool complexTransform(FourierPlan * plan, double * data, int sign, int stride)
+{
+	if (!plan->initComplex()) return false;
+	int n = plan->n;
+
+	switch (plan->complex_method)
+	{
+		case FourierPlan::MixedRadix:
+			{
+				gsl_fft_complex_workspace * work = plan->takeComplexWorkspace();
+				if (!work) return false;
+				gsl_fft_complex_transform(data, stride, n, plan->complex_table, work,
+						sign < 0 ? gsl_fft_forward : gsl_fft_backward);
+				plan->give(work);
+				return true;
+			}
+
+		case FourierPlan::Bluestein:
+			{
+				// X_k = c_k sum_j (x_j c_j) conj(c_{k-j}); the backward transform is
+				// computed as conj(forward(conj(x)))
+				int m = plan->m;
+				double conj = sign < 0 ? 1 : -1;
+				double * a = plan->takeConvolutionBuffer();
+				if (!a) return false;
+				const double * c = plan->chirp;
+				for (int j=0; j<n; j++)
+				{
+					double re = data[2*j*stride], im = conj * data[2*j*stride+1];
+					a[2*j] = re * c[2*j] - im * c[2*j+1];
+					a[2*j+1] = re * c[2*j+1] + im * c[2*j];
+				}
+				memset(a + 2*n, 0, 2*(m-n)*sizeof(double));
+				bool ok = complexTransform(plan->sub, a, -1);
+				const double * b = plan->kernel;
+				for (int k=0; k<m; k++)
+				{
+					double re = a[2*k], im = a[2*k+1];
+					a[2*k] = re * b[2*k] - im * b[2*k+1];
+					a[2*k+1] = re * b[2*k+1] + im * b[2*k];
+				}
+				ok = ok && complexTransform(plan->sub, a, +1);
+				for (int k=0; k<n; k++)
+				{
+					data[2*k*stride] = a[2*k] * c[2*k] - a[2*k+1] * c[2*k+1];
+					data[2*k*stride+1] = conj * (a[2*k] * c[2*k+1] + a[2*k+1] * c[2*k]);
+				}
+				plan->giveConvolutionBuffer(a);
+				return ok;
+			}
+
+		case FourierPlan::FourStep:
+			{
+				// n = n1*n2, j = j1*n2 + j2, k = k1 + n1*k2: transform the n2 columns,
+				// multiply by w^(j2*k1), transform the n1 rows and transpose
+				Q_ASSERT(stride == 1);
+				double * out = plan->takeBuffer();
+				if (!out) return false;
+				parallelFor(0, plan->n2-1, FourStepColumnsKernel(plan, data, sign), 8);
+				parallelFor(0, plan->n1-1, FourStepRowsKernel(plan, data, sign), 8);
+				parallelFor(0, plan->n1-1, FourStepTransposeKernel(plan, data, out), 8);
+				memcpy(data, out, 2*n*sizeof(double));
+				plan->give(out);
+				return true;
+			}
+	}
+	return false;
+}
+
+//! Real forward transform of n points to halfcomplex order
+static bool realTransform(FourierPlan * plan, double * data)
+{
+	if (!plan->initReal()) return false;
+	int n = plan->n;
+
+	switch (plan->real_method)
+	{
+		case FourierPlan::RealMixedRadix:
+			{
+				gsl_fft_real_workspace * work = plan->takeRealWorkspace();
+				if (!work) return false;
+				gsl_fft_real_transform(data, 1, n, plan->real_table, work);
+				plan->give(work);
+				return true;
+			}
+
+		case FourierPlan::RealPacked:
+			{
+				// the even and odd values are the real and imaginary parts of N = n/2
+				// complex points z; with Z = FFT(z), X_k = E_k + w^k O_k where
+				// E_k = (Z_k + conj Z_{N-k})/2 and O_k = (Z_k - conj Z_{N-k})/(2i)
+				int N = n/2;
+				if (!complexTransform(plan->half, data, -1)) return false;
+				double * out = plan->takeBuffer();
+				if (!out) return false;
+				const double * w = plan->twiddle;
+				out[0] = data[0] + data[1];
+				out[n-1] = data[0] - data[1];
+				for (int k=1; k<N; k++)
+				{
+					double zr = data[2*k], zi = data[2*k+1];
+					double cr = data[2*(N-k)], ci = -data[2*(N-k)+1];
+					double er = 0.5 * (zr + cr), ei = 0.5 * (zi + ci);
+					double or_ = 0.5 * (zi - ci), oi = -0.5 * (zr - cr);
+					out[2*k-1] = er + w[2*k] * or_ - w[2*k+1] * oi;
+					out[2*k] = ei + w[2*k] * oi + w[2*k+1] * or_;
+				}
+				memcpy(data, out, n*sizeof(double));
+				plan->give(out);
+				return true;
+			}
+
+		case FourierPlan::RealViaComplex:
+			{
+				double * buffer = plan->takeBuffer();
+				if (!buffer) return false;
+				for (int j=0; j<n; j++)
+				{
+					buffer[2*j] = data[j];
+					buffer[2*j+1] = 0;
+				}
+				bool ok = complexTransform(plan, buffer, -1);
+				data[0] = buffer[0];
+				for (int k=1; 2*k<n; k++)
+				{
+					data[2*k-1] = buffer[2*k];
+					data[2*k] = buffer[2*k+1];
+				}
+				if (n % 2 == 0)
+					data[n-1] = buffer[n];
+				plan->give(buffer);
+				return ok;
+			}
+	}
+	return false;
+}
+
+//! Inverse of realTransform(), including normalization
+static bool halfcomplexTransform(FourierPlan * plan, double * data)
+{
+	if (!plan->initReal()) return false;
+	int n = plan->n;
+
+	switch (plan->real_method)
+	{
+		case FourierPlan::RealMixedRadix:
+			{
+				gsl_fft_real_workspace * work = plan->takeRealWorkspace();
+				if (!work) return false;
+				gsl_fft_halfcomplex_inverse(data, 1, n, plan->halfcomplex_table, work);
+				plan->give(work);
+				return true;
+			}
+
+		case FourierPlan::RealPacked:
+			{
+				// reverse the steps of realTransform(): E_k = (X_k + conj X_{N-k})/2,
+				// O_k = (X_k - conj X_{N-k}) conj(w^k)/2, Z_k = E_k + i O_k
+				int N = n/2;
+				double * z = plan->takeBuffer();
+				if (!z) return false;
+				const double * w = plan->twiddle;
+				for (int k=0; k<N; k++)
+				{
+					double xr, xi, cr, ci;
+					if (k == 0)
+					{
+						xr = data[0]; xi = 0;
+						cr = data[n-1]; ci = 0;
+					}
+					else
+					{
+						xr = data[2*k-1]; xi = data[2*k];
+						cr = data[2*(N-k)-1]; ci = -data[2*(N-k)];
+					}
+					double er = 0.5 * (xr + cr), ei = 0.5 * (xi + ci);
+					double dr = 0.5 * (xr - cr), di = 0.5 * (xi - ci);
+					double or_ = dr * w[2*k] + di * w[2*k+1], oi = di * w[2*k] - dr * w[2*k+1];
+					z[2*k] = er - oi;
+					z[2*k+1] = ei + or_;
+				}
+				bool ok = complexTransform(plan->half, z, +1);
+				for (int j=0; j<n; j++)
+					data[j] = z[j] / N;
+				plan->give(z);
+				return ok;
+			}
+
+		case FourierPlan::RealViaComplex:
+			{
+				double * buffer = plan->takeBuffer();
+				if (!buffer) return false;
+				buffer[0] = data[0];
+				buffer[1] = 0;
+				for (int k=1; 2*k<n; k++)
+				{
+					buffer[2*k] = buffer[2*(n-k)] = data[2*k-1];
+					buffer[2*k+1] = data[2*k];
+					buffer[2*(n-k)+1] = -data[2*k];
+				}
+				if (n % 2 == 0)
+				{
+					buffer[n] = data[n-1];
+					buffer[n+1] = 0;
+				}
+				bool ok = complexTransform(plan, buffer, +1);
+				for (int j=0; j<n; j++)
+					data[j] = buffer[2*j] / n;
+				plan->give(buffer);
+				return ok;
+			}
+	}
+	return false;
+}
+
+//! Runs realTransform() or halfcomplexTransform() on a range of consecutive arrays
+class FourierBatchKernel
+{
+	public:
+		FourierBatchKernel(FourierPlan * plan, double * data, bool inverse, bool * failed)
+			: m_plan(plan), m_data(data), m_inverse(inverse), m_failed(failed) {}
+		void operator()(int first, int last) const
+		{
+			for (int i=first; i<=last; i++)
+			{
+				double * array = m_data + qint64(i) * m_plan->n;
+				if (!(m_inverse ? halfcomplexTransform(m_plan, array) : realTransform(m_plan, array)))
+					*m_failed = true;
+			}
+		}
+
+	private:
+		FourierPlan * m_plan;
+		double * m_data;
+		bool m_inverse;
+		bool * m_failed;
+};
+
+FourierTransform::FourierTransform(int n)
+	: m_n(n), m_plan(n > 0 ? acquirePlan(n, true) : 0)
+{
+}
+
+FourierTransform::~FourierTransform()
+{
+	if (m_plan) releasePlan(m_plan);
+}
+
+bool FourierTransform::realForward(double * data, int count) const
+{
+	if (!m_plan || !m_plan->initReal()) return false;
+	bool failed = false;
+	if (m_plan->threaded())
+		FourierBatchKernel(m_plan, data, false, &failed)(0, count-1);
+	else
+		parallelFor(0, count-1, FourierBatchKernel(m_plan, data, false, &failed), qMax(1, 65536 / m_n));
+	return !failed;
+}
+
+bool FourierTransform::halfcomplexInverse(double * data, int count) const
+{
+	if (!m_plan || !m_plan->initReal()) return false;
+	bool failed = false;
+	if (m_plan->threaded())
+		FourierBatchKernel(m_plan, data, true, &failed)(0, count-1);
+	else
+		parallelFor(0, count-1, FourierBatchKernel(m_plan, data, true, &failed), qMax(1, 65536 / m_n));
+	return !failed;
+}
+
+bool FourierTransform::complexForward(double * data) const
+{
+	return m_plan && complexTransform(m_plan, data, -1);
+}
+
+bool FourierTransform::complexInverse(double * data) const
+{
+	if (!m_plan || !complexTransform(m_plan, data, +1)) return false;
+	for (int i=0; i<2*m_n; i++)
+		data[i] /= m_n;
+	return true;
+}
+
+void FourierTransform::multiplyHalfcomplex(double * a, const double * b, int n, bool conjugate_a)
+{
+	if (n < 1) return;
+	double sign = conjugate_a ? -1 : 1;
+	a[0] *= b[0];
+	for (int k=1; 2*k<n; k++)
+	{
+		double ar = a[2*k-1], ai = sign * a[2*k];
+		a[2*k-1] = ar * b[2*k-1] - ai * b[2*k];
+		a[2*k] = ar * b[2*k] + ai * b[2*k-1];
+	}
+	if (n % 2 == 0)
+		a[n-1] *= b[n-1];
+}
+
+void FourierTransform::divideHalfcomplex(double * a, const double * b, int n)
+{
+	if (n < 1) return;
+	a[0] /= b[0];
+	for (int k=1; 2*k<n; k++)
+	{
+		double size = b[2*k-1] * b[2*k-1] + b[2*k] * b[2*k];
+		double ar = a[2*k-1], ai = a[2*k];
+		a[2*k-1] = (ar * b[2*k-1] + ai * b[2*k]) / size;
+		a[2*k] = (ai * b[2*k-1] - ar * b[2*k]) / size;
+	}
+	if (n % 2 == 0)
+		a[n-1] /= b[n-1];
+}
+
+bool FourierTransform::isFastSize(int n)
+{
+	if (n < 1) return false;
+	int factors[] = { 2, 3, 5, 7 };
+	for (int i=0; i<4; i++)
+		while (n % factors[i] == 0)
+			n /= factors[i];
+	return n == 1;
+}
+
+int FourierTransform::nextFastSize(int n)
+{
+	n = qMax(n, 1);
+	while (!isFastSize(n))
+		n++;
+	return n;
+}
+
+void FourierTransform::clearCache()
+{
+	trimCache(0);
+}
@@ -0,0 +1,103 @@
+/***************************************************************************
+    File                 : FourierTransform.h
+    Project              : SciDAVis
+    Description          : Fast Fourier transforms with shared, cached plans
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef FOURIERTRANSFORM_H
+#define FOURIERTRANSFORM_H
+
+struct FourierPlan;
+
+//! Fast Fourier transforms of a fixed length, using plans shared by the whole application
+/**
+ * The transforms use the conventions of GSL: the forward transform uses exp(-2 pi i jk/n),
+ * inverse transforms include the factor 1/n, complex data is stored as interleaved real
+ * and imaginary parts and the result of a real transform is stored in GSL's halfcomplex
+ * order (see gsl_fft_real_transform()).
+ *
+ * Everything which only depends on the length (GSL wavetables, chirp and twiddle factors)
+ * is kept in a plan which is created on first use and cached by length, so filtering many
+ * curves of equal length only pays the setup cost once. Workspaces and scratch buffers
+ * are taken from a pool belonging to the plan; a FourierTransform can therefore be used
+ * from several threads at the same time. Plans which are not in use any more are kept
+ * until the cache holds too many of them (see clearCache()).
+ *
+ * Lengths whose prime factors are small are computed by GSL's mixed-radix routines.
+ * Lengths with a large prime factor use Bluestein's algorithm, which computes the
+ * transform as a convolution of length nextFastSize(2n-1). Large transforms are split
+ * into rows and columns (the "four-step" algorithm) which are transformed on all cores,
+ * and large real transforms are computed as complex transforms of half the length.
+ *
+ * \code
+ * FourierTransform fft(n);
+ * fft.realForward(data);
+ * for (int i=1; i<n; i++) data[i] = 0; // keep the mean only
+ * fft.halfcomplexInverse(data);
+ * \endcode
+ */
+class FourierTransform
+{
+	public:
+		//! Prepare transforms of length 'n' (taking the plan from the cache)
+		FourierTransform(int n);
+		~FourierTransform();
+
+		//! The length of the transforms
+		int size() const { return m_n; }
+
+		//! Transform 'count' consecutive arrays of size() real values to halfcomplex order, in place
+		/**
+		 * Returns false if the necessary tables could not be allocated.
+		 */
+		bool realForward(double * data, int count = 1) const;
+		//! Inverse of realForward(): halfcomplex order to real values, in place
+		bool halfcomplexInverse(double * data, int count = 1) const;
+		//! Forward transform of size() complex values (2*size() doubles), in place
+		bool complexForward(double * data) const;
+		//! Inverse of complexForward(), in place
+		bool complexInverse(double * data) const;
+
+		//! Multiply two spectra in halfcomplex order of length 'n': a = a * b (or conj(a) * b)
+		static void multiplyHalfcomplex(double * a, const double * b, int n, bool conjugate_a = false);
+		//! Divide two spectra in halfcomplex order of length 'n': a = a / b
+		static void divideHalfcomplex(double * a, const double * b, int n);
+		//! Whether 'n' has no prime factors but 2, 3, 5 and 7
+		static bool isFastSize(int n);
+		//! Return the smallest length >= n for which isFastSize() is true (for zero padding)
+		static int nextFastSize(int n);
+		//! Drop all cached plans which are not in use
+		static void clearCache();
+
+	private:
+		FourierTransform(const FourierTransform&);
+		FourierTransform& operator=(const FourierTransform&);
+
+		int m_n;
+		FourierPlan * m_plan;
+};
+
+#endif // ifndef FOURIERTRANSFORM_H
@@ -31,48 +31,62 @@
 #define INTERVALATTRIBUTE_H
 
 #include "Interval.h"
+#include "RowBitmap.h"
 #include <QList>
 
+//! Return the index of the first interval in 'list' which ends at or after 'row'
+/**
+ * 'list' must be sorted and its intervals must be disjoint. If all intervals end
+ * before 'row', list.size() is returned.
+ */
+inline int intervalLowerBound(const QList< Interval<int> >& list, int row)
+{
+	int lo = 0, hi = list.size();
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (list.at(mid).end() < row)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
 //! A class representing an interval-based attribute
+/**
+ * The intervals are kept sorted and disjoint, so looking up the value of a row
+ * is a binary search and editing a range only touches the intervals it overlaps.
+ * Adjacent intervals with equal values are merged.
+ */
 template<class T> class IntervalAttribute
 {
 	public:
 		void setValue(Interval<int> i, T value) 
 		{
+			if (!i.isValid()) return;
 			// first: subtract the new interval from all others
-			QList< Interval<int> > temp_list;
-			for(int c=0; c<m_intervals.size(); c++)
+			cut(i);
+
+			// second: try to merge the new interval with its neighbours
+			int c = intervalLowerBound(m_intervals, i.start());
+			bool merge_left = c > 0 && m_intervals.at(c-1).touches(i) && m_values.at(c-1) == value;
+			bool merge_right = c < m_intervals.size() && m_intervals.at(c).touches(i) && m_values.at(c) == value;
+			if (merge_left && merge_right)
 			{
-				temp_list = Interval<int>::subtract(m_intervals.at(c), i);
-				if(temp_list.isEmpty())
-				{
-					m_intervals.removeAt(c);
-					m_values.removeAt(c--);
-				}
-				else 
-				{
-					m_intervals.replace(c, temp_list.at(0));
-					if(temp_list.size()>1)
-					{
-						m_intervals.insert(c, temp_list.at(1));
-						m_values.insert(c, m_values.at(c));
-					}
-				}
+				m_intervals[c-1] = Interval<int>(m_intervals.at(c-1).start(), m_intervals.at(c).end());
+				m_intervals.removeAt(c);
+				m_values.removeAt(c);
 			}
-
-			// second: try to merge the new interval with an old one 
-			for(int c=0; c<m_intervals.size(); c++)
+			else if (merge_left)
+				m_intervals[c-1] = Interval<int>::merge(m_intervals.at(c-1), i);
+			else if (merge_right)
+				m_intervals[c] = Interval<int>::merge(m_intervals.at(c), i);
+			else // if it could not be merged, just insert it
 			{
-				if( m_intervals.at(c).touches(i) &&
-						m_values.at(c) == value )
-				{
-					m_intervals.replace(c, Interval<int>::merge(m_intervals.at(c), i));
-					return;
-				}
+				m_intervals.insert(c, i);
+				m_values.insert(c, value);
 			}
-			// if it could not be merged, just append it
-			m_intervals.append(i);
-			m_values.append(value);
 		}
 
 		// overloaded for convenience
@@ -83,141 +97,176 @@ template<class T> class IntervalAttribute
 
 		T value(int row) const 
 		{
-			for(int c=m_intervals.size()-1; c>=0; c--)
-			{
-				if(m_intervals.at(c).contains(row))
-					return m_values.at(c);
-			}
+			int c = intervalLowerBound(m_intervals, row);
+			if (c < m_intervals.size() && m_intervals.at(c).contains(row))
+				return m_values.at(c);
 			return T(); 
 		}
 
 		void insertRows(int before, int count)
 		{
-			QList< Interval<int> > temp_list;
-			// first: split all intervals that contain 'before'
-			for(int c=0; c<m_intervals.size(); c++)
+			// first: split the interval containing 'before'
+			int c = intervalLowerBound(m_intervals, before);
+			if (c < m_intervals.size() && m_intervals.at(c).start() < before)
 			{
-				if(m_intervals.at(c).contains(before))
+				QList< Interval<int> > temp_list = Interval<int>::split(m_intervals.at(c), before);
+				m_intervals[c] = temp_list.at(0);
+				if (temp_list.size() > 1)
 				{
-					temp_list = Interval<int>::split(m_intervals.at(c), before);
-					m_intervals.replace(c, temp_list.at(0));
-					if(temp_list.size()>1)
-					{
-						m_intervals.insert(c, temp_list.at(1));
-						m_values.insert(c, m_values.at(c));
-						c++;
-					}
-					
+					T value = m_values.at(c);
+					m_intervals.insert(c+1, temp_list.at(1));
+					m_values.insert(c+1, value);
 				}
+				c++;
 			}
 			// second: translate all intervals that start at 'before' or later
-			for(int c=0; c<m_intervals.size(); c++)
-			{
-				if(m_intervals.at(c).start() >= before)
-					m_intervals[c].translate(count);
-			}
-			
+			for(; c<m_intervals.size(); c++)
+				m_intervals[c].translate(count);
 		}
 
 		void removeRows(int first, int count)
 		{
-			QList< Interval<int> > temp_list;
-			Interval<int> i(first, first+count-1);
 			// first: remove the relevant rows from all intervals
-			for(int c=0; c<m_intervals.size(); c++)
+			cut(Interval<int>(first, first+count-1));
+			// second: translate all intervals that start at 'first+count' or later
+			int c = intervalLowerBound(m_intervals, first);
+			for(int cc=c; cc<m_intervals.size(); cc++)
+				m_intervals[cc].translate(-count);
+			// third: merge the two intervals that may touch now
+			if (c > 0 && c < m_intervals.size() && m_intervals.at(c-1).touches(m_intervals.at(c)) &&
+					m_values.at(c-1) == m_values.at(c))
 			{
-				temp_list = Interval<int>::subtract(m_intervals.at(c), i);
-				if(temp_list.isEmpty())
+				m_intervals[c-1] = Interval<int>::merge(m_intervals.at(c-1), m_intervals.at(c));
+				m_intervals.removeAt(c);
+				m_values.removeAt(c);
+			}
+		}
+
+		void clear() { m_values.clear(); m_intervals.clear(); }
+
+		QList< Interval<int> > intervals() const { return m_intervals; }
+		QList<T> values() const { return m_values; }
+
+	private:
+		//! Remove the rows in 'i' from all intervals
+		void cut(Interval<int> i)
+		{
+			int c = intervalLowerBound(m_intervals, i.start());
+			while (c < m_intervals.size() && m_intervals.at(c).start() <= i.end())
+			{
+				QList< Interval<int> > rest = Interval<int>::subtract(m_intervals.at(c), i);
+				if (rest.isEmpty())
 				{
 					m_intervals.removeAt(c);
-					m_values.removeAt(c--);
+					m_values.removeAt(c);
 				}
 				else 
 				{
-					m_intervals.replace(c, temp_list.at(0));
-					if(temp_list.size()>1)
+					m_intervals[c] = rest.at(0);
+					if (rest.size() > 1)
 					{
-						m_intervals.insert(c, temp_list.at(1));
-						m_values.insert(c, m_values.at(c));
+						T value = m_values.at(c);
+						m_intervals.insert(c+1, rest.at(1));
+						m_values.insert(c+1, value);
 						c++;
 					}
+					c++;
 				}
 			}
-			// second: translate all intervals that start at 'first+count' or later
-			for(int c=0; c<m_intervals.size(); c++)
-			{
-				if(m_intervals.at(c).start() >= first+count)
-					m_intervals[c].translate(-count);
-			}
-			// third: merge as many intervals as possible
-			QList<T> values_copy = m_values;
-			QList< Interval<int> > intervals_copy = m_intervals;
-			m_values.clear();
-			m_intervals.clear();
-			for(int c=0; c<intervals_copy.size(); c++)
-			{
-				i = intervals_copy.at(c);
-				T value = values_copy.at(c);
-				for(int cc=0; cc<m_intervals.size(); cc++)
-				{
-					if( m_intervals.at(cc).touches(i) &&
-							m_values.at(cc) == value )
-					{
-						m_intervals.replace(cc, Interval<int>::merge(m_intervals.at(cc),i));
-						return;
-					}
-				}
-				// if it could not be merged, just append it
-				m_intervals.append(i);
-				m_values.append(value);
-			}
-		}
-
-		void clear() { m_values.clear(); m_intervals.clear(); }
-
-		QList< Interval<int> > intervals() const { return m_intervals; }
-		QList<T> values() const { return m_values; }
-		IntervalAttribute<T>& operator=(const IntervalAttribute<T>& other) 
-		{
-			m_intervals.clear();
-			m_values.clear();
-			foreach( Interval<int> iv, other.intervals())
-				m_intervals.append(iv);
-			foreach( T value, other.values())
-				m_values.append(value);
-			return *this;
 		}
 
-	private:
+		//! Values of the intervals (same order as #m_intervals)
 		QList<T> m_values;
+		//! Sorted, disjoint intervals
 		QList< Interval<int> > m_intervals;
 };
 
 //! A class representing an interval-based attribute (bool version)
+/**
+ * The set rows are stored either as a sorted list of disjoint intervals
+ * (compact for a few large blocks, lookups are O(log n)) or as a RowBitmap
+ * (O(1) lookups and word-at-a-time range operations, better for scattered rows).
+ * By default, the representation is chosen adaptively: the attribute switches to the
+ * bitmap once the interval list becomes fragmented and the bitmap is not much larger
+ * than the list. It switches back when the attribute is cleared or assigned a new list.
+ * This is transparent to users of the class; intervals() always returns the set rows
+ * as sorted, non-touching intervals.
+ */
 template<> class IntervalAttribute<bool>
 {
 	public:
-		IntervalAttribute<bool>() {}
-		IntervalAttribute<bool>(QList< Interval<int> > intervals) : m_intervals(intervals) {}
-		IntervalAttribute<bool>& operator=(const IntervalAttribute<bool>& other) 
+		//! Storage used for the set rows
+		enum Representation {
+			Adaptive, //!< choose automatically (default)
+			IntervalList, //!< always use a sorted list of intervals
+			Bitmap //!< always use a bitmap
+		};
+
+		IntervalAttribute<bool>() : m_representation(Adaptive), m_use_bitmap(false) {}
+		IntervalAttribute<bool>(QList< Interval<int> > intervals) 
+			: m_representation(Adaptive), m_use_bitmap(false)
 		{
-			m_intervals.clear();
-			foreach( Interval<int> iv, other.intervals())
-				m_intervals.append(iv);
-			return *this;
+			foreach(Interval<int> iv, intervals)
+				setValue(iv, true);
+		}
+
+		//! Return the current representation policy
+		Representation representation() const { return m_representation; }
+		//! Force a representation (mainly useful for benchmarks) or return to Adaptive
+		void setRepresentation(Representation representation)
+		{
+			m_representation = representation;
+			if (representation == Bitmap && !m_use_bitmap)
+				toBitmap();
+			else if (representation == IntervalList && m_use_bitmap)
+				toList();
+			else if (representation == Adaptive)
+				adapt();
 		}
+		//! Return whether the set rows are currently stored in a bitmap
+		bool usesBitmap() const { return m_use_bitmap; }
 
 		void setValue(Interval<int> i, bool value=true) 
 		{
-			if(value) 
+			if (!i.isValid()) return;
+			if (m_use_bitmap)
 			{
-				foreach(Interval<int> iv, m_intervals)
-					if(iv.contains(i)) 
-						return;
-
-				Interval<int>::mergeIntervalIntoList(&m_intervals, i);
+				m_bitmap.setRange(i, value);
+				return;
+			}
+			if (value) 
+			{
+				// all intervals in [first, last) intersect or touch i
+				int first = lowerBound(i.start() - 1);
+				int last = first;
+				while (last < m_intervals.size() && m_intervals.at(last).start() <= i.end() + 1)
+					last++;
+				if (last > first)
+				{
+					i = Interval<int>(qMin(i.start(), m_intervals.at(first).start()),
+							qMax(i.end(), m_intervals.at(last-1).end()));
+					m_intervals[first] = i;
+					for(int c=last-1; c>first; c--)
+						m_intervals.removeAt(c);
+				}
+				else
+					m_intervals.insert(first, i);
+				adapt();
 			} else { // unset
-				Interval<int>::subtractIntervalFromList(&m_intervals, i);
+				int c = lowerBound(i.start());
+				while (c < m_intervals.size() && m_intervals.at(c).start() <= i.end())
+				{
+					QList< Interval<int> > rest = Interval<int>::subtract(m_intervals.at(c), i);
+					if (rest.isEmpty())
+						m_intervals.removeAt(c);
+					else 
+					{
+						m_intervals[c] = rest.at(0);
+						if (rest.size() > 1)
+							m_intervals.insert(++c, rest.at(1));
+						c++;
+					}
+				}
 			}
 		}
 
@@ -228,73 +277,113 @@ template<> class IntervalAttribute<bool>
 
 		bool isSet(int row) const 
 		{
-			foreach(Interval<int> iv, m_intervals)
-				if(iv.contains(row))
-					return true;
-			return false;
+			if (m_use_bitmap)
+				return m_bitmap.test(row);
+			int c = lowerBound(row);
+			return c < m_intervals.size() && m_intervals.at(c).contains(row);
 		}
 
+		//! Return whether all rows in 'i' are set
 		bool isSet(Interval<int> i) const 
 		{
-			foreach(Interval<int> iv, m_intervals)
-				if(iv.contains(i))
-					return true;
-			return false;
+			if (m_use_bitmap)
+				return m_bitmap.testAll(i);
+			int c = lowerBound(i.start());
+			return c < m_intervals.size() && m_intervals.at(c).contains(i);
 		}
 
 		void insertRows(int before, int count)
 		{
-			QList< Interval<int> > temp_list;
-			int c;
-			// first: split all intervals that contain 'before'
-			for(c=0; c<m_intervals.size(); c++)
+			if (m_use_bitmap)
 			{
-				if(m_intervals.at(c).contains(before))
-				{
-					temp_list = Interval<int>::split(m_intervals.at(c), before);
-					m_intervals.replace(c, temp_list.at(0));
-					if(temp_list.size()>1)
-						m_intervals.insert(c++, temp_list.at(1));
-					
-				}
+				m_bitmap.insertRows(before, count);
+				return;
 			}
-			// second: translate all intervals that start at 'before' or later
-			for(c=0; c<m_intervals.size(); c++)
+			// first: split the interval containing 'before'
+			int c = lowerBound(before);
+			if (c < m_intervals.size() && m_intervals.at(c).start() < before)
 			{
-				if(m_intervals.at(c).start() >= before)
-					m_intervals[c].translate(count);
+				QList< Interval<int> > temp_list = Interval<int>::split(m_intervals.at(c), before);
+				m_intervals[c] = temp_list.at(0);
+				if (temp_list.size() > 1)
+					m_intervals.insert(c+1, temp_list.at(1));
+				c++;
 			}
-			
+			// second: translate all intervals that start at 'before' or later
+			for(; c<m_intervals.size(); c++)
+				m_intervals[c].translate(count);
 		}
 
 		void removeRows(int first, int count)
 		{
-			int c;
-			// first: remove the relevant rows from all intervals
-			Interval<int>::subtractIntervalFromList(&m_intervals, Interval<int>(first, first+count-1));
-			// second: translate all intervals that start at 'first+count' or later
-			for(c=0; c<m_intervals.size(); c++)
+			if (m_use_bitmap)
 			{
-				if(m_intervals.at(c).start() >= first+count)
-					m_intervals[c].translate(-count);
+				m_bitmap.removeRows(first, count);
+				return;
 			}
-			// third: merge as many intervals as possible
-			for(c=m_intervals.size()-1; c>=0; c--)
+			// first: remove the relevant rows from all intervals
+			setValue(Interval<int>(first, first+count-1), false);
+			// second: translate all intervals that start at 'first+count' or later
+			int c = lowerBound(first);
+			for(int cc=c; cc<m_intervals.size(); cc++)
+				m_intervals[cc].translate(-count);
+			// third: merge the intervals that touch now
+			if (c > 0 && c < m_intervals.size() && m_intervals.at(c-1).touches(m_intervals.at(c)))
 			{
-				Interval<int> iv = m_intervals.takeAt(c);
-				int size_before = m_intervals.size();
-				Interval<int>::mergeIntervalIntoList(&m_intervals, iv);
-				if(size_before == m_intervals.size()) // merge successful
-					c--;
+				m_intervals[c-1] = Interval<int>::merge(m_intervals.at(c-1), m_intervals.at(c));
+				m_intervals.removeAt(c);
 			}
 		}
 
-		QList< Interval<int> > intervals() const { return m_intervals; }
+		QList< Interval<int> > intervals() const 
+		{ 
+			return m_use_bitmap ? m_bitmap.intervals() : m_intervals; 
+		}
 
-		void clear() { m_intervals.clear(); }
+		void clear() 
+		{ 
+			m_intervals.clear(); 
+			m_bitmap.clear(); 
+			m_use_bitmap = (m_representation == Bitmap);
+		}
 
 	private:
+		//! Above this number of intervals, the bitmap is considered
+		static int bitmapThreshold() { return 32; }
+		//! Maximum number of bitmap bits per interval at which the bitmap is preferred
+		static int bitsPerInterval() { return 512; }
+
+		//! Index of the first interval ending at or after 'row' (list representation only)
+		int lowerBound(int row) const { return intervalLowerBound(m_intervals, row); }
+		//! Switch to the bitmap if the interval list has become fragmented
+		void adapt()
+		{
+			if (m_representation != Adaptive || m_use_bitmap) return;
+			int n = m_intervals.size();
+			if (n > bitmapThreshold() && m_intervals.last().end() / bitsPerInterval() < n)
+				toBitmap();
+		}
+		void toBitmap()
+		{
+			m_bitmap.clear();
+			foreach(Interval<int> iv, m_intervals)
+				m_bitmap.setRange(iv, true);
+			m_intervals.clear();
+			m_use_bitmap = true;
+		}
+		void toList()
+		{
+			m_intervals = m_bitmap.intervals();
+			m_bitmap.clear();
+			m_use_bitmap = false;
+		}
+
+		Representation m_representation;
+		bool m_use_bitmap;
+		//! Sorted, disjoint and non-touching intervals of set rows (if !m_use_bitmap)
 		QList< Interval<int> > m_intervals;
+		//! The set rows (if m_use_bitmap)
+		RowBitmap m_bitmap;
 };
 
 #endif
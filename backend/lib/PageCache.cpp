@@ -0,0 +1,81 @@
+/***************************************************************************
+    File                 : PageCache.cpp
+    Project              : SciDAVis
+    Description          : Memory-bounded cache for pages of column data
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "lib/PageCache.h"
+
+#include <QMutexLocker>
+#include <QtGlobal>
+
+#include <limits.h>
+
+PageCache * PageCache::instance()
+{
+	static PageCache cache;
+	return &cache;
+}
+
+PageCache::PageCache()
+{
+	setBudget(qint64(256) << 20);
+}
+
+qint64 PageCache::budget() const
+{
+	QMutexLocker locker(&m_mutex);
+	return qint64(m_pages.maxCost()) << 10;
+}
+
+void PageCache::setBudget(qint64 bytes)
+{
+	QMutexLocker locker(&m_mutex);
+	// keep at least a few pages, or sequential reads would thrash
+	m_pages.setMaxCost(int(qBound(qint64(4 * PageSize * sizeof(double)), bytes, qint64(INT_MAX) << 10) >> 10));
+}
+
+QVector<double> PageCache::page(const ArchiveBlock & block, int page)
+{
+	PageKey key(block, page);
+	QMutexLocker locker(&m_mutex);
+	QVector<double> * cached = m_pages.object(key);
+	if (cached) return *cached;
+
+	qint64 position = qint64(page) * PageSize * sizeof(double);
+	qint64 size = qMin(qint64(PageSize * sizeof(double)), block.size() - position);
+	QVector<double> * values = new QVector<double>(ProjectArchive::decodeDoubles(block.read(position, size)));
+	QVector<double> result = *values;
+	m_pages.insert(key, values, qMax(1, values->size() * int(sizeof(double)) >> 10));
+	return result;
+}
+
+void PageCache::remove(const ArchiveBlock & block)
+{
+	QMutexLocker locker(&m_mutex);
+	foreach(PageKey key, m_pages.keys())
+		if (key.file == block.fileId() && key.offset == block.offset())
+			m_pages.remove(key);
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+    File                 : PageCache.h
+    Project              : SciDAVis
+    Description          : Memory-bounded cache for pages of column data
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include "lib/ProjectArchive.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QVector>
+
+//! Identifies a page of an ArchiveBlock in the PageCache
+struct PageKey
+{
+	PageKey(const ArchiveBlock & block, int page)
+		: file(block.fileId()), offset(block.offset()), page(page) {}
+	quintptr file;
+	qint64 offset;
+	int page;
+	bool operator==(const PageKey & other) const {
+		return file == other.file && offset == other.offset && page == other.page;
+	}
+};
+
+inline uint qHash(const PageKey & key)
+{
+	return qHash(quint64(key.file)) ^ qHash(quint64(key.offset)) ^ uint(key.page * 0x9e3779b9u);
+}
+
+//! Least recently used pages of doubles read from project files, within a memory budget
+/**
+ * Columns of a binary project which can't be mapped into memory (see PagedDoubleData) read
+ * their values in pages of PageSize doubles. This cache keeps as many recently used pages as
+ * fit into the budget (in bytes) set by setBudget(). All methods are thread-safe.
+ */
+class PageCache
+{
+	public:
+		enum { PageSize = 8192 };
+
+		static PageCache * instance();
+
+		qint64 budget() const;
+		void setBudget(qint64 bytes);
+
+		//! Return page 'page' of the doubles stored in 'block', reading it if necessary
+		QVector<double> page(const ArchiveBlock & block, int page);
+		//! Drop all cached pages of 'block'
+		void remove(const ArchiveBlock & block);
+
+	private:
+		PageCache();
+
+		mutable QMutex m_mutex;
+		//! Cost of an entry is its size in KiB
+		QCache<PageKey, QVector<double> > m_pages;
+};
+
+#endif // ifndef PAGE_CACHE_H
@@ -0,0 +1,96 @@
+/***************************************************************************
+    File                 : PagedDoubleData.cpp
+    Project              : SciDAVis
+    Description          : Read-only, paged access to doubles in a project file
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "lib/PagedDoubleData.h"
+#include "lib/PageCache.h"
+
+#include <QMutexLocker>
+
+#include <string.h>
+
+PagedDoubleData::PagedDoubleData(const ArchiveBlock & block, bool use_mapping)
+	: m_block(block), m_size(int(block.size() / sizeof(double))), m_mapping(0), m_mapped(0), m_current_page(-1)
+{
+	Q_ASSERT(!block.isCompressed());
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+	if (use_mapping)
+		m_mapping = m_block.map();
+	m_mapped = reinterpret_cast<const double *>(m_mapping);
+#else
+	Q_UNUSED(use_mapping);
+#endif
+}
+
+PagedDoubleData::~PagedDoubleData()
+{
+	if (m_mapping)
+		m_block.unmap(m_mapping);
+	else
+		PageCache::instance()->remove(m_block);
+}
+
+double PagedDoubleData::value(int index) const
+{
+	if (index < 0 || index >= m_size) return 0.0;
+	if (m_mapped) return m_mapped[index];
+
+	QMutexLocker locker(&m_mutex);
+	int page = index / PageCache::PageSize;
+	if (page != m_current_page) {
+		m_current_values = PageCache::instance()->page(m_block, page);
+		m_current_page = page;
+	}
+	return m_current_values.value(index % PageCache::PageSize);
+}
+
+void PagedDoubleData::values(int first, int count, double * buffer) const
+{
+	if (m_mapped && first >= 0 && first + count <= m_size) {
+		memcpy(buffer, m_mapped + first, count * sizeof(double));
+		return;
+	}
+	int index = first;
+	while (index < first + count) {
+		if (index < 0 || index >= m_size) {
+			buffer[index - first] = 0.0;
+			index++;
+			continue;
+		}
+		int page = index / PageCache::PageSize;
+		int page_start = page * PageCache::PageSize;
+		QVector<double> values = PageCache::instance()->page(m_block, page);
+		int n = qMin(first + count, page_start + values.size()) - index;
+		if (n <= 0) {
+			buffer[index - first] = 0.0;
+			index++;
+			continue;
+		}
+		memcpy(buffer + (index - first), values.constData() + (index - page_start), n * sizeof(double));
+		index += n;
+	}
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+    File                 : PagedDoubleData.h
+    Project              : SciDAVis
+    Description          : Read-only, paged access to doubles in a project file
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PAGED_DOUBLE_DATA_H
+#define PAGED_DOUBLE_DATA_H
+
+#include "lib/ProjectArchive.h"
+
+#include <QMutex>
+#include <QVector>
+
+//! Read-only access to the doubles stored in an ArchiveBlock, without reading all of them
+/**
+ * If possible (and allowed by the use_mapping argument), the block is mapped into memory, so
+ * the operating system takes care of reading pages on demand and dropping them again under
+ * memory pressure; mappedData() then gives direct access to the values. Otherwise, values are
+ * read in pages through the PageCache, whose budget limits the memory used.
+ *
+ * The block must be uncompressed; on big endian machines, it is never mapped.
+ */
+class PagedDoubleData
+{
+	public:
+		PagedDoubleData(const ArchiveBlock & block, bool use_mapping = true);
+		~PagedDoubleData();
+
+		int size() const { return m_size; }
+		//! Return value 'index', or 0.0 if index is out of range (thread-safe)
+		double value(int index) const;
+		//! Copy 'count' values starting at 'first' to 'buffer'
+		void values(int first, int count, double * buffer) const;
+		//! Return all values if the block is mapped into memory, 0 otherwise
+		const double * mappedData() const { return m_mapped; }
+
+	private:
+		ArchiveBlock m_block;
+		int m_size;
+		const uchar * m_mapping;
+		const double * m_mapped;
+		//! \name last page used by value()
+		//@{
+		mutable QMutex m_mutex;
+		mutable int m_current_page;
+		mutable QVector<double> m_current_values;
+		//@}
+};
+
+#endif // ifndef PAGED_DOUBLE_DATA_H
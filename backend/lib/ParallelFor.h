@@ -0,0 +1,110 @@
+/***************************************************************************
+    File                 : ParallelFor.h
+    Project              : SciDAVis
+    Description          : Run a loop on all available cores
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <QThread>
+#include <QList>
+#include <QtGlobal>
+
+//! Worker thread used by parallelFor()
+template<class Kernel> class ParallelForThread : public QThread
+{
+	public:
+		ParallelForThread(const Kernel& kernel, int first, int last)
+			: m_kernel(kernel), m_first(first), m_last(last) {}
+
+	protected:
+		virtual void run() { m_kernel(m_first, m_last); }
+
+	private:
+		const Kernel& m_kernel;
+		int m_first;
+		int m_last;
+};
+
+//! Split the loop over first..last into chunks and run them on all available cores
+/**
+ * 'kernel' is a function object called as kernel(chunk_first, chunk_last) once for each
+ * chunk; the chunks are disjoint and together cover first..last. The kernel is called
+ * concurrently from several threads, so it must only write to data belonging to its
+ * chunk and must not touch any QObject. One chunk runs in the calling thread;
+ * parallelFor() returns when all chunks are finished.
+ *
+ * No thread is started if the loop has less than 2*min_chunk_size iterations or there
+ * is only one core, so it is safe (and cheap) to use this for small loops, too.
+ *
+ * \code
+ * struct Square {
+ * 	Square(const double * in, double * out) : in(in), out(out) {}
+ * 	void operator()(int first, int last) const {
+ * 		for(int i=first; i<=last; i++)
+ * 			out[i] = in[i] * in[i];
+ * 	}
+ * 	const double * in;
+ * 	double * out;
+ * };
+ * parallelFor(0, n-1, Square(x, y), 100000);
+ * \endcode
+ */
+template<class Kernel> void parallelFor(int first, int last, const Kernel& kernel, int min_chunk_size = 1)
+{
+	int count = last - first + 1;
+	if (count <= 0) return;
+#if QT_VERSION >= 0x040300
+	int chunks = qMin(QThread::idealThreadCount(), count / qMax(min_chunk_size, 1));
+#else
+	int chunks = 1;
+#endif
+	if (chunks <= 1)
+	{
+		kernel(first, last);
+		return;
+	}
+
+	QList< ParallelForThread<Kernel>* > workers;
+	int chunk_size = count / chunks, remainder = count % chunks;
+	int start = first;
+	for(int c=0; c<chunks-1; c++)
+	{
+		int size = chunk_size + (c < remainder ? 1 : 0);
+		ParallelForThread<Kernel> * worker = new ParallelForThread<Kernel>(kernel, start, start+size-1);
+		workers << worker;
+		worker->start();
+		start += size;
+	}
+	kernel(start, last);
+	foreach(ParallelForThread<Kernel> * worker, workers)
+	{
+		worker->wait();
+		delete worker;
+	}
+}
+
+#endif // ifndef PARALLELFOR_H
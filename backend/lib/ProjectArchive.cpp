@@ -0,0 +1,318 @@
+/***************************************************************************
+    File                 : ProjectArchive.cpp
+    Project              : SciDAVis
+    Description          : Binary container for projects
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "lib/ProjectArchive.h"
+
+#include <QDataStream>
+#include <QMutexLocker>
+#include <QtEndian>
+
+#include <string.h>
+
+static const char ARCHIVE_SIGNATURE[8] = { 'S', 'c', 'i', 'D', 'A', 'V', 'i', 's' };
+//! Version of QDataStream used for string and date/time blocks
+static const int DATA_STREAM_VERSION = QDataStream::Qt_4_2;
+
+QByteArray ArchiveFile::read(qint64 offset, qint64 size) const
+{
+	QMutexLocker locker(&m_mutex);
+	if (!m_file.seek(offset)) return QByteArray();
+	QByteArray result = m_file.read(size);
+	if (result.size() != size) return QByteArray();
+	return result;
+}
+
+const uchar * ArchiveFile::map(qint64 offset, qint64 size) const
+{
+#if QT_VERSION >= 0x040400
+	QMutexLocker locker(&m_mutex);
+	return m_file.map(offset, size);
+#else
+	Q_UNUSED(offset);
+	Q_UNUSED(size);
+	return 0;
+#endif
+}
+
+void ArchiveFile::unmap(const uchar * address) const
+{
+#if QT_VERSION >= 0x040400
+	QMutexLocker locker(&m_mutex);
+	m_file.unmap(const_cast<uchar *>(address));
+#else
+	Q_UNUSED(address);
+#endif
+}
+
+QByteArray ArchiveBlock::read(qint64 position, qint64 size) const
+{
+	Q_ASSERT(!m_compressed);
+	if (isNull() || position < 0 || size <= 0 || position + size > m_size) return QByteArray();
+	return m_file.constData()->read(m_offset + position, size);
+}
+
+const uchar * ArchiveBlock::map() const
+{
+	if (isNull() || m_compressed || m_size == 0) return 0;
+	return m_file.constData()->map(m_offset, m_size);
+}
+
+void ArchiveBlock::unmap(const uchar * address) const
+{
+	if (!isNull() && address)
+		m_file.constData()->unmap(address);
+}
+
+QByteArray ArchiveBlock::read() const
+{
+	if (isNull() || m_size == 0) return QByteArray();
+	QByteArray result = m_file.constData()->read(m_offset, m_stored_size);
+	if (m_compressed && !result.isEmpty())
+		result = qUncompress(result);
+	if (result.size() != m_size) return QByteArray();
+	return result;
+}
+
+ProjectArchive::ProjectArchive(QObject * parent)
+	: QBuffer(parent), m_output(0), m_output_start(0), m_compression_level(0)
+{
+}
+
+ProjectArchive::~ProjectArchive()
+{
+}
+
+bool ProjectArchive::isArchive(QIODevice * device)
+{
+	return device->peek(sizeof(ARCHIVE_SIGNATURE)) == QByteArray(ARCHIVE_SIGNATURE, sizeof(ARCHIVE_SIGNATURE));
+}
+
+bool ProjectArchive::beginWrite(QIODevice * output, int compression_level)
+{
+	m_output = output;
+	m_output_start = output->pos();
+	m_compression_level = compression_level;
+	m_blocks.clear();
+
+	QDataStream stream(output);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.writeRawData(ARCHIVE_SIGNATURE, sizeof(ARCHIVE_SIGNATURE));
+	stream << quint32(Version) << quint32(0) << quint64(0);
+	if (stream.status() != QDataStream::Ok) {
+		setErrorString(output->errorString());
+		return false;
+	}
+
+	setData(QByteArray());
+	return open(QIODevice::WriteOnly);
+}
+
+int ProjectArchive::writeBlock(const QByteArray & data)
+{
+	Q_ASSERT(m_output);
+	ArchiveBlock block;
+	block.m_size = data.size();
+
+	// align blocks to 8 bytes, so uncompressed doubles can be used in place
+	static const char padding[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	qint64 misalignment = (m_output->pos() - m_output_start) % 8;
+	if (misalignment)
+		m_output->write(padding, 8 - misalignment);
+	block.m_offset = m_output->pos() - m_output_start;
+
+	QByteArray compressed;
+	if (m_compression_level != 0 && !data.isEmpty()) {
+		compressed = qCompress(data, m_compression_level);
+		block.m_compressed = compressed.size() < data.size();
+	}
+	const QByteArray & stored = block.m_compressed ? compressed : data;
+	block.m_stored_size = stored.size();
+	m_output->write(stored);
+
+	m_blocks << block;
+	return m_blocks.size() - 1;
+}
+
+bool ProjectArchive::endWrite()
+{
+	Q_ASSERT(m_output);
+	close();
+	int saved_level = m_compression_level;
+	m_compression_level = -1;
+	int manifest = writeBlock(buffer());
+	m_compression_level = saved_level;
+	setData(QByteArray());
+
+	qint64 index_offset = m_output->pos() - m_output_start;
+	QDataStream stream(m_output);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream << quint32(m_blocks.size()) << quint32(manifest);
+	foreach(ArchiveBlock block, m_blocks)
+		stream << quint64(block.m_offset) << quint64(block.m_stored_size) << quint64(block.m_size)
+			<< quint32(block.m_compressed ? Compressed : 0);
+	qint64 end = m_output->pos();
+	if (!m_output->seek(m_output_start + IndexOffsetPosition)) {
+		setErrorString(m_output->errorString());
+		return false;
+	}
+	stream << quint64(index_offset);
+	m_output->seek(end);
+
+	m_blocks.clear();
+	m_output = 0;
+	if (stream.status() != QDataStream::Ok) {
+		setErrorString(tr("Could not write project archive."));
+		return false;
+	}
+	return true;
+}
+
+bool ProjectArchive::openArchive(const QString & file_name)
+{
+	m_blocks.clear();
+	ArchiveFile * archive_file = new ArchiveFile(file_name);
+	ArchiveFilePointer file(archive_file);
+	if (!archive_file->open()) {
+		setErrorString(archive_file->errorString());
+		return false;
+	}
+
+	QByteArray header = file.constData()->read(0, IndexOffsetPosition + 8);
+	if (!header.startsWith(QByteArray(ARCHIVE_SIGNATURE, sizeof(ARCHIVE_SIGNATURE)))) {
+		setErrorString(tr("Not a binary SciDAVis project."));
+		return false;
+	}
+	QDataStream header_stream(header);
+	header_stream.setByteOrder(QDataStream::LittleEndian);
+	header_stream.skipRawData(sizeof(ARCHIVE_SIGNATURE));
+	quint32 version, reserved;
+	quint64 index_offset;
+	header_stream >> version >> reserved >> index_offset;
+	if (version > Version) {
+		setErrorString(tr("The project was saved by a newer version of SciDAVis."));
+		return false;
+	}
+
+	QByteArray index = file.constData()->read(index_offset, 8);
+	QDataStream index_stream(index);
+	index_stream.setByteOrder(QDataStream::LittleEndian);
+	quint32 block_count, manifest;
+	index_stream >> block_count >> manifest;
+	if (index_stream.status() != QDataStream::Ok || manifest >= block_count) {
+		setErrorString(tr("The project file is damaged."));
+		return false;
+	}
+	index = file.constData()->read(index_offset + 8, qint64(block_count) * 28);
+	QDataStream blocks_stream(index);
+	blocks_stream.setByteOrder(QDataStream::LittleEndian);
+	for (quint32 i=0; i<block_count; i++) {
+		quint64 offset, stored_size, size;
+		quint32 flags;
+		blocks_stream >> offset >> stored_size >> size >> flags;
+		ArchiveBlock block;
+		block.m_file = file;
+		block.m_offset = offset;
+		block.m_stored_size = stored_size;
+		block.m_size = size;
+		block.m_compressed = flags & Compressed;
+		m_blocks << block;
+	}
+	if (blocks_stream.status() != QDataStream::Ok) {
+		m_blocks.clear();
+		setErrorString(tr("The project file is damaged."));
+		return false;
+	}
+
+	QByteArray manifest_data = m_blocks.at(manifest).read();
+	if (manifest_data.isEmpty()) {
+		m_blocks.clear();
+		setErrorString(tr("The project file is damaged."));
+		return false;
+	}
+	setData(manifest_data);
+	return open(QIODevice::ReadOnly);
+}
+
+QByteArray ProjectArchive::encodeDoubles(const double * values, int count)
+{
+	QByteArray result(reinterpret_cast<const char *>(values), count * sizeof(double));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+	quint64 * words = reinterpret_cast<quint64 *>(result.data());
+	for (int i=0; i<count; i++)
+		words[i] = qToLittleEndian(words[i]);
+#endif
+	return result;
+}
+
+QVector<double> ProjectArchive::decodeDoubles(const QByteArray & data)
+{
+	QVector<double> result(data.size() / sizeof(double));
+	memcpy(result.data(), data.constData(), result.size() * sizeof(double));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+	quint64 * words = reinterpret_cast<quint64 *>(result.data());
+	for (int i=0; i<result.size(); i++)
+		words[i] = qFromLittleEndian(words[i]);
+#endif
+	return result;
+}
+
+QByteArray ProjectArchive::encodeStrings(const QStringList & values)
+{
+	QByteArray result;
+	QDataStream stream(&result, QIODevice::WriteOnly);
+	stream.setVersion(DATA_STREAM_VERSION);
+	stream << values;
+	return result;
+}
+
+QStringList ProjectArchive::decodeStrings(const QByteArray & data)
+{
+	QStringList result;
+	QDataStream stream(data);
+	stream.setVersion(DATA_STREAM_VERSION);
+	stream >> result;
+	return result;
+}
+
+QByteArray ProjectArchive::encodeDateTimes(const QList<QDateTime> & values)
+{
+	QByteArray result;
+	QDataStream stream(&result, QIODevice::WriteOnly);
+	stream.setVersion(DATA_STREAM_VERSION);
+	stream << values;
+	return result;
+}
+
+QList<QDateTime> ProjectArchive::decodeDateTimes(const QByteArray & data)
+{
+	QList<QDateTime> result;
+	QDataStream stream(data);
+	stream.setVersion(DATA_STREAM_VERSION);
+	stream >> result;
+	return result;
+}
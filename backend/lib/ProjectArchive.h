@@ -0,0 +1,208 @@
+/***************************************************************************
+    File                 : ProjectArchive.h
+    Project              : SciDAVis
+    Description          : Binary container for projects
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PROJECT_ARCHIVE_H
+#define PROJECT_ARCHIVE_H
+
+#include <QBuffer>
+#include <QFile>
+#include <QMutex>
+#include <QSharedData>
+#include <QSharedDataPointer>
+#if QT_VERSION >= 0x040400
+#include <QExplicitlySharedDataPointer>
+#endif
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <QStringList>
+#include <QDateTime>
+
+//! An archive file opened for reading, shared by all ArchiveBlocks read from it
+class ArchiveFile : public QSharedData
+{
+	public:
+		ArchiveFile(const QString & file_name) : m_file(file_name) {}
+		//! Open the file for reading
+		bool open() { return m_file.open(QIODevice::ReadOnly); }
+		//! Read 'size' bytes starting at 'offset' (thread-safe)
+		QByteArray read(qint64 offset, qint64 size) const;
+		//! Map 'size' bytes starting at 'offset' into memory; returns 0 if that's not possible
+		const uchar * map(qint64 offset, qint64 size) const;
+		//! Undo map()
+		void unmap(const uchar * address) const;
+		QString errorString() const { return m_file.errorString(); }
+
+	private:
+		mutable QFile m_file;
+		mutable QMutex m_mutex;
+};
+
+//! Reference to an ArchiveFile that never copies it
+/**
+ * QSharedDataPointer would detach (copy the file) on every non-const access.
+ */
+#if QT_VERSION >= 0x040400
+typedef QExplicitlySharedDataPointer<ArchiveFile> ArchiveFilePointer;
+#else
+typedef QSharedDataPointer<ArchiveFile> ArchiveFilePointer; // only ever accessed through constData()
+#endif
+
+//! A block of data stored in a ProjectArchive
+/**
+ * A block keeps its archive file open, so its contents can be read when they are needed for the
+ * first time instead of when the project is loaded.
+ */
+class ArchiveBlock
+{
+	public:
+		ArchiveBlock() : m_offset(0), m_stored_size(0), m_size(0), m_compressed(false) {}
+		//! Whether this block refers to no data at all
+		bool isNull() const { return m_file.constData() == 0; }
+		//! Size of the (uncompressed) contents
+		qint64 size() const { return m_size; }
+		//! Whether the block is stored compressed
+		bool isCompressed() const { return m_compressed; }
+		//! Position of the block in the archive file
+		qint64 offset() const { return m_offset; }
+		//! Identifies the archive file the block belongs to (while it's open)
+		quintptr fileId() const { return quintptr(m_file.constData()); }
+		//! Read (and uncompress) the contents of the block
+		/**
+		 * Returns an empty array if the file could not be read.
+		 */
+		QByteArray read() const;
+		//! Read 'size' bytes of an uncompressed block, starting 'position' bytes into the block
+		QByteArray read(qint64 position, qint64 size) const;
+		//! Map an uncompressed block into memory; returns 0 if that's not possible
+		/**
+		 * The mapping has to be released using unmap() before the block is destroyed.
+		 */
+		const uchar * map() const;
+		void unmap(const uchar * address) const;
+
+	private:
+		ArchiveFilePointer m_file;
+		qint64 m_offset;
+		qint64 m_stored_size;
+		qint64 m_size;
+		bool m_compressed;
+
+	friend class ProjectArchive;
+};
+
+//! Binary container for projects
+/**
+ * Saving large tables and matrices as XML is slow and produces huge files, because every value
+ * becomes an XML element with its text representation. A ProjectArchive stores the project XML
+ * (called the manifest) together with any number of raw data blocks, which elements in the
+ * manifest refer to by index. Aspects find out whether they are saved to or loaded from an
+ * archive by checking the device of the XML writer or reader:
+ *
+ * \code
+ * ProjectArchive * archive = qobject_cast<ProjectArchive *>(writer->device());
+ * if (archive) {
+ * 	writer->writeStartElement("data");
+ * 	writer->writeAttribute("block", QString::number(archive->writeBlock(bytes)));
+ * 	writer->writeEndElement();
+ * } else
+ * 	// write XML only
+ * \endcode
+ *
+ * The manifest is written to and read from the ProjectArchive itself, which is a QBuffer.
+ * Blocks read from an archive keep the file open (see ArchiveBlock), so their contents can be
+ * read lazily.
+ *
+ * File layout (all integers little endian):
+ * - header: "SciDAVis" signature, quint32 version, quint32 reserved, quint64 offset of the index
+ * - the data blocks, each starting at a multiple of 8 bytes
+ * - the index: quint32 number of blocks, quint32 block number of the manifest, and for
+ *   every block quint64 offset, quint64 stored size, quint64 size, quint32 flags
+ *   (1 = compressed with qCompress())
+ */
+class ProjectArchive : public QBuffer
+{
+	Q_OBJECT
+
+	public:
+		ProjectArchive(QObject * parent = 0);
+		~ProjectArchive();
+
+		//! Whether the device is positioned at the start of an archive
+		static bool isArchive(QIODevice * device);
+
+		//! \name writing
+		//@{
+		//! Start writing an archive to 'output', which has to be open for writing and seekable
+		/**
+		 * Opens this buffer for writing the manifest. Blocks are compressed with
+		 * qCompress(data, compression_level) if compression_level is not 0 and this actually
+		 * reduces their size.
+		 */
+		bool beginWrite(QIODevice * output, int compression_level = 0);
+		//! Append a block of data to the archive and return its number
+		int writeBlock(const QByteArray & data);
+		//! Write the manifest and the index and close this buffer
+		bool endWrite();
+		//@}
+
+		//! \name reading
+		//@{
+		//! Read the index and manifest of an archive file
+		/**
+		 * Opens this buffer for reading the manifest. On failure, errorString() says why.
+		 */
+		bool openArchive(const QString & file_name);
+		//! Number of blocks in the archive
+		int blockCount() const { return m_blocks.size(); }
+		//! Return block number 'index'
+		ArchiveBlock block(int index) const { return m_blocks.at(index); }
+		//@}
+
+		//! \name encoding of column data
+		//@{
+		//! Convert doubles to little endian IEEE 754
+		static QByteArray encodeDoubles(const double * values, int count);
+		static QVector<double> decodeDoubles(const QByteArray & data);
+		static QByteArray encodeStrings(const QStringList & values);
+		static QStringList decodeStrings(const QByteArray & data);
+		static QByteArray encodeDateTimes(const QList<QDateTime> & values);
+		static QList<QDateTime> decodeDateTimes(const QByteArray & data);
+		//@}
+
+	private:
+		enum { Version = 1, IndexOffsetPosition = 16 };
+		enum BlockFlags { Compressed = 1 };
+
+		QIODevice * m_output;
+		qint64 m_output_start;
+		int m_compression_level;
+		QList<ArchiveBlock> m_blocks;
+};
+
+#endif // ifndef PROJECT_ARCHIVE_H
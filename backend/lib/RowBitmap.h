@@ -0,0 +1,231 @@
+/***************************************************************************
+    File                 : RowBitmap.h
+    Project              : SciDAVis
+    Description          : A bitmap with one bit per row
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ROWBITMAP_H
+#define ROWBITMAP_H
+
+#include "Interval.h"
+#include <QList>
+#include <QVector>
+#include <QtGlobal>
+
+//! A bitmap with one bit per row
+/**
+ * This is the dense counterpart to a list of intervals: looking up a row is O(1)
+ * and setting, inserting or removing ranges of rows works on 64 rows at a time.
+ * Rows beyond the end of the bitmap are considered unset, so the bitmap only grows
+ * as far as the highest set row requires.
+ *
+ * The words are kept in an implicitly shared QVector, so copying a RowBitmap
+ * (e.g. for undo commands) is cheap until one of the copies is modified.
+ */
+class RowBitmap
+{
+	public:
+		//! Return whether 'row' is set
+		bool test(int row) const
+		{
+			if (row < 0 || (row >> 6) >= m_words.size()) return false;
+			return (m_words.at(row >> 6) >> (row & 63)) & 1;
+		}
+		//! Return whether all rows in 'i' are set
+		bool testAll(Interval<int> i) const
+		{
+			if (!i.isValid() || (i.end() >> 6) >= m_words.size()) return false;
+			int first_word = i.start() >> 6, last_word = i.end() >> 6;
+			for(int w=first_word; w<=last_word; w++)
+			{
+				quint64 mask = rangeMask(w, i);
+				if ((m_words.at(w) & mask) != mask)
+					return false;
+			}
+			return true;
+		}
+		//! Return whether any row in 'i' is set
+		bool testAny(Interval<int> i) const
+		{
+			if (!i.isValid()) return false;
+			int first_word = i.start() >> 6;
+			int last_word = qMin(i.end() >> 6, m_words.size() - 1);
+			for(int w=first_word; w<=last_word; w++)
+				if (m_words.at(w) & rangeMask(w, i))
+					return true;
+			return false;
+		}
+		//! Set or unset all rows in 'i'
+		void setRange(Interval<int> i, bool value = true)
+		{
+			if (!i.isValid()) return;
+			int first_word = i.start() >> 6, last_word = i.end() >> 6;
+			if (value)
+			{
+				if (last_word >= m_words.size())
+					m_words.resize(last_word + 1); // QVector zero-initializes new integers
+			}
+			else
+				last_word = qMin(last_word, m_words.size() - 1);
+			if (first_word > last_word) return;
+			quint64 * words = m_words.data();
+			for(int w=first_word; w<=last_word; w++)
+			{
+				if (value)
+					words[w] |= rangeMask(w, i);
+				else
+					words[w] &= ~rangeMask(w, i);
+			}
+		}
+		//! Insert 'count' unset rows before row 'before'
+		void insertRows(int before, int count)
+		{
+			int bits = m_words.size() * 64;
+			if (count <= 0 || before >= bits) return;
+			QVector<quint64> result((bits + count + 63) >> 6, 0);
+			copyBits(result.data(), 0, m_words.constData(), 0, before);
+			copyBits(result.data(), before + count, m_words.constData(), before, bits - before);
+			m_words = result;
+			squeeze();
+		}
+		//! Remove 'count' rows starting at row 'first'
+		void removeRows(int first, int count)
+		{
+			int bits = m_words.size() * 64;
+			if (count <= 0 || first >= bits) return;
+			int tail = qMax(bits - first - count, 0);
+			QVector<quint64> result((first + tail + 63) >> 6, 0);
+			copyBits(result.data(), 0, m_words.constData(), 0, first);
+			copyBits(result.data(), first, m_words.constData(), first + count, tail);
+			m_words = result;
+			squeeze();
+		}
+		//! Return the set rows as a sorted list of disjoint, non-touching intervals
+		QList< Interval<int> > intervals() const
+		{
+			QList< Interval<int> > result;
+			int start = -1;
+			for(int w=0; w<m_words.size(); w++)
+			{
+				quint64 word = m_words.at(w);
+				// fast paths for words which don't start or end a run
+				if (word == 0 && start < 0) continue;
+				if (word == ~Q_UINT64_C(0) && start >= 0) continue;
+				for(int b=0; b<64; b++)
+				{
+					bool set = (word >> b) & 1;
+					if (set && start < 0)
+						start = w * 64 + b;
+					else if (!set && start >= 0)
+					{
+						result.append(Interval<int>(start, w * 64 + b - 1));
+						start = -1;
+					}
+				}
+			}
+			if (start >= 0)
+				result.append(Interval<int>(start, m_words.size() * 64 - 1));
+			return result;
+		}
+		//! Return the number of runs of set rows, i.e. intervals().size()
+		int runCount() const
+		{
+			int runs = 0;
+			quint64 carry = 0; // highest bit of the previous word
+			for(int w=0; w<m_words.size(); w++)
+			{
+				quint64 word = m_words.at(w);
+				// a run starts wherever a bit is set and its predecessor is not
+				quint64 starts = word & ~((word << 1) | carry);
+				for(; starts; runs++)
+					starts &= starts - 1;
+				carry = word >> 63;
+			}
+			return runs;
+		}
+		//! Return whether no row is set
+		bool isEmpty() const
+		{
+			for(int w=0; w<m_words.size(); w++)
+				if (m_words.at(w)) return false;
+			return true;
+		}
+		//! Unset all rows
+		void clear() { m_words.clear(); }
+		//! Access to the words, e.g. for word-at-a-time scans (bit (row & 63) of word (row >> 6))
+		const QVector<quint64>& words() const { return m_words; }
+
+	private:
+		//! Mask of the bits of word 'w' which lie inside 'i'
+		static quint64 rangeMask(int w, const Interval<int>& i)
+		{
+			int lo = qMax(i.start() - w * 64, 0);
+			int hi = qMin(i.end() - w * 64, 63);
+			quint64 upper = (hi == 63) ? ~Q_UINT64_C(0) : ((Q_UINT64_C(1) << (hi + 1)) - 1);
+			return upper & (~Q_UINT64_C(0) << lo);
+		}
+		//! Read up to 64 bits starting at bit 'pos'
+		static quint64 readBits(const quint64 * src, int src_words, int pos)
+		{
+			int w = pos >> 6, b = pos & 63;
+			quint64 result = w < src_words ? src[w] >> b : 0;
+			if (b && w + 1 < src_words)
+				result |= src[w + 1] << (64 - b);
+			return result;
+		}
+		//! Copy 'count' bits from 'src' (starting at bit 'src_pos') to 'dest' (starting at bit 'dest_pos')
+		/**
+		 * 'dest' must be zero-initialized and large enough; reads beyond 'src' yield zeros.
+		 */
+		void copyBits(quint64 * dest, int dest_pos, const quint64 * src, int src_pos, int count) const
+		{
+			int src_words = m_words.size();
+			while (count > 0)
+			{
+				int b = dest_pos & 63;
+				int n = qMin(64 - b, count);
+				quint64 chunk = readBits(src, src_words, src_pos);
+				if (n < 64)
+					chunk &= (Q_UINT64_C(1) << n) - 1;
+				dest[dest_pos >> 6] |= chunk << b;
+				dest_pos += n;
+				src_pos += n;
+				count -= n;
+			}
+		}
+		//! Drop trailing zero words
+		void squeeze()
+		{
+			int size = m_words.size();
+			while (size > 0 && m_words.at(size - 1) == 0)
+				size--;
+			if (size != m_words.size())
+				m_words.resize(size);
+		}
+
+		QVector<quint64> m_words;
+};
+
+#endif // ifndef ROWBITMAP_H
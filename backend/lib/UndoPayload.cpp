@@ -0,0 +1,406 @@
+/***************************************************************************
+    File                 : UndoPayload.cpp
+    Project              : SciDAVis
+    Description          : Backup data of undo commands within a memory budget
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "lib/UndoPayload.h"
+#include "lib/ProjectArchive.h"
+
+#include <QDir>
+#include <QMutexLocker>
+#include <QTemporaryFile>
+#include <QtDebug>
+
+#include <string.h>
+
+//! zlib level used for payloads; anything above 1 costs much more time for little gain
+static const int compression_level = 1;
+
+UndoPayload::UndoPayload()
+	: m_kind(Empty), m_state(Plain), m_count(0), m_stack(0), m_offset(0), m_packed_size(0),
+	m_bytes(0), m_data_size(0)
+{
+}
+
+UndoPayload::~UndoPayload()
+{
+	clear();
+}
+
+void UndoPayload::clear()
+{
+	if (m_kind == Empty) return;
+	UndoMemory::instance()->remove(this);
+	m_kind = Empty;
+	m_state = Plain;
+	m_count = 0;
+	m_stack = 0;
+	m_values = QVector<double>();
+	m_texts = QStringList();
+	m_date_times = QList<QDateTime>();
+	m_packed = QByteArray();
+}
+
+void UndoPayload::setValues(const QVector<double> & values, const QUndoStack * stack)
+{
+	clear();
+	m_kind = Values;
+	m_count = values.size();
+	m_stack = stack;
+	m_values = values;
+	UndoMemory::instance()->add(this);
+}
+
+void UndoPayload::setTexts(const QStringList & texts, const QUndoStack * stack)
+{
+	clear();
+	m_kind = Texts;
+	m_count = texts.size();
+	m_stack = stack;
+	m_texts = texts;
+	UndoMemory::instance()->add(this);
+}
+
+void UndoPayload::setDateTimes(const QList<QDateTime> & date_times, const QUndoStack * stack)
+{
+	clear();
+	m_kind = DateTimes;
+	m_count = date_times.size();
+	m_stack = stack;
+	m_date_times = date_times;
+	UndoMemory::instance()->add(this);
+}
+
+QVector<double> UndoPayload::values() const
+{
+	if (m_kind != Values) return QVector<double>();
+	UndoMemory * memory = UndoMemory::instance();
+	QMutexLocker locker(&memory->m_mutex);
+	memory->touch(this);
+	if (m_state == Plain) return m_values;
+	return UndoMemory::unpackValues(memory->packedData(this));
+}
+
+QStringList UndoPayload::texts() const
+{
+	if (m_kind != Texts) return QStringList();
+	UndoMemory * memory = UndoMemory::instance();
+	QMutexLocker locker(&memory->m_mutex);
+	memory->touch(this);
+	if (m_state == Plain) return m_texts;
+	return ProjectArchive::decodeStrings(qUncompress(memory->packedData(this)));
+}
+
+QList<QDateTime> UndoPayload::dateTimes() const
+{
+	if (m_kind != DateTimes) return QList<QDateTime>();
+	UndoMemory * memory = UndoMemory::instance();
+	QMutexLocker locker(&memory->m_mutex);
+	memory->touch(this);
+	if (m_state == Plain) return m_date_times;
+	return ProjectArchive::decodeDateTimes(qUncompress(memory->packedData(this)));
+}
+
+UndoMemory * UndoMemory::instance()
+{
+	static UndoMemory memory;
+	return &memory;
+}
+
+UndoMemory::UndoMemory()
+	: m_budget(qint64(256) << 20), m_usage(0), m_file(0), m_swapped(0)
+{
+}
+
+UndoMemory::~UndoMemory()
+{
+	delete m_file;
+}
+
+qint64 UndoMemory::budget() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_budget;
+}
+
+void UndoMemory::setBudget(qint64 bytes)
+{
+	QMutexLocker locker(&m_mutex);
+	m_budget = qMax(qint64(0), bytes);
+	enforceBudget();
+}
+
+qint64 UndoMemory::memoryUsage(const QUndoStack * stack) const
+{
+	QMutexLocker locker(&m_mutex);
+	if (!stack) return m_usage;
+	qint64 result = 0;
+	foreach(const UndoPayload * payload, m_payloads)
+		if (payload->m_stack == stack)
+			result += payload->m_bytes;
+	return result;
+}
+
+qint64 UndoMemory::diskUsage(const QUndoStack * stack) const
+{
+	QMutexLocker locker(&m_mutex);
+	qint64 result = 0;
+	foreach(const UndoPayload * payload, m_payloads)
+		if (payload->m_state == UndoPayload::Swapped && (!stack || payload->m_stack == stack))
+			result += payload->m_packed_size;
+	return result;
+}
+
+qint64 UndoMemory::dataSize(const QUndoStack * stack) const
+{
+	QMutexLocker locker(&m_mutex);
+	qint64 result = 0;
+	foreach(const UndoPayload * payload, m_payloads)
+		if (!stack || payload->m_stack == stack)
+			result += payload->m_data_size;
+	return result;
+}
+
+qint64 UndoMemory::swapFileSize() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_file ? m_file->size() : 0;
+}
+
+void UndoMemory::add(UndoPayload * payload)
+{
+	QMutexLocker locker(&m_mutex);
+	payload->m_state = UndoPayload::Plain;
+	payload->m_data_size = payload->m_bytes = plainSize(payload);
+	m_usage += payload->m_bytes;
+	m_payloads.append(payload);
+	enforceBudget();
+}
+
+void UndoMemory::remove(UndoPayload * payload)
+{
+	QMutexLocker locker(&m_mutex);
+	m_payloads.removeAll(payload);
+	m_usage -= payload->m_bytes;
+	if (payload->m_state != UndoPayload::Swapped) return;
+	if (--m_swapped == 0)
+	{
+		// nothing left in the file, start from scratch
+		m_free_ranges.clear();
+		m_file->resize(0);
+	}
+	else
+		freeRange(payload->m_offset, payload->m_packed_size);
+}
+
+void UndoMemory::freeRange(qint64 offset, qint64 size)
+{
+	// merge with the adjacent unused ranges
+	QMap<qint64, qint64>::iterator next = m_free_ranges.lowerBound(offset);
+	if (next != m_free_ranges.end() && next.key() == offset + size)
+	{
+		size += next.value();
+		next = m_free_ranges.erase(next);
+	}
+	if (next != m_free_ranges.begin())
+	{
+		QMap<qint64, qint64>::iterator previous = next - 1;
+		if (previous.key() + previous.value() == offset)
+		{
+			offset = previous.key();
+			size += previous.value();
+			m_free_ranges.erase(previous);
+		}
+	}
+	if (offset + size >= m_file->size())
+		// the end of the file is unused
+		m_file->resize(offset);
+	else
+		m_free_ranges.insert(offset, size);
+}
+
+void UndoMemory::touch(const UndoPayload * payload)
+{
+	int index = m_payloads.indexOf(const_cast<UndoPayload *>(payload));
+	if (index >= 0 && index < m_payloads.size() - 1)
+		m_payloads.move(index, m_payloads.size() - 1);
+}
+
+QByteArray UndoMemory::packedData(const UndoPayload * payload) const
+{
+	if (payload->m_state == UndoPayload::Compressed)
+		return payload->m_packed;
+	QByteArray result;
+	if (m_file->seek(payload->m_offset))
+		result = m_file->read(payload->m_packed_size);
+	if (result.size() != payload->m_packed_size)
+	{
+		qWarning() << "could not read undo data from" << m_file->fileName();
+		return QByteArray();
+	}
+	return result;
+}
+
+void UndoMemory::enforceBudget()
+{
+	for (int i=0; i<m_payloads.size() && m_usage > m_budget / 2; i++)
+		if (m_payloads.at(i)->m_state == UndoPayload::Plain)
+			compress(m_payloads.at(i));
+	for (int i=0; i<m_payloads.size() && m_usage > m_budget; i++)
+		if (m_payloads.at(i)->m_state == UndoPayload::Compressed && !swapOut(m_payloads.at(i)))
+			break;
+}
+
+void UndoMemory::compress(UndoPayload * payload)
+{
+	switch (payload->m_kind)
+	{
+		case UndoPayload::Values:
+			payload->m_packed = packValues(payload->m_values);
+			payload->m_values = QVector<double>();
+			break;
+		case UndoPayload::Texts:
+			payload->m_packed = qCompress(ProjectArchive::encodeStrings(payload->m_texts), compression_level);
+			payload->m_texts = QStringList();
+			break;
+		case UndoPayload::DateTimes:
+			payload->m_packed = qCompress(ProjectArchive::encodeDateTimes(payload->m_date_times), compression_level);
+			payload->m_date_times = QList<QDateTime>();
+			break;
+		case UndoPayload::Empty:
+			return;
+	}
+	payload->m_state = UndoPayload::Compressed;
+	m_usage -= payload->m_bytes;
+	payload->m_bytes = payload->m_packed.size();
+	m_usage += payload->m_bytes;
+}
+
+bool UndoMemory::swapOut(UndoPayload * payload)
+{
+	if (!m_file)
+	{
+		m_file = new QTemporaryFile(QDir::tempPath() + "/scidavis-undo-XXXXXX");
+		if (!m_file->open())
+		{
+			qWarning() << "could not create a temporary file for undo data";
+			delete m_file;
+			m_file = 0;
+			return false;
+		}
+	}
+	// fill the first gap which is large enough, append otherwise
+	qint64 size = payload->m_packed.size();
+	QMap<qint64, qint64>::iterator gap = m_free_ranges.begin();
+	while (gap != m_free_ranges.end() && gap.value() < size)
+		++gap;
+	qint64 offset = gap != m_free_ranges.end() ? gap.key() : m_file->size();
+	if (!m_file->seek(offset) || m_file->write(payload->m_packed) != size)
+	{
+		qWarning() << "could not write undo data to" << m_file->fileName();
+		// keep the file consistent with the payloads it holds
+		if (gap == m_free_ranges.end())
+			m_file->resize(offset);
+		return false;
+	}
+	if (gap != m_free_ranges.end())
+	{
+		qint64 rest = gap.value() - size;
+		m_free_ranges.erase(gap);
+		if (rest > 0)
+			m_free_ranges.insert(offset + size, rest);
+	}
+	payload->m_offset = offset;
+	payload->m_packed_size = payload->m_packed.size();
+	payload->m_packed = QByteArray();
+	payload->m_state = UndoPayload::Swapped;
+	m_usage -= payload->m_bytes;
+	payload->m_bytes = 0;
+	m_swapped++;
+	return true;
+}
+
+QByteArray UndoMemory::packValues(const QVector<double> & values)
+{
+	int n = values.size();
+	QByteArray bytes(n * int(sizeof(double)), 0);
+	uchar * out = reinterpret_cast<uchar *>(bytes.data());
+	const double * in = values.constData();
+	// byte b of the i-th XORed value goes to position b*n+i
+	quint64 previous = 0;
+	for (int i=0; i<n; i++)
+	{
+		quint64 bits;
+		memcpy(&bits, in + i, sizeof(bits));
+		quint64 delta = bits ^ previous;
+		previous = bits;
+		for (int b=0; b<8; b++)
+			out[b*n + i] = uchar(delta >> (8*b));
+	}
+	return qCompress(bytes, compression_level);
+}
+
+QVector<double> UndoMemory::unpackValues(const QByteArray & data)
+{
+	QByteArray bytes = qUncompress(data);
+	int n = bytes.size() / int(sizeof(double));
+	QVector<double> result(n);
+	const uchar * in = reinterpret_cast<const uchar *>(bytes.constData());
+	double * out = result.data();
+	quint64 previous = 0;
+	for (int i=0; i<n; i++)
+	{
+		quint64 delta = 0;
+		for (int b=0; b<8; b++)
+			delta |= quint64(in[b*n + i]) << (8*b);
+		previous ^= delta;
+		memcpy(out + i, &previous, sizeof(previous));
+	}
+	return result;
+}
+
+qint64 UndoMemory::plainSize(const UndoPayload * payload)
+{
+	switch (payload->m_kind)
+	{
+		case UndoPayload::Values:
+			return qint64(payload->m_count) * sizeof(double);
+		case UndoPayload::Texts:
+			{
+				// list node and string header per entry, plus the characters
+				qint64 result = qint64(payload->m_count) * (sizeof(void *) + 24);
+				foreach(const QString & text, payload->m_texts)
+					result += text.size() * sizeof(QChar);
+				return result;
+			}
+		case UndoPayload::DateTimes:
+			// list node and the private data of QDateTime
+			return qint64(payload->m_count) * (sizeof(void *) + 32);
+		case UndoPayload::Empty:
+			break;
+	}
+	return 0;
+}
@@ -0,0 +1,180 @@
+/***************************************************************************
+    File                 : UndoPayload.h
+    Project              : SciDAVis
+    Description          : Backup data of undo commands within a memory budget
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef UNDO_PAYLOAD_H
+#define UNDO_PAYLOAD_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+
+class QUndoStack;
+class QTemporaryFile;
+
+//! Backup data of an undo command, e.g. the old values of a column
+/**
+ * Commands which have to restore large amounts of data on undo keep their backups in
+ * an UndoPayload instead of a plain container, so UndoMemory can account for them and
+ * keep the memory used by all undo stacks within a budget. A payload always returns the
+ * data it was given, no matter whether it is currently held in memory, compressed or
+ * written to the swap file of UndoMemory.
+ *
+ * Payloads can't be copied; they belong to exactly one command.
+ */
+class UndoPayload
+{
+	public:
+		enum Kind { Empty, Values, Texts, DateTimes };
+
+		UndoPayload();
+		~UndoPayload();
+
+		Kind kind() const { return m_kind; }
+		bool isEmpty() const { return m_kind == Empty; }
+		//! Number of values, strings or date-times stored
+		int count() const { return m_count; }
+		//! Drop the data
+		void clear();
+
+		//! Store 'values'; 'stack' is the undo stack of the command the payload belongs to
+		void setValues(const QVector<double> & values, const QUndoStack * stack);
+		void setTexts(const QStringList & texts, const QUndoStack * stack);
+		void setDateTimes(const QList<QDateTime> & date_times, const QUndoStack * stack);
+
+		//! Return the values stored by setValues(), reading them back if necessary
+		QVector<double> values() const;
+		QStringList texts() const;
+		QList<QDateTime> dateTimes() const;
+
+	private:
+		UndoPayload(const UndoPayload &);
+		UndoPayload & operator=(const UndoPayload &);
+		friend class UndoMemory;
+
+		//! Where the data is kept
+		enum State { Plain, Compressed, Swapped };
+
+		Kind m_kind;
+		State m_state;
+		int m_count;
+		const QUndoStack * m_stack;
+		//! The data, for m_state == Plain
+		QVector<double> m_values;
+		QStringList m_texts;
+		QList<QDateTime> m_date_times;
+		//! The data in compressed form, for m_state == Compressed
+		QByteArray m_packed;
+		//! Position and size of the compressed data in the swap file, for m_state == Swapped
+		qint64 m_offset;
+		int m_packed_size;
+		//! Memory used in the current state (estimated for strings and date-times)
+		qint64 m_bytes;
+		//! Memory used in state Plain
+		qint64 m_data_size;
+};
+
+//! Keeps the backup data of all undo commands within a memory budget
+/**
+ * Every UndoPayload registers itself here. As long as the payloads use no more than half
+ * of the budget they are kept as they are, which makes undo and redo as fast as before.
+ * Beyond that, the least recently used payloads are compressed: doubles are XORed with
+ * their predecessor and stored with their bytes transposed, which turns the mostly equal
+ * sign, exponent and high mantissa bits of smooth data into long runs of zeros, before
+ * zlib (at its fastest level) is applied; strings and date-times are compressed in the
+ * format of ProjectArchive. If the budget is still exceeded, compressed payloads are moved
+ * to a temporary file, again least recently used first. Reading a payload doesn't move it
+ * back into memory, so undoing and redoing a large change doesn't need additional memory.
+ * The space of payloads removed from the file is reused, and the file shrinks whenever its
+ * end is no longer used.
+ *
+ * All methods are thread-safe.
+ */
+class UndoMemory
+{
+	public:
+		static UndoMemory * instance();
+
+		qint64 budget() const;
+		void setBudget(qint64 bytes);
+
+		//! Memory used by the payloads of the commands on 'stack' (all stacks if 0)
+		qint64 memoryUsage(const QUndoStack * stack = 0) const;
+		//! Space taken in the swap file by the payloads of the commands on 'stack' (all stacks if 0)
+		qint64 diskUsage(const QUndoStack * stack = 0) const;
+		//! Memory the payloads of the commands on 'stack' would use without compression
+		qint64 dataSize(const QUndoStack * stack = 0) const;
+		//! Size of the swap file, including gaps left by payloads removed from it
+		qint64 swapFileSize() const;
+
+		//! Compressed form of 'values', bit-exact for all doubles including NaNs
+		static QByteArray packValues(const QVector<double> & values);
+		static QVector<double> unpackValues(const QByteArray & data);
+
+	private:
+		UndoMemory();
+		~UndoMemory();
+		friend class UndoPayload;
+
+		//! Start accounting for 'payload', which has just been filled
+		void add(UndoPayload * payload);
+		//! Stop accounting for 'payload', which is about to be cleared
+		void remove(UndoPayload * payload);
+
+		// the following methods have to be called with m_mutex locked
+		//! Mark 'payload' as the most recently used one
+		void touch(const UndoPayload * payload);
+		//! Return the compressed data of a payload which is not in state Plain
+		QByteArray packedData(const UndoPayload * payload) const;
+		//! Compress or swap out least recently used payloads until the budget is met
+		void enforceBudget();
+		void compress(UndoPayload * payload);
+		bool swapOut(UndoPayload * payload);
+		//! Mark 'size' bytes at 'offset' of the swap file as unused
+		void freeRange(qint64 offset, qint64 size);
+		//! Estimated size in memory of an uncompressed payload
+		static qint64 plainSize(const UndoPayload * payload);
+
+		mutable QMutex m_mutex;
+		qint64 m_budget;
+		//! Sum of UndoPayload::m_bytes of all payloads not swapped out
+		qint64 m_usage;
+		//! All non-empty payloads, least recently used first
+		QList<UndoPayload *> m_payloads;
+		//! Swap file, created on demand
+		QTemporaryFile * m_file;
+		//! Number of payloads in the swap file
+		int m_swapped;
+		//! Unused ranges of the swap file (offset, size), reused by swapOut()
+		QMap<qint64, qint64> m_free_ranges;
+};
+
+#endif // ifndef UNDO_PAYLOAD_H
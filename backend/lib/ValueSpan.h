@@ -0,0 +1,147 @@
+/***************************************************************************
+    File                 : ValueSpan.h
+    Project              : SciDAVis
+    Description          : Read-only view of a range of double values
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef VALUESPAN_H
+#define VALUESPAN_H
+
+#include "Interval.h"
+#include <QVector>
+#include <QList>
+#include <QtGlobal>
+
+//! Read-only view of the double values and validity flags of a range of rows
+/**
+ * A ValueSpan is what AbstractColumn::valueSpan() hands out to code that wants to
+ * run tight loops over column data instead of calling the virtual valueAt() for
+ * every single row. It either references the contiguous storage of the column
+ * directly (no copy at all) or owns a materialized copy of the values (e.g. when
+ * the column is the output of a filter).
+ *
+ * All indices passed to the access functions are relative to the first row
+ * of the span, i.e. at(0) is the value of row first().
+ *
+ * A span which references column storage is only valid until the column is
+ * changed the next time. Don't keep it around; request a new one instead.
+ */
+class ValueSpan
+{
+	public:
+		//! Create an empty span
+		ValueSpan() : m_data(0), m_first(0), m_size(0) {}
+		//! Create a span referencing external storage
+		/**
+		 * \param first number of the first row in the span
+		 * \param size number of rows in the span
+		 * \param data pointer to the value of row 'first'
+		 */
+		ValueSpan(int first, int size, const double * data)
+			: m_data(data), m_first(first), m_size(size) {}
+		//! Create a span owning its values
+		ValueSpan(int first, const QVector<double>& values)
+			: m_first(first), m_size(values.size()), m_buffer(values)
+		{
+			m_data = m_buffer.constData();
+		}
+		ValueSpan(const ValueSpan& other)
+			: m_first(other.m_first), m_size(other.m_size),
+			m_buffer(other.m_buffer), m_invalid_bits(other.m_invalid_bits)
+		{
+			m_data = other.isMaterialized() ? m_buffer.constData() : other.m_data;
+		}
+		ValueSpan& operator=(const ValueSpan& other)
+		{
+			m_first = other.m_first;
+			m_size = other.m_size;
+			m_buffer = other.m_buffer;
+			m_invalid_bits = other.m_invalid_bits;
+			m_data = other.isMaterialized() ? m_buffer.constData() : other.m_data;
+			return *this;
+		}
+
+		//! Number of the first row in the span
+		int first() const { return m_first; }
+		//! Number of rows in the span
+		int size() const { return m_size; }
+		bool isEmpty() const { return m_size <= 0; }
+		//! The rows covered by this span
+		Interval<int> rows() const { return Interval<int>(m_first, m_first + m_size - 1); }
+		//! Whether the span owns a copy of the values (as opposed to referencing column storage)
+		bool isMaterialized() const { return !m_buffer.isEmpty(); }
+
+		//! Pointer to the contiguous values; data()[i] is the value of row first()+i
+		const double * data() const { return m_data; }
+		//! Return the value of row first()+i
+		double at(int i) const { return m_data[i]; }
+		double operator[](int i) const { return m_data[i]; }
+
+		//! Whether any of the rows in the span is invalid
+		bool hasInvalid() const { return !m_invalid_bits.isEmpty(); }
+		//! Return whether row first()+i is invalid
+		bool isInvalid(int i) const
+		{
+			if (m_invalid_bits.isEmpty()) return false;
+			return (m_invalid_bits.at(i >> 6) >> (i & 63)) & 1;
+		}
+		//! Return the invalid flags as a bitmap, one bit per row (bit set = invalid)
+		/**
+		 * Bit (i & 63) of word (i >> 6) corresponds to row first()+i. The vector
+		 * is empty if all rows in the span are valid.
+		 */
+		const QVector<quint64>& invalidBits() const { return m_invalid_bits; }
+		//! Mark the rows of the given intervals (absolute row numbers) as invalid
+		void setInvalid(const QList< Interval<int> >& intervals)
+		{
+			foreach(Interval<int> iv, intervals)
+			{
+				int start = qMax(iv.start(), m_first) - m_first;
+				int end = qMin(iv.end(), m_first + m_size - 1) - m_first;
+				if (start > end) continue;
+				if (m_invalid_bits.isEmpty())
+					m_invalid_bits.fill(0, (m_size + 63) >> 6);
+				for (int i = start; i <= end; )
+				{
+					int bit = i & 63;
+					int n = qMin(64 - bit, end - i + 1);
+					quint64 mask = (n == 64) ? ~Q_UINT64_C(0) : (((Q_UINT64_C(1) << n) - 1) << bit);
+					m_invalid_bits[i >> 6] |= mask;
+					i += n;
+				}
+			}
+		}
+
+	private:
+		const double * m_data;
+		int m_first;
+		int m_size;
+		//! Materialized values (empty if the span references external storage)
+		QVector<double> m_buffer;
+		//! One bit per row, set = invalid
+		QVector<quint64> m_invalid_bits;
+};
+
+#endif // ifndef VALUESPAN_H
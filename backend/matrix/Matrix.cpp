@@ -34,6 +34,9 @@
 #include "matrixcommands.h"
 #include "lib/ActionManager.h"
 #include "lib/XmlStreamReader.h"
+#include "lib/ProjectArchive.h"
+#include "lib/ParallelFor.h"
+#include "MatrixKernels.h"
 
 #include <QtCore>
 #include <QtGui>
@@ -42,6 +45,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <gsl/gsl_linalg.h>
 #include <gsl/gsl_math.h>
@@ -1059,7 +1063,21 @@ void Matrix::save(QXmlStreamWriter * writer) const
 	writer->writeAttribute("y_end", QString::number(yEnd()));
 	writer->writeEndElement();
 
-	for (int col=0; col<cols; col++)
+	ProjectArchive * archive = qobject_cast<ProjectArchive *>(writer->device());
+	if (archive)
+	{
+		// binary project: store all cells column by column in one block
+		QByteArray bytes;
+		for (int col=0; col<cols && rows>0; col++)
+		{
+			MatrixSlice values = m_matrix_private->slice(0, col, rows-1, col);
+			bytes += ProjectArchive::encodeDoubles(values.data(), values.rowCount());
+		}
+		writer->writeStartElement("data");
+		writer->writeAttribute("block", QString::number(archive->writeBlock(bytes)));
+		writer->writeEndElement();
+	}
+	else for (int col=0; col<cols; col++)
 		for (int row=0; row<rows; row++)
 		{
 			writer->writeStartElement("cell");
@@ -1131,6 +1149,8 @@ bool Matrix::load(XmlStreamReader * reader)
 					ret_val = readCoordinatesElement(reader);
 				else if(reader->name() == "cell")
 					ret_val = readCellElement(reader);
+				else if(reader->name() == "data")
+					ret_val = readDataElement(reader);
 				else if(reader->name() == "row_height")
 					ret_val = readRowHeightElement(reader);
 				else if(reader->name() == "column_width")
@@ -1308,6 +1328,42 @@ bool Matrix::readCellElement(XmlStreamReader * reader)
 	return true;
 }
 
+bool Matrix::readDataElement(XmlStreamReader * reader)
+{
+	Q_ASSERT(reader->isStartElement() && reader->name() == "data");
+
+	ProjectArchive * archive = qobject_cast<ProjectArchive *>(reader->device());
+	if (!archive)
+	{
+		reader->raiseError(tr("data block reference outside of a binary project"));
+		return false;
+	}
+	bool ok;
+	int block = reader->readAttributeInt("block", &ok);
+	if(!ok || block < 0 || block >= archive->blockCount())
+	{
+		reader->raiseError(tr("invalid or missing data block"));
+		return false;
+	}
+	int rows = rowCount();
+	int cols = columnCount();
+	QVector<double> values = ProjectArchive::decodeDoubles(archive->block(block).read());
+	if (values.size() != rows * cols)
+	{
+		reader->raiseError(tr("matrix data block has the wrong size"));
+		return false;
+	}
+	QVector<double> column(rows);
+	for (int col=0; col<cols && rows>0; col++)
+	{
+		qCopy(values.constBegin() + col*rows, values.constBegin() + (col+1)*rows, column.begin());
+		m_matrix_private->setColumnCells(col, 0, rows-1, column);
+	}
+	if (!reader->skipToEndElement()) return false;
+
+	return true;
+}
+
 void Matrix::setRowHeight(int row, int height) 
 { 
 	m_matrix_private->setRowHeight(row, height); 
@@ -1360,6 +1416,21 @@ void Matrix::setRowCells(int row, int first_column, int last_column, const QVect
 	RESET_CURSOR;
 }
 
+MatrixSlice Matrix::columnSlice(int col, int first_row, int last_row) const
+{
+	return m_matrix_private->slice(first_row, col, last_row, col);
+}
+
+MatrixSlice Matrix::rowSlice(int row, int first_column, int last_column) const
+{
+	return m_matrix_private->slice(row, first_column, row, last_column);
+}
+
+MatrixSlice Matrix::slice(int top, int left, int bottom, int right) const
+{
+	return m_matrix_private->slice(top, left, bottom, right);
+}
+
 void Matrix::transpose()
 {
 	WAIT_CURSOR;
@@ -1442,10 +1513,31 @@ Matrix * Matrix::fromImage(const QImage & image)
 	return matrix;
 }
 
+/* ========================== MatrixSlice ========================== */
+
+QVector<double> MatrixSlice::toVector() const
+{
+	QVector<double> result(m_rows*m_columns);
+	double *out = result.data();
+	for (int col=0; col<m_columns; col++)
+		for (int row=0; row<m_rows; row++)
+			*out++ = at(row, col);
+	return result;
+}
+
 /* ========================== Matrix::Private ====================== */
 
+//! Minimum number of cells a thread started by parallelFor() should work on
+static const int matrix_min_cells_per_thread = 1 << 16;
+
+//! Minimum chunk size for parallelFor() over items of 'cells' cells each
+static int minChunkSize(int cells)
+{
+	return qMax(1, matrix_min_cells_per_thread/qMax(cells, 1));
+}
+
 Matrix::Private::Private(Matrix *owner) 
-	: m_owner(owner), m_column_count(0), m_row_count(0) 
+	: m_owner(owner), m_column_count(0), m_row_count(0), m_stride(0)
 {
 	m_block_change_signals = false;
 	m_numeric_format = 'f';
@@ -1456,17 +1548,25 @@ Matrix::Private::Private(Matrix *owner)
 	m_y_end = 1.0;
 }
 
+void Matrix::Private::reallocate(int stride)
+{
+	Q_ASSERT(stride >= m_row_count);
+	QVector<double> data(m_column_count*stride);
+	for (int col=0; col<m_column_count; col++)
+		memcpy(data.data() + col*stride, columnData(col), m_row_count*sizeof(double));
+	m_data = data;
+	m_stride = stride;
+}
+
 void Matrix::Private::insertColumns(int before, int count)
 {
 	Q_ASSERT(before >= 0);
 	Q_ASSERT(before <= m_column_count);
 
 	emit m_owner->columnsAboutToBeInserted(before, count);
+	m_data.insert(before*m_stride, count*m_stride, 0.0);
 	for(int i=0; i<count; i++)
-	{
-		m_data.insert(before+i, QVector<double>(m_row_count));
 		m_column_widths.insert(before+i, Matrix::defaultColumnWidth());
-	}
 
 	m_column_count += count;
 	emit m_owner->columnsInserted(before, count);
@@ -1477,7 +1577,7 @@ void Matrix::Private::removeColumns(int first, int count)
 	emit m_owner->columnsAboutToBeRemoved(first, count);
 	Q_ASSERT(first >= 0);
 	Q_ASSERT(first+count <= m_column_count);
-	m_data.remove(first, count);
+	m_data.remove(first*m_stride, count*m_stride);
 	for (int i=0; i<count; i++)
 		m_column_widths.removeAt(first);
 	m_column_count -= count;
@@ -1489,9 +1589,15 @@ void Matrix::Private::insertRows(int before, int count)
 	emit m_owner->rowsAboutToBeInserted(before, count);
 	Q_ASSERT(before >= 0);
 	Q_ASSERT(before <= m_row_count);
+	// grow geometrically, so that appending rows one at a time stays linear
+	if (m_row_count + count > m_stride)
+		reallocate(qMax(m_row_count + count, m_stride*3/2));
 	for(int col=0; col<m_column_count; col++)
-		for(int i=0; i<count; i++)
-			m_data[col].insert(before+i, 0.0);
+	{
+		double *column = columnData(col);
+		memmove(column + before + count, column + before, (m_row_count - before)*sizeof(double));
+		qFill(column + before, column + before + count, 0.0);
+	}
 	for(int i=0; i<count; i++)
 		m_row_heights.insert(before+i, Matrix::defaultRowHeight());
 
@@ -1505,11 +1611,18 @@ void Matrix::Private::removeRows(int first, int count)
 	Q_ASSERT(first >= 0);
 	Q_ASSERT(first+count <= m_row_count);
 	for(int col=0; col<m_column_count; col++)
-		m_data[col].remove(first, count);
+	{
+		double *column = columnData(col);
+		memmove(column + first, column + first + count, (m_row_count - first - count)*sizeof(double));
+	}
 	for (int i=0; i<count; i++)
 		m_row_heights.removeAt(first);
 
 	m_row_count -= count;
+	// give memory back once most of it is unused; keeping some headroom (and shrinking
+	// only below a quarter of the stride) avoids thrashing against the growth in insertRows()
+	if (m_row_count < m_stride/4)
+		reallocate(m_row_count + m_row_count/2);
 	emit m_owner->rowsRemoved(first, count);
 }
 
@@ -1517,14 +1630,14 @@ double Matrix::Private::cell(int row, int col) const
 {
 	Q_ASSERT(row >= 0 && row < m_row_count);
 	Q_ASSERT(col >= 0 && col < m_column_count);
-	return m_data.at(col).at(row);
+	return columnData(col)[row];
 }
 
 void Matrix::Private::setCell(int row, int col, double value)
 {
 	Q_ASSERT(row >= 0 && row < m_row_count);
 	Q_ASSERT(col >= 0 && col < m_column_count);
-	m_data[col][row] = value;
+	columnData(col)[row] = value;
 	if (!m_block_change_signals)
 		emit m_owner->dataChanged(row, col, row, col);
 }
@@ -1534,12 +1647,8 @@ QVector<double> Matrix::Private::columnCells(int col, int first_row, int last_ro
 	Q_ASSERT(first_row >= 0 && first_row < m_row_count);
 	Q_ASSERT(last_row >= 0 && last_row < m_row_count);
 
-	if(first_row == 0 && last_row == m_row_count-1)
-		return m_data.at(col);
-
-	QVector<double> result;
-	for(int i=first_row; i<=last_row; i++)
-		result.append(m_data.at(col).at(i));
+	QVector<double> result(last_row - first_row + 1);
+	memcpy(result.data(), columnData(col) + first_row, result.size()*sizeof(double));
 	return result;
 }
 
@@ -1549,17 +1658,7 @@ void Matrix::Private::setColumnCells(int col, int first_row, int last_row, const
 	Q_ASSERT(last_row >= 0 && last_row < m_row_count);
 	Q_ASSERT(values.count() > last_row - first_row);
 
-	if(first_row == 0 && last_row == m_row_count-1)
-	{
-		m_data[col] = values;
-		m_data[col].resize(m_row_count);  // values may be larger
-		if (!m_block_change_signals)
-			emit m_owner->dataChanged(first_row, col, last_row, col);
-		return;
-	}
-
-	for(int i=first_row; i<=last_row; i++)
-		m_data[col][i] = values.at(i-first_row);
+	memcpy(columnData(col) + first_row, values.constData(), (last_row - first_row + 1)*sizeof(double));
 	if (!m_block_change_signals)
 		emit m_owner->dataChanged(first_row, col, last_row, col);
 }
@@ -1569,10 +1668,7 @@ QVector<double> Matrix::Private::rowCells(int row, int first_column, int last_co
 	Q_ASSERT(first_column >= 0 && first_column < m_column_count);
 	Q_ASSERT(last_column >= 0 && last_column < m_column_count);
 
-	QVector<double> result;
-	for(int i=first_column; i<=last_column; i++)
-		result.append(m_data.at(i).at(row));
-	return result;
+	return slice(row, first_column, row, last_column).toVector();
 }
 
 void Matrix::Private::setRowCells(int row, int first_column, int last_column, const QVector<double> & values)
@@ -1581,15 +1677,93 @@ void Matrix::Private::setRowCells(int row, int first_column, int last_column, co
 	Q_ASSERT(last_column >= 0 && last_column < m_column_count);
 	Q_ASSERT(values.count() > last_column - first_column);
 
-	for(int i=first_column; i<=last_column; i++)
-		m_data[i][row] = values.at(i-first_column);
+	double *cell = columnData(first_column) + row;
+	for(int i=first_column; i<=last_column; i++, cell += m_stride)
+		*cell = values.at(i-first_column);
 	if (!m_block_change_signals)
 		emit m_owner->dataChanged(row, first_column, row, last_column);
 }
 
+MatrixSlice Matrix::Private::slice(int top, int left, int bottom, int right) const
+{
+	Q_ASSERT(top >= 0 && bottom < m_row_count);
+	Q_ASSERT(left >= 0 && right < m_column_count);
+	if (top > bottom || left > right)
+		return MatrixSlice();
+	return MatrixSlice(columnData(left) + top, bottom - top + 1, right - left + 1, 1, m_stride);
+}
+
+void Matrix::Private::transpose()
+{
+	int rows = m_row_count;
+	int cols = m_column_count;
+
+	if (rows == cols)
+		parallelFor(0, (rows + matrix_block_size - 1)/matrix_block_size - 1,
+				MatrixSquareTransposeKernel(m_data.data(), m_stride, rows),
+				minChunkSize(matrix_block_size*rows));
+	else
+	{
+		QVector<double> transposed(rows*cols);
+		if (rows > 0)
+			parallelFor(0, cols-1, MatrixTransposeKernel(m_data.constData(), m_stride, rows, transposed.data(), cols),
+					qMax(matrix_block_size, minChunkSize(rows)));
+
+		// shrink first (the old cells stay valid), then grow into the transposed buffer
+		if (cols < rows)
+		{
+			emit m_owner->rowsAboutToBeRemoved(cols, rows - cols);
+			m_row_count = cols;
+			while (m_row_heights.size() > cols)
+				m_row_heights.removeLast();
+			emit m_owner->rowsRemoved(cols, rows - cols);
+			emit m_owner->columnsAboutToBeInserted(cols, rows - cols);
+			m_data = transposed;
+			m_stride = cols;
+			m_column_count = rows;
+			while (m_column_widths.size() < rows)
+				m_column_widths.append(Matrix::defaultColumnWidth());
+			emit m_owner->columnsInserted(cols, rows - cols);
+		}
+		else
+		{
+			emit m_owner->columnsAboutToBeRemoved(rows, cols - rows);
+			m_column_count = rows;
+			while (m_column_widths.size() > rows)
+				m_column_widths.removeLast();
+			emit m_owner->columnsRemoved(rows, cols - rows);
+			emit m_owner->rowsAboutToBeInserted(rows, cols - rows);
+			m_data = transposed;
+			m_stride = cols;
+			m_row_count = cols;
+			while (m_row_heights.size() < cols)
+				m_row_heights.append(Matrix::defaultRowHeight());
+			emit m_owner->rowsInserted(rows, cols - rows);
+		}
+	}
+	if (!m_block_change_signals)
+		emit m_owner->dataChanged(0, 0, m_row_count-1, m_column_count-1);
+}
+
+void Matrix::Private::mirrorHorizontally()
+{
+	parallelFor(0, m_column_count/2 - 1, MatrixMirrorColumnsKernel(m_data.data(), m_stride, m_row_count, m_column_count),
+			minChunkSize(2*m_row_count));
+	if (!m_block_change_signals)
+		emit m_owner->dataChanged(0, 0, m_row_count-1, m_column_count-1);
+}
+
+void Matrix::Private::mirrorVertically()
+{
+	parallelFor(0, m_column_count - 1, MatrixMirrorRowsKernel(m_data.data(), m_stride, m_row_count),
+			minChunkSize(m_row_count));
+	if (!m_block_change_signals)
+		emit m_owner->dataChanged(0, 0, m_row_count-1, m_column_count-1);
+}
+
 void Matrix::Private::clearColumn(int col)
 {
-	m_data[col].fill(0.0);
+	qFill(columnData(col), columnData(col) + m_row_count, 0.0);
 	if (!m_block_change_signals)
 		emit m_owner->dataChanged(0, col, m_row_count-1, col);
 }
@@ -44,6 +44,48 @@ class ActionManager;
 #define _Matrix_initial_rows_ 10
 #define _Matrix_initial_columns_ 3
 
+//! Read-only view on a rectangle of matrix cells
+/**
+ * A slice points directly into the storage of a Matrix, so creating one does not
+ * copy any cells. Values changed after the slice was created are visible through it,
+ * but the slice becomes invalid as soon as the dimensions of the matrix change
+ * (see Matrix::rowsAboutToBeInserted() and the related signals).
+ *
+ * The cells of one matrix column follow each other in memory, i.e. rowStep() is 1
+ * for slices of a Matrix; slices of a single row have columnStep() as distance
+ * between their cells.
+ */
+class MatrixSlice
+{
+	public:
+		MatrixSlice() : m_data(0), m_rows(0), m_columns(0), m_row_step(0), m_column_step(0) {}
+		MatrixSlice(const double *data, int rows, int columns, int row_step, int column_step)
+			: m_data(data), m_rows(rows), m_columns(columns), m_row_step(row_step), m_column_step(column_step) {}
+
+		int rowCount() const { return m_rows; }
+		int columnCount() const { return m_columns; }
+		bool isEmpty() const { return m_rows == 0 || m_columns == 0; }
+		//! Return the value in the given cell (relative to the top left cell of the slice)
+		double at(int row, int col) const { return m_data[row*m_row_step + col*m_column_step]; }
+		//! Pointer to the top left cell
+		const double *data() const { return m_data; }
+		//! Distance (in cells) between two rows
+		int rowStep() const { return m_row_step; }
+		//! Distance (in cells) between two columns
+		int columnStep() const { return m_column_step; }
+		//! Return a view on the same cells with rows and columns swapped
+		MatrixSlice transposed() const { return MatrixSlice(m_data, m_columns, m_rows, m_column_step, m_row_step); }
+		//! Copy the cells column by column into a vector
+		QVector<double> toVector() const;
+
+	private:
+		const double *m_data;
+		int m_rows;
+		int m_columns;
+		int m_row_step;
+		int m_column_step;
+};
+
 // TODO: move all selection related stuff to the primary view
 
 //! Aspect providing a spreadsheet to manage MxN matrix data
@@ -143,6 +185,12 @@ class Matrix : public AbstractPart, public scripted
 		QVector<double> rowCells(int row, int first_column, int last_column);
 		//! Set the values in the given cells from a double vector
 		void setRowCells(int row, int first_column, int last_column, const QVector<double> & values);
+		//! Return a view on the given cells of a column (without copying them)
+		MatrixSlice columnSlice(int col, int first_row, int last_row) const;
+		//! Return a view on the given cells of a row (without copying them)
+		MatrixSlice rowSlice(int row, int first_column, int last_column) const;
+		//! Return a view on the given rectangle of cells (without copying them)
+		MatrixSlice slice(int top, int left, int bottom, int right) const;
 		//! Return the text displayed in the given cell
 		QString text(int row, int col);
 		void copy(Matrix * other);
@@ -279,6 +327,7 @@ class Matrix : public AbstractPart, public scripted
 		bool readFormulaElement(XmlStreamReader * reader);
 		//! Read XML cell element
 		bool readCellElement(XmlStreamReader * reader);
+		bool readDataElement(XmlStreamReader * reader);
 		bool readRowHeightElement(XmlStreamReader * reader);
 		bool readColumnWidthElement(XmlStreamReader * reader);
 
@@ -336,11 +385,16 @@ class Matrix : public AbstractPart, public scripted
   commands only. Matrix may only call the reading functions to ensure 
   that undo/redo is possible for all data changing operations.
 
-  The values of the matrix are stored as double precision values. They
-  are managed by QVector<double> objects. Although rows and columns
-  are equally important in a matrix, the columns are chosen to
-  be contiguous in memory to allow easier copying between
-  column and matrix data.
+  The values of the matrix are stored as double precision values in a
+  single QVector<double>. Although rows and columns are equally important
+  in a matrix, the columns are chosen to be contiguous in memory to allow
+  easier copying between column and matrix data. Column j starts at
+  index j*m_stride; m_stride may be larger than the number of rows, so
+  that rows can be removed (and inserted again) without moving the
+  whole matrix around.
+
+  The buffer is never shared with other QVectors, so pointers into it
+  (see slice()) stay valid until the dimensions change.
   */
 class Matrix::Private
 {
@@ -379,6 +433,8 @@ class Matrix::Private
 		//! Return the number of rows in the table
 		int rowCount() const { return m_row_count; }
 		QString name() const { return m_owner->name(); }
+		//! Return the matrix this object belongs to
+		Matrix * owner() const { return m_owner; }
 		//! Return the value in the given cell
 		double cell(int row, int col) const;
 		//! Set the value in the given cell
@@ -391,6 +447,19 @@ class Matrix::Private
 		QVector<double> rowCells(int row, int first_column, int last_column);
 		//! Set the values in the given cells from a double vector
 		void setRowCells(int row, int first_column, int last_column, const QVector<double> & values);
+		//! Return a view on the given rectangle of cells
+		MatrixSlice slice(int top, int left, int bottom, int right) const;
+		//! Swap rows and columns
+		/**
+		 * Emits the same signals as removing the surplus rows and then
+		 * inserting the missing columns (or vice versa), followed by
+		 * dataChanged() for the whole matrix.
+		 */
+		void transpose();
+		//! Reverse the order of the columns
+		void mirrorHorizontally();
+		//! Reverse the order of the rows
+		void mirrorVertically();
 		char numericFormat() const { return m_numeric_format; }
 		void setNumericFormat(char format) { m_numeric_format = format; emit m_owner->formatChanged(); }
 		int displayedDigits()  const { return m_displayed_digits; }
@@ -435,8 +504,16 @@ class Matrix::Private
 		int m_column_count;
 		//! The number of rows
 		int m_row_count;
-		//! The matrix data
-		QVector< QVector<double> > m_data;	
+		//! Pointer to the first cell of the given column
+		double *columnData(int col) { return m_data.data() + col*m_stride; }
+		const double *columnData(int col) const { return m_data.constData() + col*m_stride; }
+		//! Replace the storage by a matrix with the given stride, keeping the cells
+		void reallocate(int stride);
+
+		//! The matrix data, column by column
+		QVector<double> m_data;
+		//! The distance between the first cells of two adjacent columns in m_data
+		int m_stride;
 		//! Row widths
 		QList<int> m_row_heights;
 		//! Columns widths
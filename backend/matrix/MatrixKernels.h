@@ -0,0 +1,150 @@
+/***************************************************************************
+    File                 : MatrixKernels.h
+    Project              : SciDAVis
+    Description          : Cache-blocked kernels for Matrix cell storage
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef MATRIX_KERNELS_H
+#define MATRIX_KERNELS_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+// The kernels work on column-major cell storage as used by Matrix::Private: cell (i,j)
+// is at data[j*stride + i], with stride >= number of rows.
+
+//! Edge length of the square blocks the transposition kernels work on
+/**
+ * Two blocks of 32x32 doubles (16 kB) fit into the L1 cache of all current CPUs.
+ */
+const int matrix_block_size = 32;
+
+//! Cache-blocked out-of-place transposition; used with parallelFor()
+/**
+ * Source column j (of length 'rows') becomes destination row j. The loop
+ * range are the source columns, so each thread writes its own destination cells.
+ */
+class MatrixTransposeKernel
+{
+	public:
+		MatrixTransposeKernel(const double *source, int source_stride, int rows, double *dest, int dest_stride)
+			: m_source(source), m_source_stride(source_stride), m_rows(rows), m_dest(dest), m_dest_stride(dest_stride) {}
+
+		void operator()(int first, int last) const {
+			for (int j0=first; j0<=last; j0+=matrix_block_size) {
+				int j1 = qMin(j0+matrix_block_size, last+1);
+				for (int i0=0; i0<m_rows; i0+=matrix_block_size) {
+					int i1 = qMin(i0+matrix_block_size, m_rows);
+					for (int j=j0; j<j1; j++) {
+						const double *source = m_source + j*m_source_stride;
+						for (int i=i0; i<i1; i++)
+							m_dest[i*m_dest_stride + j] = source[i];
+					}
+				}
+			}
+		}
+
+	private:
+		const double *m_source;
+		int m_source_stride;
+		int m_rows;
+		double *m_dest;
+		int m_dest_stride;
+};
+
+//! Cache-blocked in-place transposition of a square matrix; used with parallelFor()
+/**
+ * The loop range are the block rows; block row b swaps its blocks right of the
+ * diagonal with the blocks below the diagonal in block column b, so no two
+ * chunks touch the same cells.
+ */
+class MatrixSquareTransposeKernel
+{
+	public:
+		MatrixSquareTransposeKernel(double *data, int stride, int size)
+			: m_data(data), m_stride(stride), m_size(size) {}
+
+		void operator()(int first, int last) const {
+			for (int b=first; b<=last; b++) {
+				int i0 = b*matrix_block_size, i1 = qMin(i0+matrix_block_size, m_size);
+				for (int j0=i0; j0<m_size; j0+=matrix_block_size) {
+					int j1 = qMin(j0+matrix_block_size, m_size);
+					for (int j=j0; j<j1; j++)
+						for (int i=i0; i<i1 && (j0 != i0 || i<j); i++)
+							qSwap(m_data[j*m_stride + i], m_data[i*m_stride + j]);
+				}
+			}
+		}
+
+	private:
+		double *m_data;
+		int m_stride;
+		int m_size;
+};
+
+//! Swap column j with column count-1-j; used with parallelFor() over j < count/2
+class MatrixMirrorColumnsKernel
+{
+	public:
+		MatrixMirrorColumnsKernel(double *data, int stride, int rows, int count)
+			: m_data(data), m_stride(stride), m_rows(rows), m_count(count) {}
+
+		void operator()(int first, int last) const {
+			for (int j=first; j<=last; j++) {
+				double *left = m_data + j*m_stride;
+				double *right = m_data + (m_count-1-j)*m_stride;
+				for (int i=0; i<m_rows; i++)
+					qSwap(left[i], right[i]);
+			}
+		}
+
+	private:
+		double *m_data;
+		int m_stride;
+		int m_rows;
+		int m_count;
+};
+
+//! Reverse the cells of each column; used with parallelFor() over the columns
+class MatrixMirrorRowsKernel
+{
+	public:
+		MatrixMirrorRowsKernel(double *data, int stride, int rows)
+			: m_data(data), m_stride(stride), m_rows(rows) {}
+
+		void operator()(int first, int last) const {
+			for (int j=first; j<=last; j++) {
+				double *column = m_data + j*m_stride;
+				for (int i=0; i<m_rows/2; i++)
+					qSwap(column[i], column[m_rows-1-i]);
+			}
+		}
+
+	private:
+		double *m_data;
+		int m_stride;
+		int m_rows;
+};
+
+#endif // ifndef MATRIX_KERNELS_H
@@ -29,6 +29,25 @@
 
 #include "matrixcommands.h"
 
+//! Return the cells of columns first ... first+count-1 in rows first_row ... last_row, one column after another
+static QVector<double> columnBlock(Matrix::Private * private_obj, int first, int count, int first_row, int last_row)
+{
+	QVector<double> result;
+	result.reserve(count * (last_row - first_row + 1));
+	for (int i=0; i<count; i++)
+		result += private_obj->columnCells(first+i, first_row, last_row);
+	return result;
+}
+
+//! Inverse of columnBlock()
+static void setColumnBlock(Matrix::Private * private_obj, int first, int count, int first_row, int last_row,
+		const QVector<double> & values)
+{
+	int rows = last_row - first_row + 1;
+	for (int i=0; i<count; i++)
+		private_obj->setColumnCells(first+i, first_row, last_row, values.mid(i*rows, rows));
+}
+
 ///////////////////////////////////////////////////////////////////////////
 // class MatrixInsertColumnsCmd
 ///////////////////////////////////////////////////////////////////////////
@@ -97,20 +116,15 @@ MatrixRemoveColumnsCmd::~MatrixRemoveColumnsCmd()
 void MatrixRemoveColumnsCmd::redo()
 {
 	if(m_backups.isEmpty())
-	{
-		int last_row = m_private_obj->rowCount()-1;
-		for(int i=0; i<m_count; i++)
-			m_backups.append(m_private_obj->columnCells(m_first+i, 0, last_row));
-	}
+		m_backups.setValues(columnBlock(m_private_obj, m_first, m_count, 0, m_private_obj->rowCount()-1),
+				m_private_obj->owner()->undoStack());
 	m_private_obj->removeColumns(m_first, m_count);
 }
 
 void MatrixRemoveColumnsCmd::undo()
 {
 	m_private_obj->insertColumns(m_first, m_count);
-	int last_row = m_private_obj->rowCount()-1;
-	for(int i=0; i<m_count; i++)
-		m_private_obj->setColumnCells(m_first+i, 0, last_row, m_backups.at(i));
+	setColumnBlock(m_private_obj, m_first, m_count, 0, m_private_obj->rowCount()-1, m_backups.values());
 }
 ///////////////////////////////////////////////////////////////////////////
 // end of class MatrixRemoveColumnsCmd
@@ -132,20 +146,15 @@ MatrixRemoveRowsCmd::~MatrixRemoveRowsCmd()
 void MatrixRemoveRowsCmd::redo()
 {
 	if(m_backups.isEmpty())
-	{
-		int last_row = m_first+m_count-1;
-		for(int col=0; col<m_private_obj->columnCount(); col++)
-			m_backups.append(m_private_obj->columnCells(col, m_first, last_row));
-	}
+		m_backups.setValues(columnBlock(m_private_obj, 0, m_private_obj->columnCount(), m_first, m_first+m_count-1),
+				m_private_obj->owner()->undoStack());
 	m_private_obj->removeRows(m_first, m_count);
 }
 
 void MatrixRemoveRowsCmd::undo()
 {
 	m_private_obj->insertRows(m_first, m_count);
-	int last_row = m_first+m_count-1;
-	for(int col=0; col<m_private_obj->columnCount(); col++)
-		m_private_obj->setColumnCells(col, m_first, last_row, m_backups.at(col));
+	setColumnBlock(m_private_obj, 0, m_private_obj->columnCount(), m_first, m_first+m_count-1, m_backups.values());
 }
 ///////////////////////////////////////////////////////////////////////////
 // end of class MatrixRemoveRowsCmd
@@ -167,20 +176,15 @@ MatrixClearCmd::~MatrixClearCmd()
 void MatrixClearCmd::redo()
 {
 	if(m_backups.isEmpty())
-	{
-		int last_row = m_private_obj->rowCount()-1;
-		for(int i=0; i<m_private_obj->columnCount(); i++)
-			m_backups.append(m_private_obj->columnCells(i, 0, last_row));
-	}
+		m_backups.setValues(columnBlock(m_private_obj, 0, m_private_obj->columnCount(), 0, m_private_obj->rowCount()-1),
+				m_private_obj->owner()->undoStack());
 	for(int i=0; i<m_private_obj->columnCount(); i++)
 		m_private_obj->clearColumn(i);
 }
 
 void MatrixClearCmd::undo()
 {
-	int last_row = m_private_obj->rowCount()-1;
-	for(int i=0; i<m_private_obj->columnCount(); i++)
-		m_private_obj->setColumnCells(i, 0, last_row, m_backups.at(i));
+	setColumnBlock(m_private_obj, 0, m_private_obj->columnCount(), 0, m_private_obj->rowCount()-1, m_backups.values());
 }
 ///////////////////////////////////////////////////////////////////////////
 // end of class MatrixClearCmd
@@ -202,13 +206,14 @@ MatrixClearColumnCmd::~MatrixClearColumnCmd()
 void MatrixClearColumnCmd::redo()
 {
 	if(m_backup.isEmpty())
-		m_backup = m_private_obj->columnCells(m_col, 0, m_private_obj->rowCount()-1);
+		m_backup.setValues(m_private_obj->columnCells(m_col, 0, m_private_obj->rowCount()-1),
+				m_private_obj->owner()->undoStack());
 	m_private_obj->clearColumn(m_col);
 }
 
 void MatrixClearColumnCmd::undo()
 {
-	m_private_obj->setColumnCells(m_col, 0, m_private_obj->rowCount()-1, m_backup);
+	m_private_obj->setColumnCells(m_col, 0, m_private_obj->rowCount()-1, m_backup.values());
 }
 ///////////////////////////////////////////////////////////////////////////
 // end of class MatrixClearColumnCmd
@@ -361,9 +366,10 @@ void MatrixSetFormulaCmd::undo()
 MatrixSetColumnCellsCmd::MatrixSetColumnCellsCmd( Matrix::Private * private_obj, int col, int first_row, 
 		int last_row, const QVector<double> & values, QUndoCommand * parent)
  : QUndoCommand( parent ), m_private_obj(private_obj), m_col(col), m_first_row(first_row), 
- 		m_last_row(last_row), m_values(values)
+ 		m_last_row(last_row)
 {
 	setText(QObject::tr("%1: set cell values").arg(m_private_obj->name()));
+	m_values.setValues(values, m_private_obj->owner()->undoStack());
 }
 
 MatrixSetColumnCellsCmd::~MatrixSetColumnCellsCmd()
@@ -373,13 +379,14 @@ MatrixSetColumnCellsCmd::~MatrixSetColumnCellsCmd()
 void MatrixSetColumnCellsCmd::redo()
 {
 	if (m_old_values.isEmpty())
-		m_old_values = m_private_obj->columnCells(m_col, m_first_row, m_last_row);
-	m_private_obj->setColumnCells(m_col, m_first_row, m_last_row, m_values);
+		m_old_values.setValues(m_private_obj->columnCells(m_col, m_first_row, m_last_row),
+				m_private_obj->owner()->undoStack());
+	m_private_obj->setColumnCells(m_col, m_first_row, m_last_row, m_values.values());
 }
 
 void MatrixSetColumnCellsCmd::undo()
 {
-	m_private_obj->setColumnCells(m_col, m_first_row, m_last_row, m_old_values);
+	m_private_obj->setColumnCells(m_col, m_first_row, m_last_row, m_old_values.values());
 }
 ///////////////////////////////////////////////////////////////////////////
 // end of class MatrixSetColumnCellsCmd
@@ -391,9 +398,10 @@ void MatrixSetColumnCellsCmd::undo()
 MatrixSetRowCellsCmd::MatrixSetRowCellsCmd( Matrix::Private * private_obj, int row, int first_column, 
 		int last_column, const QVector<double> & values, QUndoCommand * parent)
  : QUndoCommand( parent ), m_private_obj(private_obj), m_row(row), m_first_column(first_column), 
- 		m_last_column(last_column), m_values(values)
+ 		m_last_column(last_column)
 {
 	setText(QObject::tr("%1: set cell values").arg(m_private_obj->name()));
+	m_values.setValues(values, m_private_obj->owner()->undoStack());
 }
 
 MatrixSetRowCellsCmd::~MatrixSetRowCellsCmd()
@@ -403,13 +411,14 @@ MatrixSetRowCellsCmd::~MatrixSetRowCellsCmd()
 void MatrixSetRowCellsCmd::redo()
 {
 	if (m_old_values.isEmpty())
-		m_old_values = m_private_obj->rowCells(m_row, m_first_column, m_last_column);
-	m_private_obj->setRowCells(m_row, m_first_column, m_last_column, m_values);
+		m_old_values.setValues(m_private_obj->rowCells(m_row, m_first_column, m_last_column),
+				m_private_obj->owner()->undoStack());
+	m_private_obj->setRowCells(m_row, m_first_column, m_last_column, m_values.values());
 }
 
 void MatrixSetRowCellsCmd::undo()
 {
-	m_private_obj->setRowCells(m_row, m_first_column, m_last_column, m_old_values);
+	m_private_obj->setRowCells(m_row, m_first_column, m_last_column, m_old_values.values());
 }
 ///////////////////////////////////////////////////////////////////////////
 // end of class MatrixSetRowCellsCmd
@@ -430,27 +439,7 @@ MatrixTransposeCmd::~MatrixTransposeCmd()
 
 void MatrixTransposeCmd::redo()
 {
-	int rows = m_private_obj->rowCount();
-	int cols = m_private_obj->columnCount();
-	int temp_size = qMax(rows, cols);
-	m_private_obj->blockChangeSignals(true);
-	if (cols < rows)
-		m_private_obj->insertColumns(cols, temp_size - cols);
-	else if (cols > rows)
-		m_private_obj->insertRows(rows, temp_size - rows);
-	for(int i = 1; i<temp_size; i++)
-	{
-		QVector<double> row = m_private_obj->rowCells(i, 0, i-1);
-		QVector<double> col = m_private_obj->columnCells(i, 0, i-1);
-		m_private_obj->setRowCells(i, 0, i-1, col);
-		m_private_obj->setColumnCells(i, 0, i-1, row);
-	}
-	if (cols < rows)
-		m_private_obj->removeRows(cols, temp_size - cols);
-	else if (cols > rows)
-		m_private_obj->removeColumns(rows, temp_size - rows);
-	m_private_obj->blockChangeSignals(false);
-	m_private_obj->emitDataChanged(0, 0, m_private_obj->rowCount()-1, m_private_obj->columnCount()-1);
+	m_private_obj->transpose();
 }
 
 void MatrixTransposeCmd::undo()
@@ -476,18 +465,7 @@ MatrixMirrorHorizontallyCmd::~MatrixMirrorHorizontallyCmd()
 
 void MatrixMirrorHorizontallyCmd::redo()
 {
-	int rows = m_private_obj->rowCount();
-	int cols = m_private_obj->columnCount();
-	int middle = cols/2;
-	m_private_obj->blockChangeSignals(true);
-	for(int i = 0; i<middle; i++)
-	{
-		QVector<double> temp = m_private_obj->columnCells(i, 0, rows-1);
-		m_private_obj->setColumnCells(i, 0, rows-1, m_private_obj->columnCells(cols-i-1, 0, rows-1));
-		m_private_obj->setColumnCells(cols-i-1, 0, rows-1, temp);
-	}
-	m_private_obj->blockChangeSignals(false);
-	m_private_obj->emitDataChanged(0, 0, rows-1, cols-1);
+	m_private_obj->mirrorHorizontally();
 }
 
 void MatrixMirrorHorizontallyCmd::undo()
@@ -513,18 +491,7 @@ MatrixMirrorVerticallyCmd::~MatrixMirrorVerticallyCmd()
 
 void MatrixMirrorVerticallyCmd::redo()
 {
-	int rows = m_private_obj->rowCount();
-	int cols = m_private_obj->columnCount();
-	int middle = rows/2;
-	m_private_obj->blockChangeSignals(true);
-	for(int i = 0; i<middle; i++)
-	{
-		QVector<double> temp = m_private_obj->rowCells(i, 0, cols-1);
-		m_private_obj->setRowCells(i, 0, cols-1, m_private_obj->rowCells(rows-i-1, 0, cols-1));
-		m_private_obj->setRowCells(rows-i-1, 0, cols-1, temp);
-	}
-	m_private_obj->blockChangeSignals(false);
-	m_private_obj->emitDataChanged(0, 0, rows-1, cols-1);
+	m_private_obj->mirrorVertically();
 }
 
 void MatrixMirrorVerticallyCmd::undo()
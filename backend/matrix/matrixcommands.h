@@ -32,6 +32,7 @@
 
 #include <QUndoCommand>
 #include "Matrix.h"
+#include "lib/UndoPayload.h"
 
 ///////////////////////////////////////////////////////////////////////////
 // class MatrixInsertColumnsCmd
@@ -105,8 +106,8 @@ private:
 	int m_first;
 	//! The number of columns to remove
 	int m_count;
-	//! Backups of the removed columns
-	QVector< QVector<double> > m_backups;
+	//! Backup of the removed columns (one after another)
+	UndoPayload m_backups;
 };
 
 ///////////////////////////////////////////////////////////////////////////
@@ -133,8 +134,8 @@ private:
 	int m_first;
 	//! The number of rows to remove
 	int m_count;
-	//! Backups of the removed rows
-	QVector< QVector<double> > m_backups;
+	//! Backup of the removed rows (column by column)
+	UndoPayload m_backups;
 };
 
 ///////////////////////////////////////////////////////////////////////////
@@ -157,8 +158,8 @@ public:
 private:
 	//! The private object to modify
 	Matrix::Private * m_private_obj;
-	//! Backups of the cleared cells
-	QVector< QVector<double> > m_backups;
+	//! Backup of the cleared cells (column by column)
+	UndoPayload m_backups;
 };
 
 ///////////////////////////////////////////////////////////////////////////
@@ -184,7 +185,7 @@ private:
 	//! The index of the column
 	int m_col;
 	//! Backup of the cleared column
-	QVector<double> m_backup;
+	UndoPayload m_backup;
 };
 
 ///////////////////////////////////////////////////////////////////////////
@@ -337,9 +338,9 @@ private:
 	//! The index of the last row
 	int m_last_row;
 	//! New cell values
-	QVector<double> m_values;
+	UndoPayload m_values;
 	//! Backup of the changed values
-	QVector<double> m_old_values;
+	UndoPayload m_old_values;
 };
 
 ///////////////////////////////////////////////////////////////////////////
@@ -369,9 +370,9 @@ private:
 	//! The index of the last column
 	int m_last_column;
 	//! New cell values
-	QVector<double> m_values;
+	UndoPayload m_values;
 	//! Backup of the changed values
-	QVector<double> m_old_values;
+	UndoPayload m_old_values;
 };
 
 ///////////////////////////////////////////////////////////////////////////
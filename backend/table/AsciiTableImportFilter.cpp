@@ -30,10 +30,315 @@
 #include "table/AsciiTableImportFilter.h"
 #include "table/Table.h"
 #include "lib/IntervalAttribute.h"
+#include "lib/ParallelFor.h"
 #include "core/column/Column.h"
 
 #include <QTextStream>
 #include <QStringList>
+#include <QFile>
+#include <QLocale>
+#include <QDateTime>
+#include <QVector>
+
+#include <string.h>
+
+//! Approximate size (in bytes) of the blocks of lines parsed in parallel.
+static const int CHUNK_SIZE = 4 << 20;
+//! Number of lines looked at in order to detect column types.
+static const int TYPE_SAMPLE_LINES = 1000;
+
+//! Powers of ten which are exactly representable as double.
+static const double EXACT_POWERS_OF_TEN[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static inline bool isSpace(char c)
+{
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static inline bool isBlank(const char * begin, const char * end)
+{
+	for (; begin < end; begin++)
+		if (!isSpace(*begin)) return false;
+	return true;
+}
+
+//! Return the start of the line following the one pos is in.
+static inline const char * nextLine(const char * pos, const char * end)
+{
+	const char * line_break = static_cast<const char *>(memchr(pos, '\n', end - pos));
+	return line_break ? line_break + 1 : end;
+}
+
+//! Append row to a sorted list of intervals, extending the last interval if possible.
+static inline void appendRow(QList< Interval<int> >& list, int row)
+{
+	if (!list.isEmpty() && list.last().end() == row - 1)
+		list.last().setEnd(row);
+	else
+		list << Interval<int>(row, row);
+}
+
+//! Locale-aware conversion of raw bytes to double.
+/**
+ * Numbers with up to 15 significant digits and a decimal exponent of at most 22 are converted
+ * using exact integer and floating point arithmetic, which gives the correctly rounded result.
+ * Everything else (more digits, group separators, "nan", "inf", ...) is handed on to QLocale.
+ */
+class NumberParser
+{
+	public:
+		NumberParser() : m_decimal_point(m_locale.decimalPoint().toLatin1()) {}
+		//! Convert [begin, end) to a number; returns false if it isn't one (this includes blank cells).
+		bool parse(const char * begin, const char * end, double * result) const;
+
+	private:
+		QLocale m_locale;
+		char m_decimal_point;
+};
+
+bool NumberParser::parse(const char * begin, const char * end, double * result) const
+{
+	while (begin < end && isSpace(*begin)) begin++;
+	while (end > begin && isSpace(end[-1])) end--;
+	if (begin == end) return false;
+
+	const char * p = begin;
+	bool negative = (*p == '-');
+	if (*p == '-' || *p == '+') p++;
+
+	quint64 mantissa = 0;
+	int significant_digits = 0, exponent = 0;
+	bool have_digits = false;
+	for (; p < end && isDigit(*p); p++) {
+		have_digits = true;
+		if (significant_digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa) significant_digits++;
+		} else
+			exponent++;
+	}
+	if (p < end && *p == m_decimal_point)
+		for (p++; p < end && isDigit(*p); p++) {
+			have_digits = true;
+			if (significant_digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa) significant_digits++;
+				exponent--;
+			}
+		}
+	if (have_digits && p < end && (*p == 'e' || *p == 'E') && p + 1 < end) {
+		const char * q = p + 1;
+		bool negative_exponent = (*q == '-');
+		if (*q == '-' || *q == '+') q++;
+		if (q < end && isDigit(*q)) {
+			int value = 0;
+			for (; q < end && isDigit(*q); q++)
+				if (value < 10000) value = value * 10 + (*q - '0');
+			exponent += negative_exponent ? -value : value;
+			p = q;
+		}
+	}
+
+	if (have_digits && p == end && significant_digits <= 15 && exponent >= -22 && exponent <= 22) {
+		double value = double(mantissa);
+		if (exponent < 0)
+			value /= EXACT_POWERS_OF_TEN[-exponent];
+		else
+			value *= EXACT_POWERS_OF_TEN[exponent];
+		*result = negative ? -value : value;
+		return true;
+	}
+
+	bool ok;
+	*result = m_locale.toDouble(QString::fromLatin1(begin, end - begin), &ok);
+	return ok;
+}
+
+//! Convert [begin, end) to a QDateTime if it is in ISO 8601 format ("T" or " " between date and time).
+static bool parseDateTime(const char * begin, const char * end, QDateTime * result)
+{
+	while (begin < end && isSpace(*begin)) begin++;
+	while (end > begin && isSpace(end[-1])) end--;
+	if (end - begin < 10 || begin[4] != '-' || begin[7] != '-') return false;
+	QString text = QString::fromLatin1(begin, end - begin);
+	if (text.size() > 10 && text.at(10) == ' ')
+		text[10] = QChar('T');
+	*result = QDateTime::fromString(text, Qt::ISODate);
+	return result->isValid();
+}
+
+//! Splits lines into cells according to the whitespace options of the filter.
+class LineSplitter
+{
+	public:
+		LineSplitter(const QByteArray& separator, bool trim, bool simplify)
+			: m_separator(separator), m_trim(trim), m_simplify(simplify) {}
+		//! Split [begin, end) (without line break); cell i is [(*bounds)[2*i], (*bounds)[2*i+1]).
+		void split(const char * begin, const char * end, QVector<const char *> * bounds);
+
+	private:
+		QByteArray m_separator;
+		bool m_trim;
+		bool m_simplify;
+		//! Holds the current line if it had to be modified for simplify_whitespace
+		QByteArray m_buffer;
+};
+
+void LineSplitter::split(const char * begin, const char * end, QVector<const char *> * bounds)
+{
+	if (m_simplify) {
+		// equivalent of QString::simplified()
+		m_buffer.resize(end - begin);
+		char * start = m_buffer.data();
+		char * out = start;
+		bool pending_space = false;
+		for (; begin < end; begin++) {
+			if (isSpace(*begin))
+				pending_space = true;
+			else {
+				if (pending_space && out != start)
+					*out++ = ' ';
+				pending_space = false;
+				*out++ = *begin;
+			}
+		}
+		begin = start;
+		end = out;
+	} else if (m_trim) {
+		while (begin < end && isSpace(*begin)) begin++;
+		while (end > begin && isSpace(end[-1])) end--;
+	}
+
+	bounds->resize(0);
+	const char * separator = m_separator.constData();
+	int separator_size = m_separator.size();
+	const char * cell = begin;
+	if (separator_size > 0)
+		for (const char * p = begin; p + separator_size <= end; ) {
+			if (*p == *separator && memcmp(p, separator, separator_size) == 0) {
+				*bounds << cell << p;
+				p += separator_size;
+				cell = p;
+			} else
+				p++;
+		}
+	*bounds << cell << end;
+}
+
+//! Data of one column read from a Chunk
+struct ChunkColumn
+{
+	ChunkColumn() : failed(false) {}
+	QVector<double> numbers;
+	QStringList texts;
+	QList<QDateTime> date_times;
+	//! Invalid rows, counted from the start of the chunk
+	QList< Interval<int> > invalid;
+	//! Whether a cell did not match the column mode
+	bool failed;
+};
+
+//! A block of complete lines and the data read from it
+struct Chunk
+{
+	Chunk() : begin(0), end(0), rows(0) {}
+	const char * begin;
+	const char * end;
+	int rows;
+	QVector<ChunkColumn> columns;
+};
+
+//! Parses Chunks into typed column data; used with parallelFor().
+class ChunkParser
+{
+	public:
+		ChunkParser(Chunk * chunks, const QVector<SciDAVis::ColumnMode>& modes,
+				const QByteArray& separator, bool trim, bool simplify)
+			: m_chunks(chunks), m_modes(modes), m_separator(separator), m_trim(trim), m_simplify(simplify) {}
+		void operator()(int first, int last) const {
+			for (int i=first; i<=last; i++)
+				parse(m_chunks[i]);
+		}
+
+	private:
+		void parse(Chunk& chunk) const;
+
+		Chunk * m_chunks;
+		QVector<SciDAVis::ColumnMode> m_modes;
+		QByteArray m_separator;
+		bool m_trim;
+		bool m_simplify;
+};
+
+void ChunkParser::parse(Chunk& chunk) const
+{
+	LineSplitter splitter(m_separator, m_trim, m_simplify);
+	NumberParser number_parser;
+	QVector<const char *> bounds;
+	int column_count = m_modes.size();
+	chunk.columns = QVector<ChunkColumn>(column_count);
+	ChunkColumn * columns = chunk.columns.data();
+	// rough guess, assuming lines of 8 characters per column
+	int expected_rows = int((chunk.end - chunk.begin) / (8 * qMax(column_count, 1))) + 1;
+	for (int c=0; c<column_count; c++)
+		if (m_modes.at(c) == SciDAVis::Numeric)
+			columns[c].numbers.reserve(expected_rows);
+
+	int row = 0;
+	for (const char * line = chunk.begin; line < chunk.end; row++) {
+		const char * line_end = static_cast<const char *>(memchr(line, '\n', chunk.end - line));
+		const char * next_line = line_end ? line_end + 1 : chunk.end;
+		if (!line_end) line_end = chunk.end;
+		if (line_end > line && line_end[-1] == '\r') line_end--;
+		splitter.split(line, line_end, &bounds);
+		int cell_count = qMin(bounds.size() / 2, column_count);
+
+		for (int c=0; c<column_count; c++) {
+			ChunkColumn& column = columns[c];
+			bool valid = c < cell_count;
+			const char * cell_begin = valid ? bounds.at(2*c) : 0;
+			const char * cell_end = valid ? bounds.at(2*c + 1) : 0;
+			switch (m_modes.at(c)) {
+				case SciDAVis::Numeric:
+					{
+						double value = 0.0;
+						if (valid && !number_parser.parse(cell_begin, cell_end, &value)) {
+							if (!isBlank(cell_begin, cell_end))
+								column.failed = true;
+							value = 0.0;
+							valid = false;
+						}
+						column.numbers << value;
+						break;
+					}
+				case SciDAVis::DateTime:
+					{
+						QDateTime value;
+						if (valid && !parseDateTime(cell_begin, cell_end, &value)) {
+							if (!isBlank(cell_begin, cell_end))
+								column.failed = true;
+							valid = false;
+						}
+						column.date_times << value;
+						break;
+					}
+				default:
+					column.texts << (valid ? QString::fromLocal8Bit(cell_begin, cell_end - cell_begin) : QString());
+			}
+			if (!valid)
+				appendRow(column.invalid, row);
+		}
+		line = next_line;
+	}
+	chunk.rows = row;
+}
 
 QStringList AsciiTableImportFilter::fileExtensions() const
 {
@@ -42,7 +347,185 @@ QStringList AsciiTableImportFilter::fileExtensions() const
 
 AbstractAspect * AsciiTableImportFilter::importAspect(QIODevice * input)
 {
-	QTextStream stream(input);
+	resetCanceled();
+
+	// QTextStream takes care of detecting UTF-16 byte order marks
+	QByteArray start = input->peek(2);
+	if (start == "\xFF\xFE" || start == "\xFE\xFF") {
+		QTextStream stream(input);
+		return importTextStream(stream);
+	}
+
+#if QT_VERSION >= 0x040400
+	QFile * file = qobject_cast<QFile *>(input);
+	if (file && file->size() > file->pos()) {
+		qint64 size = file->size() - file->pos();
+		uchar * mapped = file->map(file->pos(), size);
+		if (mapped) {
+			Table * result = importBuffer(reinterpret_cast<const char *>(mapped), size);
+			file->unmap(mapped);
+			return result;
+		}
+	}
+#endif
+
+	QByteArray data = input->readAll();
+	return importBuffer(data.constData(), data.size());
+}
+
+Table * AsciiTableImportFilter::importBuffer(const char * data, qint64 size)
+{
+	const char * pos = data;
+	const char * end = data + size;
+	if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+		pos += 3;
+
+	// skip ignored lines
+	for (int i=0; i<m_ignored_lines; i++)
+		pos = nextLine(pos, end);
+
+	// read first row
+	const char * body = nextLine(pos, end);
+	const char * first_end = body;
+	if (first_end > pos && first_end[-1] == '\n') first_end--;
+	if (first_end > pos && first_end[-1] == '\r') first_end--;
+	QString first_line = QString::fromLocal8Bit(pos, first_end - pos);
+	QStringList row;
+	if (m_simplify_whitespace)
+		row = first_line.simplified().split(m_separator);
+	else if (m_trim_whitespace)
+		row = first_line.trimmed().split(m_separator);
+	else
+		row = first_line.split(m_separator);
+
+	// determine column names; if the first row holds data, it is parsed along with the rest
+	QStringList column_names;
+	if (m_first_row_names_columns)
+		column_names = row;
+	else {
+		for (int i=0; i<row.size(); ++i)
+			column_names << QString::number(i+1);
+		body = pos;
+	}
+	int column_count = column_names.size();
+	QByteArray separator = m_separator.toLocal8Bit();
+
+	// determine column modes from a sample of lines, trying Numeric before DateTime before Text
+	QVector<SciDAVis::ColumnMode> modes(column_count, m_detect_types ? SciDAVis::Numeric : SciDAVis::Text);
+	if (m_detect_types) {
+		Chunk sample;
+		sample.begin = body;
+		sample.end = body;
+		for (int i=0; i<TYPE_SAMPLE_LINES && sample.end < end; i++)
+			sample.end = nextLine(sample.end, end);
+		for (int pass=0; pass<2; pass++) {
+			ChunkParser(&sample, modes, separator, m_trim_whitespace, m_simplify_whitespace)(0, 0);
+			for (int c=0; c<column_count; c++)
+				if (sample.columns.at(c).failed)
+					modes[c] = (modes.at(c) == SciDAVis::Numeric) ? SciDAVis::DateTime : SciDAVis::Text;
+		}
+	}
+
+	// split the rest into chunks of complete lines
+	QVector<Chunk> chunks;
+	for (const char * chunk_begin = body; chunk_begin < end; ) {
+		Chunk chunk;
+		chunk.begin = chunk_begin;
+		chunk.end = (end - chunk_begin > CHUNK_SIZE) ? nextLine(chunk_begin + CHUNK_SIZE, end) : end;
+		chunks << chunk;
+		chunk_begin = chunk.end;
+	}
+
+	// Parse one chunk per core at a time, so we can report progress and react to cancel().
+	// If a cell doesn't match the mode detected from the sample, its column is re-read as text.
+#if QT_VERSION >= 0x040300
+	int wave_size = qMax(QThread::idealThreadCount(), 1);
+#else
+	int wave_size = 1;
+#endif
+	forever {
+		emit progress(0);
+		for (int first=0; first<chunks.size(); first+=wave_size) {
+			int last = qMin(first + wave_size, chunks.size()) - 1;
+			parallelFor(first, last, ChunkParser(chunks.data(), modes, separator, m_trim_whitespace, m_simplify_whitespace));
+			emit progress(int(100.0 * (chunks.at(last).end - body) / (end - body)));
+			if (wasCanceled())
+				return 0;
+		}
+
+		bool restart = false;
+		for (int c=0; c<column_count; c++)
+			for (int i=0; i<chunks.size(); i++)
+				if (chunks.at(i).columns.at(c).failed) {
+					modes[c] = SciDAVis::Text;
+					restart = true;
+					break;
+				}
+		if (!restart) break;
+	}
+	emit progress(100);
+
+	// build a Table from the gathered data
+	// renaming will be done by the kernel
+	int row_count = 0;
+	for (int i=0; i<chunks.size(); i++)
+		row_count += chunks.at(i).rows;
+	Table * result = new Table(0, 0, 0, tr("Table"));
+	for (int c=0; c<column_count; ++c)
+	{
+		QVector<double> numbers;
+		QStringList texts;
+		QList<QDateTime> date_times;
+		IntervalAttribute<bool> validity;
+		if (modes.at(c) == SciDAVis::Numeric)
+			numbers.resize(row_count);
+		int offset = 0;
+		for (int i=0; i<chunks.size(); i++) {
+			ChunkColumn& column = chunks[i].columns[c];
+			switch (modes.at(c)) {
+				case SciDAVis::Numeric:
+					if (chunks.at(i).rows > 0)
+						memcpy(numbers.data() + offset, column.numbers.constData(), chunks.at(i).rows * sizeof(double));
+					column.numbers = QVector<double>();
+					break;
+				case SciDAVis::DateTime:
+					date_times += column.date_times;
+					column.date_times.clear();
+					break;
+				default:
+					texts += column.texts;
+					column.texts.clear();
+			}
+			foreach (Interval<int> interval, column.invalid) {
+				interval.translate(offset);
+				validity.setValue(interval, true);
+			}
+			offset += chunks.at(i).rows;
+		}
+
+		Column *new_col;
+		switch (modes.at(c)) {
+			case SciDAVis::Numeric:
+				new_col = new Column(column_names.at(c), numbers, validity);
+				break;
+			case SciDAVis::DateTime:
+				new_col = new Column(column_names.at(c), date_times, validity);
+				break;
+			default:
+				new_col = new Column(column_names.at(c), texts, validity);
+		}
+		if (c == 0)
+			new_col->setPlotDesignation(SciDAVis::X);
+		else
+			new_col->setPlotDesignation(SciDAVis::Y);
+		result->addChild(new_col);
+	}
+
+	return result;
+}
+
+Table * AsciiTableImportFilter::importTextStream(QTextStream &stream)
+{
 	QStringList row, column_names;
 	int i;
 	// This is more efficient than it looks. The string lists are handed as-is to Column's
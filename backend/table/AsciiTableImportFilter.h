@@ -32,14 +32,24 @@
 
 #include "core/AbstractImportFilter.h"
 
+class Table;
+class QTextStream;
+
 //! Import an ASCII file as Table.
 /**
  * This is a complete rewrite of equivalent functionality previously found in Table.
  *
- * Transition note:
- * Conversion to numeric format intentionally not supported, since this can easily be done via
- * Table's control tabs and automatic conversion would artificially limit the types of data that
- * can be imported. The Type tab should be improved to allow custom decimal separators to be specified.
+ * Files are memory-mapped if possible and parsed in chunks of lines on all available cores.
+ * With detect_types enabled (the default), a sample from the start of the file decides whether
+ * a column is numeric, date/time (ISO 8601) or text; numeric and date/time columns are filled
+ * directly, without going through an intermediate list of strings. Numbers are read using the
+ * decimal point of the current locale. If a cell further down does not match the type detected
+ * for its column, the file is parsed again with this column imported as text, so no data is lost.
+ * With detect_types disabled, all columns are imported as text like before; conversion can then
+ * be done via Table's control tabs.
+ *
+ * Files starting with a UTF-16 or UTF-32 byte order mark are read through QTextStream,
+ * single-threaded and without type detection.
  *
  * TODO: port options GUI from ImportTableDialog
  */
@@ -53,7 +63,8 @@ class AsciiTableImportFilter : public AbstractImportFilter
 			m_separator("\t"),
 			m_first_row_names_columns(true),
 			m_trim_whitespace(false),
-			m_simplify_whitespace(false) {}
+			m_simplify_whitespace(false),
+			m_detect_types(true) {}
 		virtual AbstractAspect * importAspect(QIODevice * input);
 		virtual QStringList fileExtensions() const;
 		virtual QString name() const { return QObject::tr("ASCII table"); }
@@ -74,12 +85,20 @@ class AsciiTableImportFilter : public AbstractImportFilter
 		ACCESSOR(bool, simplify_whitespace);
 		Q_PROPERTY(bool simplify_whitespace READ simplify_whitespace WRITE set_simplify_whitespace);
 
+		ACCESSOR(bool, detect_types);
+		Q_PROPERTY(bool detect_types READ detect_types WRITE set_detect_types);
+
 	private:
+		Table * importBuffer(const char * data, qint64 size);
+		Table * importTextStream(QTextStream &stream);
+
+
 		int m_ignored_lines;
 		QString m_separator;
 		bool m_first_row_names_columns;
 		bool m_trim_whitespace;
 		bool m_simplify_whitespace;
+		bool m_detect_types;
 };
 
 #endif // ifndef ASCII_TABLE_IMPORT_FILTER_H
@@ -0,0 +1,395 @@
+/***************************************************************************
+    File                 : ColumnStatistics.cpp
+    Project              : SciDAVis
+    Description          : Mergeable statistics of column values with cached blocks
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "table/ColumnStatistics.h"
+#include "core/AbstractColumn.h"
+#include "core/column/Column.h"
+#include "lib/ValueSpan.h"
+#include "lib/ParallelFor.h"
+
+#include <string.h>
+#include <math.h>
+
+void StatisticsAccumulator::clear()
+{
+	m_count = 0;
+	m_sum = m_mean = m_m2 = m_m3 = m_m4 = 0;
+	m_min = m_max = NAN;
+	m_min_row = m_max_row = m_first_row = m_last_row = -1;
+}
+
+void StatisticsAccumulator::add(double value, int row)
+{
+	double n1 = m_count;
+	double n = ++m_count;
+	double delta = value - m_mean;
+	double delta_n = delta / n;
+	double delta_n2 = delta_n * delta_n;
+	double term = delta * delta_n * n1;
+	m_mean += delta_n;
+	m_m4 += term * delta_n2 * (n*n - 3*n + 3) + 6 * delta_n2 * m_m2 - 4 * delta_n * m_m3;
+	m_m3 += term * delta_n * (n - 2) - 3 * delta_n * m_m2;
+	m_m2 += term;
+	m_sum += value;
+
+	if (m_count == 1 || value < m_min || (value == m_min && row < m_min_row))
+	{
+		m_min = value;
+		m_min_row = row;
+	}
+	if (m_count == 1 || value > m_max || (value == m_max && row < m_max_row))
+	{
+		m_max = value;
+		m_max_row = row;
+	}
+	if (m_count == 1 || row < m_first_row) m_first_row = row;
+	if (m_count == 1 || row > m_last_row) m_last_row = row;
+}
+
+void StatisticsAccumulator::merge(const StatisticsAccumulator& other)
+{
+	if (other.m_count == 0) return;
+	if (m_count == 0)
+	{
+		*this = other;
+		return;
+	}
+
+	double na = m_count, nb = other.m_count, n = na + nb;
+	double delta = other.m_mean - m_mean;
+	double delta2 = delta * delta;
+	m_m4 += other.m_m4 + delta2 * delta2 * na * nb * (na*na - na*nb + nb*nb) / (n*n*n)
+		+ 6 * delta2 * (na*na * other.m_m2 + nb*nb * m_m2) / (n*n)
+		+ 4 * delta * (na * other.m_m3 - nb * m_m3) / n;
+	m_m3 += other.m_m3 + delta2 * delta * na * nb * (na - nb) / (n*n)
+		+ 3 * delta * (na * other.m_m2 - nb * m_m2) / n;
+	m_m2 += other.m_m2 + delta2 * na * nb / n;
+	m_mean += delta * nb / n;
+	m_count += other.m_count;
+	m_sum += other.m_sum;
+
+	if (other.m_min < m_min || (other.m_min == m_min && other.m_min_row < m_min_row))
+	{
+		m_min = other.m_min;
+		m_min_row = other.m_min_row;
+	}
+	if (other.m_max > m_max || (other.m_max == m_max && other.m_max_row < m_max_row))
+	{
+		m_max = other.m_max;
+		m_max_row = other.m_max_row;
+	}
+	m_first_row = qMin(m_first_row, other.m_first_row);
+	m_last_row = qMax(m_last_row, other.m_last_row);
+}
+
+double StatisticsAccumulator::mean() const
+{
+	return m_count > 0 ? m_mean : NAN;
+}
+
+double StatisticsAccumulator::variance() const
+{
+	return m_count > 1 ? m_m2 / (m_count - 1) : NAN;
+}
+
+double StatisticsAccumulator::populationVariance() const
+{
+	return m_count > 0 ? m_m2 / m_count : NAN;
+}
+
+double StatisticsAccumulator::standardDeviation() const
+{
+	return sqrt(variance());
+}
+
+double StatisticsAccumulator::skewness() const
+{
+	if (m_count < 1 || m_m2 <= 0) return NAN;
+	return sqrt(double(m_count)) * m_m3 / pow(m_m2, 1.5);
+}
+
+double StatisticsAccumulator::kurtosis() const
+{
+	if (m_count < 1 || m_m2 <= 0) return NAN;
+	return m_count * m_m4 / (m_m2 * m_m2) - 3;
+}
+
+//! Checks and recomputes a range of blocks of one column
+class ColumnStatisticsBlockKernel
+{
+	public:
+		ColumnStatisticsBlockKernel(ColumnStatistics * owner, const ValueSpan& span)
+			: m_owner(owner), m_span(span) {}
+		void operator()(int first, int last) const { m_owner->updateBlocks(m_span, first, last); }
+
+	private:
+		ColumnStatistics * m_owner;
+		const ValueSpan& m_span;
+};
+
+//! Updates the statistics of a range of columns, one column per thread
+class ColumnStatisticsColumnKernel
+{
+	public:
+		ColumnStatisticsColumnKernel(const QList<ColumnStatistics*>& statistics, const QList<ValueSpan>& spans)
+			: m_statistics(statistics), m_spans(spans) {}
+		void operator()(int first, int last) const
+		{
+			for (int i=first; i<=last; i++)
+				m_statistics.at(i)->update(m_spans.at(i), false);
+		}
+
+	private:
+		const QList<ColumnStatistics*>& m_statistics;
+		const QList<ValueSpan>& m_spans;
+};
+
+ColumnStatistics::ColumnStatistics()
+	: m_first_row(0), m_recomputed(0), m_revision(0), m_tracked(false)
+{
+}
+
+void ColumnStatistics::invalidate()
+{
+	m_blocks.clear();
+	m_result.clear();
+	m_recomputed = 0;
+	m_column = 0;
+	m_tracked = false;
+}
+
+void ColumnStatistics::update(const AbstractColumn * column)
+{
+	if (!column)
+	{
+		invalidate();
+		return;
+	}
+	m_tracked = markChangedBlocks(column);
+	if (column->rawValues())
+	{
+		update(column->valueSpan(), true);
+		return;
+	}
+
+	// columns without contiguous storage (e.g. still paged from a project file) are read
+	// a few blocks at a time, so they are never materialized completely
+	if (m_first_row != 0)
+	{
+		m_blocks.clear();
+		m_first_row = 0;
+	}
+	int rows = column->rowCount();
+	m_blocks.resize((rows + BlockSize - 1) / BlockSize);
+	for (int first=0; first<m_blocks.size(); first+=ChunkBlocks)
+	{
+		int last = qMin(first + ChunkBlocks, m_blocks.size()) - 1;
+		if (m_tracked)
+		{
+			// don't read chunks without changes
+			bool changed = false;
+			for (int b=first; b<=last && !changed; b++)
+				changed = m_blocks.at(b).changed || m_blocks.at(b).size != qMin(BlockSize, rows - b * BlockSize);
+			if (!changed)
+			{
+				for (int b=first; b<=last; b++)
+					m_blocks[b].recomputed = false;
+				continue;
+			}
+		}
+		ValueSpan span = column->valueSpan(Interval<int>(first * BlockSize, qMin((last+1) * BlockSize, rows) - 1));
+		parallelFor(first, last, ColumnStatisticsBlockKernel(this, span), 4);
+	}
+	mergeBlocks();
+}
+
+void ColumnStatistics::update(const ValueSpan& span)
+{
+	m_column = 0;
+	m_tracked = false;
+	update(span, true);
+}
+
+void ColumnStatistics::update(const QList<ColumnStatistics*>& statistics, const QList<const AbstractColumn*>& columns)
+{
+	// spans are created here, since reading a column which is not a plain Column
+	// (e.g. a filter output) need not be thread-safe
+	QList<ValueSpan> spans;
+	for (int i=0; i<statistics.size(); i++)
+	{
+		statistics.at(i)->m_tracked = statistics.at(i)->markChangedBlocks(columns.value(i));
+		spans << (columns.value(i) ? columns.at(i)->valueSpan() : ValueSpan());
+	}
+	parallelFor(0, statistics.size()-1, ColumnStatisticsColumnKernel(statistics, spans));
+}
+
+bool ColumnStatistics::markChangedBlocks(const AbstractColumn * column)
+{
+	const Column * plain = dynamic_cast<const Column *>(column);
+	QList< Interval<int> > changes;
+	bool known = plain && plain == m_column && m_first_row == 0 && plain->changedRows(m_revision, &changes);
+	m_column = const_cast<Column *>(plain);
+	m_revision = plain ? plain->revision() : 0;
+	if (!known) return false;
+
+	for (int b=0; b<m_blocks.size(); b++)
+		m_blocks[b].changed = false;
+	foreach(Interval<int> rows, changes)
+		for (int b=qMax(rows.start(), 0) / BlockSize; b<=qMin(rows.end() / BlockSize, m_blocks.size()-1); b++)
+			m_blocks[b].changed = true;
+	return true;
+}
+
+void ColumnStatistics::update(const ValueSpan& span, bool parallel)
+{
+	if (span.first() != m_first_row)
+	{
+		m_blocks.clear();
+		m_first_row = span.first();
+	}
+	m_blocks.resize((span.size() + BlockSize - 1) / BlockSize);
+	if (parallel)
+		parallelFor(0, m_blocks.size()-1, ColumnStatisticsBlockKernel(this, span), 4);
+	else
+		updateBlocks(span, 0, m_blocks.size()-1);
+	mergeBlocks();
+}
+
+//! Checksum of the bits of 'count' values and their invalid flags
+/**
+ * 'invalid_bits' holds one bit per value; 0 means that all values are valid.
+ */
+static quint64 blockChecksum(const double * values, int count, const quint64 * invalid_bits)
+{
+	// four independent lanes, so the multiplications don't form one long dependency chain
+	const quint64 prime = Q_UINT64_C(0x100000001b3);
+	quint64 h[4] = { Q_UINT64_C(0xcbf29ce484222325), 1, 2, 3 };
+	int i = 0;
+	for (; i+3 < count; i+=4)
+		for (int lane=0; lane<4; lane++)
+		{
+			quint64 bits;
+			memcpy(&bits, values + i + lane, sizeof(bits));
+			h[lane] = (h[lane] ^ bits) * prime;
+		}
+	for (; i < count; i++)
+	{
+		quint64 bits;
+		memcpy(&bits, values + i, sizeof(bits));
+		h[0] = (h[0] ^ bits) * prime;
+	}
+	for (int w=0; w<(count + 63) / 64; w++)
+		h[1] = (h[1] ^ (invalid_bits ? invalid_bits[w] : 0)) * prime;
+	return ((h[0] * prime ^ h[1]) * prime ^ h[2]) * prime ^ h[3] ^ quint64(count);
+}
+
+void ColumnStatistics::updateBlocks(const ValueSpan& span, int first, int last)
+{
+	const double * data = span.data();
+	const quint64 * invalid_bits = span.hasInvalid() ? span.invalidBits().constData() : 0;
+	// the span may start at any block
+	int offset = span.first() - m_first_row;
+	for (int b=first; b<=last; b++)
+	{
+		Block &block = m_blocks[b];
+		int start = b * BlockSize - offset;
+		int size = qMin(BlockSize, span.size() - start);
+		const quint64 * block_bits = invalid_bits ? invalid_bits + start/64 : 0;
+		if (m_tracked && !block.changed && block.size == size)
+		{
+			block.recomputed = false;
+			continue;
+		}
+		quint64 checksum = blockChecksum(data + start, size, block_bits);
+		block.recomputed = (block.size != size || block.checksum != checksum);
+		if (!block.recomputed) continue;
+		block.size = size;
+		block.checksum = checksum;
+
+		// two passes over the block: count, sum and extrema, then the moments about
+		// the block mean (no division per value, unlike add())
+		StatisticsAccumulator &s = block.statistics;
+		s.clear();
+		int row0 = span.first() + start;
+		for (int i=0; i<size; i++)
+		{
+			double value = data[start + i];
+			if ((block_bits && ((block_bits[i >> 6] >> (i & 63)) & 1)) || value != value)
+				continue;
+			if (s.m_count == 0)
+			{
+				s.m_min = s.m_max = value;
+				s.m_min_row = s.m_max_row = s.m_first_row = row0 + i;
+			}
+			else if (value < s.m_min)
+			{
+				s.m_min = value;
+				s.m_min_row = row0 + i;
+			}
+			else if (value > s.m_max)
+			{
+				s.m_max = value;
+				s.m_max_row = row0 + i;
+			}
+			s.m_last_row = row0 + i;
+			s.m_count++;
+			s.m_sum += value;
+		}
+		if (s.m_count == 0) continue;
+		s.m_mean = s.m_sum / s.m_count;
+		double sum_delta = 0, m2 = 0, m3 = 0, m4 = 0;
+		for (int i=0; i<size; i++)
+		{
+			double value = data[start + i];
+			if ((block_bits && ((block_bits[i >> 6] >> (i & 63)) & 1)) || value != value)
+				continue;
+			double delta = value - s.m_mean;
+			double delta2 = delta * delta;
+			sum_delta += delta;
+			m2 += delta2;
+			m3 += delta2 * delta;
+			m4 += delta2 * delta2;
+		}
+		// corrected two-pass formula for the rounding error of the mean
+		s.m_m2 = m2 - sum_delta * sum_delta / s.m_count;
+		s.m_m3 = m3;
+		s.m_m4 = m4;
+	}
+}
+
+void ColumnStatistics::mergeBlocks()
+{
+	m_result.clear();
+	m_recomputed = 0;
+	for (int b=0; b<m_blocks.size(); b++)
+	{
+		m_result.merge(m_blocks.at(b).statistics);
+		if (m_blocks.at(b).recomputed) m_recomputed++;
+	}
+}
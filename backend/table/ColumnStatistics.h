@@ -0,0 +1,189 @@
+/***************************************************************************
+    File                 : ColumnStatistics.h
+    Project              : SciDAVis
+    Description          : Mergeable statistics of column values with cached blocks
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef COLUMNSTATISTICS_H
+#define COLUMNSTATISTICS_H
+
+#include <QVector>
+#include <QList>
+#include <QPointer>
+#include <QtGlobal>
+
+class AbstractColumn;
+class Column;
+class ValueSpan;
+
+//! Count, sum, moments and extrema of a set of values
+/**
+ * Values are added one at a time with add() (Welford's update, extended to the third
+ * and fourth central moments) and partial results are combined with merge() (the
+ * pairwise formulas of Chan et al.), so statistics of a large data set can be computed
+ * in independent parts and added up afterwards without losing precision. The central
+ * moments are kept as sums of powers of the deviations from the mean.
+ */
+class StatisticsAccumulator
+{
+	public:
+		StatisticsAccumulator() { clear(); }
+
+		//! Reset to the empty set
+		void clear();
+		//! Add the value of row 'row'
+		void add(double value, int row);
+		//! Combine with the statistics of another (disjoint) set of values
+		void merge(const StatisticsAccumulator& other);
+
+		//! Number of values
+		int count() const { return m_count; }
+		bool isEmpty() const { return m_count == 0; }
+		double sum() const { return m_sum; }
+		double mean() const;
+		//! Sample variance (divided by count()-1)
+		double variance() const;
+		//! Population variance (divided by count())
+		double populationVariance() const;
+		//! Sample standard deviation
+		double standardDeviation() const;
+		//! Skewness (third standardized moment)
+		double skewness() const;
+		//! Excess kurtosis (fourth standardized moment minus 3)
+		double kurtosis() const;
+		double minimum() const { return m_min; }
+		double maximum() const { return m_max; }
+		//! Row of the minimum (the first one if it occurs several times), -1 if empty
+		int minimumRow() const { return m_min_row; }
+		//! Row of the maximum (the first one if it occurs several times), -1 if empty
+		int maximumRow() const { return m_max_row; }
+		//! Lowest row which was added, -1 if empty
+		int firstRow() const { return m_first_row; }
+		//! Highest row which was added, -1 if empty
+		int lastRow() const { return m_last_row; }
+
+	private:
+		friend class ColumnStatistics;
+
+		int m_count;
+		double m_sum;
+		double m_mean;
+		//! Sums of the 2nd, 3rd and 4th powers of the deviations from the mean
+		double m_m2, m_m3, m_m4;
+		double m_min, m_max;
+		int m_min_row, m_max_row;
+		int m_first_row, m_last_row;
+};
+
+//! Statistics of the valid values of a column, updated block by block
+/**
+ * The rows are divided into blocks of BlockSize rows; the statistics of each block are
+ * cached together with a checksum of its values and validity flags. When update() is
+ * called again, only blocks whose checksum changed are recomputed, and the cached
+ * blocks are merged into the result. NaN values are ignored like invalid rows.
+ *
+ * When the same Column is updated again, the rows changed in between are taken from
+ * Column::changedRows() and only the blocks containing them are read at all; the other
+ * blocks are reused without computing their checksums. Editing a few rows of a large
+ * column therefore only costs the statistics of the affected blocks. Other columns
+ * (e.g. filter outputs), spans and columns whose change log has run over are checked
+ * through the checksums of all blocks.
+ *
+ * update() evaluates the blocks of a column on all cores; the static update() for several
+ * columns instead processes the columns in parallel.
+ *
+ * \code
+ * ColumnStatistics statistics;
+ * statistics.update(column);
+ * qDebug() << statistics.result().mean() << statistics.result().standardDeviation();
+ * \endcode
+ */
+class ColumnStatistics
+{
+	public:
+		//! Number of rows per cached block (a multiple of 64)
+		static const int BlockSize = 4096;
+		//! Number of blocks read at once from columns without rawValues()
+		static const int ChunkBlocks = 64;
+
+		ColumnStatistics();
+
+		//! Statistics of the rows passed to the last update()
+		const StatisticsAccumulator& result() const { return m_result; }
+		//! Number of blocks recomputed by the last update()
+		int recomputedBlocks() const { return m_recomputed; }
+		//! Forget the cached blocks
+		void invalidate();
+
+		//! Update the statistics to the valid rows of 'column'
+		void update(const AbstractColumn * column);
+		//! Update the statistics to the valid rows of 'span'
+		void update(const ValueSpan& span);
+		//! Update 'statistics[i]' to the valid rows of 'columns[i]', computing the columns in parallel
+		static void update(const QList<ColumnStatistics*>& statistics, const QList<const AbstractColumn*>& columns);
+
+	private:
+		//! Statistics of one block, identified by its checksum
+		struct Block
+		{
+			Block() : size(-1), checksum(0), changed(true), recomputed(false) {}
+			int size;
+			quint64 checksum;
+			//! Whether the block contains rows changed since the last update (see markChangedBlocks())
+			bool changed;
+			//! Whether the block was recomputed by the last update
+			bool recomputed;
+			StatisticsAccumulator statistics;
+		};
+		friend class ColumnStatisticsBlockKernel;
+		friend class ColumnStatisticsColumnKernel;
+
+		//! Flag the blocks containing rows changed since the last update of 'column'
+		/**
+		 * Returns whether the changes are known; if so, blocks without changes are
+		 * reused by updateBlocks() without looking at their values.
+		 */
+		bool markChangedBlocks(const AbstractColumn * column);
+		//! Check and recompute the blocks of 'span'; parallel across blocks if 'parallel'
+		void update(const ValueSpan& span, bool parallel);
+		//! Check and recompute blocks first..last, which have to lie within 'span'
+		void updateBlocks(const ValueSpan& span, int first, int last);
+		//! Merge the cached blocks into m_result
+		void mergeBlocks();
+
+		QVector<Block> m_blocks;
+		//! Row of the first value of the first block
+		int m_first_row;
+		StatisticsAccumulator m_result;
+		int m_recomputed;
+		//! The column of the last update() and its revision at that time
+		QPointer<Column> m_column;
+		int m_revision;
+		//! Whether the current update only looks at blocks flagged by markChangedBlocks()
+		bool m_tracked;
+};
+
+#endif // ifndef COLUMNSTATISTICS_H
@@ -0,0 +1,409 @@
+/***************************************************************************
+    File                 : FormulaEvaluator.cpp
+    Project              : SciDAVis
+    Description          : Evaluation of column formulas on row ranges
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "table/FormulaEvaluator.h"
+#include "table/Table.h"
+#include "core/Project.h"
+#include "core/MyParser.h"
+#include "core/column/Column.h"
+#include "lib/ValueSpan.h"
+#include "lib/ParallelFor.h"
+
+#include <QObject>
+#include <QLocale>
+#include <QDateTime>
+#include <math.h>
+#include <limits.h>
+
+//! Minimum number of rows evaluated by one thread
+static const int FORMULA_CHUNK_SIZE = 4096;
+
+//! Evaluates the compiled formula for a chunk of rows, using a parser of its own
+class FormulaEvaluationKernel
+{
+	public:
+		FormulaEvaluationKernel(const QString& expression, const QStringList& variables,
+				const QList<ValueSpan>& spans, int first_row, double * values, char * invalid)
+			: m_expression(expression.toAscii()), m_spans(spans), m_first_row(first_row),
+			m_values(values), m_invalid(invalid)
+		{
+			foreach(QString variable, variables)
+				m_variables << variable.toAscii();
+		}
+
+		void operator()(int first, int last) const
+		{
+			MyParser parser;
+			QVector<double> cells(m_variables.size());
+			double row_number = 0;
+			try
+			{
+				parser.DefineVar("i", &row_number);
+				for (int j=0; j<m_variables.size(); j++)
+					parser.DefineVar(m_variables.at(j).constData(), cells.data() + j);
+				parser.SetExpr(m_expression.constData());
+			}
+			catch(mu::ParserError &)
+			{
+				for (int row=first; row<=last; row++)
+				{
+					m_values[row - m_first_row] = NAN;
+					m_invalid[row - m_first_row] = 1;
+				}
+				return;
+			}
+
+			for (int row=first; row<=last; row++)
+			{
+				int k = row - m_first_row;
+				bool missing = false;
+				for (int j=0; j<m_spans.size() && !missing; j++)
+				{
+					const ValueSpan &span = m_spans.at(j);
+					int index = row - span.first();
+					if (index < 0 || index >= span.size() || span.isInvalid(index))
+						missing = true;
+					else
+						cells[j] = span.at(index);
+				}
+				m_values[k] = NAN;
+				m_invalid[k] = 1;
+				if (missing) continue;
+				row_number = row + 1;
+				try
+				{
+					m_values[k] = parser.Eval();
+					m_invalid[k] = 0;
+				}
+				catch(mu::ParserError &)
+				{
+				}
+			}
+		}
+
+	private:
+		QByteArray m_expression;
+		QList<QByteArray> m_variables;
+		QList<ValueSpan> m_spans;
+		int m_first_row;
+		double * m_values;
+		char * m_invalid;
+};
+
+//! Split the arguments of the function call whose opening parenthesis is at 'open'
+/**
+ * Returns false if the parenthesis is not closed. Otherwise, the trimmed top-level
+ * arguments are stored in 'args' and the position of the closing parenthesis in 'close'.
+ */
+static bool splitArguments(const QString& text, int open, QStringList * args, int * close)
+{
+	int depth = 0;
+	QString arg;
+	for (int pos=open; pos<text.size(); pos++)
+	{
+		QChar c = text.at(pos);
+		if (c == '"')
+		{
+			int end = pos + 1;
+			while (end < text.size() && text.at(end) != '"')
+				end += (text.at(end) == '\\') ? 2 : 1;
+			arg += text.mid(pos, end - pos + 1);
+			pos = end;
+			continue;
+		}
+		if (c == '(' && depth++ == 0) continue;
+		if (c == ')' && --depth == 0)
+		{
+			*args << arg.trimmed();
+			*close = pos;
+			return true;
+		}
+		if (c == ',' && depth == 1)
+		{
+			*args << arg.trimmed();
+			arg.clear();
+			continue;
+		}
+		arg += c;
+	}
+	return false;
+}
+
+//! Whether 'arg' is a string literal
+static bool isQuoted(const QString& arg)
+{
+	return arg.size() >= 2 && arg.startsWith('"') && arg.endsWith('"');
+}
+
+//! Return the column of 'table' given by name (quoted or not) or number, or 0
+static Column * columnOf(Table * table, const QString& arg, QString * error)
+{
+	Column * column = 0;
+	if (isQuoted(arg))
+	{
+		column = table->column(arg.mid(1, arg.size()-2));
+		if (!column)
+			*error = QObject::tr("There's no column named %1 in table %2!").arg(arg).arg(table->name());
+		return column;
+	}
+	column = table->column(arg);
+	if (column) return column;
+	bool ok;
+	int number = arg.toInt(&ok);
+	if (ok && number >= 1 && number <= table->columnCount())
+		return table->child<Column>(number-1);
+	*error = QObject::tr("There's no column %1 in table %2!").arg(arg).arg(table->name());
+	return 0;
+}
+
+FormulaEvaluator::FormulaEvaluator(Table * table)
+	: m_table(table), m_compiled(false)
+{
+}
+
+bool FormulaEvaluator::compile(const QString& formula)
+{
+	m_compiled = false;
+	m_error.clear();
+	m_expression.clear();
+	m_columns.clear();
+	m_variables.clear();
+
+	if (formula.trimmed().isEmpty())
+	{
+		m_error = QObject::tr("The formula is empty.");
+		return false;
+	}
+	if (!resolveReferences(formula))
+		return false;
+
+	// let muParser check the syntax and the remaining names once, in this thread
+	MyParser parser;
+	QVector<double> cells(m_variables.size(), 1.0);
+	double row_number = 1;
+	try
+	{
+		parser.DefineVar("i", &row_number);
+		for (int j=0; j<m_variables.size(); j++)
+			parser.DefineVar(m_variables.at(j).toAscii().constData(), cells.data() + j);
+		parser.SetExpr(m_expression.toAscii().constData());
+		parser.Eval();
+	}
+	catch(mu::ParserError &e)
+	{
+		m_error = QString::fromAscii(e.GetMsg().c_str());
+		return false;
+	}
+
+	m_compiled = true;
+	return true;
+}
+
+bool FormulaEvaluator::resolveReferences(const QString& formula)
+{
+	int pos = 0;
+	while (pos < formula.size())
+	{
+		QChar c = formula.at(pos);
+		if (c == '"')
+		{
+			int end = pos + 1;
+			while (end < formula.size() && formula.at(end) != '"')
+				end += (formula.at(end) == '\\') ? 2 : 1;
+			m_expression += formula.mid(pos, end - pos + 1);
+			pos = end + 1;
+			continue;
+		}
+		if (!c.isLetterOrNumber() && c != '_')
+		{
+			m_expression += c;
+			pos++;
+			continue;
+		}
+
+		int start = pos;
+		while (pos < formula.size() && (formula.at(pos).isLetterOrNumber() || formula.at(pos) == '_' || formula.at(pos) == '.'))
+			pos++;
+		QString name = formula.mid(start, pos - start);
+		int open = pos;
+		while (open < formula.size() && formula.at(open).isSpace())
+			open++;
+		if ((name != "col" && name != "tablecol") || open >= formula.size() || formula.at(open) != '(')
+		{
+			m_expression += name;
+			continue;
+		}
+
+		QStringList args;
+		int close;
+		if (!splitArguments(formula, open, &args, &close))
+		{
+			m_error = QObject::tr("Missing closing parenthesis after %1(.").arg(name);
+			return false;
+		}
+		const AbstractColumn * column = resolveColumn(name, args);
+		if (!column)
+			return false;
+		m_expression += variableFor(column);
+		pos = close + 1;
+	}
+	return true;
+}
+
+const AbstractColumn * FormulaEvaluator::resolveColumn(const QString& function, const QStringList& args)
+{
+	if (function == "col")
+	{
+		if (args.size() == 2)
+		{
+			m_error = QObject::tr("col(): references to other rows are not supported in column formulas.");
+			return 0;
+		}
+		if (args.size() != 1 || args.at(0).isEmpty())
+		{
+			m_error = QObject::tr("col: wrong number of arguments (need 1, got %1)").arg(args.size());
+			return 0;
+		}
+		return columnOf(m_table, args.at(0), &m_error);
+	}
+
+	if (args.size() != 2)
+	{
+		m_error = QObject::tr("tablecol: wrong number of arguments (need 2, got %1)").arg(args.size());
+		return 0;
+	}
+	if (!isQuoted(args.at(0)))
+	{
+		m_error = QObject::tr("tablecol: first argument must be a string (table name)");
+		return 0;
+	}
+	QString table_name = args.at(0).mid(1, args.at(0).size()-2);
+	Table * target = 0;
+	if (m_table->name() == table_name)
+		target = m_table;
+	else if (m_table->project())
+		foreach(Table * table, m_table->project()->children<Table>(AbstractAspect::Recursive))
+			if (table->name() == table_name)
+			{
+				target = table;
+				break;
+			}
+	if (!target)
+	{
+		m_error = QObject::tr("Couldn't find a table named %1.").arg(args.at(0));
+		return 0;
+	}
+	return columnOf(target, args.at(1), &m_error);
+}
+
+QString FormulaEvaluator::variableFor(const AbstractColumn * column)
+{
+	int index = m_columns.indexOf(column);
+	if (index < 0)
+	{
+		index = m_columns.size();
+		m_columns << column;
+		m_variables << QString("_col%1").arg(index);
+	}
+	return m_variables.at(index);
+}
+
+void FormulaEvaluator::evaluate(Interval<int> rows, QVector<double> * values, QList< Interval<int> > * invalid_rows) const
+{
+	values->clear();
+	if (invalid_rows) invalid_rows->clear();
+	if (!m_compiled || !rows.isValid()) return;
+
+	int count = rows.end() - rows.start() + 1;
+	values->resize(count);
+	QVector<char> invalid(count);
+	QList<ValueSpan> spans;
+	foreach(const AbstractColumn * column, m_columns)
+		spans << column->valueSpan(rows);
+
+	parallelFor(rows.start(), rows.end(),
+			FormulaEvaluationKernel(m_expression, m_variables, spans, rows.start(), values->data(), invalid.data()),
+			FORMULA_CHUNK_SIZE);
+
+	if (!invalid_rows) return;
+	for (int k=0; k<count; )
+	{
+		if (!invalid.at(k))
+		{
+			k++;
+			continue;
+		}
+		int start = k;
+		while (k < count && invalid.at(k))
+			k++;
+		*invalid_rows << Interval<int>(rows.start() + start, rows.start() + k - 1);
+	}
+}
+
+void FormulaEvaluator::apply(Column * column, Interval<int> rows) const
+{
+	if (!m_compiled || !column) return;
+	rows = Interval<int>::intersection(rows, Interval<int>(0, INT_MAX));
+	if (!rows.isValid()) return;
+
+	QVector<double> values;
+	QList< Interval<int> > invalid_rows;
+	evaluate(rows, &values, &invalid_rows);
+
+	if (column->dataType() == SciDAVis::TypeDouble)
+	{
+		column->replaceValues(rows.start(), values, invalid_rows);
+		return;
+	}
+
+	QLocale locale;
+	column->beginMacro(QObject::tr("%1: apply formula to rows %2 to %3").arg(column->name()).arg(rows.start()+1).arg(rows.end()+1));
+	if (column->dataType() == SciDAVis::TypeQDateTime)
+	{
+		// results are Julian days, as converted by Double2DateTimeFilter
+		QList<QDateTime> dates;
+		foreach(double value, values)
+			if (isnan(value))
+				dates << QDateTime();
+			else
+				dates << QDateTime(QDate::fromJulianDay(qRound(value)),
+						QTime(12,0,0,0).addMSecs(int((value - int(value)) * 86400000.0)));
+		column->replaceDateTimes(rows.start(), dates);
+	}
+	else
+	{
+		QStringList texts;
+		foreach(double value, values)
+			texts << (isnan(value) ? QString() : locale.toString(value, 'g', 14));
+		column->replaceTexts(rows.start(), texts);
+	}
+	foreach(Interval<int> i, invalid_rows)
+		column->setInvalid(i);
+	column->endMacro();
+}
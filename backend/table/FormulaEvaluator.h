@@ -0,0 +1,125 @@
+/***************************************************************************
+    File                 : FormulaEvaluator.h
+    Project              : SciDAVis
+    Description          : Evaluation of column formulas on row ranges
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef FORMULAEVALUATOR_H
+#define FORMULAEVALUATOR_H
+
+#include "lib/Interval.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+
+class AbstractColumn;
+class Column;
+class Table;
+
+//! Evaluates a column formula for a range of rows
+/**
+ * The formula is a muParser expression (see MyParser for the available functions). The
+ * row number (starting at 1) is available as variable "i"; cells of the current row
+ * are referenced by
+ * - col("name") or col(name): the column of the table with the given name,
+ * - col(n): the n-th column (counting from 1) of the table,
+ * - tablecol("table", "name") or tablecol("table", n): a column of another table of
+ *   the project.
+ *
+ * compile() resolves these references once: each one is replaced by a variable bound to
+ * the column, so evaluating a row only costs reading the referenced cells and one
+ * evaluation of the parsed expression. References to other rows (col(name, row)) are not
+ * supported.
+ *
+ * evaluate() reads the referenced columns directly (see AbstractColumn::valueSpan()) and
+ * splits large row ranges into blocks which are evaluated on all cores, each with a
+ * parser of its own. A row is invalid if one of the cells it references is invalid or
+ * missing, or if its evaluation fails. apply() writes the results of a range into a
+ * column as one undo step.
+ *
+ * \code
+ * FormulaEvaluator evaluator(table);
+ * if (!evaluator.compile("sin(col(\"A\"))^2 + i"))
+ * 	qDebug() << evaluator.errorMessage();
+ * else
+ * 	evaluator.apply(table->column("B"), Interval<int>(0, 99));
+ * \endcode
+ */
+class FormulaEvaluator
+{
+	public:
+		//! Create an evaluator for formulas of columns of 'table'
+		FormulaEvaluator(Table * table);
+
+		//! Parse 'formula' and resolve its column references
+		/**
+		 * Returns false (see errorMessage()) if the formula is not valid or references
+		 * columns which do not exist.
+		 */
+		bool compile(const QString& formula);
+		//! Whether the last call of compile() succeeded
+		bool isCompiled() const { return m_compiled; }
+		//! Return the reason why the last call of compile() failed
+		QString errorMessage() const { return m_error; }
+		//! The compiled expression, with column references replaced by variables
+		QString expression() const { return m_expression; }
+		//! The columns referenced by the compiled formula
+		QList<const AbstractColumn *> columns() const { return m_columns; }
+
+		//! Evaluate the compiled formula for 'rows'
+		/**
+		 * Stores the result for row rows.start()+k in (*values)[k]. If 'invalid_rows'
+		 * is not 0, the rows which could not be evaluated are stored in it; their value
+		 * is NaN.
+		 */
+		void evaluate(Interval<int> rows, QVector<double> * values, QList< Interval<int> > * invalid_rows = 0) const;
+		//! Evaluate the compiled formula for 'rows' and write the results into 'column'
+		/**
+		 * Double columns are written in one undo command (see Column::replaceValues()).
+		 * Text columns get the results as text and date/time columns interpret them as
+		 * Julian days (like Double2DateTimeFilter); both are replaced in one piece as well.
+		 */
+		void apply(Column * column, Interval<int> rows) const;
+
+	private:
+		//! Replace the arguments of col() and tablecol() by column variables
+		bool resolveReferences(const QString& formula);
+		//! Return the column referenced by the arguments of col() / tablecol()
+		const AbstractColumn * resolveColumn(const QString& function, const QStringList& args);
+		//! Return the variable bound to 'column', adding a binding if necessary
+		QString variableFor(const AbstractColumn * column);
+
+		Table * m_table;
+		bool m_compiled;
+		QString m_error;
+		QString m_expression;
+		QList<const AbstractColumn *> m_columns;
+		QStringList m_variables;
+};
+
+#endif // ifndef FORMULAEVALUATOR_H
@@ -0,0 +1,516 @@
+/***************************************************************************
+    File                 : Histogram.cpp
+    Project              : SciDAVis
+    Description          : Binning of column values with cached counts
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "table/Histogram.h"
+#include "table/Table.h"
+#include "core/column/Column.h"
+#include "lib/ValueSpan.h"
+#include "lib/ParallelFor.h"
+
+#include <QObject>
+
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+//! Number of rows counted into one partial histogram
+static const int histogram_block_size = 65536;
+//! Upper limit for the number of automatically chosen bins
+static const int histogram_max_bins = 10000;
+//! Upper limit for the number of bins given by setBins(); bins beyond it are dropped
+static const int histogram_max_user_bins = 1000000;
+//! Rebin everything if more than this fraction of the rows changed since the last update
+static const double histogram_max_changes = 0.25;
+//! Keep the interquartile range until this fraction of the values changed or the range changed by this fraction
+static const double histogram_iqr_tolerance = 0.05;
+
+static inline bool sameValue(double a, double b)
+{
+	return a == b || (a != a && b != b);
+}
+
+//! Round a bin size to 1, 2 or 5 times a power of ten
+static double niceBinSize(double size)
+{
+	double power = pow(10.0, floor(log10(size)));
+	double fraction = size / power;
+	if (fraction < 1.5)
+		return power;
+	else if (fraction < 3.5)
+		return 2*power;
+	else if (fraction < 7.5)
+		return 5*power;
+	return 10*power;
+}
+
+//! Count, extrema, mean and sum of squared deviations of one block of values
+struct HistogramBlockStatistics
+{
+	int count;
+	double min, max, mean, m2;
+};
+
+//! Computes the statistics of blocks of Histogram::m_values; used with parallelFor() over the blocks
+class HistogramStatisticsKernel
+{
+	public:
+		HistogramStatisticsKernel(const Histogram *histogram, HistogramBlockStatistics *blocks)
+			: m_histogram(histogram), m_blocks(blocks) {}
+
+		void operator()(int first, int last) const {
+			const double *values = m_histogram->m_values.constData();
+			int size = m_histogram->m_values.size();
+			for (int b=first; b<=last; b++) {
+				HistogramBlockStatistics &block = m_blocks[b];
+				block.count = 0;
+				block.min = block.max = block.mean = block.m2 = 0;
+				for (int i=b*histogram_block_size; i<qMin(size, (b+1)*histogram_block_size); i++) {
+					double value = values[i];
+					if (value != value)
+						continue;
+					if (block.count++ == 0)
+						block.min = block.max = value;
+					else {
+						block.min = qMin(block.min, value);
+						block.max = qMax(block.max, value);
+					}
+					// Welford's update
+					double delta = value - block.mean;
+					block.mean += delta / block.count;
+					block.m2 += delta * (value - block.mean);
+				}
+			}
+		}
+
+	private:
+		const Histogram *m_histogram;
+		HistogramBlockStatistics *m_blocks;
+};
+
+//! Counts blocks of Histogram::m_values into partial histograms; used with parallelFor() over the blocks
+class HistogramCountKernel
+{
+	public:
+		HistogramCountKernel(const Histogram *histogram, QVector<int> *partial_counts)
+			: m_histogram(histogram), m_partial_counts(partial_counts) {}
+
+		void operator()(int first, int last) const {
+			const double *values = m_histogram->m_values.constData();
+			int size = m_histogram->m_values.size();
+			int bins = m_histogram->m_counts.size();
+			for (int b=first; b<=last; b++) {
+				QVector<int> &partial = m_partial_counts[b];
+				partial.fill(0, bins);
+				int *counts = partial.data();
+				for (int i=b*histogram_block_size; i<qMin(size, (b+1)*histogram_block_size); i++) {
+					double value = values[i];
+					if (value != value)
+						continue;
+					int bin = m_histogram->binOf(value);
+					if (bin >= 0 && bin < bins)
+						counts[bin]++;
+				}
+			}
+		}
+
+	private:
+		const Histogram *m_histogram;
+		QVector<int> *m_partial_counts;
+};
+
+Histogram::Histogram()
+	: m_rule(FreedmanDiaconis), m_user_begin(0), m_user_end(0), m_user_size(0),
+	m_begin(0), m_bin_size(0), m_value_count(0), m_min(0), m_max(0),
+	m_shift(0), m_sum(0), m_sum_squares(0),
+	m_iqr(0), m_iqr_changes(-1), m_iqr_count(0), m_iqr_range(0)
+{
+}
+
+void Histogram::setBinningRule(BinningRule rule)
+{
+	m_rule = rule;
+	clear();
+}
+
+void Histogram::setBins(double begin, double end, double size)
+{
+	m_rule = UserBins;
+	m_user_begin = begin;
+	m_user_end = end;
+	m_user_size = size;
+	clear();
+}
+
+void Histogram::clear()
+{
+	m_values.clear();
+	m_counts.clear();
+	m_value_count = 0;
+	m_min = m_max = 0;
+	m_shift = m_sum = m_sum_squares = 0;
+	invalidateInterquartileRange();
+}
+
+void Histogram::update(const AbstractColumn *column, int first_row, int last_row)
+{
+	if (!column || column->dataType() != SciDAVis::TypeDouble) {
+		update(ValueSpan());
+		return;
+	}
+	if (last_row < 0 || last_row >= column->rowCount())
+		last_row = column->rowCount() - 1;
+	if (last_row < first_row)
+		update(ValueSpan());
+	else
+		update(column->valueSpan(Interval<int>(first_row, last_row)));
+}
+
+void Histogram::update(const ValueSpan &values)
+{
+	int size = values.size(), old_size = m_values.size();
+	int max_changes = int(histogram_max_changes * qMax(size, old_size));
+	const QVector<quint64> &invalid_bits = values.invalidBits();
+
+	// find the rows which changed since the last update; changes of rows >= size are removals
+	QVector<int> changed_rows;
+	QVector<double> old_values;
+	bool incremental = old_size > 0 && qAbs(size - old_size) <= max_changes;
+	if (incremental) {
+		double *cached = m_values.data();
+		int common = qMin(size, old_size);
+		for (int word=0; incremental && word*64 < common; word++) {
+			int first = word*64, count = qMin(64, common - first);
+			bool word_valid = invalid_bits.isEmpty() || invalid_bits.at(word) == 0;
+			if (word_valid && memcmp(cached + first, values.data() + first, count*sizeof(double)) == 0)
+				continue;
+			for (int i=first; i<first+count; i++) {
+				double value = values.isInvalid(i) ? NAN : values.at(i);
+				if (sameValue(value, cached[i]))
+					continue;
+				changed_rows << i;
+				old_values << cached[i];
+				cached[i] = value;
+			}
+			incremental = changed_rows.size() <= max_changes;
+		}
+		for (int i=size; incremental && i<old_size; i++)
+			if (cached[i] == cached[i]) {
+				changed_rows << i;
+				old_values << cached[i];
+			}
+	}
+	m_values.resize(size);
+	if (!incremental) {
+		double *cached = m_values.data();
+		if (size > 0)
+			memcpy(cached, values.data(), size*sizeof(double));
+		if (values.hasInvalid())
+			for (int i=0; i<size; i++)
+				if (values.isInvalid(i))
+					cached[i] = NAN;
+		rebin();
+		return;
+	}
+	for (int i=old_size; i<size; i++) {
+		double value = values.isInvalid(i) ? NAN : values.at(i);
+		m_values[i] = value;
+		if (value == value) {
+			changed_rows << i;
+			old_values << NAN;
+		}
+	}
+	if (changed_rows.isEmpty())
+		return;
+
+	// update the statistics
+	bool range_lost = m_value_count == 0;
+	for (int k=0; k<changed_rows.size(); k++) {
+		int row = changed_rows.at(k);
+		double old_value = old_values.at(k), new_value = row < size ? m_values.at(row) : NAN;
+		if (old_value == old_value) {
+			m_value_count--;
+			m_sum -= old_value - m_shift;
+			m_sum_squares -= (old_value - m_shift)*(old_value - m_shift);
+			if (old_value <= m_min || old_value >= m_max)
+				range_lost = true;
+		}
+		if (new_value == new_value) {
+			m_value_count++;
+			m_sum += new_value - m_shift;
+			m_sum_squares += (new_value - m_shift)*(new_value - m_shift);
+			if (!range_lost) {
+				m_min = qMin(m_min, new_value);
+				m_max = qMax(m_max, new_value);
+			}
+		}
+	}
+	if (range_lost)
+		updateRange();
+	if (m_iqr_changes >= 0)
+		m_iqr_changes += changed_rows.size();
+
+	// move the changed values between the bins, unless the bins changed as well
+	double begin, bin_size;
+	int bins;
+	chooseBins(&begin, &bin_size, &bins);
+	if (begin != m_begin || bin_size != m_bin_size || bins != m_counts.size()) {
+		m_begin = begin;
+		m_bin_size = bin_size;
+		m_counts.resize(bins);
+		countBins();
+		return;
+	}
+	int *counts = m_counts.data();
+	for (int k=0; k<changed_rows.size(); k++) {
+		int row = changed_rows.at(k);
+		double old_value = old_values.at(k), new_value = row < size ? m_values.at(row) : NAN;
+		if (old_value == old_value) {
+			int bin = binOf(old_value);
+			if (bin >= 0 && bin < bins)
+				counts[bin]--;
+		}
+		if (new_value == new_value) {
+			int bin = binOf(new_value);
+			if (bin >= 0 && bin < bins)
+				counts[bin]++;
+		}
+	}
+}
+
+void Histogram::rebin()
+{
+	int blocks = (m_values.size() + histogram_block_size - 1) / histogram_block_size;
+	QVector<HistogramBlockStatistics> statistics(blocks);
+	parallelFor(0, blocks-1, HistogramStatisticsKernel(this, statistics.data()));
+
+	// merge the blocks (Chan et al.), then keep sums relative to the mean
+	int count = 0;
+	double mean = 0, m2 = 0;
+	m_min = m_max = 0;
+	foreach(const HistogramBlockStatistics &block, statistics) {
+		if (block.count == 0)
+			continue;
+		if (count == 0) {
+			m_min = block.min;
+			m_max = block.max;
+		} else {
+			m_min = qMin(m_min, block.min);
+			m_max = qMax(m_max, block.max);
+		}
+		double delta = block.mean - mean;
+		int total = count + block.count;
+		mean += delta * block.count / total;
+		m2 += block.m2 + delta*delta * double(count) * block.count / total;
+		count = total;
+	}
+	m_value_count = count;
+	m_shift = mean;
+	m_sum = 0;
+	m_sum_squares = m2;
+	invalidateInterquartileRange();
+
+	int bins;
+	chooseBins(&m_begin, &m_bin_size, &bins);
+	m_counts.resize(bins);
+	countBins();
+}
+
+void Histogram::countBins()
+{
+	int bins = m_counts.size();
+	if (bins == 0)
+		return;
+	int blocks = (m_values.size() + histogram_block_size - 1) / histogram_block_size;
+	QVector< QVector<int> > partial_counts(blocks);
+	parallelFor(0, blocks-1, HistogramCountKernel(this, partial_counts.data()));
+
+	m_counts.fill(0, bins);
+	int *counts = m_counts.data();
+	foreach(const QVector<int> &partial, partial_counts)
+		for (int bin=0; bin<bins; bin++)
+			counts[bin] += partial.at(bin);
+}
+
+void Histogram::updateRange()
+{
+	bool first = true;
+	m_min = m_max = 0;
+	const double *values = m_values.constData();
+	for (int i=0; i<m_values.size(); i++) {
+		double value = values[i];
+		if (value != value)
+			continue;
+		if (first) {
+			m_min = m_max = value;
+			first = false;
+		} else {
+			m_min = qMin(m_min, value);
+			m_max = qMax(m_max, value);
+		}
+	}
+}
+
+double Histogram::interquartileRange() const
+{
+	QVector<double> values;
+	values.reserve(m_value_count);
+	foreach(double value, m_values)
+		if (value == value)
+			values << value;
+	if (values.size() < 2)
+		return 0;
+	double *data = values.data();
+	int n = values.size(), upper = (3*(n-1))/4, lower = (n-1)/4;
+	std::nth_element(data, data + upper, data + n);
+	double q3 = data[upper];
+	// everything below 'upper' is <= q3 now, so the first quartile is among those
+	std::nth_element(data, data + lower, data + upper);
+	return q3 - data[lower];
+}
+
+void Histogram::chooseBins(double *begin, double *size, int *count) const
+{
+	if (m_rule == UserBins) {
+		*begin = m_user_begin;
+		*size = m_user_size;
+		*count = 0;
+		if (m_user_size > 0 && m_user_end >= m_user_begin) {
+			// compare as double, a tiny size would overflow int
+			double bins = floor((m_user_end - m_user_begin)/m_user_size) + 1;
+			*count = bins < histogram_max_user_bins ? int(bins) : histogram_max_user_bins;
+		}
+		return;
+	}
+
+	*begin = m_min;
+	*size = 0;
+	*count = 0;
+	if (m_value_count < 2 || m_min == m_max)
+		return;
+
+	double n = m_value_count, width = 0;
+	switch (m_rule) {
+		case FreedmanDiaconis:
+			{
+				// selecting the quartiles copies all values, so small updates keep the last result
+				double range = m_max - m_min;
+				if (m_iqr_changes < 0 || m_iqr_changes > histogram_iqr_tolerance*m_iqr_count ||
+						fabs(range - m_iqr_range) > histogram_iqr_tolerance*m_iqr_range) {
+					m_iqr = interquartileRange();
+					m_iqr_changes = 0;
+					m_iqr_count = m_value_count;
+					m_iqr_range = range;
+				}
+			}
+			width = 2*m_iqr/pow(n, 1.0/3.0);
+			if (width > 0)
+				break;
+			// fall through: use Scott's rule if more than half of the values are equal
+		case Scott:
+			width = 3.49*standardDeviation()/pow(n, 1.0/3.0);
+			if (width > 0)
+				break;
+			// fall through: all values but a few are equal
+		case Sturges:
+		default:
+			width = (m_max - m_min)/(ceil(log(n)/log(2.0)) + 1);
+			break;
+	}
+
+	width = niceBinSize(width);
+	while (true) {
+		double start = floor(m_min/width)*width;
+		// rounding may put the minimum just below 'start'
+		if (floor((m_min - start)/width) < 0)
+			start -= width;
+		double bins = floor((m_max - start)/width) + 1;
+		if (bins <= histogram_max_bins) {
+			*begin = start;
+			*size = width;
+			*count = int(bins);
+			return;
+		}
+		width = niceBinSize(2*width);
+	}
+}
+
+int Histogram::binOf(double value) const
+{
+	if (m_counts.isEmpty())
+		return 0;
+	double bin = floor((value - m_begin)/m_bin_size);
+	if (bin < 0)
+		return -1;
+	if (bin >= m_counts.size())
+		return m_counts.size();
+	return int(bin);
+}
+
+double Histogram::mean() const
+{
+	return m_value_count > 0 ? m_shift + m_sum/m_value_count : NAN;
+}
+
+double Histogram::standardDeviation() const
+{
+	if (m_value_count < 2)
+		return 0;
+	double variance = (m_sum_squares - m_sum*m_sum/m_value_count)/(m_value_count - 1);
+	return variance > 0 ? sqrt(variance) : 0;
+}
+
+Table *Histogram::resultTable(const QString &name) const
+{
+	int bins = m_counts.size();
+	QVector<double> starts(bins), counts(bins), sums(bins), percents(bins);
+	double sum = 0, total = 0;
+	for (int i=0; i<bins; i++)
+		total += m_counts.at(i);
+	for (int i=0; i<bins; i++) {
+		starts[i] = binStart(i);
+		counts[i] = m_counts.at(i);
+		sum += m_counts.at(i);
+		sums[i] = sum;
+		percents[i] = total > 0 ? sum/total*100 : 0;
+	}
+
+	Table *result = new Table(0, 0, 0, name);
+	Column *bins_column = new Column(QObject::tr("Bins"), starts);
+	bins_column->setPlotDesignation(SciDAVis::X);
+	result->addChild(bins_column);
+	Column *column = new Column(QObject::tr("Quantity"), counts);
+	column->setPlotDesignation(SciDAVis::Y);
+	result->addChild(column);
+	column = new Column(QObject::tr("Sum"), sums);
+	column->setPlotDesignation(SciDAVis::Y);
+	result->addChild(column);
+	column = new Column(QObject::tr("Percent"), percents);
+	column->setPlotDesignation(SciDAVis::Y);
+	result->addChild(column);
+	return result;
+}
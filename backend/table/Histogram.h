@@ -0,0 +1,163 @@
+/***************************************************************************
+    File                 : Histogram.h
+    Project              : SciDAVis
+    Description          : Binning of column values with cached counts
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <QVector>
+#include <QString>
+
+class AbstractColumn;
+class ValueSpan;
+class Table;
+
+//! Counts the values of a column falling into a range of equally sized bins
+/**
+ * The bins are either given explicitly (see setBins()) or chosen by one of the usual
+ * rules from the number, spread and interquartile range of the values (see
+ * setBinningRule()). Automatic bin sizes are rounded to 1, 2 or 5 times a power of
+ * ten, and the bins start at a multiple of the bin size.
+ *
+ * Binning reads the column storage directly (see AbstractColumn::valueSpan()) and runs
+ * in blocks on all cores, each block counting into a partial histogram of its own;
+ * the partial histograms are added up afterwards. A copy of the binned values is kept:
+ * when update() is called again, only rows which were appended, removed or changed
+ * since the last update are moved between bins, as long as the bins stay the same.
+ * Changing a few rows of a large column therefore does not rebin the whole column.
+ * For the same reason, the interquartile range needed by the Freedman-Diaconis rule is
+ * only recomputed once a noticeable fraction of the values or the range changed.
+ *
+ * \code
+ * Histogram histogram;
+ * histogram.setBinningRule(Histogram::FreedmanDiaconis);
+ * histogram.update(column);
+ * for (int i=0; i<histogram.binCount(); i++)
+ * 	qDebug() << histogram.binStart(i) << histogram.count(i);
+ * project->addChild(histogram.resultTable(tr("Bins")));
+ * \endcode
+ */
+class Histogram
+{
+	public:
+		//! How the bins are chosen
+		enum BinningRule {
+			UserBins, //!< bins given by setBins()
+			Sturges, //!< ceil(log2(n))+1 bins between minimum and maximum
+			Scott, //!< bin size 3.49*sigma/n^(1/3)
+			FreedmanDiaconis //!< bin size 2*IQR/n^(1/3) (default)
+		};
+
+		Histogram();
+
+		BinningRule binningRule() const { return m_rule; }
+		//! Choose the bins automatically
+		void setBinningRule(BinningRule rule);
+		//! Use bins of width 'size' starting at 'begin', covering 'end'
+		/**
+		 * Switches the binning rule to UserBins. At most a million bins are used; if 'size'
+		 * is too small for that, the bins beyond the millionth are dropped.
+		 */
+		void setBins(double begin, double end, double size);
+
+		//! Bin the valid values in rows first_row..last_row of 'column' (last_row < 0: up to the end)
+		/**
+		 * Only numeric columns can be binned; other columns result in an empty histogram.
+		 */
+		void update(const AbstractColumn *column, int first_row = 0, int last_row = -1);
+		//! Bin the valid values of 'values'
+		void update(const ValueSpan &values);
+		//! Forget the cached values; the next update() rebins everything
+		void clear();
+
+		//! Number of bins (0 if there are less than two distinct values)
+		int binCount() const { return m_counts.size(); }
+		double begin() const { return m_begin; }
+		//! End of the last bin
+		double end() const { return m_begin + m_counts.size()*m_bin_size; }
+		double binSize() const { return m_bin_size; }
+		//! Lower edge of bin i
+		double binStart(int i) const { return m_begin + i*m_bin_size; }
+		//! Number of values in bin i
+		int count(int i) const { return m_counts.at(i); }
+		const QVector<int>& counts() const { return m_counts; }
+
+		//! \name Statistics of all valid values (including the ones outside of the bins)
+		//@{
+		int valueCount() const { return m_value_count; }
+		double mean() const;
+		double standardDeviation() const;
+		double minimum() const { return m_min; }
+		double maximum() const { return m_max; }
+		//@}
+
+		//! Create a table listing bins, counts, cumulative counts and percentages
+		Table *resultTable(const QString &name) const;
+
+	private:
+		//! Compute the bins according to m_rule from the statistics of m_values
+		void chooseBins(double *begin, double *size, int *count) const;
+		//! Bin index of 'value' (-1 below the first bin, binCount() above the last one)
+		int binOf(double value) const;
+		//! Recompute the statistics of m_values and bin all of them
+		void rebin();
+		//! Bin all of m_values into the current bins
+		void countBins();
+		//! Recompute minimum and maximum from m_values
+		void updateRange();
+		//! Interquartile range of the valid values
+		double interquartileRange() const;
+		//! Forget the cached interquartile range
+		void invalidateInterquartileRange() { m_iqr_changes = -1; }
+
+		BinningRule m_rule;
+		//! Bins set by setBins()
+		double m_user_begin, m_user_end, m_user_size;
+
+		double m_begin, m_bin_size;
+		QVector<int> m_counts;
+
+		//! Values binned by the last update(); NaN for invalid rows
+		QVector<double> m_values;
+		int m_value_count;
+		double m_min, m_max;
+		//! Sums of (value-m_shift) and (value-m_shift)^2, the shift avoids cancellation in standardDeviation()
+		double m_shift, m_sum, m_sum_squares;
+
+		//! Interquartile range used by the last Freedman-Diaconis binning (see chooseBins())
+		mutable double m_iqr;
+		//! Number of values changed since m_iqr was computed, -1 if it has to be recomputed
+		mutable int m_iqr_changes;
+		//! Value count and range (m_max-m_min) at the time m_iqr was computed
+		mutable int m_iqr_count;
+		mutable double m_iqr_range;
+
+		friend class HistogramStatisticsKernel;
+		friend class HistogramCountKernel;
+};
+
+#endif // ifndef HISTOGRAM_H
@@ -0,0 +1,191 @@
+/***************************************************************************
+    File                 : RowSorter.cpp
+    Project              : SciDAVis
+    Description          : Stable multi-key sort of table rows
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "table/RowSorter.h"
+#include "core/AbstractColumn.h"
+#include "lib/ParallelFor.h"
+
+#include <QStringList>
+#include <QDateTime>
+#include <QtAlgorithms>
+
+#include <math.h>
+
+//! Number of rows sorted by one thread before the chunks are merged
+static const int row_sort_chunk_size = 32768;
+
+//! Strict, total order of row indices used by RowSorter
+class RowSortCompare
+{
+	public:
+		//! 'keys' must stay valid while the comparison is used
+		RowSortCompare(const double * const *keys, int key_count, bool invalid_last)
+			: m_keys(keys), m_key_count(key_count), m_invalid_last(invalid_last) {}
+
+		bool operator()(int a, int b) const {
+			for (int k=0; k<m_key_count; k++) {
+				double va = m_keys[k][a], vb = m_keys[k][b];
+				bool invalid_a = va != va, invalid_b = vb != vb;
+				if (invalid_a || invalid_b) {
+					if (invalid_a && invalid_b) continue;
+					return invalid_a != m_invalid_last;
+				}
+				if (va < vb) return true;
+				if (vb < va) return false;
+			}
+			// equal keys: keep the original order
+			return a < b;
+		}
+
+	private:
+		// plain pointers: qSort() copies the comparison a lot
+		const double * const *m_keys;
+		int m_key_count;
+		bool m_invalid_last;
+};
+
+//! Sorts chunks of row_sort_chunk_size rows; used with parallelFor()
+class RowSortChunkKernel
+{
+	public:
+		RowSortChunkKernel(int *rows, int count, const RowSortCompare &compare)
+			: m_rows(rows), m_count(count), m_compare(compare) {}
+
+		void operator()(int first, int last) const {
+			for (int c=first; c<=last; c++)
+				qSort(m_rows + c*row_sort_chunk_size, m_rows + qMin(m_count, (c+1)*row_sort_chunk_size), m_compare);
+		}
+
+	private:
+		int *m_rows;
+		int m_count;
+		const RowSortCompare &m_compare;
+};
+
+//! Merges pairs of adjacent sorted runs of length 'width'; used with parallelFor() over the pairs
+class RowMergeKernel
+{
+	public:
+		RowMergeKernel(const int *source, int *dest, int count, int width, const RowSortCompare &compare)
+			: m_source(source), m_dest(dest), m_count(count), m_width(width), m_compare(compare) {}
+
+		void operator()(int first, int last) const {
+			for (int p=first; p<=last; p++) {
+				int i = 2*p*m_width, middle = qMin(m_count, i + m_width), end = qMin(m_count, i + 2*m_width);
+				int j = middle, out = i;
+				while (i < middle && j < end)
+					m_dest[out++] = m_compare(m_source[j], m_source[i]) ? m_source[j++] : m_source[i++];
+				while (i < middle)
+					m_dest[out++] = m_source[i++];
+				while (j < end)
+					m_dest[out++] = m_source[j++];
+			}
+		}
+
+	private:
+		const int *m_source;
+		int *m_dest;
+		int m_count;
+		int m_width;
+		const RowSortCompare &m_compare;
+};
+
+RowSorter::RowSorter(int rows)
+	: m_rows(qMax(rows, 0)), m_invalid_placement(InvalidLast)
+{
+}
+
+void RowSorter::addKey(const AbstractColumn * column, bool ascending)
+{
+	QVector<double> values(m_rows);
+	int rows = qMin(m_rows, column->rowCount());
+	switch (column->dataType())
+	{
+		case SciDAVis::TypeDouble:
+			column->valuesAt(0, rows, values.data());
+			break;
+		case SciDAVis::TypeQDateTime:
+			{
+				QTime midnight(0, 0);
+				for (int i=0; i<rows; i++) {
+					QDateTime date_time = column->dateTimeAt(i);
+					values[i] = date_time.isValid() ?
+						date_time.date().toJulianDay()*86400000.0 + midnight.msecsTo(date_time.time()) : NAN;
+				}
+				break;
+			}
+		case SciDAVis::TypeQString:
+			{
+				QStringList texts;
+				for (int i=0; i<rows; i++)
+					texts << column->textAt(i);
+				QStringList sorted = texts;
+				qSort(sorted);
+				for (int i=0; i<rows; i++)
+					values[i] = qLowerBound(sorted.constBegin(), sorted.constEnd(), texts.at(i)) - sorted.constBegin();
+				break;
+			}
+	}
+
+	double *data = values.data();
+	if (!ascending)
+		for (int i=0; i<rows; i++)
+			data[i] = -data[i];
+	for (int i=rows; i<m_rows; i++)
+		data[i] = NAN;
+	foreach(Interval<int> invalid, column->invalidIntervals())
+		for (int i=qMax(invalid.start(), 0); i<=qMin(invalid.end(), rows-1); i++)
+			data[i] = NAN;
+
+	m_keys << values;
+}
+
+QVector<int> RowSorter::permutation() const
+{
+	QVector<int> result(m_rows);
+	for (int i=0; i<m_rows; i++)
+		result[i] = i;
+	if (m_keys.isEmpty() || m_rows < 2)
+		return result;
+
+	QVector<const double *> keys;
+	foreach(const QVector<double> &key, m_keys)
+		keys << key.constData();
+	RowSortCompare compare(keys.constData(), keys.size(), m_invalid_placement == InvalidLast);
+
+	int chunks = (m_rows + row_sort_chunk_size - 1) / row_sort_chunk_size;
+	parallelFor(0, chunks-1, RowSortChunkKernel(result.data(), m_rows, compare));
+
+	QVector<int> buffer(m_rows);
+	for (int width=row_sort_chunk_size; width<m_rows; width*=2) {
+		int pairs = (m_rows + 2*width - 1) / (2*width);
+		parallelFor(0, pairs-1, RowMergeKernel(result.constData(), buffer.data(), m_rows, width, compare));
+		qSwap(result, buffer);
+	}
+	return result;
+}
@@ -0,0 +1,96 @@
+/***************************************************************************
+    File                 : RowSorter.h
+    Project              : SciDAVis
+    Description          : Stable multi-key sort of table rows
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ROW_SORTER_H
+#define ROW_SORTER_H
+
+#include <QVector>
+#include <QList>
+
+class AbstractColumn;
+
+//! Computes the order of the rows of a table for sorting
+/**
+ * Rows are compared by a list of key columns: rows with equal values in the first
+ * key are ordered by the second key and so on. Rows which are equal in all keys keep
+ * their original order, i.e. the sort is stable. Each key is sorted ascending or
+ * descending; invalid cells (including NaN values and invalid date-times) are placed
+ * at the end (or at the beginning, see setInvalidPlacement()) for either direction.
+ *
+ * The result is a permutation of the row indices, which can be applied to any number
+ * of columns with Column::permuteRows(). When a key is added, its cells are converted
+ * to doubles once (date-times to milliseconds, strings to their rank among all strings
+ * of the key), so the comparisons do not touch the columns at all. Large inputs are
+ * sorted in chunks in parallel (see parallelFor()) which are merged afterwards.
+ *
+ * \code
+ * RowSorter sorter(table->rowCount());
+ * sorter.addKey(x_column);
+ * sorter.addKey(y_column, false);
+ * QVector<int> permutation = sorter.permutation();
+ * foreach(Column *col, table->children<Column>())
+ * 	col->permuteRows(permutation);
+ * \endcode
+ */
+class RowSorter
+{
+	public:
+		//! Where to put invalid cells of a key
+		enum InvalidPlacement {
+			InvalidLast, //!< after all valid cells (default)
+			InvalidFirst //!< before all valid cells
+		};
+
+		//! Prepare sorting rows 0 to rows-1
+		RowSorter(int rows);
+
+		//! Add a key column
+		/**
+		 * Rows beyond the end of 'column' are treated as invalid.
+		 */
+		void addKey(const AbstractColumn * column, bool ascending = true);
+		//! Return the number of key columns
+		int keyCount() const { return m_keys.size(); }
+		InvalidPlacement invalidPlacement() const { return m_invalid_placement; }
+		void setInvalidPlacement(InvalidPlacement placement) { m_invalid_placement = placement; }
+
+		//! Return the sorted order of the rows
+		/**
+		 * Row i of the sorted table is row permutation().at(i) of the unsorted one.
+		 */
+		QVector<int> permutation() const;
+
+	private:
+		//! Number of rows to sort
+		int m_rows;
+		//! Converted key values (negated for descending keys, NaN for invalid cells)
+		QList< QVector<double> > m_keys;
+		InvalidPlacement m_invalid_placement;
+};
+
+#endif
@@ -29,6 +29,7 @@
  *                                                                         *
  ***************************************************************************/
 #include "table/Table.h"
+#include "table/RowSorter.h"
 
 #ifdef ACTIVATE_SCIDAVIS_SPECIFIC_CODE
 #include "table/TableView.h"
@@ -271,227 +272,45 @@ void Table::sortColumns(Column *leading, QList<Column*> cols, bool ascending)
 {
 	if(cols.isEmpty()) return;
 
-	// the normal QPair comparison does not work properly with descending sorting
-	// thefore we use our own compare functions
-	class CompareFunctions{ 
-		public:
-			static bool doubleLess(const QPair<double, int>& a, const QPair<double, int>& b)
-			{
-				return a.first < b.first;
-			}
-			static bool doubleGreater(const QPair<double, int>& a, const QPair<double, int>& b)
-			{
-				return a.first > b.first;
-			}
-			static bool QStringLess(const QPair<QString, int>& a, const QPair<QString, int>& b)
-			{
-				return a < b;
-			}
-			static bool QStringGreater(const QPair<QString, int>& a, const QPair<QString, int>& b)
-			{
-				return a > b;
-			}
-			static bool QDateTimeLess(const QPair<QDateTime, int>& a, const QPair<QDateTime, int>& b)
-			{
-				return a < b;
-			}
-			static bool QDateTimeGreater(const QPair<QDateTime, int>& a, const QPair<QDateTime, int>& b)
-			{
-				return a > b;
-			}
-	};
+	if(leading != 0)
+	{
+		sortColumns(QList<Column*>() << leading, QList<bool>() << ascending, cols);
+		return;
+	}
 
 	WAIT_CURSOR;
 	beginMacro(tr("%1: sort column(s)").arg(name()));
-
-	if(leading == 0) // sort separately
+	// sort separately
+	foreach(Column *col, cols)
 	{
-		for(int i=0; i<cols.size(); i++)
-		{
-			Column* col = cols.at(i);
-
-			if(col->dataType() == SciDAVis::TypeDouble)
-			{
-				int rows = col->rowCount();
-				QList< QPair<double, int> > map;
-
-				for(int j=0; j<rows; j++)
-					map.append(QPair<double, int>(col->valueAt(j), j));
-	
-				if(ascending)
-					qStableSort(map.begin(), map.end(), CompareFunctions::doubleLess);
-				else
-					qStableSort(map.begin(), map.end(), CompareFunctions::doubleGreater);
-
-				QListIterator< QPair<double, int> > it(map);
-				Column *temp_col = new Column("temp", col->columnMode());
-				
-				int k=0;
-				// put the values in the right order into temp_col
-				while(it.hasNext())
-				{
-					temp_col->copy(col, it.peekNext().second, k, 1);
-					temp_col->setMasked(col->isMasked(it.next().second));
-					k++;
-				}
-				// copy the sorted column
-				col->copy(temp_col, 0, 0, rows);
-				delete temp_col;
-			}
-			else if(col->dataType() == SciDAVis::TypeQString)
-			{
-				int rows = col->rowCount();
-				QList< QPair<QString, int> > map;
-
-				for(int j=0; j<rows; j++)
-					map.append(QPair<QString, int>(col->textAt(j), j));
-	
-				if(ascending)
-					qStableSort(map.begin(), map.end(), CompareFunctions::QStringLess);
-				else
-					qStableSort(map.begin(), map.end(), CompareFunctions::QStringGreater);
-
-				QListIterator< QPair<QString, int> > it(map);
-				Column *temp_col = new Column("temp", col->columnMode());
-				
-				int k=0;
-				// put the values in the right order into temp_col
-				while(it.hasNext())
-				{
-					temp_col->copy(col, it.peekNext().second, k, 1);
-					temp_col->setMasked(col->isMasked(it.next().second));
-					k++;
-				}
-				// copy the sorted column
-				col->copy(temp_col, 0, 0, rows);
-				delete temp_col;
-			}
-			else if(col->dataType() == SciDAVis::TypeQDateTime)
-			{
-				int rows = col->rowCount();
-				QList< QPair<QDateTime, int> > map;
-
-				for(int j=0; j<rows; j++)
-					map.append(QPair<QDateTime, int>(col->dateTimeAt(j), j));
-	
-				if(ascending)
-					qStableSort(map.begin(), map.end(), CompareFunctions::QDateTimeLess);
-				else
-					qStableSort(map.begin(), map.end(), CompareFunctions::QDateTimeGreater);
-
-				QListIterator< QPair<QDateTime, int> > it(map);
-				Column *temp_col = new Column("temp", col->columnMode());
-				
-				int k=0;
-				// put the values in the right order into temp_col
-				while(it.hasNext())
-				{
-					temp_col->copy(col, it.peekNext().second, k, 1);
-					temp_col->setMasked(col->isMasked(it.next().second));
-					k++;
-				}
-				// copy the sorted column
-				col->copy(temp_col, 0, 0, rows);
-				delete temp_col;
-			}
-		}
-		
+		RowSorter sorter(col->rowCount());
+		sorter.addKey(col, ascending);
+		col->permuteRows(sorter.permutation());
 	}
-	else // sort with leading column
-	{
-		if(leading->dataType() == SciDAVis::TypeDouble)
-		{
-			QList< QPair<double, int> > map;
-			int rows = leading->rowCount();
-
-			for(int i=0; i<rows; i++)
-				map.append(QPair<double, int>(leading->valueAt(i), i));
-
-			if(ascending)
-				qStableSort(map.begin(), map.end(), CompareFunctions::doubleLess);
-			else
-				qStableSort(map.begin(), map.end(), CompareFunctions::doubleGreater);
-			QListIterator< QPair<double, int> > it(map);
-
-			for(int i=0; i<cols.size(); i++) 
-			{
-				Column *temp_col = new Column("temp", cols.at(i)->columnMode());
-				it.toFront();
-				int j=0;
-				// put the values in the right order into temp_col
-				while(it.hasNext())
-				{
-					temp_col->copy(cols.at(i), it.peekNext().second, j, 1);
-					temp_col->setMasked(cols.at(i)->isMasked(it.next().second));
-					j++;
-				}
-				// copy the sorted column
-				cols.at(i)->copy(temp_col, 0, 0, rows);
-				delete temp_col;
-			}
-		}
-		else if(leading->dataType() == SciDAVis::TypeQString)
-		{
-			QList< QPair<QString, int> > map;
-			int rows = leading->rowCount();
-
-			for(int i=0; i<rows; i++)
-				map.append(QPair<QString, int>(leading->textAt(i), i));
-
-			if(ascending)
-				qStableSort(map.begin(), map.end(), CompareFunctions::QStringLess);
-			else
-				qStableSort(map.begin(), map.end(), CompareFunctions::QStringGreater);
-			QListIterator< QPair<QString, int> > it(map);
-
-			for(int i=0; i<cols.size(); i++) 
-			{
-				Column *temp_col = new Column("temp", cols.at(i)->columnMode());
-				it.toFront();
-				int j=0;
-				// put the values in the right order into temp_col
-				while(it.hasNext())
-				{
-					temp_col->copy(cols.at(i), it.peekNext().second, j, 1);
-					temp_col->setMasked(cols.at(i)->isMasked(it.next().second));
-					j++;
-				}
-				// copy the sorted column
-				cols.at(i)->copy(temp_col, 0, 0, rows);
-				delete temp_col;
-			}
-		}
-		else if(leading->dataType() == SciDAVis::TypeQDateTime)
-		{
-			QList< QPair<QDateTime, int> > map;
-			int rows = leading->rowCount();
+	endMacro();
+	RESET_CURSOR;
+}
 
-			for(int i=0; i<rows; i++)
-				map.append(QPair<QDateTime, int>(leading->dateTimeAt(i), i));
+void Table::sortColumns(QList<Column*> keys, QList<bool> ascending, QList<Column*> cols)
+{
+	if(cols.isEmpty() || keys.isEmpty()) return;
 
-			if(ascending)
-				qStableSort(map.begin(), map.end(), CompareFunctions::QDateTimeLess);
-			else
-				qStableSort(map.begin(), map.end(), CompareFunctions::QDateTimeGreater);
-			QListIterator< QPair<QDateTime, int> > it(map);
+	WAIT_CURSOR;
+	int rows = 0;
+	foreach(Column *key, keys)
+		rows = qMax(rows, key->rowCount());
+	RowSorter sorter(rows);
+	for(int i=0; i<keys.size(); i++)
+		sorter.addKey(keys.at(i), i < ascending.size() ? ascending.at(i) : true);
+	QVector<int> permutation = sorter.permutation();
 
-			for(int i=0; i<cols.size(); i++) 
-			{
-				Column *temp_col = new Column("temp", cols.at(i)->columnMode());
-				it.toFront();
-				int j=0;
-				// put the values in the right order into temp_col
-				while(it.hasNext())
-				{
-					temp_col->copy(cols.at(i), it.peekNext().second, j, 1);
-					temp_col->setMasked(cols.at(i)->isMasked(it.next().second));
-					j++;
-				}
-				// copy the sorted column
-				cols.at(i)->copy(temp_col, 0, 0, rows);
-				delete temp_col;
-			}
-		}
+	beginMacro(tr("%1: sort column(s)").arg(name()));
+	foreach(Column *col, cols)
+	{
+		// shorter columns get invalid rows up to the length of the keys
+		if(col->rowCount() < rows)
+			col->insertRows(col->rowCount(), rows - col->rowCount());
+		col->permuteRows(permutation);
 	}
 	endMacro();
 	RESET_CURSOR;
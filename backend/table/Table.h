@@ -140,6 +140,14 @@ class Table : public AbstractPart, public scripted
 		 * If 'leading' is a null pointer, each column is sorted separately.
 		 */
 		void sortColumns(Column * leading, QList<Column*> cols, bool ascending);
+		//! Sort the rows of the given columns by several key columns
+		/**
+		 * The rows are ordered by keys.at(0), rows with equal values there by keys.at(1)
+		 * and so on (see RowSorter); invalid cells come last. ascending.at(i) gives the
+		 * direction for keys.at(i) (default: ascending). All columns are reordered by the
+		 * same permutation, which is all the undo commands store.
+		 */
+		void sortColumns(QList<Column*> keys, QList<bool> ascending, QList<Column*> cols);
 
 	signals:
 #ifdef ACTIVATE_SCIDAVIS_SPECIFIC_CODE
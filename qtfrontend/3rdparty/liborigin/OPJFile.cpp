@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdarg.h>
 
 #include <algorithm> //required for std::swap
 #include "OPJFile.h"
@@ -57,8 +58,41 @@ void OPJFile::ByteSwap(unsigned char * b, int n) {
 	}
 }
 
+static void LogPrint(FILE *debug, const char *format, ...) { // fprintf() to the log, if there is one
+	if(!debug)
+		return;
+	va_list args;
+	va_start(args, format);
+	vfprintf(debug, format, args);
+	va_end(args);
+}
+
+static void LogFlush(FILE *debug) {
+	if(debug)
+		fflush(debug);
+}
+
+bool OPJReader::open(const char *filename) {
+	FILE *f;
+	if((f=fopen(filename,"rb")) == NULL )
+		return false;
+
+	fseek(f,0,SEEK_END);
+	long size=ftell(f);
+	fseek(f,0,SEEK_SET);
+	bool ok = size >= 0;
+	if(ok) {
+		data.resize(size);
+		ok = size == 0 || fread(&data[0],1,size,f) == (size_t)size;
+	}
+	fclose(f);
+	pos=0;
+	return ok;
+}
+
 OPJFile::OPJFile(const char *filename)
 	: filename(filename)
+	, logfile(0)
 {
 	version=0;
 	dataIndex=0;
@@ -136,8 +170,8 @@ filepre +
 
 /* parse file "filename" completely and save values */
 int OPJFile::Parse() {
-	FILE *f;
-	if((f=fopen(filename,"rb")) == NULL ) {
+	OPJReader reader;	// the whole file, read only once
+	if(!reader.open(filename)) {
 		printf("Could not open %s!\n",filename);
 		return -1;
 	}
@@ -146,40 +180,33 @@ int OPJFile::Parse() {
 	vers[4]=0;
 
 	// get version
-	fseek(f,0x7,SEEK_SET);
-	fread(&vers,4,1,f);
-	fclose(f);
+	reader.seek(0x7,SEEK_SET);
+	reader.read(&vers,4,1);
 	version = atoi(vers);
 
+	reader.seek(0,SEEK_SET);
 	if(version >= 2766 && version <= 2769) 	// 7.5
-		return ParseFormatNew();
+		return ParseFormatNew(&reader);
 	else
-		return ParseFormatOld();
+		return ParseFormatOld(&reader);
 }
 
 
-int OPJFile::ParseFormatOld() {
+int OPJFile::ParseFormatOld(OPJReader *f) {
 	int i;
-	FILE *f, *debug;
-	if((f=fopen(filename,"rb")) == NULL ) {
-		printf("Could not open %s!\n",filename);
-		return -1;
-	}
-
-	if((debug=fopen("opjfile.log","w")) == NULL ) {
+	FILE *debug = 0;
+	if(logfile && (debug=fopen(logfile,"w")) == NULL )
 		printf("Could not open log file!\n");
-		return -1;
-	}
 
 	////////////////////////////// check version from header ///////////////////////////////
 	char vers[5];
 	vers[4]=0;
 
 	// get version
-	fseek(f,0x7,SEEK_SET);
-	fread(&vers,4,1,f);
+	f->seek(0x7,SEEK_SET);
+	f->read(&vers,4,1);
 	version = atoi(vers);
-	fprintf(debug,"	[version = %d]\n",version);
+	LogPrint(debug,"	[version = %d]\n",version);
 
 	// translate version
 	if(version >= 130 && version <= 140) 		// 4.1
@@ -201,72 +228,72 @@ int OPJFile::ParseFormatOld() {
 	else if(version >= 2766 && version <= 2769) 	// 7.5
 		version=750;
 	else {
-		fprintf(debug,"Found unknown project version %d\n",version);
-		fprintf(debug,"Please contact the author of opj2dat\n");
+		LogPrint(debug,"Found unknown project version %d\n",version);
+		LogPrint(debug,"Please contact the author of opj2dat\n");
 	}
-	fprintf(debug,"Found project version %.2f\n",version/100.0);
+	LogPrint(debug,"Found project version %.2f\n",version/100.0);
 
 	unsigned char c=0;	// tmp char
 
-	fprintf(debug,"HEADER :\n");
+	LogPrint(debug,"HEADER :\n");
 	for(i=0;i<0x16;i++) {	// skip header + 5 Bytes ("27")
-		fread(&c,1,1,f);
-		fprintf(debug,"%.2X ",c);
-		if(!((i+1)%16)) fprintf(debug,"\n");
+		f->read(&c,1,1);
+		LogPrint(debug,"%.2X ",c);
+		if(!((i+1)%16)) LogPrint(debug,"\n");
 	}
-	fprintf(debug,"\n");
+	LogPrint(debug,"\n");
 
 	do{
-		fread(&c,1,1,f);
+		f->read(&c,1,1);
 	} while (c != '\n');
-	fprintf(debug,"	[file header @ 0x%X]\n", (unsigned int) ftell(f));
+	LogPrint(debug,"	[file header @ 0x%X]\n", (unsigned int) f->tell());
 
 	/////////////////// find column ///////////////////////////////////////////////////////////
 	if(version>410)
 		for(i=0;i<5;i++)	// skip "0"
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
 
 	int col_found;
-	fread(&col_found,4,1,f);
+	f->read(&col_found,4,1);
 	if(IsBigEndian()) SwapBytes(col_found);
 
-	fread(&c,1,1,f);	// skip '\n'
-	fprintf(debug,"	[column found = %d/0x%X @ 0x%X]\n",col_found,col_found,(unsigned int) ftell(f));
+	f->read(&c,1,1);	// skip '\n'
+	LogPrint(debug,"	[column found = %d/0x%X @ 0x%X]\n",col_found,col_found,(unsigned int) f->tell());
 
 	int current_col=1, nr=0, nbytes=0;
 	double a;
 	char name[25], valuesize;
 	while(col_found > 0 && col_found < 0x84) {	// should be 0x72, 0x73 or 0x83
 		//////////////////////////////// COLUMN HEADER /////////////////////////////////////////////
-		fprintf(debug,"COLUMN HEADER :\n");
+		LogPrint(debug,"COLUMN HEADER :\n");
 		for(i=0;i < 0x3D;i++) {	// skip 0x3C chars to value size
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
 			//if(i>21 && i<27) {
-			fprintf(debug,"%.2X ",c);
-			if(!((i+1)%16)) fprintf(debug,"\n");
+			LogPrint(debug,"%.2X ",c);
+			if(!((i+1)%16)) LogPrint(debug,"\n");
 			//}
 		}
-		fprintf(debug,"\n");
+		LogPrint(debug,"\n");
 
-		fread(&valuesize,1,1,f);
-		fprintf(debug,"	[valuesize = %d @ 0x%X]\n",valuesize,(unsigned int) ftell(f)-1);
+		f->read(&valuesize,1,1);
+		LogPrint(debug,"	[valuesize = %d @ 0x%X]\n",valuesize,(unsigned int) f->tell()-1);
 		if(valuesize <= 0) {
-			fprintf(debug,"	WARNING : found strange valuesize of %d\n",valuesize);
+			LogPrint(debug,"	WARNING : found strange valuesize of %d\n",valuesize);
 			valuesize=10;
 		}
 
-		fprintf(debug,"SKIP :\n");
+		LogPrint(debug,"SKIP :\n");
 		for(i=0;i<0x1A;i++) {	// skip to name
-			fread(&c,1,1,f);
-			fprintf(debug,"%.2X ",c);
-			if(!((i+1)%16)) fprintf(debug,"\n");
+			f->read(&c,1,1);
+			LogPrint(debug,"%.2X ",c);
+			if(!((i+1)%16)) LogPrint(debug,"\n");
 		}
-		fprintf(debug,"\n");
+		LogPrint(debug,"\n");
 
 		// read name
-		fprintf(debug,"	[Spreadsheet @ 0x%X]\n",(unsigned int) ftell(f));
-		fflush(debug);
-		fread(&name,25,1,f);
+		LogPrint(debug,"	[Spreadsheet @ 0x%X]\n",(unsigned int) f->tell());
+		LogFlush(debug);
+		f->read(&name,25,1);
 		//char* sname = new char[26];
 		char sname[26];
 		sprintf(sname,"%s",strtok(name,"_"));	// spreadsheet name
@@ -278,7 +305,7 @@ int OPJFile::ParseFormatOld() {
 		}
 		int spread=0;
 		if(SPREADSHEET.size() == 0 || compareSpreadnames(sname) == -1) {
-			fprintf(debug,"NEW SPREADSHEET\n");
+			LogPrint(debug,"NEW SPREADSHEET\n");
 			current_col=1;
 			SPREADSHEET.push_back(spreadSheet(sname));
 			spread=SPREADSHEET.size()-1;
@@ -294,46 +321,46 @@ int OPJFile::ParseFormatOld() {
 				current_col=1;
 			current_col++;
 		}
-		fprintf(debug,"SPREADSHEET = %s COLUMN %d NAME = %s (@0x%X)\n",
-			sname, current_col, cname, (unsigned int) ftell(f));
-		fflush(debug);
+		LogPrint(debug,"SPREADSHEET = %s COLUMN %d NAME = %s (@0x%X)\n",
+			sname, current_col, cname, (unsigned int) f->tell());
+		LogFlush(debug);
 
 		if(cname == 0) {
-			fprintf(debug,"NO COLUMN NAME FOUND! Must be a matrix or function.\n");
+			LogPrint(debug,"NO COLUMN NAME FOUND! Must be a matrix or function.\n");
 			////////////////////////////// READ MATRIX or FUNCTION ////////////////////////////////////
-			fprintf(debug,"Reading MATRIX.\n");
-			fflush(debug);
+			LogPrint(debug,"Reading MATRIX.\n");
+			LogFlush(debug);
 
-			fprintf(debug,"	[position @ 0x%X]\n",(unsigned int) ftell(f));
+			LogPrint(debug,"	[position @ 0x%X]\n",(unsigned int) f->tell());
 			// TODO
-			fprintf(debug,"	SIGNATURE : ");
+			LogPrint(debug,"	SIGNATURE : ");
 			for(i=0;i<2;i++) {	// skip header
-				fread(&c,1,1,f);
-				fprintf(debug,"%.2X ",c);
+				f->read(&c,1,1);
+				LogPrint(debug,"%.2X ",c);
 			}
-			fflush(debug);
+			LogFlush(debug);
 
 			do{	// skip until '\n'
-				fread(&c,1,1,f);
-				// fprintf(debug,"%.2X ",c);
+				f->read(&c,1,1);
+				// LogPrint(debug,"%.2X ",c);
 			} while (c != '\n');
-			fprintf(debug,"\n");
-			fflush(debug);
+			LogPrint(debug,"\n");
+			LogFlush(debug);
 
 			// read size
 			int size;
-			fread(&size,4,1,f);
-			fread(&c,1,1,f);	// skip '\n'
+			f->read(&size,4,1);
+			f->read(&c,1,1);	// skip '\n'
 			// TODO : use entry size : double, float, ...
 			size /= 8;
-			fprintf(debug,"	SIZE = %d\n",size);
-			fflush(debug);
+			LogPrint(debug,"	SIZE = %d\n",size);
+			LogFlush(debug);
 
 			// catch exception
 			if(size>10000)
 				size=1000;
 
-			fprintf(debug,"VALUES :\n");
+			LogPrint(debug,"VALUES :\n");
 			SPREADSHEET[SPREADSHEET.size()-1].maxRows=1;
 
 			double value=0;
@@ -351,13 +378,13 @@ int OPJFile::ParseFormatOld() {
 					stmp[2] = i%26+0x41;
 				}
 				SPREADSHEET[SPREADSHEET.size()-1].column.push_back(stmp);
-				fread(&value,8,1,f);
+				f->read(&value,8,1);
 				SPREADSHEET[SPREADSHEET.size()-1].column[i].odata.push_back(originData(value));
 
-				fprintf(debug,"%g ",value);
+				LogPrint(debug,"%g ",value);
 			}
-			fprintf(debug,"\n");
-			fflush(debug);
+			LogPrint(debug,"\n");
+			LogFlush(debug);
 
 		}
 		else {	// worksheet
@@ -365,76 +392,76 @@ int OPJFile::ParseFormatOld() {
 
 			////////////////////////////// SIZE of column /////////////////////////////////////////////
 			do{	// skip until '\n'
-				fread(&c,1,1,f);
+				f->read(&c,1,1);
 			} while (c != '\n');
 
-			fread(&nbytes,4,1,f);
+			f->read(&nbytes,4,1);
 			if(IsBigEndian()) SwapBytes(nbytes);
 			if(fmod(nbytes,(double)valuesize)>0)
-				fprintf(debug,"WARNING: data section could not be read correct\n");
+				LogPrint(debug,"WARNING: data section could not be read correct\n");
 			nr = nbytes / valuesize;
-			fprintf(debug,"	[number of rows = %d (%d Bytes) @ 0x%X]\n",nr,nbytes,(unsigned int) ftell(f));
-			fflush(debug);
+			LogPrint(debug,"	[number of rows = %d (%d Bytes) @ 0x%X]\n",nr,nbytes,(unsigned int) f->tell());
+			LogFlush(debug);
 
 			SPREADSHEET[spread].maxRows<nr?SPREADSHEET[spread].maxRows=nr:0;
 
 			////////////////////////////////////// DATA ////////////////////////////////////////////////
-			fread(&c,1,1,f);	// skip '\n'
+			f->read(&c,1,1);	// skip '\n'
 			if(valuesize != 8 && valuesize <= 16) {	// skip 0 0
-				fread(&c,1,1,f);
-				fread(&c,1,1,f);
+				f->read(&c,1,1);
+				f->read(&c,1,1);
 			}
-			fprintf(debug,"	[data @ 0x%X]\n",(unsigned int) ftell(f));
-			fflush(debug);
+			LogPrint(debug,"	[data @ 0x%X]\n",(unsigned int) f->tell());
+			LogFlush(debug);
 
 			for (i=0;i<nr;i++) {
 				if(valuesize <= 16) {	// value
-					fread(&a,valuesize,1,f);
+					f->read(&a,valuesize,1);
 					if(IsBigEndian()) SwapBytes(a);
-					fprintf(debug,"%g ",a);
+					LogPrint(debug,"%g ",a);
 					SPREADSHEET[spread].column[(current_col-1)].odata.push_back(originData(a));
 				}
 				else {			// label
 					char *stmp = new char[valuesize+1];
-					fread(stmp,valuesize,1,f);
-					fprintf(debug,"%s ",stmp);
+					f->read(stmp,valuesize,1);
+					LogPrint(debug,"%s ",stmp);
 					SPREADSHEET[spread].column[(current_col-1)].odata.push_back(originData(stmp));
 					delete stmp;
 				}
 			}
 		}	// else
-		//		fprintf(debug,"	[now @ 0x%X]\n",ftell(f));
-		fprintf(debug,"\n");
-		fflush(debug);
+		//		LogPrint(debug,"	[now @ 0x%X]\n",f->tell());
+		LogPrint(debug,"\n");
+		LogFlush(debug);
 
 		for(i=0;i<4;i++)	// skip "0"
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
 		if(valuesize == 8 || valuesize > 16) {	// skip 0 0
-			fread(&c,1,1,f);
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
+			f->read(&c,1,1);
 		}
-		fread(&col_found,4,1,f);
+		f->read(&col_found,4,1);
 		if(IsBigEndian()) SwapBytes(col_found);
-		fread(&c,1,1,f);	// skip '\n'
-		fprintf(debug,"	[column found = %d/0x%X (@ 0x%X)]\n",col_found,col_found,(unsigned int) ftell(f)-5);
-		fflush(debug);
+		f->read(&c,1,1);	// skip '\n'
+		LogPrint(debug,"	[column found = %d/0x%X (@ 0x%X)]\n",col_found,col_found,(unsigned int) f->tell()-5);
+		LogFlush(debug);
 	}
 
 	////////////////////// HEADER SECTION //////////////////////////////////////
 	// TODO : use new method ('\n')
 
-	int POS = ftell(f)-11;
-	fprintf(debug,"\nHEADER SECTION\n");
-	fprintf(debug,"	nr_spreads = %d\n",SPREADSHEET.size());
-	fprintf(debug,"	[position @ 0x%X]\n",POS);
-	fflush(debug);
+	int POS = f->tell()-11;
+	LogPrint(debug,"\nHEADER SECTION\n");
+	LogPrint(debug,"	nr_spreads = %d\n",SPREADSHEET.size());
+	LogPrint(debug,"	[position @ 0x%X]\n",POS);
+	LogFlush(debug);
 
 ///////////////////// SPREADSHEET INFOS ////////////////////////////////////
 	int LAYER=0;
 	int COL_JUMP = 0x1ED;
 	for(unsigned int i=0; i < SPREADSHEET.size(); i++) {
-	fprintf(debug,"		reading	Spreadsheet %d/%d properties\n",i+1,SPREADSHEET.size());
-	fflush(debug);
+	LogPrint(debug,"		reading	Spreadsheet %d/%d properties\n",i+1,SPREADSHEET.size());
+	LogFlush(debug);
 	if(i > 0) {
 		if (version == 700 )
 			POS += 0x2530 + SPREADSHEET[i-1].column.size()*COL_JUMP;
@@ -452,50 +479,50 @@ int OPJFile::ParseFormatOld() {
 			POS += 0x7FB + SPREADSHEET[i-1].column.size()*COL_JUMP;
 	}
 
-	fprintf(debug,"			reading	Header\n");
-	fflush(debug);
+	LogPrint(debug,"			reading	Header\n");
+	LogFlush(debug);
 	// HEADER
 	// check header
 	int ORIGIN = 0x55;
 	if(version == 500)
 		ORIGIN = 0x58;
-	fseek(f,POS + ORIGIN,SEEK_SET);	// check for 'O'RIGIN
+	f->seek(POS + ORIGIN,SEEK_SET);	// check for 'O'RIGIN
 	char c;
-	fread(&c,1,1,f);
+	f->read(&c,1,1);
 	int jump=0;
 	if( c == 'O')
-		fprintf(debug,"			\"ORIGIN\" found ! (@ 0x%X)\n",POS+ORIGIN);
+		LogPrint(debug,"			\"ORIGIN\" found ! (@ 0x%X)\n",POS+ORIGIN);
 	while( c != 'O' && jump < MAX_LEVEL) {	// no inf loop
-		fprintf(debug,"		TRY %d	\"O\"RIGIN not found ! : %c (@ 0x%X)",jump+1,c,POS+ORIGIN);
-		fprintf(debug,"			POS=0x%X | ORIGIN = 0x%X\n",POS,ORIGIN);
-		fflush(debug);
+		LogPrint(debug,"		TRY %d	\"O\"RIGIN not found ! : %c (@ 0x%X)",jump+1,c,POS+ORIGIN);
+		LogPrint(debug,"			POS=0x%X | ORIGIN = 0x%X\n",POS,ORIGIN);
+		LogFlush(debug);
 		POS+=0x1F2;
-		fseek(f,POS + ORIGIN,SEEK_SET);
-		fread(&c,1,1,f);
+		f->seek(POS + ORIGIN,SEEK_SET);
+		f->read(&c,1,1);
 		jump++;
 	}
 
 	int spread=i;
 	if(jump == MAX_LEVEL){
-		fprintf(debug,"		Spreadsheet SECTION not found ! 	(@ 0x%X)\n",POS-10*0x1F2+0x55);
+		LogPrint(debug,"		Spreadsheet SECTION not found ! 	(@ 0x%X)\n",POS-10*0x1F2+0x55);
 		// setColName(spread);
 		return -5;
 	}
 
-	fprintf(debug,"			[Spreadsheet SECTION (@ 0x%X)]\n",POS);
-	fflush(debug);
+	LogPrint(debug,"			[Spreadsheet SECTION (@ 0x%X)]\n",POS);
+	LogFlush(debug);
 
 	// check spreadsheet name
-	fseek(f,POS + 0x12,SEEK_SET);
-	fread(&name,25,1,f);
+	f->seek(POS + 0x12,SEEK_SET);
+	f->read(&name,25,1);
 
 	spread=compareSpreadnames(name);
 	if(spread == -1)
 		spread=i;
 
-	fprintf(debug,"			SPREADSHEET %d NAME : %s	(@ 0x%X) has %d columns\n",
+	LogPrint(debug,"			SPREADSHEET %d NAME : %s	(@ 0x%X) has %d columns\n",
 		spread+1,name,POS + 0x12,SPREADSHEET[spread].column.size());
-	fflush(debug);
+	LogFlush(debug);
 
 	int ATYPE=0;
 	LAYER = POS;
@@ -517,18 +544,18 @@ int OPJFile::ParseFormatOld() {
 		COL_JUMP = 0x58;
 		ATYPE = 0x229;
 	}
-	fflush(debug);
+	LogFlush(debug);
 
 	/////////////// COLUMN Types ///////////////////////////////////////////
-	fprintf(debug,"			Spreadsheet has %d columns\n",SPREADSHEET[spread].column.size());
+	LogPrint(debug,"			Spreadsheet has %d columns\n",SPREADSHEET[spread].column.size());
 	for (unsigned int j=0;j<SPREADSHEET[spread].column.size();j++) {
-		fprintf(debug,"			reading	COLUMN %d/%d type\n",j+1,SPREADSHEET[spread].column.size());
-		fflush(debug);
-		fseek(f,LAYER+ATYPE+j*COL_JUMP, SEEK_SET);
-		fread(&name,25,1,f);
+		LogPrint(debug,"			reading	COLUMN %d/%d type\n",j+1,SPREADSHEET[spread].column.size());
+		LogFlush(debug);
+		f->seek(LAYER+ATYPE+j*COL_JUMP, SEEK_SET);
+		f->read(&name,25,1);
 
-		fseek(f,LAYER+ATYPE+j*COL_JUMP-1, SEEK_SET);
-		fread(&c,1,1,f);
+		f->seek(LAYER+ATYPE+j*COL_JUMP-1, SEEK_SET);
+		f->read(&c,1,1);
 		char type[5];
 		switch(c) {
 		case 3: sprintf(type,"X");break;
@@ -542,9 +569,9 @@ int OPJFile::ParseFormatOld() {
 
 		SPREADSHEET[spread].column[j].type=type;
 
-		fprintf(debug,"				COLUMN \"%s\" type = %s (@ 0x%X)\n",
+		LogPrint(debug,"				COLUMN \"%s\" type = %s (@ 0x%X)\n",
 			SPREADSHEET[spread].column[j].name.c_str(),type,LAYER+ATYPE+j*COL_JUMP);
-		fflush(debug);
+		LogFlush(debug);
 
 		// check column name
 		int max_length=11;	// only first 11 chars are saved here !
@@ -552,53 +579,47 @@ int OPJFile::ParseFormatOld() {
                     int length = (name_length < max_length) ? name_length : max_length;
 
 		if(SPREADSHEET[spread].column[j].name.substr(0,length) == name) {
-			fprintf(debug,"				TEST : column name = \"%s\". OK!\n",
+			LogPrint(debug,"				TEST : column name = \"%s\". OK!\n",
 				SPREADSHEET[spread].column[j].name.c_str());
 		}
 		else {
-			fprintf(debug,"				TEST : COLUMN %d name mismatch (\"%s\" != \"%s\")\n",
+			LogPrint(debug,"				TEST : COLUMN %d name mismatch (\"%s\" != \"%s\")\n",
 				j+1,name,SPREADSHEET[spread].column[j].name.c_str());
-			//fprintf(debug,"ERROR : column name mismatch! Continue anyway.\n"ERROR_MSG);
+			//LogPrint(debug,"ERROR : column name mismatch! Continue anyway.\n"ERROR_MSG);
 		}
-		fflush(debug);
+		LogFlush(debug);
 	}
-		fprintf(debug,"		Done with spreadsheet %d\n",spread);
-		fflush(debug);
+		LogPrint(debug,"		Done with spreadsheet %d\n",spread);
+		LogFlush(debug);
 	}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	// TODO : GRAPHS
 
-	fprintf(debug,"Done parsing\n");
-	fclose(debug);
+	LogPrint(debug,"Done parsing\n");
+	if(debug)
+		fclose(debug);
 
 	return 0;
 }
 
 
-int OPJFile::ParseFormatNew() {
+int OPJFile::ParseFormatNew(OPJReader *f) {
 	int i;
-	FILE *f, *debug;
-	if((f=fopen(filename,"rb")) == NULL ) {
-		printf("Could not open %s!\n",filename);
-		return -1;
-	}
-
-	if((debug=fopen("opjfile.log","w")) == NULL ) {
+	FILE *debug = 0;
+	if(logfile && (debug=fopen(logfile,"w")) == NULL )
 		printf("Could not open log file!\n");
-		return -1;
-	}
 
 ////////////////////////////// check version from header ///////////////////////////////
 	char vers[5];
 	vers[4]=0;
 
 	// get version
-	fseek(f,0x7,SEEK_SET);
-	fread(&vers,4,1,f);
+	f->seek(0x7,SEEK_SET);
+	f->read(&vers,4,1);
 	version = atoi(vers);
-	fprintf(debug,"	[version = %d]\n",version);
+	LogPrint(debug,"	[version = %d]\n",version);
 
 	// translate version
 	if(version >= 130 && version <= 140) 		// 4.1
@@ -620,38 +641,38 @@ int OPJFile::ParseFormatNew() {
 	else if(version >= 2766 && version <= 2769) 	// 7.5
 		version=750;
 	else {
-		fprintf(debug,"Found unknown project version %d\n",version);
-		fprintf(debug,"Please contact the author of opj2dat\n");
+		LogPrint(debug,"Found unknown project version %d\n",version);
+		LogPrint(debug,"Please contact the author of opj2dat\n");
 	}
-	fprintf(debug,"Found project version %.2f\n",version/100.0);
+	LogPrint(debug,"Found project version %.2f\n",version/100.0);
 
 	unsigned char c=0;	// tmp char
 
-	fprintf(debug,"HEADER :\n");
+	LogPrint(debug,"HEADER :\n");
 	for(i=0;i<0x16;i++) {	// skip header + 5 Bytes ("27")
-		fread(&c,1,1,f);
-		fprintf(debug,"%.2X ",c);
-		if(!((i+1)%16)) fprintf(debug,"\n");
+		f->read(&c,1,1);
+		LogPrint(debug,"%.2X ",c);
+		if(!((i+1)%16)) LogPrint(debug,"\n");
 	}
-	fprintf(debug,"\n");
+	LogPrint(debug,"\n");
 
 	do{
-		fread(&c,1,1,f);
+		f->read(&c,1,1);
 	} while (c != '\n');
-	fprintf(debug,"	[file header @ 0x%X]\n", (unsigned int) ftell(f));
+	LogPrint(debug,"	[file header @ 0x%X]\n", (unsigned int) f->tell());
 
 /////////////////// find column ///////////////////////////////////////////////////////////
 	if(version>410)
 		for(i=0;i<5;i++)	// skip "0"
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
 
 	int col_found;
-	fread(&col_found,4,1,f);
+	f->read(&col_found,4,1);
 	if(IsBigEndian()) SwapBytes(col_found);
 
-	fread(&c,1,1,f);	// skip '\n'
-	fprintf(debug,"	[column found = %d/0x%X @ 0x%X]\n",col_found,col_found,(unsigned int) ftell(f));
-	int colpos=ftell(f);
+	f->read(&c,1,1);	// skip '\n'
+	LogPrint(debug,"	[column found = %d/0x%X @ 0x%X]\n",col_found,col_found,(unsigned int) f->tell());
+	int colpos=f->tell();
 
 	int current_col=1, nr=0, nbytes=0;
 	double a;
@@ -660,43 +681,43 @@ int OPJFile::ParseFormatNew() {
 //////////////////////////////// COLUMN HEADER /////////////////////////////////////////////
 		short data_type;
 		char data_type_u;
-		int oldpos=ftell(f);
-		fseek(f,oldpos+0x16,SEEK_SET);
-		fread(&data_type,2,1,f);
+		int oldpos=f->tell();
+		f->seek(oldpos+0x16,SEEK_SET);
+		f->read(&data_type,2,1);
 		if(IsBigEndian()) SwapBytes(data_type);
-		fseek(f,oldpos+0x3F,SEEK_SET);
-		fread(&data_type_u,1,1,f);
-		fseek(f,oldpos,SEEK_SET);
+		f->seek(oldpos+0x3F,SEEK_SET);
+		f->read(&data_type_u,1,1);
+		f->seek(oldpos,SEEK_SET);
 
-		fprintf(debug,"COLUMN HEADER :\n");
+		LogPrint(debug,"COLUMN HEADER :\n");
 		for(i=0;i < 0x3D;i++) {	// skip 0x3C chars to value size
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
 			//if(i>21 && i<27) {
-				fprintf(debug,"%.2X ",c);
-				if(!((i+1)%16)) fprintf(debug,"\n");
+				LogPrint(debug,"%.2X ",c);
+				if(!((i+1)%16)) LogPrint(debug,"\n");
 			//}
 		}
-		fprintf(debug,"\n");
+		LogPrint(debug,"\n");
 
-		fread(&valuesize,1,1,f);
-		fprintf(debug,"	[valuesize = %d @ 0x%X]\n",valuesize,(unsigned int) ftell(f)-1);
+		f->read(&valuesize,1,1);
+		LogPrint(debug,"	[valuesize = %d @ 0x%X]\n",valuesize,(unsigned int) f->tell()-1);
 		if(valuesize <= 0) {
-			fprintf(debug,"	WARNING : found strange valuesize of %d\n",valuesize);
+			LogPrint(debug,"	WARNING : found strange valuesize of %d\n",valuesize);
 			valuesize=10;
 		}
 
-		fprintf(debug,"SKIP :\n");
+		LogPrint(debug,"SKIP :\n");
 		for(i=0;i<0x1A;i++) {	// skip to name
-			fread(&c,1,1,f);
-			fprintf(debug,"%.2X ",c);
-			if(!((i+1)%16)) fprintf(debug,"\n");
+			f->read(&c,1,1);
+			LogPrint(debug,"%.2X ",c);
+			if(!((i+1)%16)) LogPrint(debug,"\n");
 		}
-		fprintf(debug,"\n");
+		LogPrint(debug,"\n");
 
 		// read name
-		fprintf(debug,"	[Spreadsheet @ 0x%X]\n",(unsigned int) ftell(f));
-		fflush(debug);
-		fread(&name,25,1,f);
+		LogPrint(debug,"	[Spreadsheet @ 0x%X]\n",(unsigned int) f->tell());
+		LogFlush(debug);
+		f->read(&name,25,1);
 		//char* sname = new char[26];
 		char sname[26];
 		sprintf(sname,"%s",strtok(name,"_"));	// spreadsheet name
@@ -708,34 +729,34 @@ int OPJFile::ParseFormatNew() {
 		}
 		int spread=0;
 		if(cname == 0) {
-			fprintf(debug,"NO COLUMN NAME FOUND! Must be a matrix or function.\n");
+			LogPrint(debug,"NO COLUMN NAME FOUND! Must be a matrix or function.\n");
 ////////////////////////////// READ MATRIX or FUNCTION ////////////////////////////////////
 
-			fprintf(debug,"	[position @ 0x%X]\n",(unsigned int) ftell(f));
+			LogPrint(debug,"	[position @ 0x%X]\n",(unsigned int) f->tell());
 			// TODO
 			short signature;
-			fread(&signature,2,1,f);
+			f->read(&signature,2,1);
 			if(IsBigEndian()) SwapBytes(signature);
-			fprintf(debug,"	SIGNATURE : ");
-			fprintf(debug,"%.2X ",signature);
-			fflush(debug);
+			LogPrint(debug,"	SIGNATURE : ");
+			LogPrint(debug,"%.2X ",signature);
+			LogFlush(debug);
 
 			do{	// skip until '\n'
-				fread(&c,1,1,f);
-				// fprintf(debug,"%.2X ",c);
+				f->read(&c,1,1);
+				// LogPrint(debug,"%.2X ",c);
 			} while (c != '\n');
-			fprintf(debug,"\n");
-			fflush(debug);
+			LogPrint(debug,"\n");
+			LogFlush(debug);
 
 			// read size
 			int size;
-			fread(&size,4,1,f);
+			f->read(&size,4,1);
 			if(IsBigEndian()) SwapBytes(size);
-			fread(&c,1,1,f);	// skip '\n'
+			f->read(&c,1,1);	// skip '\n'
 			// TODO : use entry size : double, float, ...
 			size /= valuesize;
-			fprintf(debug,"	SIZE = %d\n",size);
-			fflush(debug);
+			LogPrint(debug,"	SIZE = %d\n",size);
+			LogFlush(debug);
 
 			// catch exception
 			/*if(size>10000)
@@ -746,142 +767,142 @@ int OPJFile::ParseFormatNew() {
 			case 0x70CA:
 			case 0x50F2:
 			case 0x50E2:
-				fprintf(debug,"NEW MATRIX\n");
+				LogPrint(debug,"NEW MATRIX\n");
 				MATRIX.push_back(matrix(sname, dataIndex));
 				dataIndex++;
 
-				fprintf(debug,"VALUES :\n");
+				LogPrint(debug,"VALUES :\n");
 
 				switch(data_type)
 				{
 				case 0x6001://double
 					for(i=0;i<size;i++) {
 						double value;
-						fread(&value,valuesize,1,f);
+						f->read(&value,valuesize,1);
 						if(IsBigEndian()) SwapBytes(value);
 						MATRIX.back().data.push_back((double)value);
-						fprintf(debug,"%g ",MATRIX.back().data.back());
+						LogPrint(debug,"%g ",MATRIX.back().data.back());
 					}
 					break;
 				case 0x6003://float
 					for(i=0;i<size;i++) {
 						float value;
-						fread(&value,valuesize,1,f);
+						f->read(&value,valuesize,1);
 						if(IsBigEndian()) SwapBytes(value);
 						MATRIX.back().data.push_back((double)value);
-						fprintf(debug,"%g ",MATRIX.back().data.back());
+						LogPrint(debug,"%g ",MATRIX.back().data.back());
 					}
 					break;
 				case 0x6801://int
 					if(data_type_u==8)//unsigned
 						for(i=0;i<size;i++) {
 							unsigned int value;
-							fread(&value,valuesize,1,f);
+							f->read(&value,valuesize,1);
 							if(IsBigEndian()) SwapBytes(value);
 							MATRIX.back().data.push_back((double)value);
-							fprintf(debug,"%g ",MATRIX.back().data.back());
+							LogPrint(debug,"%g ",MATRIX.back().data.back());
 						}
 					else
 						for(i=0;i<size;i++) {
 							int value;
-							fread(&value,valuesize,1,f);
+							f->read(&value,valuesize,1);
 							if(IsBigEndian()) SwapBytes(value);
 							MATRIX.back().data.push_back((double)value);
-							fprintf(debug,"%g ",MATRIX.back().data.back());
+							LogPrint(debug,"%g ",MATRIX.back().data.back());
 						}
 					break;
 				case 0x6803://short
 					if(data_type_u==8)//unsigned
 						for(i=0;i<size;i++) {
 							unsigned short value;
-							fread(&value,valuesize,1,f);
+							f->read(&value,valuesize,1);
 							if(IsBigEndian()) SwapBytes(value);
 							MATRIX.back().data.push_back((double)value);
-							fprintf(debug,"%g ",MATRIX.back().data.back());
+							LogPrint(debug,"%g ",MATRIX.back().data.back());
 						}
 					else
 						for(i=0;i<size;i++) {
 							short value;
-							fread(&value,valuesize,1,f);
+							f->read(&value,valuesize,1);
 							if(IsBigEndian()) SwapBytes(value);
 							MATRIX.back().data.push_back((double)value);
-							fprintf(debug,"%g ",MATRIX.back().data.back());
+							LogPrint(debug,"%g ",MATRIX.back().data.back());
 						}
 					break;
 				case 0x6821://char
 					if(data_type_u==8)//unsigned
 						for(i=0;i<size;i++) {
 							unsigned char value;
-							fread(&value,valuesize,1,f);
+							f->read(&value,valuesize,1);
 							if(IsBigEndian()) SwapBytes(value);
 							MATRIX.back().data.push_back((double)value);
-							fprintf(debug,"%g ",MATRIX.back().data.back());
+							LogPrint(debug,"%g ",MATRIX.back().data.back());
 						}
 					else
 						for(i=0;i<size;i++) {
 							char value;
-							fread(&value,valuesize,1,f);
+							f->read(&value,valuesize,1);
 							if(IsBigEndian()) SwapBytes(value);
 							MATRIX.back().data.push_back((double)value);
-							fprintf(debug,"%g ",MATRIX.back().data.back());
+							LogPrint(debug,"%g ",MATRIX.back().data.back());
 						}
 					break;
 				default:
-					fprintf(debug,"UNKNOWN MATRIX DATATYPE: %.2X SKIP DATA\n", data_type);
-					fseek(f, valuesize*size, SEEK_CUR);
+					LogPrint(debug,"UNKNOWN MATRIX DATATYPE: %.2X SKIP DATA\n", data_type);
+					f->seek( valuesize*size, SEEK_CUR);
 					MATRIX.pop_back();
 				}
 
 				break;
 			case 0x10C8:
-				fprintf(debug,"NEW FUNCTION\n");
+				LogPrint(debug,"NEW FUNCTION\n");
 				FUNCTION.push_back(function(sname, dataIndex));
 				dataIndex++;
 
 				char *cmd;
 				cmd=new char[valuesize+1];
 				cmd[valuesize]='\0';
-				fread(cmd,valuesize,1,f);
+				f->read(cmd,valuesize,1);
 				FUNCTION.back().formula=cmd;
 				int oldpos;
-				oldpos=ftell(f);
+				oldpos=f->tell();
 				short t;
-				fseek(f,colpos+0xA,SEEK_SET);
-				fread(&t,2,1,f);
+				f->seek(colpos+0xA,SEEK_SET);
+				f->read(&t,2,1);
 				if(IsBigEndian()) SwapBytes(t);
 				if(t==0x1194)
 					FUNCTION.back().type=1;
 				int N;
-				fseek(f,colpos+0x21,SEEK_SET);
-				fread(&N,4,1,f);
+				f->seek(colpos+0x21,SEEK_SET);
+				f->read(&N,4,1);
 				if(IsBigEndian()) SwapBytes(N);
 				FUNCTION.back().points=N;
 				double d;
-				fread(&d,8,1,f);
+				f->read(&d,8,1);
 				if(IsBigEndian()) SwapBytes(d);
 				FUNCTION.back().begin=d;
-				fread(&d,8,1,f);
+				f->read(&d,8,1);
 				if(IsBigEndian()) SwapBytes(d);
 				FUNCTION.back().end=FUNCTION.back().begin+d*(FUNCTION.back().points-1);
-				fprintf(debug,"FUNCTION %s : %s \n", FUNCTION.back().name.c_str(), FUNCTION.back().formula.c_str());
-				fprintf(debug," interval %g : %g, number of points %d \n", FUNCTION.back().begin, FUNCTION.back().end, FUNCTION.back().points);
-				fseek(f,oldpos,SEEK_SET);
+				LogPrint(debug,"FUNCTION %s : %s \n", FUNCTION.back().name.c_str(), FUNCTION.back().formula.c_str());
+				LogPrint(debug," interval %g : %g, number of points %d \n", FUNCTION.back().begin, FUNCTION.back().end, FUNCTION.back().points);
+				f->seek(oldpos,SEEK_SET);
 
 				delete [] cmd;
 				break;
 			default:
-				fprintf(debug,"UNKNOWN SIGNATURE: %.2X SKIP DATA\n", signature);
-				fseek(f, valuesize*size, SEEK_CUR);
+				LogPrint(debug,"UNKNOWN SIGNATURE: %.2X SKIP DATA\n", signature);
+				f->seek( valuesize*size, SEEK_CUR);
 				if(valuesize != 8 && valuesize <= 16)
-					fseek(f, 2, SEEK_CUR);
+					f->seek( 2, SEEK_CUR);
 			}
 
-			fprintf(debug,"\n");
-			fflush(debug);
+			LogPrint(debug,"\n");
+			LogFlush(debug);
 		}
 		else {	// worksheet
 			if(SPREADSHEET.size() == 0 || compareSpreadnames(sname) == -1) {
-				fprintf(debug,"NEW SPREADSHEET\n");
+				LogPrint(debug,"NEW SPREADSHEET\n");
 				current_col=1;
 				SPREADSHEET.push_back(spreadSheet(sname));
 				spread=SPREADSHEET.size()-1;
@@ -897,131 +918,131 @@ int OPJFile::ParseFormatNew() {
 					current_col=1;
 				current_col++;
 			}
-			fprintf(debug,"SPREADSHEET = %s COLUMN NAME = %s (%d) (@0x%X)\n",
-				sname, cname,current_col,(unsigned int) ftell(f));
-			fflush(debug);
+			LogPrint(debug,"SPREADSHEET = %s COLUMN NAME = %s (%d) (@0x%X)\n",
+				sname, cname,current_col,(unsigned int) f->tell());
+			LogFlush(debug);
 			SPREADSHEET[spread].column.push_back(spreadColumn(cname, dataIndex));
 			dataIndex++;
 
 ////////////////////////////// SIZE of column /////////////////////////////////////////////
 			do{	// skip until '\n'
-				fread(&c,1,1,f);
+				f->read(&c,1,1);
 			} while (c != '\n');
 
-			fread(&nbytes,4,1,f);
+			f->read(&nbytes,4,1);
 			if(IsBigEndian()) SwapBytes(nbytes);
 			if(fmod(nbytes,(double)valuesize)>0)
-				fprintf(debug,"WARNING: data section could not be read correct\n");
+				LogPrint(debug,"WARNING: data section could not be read correct\n");
 			nr = nbytes / valuesize;
-			fprintf(debug,"	[number of rows = %d (%d Bytes) @ 0x%X]\n",nr,nbytes,(unsigned int) ftell(f));
-			fflush(debug);
+			LogPrint(debug,"	[number of rows = %d (%d Bytes) @ 0x%X]\n",nr,nbytes,(unsigned int) f->tell());
+			LogFlush(debug);
 
 			SPREADSHEET[spread].maxRows<nr?SPREADSHEET[spread].maxRows=nr:0;
 
 ////////////////////////////////////// DATA ////////////////////////////////////////////////
-			fread(&c,1,1,f);	// skip '\n'
+			f->read(&c,1,1);	// skip '\n'
 			/*if(valuesize != 8 && valuesize <= 16 && nbytes>0) {	// skip 0 0
-				fread(&c,1,1,f);
-				fread(&c,1,1,f);
+				f->read(&c,1,1);
+				f->read(&c,1,1);
 			}*/
-			fprintf(debug,"	[data @ 0x%X]\n",(unsigned int) ftell(f));
-			fflush(debug);
+			LogPrint(debug,"	[data @ 0x%X]\n",(unsigned int) f->tell());
+			LogFlush(debug);
 
 			for (i=0;i<nr;i++) {
 				if(valuesize <= 8) {	// Numeric, Time, Date, Month, Day
-					fread(&a,valuesize,1,f);
+					f->read(&a,valuesize,1);
 					if(IsBigEndian()) SwapBytes(a);
-					fprintf(debug,"%g ",a);
+					LogPrint(debug,"%g ",a);
 					SPREADSHEET[spread].column[(current_col-1)].odata.push_back(originData(a));
 				}
 				else if((data_type&0x100)==0x100) // Text&Numeric
 				{
-					fread(&c,1,1,f);
-					fseek(f,1,SEEK_CUR);
+					f->read(&c,1,1);
+					f->seek(1,SEEK_CUR);
 					if(c==0) //value
 					{
-						//fread(&a,valuesize-2,1,f);
-						fread(&a,8,1,f);
+						//f->read(&a,valuesize-2,1);
+						f->read(&a,8,1);
 						if(IsBigEndian()) SwapBytes(a);
-						fprintf(debug,"%g ",a);
+						LogPrint(debug,"%g ",a);
 						SPREADSHEET[spread].column[(current_col-1)].odata.push_back(originData(a));
-						fseek(f,valuesize-10,SEEK_CUR);
+						f->seek(valuesize-10,SEEK_CUR);
 					}
 					else //text
 					{
 						char *stmp = new char[valuesize-1];
-						fread(stmp,valuesize-2,1,f);
+						f->read(stmp,valuesize-2,1);
 						if(strchr(stmp,0x0E)) // try find non-printable symbol - garbage test
 							stmp[0]='\0';
 						SPREADSHEET[spread].column[(current_col-1)].odata.push_back(originData(stmp));
-						fprintf(debug,"%s ",stmp);
+						LogPrint(debug,"%s ",stmp);
 						delete stmp;
 					}
 				}
 				else //Text
 				{
 					char *stmp = new char[valuesize+1];
-					fread(stmp,valuesize,1,f);
+					f->read(stmp,valuesize,1);
 					if(strchr(stmp,0x0E)) // try find non-printable symbol - garbage test
 						stmp[0]='\0';
 					SPREADSHEET[spread].column[(current_col-1)].odata.push_back(originData(stmp));
-					fprintf(debug,"%s ",stmp);
+					LogPrint(debug,"%s ",stmp);
 					delete stmp;
 				}
 			}
 
 		}	// else
 
-		fprintf(debug,"\n");
-		fflush(debug);
+		LogPrint(debug,"\n");
+		LogFlush(debug);
 
 		if(nbytes>0||cname==0)
-			fseek(f,1,SEEK_CUR);
+			f->seek(1,SEEK_CUR);
 
 		int tailsize;
-		fread(&tailsize,4,1,f);
+		f->read(&tailsize,4,1);
 		if(IsBigEndian()) SwapBytes(tailsize);
-		fseek(f,1+tailsize+(tailsize>0?1:0),SEEK_CUR); //skip tail
-		//fseek(f,5+((nbytes>0||cname==0)?1:0),SEEK_CUR);
-		fread(&col_found,4,1,f);
+		f->seek(1+tailsize+(tailsize>0?1:0),SEEK_CUR); //skip tail
+		//f->seek(5+((nbytes>0||cname==0)?1:0),SEEK_CUR);
+		f->read(&col_found,4,1);
 		if(IsBigEndian()) SwapBytes(col_found);
-		fseek(f,1,SEEK_CUR);	// skip '\n'
-		fprintf(debug,"	[column found = %d/0x%X (@ 0x%X)]\n",col_found,col_found,(unsigned int) ftell(f)-5);
-		colpos=ftell(f);
-		fflush(debug);
+		f->seek(1,SEEK_CUR);	// skip '\n'
+		LogPrint(debug,"	[column found = %d/0x%X (@ 0x%X)]\n",col_found,col_found,(unsigned int) f->tell()-5);
+		colpos=f->tell();
+		LogFlush(debug);
 	}
 
 ////////////////////// HEADER SECTION //////////////////////////////////////
 
-	int POS = ftell(f)-11;
-	fprintf(debug,"\nHEADER SECTION\n");
-	fprintf(debug,"	nr_spreads = %d\n",SPREADSHEET.size());
-	fprintf(debug,"	[position @ 0x%X]\n",POS);
-	fflush(debug);
+	int POS = f->tell()-11;
+	LogPrint(debug,"\nHEADER SECTION\n");
+	LogPrint(debug,"	nr_spreads = %d\n",SPREADSHEET.size());
+	LogPrint(debug,"	[position @ 0x%X]\n",POS);
+	LogFlush(debug);
 
 ///////////////////// SPREADSHEET INFOS ////////////////////////////////////
 	POS+=0xB;
-	fseek(f,POS,SEEK_SET);
+	f->seek(POS,SEEK_SET);
 	while(1) {
 
-		fprintf(debug,"			reading	Header\n");
-		fflush(debug);
+		LogPrint(debug,"			reading	Header\n");
+		LogFlush(debug);
 		// HEADER
 		// check header
-		POS=ftell(f);
+		POS=f->tell();
 		int headersize;
-		fread(&headersize,4,1,f);
+		f->read(&headersize,4,1);
 		if(IsBigEndian()) SwapBytes(headersize);
 		if(headersize==0)
 			break;
 		char object_type[10];
 		char object_name[25];
-		fseek(f,POS + 0x7,SEEK_SET);
-		fread(&object_name,25,1,f);
-		fseek(f,POS + 0x4A,SEEK_SET);
-		fread(&object_type,10,1,f);
+		f->seek(POS + 0x7,SEEK_SET);
+		f->read(&object_name,25,1);
+		f->seek(POS + 0x4A,SEEK_SET);
+		f->read(&object_type,10,1);
 
-		fseek(f,POS,SEEK_SET);
+		f->seek(POS,SEEK_SET);
 		/*if(0==strcmp(object_type,"ORIGIN")
 			|| 0==strcmp(object_type,"CREATE")
 			|| 0==strcmp(object_type,"FFT")
@@ -1044,7 +1065,7 @@ int OPJFile::ParseFormatNew() {
 			readGraphInfo(f, debug);
 		else
 		{
-			fprintf(debug,"Object %s has not supported yes type: %s\n", object_name, object_type);
+			LogPrint(debug,"Object %s has not supported yes type: %s\n", object_name, object_type);
 			skipObjectInfo(f, debug);
 		}*/
 		if(compareSpreadnames(object_name)!=-1)
@@ -1057,53 +1078,53 @@ int OPJFile::ParseFormatNew() {
 
 
 
-	fseek(f,1,SEEK_CUR);
-	fprintf(debug,"Some Origin params @ 0x%X:\n", ftell(f));
-	fread(&c,1,1,f);
+	f->seek(1,SEEK_CUR);
+	LogPrint(debug,"Some Origin params @ 0x%X:\n", f->tell());
+	f->read(&c,1,1);
 	while(c!=0)
 	{
-		fprintf(debug,"		");
+		LogPrint(debug,"		");
 		while(c!='\n'){
-			fprintf(debug,"%c",c);
-			fread(&c,1,1,f);
+			LogPrint(debug,"%c",c);
+			f->read(&c,1,1);
 		}
 		double parvalue;
-		fread(&parvalue,8,1,f);
+		f->read(&parvalue,8,1);
 		if(IsBigEndian()) SwapBytes(parvalue);
-		fprintf(debug,": %g\n", parvalue);
-		fseek(f,1,SEEK_CUR);
-		fread(&c,1,1,f);
+		LogPrint(debug,": %g\n", parvalue);
+		f->seek(1,SEEK_CUR);
+		f->read(&c,1,1);
 	}
-	fseek(f,1+5,SEEK_CUR);
+	f->seek(1+5,SEEK_CUR);
 	while(1)
 	{
-		//fseek(f,5+0x40+1,SEEK_CUR);
+		//f->seek(5+0x40+1,SEEK_CUR);
 		int size;
-		fread(&size,4,1,f);
+		f->read(&size,4,1);
 		if(IsBigEndian()) SwapBytes(size);
 		if(size!=0x40)
 			break;
-		fseek(f,1+0x40-4,SEEK_CUR);
+		f->seek(1+0x40-4,SEEK_CUR);
 		unsigned char labellen;
-		fread(&labellen,1,1,f);
+		f->read(&labellen,1,1);
 
-		fseek(f,4,SEEK_CUR);
-		fread(&size,4,1,f);
+		f->seek(4,SEEK_CUR);
+		f->read(&size,4,1);
 		if(IsBigEndian()) SwapBytes(size);
-		fseek(f,1,SEEK_CUR);
+		f->seek(1,SEEK_CUR);
 		char *stmp = new char[size+1];
-		fread(stmp,size,1,f);
+		f->read(stmp,size,1);
 		if(0==strcmp(stmp,"ResultsLog"))
 		{
 			delete stmp;
-			fseek(f,1,SEEK_CUR);
-			fread(&size,4,1,f);
+			f->seek(1,SEEK_CUR);
+			f->read(&size,4,1);
 			if(IsBigEndian()) SwapBytes(size);
-			fseek(f,1,SEEK_CUR);
+			f->seek(1,SEEK_CUR);
 			stmp = new char[size+1];
-			fread(stmp,size,1,f);
+			f->read(stmp,size,1);
 			resultsLog=stmp;
-			fprintf(debug,"Results Log: %s\n", resultsLog.c_str());
+			LogPrint(debug,"Results Log: %s\n", resultsLog.c_str());
 			delete stmp;
 			break;
 		}
@@ -1111,94 +1132,95 @@ int OPJFile::ParseFormatNew() {
 		{
 			NOTE.push_back(note(stmp));
 			delete stmp;
-			fseek(f,1,SEEK_CUR);
-			fread(&size,4,1,f);
+			f->seek(1,SEEK_CUR);
+			f->read(&size,4,1);
 			if(IsBigEndian()) SwapBytes(size);
-			fseek(f,1,SEEK_CUR);
+			f->seek(1,SEEK_CUR);
 			if(labellen>1)
 			{
 				stmp = new char[labellen];
 				stmp[labellen-1]='\0';
-				fread(stmp,labellen-1,1,f);
+				f->read(stmp,labellen-1,1);
 				NOTE.back().label=stmp;
 				delete stmp;
-				fseek(f,1,SEEK_CUR);
+				f->seek(1,SEEK_CUR);
 			}
 			stmp = new char[size-labellen+1];
-			fread(stmp,size-labellen,1,f);
+			f->read(stmp,size-labellen,1);
 			NOTE.back().text=stmp;
-			fprintf(debug,"NOTE %d NAME: %s\n", NOTE.size(), NOTE.back().name.c_str());
-			fprintf(debug,"NOTE %d LABEL: %s\n", NOTE.size(), NOTE.back().label.c_str());
-			fprintf(debug,"NOTE %d TEXT:\n%s\n", NOTE.size(), NOTE.back().text.c_str());
+			LogPrint(debug,"NOTE %d NAME: %s\n", NOTE.size(), NOTE.back().name.c_str());
+			LogPrint(debug,"NOTE %d LABEL: %s\n", NOTE.size(), NOTE.back().label.c_str());
+			LogPrint(debug,"NOTE %d TEXT:\n%s\n", NOTE.size(), NOTE.back().text.c_str());
 			delete stmp;
-			fseek(f,1,SEEK_CUR);
+			f->seek(1,SEEK_CUR);
 		}
 	}
 
-	fprintf(debug,"Done parsing\n");
-	fclose(debug);
+	LogPrint(debug,"Done parsing\n");
+	if(debug)
+		fclose(debug);
 
 	return 0;
 }
 
-void OPJFile::readSpreadInfo(FILE *f, FILE *debug)
+void OPJFile::readSpreadInfo(OPJReader *f, FILE *debug)
 {
-	int POS=ftell(f);
+	int POS=f->tell();
 
 	int headersize;
-	fread(&headersize,4,1,f);
+	f->read(&headersize,4,1);
 	if(IsBigEndian()) SwapBytes(headersize);
 
 	POS+=5;
 
-	fprintf(debug,"			[Spreadsheet SECTION (@ 0x%X)]\n",POS);
-	fflush(debug);
+	LogPrint(debug,"			[Spreadsheet SECTION (@ 0x%X)]\n",POS);
+	LogFlush(debug);
 
 	// check spreadsheet name
 	char name[25];
-	fseek(f,POS + 0x2,SEEK_SET);
-	fread(&name,25,1,f);
+	f->seek(POS + 0x2,SEEK_SET);
+	f->read(&name,25,1);
 
 	int spread=compareSpreadnames(name);
 	SPREADSHEET[spread].name=name;
 
-	fprintf(debug,"			SPREADSHEET %d NAME : %s	(@ 0x%X) has %d columns\n",
+	LogPrint(debug,"			SPREADSHEET %d NAME : %s	(@ 0x%X) has %d columns\n",
 		spread+1,name,POS + 0x2,SPREADSHEET[spread].column.size());
-	fflush(debug);
+	LogFlush(debug);
 
 	char c;
-	fseek(f,POS + 0x69,SEEK_SET);
-	fread(&c,1,1,f);
+	f->seek(POS + 0x69,SEEK_SET);
+	f->read(&c,1,1);
 	if( (c&0x08) == 0x08)
 	{
 		SPREADSHEET[spread].bHidden=true;
-		fprintf(debug,"			SPREADSHEET %d NAME : %s	is hidden\n", spread+1,name);
-		fflush(debug);
+		LogPrint(debug,"			SPREADSHEET %d NAME : %s	is hidden\n", spread+1,name);
+		LogFlush(debug);
 	}
 	SPREADSHEET[spread].bLoose=false;
 
 	if(headersize>0xC3)
 	{
 		int labellen=0;
-		fseek(f,POS + 0xC3,SEEK_SET);
-		fread(&c,1,1,f);
+		f->seek(POS + 0xC3,SEEK_SET);
+		f->read(&c,1,1);
 		while (c != '@'){
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
 			labellen++;
 		}
 		if(labellen>0)
 		{
 			char *label=new char[labellen+1];
 			label[labellen]='\0';
-			fseek(f,POS + 0xC3,SEEK_SET);
-			fread(label,labellen,1,f);
+			f->seek(POS + 0xC3,SEEK_SET);
+			f->read(label,labellen,1);
 			SPREADSHEET[spread].label=label;
 			delete label;
 		}
 		else
 			SPREADSHEET[spread].label="";
-		fprintf(debug,"			SPREADSHEET %d LABEL : %s\n",spread+1,SPREADSHEET[spread].label.c_str());
-		fflush(debug);
+		LogPrint(debug,"			SPREADSHEET %d LABEL : %s\n",spread+1,SPREADSHEET[spread].label.c_str());
+		LogFlush(debug);
 	}
 
 	int LAYER = POS;
@@ -1215,38 +1237,38 @@ void OPJFile::readSpreadInfo(FILE *f, FILE *debug)
 			LAYER+=0x5;
 
 		//section_header
-			fseek(f,LAYER+0x46,SEEK_SET);
+			f->seek(LAYER+0x46,SEEK_SET);
 			char sec_name[42];
 			sec_name[41]='\0';
-			fread(&sec_name,41,1,f);
+			f->read(&sec_name,41,1);
 
-			fprintf(debug,"				DEBUG SECTION NAME: %s (@ 0x%X)\n", sec_name, LAYER+0x46);
-			fflush(debug);
+			LogPrint(debug,"				DEBUG SECTION NAME: %s (@ 0x%X)\n", sec_name, LAYER+0x46);
+			LogFlush(debug);
 
 		//section_body_1_size
 			LAYER+=0x6F+0x1;
-			fseek(f,LAYER,SEEK_SET);
-			fread(&sec_size,4,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(&sec_size,4,1);
 			if(IsBigEndian()) SwapBytes(sec_size);
 
 		//section_body_1
 			LAYER+=0x5;
-			fseek(f,LAYER,SEEK_SET);
+			f->seek(LAYER,SEEK_SET);
 			//check if it is a formula
 			int col_index=compareColumnnames(spread,sec_name);
 			if(col_index!=-1)
 			{
 				char *stmp=new char[sec_size+1];
 				stmp[sec_size]='\0';
-				fread(stmp,sec_size,1,f);
+				f->read(stmp,sec_size,1);
 				SPREADSHEET[spread].column[col_index].command=stmp;
 				delete stmp;
 			}
 
 		//section_body_2_size
 			LAYER+=sec_size+0x1;
-			fseek(f,LAYER,SEEK_SET);
-			fread(&sec_size,4,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(&sec_size,4,1);
 			if(IsBigEndian()) SwapBytes(sec_size);
 
 		//section_body_2
@@ -1263,22 +1285,22 @@ void OPJFile::readSpreadInfo(FILE *f, FILE *debug)
 
 	}
 
-	fflush(debug);
+	LogFlush(debug);
 
 	/////////////// COLUMN Types ///////////////////////////////////////////
-	fprintf(debug,"			Spreadsheet has %d columns\n",SPREADSHEET[spread].column.size());
+	LogPrint(debug,"			Spreadsheet has %d columns\n",SPREADSHEET[spread].column.size());
 
 	while(1)
 	{
 		LAYER+=0x5;
-		fseek(f,LAYER+0x12, SEEK_SET);
-		fread(&name,12,1,f);
+		f->seek(LAYER+0x12, SEEK_SET);
+		f->read(&name,12,1);
 
-		fseek(f,LAYER+0x11, SEEK_SET);
-		fread(&c,1,1,f);
+		f->seek(LAYER+0x11, SEEK_SET);
+		f->read(&c,1,1);
 		short width=0;
-		fseek(f,LAYER+0x4A, SEEK_SET);
-		fread(&width,2,1,f);
+		f->seek(LAYER+0x4A, SEEK_SET);
+		f->read(&width,2,1);
 		if(IsBigEndian()) SwapBytes(width);
 		int col_index=compareColumnnames(spread,name);
 		if(col_index!=-1)
@@ -1298,10 +1320,10 @@ void OPJFile::readSpreadInfo(FILE *f, FILE *debug)
 			if(width==0)
 				width=8;
 			SPREADSHEET[spread].column[col_index].width=width;
-			fseek(f,LAYER+0x1E, SEEK_SET);
+			f->seek(LAYER+0x1E, SEEK_SET);
 			unsigned char c1,c2;
-			fread(&c1,1,1,f);
-			fread(&c2,1,1,f);
+			f->read(&c1,1,1);
+			f->read(&c2,1,1);
 			switch(c1)
 			{
 			case 0x00: // Numeric	   - Dec1000
@@ -1350,87 +1372,87 @@ void OPJFile::readSpreadInfo(FILE *f, FILE *debug)
 				SPREADSHEET[spread].column[col_index].value_type=1;
 				break;
 			}
-			fprintf(debug,"				COLUMN \"%s\" type = %s(%d) (@ 0x%X)\n",
+			LogPrint(debug,"				COLUMN \"%s\" type = %s(%d) (@ 0x%X)\n",
 				SPREADSHEET[spread].column[col_index].name.c_str(),type,c,LAYER+0x11);
-			fflush(debug);
+			LogFlush(debug);
 		}
 		LAYER+=0x1E7+0x1;
-		fseek(f,LAYER,SEEK_SET);
+		f->seek(LAYER,SEEK_SET);
 		int comm_size=0;
-		fread(&comm_size,4,1,f);
+		f->read(&comm_size,4,1);
 		if(IsBigEndian()) SwapBytes(comm_size);
 		LAYER+=0x5;
 		if(comm_size>0)
 		{
 			char* comment=new char[comm_size+1];
 			comment[comm_size]='\0';
-			fseek(f,LAYER,SEEK_SET);
-			fread(comment,comm_size,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(comment,comm_size,1);
 			if(col_index!=-1)
 				SPREADSHEET[spread].column[col_index].comment=comment;
 			LAYER+=comm_size+0x1;
 			delete comment;
 		}
-		fseek(f,LAYER,SEEK_SET);
+		f->seek(LAYER,SEEK_SET);
 		int ntmp;
-		fread(&ntmp,4,1,f);
+		f->read(&ntmp,4,1);
 		if(IsBigEndian()) SwapBytes(ntmp);
 		if(ntmp!=0x1E7)
 			break;
 	}
-	fprintf(debug,"		Done with spreadsheet %d\n",spread);
-	fflush(debug);
+	LogPrint(debug,"		Done with spreadsheet %d\n",spread);
+	LogFlush(debug);
 
 	POS = LAYER+0x5*0x6+0x1ED*0x12;
-	fseek(f,POS,SEEK_SET);
+	f->seek(POS,SEEK_SET);
 }
 
-void OPJFile::readMatrixInfo(FILE *f, FILE *debug)
+void OPJFile::readMatrixInfo(OPJReader *f, FILE *debug)
 {
-	int POS=ftell(f);
+	int POS=f->tell();
 
 	int headersize;
-	fread(&headersize,4,1,f);
+	f->read(&headersize,4,1);
 	if(IsBigEndian()) SwapBytes(headersize);
 	POS+=5;
 
-	fprintf(debug,"			[Matrix SECTION (@ 0x%X)]\n",POS);
-	fflush(debug);
+	LogPrint(debug,"			[Matrix SECTION (@ 0x%X)]\n",POS);
+	LogFlush(debug);
 
 	// check spreadsheet name
 	char name[25];
-	fseek(f,POS + 0x2,SEEK_SET);
-	fread(&name,25,1,f);
+	f->seek(POS + 0x2,SEEK_SET);
+	f->read(&name,25,1);
 
 	int idx=compareMatrixnames(name);
 	MATRIX[idx].name=name;
 
-	fprintf(debug,"			MATRIX %d NAME : %s	(@ 0x%X) \n", idx+1,name,POS + 0x2);
-	fflush(debug);
+	LogPrint(debug,"			MATRIX %d NAME : %s	(@ 0x%X) \n", idx+1,name,POS + 0x2);
+	LogFlush(debug);
 
 	if(headersize>0xC3)
 	{
 		int labellen=0;
 		char c=0;
-		fseek(f,POS + 0xC3,SEEK_SET);
-		fread(&c,1,1,f);
+		f->seek(POS + 0xC3,SEEK_SET);
+		f->read(&c,1,1);
 		while (c != '@'){
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
 			labellen++;
 		}
 		if(labellen>0)
 		{
 			char *label=new char[labellen+1];
 			label[labellen]='\0';
-			fseek(f,POS + 0xC3,SEEK_SET);
-			fread(label,labellen,1,f);
+			f->seek(POS + 0xC3,SEEK_SET);
+			f->read(label,labellen,1);
 			MATRIX[idx].label=label;
 			delete label;
 		}
 		else
 			MATRIX[idx].label="";
-		fprintf(debug,"			MATRIX %d LABEL : %s\n",idx+1,MATRIX[idx].label.c_str());
-		fflush(debug);
+		LogPrint(debug,"			MATRIX %d LABEL : %s\n",idx+1,MATRIX[idx].label.c_str());
+		LogFlush(debug);
 	}
 
 	int LAYER = POS;
@@ -1438,13 +1460,13 @@ void OPJFile::readMatrixInfo(FILE *f, FILE *debug)
 	int sec_size;
 	// LAYER section
 	LAYER +=0x5;
-	fseek(f,LAYER+0x2B,SEEK_SET);
+	f->seek(LAYER+0x2B,SEEK_SET);
 	short w=0;
-	fread(&w,2,1,f);
+	f->read(&w,2,1);
 	if(IsBigEndian()) SwapBytes(w);
 	MATRIX[idx].nr_cols=w;
-	fseek(f,LAYER+0x52,SEEK_SET);
-	fread(&w,2,1,f);
+	f->seek(LAYER+0x52,SEEK_SET);
+	f->read(&w,2,1);
 	if(IsBigEndian()) SwapBytes(w);
 	MATRIX[idx].nr_rows=w;
 	LAYER +=0x12D + 0x1;
@@ -1457,15 +1479,15 @@ void OPJFile::readMatrixInfo(FILE *f, FILE *debug)
 		LAYER+=0x5;
 
 	//section_header
-		fseek(f,LAYER+0x46,SEEK_SET);
+		f->seek(LAYER+0x46,SEEK_SET);
 		char sec_name[42];
 		sec_name[41]='\0';
-		fread(&sec_name,41,1,f);
+		f->read(&sec_name,41,1);
 
 	//section_body_1_size
 		LAYER+=0x6F+0x1;
-		fseek(f,LAYER,SEEK_SET);
-		fread(&sec_size,4,1,f);
+		f->seek(LAYER,SEEK_SET);
+		f->read(&sec_size,4,1);
 		if(IsBigEndian()) SwapBytes(sec_size);
 
 	//section_body_1
@@ -1473,18 +1495,18 @@ void OPJFile::readMatrixInfo(FILE *f, FILE *debug)
 		//check if it is a formula
 		if(0==strcmp(sec_name,"MV"))
 		{
-			fseek(f,LAYER,SEEK_SET);
+			f->seek(LAYER,SEEK_SET);
 			char *stmp=new char[sec_size+1];
 			stmp[sec_size]='\0';
-			fread(stmp,sec_size,1,f);
+			f->read(stmp,sec_size,1);
 			MATRIX[idx].command=stmp;
 			delete stmp;
 		}
 
 	//section_body_2_size
 		LAYER+=sec_size+0x1;
-		fseek(f,LAYER,SEEK_SET);
-		fread(&sec_size,4,1,f);
+		f->seek(LAYER,SEEK_SET);
+		f->read(&sec_size,4,1);
 		if(IsBigEndian()) SwapBytes(sec_size);
 
 	//section_body_2
@@ -1504,17 +1526,17 @@ void OPJFile::readMatrixInfo(FILE *f, FILE *debug)
 		LAYER+=0x5;
 
 		short width=0;
-		fseek(f,LAYER+0x2B, SEEK_SET);
-		fread(&width,2,1,f);
+		f->seek(LAYER+0x2B, SEEK_SET);
+		f->read(&width,2,1);
 		if(IsBigEndian()) SwapBytes(width);
 		width=(width-55)/0xA;
 		if(width==0)
 			width=8;
 		MATRIX[idx].width=width;
-		fseek(f,LAYER+0x1E, SEEK_SET);
+		f->seek(LAYER+0x1E, SEEK_SET);
 		unsigned char c1,c2;
-		fread(&c1,1,1,f);
-		fread(&c2,1,1,f);
+		f->read(&c1,1,1);
+		f->read(&c2,1,1);
 
 		MATRIX[idx].value_type_specification=c1/0x10;
 		if(c2>=0x80)
@@ -1529,18 +1551,18 @@ void OPJFile::readMatrixInfo(FILE *f, FILE *debug)
 		}
 
 		LAYER+=0x1E7+0x1;
-		fseek(f,LAYER,SEEK_SET);
+		f->seek(LAYER,SEEK_SET);
 		int comm_size=0;
-		fread(&comm_size,4,1,f);
+		f->read(&comm_size,4,1);
 		if(IsBigEndian()) SwapBytes(comm_size);
 		LAYER+=0x5;
 		if(comm_size>0)
 		{
 			LAYER+=comm_size+0x1;
 		}
-		fseek(f,LAYER,SEEK_SET);
+		f->seek(LAYER,SEEK_SET);
 		int ntmp;
-		fread(&ntmp,4,1,f);
+		f->read(&ntmp,4,1);
 		if(IsBigEndian()) SwapBytes(ntmp);
 		if(ntmp!=0x1E7)
 			break;
@@ -1549,65 +1571,65 @@ void OPJFile::readMatrixInfo(FILE *f, FILE *debug)
 	LAYER+=0x5*0x5+0x1ED*0x12;
 	POS = LAYER+0x5;
 
-	fseek(f,POS,SEEK_SET);
+	f->seek(POS,SEEK_SET);
 }
 
 
-void OPJFile::readGraphInfo(FILE *f, FILE *debug)
+void OPJFile::readGraphInfo(OPJReader *f, FILE *debug)
 {
-	int POS=ftell(f);
+	int POS=f->tell();
 
 	int headersize;
-	fread(&headersize,4,1,f);
+	f->read(&headersize,4,1);
 	if(IsBigEndian()) SwapBytes(headersize);
 	POS+=5;
 
-	fprintf(debug,"			[Graph SECTION (@ 0x%X)]\n",POS);
-	fflush(debug);
+	LogPrint(debug,"			[Graph SECTION (@ 0x%X)]\n",POS);
+	LogFlush(debug);
 
 	// check spreadsheet name
 	char name[25];
-	fseek(f,POS + 0x2,SEEK_SET);
-	fread(&name,25,1,f);
+	f->seek(POS + 0x2,SEEK_SET);
+	f->read(&name,25,1);
 
 	GRAPH.push_back(graph(name));
 
-	fprintf(debug,"			GRAPH %d NAME : %s	(@ 0x%X) \n", GRAPH.size(),name,POS + 0x2);
-	fflush(debug);
+	LogPrint(debug,"			GRAPH %d NAME : %s	(@ 0x%X) \n", GRAPH.size(),name,POS + 0x2);
+	LogFlush(debug);
 
 	char c;
-	fseek(f,POS + 0x69,SEEK_SET);
-	fread(&c,1,1,f);
+	f->seek(POS + 0x69,SEEK_SET);
+	f->read(&c,1,1);
 	if( (c&0x08) == 0x08)
 	{
 		GRAPH.back().bHidden=true;
-		fprintf(debug,"			GRAPH %d NAME : %s	is hidden\n", GRAPH.size(),name);
-		fflush(debug);
+		LogPrint(debug,"			GRAPH %d NAME : %s	is hidden\n", GRAPH.size(),name);
+		LogFlush(debug);
 	}
 
 	if(headersize>0xC3)
 	{
 		int labellen=0;
 		char c=0;
-		fseek(f,POS + 0xC3,SEEK_SET);
-		fread(&c,1,1,f);
+		f->seek(POS + 0xC3,SEEK_SET);
+		f->read(&c,1,1);
 		while (c != '@'){
-			fread(&c,1,1,f);
+			f->read(&c,1,1);
 			labellen++;
 		}
 		if(labellen>0)
 		{
 			char *label=new char[labellen+1];
 			label[labellen]='\0';
-			fseek(f,POS + 0xC3,SEEK_SET);
-			fread(label,labellen,1,f);
+			f->seek(POS + 0xC3,SEEK_SET);
+			f->read(label,labellen,1);
 			GRAPH.back().label=label;
 			delete label;
 		}
 		else
 			GRAPH.back().label="";
-		fprintf(debug,"			GRAPH %d LABEL : %s\n",GRAPH.size(),GRAPH.back().label.c_str());
-		fflush(debug);
+		LogPrint(debug,"			GRAPH %d LABEL : %s\n",GRAPH.size(),GRAPH.back().label.c_str());
+		LogFlush(debug);
 	}
 
 	int LAYER = POS;
@@ -1620,42 +1642,42 @@ void OPJFile::readGraphInfo(FILE *f, FILE *debug)
 		LAYER +=0x5;
 		double range=0.0;
 		unsigned char m=0;
-		fseek(f, LAYER+0xF, SEEK_SET);
-		fread(&range,8,1,f);
+		f->seek( LAYER+0xF, SEEK_SET);
+		f->read(&range,8,1);
 		if(IsBigEndian()) SwapBytes(range);
 		GRAPH.back().layer.back().xAxis.min=range;
-		fread(&range,8,1,f);
+		f->read(&range,8,1);
 		if(IsBigEndian()) SwapBytes(range);
 		GRAPH.back().layer.back().xAxis.max=range;
-		fread(&range,8,1,f);
+		f->read(&range,8,1);
 		if(IsBigEndian()) SwapBytes(range);
 		GRAPH.back().layer.back().xAxis.step=range;
-		fseek(f, LAYER+0x2B, SEEK_SET);
-		fread(&m,1,1,f);
+		f->seek( LAYER+0x2B, SEEK_SET);
+		f->read(&m,1,1);
 		GRAPH.back().layer.back().xAxis.majorTicks=m;
-		fseek(f, LAYER+0x37, SEEK_SET);
-		fread(&m,1,1,f);
+		f->seek( LAYER+0x37, SEEK_SET);
+		f->read(&m,1,1);
 		GRAPH.back().layer.back().xAxis.minorTicks=m;
-		fread(&m,1,1,f);
+		f->read(&m,1,1);
 		GRAPH.back().layer.back().xAxis.scale=m;
 
-		fseek(f, LAYER+0x3A, SEEK_SET);
-		fread(&range,8,1,f);
+		f->seek( LAYER+0x3A, SEEK_SET);
+		f->read(&range,8,1);
 		if(IsBigEndian()) SwapBytes(range);
 		GRAPH.back().layer.back().yAxis.min=range;
-		fread(&range,8,1,f);
+		f->read(&range,8,1);
 		if(IsBigEndian()) SwapBytes(range);
 		GRAPH.back().layer.back().yAxis.max=range;
-		fread(&range,8,1,f);
+		f->read(&range,8,1);
 		if(IsBigEndian()) SwapBytes(range);
 		GRAPH.back().layer.back().yAxis.step=range;
-		fseek(f, LAYER+0x56, SEEK_SET);
-		fread(&m,1,1,f);
+		f->seek( LAYER+0x56, SEEK_SET);
+		f->read(&m,1,1);
 		GRAPH.back().layer.back().yAxis.majorTicks=m;
-		fseek(f, LAYER+0x62, SEEK_SET);
-		fread(&m,1,1,f);
+		f->seek( LAYER+0x62, SEEK_SET);
+		f->read(&m,1,1);
 		GRAPH.back().layer.back().yAxis.minorTicks=m;
-		fread(&m,1,1,f);
+		f->read(&m,1,1);
 		GRAPH.back().layer.back().yAxis.scale=m;
 
 		LAYER += 0x12D + 0x1;
@@ -1668,15 +1690,15 @@ void OPJFile::readGraphInfo(FILE *f, FILE *debug)
 			LAYER+=0x5;
 
 		//section_header
-			fseek(f,LAYER+0x46,SEEK_SET);
+			f->seek(LAYER+0x46,SEEK_SET);
 			char sec_name[42];
 			sec_name[41]='\0';
-			fread(&sec_name,41,1,f);
+			f->read(&sec_name,41,1);
 
 		//section_body_1_size
 			LAYER+=0x6F+0x1;
-			fseek(f,LAYER,SEEK_SET);
-			fread(&sec_size,4,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(&sec_size,4,1);
 			if(IsBigEndian()) SwapBytes(sec_size);
 
 		//section_body_1
@@ -1684,62 +1706,62 @@ void OPJFile::readGraphInfo(FILE *f, FILE *debug)
 
 		//section_body_2_size
 			LAYER+=sec_size+0x1;
-			fseek(f,LAYER,SEEK_SET);
-			fread(&sec_size,4,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(&sec_size,4,1);
 			if(IsBigEndian()) SwapBytes(sec_size);
 
 		//section_body_2
 			LAYER+=0x5;
 			//check if it is a axis or legend
-			fseek(f,1,SEEK_CUR);
+			f->seek(1,SEEK_CUR);
 			char stmp[255];
 			if(0==strcmp(sec_name,"XB"))
 			{
 				stmp[sec_size]='\0';
-				fread(&stmp,sec_size,1,f);
+				f->read(&stmp,sec_size,1);
 				GRAPH.back().layer.back().xAxis.pos=Bottom;
 				GRAPH.back().layer.back().xAxis.label=stmp;
 			}
 			else if(0==strcmp(sec_name,"XT"))
 			{
 				stmp[sec_size]='\0';
-				fread(&stmp,sec_size,1,f);
+				f->read(&stmp,sec_size,1);
 				GRAPH.back().layer.back().xAxis.pos=Top;
 				GRAPH.back().layer.back().xAxis.label=stmp;
 			}
 			else if(0==strcmp(sec_name,"YL"))
 			{
 				stmp[sec_size]='\0';
-				fread(&stmp,sec_size,1,f);
+				f->read(&stmp,sec_size,1);
 				GRAPH.back().layer.back().yAxis.pos=Left;
 				GRAPH.back().layer.back().yAxis.label=stmp;
 			}
 			else if(0==strcmp(sec_name,"YR"))
 			{
 				stmp[sec_size]='\0';
-				fread(&stmp,sec_size,1,f);
+				f->read(&stmp,sec_size,1);
 				GRAPH.back().layer.back().yAxis.pos=Right;
 				GRAPH.back().layer.back().yAxis.label=stmp;
 			}
 			else if(0==strcmp(sec_name,"Legend"))
 			{
 				stmp[sec_size]='\0';
-				fread(&stmp,sec_size,1,f);
+				f->read(&stmp,sec_size,1);
 				GRAPH.back().layer.back().legend=stmp;
 			}
 			else if(0==strcmp(sec_name,"__BCO2"))
 			{
 				double d;
-				fseek(f,LAYER+0x10,SEEK_SET);
-				fread(&d,8,1,f);
+				f->seek(LAYER+0x10,SEEK_SET);
+				f->read(&d,8,1);
 				if(IsBigEndian()) SwapBytes(d);
 				GRAPH.back().layer.back().histogram_bin=d;
-				fseek(f,LAYER+0x20,SEEK_SET);
-				fread(&d,8,1,f);
+				f->seek(LAYER+0x20,SEEK_SET);
+				f->read(&d,8,1);
 				if(IsBigEndian()) SwapBytes(d);
 				GRAPH.back().layer.back().histogram_end=d;
-				fseek(f,LAYER+0x28,SEEK_SET);
-				fread(&d,8,1,f);
+				f->seek(LAYER+0x28,SEEK_SET);
+				f->read(&d,8,1);
 				if(IsBigEndian()) SwapBytes(d);
 				GRAPH.back().layer.back().histogram_begin=d;
 			}
@@ -1748,8 +1770,8 @@ void OPJFile::readGraphInfo(FILE *f, FILE *debug)
 			LAYER+=sec_size+(sec_size>0?0x1:0);
 
 		//section_body_3_size
-			fseek(f,LAYER,SEEK_SET);
-			fread(&sec_size,4,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(&sec_size,4,1);
 			if(IsBigEndian()) SwapBytes(sec_size);
 
 		//section_body_3
@@ -1772,129 +1794,129 @@ void OPJFile::readGraphInfo(FILE *f, FILE *debug)
 			GRAPH.back().layer.back().curve.push_back(graphCurve());
 
 			vector<string> col;
-			fseek(f,LAYER+0x4,SEEK_SET);
-			fread(&w,2,1,f);
+			f->seek(LAYER+0x4,SEEK_SET);
+			f->read(&w,2,1);
 			if(IsBigEndian()) SwapBytes(w);
 			col=findDataByIndex(w-1);
 			if(col.size()>0)
 			{
-				fprintf(debug,"			GRAPH %d layer %d curve %d Y : %s.%s\n",GRAPH.size(),GRAPH.back().layer.size(),GRAPH.back().layer.back().curve.size(),col[1].c_str(),col[0].c_str());
-				fflush(debug);
+				LogPrint(debug,"			GRAPH %d layer %d curve %d Y : %s.%s\n",GRAPH.size(),GRAPH.back().layer.size(),GRAPH.back().layer.back().curve.size(),col[1].c_str(),col[0].c_str());
+				LogFlush(debug);
 				GRAPH.back().layer.back().curve.back().yColName=col[0];
 				GRAPH.back().layer.back().curve.back().dataName=col[1];
 			}
 
-			fseek(f,LAYER+0x23,SEEK_SET);
-			fread(&w,2,1,f);
+			f->seek(LAYER+0x23,SEEK_SET);
+			f->read(&w,2,1);
 			if(IsBigEndian()) SwapBytes(w);
 			col=findDataByIndex(w-1);
 			if(col.size()>0)
 			{
-				fprintf(debug,"			GRAPH %d layer %d curve %d X : %s.%s\n",GRAPH.size(),GRAPH.back().layer.size(),GRAPH.back().layer.back().curve.size(),col[1].c_str(),col[0].c_str());
-				fflush(debug);
+				LogPrint(debug,"			GRAPH %d layer %d curve %d X : %s.%s\n",GRAPH.size(),GRAPH.back().layer.size(),GRAPH.back().layer.back().curve.size(),col[1].c_str(),col[0].c_str());
+				LogFlush(debug);
 				GRAPH.back().layer.back().curve.back().xColName=col[0];
 				if(GRAPH.back().layer.back().curve.back().dataName!=col[1])
-					fprintf(debug,"			GRAPH %d X and Y from different tables\n",GRAPH.size());
+					LogPrint(debug,"			GRAPH %d X and Y from different tables\n",GRAPH.size());
 			}
 
-			fseek(f,LAYER+0x4C,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x4C,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().type=h;
 
-			fseek(f,LAYER+0x11,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x11,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().line_connect=h;
 
-			fseek(f,LAYER+0x12,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x12,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().line_style=h;
 
-			fseek(f,LAYER+0x15,SEEK_SET);
-			fread(&w,2,1,f);
+			f->seek(LAYER+0x15,SEEK_SET);
+			f->read(&w,2,1);
 			if(IsBigEndian()) SwapBytes(w);
 			GRAPH.back().layer.back().curve.back().line_width=(double)w/500.0;
 
-			fseek(f,LAYER+0x19,SEEK_SET);
-			fread(&w,2,1,f);
+			f->seek(LAYER+0x19,SEEK_SET);
+			f->read(&w,2,1);
 			if(IsBigEndian()) SwapBytes(w);
 			GRAPH.back().layer.back().curve.back().symbol_size=(double)w/500.0;
 
-			fseek(f,LAYER+0x1C,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x1C,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().fillarea=(h==2?true:false);
 
-			fseek(f,LAYER+0x1E,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x1E,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().fillarea_type=h;
 
-			fseek(f,LAYER+0xC2,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0xC2,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().fillarea_color=h;
 
-			fseek(f,LAYER+0xCE,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0xCE,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().fillarea_pattern=h;
 
-			fseek(f,LAYER+0xCA,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0xCA,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().fillarea_pattern_color=h;
 
-			fseek(f,LAYER+0xC6,SEEK_SET);
-			fread(&w,2,1,f);
+			f->seek(LAYER+0xC6,SEEK_SET);
+			f->read(&w,2,1);
 			if(IsBigEndian()) SwapBytes(w);
 			GRAPH.back().layer.back().curve.back().fillarea_pattern_width=(double)w/500.0;
 
-			fseek(f,LAYER+0xCF,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0xCF,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().fillarea_pattern_border_style=h;
 
-			fseek(f,LAYER+0xD2,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0xD2,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().fillarea_pattern_border_color=h;
 			
-			fseek(f,LAYER+0xD0,SEEK_SET);
-			fread(&w,2,1,f);
+			f->seek(LAYER+0xD0,SEEK_SET);
+			f->read(&w,2,1);
 			if(IsBigEndian()) SwapBytes(w);
 			GRAPH.back().layer.back().curve.back().fillarea_pattern_border_width=(double)w/500.0;
 
-			fseek(f,LAYER+0x16A,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x16A,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().line_color=h;
 
-			fseek(f,LAYER+0x17,SEEK_SET);
-			fread(&w,2,1,f);
+			f->seek(LAYER+0x17,SEEK_SET);
+			f->read(&w,2,1);
 			if(IsBigEndian()) SwapBytes(w);
 			GRAPH.back().layer.back().curve.back().symbol_type=w;
 
-			fseek(f,LAYER+0x12E,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x12E,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().symbol_fill_color=h;
 
-			fseek(f,LAYER+0x132,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x132,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().symbol_color=h;
 
-			fseek(f,LAYER+0x136,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x136,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().symbol_thickness=(h==255?1:h);
 
-			fseek(f,LAYER+0x137,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(LAYER+0x137,SEEK_SET);
+			f->read(&h,1,1);
 			GRAPH.back().layer.back().curve.back().point_offset=h;
 
 			LAYER+=0x1E7+0x1;
-			fseek(f,LAYER,SEEK_SET);
+			f->seek(LAYER,SEEK_SET);
 			int comm_size=0;
-			fread(&comm_size,4,1,f);
+			f->read(&comm_size,4,1);
 			if(IsBigEndian()) SwapBytes(comm_size);
 			LAYER+=0x5;
 			if(comm_size>0)
 			{
 				LAYER+=comm_size+0x1;
 			}
-			fseek(f,LAYER,SEEK_SET);
+			f->seek(LAYER,SEEK_SET);
 			int ntmp;
-			fread(&ntmp,4,1,f);
+			f->read(&ntmp,4,1);
 			if(IsBigEndian()) SwapBytes(ntmp);
 			if(ntmp!=0x1E7)
 				break;
@@ -1956,23 +1978,23 @@ void OPJFile::readGraphInfo(FILE *f, FILE *debug)
 
 		LAYER+=0x2*0x5+0x1ED*0x6;
 
-		fseek(f,LAYER,SEEK_SET);
-		fread(&sec_size,4,1,f);
+		f->seek(LAYER,SEEK_SET);
+		f->read(&sec_size,4,1);
 		if(IsBigEndian()) SwapBytes(sec_size);
 		if(sec_size==0)
 			break;
 	}
 	POS = LAYER+0x5;
 
-	fseek(f,POS,SEEK_SET);
+	f->seek(POS,SEEK_SET);
 }
 
-void OPJFile::skipObjectInfo(FILE *f, FILE *)
+void OPJFile::skipObjectInfo(OPJReader *f, FILE *)
 {
-	int POS=ftell(f);
+	int POS=f->tell();
 
 	int headersize;
-	fread(&headersize,4,1,f);
+	f->read(&headersize,4,1);
 	if(IsBigEndian()) SwapBytes(headersize);
 	POS+=5;
 
@@ -1992,15 +2014,15 @@ void OPJFile::skipObjectInfo(FILE *f, FILE *)
 			LAYER+=0x5;
 
 		//section_header
-			fseek(f,LAYER+0x46,SEEK_SET);
+			f->seek(LAYER+0x46,SEEK_SET);
 			char sec_name[42];
 			sec_name[41]='\0';
-			fread(&sec_name,41,1,f);
+			f->read(&sec_name,41,1);
 
 		//section_body_1_size
 			LAYER+=0x6F+0x1;
-			fseek(f,LAYER,SEEK_SET);
-			fread(&sec_size,4,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(&sec_size,4,1);
 			if(IsBigEndian()) SwapBytes(sec_size);
 
 		//section_body_1
@@ -2008,8 +2030,8 @@ void OPJFile::skipObjectInfo(FILE *f, FILE *)
 
 		//section_body_2_size
 			LAYER+=sec_size+0x1;
-			fseek(f,LAYER,SEEK_SET);
-			fread(&sec_size,4,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(&sec_size,4,1);
 			if(IsBigEndian()) SwapBytes(sec_size);
 
 		//section_body_2
@@ -2019,8 +2041,8 @@ void OPJFile::skipObjectInfo(FILE *f, FILE *)
 			LAYER+=sec_size+(sec_size>0?0x1:0);
 
 		//section_body_3_size
-			fseek(f,LAYER,SEEK_SET);
-			fread(&sec_size,4,1,f);
+			f->seek(LAYER,SEEK_SET);
+			f->read(&sec_size,4,1);
 			if(IsBigEndian()) SwapBytes(sec_size);
 
 		//section_body_3
@@ -2040,133 +2062,133 @@ void OPJFile::skipObjectInfo(FILE *f, FILE *)
 			LAYER+=0x5;
 
 			LAYER+=0x1E7+0x1;
-			fseek(f,LAYER,SEEK_SET);
+			f->seek(LAYER,SEEK_SET);
 			int comm_size=0;
-			fread(&comm_size,4,1,f);
+			f->read(&comm_size,4,1);
 			if(IsBigEndian()) SwapBytes(comm_size);
 			LAYER+=0x5;
 			if(comm_size>0)
 			{
 				LAYER+=comm_size+0x1;
 			}
-			fseek(f,LAYER,SEEK_SET);
+			f->seek(LAYER,SEEK_SET);
 			int ntmp;
-			fread(&ntmp,4,1,f);
+			f->read(&ntmp,4,1);
 			if(IsBigEndian()) SwapBytes(ntmp);
 			if(ntmp!=0x1E7)
 				break;
 		}
 
 		LAYER+=0x5*0x5+0x1ED*0x12;
-		fseek(f,LAYER,SEEK_SET);
-		fread(&sec_size,4,1,f);
+		f->seek(LAYER,SEEK_SET);
+		f->read(&sec_size,4,1);
 		if(IsBigEndian()) SwapBytes(sec_size);
 		if(sec_size==0)
 			break;
 	}
 	POS = LAYER+0x5;
 
-	fseek(f,POS,SEEK_SET);
+	f->seek(POS,SEEK_SET);
 }
 
-void OPJFile::readGraphGridInfo(graphGrid &grid, FILE *f, int pos) 
+void OPJFile::readGraphGridInfo(graphGrid &grid, OPJReader *f, int pos) 
 {
 	unsigned char h;
 	short w;
-	fseek(f,pos+0x26,SEEK_SET);
-	fread(&h,1,1,f);
+	f->seek(pos+0x26,SEEK_SET);
+	f->read(&h,1,1);
 	grid.hidden=(h==0);
 
-	fseek(f,pos+0xF,SEEK_SET);
-	fread(&h,1,1,f);
+	f->seek(pos+0xF,SEEK_SET);
+	f->read(&h,1,1);
 	grid.color=h;
 
 	
-	fseek(f,pos+0x12,SEEK_SET);
-	fread(&h,1,1,f);
+	f->seek(pos+0x12,SEEK_SET);
+	f->read(&h,1,1);
 	grid.style=h;
 	
-	fseek(f,pos+0x15,SEEK_SET);
-	fread(&w,2,1,f);
+	f->seek(pos+0x15,SEEK_SET);
+	f->read(&w,2,1);
 	if(IsBigEndian()) SwapBytes(w);
 	grid.width=(double)w/500.0;
 }
 
-void OPJFile::readGraphAxisFormatInfo(graphAxisFormat &format, FILE *f, int pos) 
+void OPJFile::readGraphAxisFormatInfo(graphAxisFormat &format, OPJReader *f, int pos) 
 {
 	unsigned char h;
 	short w;
 	double p;
-	fseek(f,pos+0x26,SEEK_SET);
-	fread(&h,1,1,f);
+	f->seek(pos+0x26,SEEK_SET);
+	f->read(&h,1,1);
 	format.hidden=(h==0);
 
-	fseek(f,pos+0xF,SEEK_SET);
-	fread(&h,1,1,f);
+	f->seek(pos+0xF,SEEK_SET);
+	f->read(&h,1,1);
 	format.color=h;
 
-	fseek(f,pos+0x4A,SEEK_SET);
-	fread(&w,2,1,f);
+	f->seek(pos+0x4A,SEEK_SET);
+	f->read(&w,2,1);
 	if(IsBigEndian()) SwapBytes(w);
 	format.majorTickLength=(double)w/10.0;
 	
-	fseek(f,pos+0x15,SEEK_SET);
-	fread(&w,2,1,f);
+	f->seek(pos+0x15,SEEK_SET);
+	f->read(&w,2,1);
 	if(IsBigEndian()) SwapBytes(w);
 	format.thickness=(double)w/500.0;
 
-	fseek(f,pos+0x25,SEEK_SET);
-	fread(&h,1,1,f);
+	f->seek(pos+0x25,SEEK_SET);
+	f->read(&h,1,1);
 	format.minorTicksType=(h>>6);
 	format.majorTicksType=((h>>4)&3);
 	format.axisPosition=(h&0xF);
 	switch(format.axisPosition) 
 	{
 		case 1:
-			fseek(f,pos+0x37,SEEK_SET);
-			fread(&h,1,1,f);
+			f->seek(pos+0x37,SEEK_SET);
+			f->read(&h,1,1);
 			format.axisPositionValue=(double)h;
 			break;
 		case 2:
-			fseek(f,pos+0x2F,SEEK_SET);
-			fread(&p,8,1,f);
+			f->seek(pos+0x2F,SEEK_SET);
+			f->read(&p,8,1);
 			if(IsBigEndian()) SwapBytes(p);
 			format.axisPositionValue=p;
 			break;
 	}
 }
 
-void OPJFile::readGraphAxisTickLabelsInfo(graphAxisTick &tick, FILE *f, int pos) {
+void OPJFile::readGraphAxisTickLabelsInfo(graphAxisTick &tick, OPJReader *f, int pos) {
 	unsigned char h;
 	unsigned char h1;
 	// unsigned char h2;
 	short w;
 	//double p;
-	fseek(f,pos+0x26,SEEK_SET);
-	fread(&h,1,1,f);
+	f->seek(pos+0x26,SEEK_SET);
+	f->read(&h,1,1);
 	tick.hidden=(h==0);
 
-	fseek(f,pos+0xF,SEEK_SET);
-	fread(&h,1,1,f);
+	f->seek(pos+0xF,SEEK_SET);
+	f->read(&h,1,1);
 	tick.color=h;
 	
-	fseek(f,pos+0x13,SEEK_SET);
-	fread(&w,2,1,f);
+	f->seek(pos+0x13,SEEK_SET);
+	f->read(&w,2,1);
 	if(IsBigEndian()) SwapBytes(w);
 	tick.rotation=w/10;
 
-	fseek(f,pos+0x15,SEEK_SET);
-	fread(&w,2,1,f);
+	f->seek(pos+0x15,SEEK_SET);
+	f->read(&w,2,1);
 	if(IsBigEndian()) SwapBytes(w);
 	tick.fontsize=w;
 
-	fseek(f,pos+0x23,SEEK_SET);
-	fread(&w,2,1,f);
+	f->seek(pos+0x23,SEEK_SET);
+	f->read(&w,2,1);
 	if(IsBigEndian()) SwapBytes(w);
 	
-	fseek(f,pos+0x25,SEEK_SET);
-	fread(&h,1,1,f);
-	fread(&h1,1,1,f);
+	f->seek(pos+0x25,SEEK_SET);
+	f->read(&h,1,1);
+	f->read(&h1,1,1);
 	tick.value_type=(h&0xF);
 
 	vector<string> col;
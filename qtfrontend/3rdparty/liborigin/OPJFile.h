@@ -32,11 +32,45 @@
 #ifndef OPJFILE_H
 #define OPJFILE_H
 
+#include <stdio.h>
+#include <string.h>
 #include <string>
 #include <vector>
 
 using namespace std;
 
+//! In-memory copy of a project file, read with the semantics of fread(), fseek() and ftell()
+/*! The parser reads most items a few bytes at a time and seeks back and forth a lot.
+ *  Reading the whole file at once and serving those calls from memory is much faster
+ *  than a library call (and often a system call) for each of them.
+ */
+class OPJReader {
+public:
+	OPJReader() : pos(0) {}
+	bool open(const char *filename);	//!< read the whole file, false if that failed
+	size_t read(void *ptr, size_t size, size_t count) {	//!< like fread(ptr, size, count, file)
+		if(size == 0 || count == 0 || pos >= (long)data.size())
+			return 0;
+		size_t bytes = size*count, left = data.size() - pos;
+		if(bytes > left)
+			bytes = left;
+		memcpy(ptr, &data[pos], bytes);
+		pos += bytes;
+		return bytes/size;
+	}
+	int seek(long offset, int whence) {	//!< like fseek(file, offset, whence)
+		long base = whence == SEEK_CUR ? pos : (whence == SEEK_END ? (long)data.size() : 0);
+		if(base + offset < 0)
+			return -1;
+		pos = base + offset;
+		return 0;
+	}
+	long tell() const { return pos; }	//!< like ftell(file)
+private:
+	vector<char> data;
+	long pos;
+};
+
 // for string entries
 struct Entry {
 	short spread;
@@ -265,6 +299,7 @@ class OPJFile
 public:
 	OPJFile(const char* filename);
 	int Parse();
+	void setDebugLog(const char *logfile) { this->logfile = logfile; }	//!< write a log of the parsing to logfile (none by default)
 	double Version() { return version/100.0; }		//!< get version of project file
 
 	//spreadsheet properties
@@ -444,22 +479,23 @@ public:
 private:
 	bool IsBigEndian();
 	void ByteSwap(unsigned char * b, int n);
-	int ParseFormatOld();
-	int ParseFormatNew();
+	int ParseFormatOld(OPJReader *fopj);
+	int ParseFormatNew(OPJReader *fopj);
 	int  compareSpreadnames(char *sname);				//!< returns matching spread index
 	int  compareColumnnames(int spread, char *sname);	//!< returns matching column index
 	int  compareMatrixnames(char *sname);				//!< returns matching matrix index
 	int  compareFunctionnames(const char *sname);				//!< returns matching function index
 	vector<string> findDataByIndex(int index);
-	void readSpreadInfo(FILE *fopj, FILE *fdebug);
-	void readMatrixInfo(FILE *fopj, FILE *fdebug);
-	void readGraphInfo(FILE *fopj, FILE *fdebug);
-	void readGraphGridInfo(graphGrid &grid, FILE *fopj, int pos);
-	void readGraphAxisFormatInfo(graphAxisFormat &format, FILE *fopj, int pos);
-	void readGraphAxisTickLabelsInfo(graphAxisTick &tick, FILE *fopj, int pos);
-	void skipObjectInfo(FILE *fopj, FILE *fdebug);
+	void readSpreadInfo(OPJReader *fopj, FILE *fdebug);
+	void readMatrixInfo(OPJReader *fopj, FILE *fdebug);
+	void readGraphInfo(OPJReader *fopj, FILE *fdebug);
+	void readGraphGridInfo(graphGrid &grid, OPJReader *fopj, int pos);
+	void readGraphAxisFormatInfo(graphAxisFormat &format, OPJReader *fopj, int pos);
+	void readGraphAxisTickLabelsInfo(graphAxisTick &tick, OPJReader *fopj, int pos);
+	void skipObjectInfo(OPJReader *fopj, FILE *fdebug);
 	void setColName(int spread);		//!< set default column name starting from spreadsheet spread
 	const char* filename;			//!< project file name
+	const char* logfile;			//!< debug log file name (0 = no log)
 	int version;				//!< project version
 	int dataIndex;
 	string resultsLog;
@@ -31,12 +31,12 @@
 #include "graph/Plot.h"
 #include "graph/PlotCurve.h"
 #include "lib/ColorBox.h"
+#include "lib/FourierTransform.h"
 #include "core/AbstractDataSource.h"
 #include "table/Table.h"
 
 #include <QMessageBox>
 #include <QLocale>
-#include <gsl/gsl_fft_halfcomplex.h>
 
 Convolution::Convolution(ApplicationWindow *parent, Table *t, const QString& signalColName, const QString& responseColName)
 : Filter(parent, t)
@@ -98,9 +98,8 @@ void Convolution::setDataFromTable(Table *t, const QString& signalColName, const
 
 	m_n = rows;
 
-	m_n_signal = 16;// tmp number of points
-	while (m_n_signal < m_n + m_n_response/2)
-		m_n_signal *= 2;
+	// zero-pad to a length which GSL can transform without a large prime factor
+	m_n_signal = FourierTransform::nextFastSize(qMax(16, m_n + m_n_response/2));
 
     m_x = new double[m_n_signal]; //signal
 	m_y = new double[m_n_response]; //response
@@ -185,42 +184,18 @@ void Convolution::convlv(double *sig, int n, double *dres, int m, int sign)
 		res[m2]=dres[m-1];
 
 	// calculate ffts
-	gsl_fft_real_radix2_transform(res,1,n);
-	gsl_fft_real_radix2_transform(sig,1,n);
-
-	double re, im, size;
-	for (i=0;i<n/2;i++)
-	{// multiply/divide both ffts
-		if(i==0 || i==n/2-1)
-		{
-			if(sign == 1)
-				sig[i] = res[i]*sig[i];
-			else
-				sig[i] = sig[i]/res[i];
-		}
-		else
-		{
-			int ni = n-i;
-			if(sign == 1)
-			{
-				re = res[i]*sig[i]-res[ni]*sig[ni];
-				im = res[i]*sig[ni]+res[ni]*sig[i];
-			}
-			else
-			{
-				size = res[i]*res[i]+res[ni]*res[ni];
-				re = res[i]*sig[i]+res[ni]*sig[ni];
-				im = res[i]*sig[ni]-res[ni]*sig[i];
-				re /= size;
-				im /= size;
-			}
-
-			sig[i] = re;
-			sig[ni] = im;
-		}
-	}
+	FourierTransform fft(n);
+	fft.realForward(res);
+	fft.realForward(sig);
+
+	// multiply/divide both ffts
+	if(sign == 1)
+		FourierTransform::multiplyHalfcomplex(sig, res, n);
+	else
+		FourierTransform::divideHalfcomplex(sig, res, n);
+
 	delete[] res;
-	gsl_fft_halfcomplex_radix2_inverse(sig,1,n);// inverse fft
+	fft.halfcomplexInverse(sig);// inverse fft
 }
  /**************************************************************************
  *             Class Deconvolution                                         *
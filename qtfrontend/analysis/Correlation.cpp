@@ -31,13 +31,12 @@
 #include "graph/Plot.h"
 #include "graph/PlotCurve.h"
 #include "lib/ColorBox.h"
+#include "lib/FourierTransform.h"
 #include "table/Table.h"
 
 #include <QMessageBox>
 #include <QLocale>
 
-#include <gsl/gsl_fft_halfcomplex.h>
-
 Correlation::Correlation(ApplicationWindow *parent, Table *t, const QString& colName1, const QString& colName2)
 : Filter(parent, t)
 {
@@ -75,9 +74,8 @@ void Correlation::setDataFromTable(Table *t, const QString& colName1, const QStr
 	}
 
 	int rows = m_table->rowCount();
-	m_n = 16; // tmp number of points
-	while (m_n < rows)
-		m_n *= 2;
+	// zero-pad to a length which GSL can transform without a large prime factor
+	m_n = FourierTransform::nextFastSize(qMax(16, rows));
 
     m_x = new double[m_n];
 	m_y = new double[m_n];
@@ -104,32 +102,18 @@ void Correlation::setDataFromTable(Table *t, const QString& colName1, const QStr
 void Correlation::output()
 {
     // calculate the FFTs of the two functions
-	if( gsl_fft_real_radix2_transform( m_x, 1, m_n ) == 0 &&
-        gsl_fft_real_radix2_transform( m_y, 1, m_n ) == 0)
-	{
-		// multiply the FFT by its complex conjugate
-		for(int i=0; i<m_n/2; i++ )
-		{
-			if( i==0 || i==(m_n/2)-1 )
-				m_x[i] *= m_x[i];
-			else
-			{
-				int ni = m_n-i;
-				double dReal = m_x[i] * m_y[i] + m_x[ni] * m_y[ni];
-				double dImag = m_x[i] * m_y[ni] - m_x[ni] * m_y[i];
-				m_x[i] = dReal;
-				m_x[ni] = dImag;
-			}
-		}
-	}
-	else
+	FourierTransform fft(m_n);
+	if(!fft.realForward(m_x) || !fft.realForward(m_y))
 	{
 		QMessageBox::warning((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
                              tr("Error in GSL forward FFT operation!"));
 		return;
 	}
 
-	gsl_fft_halfcomplex_radix2_inverse(m_x, 1, m_n );	//inverse FFT
+	// multiply the complex conjugate of the first FFT with the second one
+	FourierTransform::multiplyHalfcomplex(m_x, m_y, m_n, true);
+
+	fft.halfcomplexInverse(m_x);	//inverse FFT
 
 	addResultCurve();
 }
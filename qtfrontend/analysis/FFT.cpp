@@ -30,12 +30,12 @@
 #include "graph/Graph.h"
 #include "graph/Plot.h"
 #include "lib/ColorBox.h"
+#include "lib/FourierTransform.h"
 #include "table/Table.h"
 
 #include <QMessageBox>
 #include <QLocale>
 
-#include <gsl/gsl_fft_complex.h>
 #include <gsl/gsl_fft_halfcomplex.h>
 
 FFT::FFT(ApplicationWindow *parent, Table *t, const QString& realColName, const QString& imagColName)
@@ -86,22 +86,17 @@ QString FFT::fftCurve()
         m_explanation = tr("Forward") + " " + tr("FFT") + " " + tr("of") + " " + m_curve->title().text();
 		text = tr("Frequency");
 
-		gsl_fft_real_workspace *work=gsl_fft_real_workspace_alloc(m_n);
-		gsl_fft_real_wavetable *real=gsl_fft_real_wavetable_alloc(m_n);
-
-		if(!work || !real)
+		FourierTransform fft(m_n);
+		if(!fft.realForward(m_y))
 		{
+			delete[] amp;
+			delete[] result;
 			QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
                         tr("Could not allocate memory, operation aborted!"));
             m_init_err = true;
 			return "";
 		}
-
-		gsl_fft_real_transform(m_y, 1, m_n, real,work);
 		gsl_fft_halfcomplex_unpack (m_y, result, 1, m_n);
-
-		gsl_fft_real_wavetable_free(real);
-		gsl_fft_real_workspace_free(work);
 	}
 	else
 	{
@@ -109,20 +104,15 @@ QString FFT::fftCurve()
 		text = tr("Time");
 
 		gsl_fft_real_unpack (m_y, result, 1, m_n);
-		gsl_fft_complex_wavetable *wavetable = gsl_fft_complex_wavetable_alloc (m_n);
-		gsl_fft_complex_workspace *workspace = gsl_fft_complex_workspace_alloc (m_n);
-
-		if(!workspace || !wavetable)
+		if(!FourierTransform(m_n).complexInverse(result))
 		{
+			delete[] amp;
+			delete[] result;
 			QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
                         tr("Could not allocate memory, operation aborted!"));
             m_init_err = true;
 			return "";
 		}
-
-		gsl_fft_complex_inverse (result, 1, m_n, wavetable, workspace);
-		gsl_fft_complex_wavetable_free (wavetable);
-		gsl_fft_complex_workspace_free (workspace);
 	}
 
 	if (m_shift_order)
@@ -180,10 +170,7 @@ QString FFT::fftTable()
 	int rows = m_table->rowCount();
 	double *amp = new double[rows];
 
-	gsl_fft_complex_wavetable *wavetable = gsl_fft_complex_wavetable_alloc (rows);
-	gsl_fft_complex_workspace *workspace = gsl_fft_complex_workspace_alloc (rows);
-
-	if(!amp || !wavetable || !workspace)
+	if(!amp)
 	{
 		QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
                         tr("Could not allocate memory, operation aborted!"));
@@ -194,19 +181,27 @@ QString FFT::fftTable()
 	double df = 1.0/(double)(rows*m_sampling);//frequency sampling
 	double aMax = 0.0;//max amplitude
 	QString text;
+	FourierTransform fft(rows);
+	bool ok;
 	if(!m_inverse)
 	{
 		text = tr("Frequency");
-		gsl_fft_complex_forward (m_y, 1, rows, wavetable, workspace);
+		ok = fft.complexForward(m_y);
 	}
 	else
 	{
 		text = tr("Time");
-		gsl_fft_complex_inverse (m_y, 1, rows, wavetable, workspace);
+		ok = fft.complexInverse(m_y);
 	}
 
-	gsl_fft_complex_wavetable_free (wavetable);
-	gsl_fft_complex_workspace_free (workspace);
+	if(!ok)
+	{
+		delete[] amp;
+		QMessageBox::critical((ApplicationWindow *)parent(), tr("SciDAVis") + " - " + tr("Error"),
+                        tr("Could not allocate memory, operation aborted!"));
+        m_init_err = true;
+        return "";
+	}
 
 	if (m_shift_order)
 	{
@@ -27,12 +27,11 @@
  *                                                                         *
  ***************************************************************************/
 #include "FFTFilter.h"
+#include "lib/FourierTransform.h"
 
 #include <QMessageBox>
 #include <QLocale>
 
-#include <gsl/gsl_fft_halfcomplex.h>
-
 FFTFilter::FFTFilter(ApplicationWindow *parent, Layer *layer, const QString& curveTitle, int m)
 : Filter(parent, layer)
 {
@@ -113,11 +112,8 @@ void FFTFilter::calculateOutputData(double *x, double *y)
 
     double df = 0.5/(double)(m_n*(x[1]-x[0]));//half frequency sampling due to GSL storing
 
-	gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(m_n);
-	gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(m_n);
-
-	gsl_fft_real_transform (y, 1, m_n, real, work);
-	gsl_fft_real_wavetable_free (real);
+	FourierTransform fft(m_n);
+	fft.realForward(y);
 
     m_explanation = QLocale().toString(m_low_freq) + " ";
 	if (m_filter_type > 2)
@@ -163,8 +159,5 @@ void FFTFilter::calculateOutputData(double *x, double *y)
 			break;
 	}
 
-	gsl_fft_halfcomplex_wavetable *hc = gsl_fft_halfcomplex_wavetable_alloc (m_n);
-	gsl_fft_halfcomplex_inverse (y, 1, m_n, hc, work);
-	gsl_fft_halfcomplex_wavetable_free (hc);
-	gsl_fft_real_workspace_free (work);
+	fft.halfcomplexInverse(y);
 }
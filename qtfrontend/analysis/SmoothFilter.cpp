@@ -28,12 +28,11 @@
  ***************************************************************************/
 #include "SmoothFilter.h"
 #include "nrutil.h"
+#include "lib/FourierTransform.h"
 
 #include <QApplication>
 #include <QMessageBox>
 
-#include <gsl/gsl_fft_halfcomplex.h>
-
 SmoothFilter::SmoothFilter(ApplicationWindow *parent, Layer *layer, const QString& curveTitle, int m)
 : Filter(parent, layer)
 {
@@ -99,10 +98,8 @@ void SmoothFilter::calculateOutputData(double *x, double *y)
 
 void SmoothFilter::smoothFFT(double *x, double *y)
 {
-	gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(m_n);
-	gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(m_n);
-	gsl_fft_real_transform (y, 1, m_n, real, work);//FFT forward
-	gsl_fft_real_wavetable_free (real);
+	FourierTransform fft(m_n);
+	fft.realForward(y);//FFT forward
 
 	double df = 1.0/(double)(x[1] - x[0]);
 	double lf = df/(double)m_smooth_points;//frequency cutoff
@@ -114,10 +111,7 @@ void SmoothFilter::smoothFFT(double *x, double *y)
 	   y[i] = i*df > lf ? 0 : y[i];//filtering frequencies
 	}
 
-	gsl_fft_halfcomplex_wavetable *hc = gsl_fft_halfcomplex_wavetable_alloc (m_n);
-	gsl_fft_halfcomplex_inverse (y, 1, m_n, hc, work);//FFT inverse
-	gsl_fft_halfcomplex_wavetable_free (hc);
-	gsl_fft_real_workspace_free (work);
+	fft.halfcomplexInverse(y);//FFT inverse
 }
 
 void SmoothFilter::smoothAverage(double *, double *y)
@@ -30,22 +30,32 @@
 #include <math.h>
 
 StatisticsFilter::StatisticsFilter()
+	: AbstractFilter("StatisticsFilter")
 {
 	for (int i=0; i<2; i++)
+	{
 		m_strings[i] = new StringStatisticsColumn(this, (StatItem)i);
+		addChild(m_strings[i]);
+	}
 	for (int i=2; i<11; i++)
+	{
 		m_doubles[i-2] = new DoubleStatisticsColumn(this, (StatItem)i);
+		addChild(m_doubles[i-2]);
+	}
 }
 
 StatisticsFilter::~StatisticsFilter()
 {
-	for (int i=0; i<2; i++)
-		delete m_strings[i];
-	for (int i=0; i<9; i++)
-		delete m_doubles[i];
 }
 
-AbstractDataSource *StatisticsFilter::output(int port) const
+AbstractColumn *StatisticsFilter::output(int port)
+{
+	if (port < 0 || port >= outputCount()) return 0;
+	if (port <= 1) return m_strings[port];
+	return m_doubles[port-2];
+}
+
+const AbstractColumn *StatisticsFilter::output(int port) const
 {
 	if (port < 0 || port >= outputCount()) return 0;
 	if (port <= 1) return m_strings[port];
@@ -55,95 +65,67 @@ AbstractDataSource *StatisticsFilter::output(int port) const
 int StatisticsFilter::rowCount() const
 {
 	int result = 0;
-	foreach(AbstractDataSource* i, m_inputs)
+	foreach(const AbstractColumn* i, m_inputs)
 		if (i) result++;
 	return result;
 }
 
-void StatisticsFilter::inputDataAboutToChange(AbstractDataSource*)
+void StatisticsFilter::inputDataAboutToChange(const AbstractColumn*)
 {
 	// relay signal to all outputs but the first (which only holds the data source labels)
-	m_strings[1]->dataAboutToChange(m_strings[1]);
+	m_strings[1]->emitDataAboutToChange();
 	for (int i=0; i<9; i++)
-		m_doubles[i]->dataAboutToChange(m_doubles[i]);
+		m_doubles[i]->emitDataAboutToChange();
 }
 
-void StatisticsFilter::inputAboutToBeDisconnected(AbstractDataSource *source)
+void StatisticsFilter::inputAboutToBeDisconnected(const AbstractColumn *source)
 {
-	if (m_inputs.indexOf(source)+1 == m_s.size())
+	if (portIndexOf(source)+1 == m_s.size())
+	{
 		m_s.resize(m_s.size()-1);
+		m_dirty.resize(m_dirty.size()-1);
+	}
 }
 
-void StatisticsFilter::inputDataChanged(int port)
+void StatisticsFilter::inputDataChanged(const AbstractColumn *source)
 {
-	if (port >= m_s.size()) m_s.resize(port+1);
-	Statistics *s = &m_s[port];
-	QList< Interval<int> > valid_intervals = Interval<int>(0,m_inputs.at(port)->rowCount()-1) - m_inputs.at(port)->invalidIntervals();
-	if (valid_intervals.isEmpty()) {
-		s->first_valid_row = -1;
-		return;
+	int port = portIndexOf(source);
+	if (port < 0) return;
+	if (port >= m_s.size())
+	{
+		m_s.resize(port+1);
+		m_dirty.resize(port+1);
 	}
-
-	// initialize some entries for the following iteration
-	s->sum = 0; s->N = 0;
-	s->min_index = s->max_index = s->first_valid_row = s->last_valid_row = valid_intervals.at(0).start();
-	s->min = s->max = static_cast<AbstractDoubleDataSource*>(m_inputs.at(port))->valueAt(s->first_valid_row);
-
-	// iterate over all valid rows, determining first_valid_row, last_valid_row, N, min, max and sum
-	foreach(Interval<int> i, valid_intervals) {
-		if (i.start() < s->first_valid_row)
-			s->first_valid_row = i.start();
-		if (i.end() > s->last_valid_row)
-			s->last_valid_row = i.end();
-		for (int row = i.start(); row <= i.end(); row++) {
-			s->N++;
-			double val = static_cast<AbstractDoubleDataSource*>(m_inputs.at(port))->valueAt(row);
-			if (val < s->min) {
-				s->min = val;
-				s->min_index = row;
-			} else if (val > s->max) {
-				s->max = val;
-				s->max_index = row;
-			}
-			s->sum += val;
-		}
-	}
-
-	// iterate a second time, using the now-known mean to compute the variance
-	double mean = s->sum / double(s->N);
-	s->variance = 0;
-	foreach(Interval<int> i, valid_intervals)
-		for (int row = i.start(); row <= i.end(); row++)
-			s->variance += pow(static_cast<AbstractDoubleDataSource*>(m_inputs.at(port))->valueAt(row) - mean, 2);
-	s->variance /= double(s->N);
+	// the statistics are recomputed by update() when they are read the next time, so
+	// inputs changing together are computed in one parallel pass
+	m_dirty[port] = true;
 
 	// emit signals on all output ports that might have changed
-	m_strings[1]->dataChanged(m_strings[1]);
+	m_strings[1]->emitDataChanged();
 	for (int i=0; i<9; i++)
-		m_doubles[i]->dataChanged(m_doubles[i]);
+		m_doubles[i]->emitDataChanged();
 }
 
-double StatisticsFilter::DoubleStatisticsColumn::valueAt(int row) const
+void StatisticsFilter::update() const
 {
-	if (row<0 || row>=m_parent->rowCount()) return 0;
-	const Statistics *s = &(m_parent->m_s.at(row));
-	switch(m_item) {
-		case Mean: return s->sum / double(s->N);
-		case Sigma: return sqrt(s->variance);
-		case Variance: return s->variance;
-		case Sum: return s->sum;
-		case iMax: return s->max_index + 1;
-		case Max: return s->max;
-		case iMin: return s->min_index + 1;
-		case Min: return s->min;
-		case N: return s->N;
-		default: return 0;
-	}
+	QList<ColumnStatistics*> statistics;
+	QList<const AbstractColumn*> columns;
+	for (int port=0; port<m_s.size(); port++)
+		if (m_dirty.at(port))
+		{
+			statistics << &m_s[port];
+			columns << m_inputs.value(port);
+			m_dirty[port] = false;
+		}
+	if (!statistics.isEmpty())
+		ColumnStatistics::update(statistics, columns);
 }
 
-QString StatisticsFilter::DoubleStatisticsColumn::label() const
-{ 
-	switch(m_item) {
+QString StatisticsFilter::itemLabel(StatItem item)
+{
+	switch(item) {
+		case Label: return tr("Name");
+		case Rows: return tr("Rows");
 		case Mean: return tr("Mean");
 		case Sigma: return tr("StandardDev");
 		case Variance: return tr("Variance");
@@ -157,25 +139,45 @@ QString StatisticsFilter::DoubleStatisticsColumn::label() const
 	}
 }
 
-QString StatisticsFilter::StringStatisticsColumn::textAt(int row) const
+StatisticsFilter::StatisticsColumn::StatisticsColumn(const StatisticsFilter *parent, StatItem item)
+	: AbstractColumn(StatisticsFilter::itemLabel(item)), m_parent(parent), m_item(item)
 {
-	const Statistics *s = &(m_parent->m_s.at(row));
+}
+
+double StatisticsFilter::DoubleStatisticsColumn::valueAt(int row) const
+{
+	if (row<0 || row>=m_parent->rowCount() || row>=m_parent->m_s.size()) return 0;
+	m_parent->update();
+	const StatisticsAccumulator &s = m_parent->m_s.at(row).result();
 	switch(m_item) {
-		case Label:
-			return m_parent->m_inputs.value(row) ?
-				m_parent->m_inputs[row]->label() :
-				QString();
-		case Rows: return QString("[%1,%2]").arg(s->first_valid_row + 1).arg(s->last_valid_row+1);
-		default: return QString();
+		case Mean: return s.mean();
+		case Sigma: return sqrt(s.populationVariance());
+		case Variance: return s.populationVariance();
+		case Sum: return s.sum();
+		case iMax: return s.maximumRow() + 1;
+		case Max: return s.maximum();
+		case iMin: return s.minimumRow() + 1;
+		case Min: return s.minimum();
+		case N: return s.count();
+		default: return 0;
 	}
 }
 
-QString StatisticsFilter::StringStatisticsColumn::label() const
+QString StatisticsFilter::StringStatisticsColumn::textAt(int row) const
 {
 	switch(m_item) {
-		case Label: return tr("Name");
-		case Rows: return tr("Rows");
+		case Label:
+			return m_parent->m_inputs.value(row) ?
+				m_parent->m_inputs[row]->name() :
+				QString();
+		case Rows:
+			{
+				if (row<0 || row>=m_parent->m_s.size()) return QString();
+				m_parent->update();
+				const StatisticsAccumulator &s = m_parent->m_s.at(row).result();
+				if (s.isEmpty()) return QString();
+				return QString("[%1,%2]").arg(s.firstRow() + 1).arg(s.lastRow() + 1);
+			}
 		default: return QString();
 	}
 }
-
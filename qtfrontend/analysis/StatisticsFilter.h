@@ -30,8 +30,10 @@
 #define STATISTICS_FILTER_H
 
 #include "core/AbstractFilter.h"
-#include "core/datatypes/AbstractDoubleDataSource.h"
-#include "core/datatypes/AbstractStringDataSource.h"
+#include "core/AbstractColumn.h"
+#include "table/ColumnStatistics.h"
+
+#include <QVector>
 
 /**
  * \brief Computes standard statistics on any number of inputs.
@@ -40,8 +42,19 @@
  * are not implemented yet). It takes any number of inputs, computes statistics on
  * each and returns them on its outputs. Each output port corresponds to one
  * statistical item and provides as many rows as input ports are connected.
+ *
+ * The statistics of each input are kept in a ColumnStatistics, which caches the
+ * statistics of blocks of rows; when an input changes, only the blocks containing
+ * changed rows are recomputed. Inputs which changed at the same time are updated in
+ * parallel (see update()).
+ *
+ * \note The analysis module is not part of MODULES (see config.pri), so this filter is
+ * currently not built. ColumnStatistics itself is built with the table module and
+ * tested by table-test.
  */
 class StatisticsFilter : public AbstractFilter {
+	Q_OBJECT
+
 	public:
 		//! Standard constructor.
 		StatisticsFilter();
@@ -51,59 +64,76 @@ class StatisticsFilter : public AbstractFilter {
 		virtual int inputCount() const { return -1; }
 		//! Currently, 11 statistics items are computed (see the private StatItem enum).
 		virtual int outputCount() const { return 11; }
-		virtual AbstractDataSource *output(int port) const;
+		virtual AbstractColumn *output(int port);
+		virtual const AbstractColumn *output(int port) const;
 		//! Number of rows = number of inputs that have been provided.
 		int rowCount() const;
+		//! Bring the statistics of all inputs which changed up to date
+		/**
+		 * This is done automatically when the outputs are read; inputs which changed
+		 * since the last update are computed in parallel.
+		 */
+		void update() const;
 	protected:
-		virtual bool inputAcceptable(int, AbstractDataSource *source) {
-			return source->inherits("AbstractDoubleDataSource");
+		virtual bool inputAcceptable(int, const AbstractColumn *source) {
+			return source->dataType() == SciDAVis::TypeDouble;
 		}
-		virtual void inputDescriptionAboutToChange(AbstractDataSource*) { m_strings[0]->dataAboutToChange(m_doubles[0]); }
-		virtual void inputDescriptionChanged(AbstractDataSource*) { m_strings[0]->dataChanged(m_doubles[0]); }
-		virtual void inputDataAboutToChange(AbstractDataSource*);
-		virtual void inputAboutToBeDisconnected(AbstractDataSource*);
+		virtual void inputDescriptionAboutToChange(const AbstractColumn*) { m_strings[0]->emitDataAboutToChange(); }
+		virtual void inputDescriptionChanged(const AbstractColumn*) { m_strings[0]->emitDataChanged(); }
+		virtual void inputDataAboutToChange(const AbstractColumn*);
+		virtual void inputAboutToBeDisconnected(const AbstractColumn*);
 		//! This is where the magic happens: data changes on an input port cause the corresponding entry in #m_s to be recomputed.
-		virtual void inputDataChanged(int port);
+		virtual void inputDataChanged(const AbstractColumn*);
 	private:
-		//! The values being cached for each input column provided.
-		struct Statistics {
-			int first_valid_row, last_valid_row, min_index, max_index, N;
-			double min, max, sum, variance;
-		};
+		class StatisticsColumn;
+		class DoubleStatisticsColumn;
+		class StringStatisticsColumn;
+		friend class StatisticsColumn;
+		friend class DoubleStatisticsColumn;
+		friend class StringStatisticsColumn;
+
 		enum StatItem { Label, Rows, Mean, Sigma, Variance, Sum, iMax, Max, iMin, Min, N };
 
-		//! Implements the double-typed output ports.
-		class DoubleStatisticsColumn : public AbstractDoubleDataSource {
+		//! Base class of the output ports.
+		class StatisticsColumn : public AbstractColumn {
 			public:
-				DoubleStatisticsColumn(const StatisticsFilter *parent, StatItem item) : m_parent(parent), m_item(item) {}
+				StatisticsColumn(const StatisticsFilter *parent, StatItem item);
 				virtual int rowCount() const { return m_parent->rowCount(); }
-				virtual double valueAt(int row) const;
-				virtual QString label() const; 
 				virtual SciDAVis::PlotDesignation plotDesignation() const { return SciDAVis::noDesignation; }
-			private:
-				friend class StatisticsFilter;
+				void emitDataAboutToChange() { emit dataAboutToChange(this); }
+				void emitDataChanged() { emit dataChanged(this); }
+			protected:
 				const StatisticsFilter *m_parent;
 				StatItem m_item;
 		};
 
+		//! Implements the double-typed output ports.
+		class DoubleStatisticsColumn : public StatisticsColumn {
+			public:
+				DoubleStatisticsColumn(const StatisticsFilter *parent, StatItem item) : StatisticsColumn(parent, item) {}
+				virtual SciDAVis::ColumnDataType dataType() const { return SciDAVis::TypeDouble; }
+				virtual SciDAVis::ColumnMode columnMode() const { return SciDAVis::Numeric; }
+				virtual double valueAt(int row) const;
+		};
+
 		//! Implements the string-typed output ports.
-		class StringStatisticsColumn : public AbstractStringDataSource {
+		class StringStatisticsColumn : public StatisticsColumn {
 			public:
-				StringStatisticsColumn(const StatisticsFilter *parent, StatItem item) : m_parent(parent), m_item(item) {}
-				virtual int rowCount() const { return m_parent->rowCount(); }
+				StringStatisticsColumn(const StatisticsFilter *parent, StatItem item) : StatisticsColumn(parent, item) {}
+				virtual SciDAVis::ColumnDataType dataType() const { return SciDAVis::TypeQString; }
+				virtual SciDAVis::ColumnMode columnMode() const { return SciDAVis::Text; }
 				virtual QString textAt(int row) const;
-				virtual QString label() const;
-				virtual SciDAVis::PlotDesignation plotDesignation() const { return SciDAVis::noDesignation; }
-			private:
-				friend class StatisticsFilter;
-				const StatisticsFilter *m_parent;
-				StatItem m_item;
 		};
 
-		QVector<Statistics> m_s;
+		//! Return the label of a statistics item.
+		static QString itemLabel(StatItem item);
+
+		//! The values being cached for each input column provided.
+		mutable QVector<ColumnStatistics> m_s;
+		//! Whether the input on the same port changed since the last update().
+		mutable QVector<bool> m_dirty;
 		StringStatisticsColumn* m_strings[2];
 		DoubleStatisticsColumn* m_doubles[9];
 };
 
 #endif // ifndef STATISTICS_FILTER_H
-
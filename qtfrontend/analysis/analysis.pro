@@ -1,7 +1,7 @@
 include(../config.pri)
 TEMPLATE = lib
 CONFIG += plugin static
-INCLUDEPATH += .. ../core
+INCLUDEPATH += .. ../core ../../backend
 TARGET = ../$$qtLibraryTarget(scidavis_analysis)
 QT += xml
 
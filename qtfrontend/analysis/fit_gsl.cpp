@@ -3,8 +3,6 @@
 #include <stdio.h>
 #include <stddef.h>
 
-#include <qmessagebox.h>
-
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_math.h>
 #include "fit_gsl.h"
@@ -612,41 +610,93 @@ int lorentz_multi_peak_fdf (const gsl_vector * x, void *params, gsl_vector * f,
 	return GSL_SUCCESS;
 }
 
+UserFitFunction::UserFitFunction(const QString& formula, const QStringList& parameters)
+	: m_parser(new MyParser()), m_p(parameters.size()), m_params(new double[parameters.size()]), m_x(0)
+{
+	try
+	{
+		m_parser->DefineVar("x", &m_x);
+		for (size_t i=0; i<m_p; i++)
+		{
+			m_params[i] = 1.0;
+			m_parser->DefineVar(parameters[i].toAscii().constData(), &m_params[i]);
+		}
+		m_parser->SetExpr(formula.toAscii().constData());
+	}
+	catch(mu::ParserError &)
+	{
+		delete m_parser;
+		delete[] m_params;
+		throw;
+	}
+}
+
+UserFitFunction::~UserFitFunction()
+{
+	delete m_parser;
+	delete[] m_params;
+}
+
+void UserFitFunction::setParameters(const gsl_vector * params)
+{
+	for (size_t i=0; i<m_p; i++)
+		m_params[i] = gsl_vector_get(params, i);
+}
+
+void UserFitFunction::eval(const gsl_vector * params, const double * X, double * out, size_t n)
+{
+	setParameters(params);
+	for (size_t i=0; i<n; i++)
+	{
+		m_x = X[i];
+		out[i] = m_parser->Eval();
+	}
+}
+
+void UserFitFunction::jacobian(const gsl_vector * params, const double * X, const double * sigma, size_t n, gsl_matrix * J)
+{
+	static const double steps[4] = {2, 1, -1, -2};
+	static const double weights[4] = {-1, 8, -8, 1};
+
+	setParameters(params);
+	gsl_matrix_set_zero(J);
+	for (size_t j=0; j<m_p; j++)
+	{
+		double pos = m_params[j];
+		double epsilon = (pos == 0) ? 1e-10 : 1e-7*pos;
+		for (int k=0; k<4; k++)
+		{
+			m_params[j] = pos + steps[k]*epsilon;
+			double weight = weights[k]/(12*epsilon);
+			for (size_t i=0; i<n; i++)
+			{
+				m_x = X[i];
+				*gsl_matrix_ptr(J, i, j) += weight*m_parser->Eval();
+			}
+		}
+		m_params[j] = pos;
+		for (size_t i=0; i<n; i++)
+			*gsl_matrix_ptr(J, i, j) /= sigma[i];
+	}
+}
+
 int user_f(const gsl_vector * x, void *params, gsl_vector * f)
 {
 	size_t n = ((struct FitData *)params)->n;
-	size_t p = ((struct FitData *)params)->p;
-	double *X = ((struct FitData *)params)->X;
 	double *Y = ((struct FitData *)params)->Y;
 	double *sigma = ((struct FitData *)params)->sigma;
+	UserFitFunction *function = ((struct FitData *)params)->function;
 
-	const char *function = ((struct FitData *) params)->function;
-
-	QString names = (QString)((struct FitData *) params)->names;
-	QStringList parNames= names.split(",", QString::SkipEmptyParts);
-
-	MyParser parser;
 	try
 	{
-		double *parameters = new double[p];
-		double xvar;
-		parser.DefineVar("x", &xvar);
-		for (int i=0; i<(int)p; i++)
-		{
-			parameters[i]=gsl_vector_get(x,i);
-			parser.DefineVar(parNames[i].toAscii().constData(), &parameters[i]);
-		}	
-		parser.SetExpr(function);
+		double *values = new double[n];
+		function->eval(x, ((struct FitData *)params)->X, values, n);
 		for (int j = 0; j < (int)n; j++)
-		{
-			xvar=X[j];
-			gsl_vector_set (f, j, (parser.Eval() - Y[j])/sigma[j]);
-		}
-		delete[] parameters;
+			gsl_vector_set (f, j, (values[j] - Y[j])/sigma[j]);
+		delete[] values;
 	}
-	catch(mu::ParserError &e)
+	catch(mu::ParserError &)
 	{
-		QMessageBox::critical(0,"Input function error",QString::fromStdString(e.GetMsg()));
 		return GSL_EINVAL;
 	}
 	return GSL_SUCCESS;
@@ -655,39 +705,24 @@ int user_f(const gsl_vector * x, void *params, gsl_vector * f)
 double user_d(const gsl_vector * x, void *params)
 {
 	size_t n = ((struct FitData *)params)->n;
-	size_t p = ((struct FitData *)params)->p;
-	double *X = ((struct FitData *)params)->X;
 	double *Y = ((struct FitData *)params)->Y;
 	double *sigma = ((struct FitData *)params)->sigma;
-
-	const char *function = ((struct FitData *) params)->function;
-	QString names = (QString)((struct FitData *) params)->names;
-	QStringList parNames= names.split(",", QString::SkipEmptyParts);
+	UserFitFunction *function = ((struct FitData *)params)->function;
 
 	double val=0;
-	MyParser parser;
 	try
 	{
-		double *parameters = new double[p];
-		double xvar;
-		parser.DefineVar("x", &xvar);
-		for (int i=0; i<(int)p; i++)
-		{
-			parameters[i]=gsl_vector_get(x,i);
-			parser.DefineVar(parNames[i].toAscii().constData(), &parameters[i]);
-		}	
-		parser.SetExpr(function);
+		double *values = new double[n];
+		function->eval(x, ((struct FitData *)params)->X, values, n);
 		for (int j = 0; j < (int)n; j++)
 		{
-			xvar=X[j];
-			double t=(parser.Eval() - Y[j])/sigma[j];
+			double t=(values[j] - Y[j])/sigma[j];
 			val+=t*t;
 		}
-		delete[] parameters;
+		delete[] values;
 	}
-	catch(mu::ParserError &e)
+	catch(mu::ParserError &)
 	{
-		QMessageBox::critical(0,"Input function error",QString::fromStdString(e.GetMsg()));
 		return GSL_EINVAL;
 	}
 	return val;
@@ -696,36 +731,13 @@ double user_d(const gsl_vector * x, void *params)
 int user_df(const gsl_vector *x, void *params, gsl_matrix *J)
 {
 	size_t n = ((struct FitData *)params)->n;
-	size_t p = ((struct FitData *)params)->p;
 	double *X = ((struct FitData *)params)->X;
 	double *sigma = ((struct FitData *)params)->sigma;
-
-	const char *function = ((struct FitData *) params)->function;
-	QString names = (QString)((struct FitData *) params)->names;
-	QStringList parNames= names.split(",", QString::SkipEmptyParts);
+	UserFitFunction *function = ((struct FitData *)params)->function;
 
 	try
 	{
-		double *param = new double[p];
-		MyParser parser;
-		double xvar; 
-		parser.DefineVar("x", &xvar);
-
-		for (int k=0; k<(int)p; k++)
-		{
-			param[k]=gsl_vector_get(x,k);
-			parser.DefineVar(parNames[k].toAscii().constData(), &param[k]);
-		}
-
-		parser.SetExpr(function);
-
-		for (int i = 0; i<(int)n; i++)
-		{
-			xvar = X[i];	 
-			for (int j=0; j<(int)p; j++)
-				gsl_matrix_set (J, i, j, 1/sigma[i]*parser.Diff(&param[j], param[j]));
-		}
-		delete[] param;
+		function->jacobian(x, X, sigma, n, J);
 	}
 	catch(mu::ParserError &)
 	{
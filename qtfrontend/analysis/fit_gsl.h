@@ -2,6 +2,45 @@
 #define FIT_GSL_H
 
 #include <gsl/gsl_vector.h>
+#include <gsl/gsl_matrix.h>
+
+#include <QString>
+#include <QStringList>
+
+class MyParser;
+
+//! A user-defined fit function, parsed once and evaluated for all iterations of a fit
+/**
+ * The parser variables are bound to members of this object, so evaluating the function
+ * for a new set of parameters only means copying the parameters into place.
+ * All methods throw mu::ParserError if the formula is invalid.
+ */
+class UserFitFunction
+{
+	public:
+		UserFitFunction(const QString& formula, const QStringList& parameters);
+		~UserFitFunction();
+
+		//! Evaluate the function for the n values in X, storing the results in 'out'.
+		void eval(const gsl_vector * params, const double * X, double * out, size_t n);
+		//! Numerical derivatives with respect to all parameters, divided by 'sigma'.
+		/**
+		 * J(i,j) is set to d f(X[i]) / d param_j / sigma[i], using the same five-point
+		 * stencil as mu::Parser::Diff(), but stepping each parameter only once for all points.
+		 */
+		void jacobian(const gsl_vector * params, const double * X, const double * sigma, size_t n, gsl_matrix * J);
+
+	private:
+		UserFitFunction(const UserFitFunction&);
+		UserFitFunction& operator=(const UserFitFunction&);
+
+		void setParameters(const gsl_vector * params);
+
+		MyParser * m_parser;
+		size_t m_p;
+		double * m_params;
+		double m_x;
+};
 
 //! Structure for fitting data
 struct FitData {
@@ -10,8 +49,7 @@ struct FitData {
   double * X;
   double * Y;
   double * sigma; // weighting data
-  const char *function;
-  const char *names;
+  UserFitFunction * function; // only used by user_f, user_df and user_d
 };
 
 int expd3_fdf (const gsl_vector * x, void *params, gsl_vector * f, gsl_matrix * J);
@@ -46,6 +46,12 @@ win32:INCLUDEPATH  += c:/zlib/include
 win32:LIBS         += c:/gsl/lib/libgsl.a
 win32:LIBS         += c:/gsl/lib/libgslcblas.a
 
+### muParser is required by core (MyParser, used by column formulas and 3D plots)
+unix:LIBS         += /usr/local/lib/libmuparser.a
+unix:INCLUDEPATH  += /usr/local/include
+win32:INCLUDEPATH  += c:/muparser/include
+win32:LIBS         += c:/muparser/lib/libmuparser.a
+
 ### Apparently this works around a qmake bug. This option doesn't seem to be
 ### documented, so it _might_ cause trouble and you _might_ want to build
 ### without it.
@@ -103,10 +109,6 @@ contains(MODULES, graph3D) {
 
 #unix:INCLUDEPATH  += 3rdparty/qwtplot3d/include
 #unix:LIBS         += 3rdparty/qwtplot3d/lib/libqwtplot3d.a
-#unix:LIBS			 += -lmuparser # the dependency on muparser needs to be removed
-#unix:LIBS			 += -lmuparserd # the dependency on muparser needs to be removed
-unix:LIBS         += /usr/local/lib/libmuparser.a
-unix:INCLUDEPATH  += /usr/local/include
 
 ### Link dynamically against system-wide installation of Qwtplot3D.
 ### WARNING: Make sure Qwtplot3D is compiled against Qt >= 4.2 if you use this.
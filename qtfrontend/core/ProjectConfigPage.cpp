@@ -29,11 +29,13 @@
 
 #include "core/ProjectConfigPage.h"
 #include "core/Project.h"
+#include "lib/UndoPayload.h"
 
 ProjectConfigPage::ProjectConfigPage() 
 {
 	ui.setupUi(this);
 	ui.default_subwindow_visibility_combobox->setCurrentIndex(Project::global("default_mdi_window_visibility").toInt());
+	ui.undo_memory_spinbox->setValue(Project::global("undo_memory_size").toInt());
 	// TODO: set the ui according to the global settings in Project::Private
 }
 
@@ -48,6 +50,8 @@ void ProjectConfigPage::apply()
 			Project::setGlobal("default_mdi_window_visibility", index);
 			break;
 	}
+	Project::setGlobal("undo_memory_size", ui.undo_memory_spinbox->value());
+	UndoMemory::instance()->setBudget(qint64(ui.undo_memory_spinbox->value()) << 20);
 	// TODO: read settings from ui and change them in Project::Private
 }
 
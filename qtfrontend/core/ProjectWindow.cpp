@@ -40,8 +40,11 @@
 #include "core/interfaces.h"
 #include "core/ImportDialog.h"
 #include "core/AbstractImportFilter.h"
+#include "core/column/Column.h"
 #include "lib/ActionManager.h"
 #include "lib/ShortcutsDialog.h"
+#include "lib/ProjectArchive.h"
+#include "lib/UndoPayload.h"
 #include "core/globals.h"
 
 #include <QMenuBar>
@@ -70,6 +73,8 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QTextStream>
+#include <QProgressDialog>
+#include <QFileInfo>
 
 ActionManager * ProjectWindow::action_manager = 0;
 
@@ -126,6 +131,10 @@ void ProjectWindow::init()
 		this, SLOT(handleAspectAboutToBeRemoved(const AbstractAspect *)));
 	connect(m_project, SIGNAL(statusInfo(const QString&)),
 			statusBar(), SLOT(showMessage(const QString&)));
+	m_undo_memory_label = new QLabel();
+	statusBar()->addPermanentWidget(m_undo_memory_label);
+	connect(m_project->undoStack(), SIGNAL(indexChanged(int)), this, SLOT(updateUndoMemoryInfo()));
+	updateUndoMemoryInfo();
 
 	handleAspectDescriptionChanged(m_project);
 
@@ -494,7 +503,8 @@ void ProjectWindow::newProject()
 void ProjectWindow::openProject()
 {
 	QString filter = tr("SciDAVis project")+" (*.sciprj);;";
-	filter += tr("Compressed SciDAVis project")+" (*.sciprj.gz)";
+	filter += tr("Compressed SciDAVis project")+" (*.sciprj.gz);;";
+	filter += tr("Binary SciDAVis project")+" (*.sciprjb)";
 
 	QString working_dir = qApp->applicationDirPath();
 	QString selected_filter;
@@ -514,7 +524,17 @@ void ProjectWindow::openProject()
 		statusBar()->showMessage(msg_text);
 		return;
 	}
-	XmlStreamReader reader(&file);
+	// binary projects are recognized by their signature, whatever the file name
+	ProjectArchive archive;
+	bool binary = ProjectArchive::isArchive(&file);
+	if (binary && !archive.openArchive(file_name))
+	{
+		QString msg_text = archive.errorString();
+		QMessageBox::critical(this, tr("Error opening project"), msg_text);
+		statusBar()->showMessage(msg_text);
+		return;
+	}
+	XmlStreamReader reader(binary ? static_cast<QIODevice *>(&archive) : static_cast<QIODevice *>(&file));
 	Project * prj = new Project();
 	prj->view(); // ensure the view (ProjectWindow) is created
 	if (prj->load(&reader) == false)
@@ -538,6 +558,8 @@ void ProjectWindow::openProject()
 	prj->undoStack()->clear();
 	prj->view()->showMaximized();
 	prj->setFileName(file_name);
+	if (binary)
+		prj->setArchiveFileName(file_name);
 }
 
 void ProjectWindow::saveProject()
@@ -546,25 +568,73 @@ void ProjectWindow::saveProject()
 		saveProjectAs();
 	else
 	{
-		QFile file(m_project->fileName());
+		QString file_name = m_project->fileName();
+		// Columns of a binary project may not have been read from the file yet, so the file
+		// the project was loaded from is saved in the same format, to a temporary file, which
+		// replaces the original when done.
+		bool archive_in_use = !m_project->archiveFileName().isEmpty()
+			&& QFileInfo(m_project->archiveFileName()).absoluteFilePath() == QFileInfo(file_name).absoluteFilePath();
+		bool binary = archive_in_use || file_name.endsWith(".sciprjb");
+		QFile file(binary ? file_name + ".part" : file_name);
 		if (!file.open(QIODevice::WriteOnly)) 
 		{
-			QString msg_text = tr("Could not open file \"%1\".").arg(m_project->fileName());
+			QString msg_text = tr("Could not open file \"%1\".").arg(file.fileName());
 			QMessageBox::critical(this, tr("Error saving project"), msg_text);
 			statusBar()->showMessage(msg_text);
 			return;
 		}
-		QXmlStreamWriter writer(&file);
-		m_project->save(&writer);
+		if (binary)
+		{
+			ProjectArchive archive;
+			QXmlStreamWriter writer(&archive);
+			bool ok = archive.beginWrite(&file);
+			if (ok)
+			{
+				m_project->save(&writer);
+				ok = archive.endWrite();
+			}
+			file.close();
+			QString msg_text = archive.errorString();
+			if (ok)
+			{
+#ifdef Q_OS_WIN
+				// open or mapped files can't be replaced on Windows
+				foreach(Column * col, m_project->children<Column>(AbstractAspect::Recursive))
+					col->releaseProjectFile();
+#endif
+				QFile::remove(file_name);
+				if (!file.rename(file_name))
+				{
+					msg_text = tr("Could not replace file \"%1\"; the project was saved as \"%2\".")
+						.arg(file_name).arg(file.fileName());
+					QMessageBox::warning(this, tr("Error saving project"), msg_text);
+					statusBar()->showMessage(msg_text);
+					return;
+				}
+			}
+			else
+			{
+				file.remove();
+				QMessageBox::critical(this, tr("Error saving project"), msg_text);
+				statusBar()->showMessage(msg_text);
+				return;
+			}
+		}
+		else
+		{
+			QXmlStreamWriter writer(&file);
+			m_project->save(&writer);
+			file.close();
+		}
 		m_project->undoStack()->clear();
-		file.close();
 	}
 }
 
 void ProjectWindow::saveProjectAs()
 {
 	QString filter = tr("SciDAVis project")+" (*.sciprj);;";
-	filter += tr("Compressed SciDAVis project")+" (*.sciprj.gz)";
+	filter += tr("Compressed SciDAVis project")+" (*.sciprj.gz);;";
+	filter += tr("Binary SciDAVis project")+" (*.sciprjb)";
 
 	QString working_dir = qApp->applicationDirPath();
 	QString selected_filter;
@@ -580,9 +650,12 @@ void ProjectWindow::saveProjectAs()
 		// TODO: remember path
 		//		working_dir = fi.dirPath(true);
 		QString base_name = fi.fileName();
-		if (!base_name.endsWith(".sciprj") && !base_name.endsWith(".sciprj.gz"))
+		if (!base_name.endsWith(".sciprj") && !base_name.endsWith(".sciprj.gz") && !base_name.endsWith(".sciprjb"))
 		{
-			fn.append(".sciprj");
+			if (selected_filter.contains(".sciprjb"))
+				fn.append(".sciprjb");
+			else
+				fn.append(".sciprj");
 		}
 		bool compress = false;
 		if (fn.endsWith(".gz"))
@@ -747,6 +820,11 @@ void ProjectWindow::importAspect()
 
 	AbstractImportFilter * filter = filter_map[id->selectedFilter()];
 	QFile file;
+	QProgressDialog progress(tr("Importing..."), tr("Cancel"), 0, 100, this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+	connect(filter, SIGNAL(progress(int)), &progress, SLOT(setValue(int)));
+	connect(&progress, SIGNAL(canceled()), filter, SLOT(cancel()));
 	switch (id->destination()) {
 		case ImportDialog::CurrentProject:
 			foreach(QString file_name, id->selectedFiles()) {
@@ -757,6 +835,12 @@ void ProjectWindow::importAspect()
 				}
 				AbstractAspect * aspect = filter->importAspect(&file);
 				file.close();
+				if (!aspect) {
+					if (filter->wasCanceled())
+						break;
+					statusBar()->showMessage(tr("Could not import file \"%1\".").arg(file_name));
+					continue;
+				}
 				if (aspect->inherits("Project")) {
 					Folder * folder = new Folder(aspect->name());
 					folder->setComment(aspect->comment());
@@ -778,6 +862,12 @@ void ProjectWindow::importAspect()
 				}
 				AbstractAspect * aspect = filter->importAspect(&file);
 				file.close();
+				if (!aspect) {
+					if (filter->wasCanceled())
+						break;
+					statusBar()->showMessage(tr("Could not import file \"%1\".").arg(file_name));
+					continue;
+				}
 				if (aspect->inherits("Project")) {
 					static_cast<Project*>(aspect)->view()->showMaximized();
 				} else {
@@ -863,7 +953,10 @@ void ProjectWindow::showHistory()
 	int index = m_project->undoStack()->index();
 	QUndoView undo_view(m_project->undoStack());
 
+	QLabel memory_label(m_undo_memory_label->toolTip());
+
 	layout.addWidget(&undo_view);
+	layout.addWidget(&memory_label);
 	layout.addWidget(&button_box);
 
 	dialog.setWindowTitle(tr("Undo/Redo History"));
@@ -874,6 +967,25 @@ void ProjectWindow::showHistory()
 }
 
 
+//! Format a number of bytes in MiB
+static QString mebibytes(qint64 bytes)
+{
+	return QObject::tr("%1 MiB").arg(bytes / 1048576.0, 0, 'f', 1);
+}
+
+void ProjectWindow::updateUndoMemoryInfo()
+{
+	UndoMemory * memory = UndoMemory::instance();
+	const QUndoStack * stack = m_project->undoStack();
+	qint64 in_memory = memory->memoryUsage(stack);
+	qint64 on_disk = memory->diskUsage(stack);
+	m_undo_memory_label->setText(tr("Undo: %1").arg(mebibytes(in_memory + on_disk)));
+	m_undo_memory_label->setToolTip(tr("Undo data of this project: %1 in memory, %2 on disk, "
+				"%3 uncompressed (memory budget for all projects: %4)")
+			.arg(mebibytes(in_memory)).arg(mebibytes(on_disk))
+			.arg(mebibytes(memory->dataSize(stack))).arg(mebibytes(memory->budget())));
+}
+
 void ProjectWindow::handleWindowsMenuAboutToShow()
 {
 	m_menus.windows->clear();
@@ -48,6 +48,7 @@ class Folder;
 class QSignalMapper;
 class AbstractPart;
 class ActionManager;
+class QLabel;
 #include "core/PartMdiView.h"
 
 //! Standard view on a Project; main window.
@@ -134,6 +135,8 @@ class ProjectWindow : public QMainWindow
 
 		void nameUndoRedo();
 		void renameUndoRedo();
+		//! Show the memory used by the undo data of the project in the status bar
+		void updateUndoMemoryInfo();
 
 	protected:
 		void handleAspectAddedInternal(const AbstractAspect *aspect);
@@ -213,6 +216,8 @@ class ProjectWindow : public QMainWindow
 		QMdiArea * m_mdi_area;
 		AbstractAspect * m_current_aspect;
 		Folder * m_current_folder;
+		//! Permanent status bar widget showing the memory used for undo
+		QLabel * m_undo_memory_label;
 
 		static ActionManager * action_manager;
 };
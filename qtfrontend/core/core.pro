@@ -81,6 +81,10 @@ HEADERS += \
 	AbstractFit.h \
 	AbstractLinearFit.h \
 	AbstractNonlinearFit.h \
+	MyParser.h \
+	FitSolver.h \
+	BatchFit.h \
+	../analysis/fit_gsl.h \
 	# TODO: port or delete the following files
 	#ApplicationWindow.h \
 	#PreferencesDialog.h \
@@ -92,7 +96,6 @@ HEADERS += \
 	#FindWindowDialog.h \
 	#Fit.h \
 	#FitDialog.h \
-	#MyParser.h \
 	#MyWidget.h \
 	#OpenProjectDialog.h \
 	#ReadOnlyTableModel.h \
@@ -107,6 +110,7 @@ SOURCES += \
 	globals.cpp \
 	AbstractFilter.cpp \
 	AbstractSimpleFilter.cpp \
+	AbstractColumn.cpp \
 	Column.cpp \
 	ColumnPrivate.cpp \
 	columncommands.cpp \
@@ -129,6 +133,10 @@ SOURCES += \
 	AbstractFit.cpp \
 	AbstractLinearFit.cpp \
 	AbstractNonlinearFit.cpp \
+	MyParser.cpp \
+	FitSolver.cpp \
+	BatchFit.cpp \
+	../analysis/fit_gsl.cpp \
 	# TODO: port or delete the following files
 	#ApplicationWindow.cpp \
 	#PreferencesDialog.cpp \
@@ -140,7 +148,6 @@ SOURCES += \
 	#Fit.cpp \
 	#FitDialog.cpp \
 	#Folder.cpp \
-	#MyParser.cpp \
 	#MyWidget.cpp \
 	#OpenProjectDialog.cpp \
 	#ReadOnlyTableModel.cpp \
@@ -162,6 +169,11 @@ SOURCES += \
     ../lib/ShortcutsDialog.cpp \
     ../lib/ConfigPageWidget.cpp \
 	../lib/XmlStreamReader.cpp \
+	../lib/ProjectArchive.cpp \
+	../lib/PageCache.cpp \
+	../lib/PagedDoubleData.cpp \
+	../lib/UndoPayload.cpp \
+	../lib/FourierTransform.cpp \
 
 HEADERS += \
 	../lib/ColorBox.h \
@@ -169,6 +181,8 @@ HEADERS += \
 	../lib/ExtensibleFileDialog.h \
 	../lib/Interval.h \
 	../lib/IntervalAttribute.h \
+	../lib/ValueSpan.h \
+	../lib/ParallelFor.h \
 	../lib/PatternBox.h \
 	../lib/SymbolDialog.h \
 	../lib/TextDialog.h \
@@ -180,4 +194,9 @@ HEADERS += \
     ../lib/ShortcutsDialog.h \
     ../lib/ConfigPageWidget.h \
 	../lib/XmlStreamReader.h \
+	../lib/ProjectArchive.h \
+	../lib/PageCache.h \
+	../lib/PagedDoubleData.h \
+	../lib/UndoPayload.h \
+	../lib/FourierTransform.h \
 
@@ -0,0 +1,111 @@
+/***************************************************************************
+    File                 : BoxStatistics.cpp
+    Project              : SciDAVis
+    Description          : Summary and order statistics of box curve values
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "BoxStatistics.h"
+
+#include <qwt_data.h>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <math.h>
+
+void BoxStatistics::invalidate()
+{
+	d_valid = false;
+	d_values.clear();
+	d_sorted_ranks.clear();
+}
+
+void BoxStatistics::update(const QwtData &data)
+{
+	int size = data.size();
+	d_values.resize(size);
+	d_sorted_ranks.clear();
+	d_valid = true;
+	d_mean = d_sd = d_min = d_max = 0;
+	if (size == 0)
+		return;
+
+	double *values = d_values.data();
+	int min_index = 0, max_index = 0;
+	double sum = 0;
+	for (int i=0; i<size; i++){
+		values[i] = data.y(i);
+		sum += values[i];
+		if (values[i] < values[min_index])
+			min_index = i;
+		if (values[i] > values[max_index])
+			max_index = i;
+	}
+	d_mean = sum/size;
+	d_min = values[min_index];
+	d_max = values[max_index];
+	double squares = 0;
+	for (int i=0; i<size; i++)
+		squares += (values[i] - d_mean)*(values[i] - d_mean);
+	d_sd = size > 1 ? sqrt(squares/(size - 1)) : 0;
+
+	// put the extremes at their sorted positions, so every later selection has a bracket
+	qSwap(values[0], values[min_index]);
+	if (max_index == 0)
+		max_index = min_index;
+	qSwap(values[size-1], values[max_index]);
+	d_sorted_ranks << 0;
+	if (size > 1)
+		d_sorted_ranks << size-1;
+}
+
+double BoxStatistics::orderStatistic(int rank)
+{
+	if (d_values.isEmpty())
+		return 0;
+	rank = qBound(0, rank, d_values.size() - 1);
+	QVector<int>::iterator upper = qLowerBound(d_sorted_ranks.begin(), d_sorted_ranks.end(), rank);
+	if (upper != d_sorted_ranks.end() && *upper == rank)
+		return d_values.at(rank);
+
+	// values between two sorted ranks lie between their values, so only this bracket needs to be partitioned
+	double *values = d_values.data();
+	int first = *(upper - 1) + 1, end = *upper;
+	std::nth_element(values + first, values + rank, values + end);
+	d_sorted_ranks.insert(upper, rank);
+	return values[rank];
+}
+
+double BoxStatistics::quantile(double f)
+{
+	int size = d_values.size();
+	if (size == 0)
+		return 0;
+	double index = qBound(0.0, f, 1.0)*(size - 1);
+	int lower = int(floor(index));
+	double delta = index - lower;
+	if (delta == 0 || lower + 1 >= size)
+		return orderStatistic(lower);
+	return (1 - delta)*orderStatistic(lower) + delta*orderStatistic(lower + 1);
+}
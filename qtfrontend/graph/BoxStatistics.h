@@ -0,0 +1,77 @@
+/***************************************************************************
+    File                 : BoxStatistics.h
+    Project              : SciDAVis
+    Description          : Summary and order statistics of box curve values
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef BOX_STATISTICS_H
+#define BOX_STATISTICS_H
+
+#include <QVector>
+
+class QwtData;
+
+//! Summary statistics and order statistics of the values of a box curve
+/**
+ * Mean, standard deviation and range are computed by update(); quantiles are selected
+ * on demand from a copy of the values with nth_element() instead of sorting them.
+ * Every selected rank stays at its sorted position and splits the copy into independent
+ * brackets, so later selections only partition the bracket containing their rank.
+ * Drawing a box with all its whiskers, percentile symbols and notches therefore costs
+ * a few linear passes over the values the first time and nothing afterwards.
+ */
+class BoxStatistics
+{
+public:
+	BoxStatistics() : d_valid(false), d_mean(0), d_sd(0), d_min(0), d_max(0) {}
+
+	//! Forget the values (to be called whenever the curve data changes)
+	void invalidate();
+	bool isValid() const {return d_valid;};
+	//! Copy the Y values of 'data' and compute mean, standard deviation and range
+	void update(const QwtData &data);
+
+	int size() const {return d_values.size();};
+	double mean() const {return d_mean;};
+	//! Sample standard deviation
+	double standardDeviation() const {return d_sd;};
+	double minimum() const {return d_min;};
+	double maximum() const {return d_max;};
+
+	//! Value at position 'rank' of the sorted values
+	double orderStatistic(int rank);
+	//! Quantile 'f' (between 0 and 1), interpolated like gsl_stats_quantile_from_sorted_data()
+	double quantile(double f);
+
+private:
+	bool d_valid;
+	double d_mean, d_sd, d_min, d_max;
+	//! Copy of the values, partially sorted
+	QVector<double> d_values;
+	//! Ascending ranks which are at their sorted position in d_values
+	QVector<int> d_sorted_ranks;
+};
+
+#endif // ifndef BOX_STATISTICS_H
@@ -0,0 +1,276 @@
+/***************************************************************************
+    File                 : ColumnQwtData.cpp
+    Project              : SciDAVis
+    Description          : QwtData view of two table columns
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "ColumnQwtData.h"
+#include "core/AbstractColumn.h"
+#include "core/column/Column.h"
+
+#include <QtAlgorithms>
+
+#include <limits.h>
+
+ColumnQwtDataGuard::ColumnQwtDataGuard(const AbstractColumn *x, const AbstractColumn *y, const AbstractColumn *filter)
+	: m_x(x), m_y(y), m_filter(filter), m_filter_destroyed(false)
+{
+	if (x)
+		connect(x, SIGNAL(aboutToBeDestroyed(const AbstractColumn *)), this, SLOT(columnDestroyed(const AbstractColumn *)));
+	if (y && y != x)
+		connect(y, SIGNAL(aboutToBeDestroyed(const AbstractColumn *)), this, SLOT(columnDestroyed(const AbstractColumn *)));
+	if (filter && filter != x && filter != y)
+		connect(filter, SIGNAL(aboutToBeDestroyed(const AbstractColumn *)), this, SLOT(columnDestroyed(const AbstractColumn *)));
+}
+
+void ColumnQwtDataGuard::columnDestroyed(const AbstractColumn *column)
+{
+	if (column == m_x) m_x = 0;
+	if (column == m_y) m_y = 0;
+	if (column == m_filter) {
+		m_filter = 0;
+		m_filter_destroyed = true;
+	}
+}
+
+ColumnQwtData::ColumnQwtData(const AbstractColumn *x, const AbstractColumn *y, int start_row, int end_row,
+		const AbstractColumn *filter)
+	: m_guard(new ColumnQwtDataGuard(x, y, filter)), m_transposed(false),
+	m_start_row(qMax(start_row, 0)), m_end_row(end_row), m_last(-1), m_first(m_start_row), m_size(0),
+	m_x_revision(0), m_y_revision(0), m_filter_revision(0), m_unchanged(0)
+{
+	m_x_numeric = x->columnMode() == SciDAVis::Numeric;
+	m_y_numeric = y->columnMode() == SciDAVis::Numeric;
+	firstChangedRow();
+	build(lastRow());
+}
+
+ColumnQwtData::ColumnQwtData(const ColumnQwtData& other)
+	: QwtData(other),
+	m_guard(new ColumnQwtDataGuard(other.m_guard->x(), other.m_guard->y(), other.m_guard->filter())),
+	m_x_numeric(other.m_x_numeric), m_y_numeric(other.m_y_numeric), m_transposed(other.m_transposed),
+	m_start_row(other.m_start_row), m_end_row(other.m_end_row), m_last(other.m_last),
+	m_invalid(other.m_invalid), m_first(other.m_first), m_size(other.m_size), m_rows(other.m_rows),
+	m_x_revision(other.m_x_revision), m_y_revision(other.m_y_revision), m_filter_revision(other.m_filter_revision),
+	m_unchanged(other.m_unchanged)
+{
+	if (!other.m_guard->isValid()) {
+		// keep the copy empty
+		delete m_guard;
+		m_guard = new ColumnQwtDataGuard(0, 0, 0);
+	}
+}
+
+ColumnQwtData& ColumnQwtData::operator=(const ColumnQwtData& other)
+{
+	if (this == &other)
+		return *this;
+	QwtData::operator=(other);
+	delete m_guard;
+	if (other.m_guard->isValid())
+		m_guard = new ColumnQwtDataGuard(other.m_guard->x(), other.m_guard->y(), other.m_guard->filter());
+	else
+		m_guard = new ColumnQwtDataGuard(0, 0, 0);
+	m_x_numeric = other.m_x_numeric;
+	m_y_numeric = other.m_y_numeric;
+	m_transposed = other.m_transposed;
+	m_start_row = other.m_start_row;
+	m_end_row = other.m_end_row;
+	m_last = other.m_last;
+	m_invalid = other.m_invalid;
+	m_first = other.m_first;
+	m_size = other.m_size;
+	m_rows = other.m_rows;
+	m_x_revision = other.m_x_revision;
+	m_y_revision = other.m_y_revision;
+	m_filter_revision = other.m_filter_revision;
+	m_unchanged = other.m_unchanged;
+	return *this;
+}
+
+ColumnQwtData::~ColumnQwtData()
+{
+	delete m_guard;
+}
+
+bool ColumnQwtData::supports(const AbstractColumn *column)
+{
+	return column && (column->columnMode() == SciDAVis::Numeric || column->columnMode() == SciDAVis::Text);
+}
+
+bool ColumnQwtData::refersTo(const AbstractColumn *x, const AbstractColumn *y, int start_row, int end_row,
+		const AbstractColumn *filter) const
+{
+	return m_guard->isValid() && m_guard->x() == x && m_guard->y() == y && m_guard->filter() == filter
+		&& m_start_row == qMax(start_row, 0) && m_end_row == end_row
+		&& m_x_numeric == (x->columnMode() == SciDAVis::Numeric)
+		&& m_y_numeric == (y->columnMode() == SciDAVis::Numeric);
+}
+
+int ColumnQwtData::lastRow() const
+{
+	const AbstractColumn *filter = m_guard->filter();
+	int last = qMin(m_end_row, qMin(m_guard->x()->rowCount(), m_guard->y()->rowCount()) - 1);
+	if (filter)
+		last = qMin(last, filter->rowCount() - 1);
+	return last;
+}
+
+QList< Interval<int> > ColumnQwtData::invalidIntervals(int last) const
+{
+	QList< Interval<int> > result;
+	if (last < m_start_row)
+		return result;
+	Interval<int> range(m_start_row, last);
+	const AbstractColumn *columns[3] = { m_guard->x(), m_guard->y(), m_guard->filter() };
+	for (int c=0; c<3; c++) {
+		if (!columns[c]) continue;
+		foreach(Interval<int> invalid, columns[c]->invalidIntervals()) {
+			Interval<int> clipped = Interval<int>::intersection(invalid, range);
+			if (clipped.isValid())
+				result << clipped;
+		}
+	}
+	return result;
+}
+
+bool ColumnQwtData::update()
+{
+	m_unchanged = 0;
+	if (!m_guard->isValid())
+		return false;
+
+	int first_changed = firstChangedRow();
+	int last = lastRow();
+	if (last < m_last || invalidIntervals(m_last) != m_invalid) {
+		// rows were removed or rows already in the view became (in)valid
+		build(last);
+		return true;
+	}
+	m_unchanged = pointsBefore(first_changed);
+	append(last);
+	return true;
+}
+
+//! First row from 'start' on of 'column' changed after '*revision' (INT_MAX if none, -1 if not known)
+static int firstChangedRow(const AbstractColumn *column, int start, int *revision)
+{
+	if (!column)
+		return INT_MAX;
+	const Column *col = dynamic_cast<const Column *>(column);
+	if (!col)
+		return -1;
+	QList< Interval<int> > rows;
+	bool known = col->changedRows(*revision, &rows);
+	*revision = col->revision();
+	if (!known)
+		return -1;
+	int first = INT_MAX;
+	foreach(Interval<int> i, rows)
+		if (i.end() >= start)
+			first = qMin(first, i.start());
+	return first;
+}
+
+int ColumnQwtData::firstChangedRow()
+{
+	int x = ::firstChangedRow(m_guard->x(), m_start_row, &m_x_revision);
+	int y = ::firstChangedRow(m_guard->y(), m_start_row, &m_y_revision);
+	int filter = ::firstChangedRow(m_guard->filter(), m_start_row, &m_filter_revision);
+	return qMin(x, qMin(y, filter));
+}
+
+size_t ColumnQwtData::pointsBefore(int row) const
+{
+	if (row == INT_MAX)
+		return m_size;
+	if (m_rows.isEmpty())
+		return (size_t)qBound(0, row - m_first, (int)m_size);
+	return qLowerBound(m_rows.constBegin(), m_rows.constEnd(), row) - m_rows.constBegin();
+}
+
+void ColumnQwtData::build(int last)
+{
+	m_last = m_start_row - 1;
+	m_invalid.clear();
+	m_first = m_start_row;
+	m_size = 0;
+	m_rows.clear();
+	append(last);
+}
+
+void ColumnQwtData::append(int last)
+{
+	if (last <= m_last)
+		return;
+
+	int from = m_last + 1;
+	QList< Interval<int> > invalid = invalidIntervals(last);
+	m_invalid = invalid;
+	m_last = last;
+
+	// invalid rows among the new ones
+	QList< Interval<int> > new_invalid;
+	foreach(Interval<int> iv, invalid)
+		if (iv.end() >= from)
+			new_invalid << Interval<int>(qMax(iv.start(), from), iv.end());
+
+	if (new_invalid.isEmpty() && m_rows.isEmpty() && (m_size == 0 || m_first + (int)m_size == from)) {
+		// still one contiguous block of valid rows
+		if (m_size == 0)
+			m_first = from;
+		m_size += last - from + 1;
+		return;
+	}
+
+	if (m_rows.isEmpty()) {
+		m_rows.reserve(m_size + last - from + 1);
+		for (size_t i=0; i<m_size; i++)
+			m_rows << m_first + (int)i;
+	}
+	for (int i=from; i<=last; i++) {
+		bool valid = true;
+		foreach(Interval<int> iv, new_invalid)
+			if (iv.contains(i)) {
+				valid = false;
+				break;
+			}
+		if (valid)
+			m_rows << i;
+	}
+	m_size = m_rows.size();
+	// keep row() cheap for the (common) case of a contiguous block of valid rows
+	if (m_size > 0 && m_rows.last() - m_rows.first() + 1 == (int)m_size) {
+		m_first = m_rows.first();
+		m_rows.clear();
+	}
+}
+
+double ColumnQwtData::value(const AbstractColumn *column, bool numeric, size_t i) const
+{
+	if (numeric)
+		return column->valueAt(row(i));
+	return (double)(i + 1);
+}
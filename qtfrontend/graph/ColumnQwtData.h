@@ -0,0 +1,164 @@
+/***************************************************************************
+    File                 : ColumnQwtData.h
+    Project              : SciDAVis
+    Description          : QwtData view of two table columns
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef COLUMN_QWT_DATA_H
+#define COLUMN_QWT_DATA_H
+
+#include <qwt_data.h>
+#include <QObject>
+#include <QVector>
+#include <QList>
+#include "lib/Interval.h"
+
+class AbstractColumn;
+
+//! Forgets about the columns of a ColumnQwtData (which is no QObject) once they are destroyed
+class ColumnQwtDataGuard : public QObject
+{
+	Q_OBJECT
+
+	public:
+		ColumnQwtDataGuard(const AbstractColumn *x, const AbstractColumn *y, const AbstractColumn *filter);
+
+		//! The columns, or 0 after one of them was destroyed
+		const AbstractColumn *x() const { return m_x; }
+		const AbstractColumn *y() const { return m_y; }
+		const AbstractColumn *filter() const { return m_filter; }
+		//! Whether all columns still exist
+		bool isValid() const { return m_x && m_y && !m_filter_destroyed; }
+
+	private slots:
+		void columnDestroyed(const AbstractColumn *column);
+
+	private:
+		const AbstractColumn *m_x;
+		const AbstractColumn *m_y;
+		const AbstractColumn *m_filter;
+		bool m_filter_destroyed;
+};
+
+//! QwtData view of two table columns
+/**
+ * Lets a plot curve read its points directly from the column storage, instead of
+ * formatting and re-parsing every cell. Only rows in the given range where both
+ * columns (and, if given, the 'filter' column) hold valid data are used. Numeric
+ * columns are read with valueAt(); for text columns, point i has the value i+1
+ * (matching the text labels set by the curve).
+ *
+ * The point-to-row index is only built if the range actually contains invalid rows,
+ * and copy() shares it implicitly, so handing the data to Qwt copies nothing.
+ * The columns are referenced, not copied: after they changed, the owner has to call
+ * update() on a copy of the data and hand it to the curve again (see DataCurve::loadData()).
+ * Once one of the columns is destroyed, the view is empty.
+ */
+class ColumnQwtData : public QwtData
+{
+	public:
+		ColumnQwtData(const AbstractColumn *x, const AbstractColumn *y, int start_row, int end_row,
+				const AbstractColumn *filter = 0);
+		ColumnQwtData(const ColumnQwtData& other);
+		ColumnQwtData& operator=(const ColumnQwtData& other);
+		~ColumnQwtData();
+
+		//! Whether this view can handle the given column (Numeric or Text mode)
+		static bool supports(const AbstractColumn *column);
+
+		//! Whether this view reads the given columns and rows
+		bool refersTo(const AbstractColumn *x, const AbstractColumn *y, int start_row, int end_row,
+				const AbstractColumn *filter = 0) const;
+		//! Catch up with changes of the columns
+		/**
+		 * Rows appended to the columns are checked and added to the view. Everything is
+		 * only rebuilt if the validity of rows already in the view changed or rows were
+		 * removed, so updating after appending to a large column costs time proportional
+		 * to the new rows plus the number of invalid intervals.
+		 * Returns false if the columns were destroyed.
+		 */
+		bool update();
+		//! Number of points at the start which the last update() left unchanged
+		/**
+		 * Only known for Column objects (see Column::changedRows()); otherwise all points
+		 * count as changed. Caches of the points can keep this many of them.
+		 */
+		size_t unchangedPoints() const { return m_unchanged; }
+
+		//! Exchange X and Y (used for horizontal bars)
+		void setTransposed(bool yes) { m_transposed = yes; }
+		bool isTransposed() const { return m_transposed; }
+
+		//! Table row of point i
+		int row(size_t i) const { return m_rows.isEmpty() ? m_first + (int)i : m_rows.at(i); }
+
+		//! \name Reimplemented from QwtData
+		//@{
+		virtual QwtData *copy() const { return new ColumnQwtData(*this); }
+		virtual size_t size() const { return m_guard->isValid() ? m_size : 0; }
+		virtual double x(size_t i) const {
+			return m_transposed ? value(m_guard->y(), m_y_numeric, i) : value(m_guard->x(), m_x_numeric, i);
+		}
+		virtual double y(size_t i) const {
+			return m_transposed ? value(m_guard->x(), m_x_numeric, i) : value(m_guard->y(), m_y_numeric, i);
+		}
+		//@}
+
+	private:
+		double value(const AbstractColumn *column, bool numeric, size_t i) const;
+		//! Last row covered by the columns and the requested range
+		int lastRow() const;
+		//! Invalid intervals of all columns, clipped to m_start_row..last
+		QList< Interval<int> > invalidIntervals(int last) const;
+		//! Index the rows m_start_row..last from scratch
+		void build(int last);
+		//! Add the rows m_last+1..last
+		void append(int last);
+		//! First row changed since the last call (INT_MAX if none); brings the m_*_revision up to date
+		int firstChangedRow();
+		//! Number of points in rows before 'row'
+		size_t pointsBefore(int row) const;
+
+		ColumnQwtDataGuard *m_guard;
+		bool m_x_numeric;
+		bool m_y_numeric;
+		bool m_transposed;
+		//! The requested range of rows
+		int m_start_row, m_end_row;
+		//! Last row examined so far
+		int m_last;
+		//! Invalid intervals of the columns within m_start_row..m_last
+		QList< Interval<int> > m_invalid;
+		int m_first;
+		size_t m_size;
+		//! Table rows of the points; empty if all rows from m_first on are used
+		QVector<int> m_rows;
+		//! Column::revision() of the columns as of the last update()
+		int m_x_revision, m_y_revision, m_filter_revision;
+		//! See unchangedPoints()
+		size_t m_unchanged;
+};
+
+#endif // ifndef COLUMN_QWT_DATA_H
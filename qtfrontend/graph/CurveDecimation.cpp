@@ -0,0 +1,180 @@
+/***************************************************************************
+    File                 : CurveDecimation.cpp
+    Project              : SciDAVis
+    Description          : Min/max pyramid for drawing curves with many points
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "CurveDecimation.h"
+
+#include <qwt_data.h>
+#include <qwt_scale_map.h>
+
+bool CurveDecimation::needsUpdate(const QwtData &data) const
+{
+	return m_dirty || (int)data.size() != m_x.size();
+}
+
+bool CurveDecimation::update(const QwtData &data)
+{
+	int size = data.size();
+	// keep the points (and pyramid blocks) the caller promised to be unchanged
+	int kept = m_valid && m_dirty ? qMin(m_unchanged, qMin(size, m_x.size())) : 0;
+	m_dirty = false;
+	m_unchanged = 0;
+	truncate(kept);
+
+	m_x.resize(size);
+	m_y.resize(size);
+	double *x = m_x.data(), *y = m_y.data();
+	m_valid = true;
+	for (int i=kept; i<size; i++) {
+		x[i] = data.x(i);
+		y[i] = data.y(i);
+		if (x[i] != x[i] || y[i] != y[i] || (i > 0 && x[i] < x[i-1])) {
+			m_valid = false;
+			m_min.clear();
+			m_max.clear();
+			return false;
+		}
+	}
+	extendLevels();
+	return true;
+}
+
+void CurveDecimation::truncate(int size)
+{
+	m_x.resize(size);
+	m_y.resize(size);
+	for (int level=1; level<=m_min.size(); level++) {
+		m_min[level-1].resize(size >> level);
+		m_max[level-1].resize(size >> level);
+	}
+	while (!m_min.isEmpty() && m_min.last().isEmpty()) {
+		m_min.resize(m_min.size()-1);
+		m_max.resize(m_max.size()-1);
+	}
+}
+
+void CurveDecimation::extendLevels()
+{
+	for (int level=1; (m_x.size() >> level) > 0; level++) {
+		if (m_min.size() < level) {
+			m_min.resize(level);
+			m_max.resize(level);
+		}
+		QVector<double> &min = m_min[level-1], &max = m_max[level-1];
+		int old_blocks = min.size(), blocks = m_x.size() >> level;
+		min.resize(blocks);
+		max.resize(blocks);
+		for (int b=old_blocks; b<blocks; b++) {
+			if (level == 1) {
+				min[b] = qMin(m_y.at(2*b), m_y.at(2*b+1));
+				max[b] = qMax(m_y.at(2*b), m_y.at(2*b+1));
+			} else {
+				const QVector<double> &child_min = m_min.at(level-2), &child_max = m_max.at(level-2);
+				min[b] = qMin(child_min.at(2*b), child_min.at(2*b+1));
+				max[b] = qMax(child_max.at(2*b), child_max.at(2*b+1));
+			}
+		}
+	}
+}
+
+void CurveDecimation::range(int first, int last, double *min, double *max) const
+{
+	*min = *max = m_y.at(first);
+	int i = first;
+	while (i <= last) {
+		// largest aligned block starting at i which ends at 'last' or before
+		int level = 0;
+		while (level < m_min.size() && (i & ((2 << level) - 1)) == 0 && i + (2 << level) - 1 <= last)
+			level++;
+		if (level == 0) {
+			*min = qMin(*min, m_y.at(i));
+			*max = qMax(*max, m_y.at(i));
+			i++;
+		} else {
+			*min = qMin(*min, m_min.at(level-1).at(i >> level));
+			*max = qMax(*max, m_max.at(level-1).at(i >> level));
+			i += 1 << level;
+		}
+	}
+}
+
+int CurveDecimation::lowerBound(double x) const
+{
+	return qLowerBound(m_x.constBegin(), m_x.constEnd(), x) - m_x.constBegin();
+}
+
+int CurveDecimation::upperBound(double x) const
+{
+	return qUpperBound(m_x.constBegin(), m_x.constEnd(), x) - m_x.constBegin();
+}
+
+int CurveDecimation::visiblePoints(const QwtScaleMap &x_map, int from, int to) const
+{
+	if (to < 0 || to >= m_x.size())
+		to = m_x.size() - 1;
+	double x1 = qMin(x_map.s1(), x_map.s2()), x2 = qMax(x_map.s1(), x_map.s2());
+	return qMin(to + 1, upperBound(x2)) - qMax(from, lowerBound(x1));
+}
+
+QPolygon CurveDecimation::polyline(const QwtScaleMap &x_map, const QwtScaleMap &y_map, int from, int to) const
+{
+	QPolygon result;
+	if (to < 0 || to >= m_x.size())
+		to = m_x.size() - 1;
+	// one point beyond the visible range on either side, so the line leaves the canvas correctly
+	double x1 = qMin(x_map.s1(), x_map.s2()), x2 = qMax(x_map.s1(), x_map.s2());
+	int first = qMax(from, lowerBound(x1) - 1);
+	int last = qMin(to, upperBound(x2));
+	if (first > last)
+		return result;
+
+	int i = first;
+	while (i <= last) {
+		int px = x_map.transform(m_x.at(i));
+		// last point in the same pixel column (X and thus the pixel are monotonic)
+		int low = i, high = last;
+		while (low < high) {
+			int middle = (low + high + 1) / 2;
+			if (x_map.transform(m_x.at(middle)) == px)
+				low = middle;
+			else
+				high = middle - 1;
+		}
+		int j = low;
+
+		result << QPoint(px, y_map.transform(m_y.at(i)));
+		if (j > i) {
+			// all points share the same x pixel, so the order of min and max does not matter
+			double min, max;
+			range(i, j, &min, &max);
+			result << QPoint(px, y_map.transform(min)) << QPoint(px, y_map.transform(max))
+				<< QPoint(px, y_map.transform(m_y.at(j)));
+		}
+		i = j + 1;
+	}
+	return result;
+}
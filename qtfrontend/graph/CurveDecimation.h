@@ -0,0 +1,108 @@
+/***************************************************************************
+    File                 : CurveDecimation.h
+    Project              : SciDAVis
+    Description          : Min/max pyramid for drawing curves with many points
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef CURVE_DECIMATION_H
+#define CURVE_DECIMATION_H
+
+#include <QVector>
+#include <QPolygon>
+
+class QwtData;
+class QwtScaleMap;
+
+//! Level-of-detail representation of a line curve with non-decreasing X values
+/**
+ * When a curve has many more points than the canvas has pixels, drawing all segments
+ * is a waste of time: the result only depends on the first, the last, the lowest
+ * and the highest point falling into each pixel column (M4 aggregation). polyline()
+ * computes these four points for every pixel column in the visible range and returns
+ * a polyline which looks the same as the complete curve, but has O(pixels) points.
+ *
+ * The pixel columns are found by binary search on X; their minimum and maximum Y
+ * are looked up in a pyramid: level k holds the minimum and maximum of aligned
+ * blocks of 2^k points, so any range of points is covered by O(log n) blocks.
+ *
+ * The pyramid is built from a copy of the curve data (see update()). If the caller
+ * knows that the new data starts with the old points (rows were appended to the
+ * columns, see invalidate()), only the new points are read and only the blocks
+ * covering them are computed.
+ */
+class CurveDecimation
+{
+	public:
+		CurveDecimation() : m_unchanged(0), m_valid(false), m_dirty(true) {}
+
+		//! Mark the pyramid for update() (to be called whenever the curve data changes)
+		/**
+		 * 'unchanged' is the number of points at the start of the data which are known
+		 * to be the same as before; update() neither reads nor re-aggregates them.
+		 */
+		void invalidate(int unchanged = 0) {
+			m_unchanged = m_dirty ? qMin(m_unchanged, unchanged) : unchanged;
+			m_dirty = true;
+		}
+		//! Whether update() has to be called before polyline()
+		bool needsUpdate(const QwtData &data) const;
+		//! Read the curve data and update the pyramid
+		/**
+		 * Returns false if the data cannot be decimated (X decreasing somewhere, or NaN values).
+		 */
+		bool update(const QwtData &data);
+		//! Whether the data passed to the last update() can be decimated
+		bool isValid() const { return m_valid; }
+		//! Number of points
+		int size() const { return m_x.size(); }
+
+		//! Return the number of points from..to which lie within the visible range of 'x_map'
+		int visiblePoints(const QwtScaleMap &x_map, int from, int to) const;
+		//! Return the decimated polyline (in paint device coordinates) for the points from..to
+		QPolygon polyline(const QwtScaleMap &x_map, const QwtScaleMap &y_map, int from, int to) const;
+
+	private:
+		//! Drop the points from 'size' on and the pyramid blocks covering them
+		void truncate(int size);
+		//! Compute the pyramid blocks which are not yet there
+		void extendLevels();
+		//! Minimum and maximum Y of the points first..last
+		void range(int first, int last, double *min, double *max) const;
+		//! Index of the first point with X >= x
+		int lowerBound(double x) const;
+		//! Index of the first point with X > x
+		int upperBound(double x) const;
+
+		//! Copy of the curve points
+		QVector<double> m_x, m_y;
+		//! Pyramid levels 1, 2, ...; level k has the complete blocks of 2^k points
+		QVector< QVector<double> > m_min, m_max;
+		//! Number of leading points passed to invalidate() since the last update()
+		int m_unchanged;
+		bool m_valid;
+		bool m_dirty;
+};
+
+#endif // ifndef CURVE_DECIMATION_H
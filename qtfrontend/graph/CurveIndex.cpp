@@ -0,0 +1,185 @@
+/***************************************************************************
+    File                 : CurveIndex.cpp
+    Project              : SciDAVis
+    Description          : Uniform grid for nearest point queries on curves
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "CurveIndex.h"
+
+#include <qwt_data.h>
+#include <qwt_scale_map.h>
+#include <qwt_math.h>
+
+#include <math.h>
+
+//! Average number of points per cell aimed at when choosing the grid size
+static const int points_per_cell = 4;
+//! Half width (in pixels) of the first square searched by closestPoint()
+static const double initial_radius = 16.0;
+
+//! False for NaN and infinite values
+static inline bool isFinite(double v)
+{
+	return v == v && v - v == 0;
+}
+
+bool CurveIndex::needsUpdate(const QwtData &data) const
+{
+	return m_dirty || (int)data.size() != m_size;
+}
+
+void CurveIndex::update(const QwtData &data)
+{
+	m_dirty = false;
+	m_size = data.size();
+	m_cell_start.clear();
+	m_points.clear();
+	m_columns = m_rows = 0;
+
+	int count = 0;
+	double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+	for (int i=0; i<m_size; i++) {
+		double x = data.x(i), y = data.y(i);
+		if (!isFinite(x) || !isFinite(y))
+			continue;
+		if (count++ == 0) {
+			x1 = x2 = x;
+			y1 = y2 = y;
+		} else {
+			x1 = qMin(x1, x);
+			x2 = qMax(x2, x);
+			y1 = qMin(y1, y);
+			y2 = qMax(y2, y);
+		}
+	}
+	if (count == 0)
+		return;
+
+	m_x0 = x1;
+	m_y0 = y1;
+	m_width = x2 - x1;
+	m_height = y2 - y1;
+	int cells_per_side = qMax(1, int(sqrt(double(count / points_per_cell))));
+	m_columns = m_width > 0 ? cells_per_side : 1;
+	m_rows = m_height > 0 ? cells_per_side : 1;
+
+	// counting sort of the point indices by cell
+	int cells = m_columns * m_rows;
+	QVector<int> cell_of(m_size, -1);
+	m_cell_start.fill(0, cells + 1);
+	for (int i=0; i<m_size; i++) {
+		double x = data.x(i), y = data.y(i);
+		if (!isFinite(x) || !isFinite(y))
+			continue;
+		cell_of[i] = cellRow(y) * m_columns + cellColumn(x);
+		m_cell_start[cell_of[i] + 1]++;
+	}
+	for (int c=0; c<cells; c++)
+		m_cell_start[c+1] += m_cell_start[c];
+	m_points.resize(count);
+	QVector<int> fill = m_cell_start;
+	for (int i=0; i<m_size; i++)
+		if (cell_of[i] >= 0)
+			m_points[fill[cell_of[i]]++] = i;
+}
+
+int CurveIndex::cellColumn(double x) const
+{
+	if (m_width <= 0)
+		return 0;
+	// clamp before converting, the query square may reach far beyond the grid
+	return int(qBound(0.0, (x - m_x0) / m_width * m_columns, double(m_columns - 1)));
+}
+
+int CurveIndex::cellRow(double y) const
+{
+	if (m_height <= 0)
+		return 0;
+	return int(qBound(0.0, (y - m_y0) / m_height * m_rows, double(m_rows - 1)));
+}
+
+int CurveIndex::closestPoint(const QwtData &data, const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		int xpos, int ypos, double *dist2) const
+{
+	if (m_points.isEmpty())
+		return -1;
+
+	// A point found within the square of half width r is the closest one only if its
+	// distance is at most r (points outside the square are farther away than r).
+	double max_radius = sqrt(*dist2);
+	double radius = qMin(initial_radius, max_radius);
+	while (true) {
+		int point = -1;
+		double d = *dist2;
+		bool complete = searchSquare(data, x_map, y_map, xpos, ypos, radius, &point, &d);
+		if (point >= 0 && (complete || d <= radius*radius)) {
+			*dist2 = d;
+			return point;
+		}
+		if (complete || radius >= max_radius)
+			return -1;
+		radius = qMin(2.0*radius, max_radius);
+	}
+}
+
+bool CurveIndex::searchSquare(const QwtData &data, const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		int xpos, int ypos, double radius, int *point, double *dist2) const
+{
+	int c1 = 0, c2 = m_columns - 1, r1 = 0, r2 = m_rows - 1;
+	double xa = x_map.invTransform(xpos - radius), xb = x_map.invTransform(xpos + radius);
+	double ya = y_map.invTransform(ypos - radius), yb = y_map.invTransform(ypos + radius);
+	// transformations may fail far outside the canvas (e.g. logarithmic scales); search everything then
+	if (isFinite(xa) && isFinite(xb)) {
+		double x1 = qMin(xa, xb), x2 = qMax(xa, xb);
+		if (x2 < m_x0 || x1 > m_x0 + m_width)
+			return false;
+		c1 = cellColumn(x1);
+		c2 = cellColumn(x2);
+	}
+	if (isFinite(ya) && isFinite(yb)) {
+		double y1 = qMin(ya, yb), y2 = qMax(ya, yb);
+		if (y2 < m_y0 || y1 > m_y0 + m_height)
+			return false;
+		r1 = cellRow(y1);
+		r2 = cellRow(y2);
+	}
+
+	const int *points = m_points.constData();
+	for (int row=r1; row<=r2; row++) {
+		int first = m_cell_start.at(row * m_columns + c1), last = m_cell_start.at(row * m_columns + c2 + 1);
+		for (int k=first; k<last; k++) {
+			int i = points[k];
+			double dx = x_map.xTransform(data.x(i)) - double(xpos);
+			double dy = y_map.xTransform(data.y(i)) - double(ypos);
+			double d = qwtSqr(dx) + qwtSqr(dy);
+			if (d < *dist2) {
+				*dist2 = d;
+				*point = i;
+			}
+		}
+	}
+	// all points have been looked at
+	return c1 == 0 && r1 == 0 && c2 == m_columns - 1 && r2 == m_rows - 1;
+}
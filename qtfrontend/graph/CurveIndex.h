@@ -0,0 +1,96 @@
+/***************************************************************************
+    File                 : CurveIndex.h
+    Project              : SciDAVis
+    Description          : Uniform grid for nearest point queries on curves
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef CURVE_INDEX_H
+#define CURVE_INDEX_H
+
+#include <QVector>
+
+class QwtData;
+class QwtScaleMap;
+
+//! Spatial index of the points of a curve, for picking points with the mouse
+/**
+ * The bounding rectangle of the curve (in data coordinates) is divided into a uniform
+ * grid of about four points per cell, and the point indices are sorted by cell.
+ * closestPoint() transforms a square of the given radius around the mouse position
+ * into data coordinates and only looks at the points in the cells it covers; distances
+ * are measured in paint device coordinates, so logarithmic scales work as well.
+ *
+ * The index is built on demand from the curve data and has to be invalidated
+ * whenever the data changes (see PlotCurve).
+ */
+class CurveIndex
+{
+	public:
+		CurveIndex() : m_dirty(true), m_size(0), m_columns(0), m_rows(0) {}
+
+		//! Mark the index for rebuilding (to be called whenever the curve data changes)
+		void invalidate() { m_dirty = true; }
+		//! Whether update() has to be called before closestPoint()
+		bool needsUpdate(const QwtData &data) const;
+		//! Rebuild the index from the curve data
+		void update(const QwtData &data);
+
+		//! Return the index of the point closest to (xpos, ypos), or -1 if there is none
+		/**
+		 * \param data the curve data the index was built from
+		 * \param x_map, y_map maps from data to paint device coordinates
+		 * \param xpos, ypos position in paint device coordinates
+		 * \param dist2 on input, only points with a squared distance below this value are
+		 * considered; on output, the squared distance of the returned point
+		 */
+		int closestPoint(const QwtData &data, const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+				int xpos, int ypos, double *dist2) const;
+
+	private:
+		//! Search the cells covered by the square of half width 'radius' around (xpos, ypos)
+		/**
+		 * Returns true if all cells of the grid have been searched.
+		 */
+		bool searchSquare(const QwtData &data, const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+				int xpos, int ypos, double radius, int *point, double *dist2) const;
+		//! Cell column containing x (clamped to the grid)
+		int cellColumn(double x) const;
+		//! Cell row containing y (clamped to the grid)
+		int cellRow(double y) const;
+
+		bool m_dirty;
+		//! Number of points of the data the index was built from
+		int m_size;
+		//! Bounding rectangle of the finite points
+		double m_x0, m_y0, m_width, m_height;
+		//! Grid dimensions
+		int m_columns, m_rows;
+		//! Points of cell c (row major) are m_points[m_cell_start[c]] ... m_points[m_cell_start[c+1]-1]
+		QVector<int> m_cell_start;
+		//! Indices of the finite points, sorted by cell
+		QVector<int> m_points;
+};
+
+#endif // ifndef CURVE_INDEX_H
@@ -28,12 +28,15 @@
  ***************************************************************************/
 #include "FunctionCurve.h"
 #include "Layer.h"
-#include "core/MyParser.h"
 
 #include <QMessageBox>
+#include <qwt_plot.h>
+#include <qwt_scale_engine.h>
+#include <qwt_scale_div.h>
 
 FunctionCurve::FunctionCurve(const char *name):
-	PlotCurve(name)
+	PlotCurve(name),
+	m_from(0), m_to(1), m_points(0)
 {
 	m_variable = "x";
 	setType(Layer::Function);
@@ -41,7 +44,8 @@ FunctionCurve::FunctionCurve(const char *name):
 
 FunctionCurve::FunctionCurve(const FunctionType& t, const char *name):
 	PlotCurve(name),
-	m_function_type(t)
+	m_function_type(t),
+	m_from(0), m_to(1), m_points(0)
 {
 	m_variable = "x";
 	setType(Layer::Function);
@@ -60,6 +64,8 @@ void FunctionCurve::copy(FunctionCurve* f)
 	m_formulas = f->formulas();
 	m_from = f->startRange();
 	m_to = f->endRange();
+	m_points = f->points();
+	m_sampler = f->m_sampler;
 }
 
 QString FunctionCurve::saveToString()
@@ -70,7 +76,7 @@ QString FunctionCurve::saveToString()
 	s += m_formulas.join(",") + "," + m_variable + ",";
 	s += QString::number(m_from,'g',15)+",";
 	s += QString::number(m_to,'g',15)+"\t";
-	s += QString::number(dataSize())+"\t\t\t";
+	s += QString::number(m_points)+"\t\t\t";
 	//the 2 last tabs are legacy code, kept for compatibility with old project files
 	return s;
 }
@@ -93,71 +99,55 @@ QString FunctionCurve::legend()
 	return label;
 }
 
+void FunctionCurve::setupSampler()
+{
+	m_sampler.setFunction((FunctionSampler::FunctionType)m_function_type, m_variable, m_formulas,
+			m_from, m_to, m_points);
+	m_sampler.setLogarithmic(logarithmicAxis(xAxis()), logarithmicAxis(yAxis()));
+}
+
 void FunctionCurve::loadData(int points)
 {
-    if (!points)
-        points = dataSize();
+	if (points > 0)
+		m_points = points;
+	if (m_points < 2)
+		return;
 
-    double X[points], Y[points];
-    double step = (m_to - m_from)/(double)(points - 1);
-    bool error = false;
+	setupSampler();
+	if (m_sampler.sample())
+		setData(m_sampler.x().constData(), m_sampler.y().constData(), m_sampler.size());
+}
 
-	if (m_function_type == Normal)
-	{
-		MyParser parser;
-		double x;
-		try
-		{
-			parser.DefineVar(m_variable.toAscii().constData(), &x);
-			parser.SetExpr(m_formulas[0].toAscii().constData());
-
-			X[0] = m_from; x = m_from; Y[0]=parser.Eval();
-			for (int i = 1; i<points; i++ )
-			{
-				x += step;
-				X[i] = x;
-				Y[i] = parser.Eval();
-			}
-		}
-		catch(mu::ParserError &)
-		{
-			error = true;
-		}
-	}
-	else if (m_function_type == Parametric || m_function_type == Polar)
-	{
-		QStringList aux = m_formulas;
-		MyParser xparser;
-		MyParser yparser;
-		double par;
-		if (m_function_type == Polar)
-		{
-			QString swap=aux[0];
-			aux[0]="("+swap+")*cos("+aux[1]+")";
-			aux[1]="("+swap+")*sin("+aux[1]+")";
-		}
-		try
-		{
-			xparser.DefineVar(m_variable.toAscii().constData(), &par);
-			yparser.DefineVar(m_variable.toAscii().constData(), &par);
-			xparser.SetExpr(aux[0].toAscii().constData());
-			yparser.SetExpr(aux[1].toAscii().constData());
-			par = m_from;
-			for (int i = 0; i<points; i++ )
-			{
-				X[i]=xparser.Eval();
-				Y[i]=yparser.Eval();
-				par+=step;
-			}
-		}
-		catch(mu::ParserError &)
-		{
-			error = true;
-		}
-	}
+bool FunctionCurve::updateSampling()
+{
+	if (!plot() || m_points < 2)
+		return false;
 
-	if (error)
-		return;
+	// resamples if the axis scales changed
+	setupSampler();
+	bool changed = m_sampler.sample();
+	if (!m_sampler.isValid())
+		return changed;
+
+	const QwtScaleDiv *xdiv = plot()->axisScaleDiv(xAxis());
+	const QwtScaleDiv *ydiv = plot()->axisScaleDiv(yAxis());
+	double x1 = m_sampler.axisX(qMin(xdiv->lBound(), xdiv->hBound()));
+	double x2 = m_sampler.axisX(qMax(xdiv->lBound(), xdiv->hBound()));
+	double y1 = m_sampler.axisY(qMin(ydiv->lBound(), ydiv->hBound()));
+	double y2 = m_sampler.axisY(qMax(ydiv->lBound(), ydiv->hBound()));
+	if (m_sampler.refine(x1, x2, y1, y2))
+		changed = true;
+	if (changed)
+		setData(m_sampler.x().constData(), m_sampler.y().constData(), m_sampler.size());
+	return changed;
+}
 
-	setData(X, Y, points);
+bool FunctionCurve::logarithmicAxis(int axis) const
+{
+	if (!plot())
+		return false;
+	QwtScaleTransformation *tr = plot()->axisScaleEngine(axis)->transformation();
+	bool log = tr->type() == QwtScaleTransformation::Log10;
+	delete tr;
+	return log;
 }
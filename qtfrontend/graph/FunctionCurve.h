@@ -30,8 +30,19 @@
 #define FUNCTIONCURVE_H
 
 #include "PlotCurve.h"
+#include "FunctionSampler.h"
 
 // Function curve class
+/**
+ * The function is sampled adaptively by a FunctionSampler, starting from points() equally
+ * spaced values of the variable. Samples are cached. Loading the data again with unchanged
+ * formulas, range, number of points and axis scales doesn't evaluate anything; after zooming
+ * into a part of the curve only the segments within the visible area are refined further
+ * (see updateSampling()).
+ *
+ * \note FunctionCurve and Layer are not part of the build yet (see the list of files to be
+ * ported in graph.pro); the sampling itself is built and tested as FunctionSampler.
+ */
 class FunctionCurve: public PlotCurve
 {
 public:
@@ -64,13 +75,31 @@ public:
 	//! Returns a string that can be displayed in a plot legend
 	QString legend();
 
+	//! Number of equally spaced samples the adaptive sampling starts from
+	int points(){return m_points;};
+
+	//! Sample the function, starting from 'points' equally spaced values (the last number used if 0)
 	void loadData(int points = 0);
+	//! Refine the samples within the visible area of the plot (after zooming or changing the scales)
+	/**
+	 * Returns true if the curve data was changed.
+	 */
+	bool updateSampling();
 
 private:
+	//! Whether the x/y axis of the plot is logarithmic
+	bool logarithmicAxis(int axis) const;
+	//! Pass the function and the axis scales to m_sampler
+	void setupSampler();
+
 	FunctionType m_function_type;
 	QString m_variable;
 	QStringList m_formulas;
 	double m_from, m_to;
+	int m_points;
+
+	//! The samples, cached between calls of loadData()
+	FunctionSampler m_sampler;
 };
 
 #endif
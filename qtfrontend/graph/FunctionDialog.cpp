@@ -208,7 +208,7 @@ void FunctionDialog::setCurveToModify(Layer *layer, int curve)
 		boxFunction->setText(formulas[0]);
 		boxFrom->setText(QString::number(c->startRange(), 'g', 15));
 		boxTo->setText(QString::number(c->endRange(), 'g', 15));
-		boxPoints->setValue(c->dataSize());
+		boxPoints->setValue(c->points());
 	}
 	else if (c->functionType() == FunctionCurve::Polar)
 	{
@@ -220,7 +220,7 @@ void FunctionDialog::setCurveToModify(Layer *layer, int curve)
 		boxPolarParameter->setText(c->variable());
 		boxPolarFrom->setText(QString::number(c->startRange(), 'g', 15));
 		boxPolarTo->setText(QString::number(c->endRange(), 'g', 15));
-		boxPolarPoints->setValue(c->dataSize());
+		boxPolarPoints->setValue(c->points());
 	}
 	else if (c->functionType() == FunctionCurve::Parametric)
 	{
@@ -232,7 +232,7 @@ void FunctionDialog::setCurveToModify(Layer *layer, int curve)
 		boxParameter->setText(c->variable());
 		boxParFrom->setText(QString::number(c->startRange(), 'g', 15));
 		boxParTo->setText(QString::number(c->endRange(), 'g', 15));
-		boxParPoints->setValue(c->dataSize());
+		boxParPoints->setValue(c->points());
 	}
 }
 
@@ -0,0 +1,405 @@
+/***************************************************************************
+    File                 : FunctionSampler.cpp
+    Project              : SciDAVis
+    Description          : Adaptive sampling of function curves
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "FunctionSampler.h"
+#include "core/MyParser.h"
+
+#include <math.h>
+
+//! Maximum distance of the curve from its chords, relative to the size of the plot
+static const double relative_tolerance = 1e-3;
+//! Segments longer than this (relative to the size of the plot) are split in any case
+/**
+ * The midpoint alone can't tell rapid oscillations from steep but straight segments.
+ */
+static const double max_chord = 0.1;
+//! Segments shorter than this part of the visible range of the variable are not split any more
+static const double min_segment = 1.0 / (1 << 20);
+//! Refinement stops when the curve has this many samples (or four times the initial number)
+static const int max_samples = 1 << 16;
+
+//! False for NaN and infinite values
+static inline bool isFinite(double v)
+{
+	return v == v && v - v == 0;
+}
+
+FunctionSampler::FunctionSampler()
+	: m_function_type(Normal), m_from(0), m_to(1), m_points(0), m_log_x(false), m_log_y(false),
+	m_evaluations(0)
+{
+	m_variable = "x";
+}
+
+void FunctionSampler::setFunction(FunctionType type, const QString& variable, const QStringList& formulas,
+		double from, double to, int points)
+{
+	m_function_type = type;
+	m_variable = variable;
+	m_formulas = formulas;
+	m_from = from;
+	m_to = to;
+	m_points = points;
+}
+
+void FunctionSampler::setLogarithmic(bool log_x, bool log_y)
+{
+	m_log_x = log_x;
+	m_log_y = log_y;
+}
+
+QString FunctionSampler::key() const
+{
+	QStringList key;
+	key << QString::number(m_function_type) << m_variable << m_formulas;
+	key << QString::number(m_from, 'g', 17) << QString::number(m_to, 'g', 17);
+	key << QString::number(m_points) << QString::number(m_log_x) << QString::number(m_log_y);
+	return key.join("\n");
+}
+
+bool FunctionSampler::sample()
+{
+	if (m_points < 2)
+		return false;
+	QString new_key = key();
+	if (new_key == m_sampling_key)
+		return false;
+
+	m_sampling_key = QString();
+	if (!sampleUniformly())
+		return false;
+	m_sampling_key = new_key;
+
+	// tolerances relative to the bounding rectangle of the initial samples; peaks and edges of
+	// the domain may lie outside of it, so every segment is considered visible
+	bool empty = true;
+	double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+	for (int i=0; i<m_t.size(); i++) {
+		double x = axisX(m_x[i]), y = axisY(m_y[i]);
+		if (!isFinite(x) || !isFinite(y))
+			continue;
+		if (empty) {
+			x1 = x2 = x;
+			y1 = y2 = y;
+			empty = false;
+		} else {
+			x1 = qMin(x1, x);
+			x2 = qMax(x2, x);
+			y1 = qMin(y1, y);
+			y2 = qMax(y2, y);
+		}
+	}
+	if (!empty)
+		refineView(-HUGE_VAL, HUGE_VAL, -HUGE_VAL, HUGE_VAL, x2 - x1, y2 - y1);
+	return true;
+}
+
+bool FunctionSampler::evaluate(const QVector<double>& t, QVector<double>& x, QVector<double>& y)
+{
+	int n = t.size();
+	x.resize(n);
+	y.resize(n);
+	if (n == 0)
+		return true;
+
+	const double *pt = t.constData();
+	double *px = x.data(), *py = y.data();
+	double par;
+	try
+	{
+		if (m_function_type == Normal)
+		{
+			MyParser parser;
+			parser.DefineVar(m_variable.toAscii().constData(), &par);
+			parser.SetExpr(m_formulas[0].toAscii().constData());
+			for (int i = 0; i<n; i++)
+			{
+				par = pt[i];
+				px[i] = par;
+				py[i] = parser.Eval();
+			}
+		}
+		else
+		{
+			QStringList aux = m_formulas;
+			if (m_function_type == Polar)
+			{
+				QString swap=aux[0];
+				aux[0]="("+swap+")*cos("+aux[1]+")";
+				aux[1]="("+swap+")*sin("+aux[1]+")";
+			}
+			MyParser xparser;
+			MyParser yparser;
+			xparser.DefineVar(m_variable.toAscii().constData(), &par);
+			yparser.DefineVar(m_variable.toAscii().constData(), &par);
+			xparser.SetExpr(aux[0].toAscii().constData());
+			yparser.SetExpr(aux[1].toAscii().constData());
+			for (int i = 0; i<n; i++)
+			{
+				par = pt[i];
+				px[i] = xparser.Eval();
+				py[i] = yparser.Eval();
+			}
+		}
+	}
+	catch(mu::ParserError &)
+	{
+		return false;
+	}
+	m_evaluations += n;
+	return true;
+}
+
+bool FunctionSampler::logSampling() const
+{
+	return m_function_type == Normal && m_log_x && m_from > 0 && m_to > 0;
+}
+
+double FunctionSampler::midpoint(int i) const
+{
+	if (logSampling())
+		return sqrt(m_t[i] * m_t[i+1]);
+	return 0.5 * (m_t[i] + m_t[i+1]);
+}
+
+double FunctionSampler::parameter(int i) const
+{
+	return logSampling() ? log10(m_t[i]) : m_t[i];
+}
+
+double FunctionSampler::axisX(double x) const
+{
+	if (m_log_x)
+		return x > 0 ? log10(x) : NAN;
+	return x;
+}
+
+double FunctionSampler::axisY(double y) const
+{
+	if (m_log_y)
+		return y > 0 ? log10(y) : NAN;
+	return y;
+}
+
+bool FunctionSampler::sampleUniformly()
+{
+	// equally spaced on the x axis, also for logarithmic scales
+	bool log = logSampling();
+	double from = log ? log10(m_from) : m_from;
+	double to = log ? log10(m_to) : m_to;
+	double step = (to - from)/(double)(m_points - 1);
+
+	QVector<double> t(m_points);
+	for (int i = 0; i<m_points; i++)
+		t[i] = log ? pow(10.0, from + i*step) : from + i*step;
+	t[0] = m_from;
+	t[m_points - 1] = m_to;
+
+	QVector<double> x, y;
+	if (!evaluate(t, x, y))
+		return false;
+
+	m_t = t;
+	m_x = x;
+	m_y = y;
+	m_probed.fill(false, m_points - 1);
+	m_probe_x.fill(0.0, m_points - 1);
+	m_probe_y.fill(0.0, m_points - 1);
+	return true;
+}
+
+bool FunctionSampler::segmentVisible(int i, double x1, double x2, double y1, double y2) const
+{
+	bool found = false;
+	double xa = 0, xb = 0, ya = 0, yb = 0;
+	for (int k=0; k<2; k++) {
+		double x = axisX(m_x[i+k]), y = axisY(m_y[i+k]);
+		if (!isFinite(x) || !isFinite(y))
+			continue;
+		if (!found) {
+			xa = xb = x;
+			ya = yb = y;
+			found = true;
+		} else {
+			xa = qMin(xa, x);
+			xb = qMax(xb, x);
+			ya = qMin(ya, y);
+			yb = qMax(yb, y);
+		}
+	}
+	return found && xb >= x1 && xa <= x2 && yb >= y1 && ya <= y2;
+}
+
+bool FunctionSampler::needsSplit(int i, double xtol, double ytol) const
+{
+	double ax = axisX(m_x[i]), ay = axisY(m_y[i]);
+	double bx = axisX(m_x[i+1]), by = axisY(m_y[i+1]);
+	double mx = axisX(m_probe_x[i]), my = axisY(m_probe_y[i]);
+	bool a_ok = isFinite(ax) && isFinite(ay);
+	bool b_ok = isFinite(bx) && isFinite(by);
+	bool m_ok = isFinite(mx) && isFinite(my);
+	// look for the edges of the domain of definition and for holes in it
+	if (!a_ok || !b_ok || !m_ok)
+		return a_ok || b_ok || m_ok;
+
+	// distance of the midpoint from the chord, in units of the tolerance
+	double ux = (bx - ax)/xtol, uy = (by - ay)/ytol;
+	double vx = (mx - ax)/xtol, vy = (my - ay)/ytol;
+	double len2 = ux*ux + uy*uy;
+	double max_len = max_chord / relative_tolerance;
+	if (len2 > max_len*max_len)
+		return true;
+	double s = len2 > 0 ? qBound(0.0, (vx*ux + vy*uy)/len2, 1.0) : 0.0;
+	double dx = vx - s*ux, dy = vy - s*uy;
+	return dx*dx + dy*dy > 1.0;
+}
+
+bool FunctionSampler::refine(double x1, double x2, double y1, double y2)
+{
+	if (!isValid())
+		return false;
+	return refineView(x1, x2, y1, y2, x2 - x1, y2 - y1);
+}
+
+bool FunctionSampler::refineView(double x1, double x2, double y1, double y2, double width, double height)
+{
+	double xtol = relative_tolerance * width;
+	double ytol = relative_tolerance * height;
+	if (!(xtol > 0))
+		xtol = relative_tolerance;
+	if (!(ytol > 0))
+		ytol = relative_tolerance;
+	int limit = qMax(max_samples, 4*m_points);
+
+	// the shortest segment which may still be split, relative to the visible range of the variable
+	bool visible = false;
+	double p1 = 0, p2 = 0;
+	for (int i=0; i<m_t.size()-1; i++)
+		if (segmentVisible(i, x1, x2, y1, y2)) {
+			if (!visible)
+				p1 = parameter(i);
+			p2 = parameter(i+1);
+			visible = true;
+		}
+	if (!visible)
+		return false;
+	double min_length = min_segment * (p2 - p1);
+
+	bool changed = false;
+	while (true) {
+		int n = m_t.size();
+
+		// segments which may be split: visible, long enough and with room for a midpoint
+		QVector<bool> splittable(n-1, false);
+		for (int i=0; i<n-1; i++) {
+			double t = midpoint(i);
+			splittable[i] = parameter(i+1) - parameter(i) > min_length && t > m_t[i] && t < m_t[i+1]
+				&& segmentVisible(i, x1, x2, y1, y2);
+		}
+
+		// evaluate the midpoints of these segments which haven't been looked at yet
+		QVector<int> probe;
+		QVector<double> t;
+		for (int i=0; i<n-1; i++)
+			if (splittable[i] && !m_probed[i]) {
+				probe << i;
+				t << midpoint(i);
+			}
+		QVector<double> x, y;
+		if (!evaluate(t, x, y))
+			break;
+		for (int k=0; k<probe.size(); k++) {
+			m_probe_x[probe[k]] = x[k];
+			m_probe_y[probe[k]] = y[k];
+			m_probed[probe[k]] = true;
+		}
+
+		QVector<bool> deviates(n-1, false);
+		for (int i=0; i<n-1; i++)
+			deviates[i] = splittable[i] && needsSplit(i, xtol, ytol);
+
+		// The midpoint can't see the deviation of a segment centred on an inflection point.
+		// Keeping neighbouring segments within a factor of two in length lets the refinement
+		// at the bends spread to them.
+		QVector<int> split;
+		for (int i=0; i<n-1 && n + split.size() < limit; i++) {
+			bool graded = false;
+			if (splittable[i] && !deviates[i]) {
+				double length = parameter(i+1) - parameter(i);
+				for (int j=i-1; j<=i+1; j+=2) {
+					if (j < 0 || j >= n-1)
+						continue;
+					double neighbour = parameter(j+1) - parameter(j);
+					if (deviates[j])
+						neighbour /= 2;
+					if (length > 2*neighbour)
+						graded = true;
+				}
+			}
+			if (deviates[i] || graded)
+				split << i;
+		}
+		if (split.isEmpty())
+			break;
+
+		// insert the midpoints of the split segments as new samples
+		int m = n + split.size();
+		QVector<double> new_t(m), new_x(m), new_y(m), probe_x(m-1), probe_y(m-1);
+		QVector<bool> probed(m-1);
+		int j = 0, k = 0;
+		for (int i=0; i<n; i++) {
+			new_t[j] = m_t[i];
+			new_x[j] = m_x[i];
+			new_y[j] = m_y[i];
+			if (i == n-1)
+				break;
+			if (k < split.size() && split[k] == i) {
+				probed[j] = probed[j+1] = false;
+				j++;
+				new_t[j] = midpoint(i);
+				new_x[j] = m_probe_x[i];
+				new_y[j] = m_probe_y[i];
+				k++;
+			} else {
+				probed[j] = m_probed[i];
+				probe_x[j] = m_probe_x[i];
+				probe_y[j] = m_probe_y[i];
+			}
+			j++;
+		}
+		m_t = new_t;
+		m_x = new_x;
+		m_y = new_y;
+		m_probed = probed;
+		m_probe_x = probe_x;
+		m_probe_y = probe_y;
+		changed = true;
+	}
+	return changed;
+}
@@ -0,0 +1,128 @@
+/***************************************************************************
+    File                 : FunctionSampler.h
+    Project              : SciDAVis
+    Description          : Adaptive sampling of function curves
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef FUNCTION_SAMPLER_H
+#define FUNCTION_SAMPLER_H
+
+#include <QVector>
+#include <QStringList>
+
+//! Adaptive sampling of the curve of a function, independent of the plot showing it
+/**
+ * The function is first evaluated at points() equally spaced values of the variable
+ * (equally spaced on the axis if x is logarithmic). Then every segment whose chord deviates
+ * too much from the function, judged by the value at its midpoint, is split into halves
+ * until the curve is accurate to about 1/1000 of the plot size. Flat parts of the curve
+ * thus keep their initial samples, while bends, peaks, discontinuities and the edges of
+ * the domain of definition get as many samples as they need. Deviations are measured in
+ * axis coordinates, i.e. after taking the logarithm on logarithmic axes.
+ *
+ * The samples are cached under key(). sample() doesn't evaluate anything as long as the
+ * function, range, number of points and axis scales stay the same; refine() only splits
+ * the segments within the visible area and keeps all values computed so far. How finely
+ * a segment may be split depends on the visible part of the curve, so zooming in refines
+ * further.
+ */
+class FunctionSampler
+{
+public:
+	enum FunctionType{Normal = 0, Parametric = 1, Polar = 2};
+
+	FunctionSampler();
+
+	//! Set the function; the samples are computed again by the next sample() if anything changed
+	void setFunction(FunctionType type, const QString& variable, const QStringList& formulas,
+			double from, double to, int points);
+	//! Set whether the x and y axes are logarithmic
+	void setLogarithmic(bool log_x, bool log_y);
+	//! String identifying everything the samples depend on
+	QString key() const;
+
+	//! Sample uniformly and refine relative to the bounding rectangle, unless key() is unchanged
+	/**
+	 * Returns true if the samples were changed.
+	 */
+	bool sample();
+	//! Split the segments intersecting the view (in axis coordinates) until they are accurate enough
+	/**
+	 * Returns true if the samples were changed.
+	 */
+	bool refine(double x1, double x2, double y1, double y2);
+	//! Whether there are samples for the current key() (false if the formulas can't be evaluated)
+	bool isValid() const { return !m_sampling_key.isEmpty() && m_sampling_key == key(); }
+
+	//! Number of equally spaced samples the sampling starts from
+	int points() const { return m_points; }
+	int size() const { return m_t.size(); }
+	//! The samples, sorted by the value of the variable
+	const QVector<double>& t() const { return m_t; }
+	const QVector<double>& x() const { return m_x; }
+	const QVector<double>& y() const { return m_y; }
+	//! Number of times the formulas were evaluated so far
+	int evaluations() const { return m_evaluations; }
+
+	//! Transform a value to (linear) axis coordinates
+	double axisX(double x) const;
+	double axisY(double y) const;
+
+private:
+	//! Evaluate the curve at the parameter values 't'
+	bool evaluate(const QVector<double>& t, QVector<double>& x, QVector<double>& y);
+	//! Replace the samples by m_points equally spaced ones
+	bool sampleUniformly();
+	//! Whether segment i has to be split, given the tolerances in axis coordinates
+	bool needsSplit(int i, double xtol, double ytol) const;
+	//! Whether the segments of the initial sampling are equally long on a logarithmic x axis
+	bool logSampling() const;
+	//! Value of the variable halfway between samples i and i+1
+	double midpoint(int i) const;
+	//! Sample i's value of the variable in the coordinate in which the initial samples are equally spaced
+	double parameter(int i) const;
+	//! Split the segments intersecting the view, with tolerances relative to 'width' and 'height'
+	bool refineView(double x1, double x2, double y1, double y2, double width, double height);
+	//! Whether the finite samples of segment i lie (partly) within 'view' (in axis coordinates)
+	bool segmentVisible(int i, double x1, double x2, double y1, double y2) const;
+
+	FunctionType m_function_type;
+	QString m_variable;
+	QStringList m_formulas;
+	double m_from, m_to;
+	int m_points;
+	bool m_log_x, m_log_y;
+
+	//! Result of key() when the samples were computed
+	QString m_sampling_key;
+	QVector<double> m_t, m_x, m_y;
+	//! Value at the midpoint of segment i, if m_probed[i]
+	QVector<double> m_probe_x, m_probe_y;
+	QVector<bool> m_probed;
+	int m_evaluations;
+};
+
+#endif // ifndef FUNCTION_SAMPLER_H
@@ -1367,6 +1367,7 @@ void Layer::setScale(int axis, double start, double end, double step, int majorT
   	    updateSecondaryAxis(QwtPlot::yRight);
   	}
 
+	updateFunctionCurves();
 	m_plot->replot();
 	//keep markers on canvas area
 	updateMarkersBoundingRect();
@@ -3750,6 +3751,8 @@ bool Layer::zoomOn()
 
 void Layer::zoomed (const QwtDoubleRect &)
 {
+	if (updateFunctionCurves())
+		m_plot->replot();
 	emit modified();
 }
 
@@ -3889,7 +3892,7 @@ void Layer::modifyFunctionCurve(int curve, int type, const QStringList &formulas
 		c->formulas() == formulas &&
 		c->startRange() == ranges[0] &&
 		c->endRange() == ranges[1] &&
-		c->dataSize() == points)
+		c->points() == points)
 		return;
 
 	QString oldLegend = c->legend();
@@ -3934,6 +3937,21 @@ QString Layer::generateFunctionName(const QString& name)
   	return newName;
 }
 
+bool Layer::updateFunctionCurves()
+{
+	bool changed = false;
+	QList<int> keys = m_plot->curveKeys();
+	for (int i=0; i<(int)keys.count(); i++)
+	{
+		QwtPlotItem *it = m_plot->plotItem(keys[i]);
+		if (!it || it->rtti() == QwtPlotItem::Rtti_PlotSpectrogram)
+			continue;
+		if (((PlotCurve *)it)->type() == Function && ((FunctionCurve *)it)->updateSampling())
+			changed = true;
+	}
+	return changed;
+}
+
 void Layer::addFunctionCurve(int type, const QStringList &formulas, const QString &var,
 		QList<double> &ranges, int points, const QString& title)
 {
@@ -5099,6 +5117,11 @@ void Layer::restoreSpectrogram(ApplicationWindow *app, const QStringList& lst)
             int mode = s.remove("<Image>").remove("</Image>").trimmed().toInt();
             sp->setDisplayMode(QwtPlotSpectrogram::ImageMode, mode);
         }
+        else if (s.contains("<Sampling>"))
+        {
+            int sampling = s.remove("<Sampling>").remove("</Sampling>").trimmed().toInt();
+            sp->setSampling((SpectrogramRaster::Sampling)sampling);
+        }
         else if (s.contains("<ContourLines>"))
         {
             int contours = s.remove("<ContourLines>").remove("</ContourLines>").trimmed().toInt();
@@ -592,6 +592,8 @@ class Layer: public QWidget
 		void insertFunctionCurve(const QString& formula, int points, int fileVersion);
 		//! Returns an unique function name
         QString generateFunctionName(const QString& name = tr("F"));
+		//! Refine the sampling of the function curves to the visible area; returns true if any curve changed
+		bool updateFunctionCurves();
 		//@}
 
         //! Provided for convenience in scripts.
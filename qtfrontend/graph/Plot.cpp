@@ -431,17 +431,14 @@ int Plot::closestCurve(int xpos, int ypos, int &dist, int &point)
 		if(item->rtti() != QwtPlotItem::Rtti_PlotSpectrogram)
 		{
 			PlotCurve *c = (PlotCurve *)item;
-			for (int i=0; i<c->dataSize(); i++)
+			if (c->type() == Layer::ErrorBars)
+				continue;
+			// only points closer than the best one found so far are looked at
+			int i = c->closestPoint(map[c->xAxis()], map[c->yAxis()], xpos, ypos, &dmin);
+			if (i >= 0)
 			{
-				double cx = map[c->xAxis()].xTransform(c->x(i)) - double(xpos);
-				double cy = map[c->yAxis()].xTransform(c->y(i)) - double(ypos);
-				double f = qwtSqr(cx) + qwtSqr(cy);
-				if (f < dmin && c->type() != Layer::ErrorBars)
-				{
-					dmin = f;
-					key = iter.key();
-					point = i;
-				}
+				key = iter.key();
+				point = i;
 			}
 		}
 	}
@@ -27,6 +27,7 @@
  *                                                                         *
  ***************************************************************************/
 #include "PlotCurve.h"
+#include "ColumnQwtData.h"
 #include "ScaleDraw.h"
 #include "Layer.h"
 #include "table/Table.h"
@@ -34,10 +35,16 @@
 #include <QDateTime>
 #include <QMessageBox>
 #include <QVarLengthArray>
+#include <QPainter>
 #include <qwt_symbol.h>
+#include <qwt_painter.h>
+
+//! Curves with more points than this are drawn through a CurveDecimation (if possible)
+static const int decimation_threshold = 4096;
 
 DataCurve::DataCurve(Table *t, const QString& xColName, const char *name, int startRow, int endRow):
     PlotCurve(name),
+	m_unchanged_points(0),
 	m_table(t),
 	m_x_column(xColName),
 	m_start_row(startRow),
@@ -119,6 +126,25 @@ bool DataCurve::updateData(Table *t, const QString& colName)
 	return true;
 }
 
+void DataCurve::draw(QPainter *painter, const QwtScaleMap &xMap, const QwtScaleMap &yMap, int from, int to) const
+{
+	if (style() == QwtPlotCurve::Lines && symbol().style() == QwtSymbol::NoSymbol
+			&& !testCurveAttribute(QwtPlotCurve::Fitted) && brush().style() == Qt::NoBrush
+			&& (int)dataSize() > decimation_threshold){
+		if (m_decimation.needsUpdate(data()))
+			m_decimation.update(data());
+		// M4 decimation only pays off with several points per pixel column
+		if (m_decimation.isValid() && m_decimation.visiblePoints(xMap, from, to) > 4*qAbs(xMap.p2() - xMap.p1())){
+			painter->save();
+			painter->setPen(pen());
+			QwtPainter::drawPolyline(painter, m_decimation.polyline(xMap, yMap, from, to));
+			painter->restore();
+			return;
+		}
+	}
+	PlotCurve::draw(painter, xMap, yMap, from, to);
+}
+
 void DataCurve::loadData()
 {
 	Layer *g = (Layer *)plot()->parent();
@@ -133,6 +159,13 @@ void DataCurve::loadData()
 		return;
 	}
 
+	Column *x_col = m_table->column(xcol);
+	Column *y_col = m_table->column(ycol);
+	if (ColumnQwtData::supports(x_col) && ColumnQwtData::supports(y_col)){
+		loadColumnData(g, x_col, y_col);
+		return;
+	}
+
 	int r = abs(m_end_row - m_start_row) + 1;
     QVarLengthArray<double> X(r), Y(r);
 	int xColType = m_table->columnType(xcol);
@@ -243,6 +276,43 @@ void DataCurve::loadData()
 	}
 }
 
+void DataCurve::loadColumnData(Layer *g, Column *x_col, Column *y_col)
+{
+	// after appending to the columns, only the new rows need to be checked
+	const ColumnQwtData *current = dynamic_cast<const ColumnQwtData *>(&this->data());
+	ColumnQwtData data = current && current->refersTo(x_col, y_col, m_start_row, m_end_row) ?
+		*current : ColumnQwtData(x_col, y_col, m_start_row, m_end_row);
+	data.update();
+	if (!data.size()){
+		remove();
+		return;
+	}
+
+	data.setTransposed(m_type == Layer::HorizontalBars);
+	// the decimation only needs to read the points after the first changed row
+	m_unchanged_points = current && current->isTransposed() == data.isTransposed() ? (int)data.unchangedPoints() : 0;
+	setData(data);
+	foreach(DataCurve *c, m_error_bars)
+		c->setData(data);
+
+	if (x_col->columnMode() == SciDAVis::Text){
+		QStringList xLabels;
+		for (size_t i = 0; i < data.size(); i++)
+			xLabels << x_col->textAt(data.row(i));
+		if (m_type == Layer::HorizontalBars)
+			g->setLabelsTextFormat(QwtPlot::yLeft, Layer::Txt, m_x_column, xLabels);
+		else
+			g->setLabelsTextFormat(QwtPlot::xBottom, Layer::Txt, m_x_column, xLabels);
+	}
+
+	if (y_col->columnMode() == SciDAVis::Text){
+		QStringList yLabels;
+		for (size_t i = 0; i < data.size(); i++)
+			yLabels << y_col->textAt(data.row(i));
+		g->setLabelsTextFormat(QwtPlot::yLeft, Layer::Txt, title().text(), yLabels);
+	}
+}
+
 void DataCurve::removeErrorBars(DataCurve *c)
 {
 	if (!c || m_error_bars.isEmpty())
@@ -283,6 +353,14 @@ int DataCurve::tableRow(int point)
     if (!m_table)
         return -1;
 
+	// curves reading the columns directly know their rows
+	const ColumnQwtData *column_data = dynamic_cast<const ColumnQwtData *>(&data());
+	if (column_data){
+		if (point < 0 || point >= (int)column_data->size())
+			return -1;
+		return column_data->row(point);
+	}
+
 	int xcol = m_table->colIndex(m_x_column);
 	int ycol = m_table->colIndex(title().text());
 
@@ -350,3 +428,28 @@ QwtDoubleRect PlotCurve::boundingRect() const
 
     return QwtDoubleRect(m_x_left, m_y_top, qAbs(m_x_right - m_x_left), qAbs(m_y_bottom - m_y_top));
 }
+
+int PlotCurve::closestPoint(const QwtScaleMap &xMap, const QwtScaleMap &yMap, int xpos, int ypos, double *dist2) const
+{
+	if (m_index.needsUpdate(data()))
+		m_index.update(data());
+	return m_index.closestPoint(data(), xMap, yMap, xpos, ypos, dist2);
+}
+
+void PlotCurve::itemChanged()
+{
+	dataChanged();
+	QwtPlotCurve::itemChanged();
+}
+
+void PlotCurve::dataChanged()
+{
+	m_index.invalidate();
+}
+
+void DataCurve::dataChanged()
+{
+	PlotCurve::dataChanged();
+	m_decimation.invalidate(m_unchanged_points);
+	m_unchanged_points = 0;
+}
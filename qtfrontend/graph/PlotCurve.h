@@ -30,8 +30,12 @@
 #define PLOTCURVE_H
 
 #include <qwt_plot_curve.h>
+#include "CurveDecimation.h"
+#include "CurveIndex.h"
 
 class Table;
+class Column;
+class Layer;
 
 //! Abstract 2D plot curve class
 class PlotCurve: public QwtPlotCurve
@@ -45,8 +49,28 @@ public:
 
 	QwtDoubleRect boundingRect() const;
 
+	//! Return the index of the point closest to (xpos, ypos) (in paint device coordinates), or -1 if there is none
+	/**
+	 * Only points with a squared distance below *dist2 are considered; on return, *dist2 holds
+	 * the squared distance of the point found.
+	 */
+	int closestPoint(const QwtScaleMap &xMap, const QwtScaleMap &yMap, int xpos, int ypos, double *dist2) const;
+
+	//! Reimplemented from QwtPlotItem to call dataChanged()
+	/**
+	 * All QwtPlotCurve::setData() and setRawData() variants end up here (they are not virtual,
+	 * so hiding them would miss calls through a QwtPlotCurve pointer). Changes of the pen,
+	 * style etc. are reported as well, which only costs a rebuild of the caches on demand.
+	 */
+	virtual void itemChanged();
+
 protected:
+	//! Called whenever the data may have been replaced; reimplementations must call the base class version
+	virtual void dataChanged();
+
 	int m_type;
+	//! Spatial index of the curve points; built on demand by closestPoint()
+	mutable CurveIndex m_index;
 };
 
 class DataCurve: public PlotCurve
@@ -105,6 +129,21 @@ public:
 	void setVisible(bool on);
 
 protected:
+	//! Reimplemented from PlotCurve to reset m_decimation
+	virtual void dataChanged();
+
+	//! Draw plain line curves with many more points than pixels through m_decimation
+	virtual void draw(QPainter *painter, const QwtScaleMap &xMap,
+		const QwtScaleMap &yMap, int from, int to) const;
+
+	//! Read numeric and text columns directly through a ColumnQwtData, without text conversion.
+	void loadColumnData(Layer *g, Column *x_col, Column *y_col);
+
+	//! Level-of-detail pyramid of the curve points; built on demand by draw()
+	mutable CurveDecimation m_decimation;
+	//! Number of leading points the next dataChanged() keeps in m_decimation; set by loadColumnData()
+	int m_unchanged_points;
+
 	//! List of the error bar curves associated to this curve.
 	QList <DataCurve *> m_error_bars;
 	//! The data source table.
@@ -14,14 +14,26 @@ FORMS += GraphConfigPage.ui
 
 
 SOURCES += \
+	BoxStatistics.cpp \
+	ColumnQwtData.cpp \
+	CurveDecimation.cpp \
+	CurveIndex.cpp \
+	FunctionSampler.cpp \
 	Graph.cpp \
 	GraphModule.cpp \
 	GraphView.cpp \
+	types/SpectrogramRaster.cpp \
 
 HEADERS += \
+	BoxStatistics.h \
+	ColumnQwtData.h \
+	CurveDecimation.h \
+	CurveIndex.h \
+	FunctionSampler.h \
 	Graph.h \
 	GraphModule.h \
 	GraphView.h \
+	types/SpectrogramRaster.h \
 
 ### TODO: port or remove the following files
 #SOURCES += \
@@ -67,7 +79,6 @@ HEADERS += \
 #	AbstractEnrichment.h \
 #	AbstractGraphTool.h \
 #	PlotWizard.h \
-#	QwtDataFilter.h \
 #	ScaleDraw.h \
 #	ScalePicker.h \
 #	SelectionMoveResizer.h \
@@ -30,11 +30,12 @@
 #include "../Layer.h"
 #include "table/Table.h"
 
+#include "core/column/Column.h"
+
 #include <QPainter>
 #include <QLocale>
 
-#include <gsl/gsl_sort.h>
-#include <gsl/gsl_statistics.h>
+#include <math.h>
 
 BoxCurve::BoxCurve(Table *t, const char *name, int startRow, int endRow):
 	DataCurve(t, QString(), name, startRow, endRow)
@@ -84,34 +85,29 @@ void BoxCurve::draw(QPainter *painter,
 	painter->save();
 	painter->setPen(QwtPlotCurve::pen());
 
-	double *dat = new double[size];
-	for (int i = from; i<= to; i++)
-		dat[i] = y(i);
+	if (!d_statistics.isValid())
+		d_statistics.update(data());
 
-	drawBox(painter, xMap, yMap, dat, size);
-	drawSymbols(painter, xMap, yMap, dat, size);
+	drawBox(painter, xMap, yMap);
+	drawSymbols(painter, xMap, yMap);
 
 	painter->restore();
-	delete[] dat;
 }
 
 void BoxCurve::drawBox(QPainter *painter, const QwtScaleMap &xMap,
-		const QwtScaleMap &yMap, double *dat, int size) const
+		const QwtScaleMap &yMap) const
 {
+	const int size = d_statistics.size();
 	const int px = xMap.transform(x(0));
 	const int px_min = xMap.transform(x(0) - 0.5);
 	const int px_max = xMap.transform(x(0) + 0.5);
 	const int box_width = 1+(px_max - px_min)*b_width/100;
 	const int hbw = box_width/2;
-	const int median = yMap.transform(gsl_stats_median_from_sorted_data (dat, 1, size));
+	const int median = yMap.transform(d_statistics.quantile(0.5));
 	int b_lowerq, b_upperq;
-	double sd, se, mean;
-	if(w_range == SD || w_range == SE || b_range == SD || b_range == SE)
-	{
-		sd = gsl_stats_sd(dat, 1, size);
-		se = sd/sqrt((double)size);
-		mean = gsl_stats_mean(dat, 1, size);
-	}
+	const double sd = d_statistics.standardDeviation();
+	const double se = sd/sqrt((double)size);
+	const double mean = d_statistics.mean();
 
 	if(b_range == SD)
 	{
@@ -125,8 +121,8 @@ void BoxCurve::drawBox(QPainter *painter, const QwtScaleMap &xMap,
 	}
 	else
 	{
-		b_lowerq = yMap.transform(gsl_stats_quantile_from_sorted_data (dat, 1, size, 1-0.01*b_coeff));
-		b_upperq = yMap.transform(gsl_stats_quantile_from_sorted_data (dat, 1, size, 0.01*b_coeff));
+		b_lowerq = yMap.transform(d_statistics.quantile(1-0.01*b_coeff));
+		b_upperq = yMap.transform(d_statistics.quantile(0.01*b_coeff));
 	}
 
 	//draw box
@@ -149,8 +145,8 @@ void BoxCurve::drawBox(QPainter *painter, const QwtScaleMap &xMap,
 	}
 	else if (b_style == WindBox)
 	{
-		const int lowerq = yMap.transform(gsl_stats_quantile_from_sorted_data (dat, 1, size, 0.25));
-		const int upperq = yMap.transform(gsl_stats_quantile_from_sorted_data (dat, 1, size, 0.75));
+		const int lowerq = yMap.transform(d_statistics.quantile(0.25));
+		const int upperq = yMap.transform(d_statistics.quantile(0.75));
 		QPolygon pa(8);
 		pa[0] = QPoint(px + hbw, b_upperq);
 		pa[1] = QPoint(int(px + 0.4*box_width), upperq);
@@ -168,8 +164,8 @@ void BoxCurve::drawBox(QPainter *painter, const QwtScaleMap &xMap,
 	{
 		int j = (int)ceil(0.5*(size - 1.96*sqrt((double)size)));
 		int k = (int)ceil(0.5*(size + 1.96*sqrt((double)size)));
-		const int lowerCI = yMap.transform(dat[j]);
-		const int upperCI = yMap.transform(dat[k]);
+		const int lowerCI = yMap.transform(d_statistics.orderStatistic(j));
+		const int upperCI = yMap.transform(d_statistics.orderStatistic(k));
 
 		QPolygon pa(10);
 		pa[0] = QPoint(px + hbw, b_upperq);
@@ -203,8 +199,8 @@ void BoxCurve::drawBox(QPainter *painter, const QwtScaleMap &xMap,
 		}
 		else
 		{
-			w_lowerq = yMap.transform(gsl_stats_quantile_from_sorted_data (dat, 1, size, 1-0.01*w_coeff));
-			w_upperq = yMap.transform(gsl_stats_quantile_from_sorted_data (dat, 1, size, 0.01*w_coeff));
+			w_lowerq = yMap.transform(d_statistics.quantile(1-0.01*w_coeff));
+			w_upperq = yMap.transform(d_statistics.quantile(0.01*w_coeff));
 		}
 
 		painter->drawLine(px - l, w_lowerq, px + l, w_lowerq);
@@ -231,38 +227,38 @@ void BoxCurve::drawBox(QPainter *painter, const QwtScaleMap &xMap,
 }
 
 void BoxCurve::drawSymbols(QPainter *painter, const QwtScaleMap &xMap,
-		const QwtScaleMap &yMap, double *dat, int size) const
+		const QwtScaleMap &yMap) const
 {
 	const int px = xMap.transform(x(0));
 
 	QwtSymbol s = this->symbol();
 	if (min_style != QwtSymbol::NoSymbol)
 	{
-		const int py_min = yMap.transform(y(0));
+		const int py_min = yMap.transform(d_statistics.minimum());
 		s.setStyle(min_style);
 		s.draw(painter, px, py_min);
 	}
 	if (max_style != QwtSymbol::NoSymbol)
 	{
-		const int py_max = yMap.transform(y(size - 1));
+		const int py_max = yMap.transform(d_statistics.maximum());
 		s.setStyle(max_style);
 		s.draw(painter, px, py_max);
 	}
 	if (p1_style != QwtSymbol::NoSymbol)
 	{
-		const int p1 = yMap.transform(gsl_stats_quantile_from_sorted_data (dat, 1, size, 0.01));
+		const int p1 = yMap.transform(d_statistics.quantile(0.01));
 		s.setStyle(p1_style);
 		s.draw(painter, px, p1);
 	}
 	if (p99_style != QwtSymbol::NoSymbol)
 	{
-		const int p99 = yMap.transform(gsl_stats_quantile_from_sorted_data (dat, 1, size, 0.99));
+		const int p99 = yMap.transform(d_statistics.quantile(0.99));
 		s.setStyle(p99_style);
 		s.draw(painter, px, p99);
 	}
 	if (mean_style != QwtSymbol::NoSymbol)
 	{
-		const int mean = yMap.transform(gsl_stats_mean(dat, 1, size));
+		const int mean = yMap.transform(d_statistics.mean());
 		s.setStyle(mean_style);
 		s.draw(painter, px, mean);
 	}
@@ -331,25 +327,34 @@ QwtDoubleRect BoxCurve::boundingRect() const
 	return rect;
 }
 
+void BoxCurve::dataChanged()
+{
+	DataCurve::dataChanged();
+	d_statistics.invalidate();
+}
+
 void BoxCurve::loadData()
 {
-	QVector<double> Y(abs(d_end_row - d_start_row) + 1);
-    int ycol = d_table->colIndex(title().text());
-	int size = 0;
-	for (int i = d_start_row; i <= d_end_row; i++){
-		QString s = d_table->text(i, ycol);
-        if (!s.isEmpty()){
-            bool valid_data = true;
-            Y[size] = QLocale().toDouble(s, &valid_data);
-            if (valid_data)
-                size++;
-        }
+	QVector<double> Y;
+	Column *col = m_table->column(title().text());
+	if (col){
+		int last_row = qMin(qMax(m_start_row, m_end_row), col->rowCount() - 1);
+		for (int i = qMin(m_start_row, m_end_row); i <= last_row; i++){
+			if (col->isInvalid(i))
+				continue;
+			if (col->dataType() == SciDAVis::TypeDouble)
+				Y << col->valueAt(i);
+			else {
+				bool valid_data = false;
+				double value = QLocale().toDouble(col->textAt(i), &valid_data);
+				if (valid_data)
+					Y << value;
+			}
+		}
 	}
 
-	if (size>0){
-		Y.resize(size);
-		gsl_sort (Y.data(), 1, size);
-        setData(QwtSingleArrayData(this->x(0), Y, size));
-	} else
+	if (Y.size() > 0)
+		setData(QwtSingleArrayData(this->x(0), Y, Y.size()));
+	else
 		remove();
 }
@@ -30,6 +30,7 @@
 #define BOXCURVE_H
 
 #include "../PlotCurve.h"
+#include "../BoxStatistics.h"
 #include <qwt_plot.h>
 #include <qwt_symbol.h>
 
@@ -77,17 +78,23 @@ public:
 
     void loadData();
 
+protected:
+	virtual void dataChanged();
+
 private:
 	void draw(QPainter *painter,const QwtScaleMap &xMap,
 		const QwtScaleMap &yMap, int from, int to) const;
 	void drawBox(QPainter *painter, const QwtScaleMap &xMap,
-				const QwtScaleMap &yMap, double *dat, int size) const;
+				const QwtScaleMap &yMap) const;
 	void drawSymbols(QPainter *painter, const QwtScaleMap &xMap,
-				const QwtScaleMap &yMap, double *dat, int size) const;
+				const QwtScaleMap &yMap) const;
 
 	QwtSymbol::Style min_style, max_style, mean_style, p99_style, p1_style;
 	double b_coeff, w_coeff;
 	int b_style, b_width, b_range, w_range;
+
+	//! Statistics of the curve data; computed by draw() and kept until the data changes
+	mutable BoxStatistics d_statistics;
 };
 
 
@@ -29,6 +29,7 @@
 #include "ErrorCurve.h"
 #include "BarCurve.h"
 #include "../Layer.h"
+#include "../ColumnQwtData.h"
 #include "table/Table.h"
 
 #include <qwt_painter.h>
@@ -254,6 +255,31 @@ void ErrorCurve::loadData()
 	if (xcol<0 || ycol<0 || errcol<0)
 		return;
 
+	d_start_row = d_master_curve->startRow();
+	d_end_row = d_master_curve->endRow();
+
+	Column *x_col = mt->column(xcol);
+	Column *y_col = mt->column(ycol);
+	Column *err_col = d_table->column(errcol);
+	if (ColumnQwtData::supports(x_col) && ColumnQwtData::supports(y_col)
+			&& err_col && err_col->columnMode() == SciDAVis::Numeric){
+		// read the columns directly, skipping rows with an invalid error value, too
+		const ColumnQwtData *current = dynamic_cast<const ColumnQwtData *>(&this->data());
+		ColumnQwtData data = current && current->refersTo(x_col, y_col, d_start_row, d_end_row, err_col) ?
+			*current : ColumnQwtData(x_col, y_col, d_start_row, d_end_row, err_col);
+		data.update();
+		if (!data.size()){
+			remove();
+			return;
+		}
+		QVector<double> err(data.size());
+		for (size_t i = 0; i < data.size(); i++)
+			err[i] = err_col->valueAt(data.row(i));
+		setData(data);
+		setErrors(err);
+		return;
+	}
+
 	int xColType = mt->columnType(xcol);
 	int yColType = mt->columnType(ycol);
 
@@ -29,15 +29,21 @@
 #include "HistogramCurve.h"
 #include "table/Table.h"
 
+#include "core/column/Column.h"
+#include "lib/ValueSpan.h"
+
 #include <QPainter>
 #include <QLocale>
-#include <QVarLengthArray>
 
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_histogram.h>
+#include <math.h>
 
 HistogramCurve::HistogramCurve(Table *t, const QString& xColName, const char *name, int startRow, int endRow):
-	BarCurve(BarCurve::Vertical, t, xColName, name, startRow, endRow)
+	BarCurve(BarCurve::Vertical, t, xColName, name, startRow, endRow),
+	d_autoBin(true),
+	d_rule(Histogram::FreedmanDiaconis),
+	d_bin_size(0),
+	d_begin(0),
+	d_end(0)
 {}
 
 void HistogramCurve::copy(const HistogramCurve *h)
@@ -45,9 +51,11 @@ void HistogramCurve::copy(const HistogramCurve *h)
 	BarCurve::copy((const BarCurve *)h);
 
 	d_autoBin = h->d_autoBin;
+	d_rule = h->d_rule;
 	d_bin_size = h->d_bin_size;
 	d_begin = h->d_begin;
 	d_end = h->d_end;
+	updateBinning();
 }
 
 void HistogramCurve::draw(QPainter *painter,
@@ -94,142 +102,72 @@ void HistogramCurve::setBinning(bool autoBin, double size, double begin, double
 	d_bin_size = size;
 	d_begin = begin;
 	d_end = end;
+	updateBinning();
 }
 
-void HistogramCurve::loadData()
+void HistogramCurve::setBinningRule(Histogram::BinningRule rule)
 {
-    int r = abs(d_end_row - d_start_row) + 1;
-	QVarLengthArray<double> Y(r);
-
-    int ycol = d_table->colIndex(title().text());
-	int size = 0;
-	for (int i = 0; i<r; i++ ){
-		QString yval = d_table->text(i, ycol);
-		if (!yval.isEmpty()){
-		    bool valid_data = true;
-            Y[size] = QLocale().toDouble(yval, &valid_data);
-            if (valid_data)
-                size++;
-		}
-	}
-	if(size < 2 || (size==2 && Y[0] == Y[1])){//non valid histogram
-		double X[2];
-		Y.resize(2);
-		for (int i = 0; i<2; i++ ){
-			Y[i] = 0;
-			X[i] = 0;
-		}
-		setData(X, Y.data(), 2);
-		return;
-	}
-
-	int n;
-	gsl_histogram *h;
-	if (d_autoBin){
-		n = 10;
-		h = gsl_histogram_alloc (n);
-		if (!h)
-			return;
-
-		gsl_vector *v = gsl_vector_alloc (size);
-		for (int i = 0; i<size; i++ )
-			gsl_vector_set (v, i, Y[i]);
-
-		double min, max;
-		gsl_vector_minmax (v, &min, &max);
-		gsl_vector_free (v);
-
-		d_begin = floor(min);
-		d_end = ceil(max);
-		d_bin_size = (d_end - d_begin)/(double)n;
-
-		gsl_histogram_set_ranges_uniform (h, floor(min), ceil(max));
-	} else {
-		n = int((d_end - d_begin)/d_bin_size + 1);
-		h = gsl_histogram_alloc (n);
-		if (!h)
-			return;
-
-		double *range = new double[n+2];
-		for (int i = 0; i<= n+1; i++ )
-			range[i] = d_begin + i*d_bin_size;
-
-		gsl_histogram_set_ranges (h, range, n+1);
-		delete[] range;
-	}
+	d_rule = rule;
+	updateBinning();
+}
 
-	for (int i = 0; i<size; i++ )
-		gsl_histogram_increment (h, Y[i]);
+void HistogramCurve::updateBinning()
+{
+	if (!d_autoBin)
+		d_histogram.setBins(d_begin, d_end, d_bin_size);
+	else if (d_rule != Histogram::UserBins)
+		d_histogram.setBinningRule(d_rule);
+	else
+		d_histogram.setBinningRule(Histogram::FreedmanDiaconis);
+}
 
-	double X[n]; //stores ranges (x) and bins (y)
-	Y.resize(n);
-	for (int i = 0; i<n; i++ ){
-		Y[i] = gsl_histogram_get (h, i);
-		double lower, upper;
-		gsl_histogram_get_range (h, i, &lower, &upper);
-		X[i] = lower;
+void HistogramCurve::loadData()
+{
+	Column *col = m_table->column(title().text());
+	int first_row = qMin(m_start_row, m_end_row), last_row = qMax(m_start_row, m_end_row);
+	if (!col || col->dataType() == SciDAVis::TypeDouble)
+		d_histogram.update(col, first_row, last_row);
+	else {
+		// text columns may still contain numbers
+		last_row = qMin(last_row, col->rowCount() - 1);
+		QVector<double> values;
+		for (int i = first_row; i <= last_row; i++){
+			bool valid_data = false;
+			double value = QLocale().toDouble(col->textAt(i), &valid_data);
+			values << (valid_data ? value : NAN);
+		}
+		d_histogram.update(ValueSpan(first_row, values));
 	}
-	setData(X, Y.data(), n);
-
-	d_mean = gsl_histogram_mean(h);
-	d_standard_deviation = gsl_histogram_sigma(h);
-	d_min = gsl_histogram_min_val(h);
-	d_max = gsl_histogram_max_val(h);
-
-	gsl_histogram_free (h);
+	setHistogramData();
 }
 
 void HistogramCurve::initData(const QVector<double>& Y, int size)
 {
-	if(size<2 || (size == 2 && Y[0] == Y[1]))
-	{//non valid histogram data
-		double x[2], y[2];
-		for (int i = 0; i<2; i++ ){
-			y[i] = 0;
-			x[i] = 0;
-		}
-		setData(x, y, 2);
-		return;
-	}
+	d_autoBin = true;
+	updateBinning();
+	d_histogram.update(ValueSpan(0, Y.mid(0, size)));
+	setHistogramData();
+}
 
-	int n = 10;//default value
-	double x[n], y[n]; //store ranges (x) and bins (y)
-	gsl_histogram * h = gsl_histogram_alloc (n);
-	if (!h)
+void HistogramCurve::setHistogramData()
+{
+	int n = d_histogram.binCount();
+	if (n == 0){//non valid histogram
+		double zeros[2] = {0, 0};
+		setData(zeros, zeros, 2);
 		return;
+	}
 
-	gsl_vector *v;
-	v = gsl_vector_alloc (size);
-	for (int i = 0; i<size; i++ )
-		gsl_vector_set (v, i, Y[i]);
-
-	double min, max;
-	gsl_vector_minmax (v, &min, &max);
-	gsl_vector_free (v);
-
-	d_begin = floor(min);
-	d_end = ceil(max);
-
-	gsl_histogram_set_ranges_uniform (h, floor(min), ceil(max));
-
-	for (int i = 0; i<size; i++ )
-		gsl_histogram_increment (h, Y[i]);
-
+	QVector<double> X(n), Y(n); //stores ranges (x) and bins (y)
 	for (int i = 0; i<n; i++ ){
-		y[i] = gsl_histogram_get (h, i);
-		double lower, upper;
-		gsl_histogram_get_range (h, i, &lower, &upper);
-		x[i] = lower;
+		X[i] = d_histogram.binStart(i);
+		Y[i] = d_histogram.count(i);
 	}
+	setData(X.data(), Y.data(), n);
 
-	setData(x, y, n);
-
-	d_bin_size = (d_end - d_begin)/(double)n;
-	d_autoBin = true;
-    d_mean = gsl_histogram_mean(h);
-	d_standard_deviation = gsl_histogram_sigma(h);
-	d_min = gsl_histogram_min_val(h);
-	d_max = gsl_histogram_max_val(h);
-
-	gsl_histogram_free (h);
+	if (d_autoBin){
+		d_begin = d_histogram.begin();
+		d_end = d_histogram.end();
+		d_bin_size = d_histogram.binSize();
+	}
 }
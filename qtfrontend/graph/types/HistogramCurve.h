@@ -30,8 +30,14 @@
 #define HISTOGRAM_CURVE_H
 
 #include "BarCurve.h"
+#include "table/Histogram.h"
 
 //! Histogram class
+/**
+ * The bins are counted by a Histogram, which keeps the counts between calls to loadData(),
+ * so that reloading after a few rows of the column changed only moves these rows
+ * between the bins.
+ */
 class HistogramCurve: public BarCurve
 {
 public:
@@ -47,23 +53,32 @@ public:
 	double end(){return d_end;};
 	double binSize(){return d_bin_size;};
 
+	//! Rule used for choosing the bins when autoBinning() is enabled
+	Histogram::BinningRule binningRule() const {return d_rule;};
+	void setBinningRule(Histogram::BinningRule rule);
+
     void loadData();
     void initData(const QVector<double>& Y, int size);
 
-    double mean(){return d_mean;};
-    double standardDeviation(){return d_standard_deviation;};
-    double minimum(){return d_min;};
-    double maximum(){return d_max;};
+    double mean(){return d_histogram.mean();};
+    double standardDeviation(){return d_histogram.standardDeviation();};
+    double minimum(){return d_histogram.minimum();};
+    double maximum(){return d_histogram.maximum();};
 
 private:
 	void draw(QPainter *painter,const QwtScaleMap &xMap,
 		const QwtScaleMap &yMap, int from, int to) const;
 
+	//! Pass the binning settings on to d_histogram
+	void updateBinning();
+	//! Set the curve data from the bins of d_histogram
+	void setHistogramData();
+
 	bool d_autoBin;
+	Histogram::BinningRule d_rule;
 	double d_bin_size, d_begin, d_end;
 
-    //! Variables storing statistical information
-	double d_mean, d_standard_deviation, d_min, d_max;
+	Histogram d_histogram;
 };
 
 #endif // ifndef HISTOGRAM_CURVE_H
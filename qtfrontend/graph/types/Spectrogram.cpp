@@ -37,6 +37,7 @@
 Spectrogram::Spectrogram():
 	QwtPlotSpectrogram(),
 	d_matrix(0),
+	d_raster(0),
 	color_axis(QwtPlot::yRight),
 	color_map_policy(Default),
 	color_map(QwtLinearColorMap())
@@ -46,11 +47,12 @@ Spectrogram::Spectrogram():
 Spectrogram::Spectrogram(Matrix *m):
 	QwtPlotSpectrogram(QString(m->name())),
 	d_matrix(m),
+	d_raster(new SpectrogramRaster(m)),
 	color_axis(QwtPlot::yRight),
 	color_map_policy(Default),
 	color_map(QwtLinearColorMap())
 {
-setData(MatrixData(m));
+setData(MatrixData(d_raster));
 double step = fabs(data().range().maxValue() - data().range().minValue())/5.0;
 
 QwtValueList contourLevels;
@@ -70,7 +72,14 @@ QwtPlot *plot = this->plot();
 if (!plot)
 	return;
 
-setData(MatrixData(m));
+// the raster follows changes of its matrix by itself
+if (m != d_matrix)
+	{
+	delete d_raster;
+	d_matrix = m;
+	d_raster = new SpectrogramRaster(m);
+	}
+setData(MatrixData(d_raster));
 setLevelsNumber(levels());
 
 QwtScaleWidget *colorAxis = plot->axisWidget(color_axis);
@@ -81,6 +90,29 @@ plot->setAxisScale(color_axis, data().range().minValue(), data().range().maxValu
 plot->replot();
 }
 
+Spectrogram::~Spectrogram()
+{
+delete d_raster;
+}
+
+QImage Spectrogram::renderImage(const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QwtDoubleRect &area) const
+{
+if (!d_raster)
+	return QwtPlotSpectrogram::renderImage(xMap, yMap, area);
+return d_raster->render(xMap, yMap, area, colorMap());
+}
+
+SpectrogramRaster::Sampling Spectrogram::sampling() const
+{
+return d_raster ? d_raster->sampling() : SpectrogramRaster::NearestNeighbour;
+}
+
+void Spectrogram::setSampling(SpectrogramRaster::Sampling sampling)
+{
+if (d_raster)
+	d_raster->setSampling(sampling);
+}
+
 void Spectrogram::setLevelsNumber(int levels)
 {
 double step = fabs(data().range().maxValue() - data().range().minValue())/(double)levels;
@@ -178,6 +210,7 @@ Spectrogram *new_s = new Spectrogram(matrix());
 new_s->setDisplayMode(QwtPlotSpectrogram::ImageMode, testDisplayMode(QwtPlotSpectrogram::ImageMode));
 new_s->setDisplayMode(QwtPlotSpectrogram::ContourMode, testDisplayMode(QwtPlotSpectrogram::ContourMode));
 new_s->setColorMap (colorMap());
+new_s->setSampling(sampling());
 new_s->setAxis(xAxis(), yAxis());
 new_s->setDefaultContourPen(defaultContourPen());
 new_s->setLevelsNumber(levels());
@@ -264,6 +297,7 @@ else
 	s += "\t</ColorMap>\n";
 	}
 s += "\t<Image>"+QString::number(testDisplayMode(QwtPlotSpectrogram::ImageMode))+"</Image>\n";
+s += "\t<Sampling>"+QString::number(sampling())+"</Sampling>\n";
 
 bool contourLines = testDisplayMode(QwtPlotSpectrogram::ContourMode);
 s += "\t<ContourLines>"+QString::number(contourLines)+"</ContourLines>\n";
@@ -289,14 +323,3 @@ if (colorAxis && colorAxis->isColorBarEnabled())
 s += "\t<Visible>"+ QString::number(isVisible()) + "</Visible>\n";
 return s+"</spectrogram>\n";
 }
-
-double MatrixData::value(double x, double y) const
-{       
-int i = abs((int)floor((y - y_start)/dy - 1));
-int j = abs((int)floor((x - x_start)/dx));
-
-if (d_m && i < n_rows && j < n_cols)
-	return d_m[i][j];
-else 
-	return 0.0;
-}
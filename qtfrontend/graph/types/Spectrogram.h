@@ -34,6 +34,7 @@
 #include <qwt_color_map.h>
 
 #include "matrix/Matrix.h"
+#include "SpectrogramRaster.h"
 
 class MatrixData;
 
@@ -42,6 +43,7 @@ class Spectrogram: public QwtPlotSpectrogram
 public:
 	Spectrogram();
     Spectrogram(Matrix *m);
+	~Spectrogram();
 
 	enum ColorMapPolicy{GrayScale, Default, Custom};
 
@@ -65,15 +67,24 @@ public:
 	void setCustomColorMap(const QwtLinearColorMap& map);
 	void updateData(Matrix *m);
 
+	SpectrogramRaster::Sampling sampling() const;
+	void setSampling(SpectrogramRaster::Sampling sampling);
+
 	//! Used when saving a project file
 	QString saveToString();
 
 	ColorMapPolicy colorMapPolicy(){return color_map_policy;};
 
 protected:
+	//! Renders the image through d_raster instead of asking MatrixData for every pixel
+	virtual QImage renderImage(const QwtScaleMap &xMap, const QwtScaleMap &yMap, const QwtDoubleRect &area) const;
+
 	//! Pointer to the source data matrix
 	Matrix *d_matrix;
 
+	//! Resolution pyramid and tile cache for d_matrix
+	SpectrogramRaster *d_raster;
+
 	//! Axis used to display the color scale
 	int color_axis;
 
@@ -84,79 +95,41 @@ protected:
 };
 
 
+//! QwtRasterData view of a SpectrogramRaster, used for contour lines
+/**
+ * Copying is cheap, since all copies share the SpectrogramRaster of the Spectrogram.
+ */
 class MatrixData: public QwtRasterData
 {
 public:
-    MatrixData(Matrix *m):
-        QwtRasterData(m->boundingRect()),
-		d_matrix(m)
-    {
-	n_rows = d_matrix->rowCount();
-	n_cols = d_matrix->columnCount();
-
-	d_m = new double* [n_rows];
-	for ( int l = 0; l < n_rows; ++l)
-		d_m[l] = new double [n_cols];
-
-	for (int i = 0; i < n_rows; i++)
-         for (int j = 0; j < n_cols; j++)
-           d_m[i][j] = d_matrix->cell(i, j);
-
-	m->range(&min_z, &max_z);
-
-	x_start = d_matrix->xStart();
-	dx = (d_matrix->xEnd() - x_start)/(double)n_cols;
-
-	y_start = d_matrix->yStart();
-	dy = (d_matrix->yEnd() - y_start)/(double)n_rows;
-    }
-
-	~MatrixData()
-	{
-	for (int i = 0; i < n_rows; i++)
-		delete [] d_m[i];
-
-	delete [] d_m;
-	};
+    MatrixData(SpectrogramRaster *raster):
+        QwtRasterData(raster->boundingRect()),
+		d_raster(raster)
+    {}
 
     virtual QwtRasterData *copy() const
     {
-        return new MatrixData(d_matrix);
+        return new MatrixData(d_raster);
     }
 
     virtual QwtDoubleInterval range() const
     {
-        return QwtDoubleInterval(min_z, max_z);
+        return d_raster->range();
     }
 
 	virtual QSize rasterHint (const QwtDoubleRect &) const
 	{
-		return QSize(n_cols, n_rows);
+		return QSize(d_raster->columnCount(), d_raster->rowCount());
 	}
 
-    virtual double value(double x, double y) const;
+    virtual double value(double x, double y) const
+    {
+        return d_raster->value(x, y);
+    }
 
 private:
-	//! Pointer to the source data matrix
-	Matrix *d_matrix;
-
-	//! Vector used to store in memory the data from the source matrix window
-	double** d_m;
-
-	//! Data size
-	int n_rows, n_cols;
-
-	//! Min and max values in the source data matrix
-	double min_z, max_z;
-
-	//! Data resolution in x(columns) and y(rows)
-	double dx, dy;
-
-	//! X axis left value in the data matrix
-	double x_start;
-
-	//! Y axis bottom value in the data matrix
-	double y_start;
+	//! The raster of the spectrogram, which reads the matrix
+	SpectrogramRaster *d_raster;
 };
 
 #endif
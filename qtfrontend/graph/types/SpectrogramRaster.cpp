@@ -0,0 +1,366 @@
+/***************************************************************************
+    File                 : SpectrogramRaster.cpp
+    Project              : SciDAVis
+    Description          : Tiled, multi-threaded image renderer for spectrograms
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "SpectrogramRaster.h"
+#include "matrix/Matrix.h"
+#include "lib/ParallelFor.h"
+
+#include <QPainter>
+#include <qwt_scale_map.h>
+#include <qwt_color_map.h>
+
+#include <math.h>
+
+uint qHash(const SpectrogramTileKey& key)
+{
+	return qHash(key.column) ^ qHash(key.row << 16) ^ qHash(key.color_map << 4) ^ qHash(key.range << 8)
+		^ qHash((qint64)(key.x_scale * 1e6)) ^ qHash((qint64)(key.y_scale * 1e6) << 2);
+}
+
+//! Renders a list of tiles; used with parallelFor()
+class SpectrogramTileRenderer
+{
+	public:
+		SpectrogramTileRenderer(const SpectrogramRaster *raster, const QList<SpectrogramTileKey> &keys,
+				int level, const QVector<QRgb> &colors, QImage *tiles)
+			: m_raster(raster), m_keys(keys), m_level(level), m_colors(colors), m_tiles(tiles) {}
+
+		void operator()(int first, int last) const {
+			for (int i=first; i<=last; i++)
+				m_raster->renderTile(m_keys.at(i), m_level, m_colors, &m_tiles[i]);
+		}
+
+	private:
+		const SpectrogramRaster *m_raster;
+		const QList<SpectrogramTileKey> &m_keys;
+		int m_level;
+		const QVector<QRgb> &m_colors;
+		QImage *m_tiles;
+};
+
+//! Round towards minus infinity (unlike the / operator)
+static inline int floorDiv(int a, int b)
+{
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+SpectrogramRaster::SpectrogramRaster(Matrix *matrix)
+	: m_matrix(matrix), m_sampling(NearestNeighbour), m_range_serial(0)
+{
+	setCacheSize(64*1024);
+	reload();
+	connect(matrix, SIGNAL(dataChanged(int, int, int, int)), this, SLOT(update(int, int, int, int)));
+	connect(matrix, SIGNAL(columnsInserted(int, int)), this, SLOT(reload()));
+	connect(matrix, SIGNAL(columnsRemoved(int, int)), this, SLOT(reload()));
+	connect(matrix, SIGNAL(rowsInserted(int, int)), this, SLOT(reload()));
+	connect(matrix, SIGNAL(rowsRemoved(int, int)), this, SLOT(reload()));
+	connect(matrix, SIGNAL(coordinatesChanged()), this, SLOT(reload()));
+}
+
+QRectF SpectrogramRaster::boundingRect() const
+{
+	return QRectF(m_x_start, m_y_start, m_dx*columnCount(), m_dy*rowCount()).normalized();
+}
+
+QwtDoubleInterval SpectrogramRaster::range() const
+{
+	return m_range;
+}
+
+void SpectrogramRaster::reload()
+{
+	int columns = m_matrix->columnCount();
+	int rows = m_matrix->rowCount();
+	m_x_start = m_matrix->xStart();
+	m_y_start = m_matrix->yStart();
+	m_dx = columns > 0 ? (m_matrix->xEnd() - m_x_start)/columns : 1.0;
+	m_dy = rows > 0 ? (m_matrix->yEnd() - m_y_start)/rows : 1.0;
+	// the slice stays valid until the dimensions change, and then we are called again
+	m_cells = m_matrix->slice(0, 0, rows-1, columns-1);
+
+	m_levels.clear();
+	int w = columns, h = rows;
+	while (w > 1 || h > 1) {
+		Level level;
+		level.columns = (w+1)/2;
+		level.rows = (h+1)/2;
+		level.min.resize(level.columns*level.rows);
+		level.max.resize(level.columns*level.rows);
+		level.mean.resize(level.columns*level.rows);
+		m_levels << level;
+		updateLevel(m_levels.size(), 0, 0, rows-1, columns-1);
+		w = level.columns;
+		h = level.rows;
+	}
+
+	updateRange();
+	m_range_serial++;
+	m_tiles.clear();
+}
+
+void SpectrogramRaster::update(int top, int left, int bottom, int right)
+{
+	if (m_matrix->columnCount() != columnCount() || m_matrix->rowCount() != rowCount()) {
+		reload();
+		return;
+	}
+
+	top = qMax(top, 0);
+	left = qMax(left, 0);
+	bottom = qMin(bottom, rowCount()-1);
+	right = qMin(right, columnCount()-1);
+	if (top > bottom || left > right)
+		return;
+
+	for (int level=1; level<=m_levels.size(); level++)
+		updateLevel(level, top, left, bottom, right);
+
+	QwtDoubleInterval old_range = m_range;
+	updateRange();
+	if (old_range.minValue() != m_range.minValue() || old_range.maxValue() != m_range.maxValue()) {
+		// all colors change
+		m_range_serial++;
+		m_tiles.clear();
+		return;
+	}
+
+	QRectF changed = QRectF(m_x_start + left*m_dx, m_y_start + top*m_dy,
+			(right-left+1)*m_dx, (bottom-top+1)*m_dy).normalized();
+	foreach(SpectrogramTileKey key, m_tiles.keys()) {
+		// bilinear sampling reaches into the neighbouring cells of the level rendered from
+		double margin = (1 << levelFor(key.x_scale, key.y_scale));
+		QRectF affected = changed.adjusted(-margin*fabs(m_dx), -margin*fabs(m_dy),
+				margin*fabs(m_dx), margin*fabs(m_dy));
+		if (tileRect(key).intersects(affected))
+			m_tiles.remove(key);
+	}
+}
+
+void SpectrogramRaster::updateLevel(int level, int top, int left, int bottom, int right)
+{
+	Level &current = m_levels[level-1];
+	int child_rows = level == 1 ? rowCount() : m_levels.at(level-2).rows;
+	int child_columns = level == 1 ? columnCount() : m_levels.at(level-2).columns;
+
+	for (int i=(top >> level); i<=(bottom >> level); i++)
+		for (int j=(left >> level); j<=(right >> level); j++) {
+			double min = 0, max = 0, sum = 0;
+			int count = 0;
+			for (int ci=2*i; ci<=2*i+1 && ci<child_rows; ci++)
+				for (int cj=2*j; cj<=2*j+1 && cj<child_columns; cj++) {
+					double child_min, child_max, child_mean;
+					if (level == 1)
+						child_min = child_max = child_mean = m_cells.at(ci, cj);
+					else {
+						const Level &child = m_levels.at(level-2);
+						int index = ci*child.columns + cj;
+						child_min = child.min.at(index);
+						child_max = child.max.at(index);
+						child_mean = child.mean.at(index);
+					}
+					if (count == 0 || child_min < min) min = child_min;
+					if (count == 0 || child_max > max) max = child_max;
+					sum += child_mean;
+					count++;
+				}
+			int index = i*current.columns + j;
+			current.min[index] = min;
+			current.max[index] = max;
+			current.mean[index] = count > 0 ? sum/count : 0;
+		}
+}
+
+void SpectrogramRaster::updateRange()
+{
+	if (m_cells.isEmpty()) {
+		m_range = QwtDoubleInterval(0, 0);
+		return;
+	}
+	if (m_levels.isEmpty()) {
+		m_range = QwtDoubleInterval(m_cells.at(0, 0), m_cells.at(0, 0));
+		return;
+	}
+	const Level &top = m_levels.last();
+	double min = top.min.at(0), max = top.max.at(0);
+	for (int i=1; i<top.min.size(); i++) {
+		min = qMin(min, top.min.at(i));
+		max = qMax(max, top.max.at(i));
+	}
+	m_range = QwtDoubleInterval(min, max);
+}
+
+int SpectrogramRaster::levelFor(double x_scale, double y_scale) const
+{
+	// matrix cells per pixel in the direction with the higher resolution
+	double cells = qMin(1.0/fabs(x_scale*m_dx), 1.0/fabs(y_scale*m_dy));
+	int level = 0;
+	while (level < m_levels.size() && (1 << (level+1)) <= cells)
+		level++;
+	return level;
+}
+
+QRectF SpectrogramRaster::tileRect(const SpectrogramTileKey &key) const
+{
+	return QRectF(m_x_start + key.column*TileSize/key.x_scale, m_y_start + key.row*TileSize/key.y_scale,
+			TileSize/key.x_scale, TileSize/key.y_scale).normalized();
+}
+
+double SpectrogramRaster::value(double x, double y) const
+{
+	int j = (int)floor((x - m_x_start)/m_dx);
+	int i = (int)floor((y - m_y_start)/m_dy);
+	if (i < 0 || i >= rowCount() || j < 0 || j >= columnCount())
+		return 0.0;
+	return m_cells.at(i, j);
+}
+
+double SpectrogramRaster::sample(int level, double u, double v) const
+{
+	int columns = level == 0 ? columnCount() : m_levels.at(level-1).columns;
+	int rows = level == 0 ? rowCount() : m_levels.at(level-1).rows;
+
+	if (m_sampling == NearestNeighbour)
+		return cell(level, qMin((int)v, rows-1), qMin((int)u, columns-1));
+
+	// interpolate between the centers of the four nearest cells
+	u -= 0.5;
+	v -= 0.5;
+	int j0 = (int)floor(u), i0 = (int)floor(v);
+	double fu = u - j0, fv = v - i0;
+	int j1 = qBound(0, j0+1, columns-1), i1 = qBound(0, i0+1, rows-1);
+	j0 = qBound(0, j0, columns-1);
+	i0 = qBound(0, i0, rows-1);
+	return (1-fv)*((1-fu)*cell(level, i0, j0) + fu*cell(level, i0, j1))
+		+ fv*((1-fu)*cell(level, i1, j0) + fu*cell(level, i1, j1));
+}
+
+void SpectrogramRaster::renderTile(const SpectrogramTileKey &key, int level, const QVector<QRgb> &colors, QImage *tile) const
+{
+	// positions of the pixels in matrix cells (level 0) and in cells of 'level'
+	double factor = 1 << level;
+	QVector<double> us(TileSize), vs(TileSize);
+	for (int p=0; p<TileSize; p++) {
+		us[p] = (key.column*TileSize + p)/(key.x_scale*m_dx);
+		vs[p] = (key.row*TileSize + p)/(key.y_scale*m_dy);
+	}
+
+	double min = m_range.minValue(), width = m_range.maxValue() - m_range.minValue();
+	double color_scale = width > 0 ? (colors.size()-1)/width : 0;
+	int columns = columnCount(), rows = rowCount();
+	for (int py=0; py<TileSize; py++) {
+		QRgb *line = (QRgb *)tile->scanLine(py);
+		double v = vs.at(py);
+		bool row_inside = v >= 0 && v < rows;
+		for (int px=0; px<TileSize; px++) {
+			double u = us.at(px);
+			if (!row_inside || u < 0 || u >= columns) {
+				line[px] = qRgba(0, 0, 0, 0);
+				continue;
+			}
+			int index = (int)((sample(level, u/factor, v/factor) - min)*color_scale + 0.5);
+			line[px] = colors.at(qBound(0, index, colors.size()-1));
+		}
+	}
+}
+
+QImage SpectrogramRaster::render(const QwtScaleMap &x_map, const QwtScaleMap &y_map, const QRectF &area,
+		const QwtColorMap &color_map)
+{
+	// same pixel rectangle as QwtPlotItem::transform()
+	int x1 = qRound(x_map.xTransform(area.left()));
+	int x2 = qRound(x_map.xTransform(area.right()));
+	int y1 = qRound(y_map.xTransform(area.top()));
+	int y2 = qRound(y_map.xTransform(area.bottom()));
+	QRect rect = QRect(x1, y1, x2 - x1, y2 - y1).normalized();
+
+	QImage image(rect.size(), QImage::Format_ARGB32);
+	image.fill(0);
+	if (rect.isEmpty() || m_cells.isEmpty()
+			|| x_map.s2() == x_map.s1() || y_map.s2() == y_map.s1())
+		return image;
+
+	// The color table is cheap compared to a tile, and hashing it notices any change of
+	// the color map, no matter how it was made (QwtPlotSpectrogram::setColorMap() isn't virtual).
+	QVector<QRgb> colors(1024);
+	double min = m_range.minValue(), step = (m_range.maxValue() - min)/(colors.size()-1);
+	uint color_hash = colors.size();
+	for (int i=0; i<colors.size(); i++) {
+		colors[i] = color_map.rgb(m_range, min + i*step);
+		color_hash = color_hash*31 + colors.at(i);
+	}
+
+	SpectrogramTileKey key;
+	key.x_scale = (x_map.p2() - x_map.p1())/(x_map.s2() - x_map.s1());
+	key.y_scale = (y_map.p2() - y_map.p1())/(y_map.s2() - y_map.s1());
+	key.sampling = m_sampling;
+	key.color_map = color_hash;
+	key.range = m_range_serial;
+	int level = levelFor(key.x_scale, key.y_scale);
+
+	// tiles are anchored at the (pixel containing the) matrix origin
+	int origin_x = qRound(x_map.xTransform(m_x_start));
+	int origin_y = qRound(y_map.xTransform(m_y_start));
+	int first_column = floorDiv(rect.left() - origin_x, TileSize);
+	int last_column = floorDiv(rect.right() - origin_x, TileSize);
+	int first_row = floorDiv(rect.top() - origin_y, TileSize);
+	int last_row = floorDiv(rect.bottom() - origin_y, TileSize);
+
+	QList<SpectrogramTileKey> keys, missing;
+	QList<int> missing_index;
+	QList<QImage> tiles;
+	for (int r=first_row; r<=last_row; r++)
+		for (int c=first_column; c<=last_column; c++) {
+			key.row = r;
+			key.column = c;
+			keys << key;
+			QImage *cached = m_tiles.object(key);
+			tiles << (cached ? *cached : QImage());
+			if (!cached) {
+				missing << key;
+				missing_index << keys.size()-1;
+			}
+		}
+
+	if (!missing.isEmpty()) {
+		QVector<QImage> rendered(missing.size());
+		for (int i=0; i<missing.size(); i++)
+			rendered[i] = QImage(TileSize, TileSize, QImage::Format_ARGB32);
+		parallelFor(0, missing.size()-1, SpectrogramTileRenderer(this, missing, level, colors, rendered.data()));
+
+		for (int i=0; i<missing.size(); i++) {
+			m_tiles.insert(missing.at(i), new QImage(rendered.at(i)), TileSize*TileSize*4/1024);
+			tiles[missing_index.at(i)] = rendered.at(i);
+		}
+	}
+
+	QPainter painter(&image);
+	for (int i=0; i<keys.size(); i++)
+		painter.drawImage(origin_x + keys.at(i).column*TileSize - rect.left(),
+				origin_y + keys.at(i).row*TileSize - rect.top(), tiles.at(i));
+	return image;
+}
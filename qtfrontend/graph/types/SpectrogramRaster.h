@@ -0,0 +1,157 @@
+/***************************************************************************
+    File                 : SpectrogramRaster.h
+    Project              : SciDAVis
+    Description          : Tiled, multi-threaded image renderer for spectrograms
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SPECTROGRAM_RASTER_H
+#define SPECTROGRAM_RASTER_H
+
+#include <QObject>
+#include <QVector>
+#include <QCache>
+#include <QImage>
+#include <QRectF>
+#include <qwt_double_interval.h>
+
+#include "matrix/Matrix.h"
+
+class QwtScaleMap;
+class QwtColorMap;
+
+//! Key of a tile in the SpectrogramRaster tile cache
+struct SpectrogramTileKey
+{
+	//! Pixels per data unit; identifies the zoom level
+	double x_scale, y_scale;
+	//! Tile position, in tiles from the matrix origin
+	int column, row;
+	int sampling;
+	//! Hash of the color table the tile was rendered with
+	uint color_map;
+	//! Changes whenever the data range (and thus the color of each value) changes
+	int range;
+
+	bool operator==(const SpectrogramTileKey& other) const {
+		return x_scale == other.x_scale && y_scale == other.y_scale && column == other.column
+			&& row == other.row && sampling == other.sampling && color_map == other.color_map
+			&& range == other.range;
+	}
+};
+uint qHash(const SpectrogramTileKey& key);
+
+//! Tiled, multi-threaded image renderer for spectrograms
+/**
+ * SpectrogramRaster reads the cells of a Matrix through a MatrixSlice (so nothing is
+ * copied) and keeps a resolution pyramid of it:
+ * level k has one cell per 2^k x 2^k matrix cells, holding their minimum, maximum and
+ * mean. Images are rendered from the coarsest level that still has at least one cell
+ * per pixel, in tiles of TileSize x TileSize pixels. Tiles are anchored at the matrix
+ * origin, so panning reuses them; missing tiles are rendered in parallel (see
+ * parallelFor()) and kept in a cache keyed by zoom, sampling mode and color map.
+ *
+ * When the matrix emits dataChanged(), only the affected pyramid cells are recomputed
+ * and only the cached tiles overlapping the changed cells are dropped (all of them if
+ * the data range changed, since that shifts all colors).
+ */
+class SpectrogramRaster : public QObject
+{
+	Q_OBJECT
+
+	public:
+		enum Sampling { NearestNeighbour, Bilinear };
+		enum { TileSize = 256 };
+
+		SpectrogramRaster(Matrix *matrix);
+
+		Matrix * matrix() const { return m_matrix; }
+		//! The area covered by the matrix, in plot coordinates
+		QRectF boundingRect() const;
+		//! Minimum and maximum over all cells
+		QwtDoubleInterval range() const;
+		int columnCount() const { return m_cells.columnCount(); }
+		int rowCount() const { return m_cells.rowCount(); }
+
+		Sampling sampling() const { return m_sampling; }
+		void setSampling(Sampling sampling) { m_sampling = sampling; }
+
+		//! Value of the cell containing (x,y); 0 outside of the matrix
+		double value(double x, double y) const;
+
+		//! Render 'area' (in plot coordinates) for the given maps, as done by QwtPlotSpectrogram::renderImage()
+		QImage render(const QwtScaleMap &x_map, const QwtScaleMap &y_map, const QRectF &area,
+				const QwtColorMap &color_map);
+
+		//! Set the memory used for cached tiles, in KiB
+		void setCacheSize(int kib) { m_tiles.setMaxCost(kib); }
+
+	public slots:
+		//! Re-read the whole matrix
+		void reload();
+
+	private slots:
+		void update(int top, int left, int bottom, int right);
+
+	private:
+		//! One level of the resolution pyramid
+		struct Level
+		{
+			int columns, rows;
+			//! Row-major cell values
+			QVector<double> min, max, mean;
+		};
+
+		//! Recompute the cells of pyramid level 'level' covering matrix cells top..bottom, left..right
+		void updateLevel(int level, int top, int left, int bottom, int right);
+		//! Recompute m_range from the coarsest level
+		void updateRange();
+		//! The pyramid level to render from at the given zoom
+		int levelFor(double x_scale, double y_scale) const;
+		//! The area covered by a cached tile, in plot coordinates
+		QRectF tileRect(const SpectrogramTileKey &key) const;
+		//! Value of cell (row, col) on pyramid level 'level'
+		double cell(int level, int row, int col) const {
+			return level == 0 ? m_cells.at(row, col) : m_levels.at(level-1).mean.at(row*m_levels.at(level-1).columns + col);
+		}
+		//! Value at position (u,v), measured in cells of pyramid level 'level'
+		double sample(int level, double u, double v) const;
+		void renderTile(const SpectrogramTileKey &key, int level, const QVector<QRgb> &colors, QImage *tile) const;
+
+		Matrix *m_matrix;
+		double m_x_start, m_y_start, m_dx, m_dy;
+		//! View on all cells of the matrix
+		MatrixSlice m_cells;
+		//! Pyramid levels 1, 2, ... (level 0 is the matrix itself)
+		QVector<Level> m_levels;
+		QwtDoubleInterval m_range;
+		Sampling m_sampling;
+		//! Incremented whenever m_range changes, so that all tiles are re-colored
+		int m_range_serial;
+		QCache<SpectrogramTileKey, QImage> m_tiles;
+
+		friend class SpectrogramTileRenderer;
+};
+
+#endif // ifndef SPECTROGRAM_RASTER_H
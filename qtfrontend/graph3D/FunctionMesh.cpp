@@ -0,0 +1,280 @@
+/***************************************************************************
+    File                 : FunctionMesh.cpp
+    Project              : SciDAVis
+    Description          : Adaptively refined mesh of a function of x and y
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "FunctionMesh.h"
+#include "core/MyParser.h"
+#include "lib/ParallelFor.h"
+
+#include <math.h>
+
+//! Relative deviation from a plane (with respect to the z range) above which update() refines the mesh
+static const double refinement_tolerance = 0.002;
+//! Minimum number of mesh columns handled by one thread in evaluate()
+static const int min_columns_per_thread = 4;
+
+//! Evaluates a formula at the nodes of a range of grid columns
+class FunctionMeshKernel
+{
+	public:
+		FunctionMeshKernel(const QByteArray& formula, const QVector<double>& xs, const QVector<double>& ys,
+				QVector<double>& values)
+			: m_formula(formula), m_xs(xs), m_ys(ys), m_values(values) {}
+
+		void operator()(int first, int last) const
+		{
+			// muParser is not thread-safe, so every thread compiles its own copy
+			MyParser parser;
+			double x = 0, y = 0;
+			int rows = m_ys.size();
+			try
+			{
+				parser.DefineVar("x", &x);
+				parser.DefineVar("y", &y);
+				parser.SetExpr(m_formula.constData());
+			}
+			catch(mu::ParserError &)
+			{
+				for (int i=first*rows; i<(last+1)*rows; i++)
+					m_values[i] = NAN;
+				return;
+			}
+
+			for (int i=first; i<=last; i++)
+			{
+				x = m_xs.at(i);
+				for (int j=0; j<rows; j++)
+				{
+					y = m_ys.at(j);
+					try
+					{
+						m_values[i*rows + j] = parser.Eval();
+					}
+					catch(mu::ParserError &)
+					{
+						m_values[i*rows + j] = NAN;
+					}
+				}
+			}
+		}
+
+	private:
+		QByteArray m_formula;
+		const QVector<double>& m_xs;
+		const QVector<double>& m_ys;
+		QVector<double>& m_values;
+};
+
+FunctionMesh::FunctionMesh()
+	: m_xl(0), m_xr(0), m_yl(0), m_yr(0), m_zl(0), m_zr(0),
+	m_columns(0), m_rows(0), m_refinement(0), m_cached(false), m_evaluations(0)
+{
+}
+
+void FunctionMesh::setFormula(const QString& formula)
+{
+	if (formula != m_formula)
+		m_cached = false;
+	m_formula = formula;
+}
+
+void FunctionMesh::setDomain(double xl, double xr, double yl, double yr)
+{
+	if (xl != m_xl || xr != m_xr || yl != m_yl || yr != m_yr)
+		m_cached = false;
+	m_xl = xl;
+	m_xr = xr;
+	m_yl = yl;
+	m_yr = yr;
+}
+
+void FunctionMesh::setMesh(int columns, int rows)
+{
+	if (columns != m_columns || rows != m_rows)
+		m_cached = false;
+	m_columns = columns;
+	m_rows = rows;
+}
+
+void FunctionMesh::setZRange(double zl, double zr)
+{
+	m_zl = zl;
+	m_zr = zr;
+}
+
+void FunctionMesh::setRefinement(int levels)
+{
+	levels = qMax(levels, 0);
+	if (levels != m_refinement)
+		m_cached = false;
+	m_refinement = levels;
+}
+
+bool FunctionMesh::evaluate(const QVector<double>& xs, const QVector<double>& ys, QVector<double>& values)
+{
+	values.resize(xs.size() * ys.size());
+	if (m_formula.isEmpty())
+	{
+		values.fill(0.0);
+		return true;
+	}
+
+	// check the syntax once here, so errors are reported only once
+	try
+	{
+		MyParser parser;
+		double x = xs.isEmpty() ? 0 : xs.first(), y = ys.isEmpty() ? 0 : ys.first();
+		parser.DefineVar("x", &x);
+		parser.DefineVar("y", &y);
+		parser.SetExpr((const std::string)m_formula.toAscii().constData());
+		parser.Eval();
+	}
+	catch(mu::ParserError &e)
+	{
+		m_error = QString::fromStdString(e.GetMsg());
+		return false;
+	}
+
+	parallelFor(0, xs.size()-1, FunctionMeshKernel(m_formula.toAscii(), xs, ys, values),
+			min_columns_per_thread);
+	m_evaluations += values.size();
+	return true;
+}
+
+QVector<double> FunctionMesh::refinedLines(bool columns) const
+{
+	const QVector<double>& lines = columns ? m_xs : m_ys;
+	int count = lines.size(), others = columns ? m_ys.size() : m_xs.size();
+	double tolerance = refinement_tolerance * (m_zr > m_zl ? m_zr - m_zl : 1.0);
+
+	// interval k lies between lines k and k+1
+	QVector<bool> refine(qMax(count-1, 0), false);
+	for (int k=1; k<count-1; k++)
+	{
+		double h1 = lines.at(k) - lines.at(k-1), h2 = lines.at(k+1) - lines.at(k);
+		for (int o=0; o<others; o++)
+		{
+			double f0, f1, f2;
+			if (columns)
+			{
+				f0 = m_values.at((k-1)*others + o);
+				f1 = m_values.at(k*others + o);
+				f2 = m_values.at((k+1)*others + o);
+			}
+			else
+			{
+				f0 = m_values.at(o*count + k-1);
+				f1 = m_values.at(o*count + k);
+				f2 = m_values.at(o*count + k+1);
+			}
+			// deviation of the middle value from the chord through its neighbours
+			if (fabs(f1 - (f0*h2 + f2*h1) / (h1 + h2)) > tolerance)
+			{
+				refine[k-1] = refine[k] = true;
+				break;
+			}
+		}
+	}
+
+	QVector<double> result;
+	for (int k=0; k<count-1; k++)
+		if (refine.at(k))
+			result << 0.5 * (lines.at(k) + lines.at(k+1));
+	return result;
+}
+
+bool FunctionMesh::update()
+{
+	if (m_cached)
+		return true;
+	m_error = QString();
+
+	m_xs.resize(qMax(m_columns, 2));
+	m_ys.resize(qMax(m_rows, 2));
+	for (int i=0; i<m_xs.size(); i++)
+		m_xs[i] = m_xl + i * (m_xr - m_xl) / (m_xs.size() - 1);
+	for (int j=0; j<m_ys.size(); j++)
+		m_ys[j] = m_yl + j * (m_yr - m_yl) / (m_ys.size() - 1);
+	if (!evaluate(m_xs, m_ys, m_values))
+		return false;
+
+	for (int level=0; level<m_refinement; level++)
+	{
+		QVector<double> new_xs = refinedLines(true), new_ys = refinedLines(false);
+		if (new_xs.isEmpty() && new_ys.isEmpty())
+			break;
+
+		// merge the new lines into the old ones, remembering where each line came from
+		QVector<double> xs, ys;
+		QVector<int> x_source, y_source; // index into the old lines if >= 0, else -1-(index into new lines)
+		for (int i=0, k=0; i<m_xs.size(); i++)
+		{
+			xs << m_xs.at(i);
+			x_source << i;
+			if (k < new_xs.size() && i+1 < m_xs.size() && new_xs.at(k) < m_xs.at(i+1))
+			{
+				xs << new_xs.at(k);
+				x_source << -1-k;
+				k++;
+			}
+		}
+		for (int j=0, k=0; j<m_ys.size(); j++)
+		{
+			ys << m_ys.at(j);
+			y_source << j;
+			if (k < new_ys.size() && j+1 < m_ys.size() && new_ys.at(k) < m_ys.at(j+1))
+			{
+				ys << new_ys.at(k);
+				y_source << -1-k;
+				k++;
+			}
+		}
+
+		// only the nodes on the new lines have to be evaluated
+		QVector<double> new_columns, new_rows;
+		if (!evaluate(new_xs, ys, new_columns) || !evaluate(m_xs, new_ys, new_rows))
+			return false;
+
+		QVector<double> values(xs.size() * ys.size());
+		for (int i=0; i<xs.size(); i++)
+			for (int j=0; j<ys.size(); j++)
+			{
+				double &v = values[i*ys.size() + j];
+				if (x_source.at(i) < 0)
+					v = new_columns.at((-1-x_source.at(i))*ys.size() + j);
+				else if (y_source.at(j) < 0)
+					v = new_rows.at(x_source.at(i)*new_ys.size() + (-1-y_source.at(j)));
+				else
+					v = m_values.at(x_source.at(i)*m_ys.size() + y_source.at(j));
+			}
+		m_xs = xs;
+		m_ys = ys;
+		m_values = values;
+	}
+	m_cached = true;
+	return true;
+}
@@ -0,0 +1,100 @@
+/***************************************************************************
+    File                 : FunctionMesh.h
+    Project              : SciDAVis
+    Description          : Adaptively refined mesh of a function of x and y
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FUNCTION_MESH_H
+#define FUNCTION_MESH_H
+
+#include <QVector>
+#include <QString>
+
+//! The values of a function z(x,y) on a rectangular mesh, refined where the surface is curved
+/**
+ * The formula is compiled once per thread and evaluated over the whole mesh at once, with
+ * the mesh columns distributed on all cores (see evaluate()). With refinement levels > 0,
+ * update() halves the mesh intervals in which the surface deviates visibly from a plane
+ * (relative to the z range), so strongly curved regions get a finer mesh than flat ones.
+ * Each level only evaluates the nodes on the new lines.
+ *
+ * The mesh is cached: update() only evaluates the formula again after the formula, the
+ * domain, the mesh or the refinement changed, not for a new z range.
+ */
+class FunctionMesh
+{
+	public:
+		FunctionMesh();
+
+		void setFormula(const QString& formula);
+		QString formula() const { return m_formula; }
+		void setDomain(double xl, double xr, double yl, double yr);
+		//! Number of equally spaced lines the mesh starts from (at least 2 each)
+		void setMesh(int columns, int rows);
+		//! The z range; refinement tolerances are relative to it
+		void setZRange(double zl, double zr);
+		//! Set how often the intervals of the mesh may be halved where the surface is curved
+		void setRefinement(int levels);
+		int refinement() const { return m_refinement; }
+
+		//! Compute the mesh, unless it is cached
+		/**
+		 * Returns false if the formula is invalid; see error().
+		 */
+		bool update();
+		//! Parser error of the last update()
+		QString error() const { return m_error; }
+
+		//! The x values of the mesh columns, in ascending order
+		const QVector<double>& xs() const { return m_xs; }
+		//! The y values of the mesh rows, in ascending order
+		const QVector<double>& ys() const { return m_ys; }
+		//! The value at (xs()[i], ys()[j]) is values()[i*ys().size() + j]
+		const QVector<double>& values() const { return m_values; }
+		//! Number of times the formula was evaluated so far
+		int evaluations() const { return m_evaluations; }
+
+		//! Evaluate the formula at all nodes of the grid xs x ys
+		/**
+		 * The value at (xs[i], ys[j]) is stored at values[i*ys.size() + j]. Points at which
+		 * the formula can't be evaluated get NaN. Returns false if the formula is invalid.
+		 */
+		bool evaluate(const QVector<double>& xs, const QVector<double>& ys, QVector<double>& values);
+
+	private:
+		//! Return the midpoints of the intervals of xs (or ys, if 'columns' is false) to be refined
+		QVector<double> refinedLines(bool columns) const;
+
+		QString m_formula;
+		double m_xl, m_xr, m_yl, m_yr, m_zl, m_zr;
+		int m_columns, m_rows, m_refinement;
+		//! Whether m_xs, m_ys and m_values belong to the current formula, domain, mesh and refinement
+		bool m_cached;
+		QString m_error;
+		QVector<double> m_xs, m_ys, m_values;
+		int m_evaluations;
+};
+
+#endif // ifndef FUNCTION_MESH_H
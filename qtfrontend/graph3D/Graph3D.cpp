@@ -29,6 +29,7 @@
 #include "Graph3D.h"
 #include "Bar3D.h"
 #include "Cone3D.h"
+#include "ScatteredData.h"
 #include "core/MyParser.h"
 #include "table/Table.h"
 #include "matrix/Matrix.h"
@@ -50,12 +51,16 @@
 #include <QMenu>
 #include <QComboBox>
 #include <QDialogButtonBox>
+#include <QGridLayout>
+#include <QLabel>
+#include <QSpinBox>
 
 #include <qwt3d_io_gl2ps.h>
 #include <qwt3d_coordsys.h>
 
 #include <gsl/gsl_vector.h>
 #include <fstream>
+#include <math.h>
 
 #define WAIT_CURSOR QApplication::setOverrideCursor(QCursor(Qt::WaitCursor))
 #define RESET_CURSOR QApplication::restoreOverrideCursor()
@@ -77,9 +82,20 @@ class Graph3DWidget : public QWidget
 };
 
 UserFunction::UserFunction(const QString& s, SurfacePlot& pw)
-: Function(pw)
+: Function(pw), m_plot(&pw), m_x(0), m_y(0), m_zl(0), m_zr(0)
 {
 	formula=s;
+	m_mesh.setFormula(formula);
+	m_parser = new MyParser();
+	try
+	{
+		m_parser->DefineVar("x", &m_x);
+		m_parser->DefineVar("y", &m_y);
+		m_parser->SetExpr((const std::string)formula.toAscii().constData());
+	}
+	catch(mu::ParserError &)
+	{
+	}
 }
 
 double UserFunction::operator()(double x, double y)
@@ -87,15 +103,12 @@ double UserFunction::operator()(double x, double y)
 	if (formula.isEmpty())
 		return 0.0;
 
-	MyParser parser;
+	m_x = x;
+	m_y = y;
 	double result=0.0;
 	try
 	{
-		parser.DefineVar("x", &x);
-		parser.DefineVar("y", &y);
-
-		parser.SetExpr((const std::string)formula.toAscii().constData());
-		result=parser.Eval();
+		result=m_parser->Eval();
 	}
 	catch(mu::ParserError &e)
 	{
@@ -106,6 +119,66 @@ double UserFunction::operator()(double x, double y)
 
 UserFunction::~UserFunction()
 {
+	delete m_parser;
+}
+
+void UserFunction::setMesh(unsigned int columns, unsigned int rows)
+{
+	Function::setMesh(columns, rows);
+	m_mesh.setMesh(columns, rows);
+}
+
+void UserFunction::setDomain(double xl, double xr, double yl, double yr)
+{
+	Function::setDomain(xl, xr, yl, yr);
+	m_mesh.setDomain(xl, xr, yl, yr);
+}
+
+void UserFunction::setMinZ(double z)
+{
+	Function::setMinZ(z);
+	m_zl = z;
+	m_mesh.setZRange(m_zl, m_zr);
+}
+
+void UserFunction::setMaxZ(double z)
+{
+	Function::setMaxZ(z);
+	m_zr = z;
+	m_mesh.setZRange(m_zl, m_zr);
+}
+
+bool UserFunction::create()
+{
+	if (!m_mesh.update())
+	{
+		QMessageBox::critical(0,"Input function error",m_mesh.error());
+		return false;
+	}
+
+	const QVector<double>& xs = m_mesh.xs();
+	const QVector<double>& ys = m_mesh.ys();
+	const QVector<double>& values = m_mesh.values();
+	int columns = xs.size(), rows = ys.size();
+	Qwt3D::Triple **data = new Qwt3D::Triple* [columns];
+	for (int i = 0; i < columns; i++)
+	{
+		data[i] = new Qwt3D::Triple [rows];
+		for (int j = 0; j < rows; j++)
+		{
+			double z = values.at(i*rows + j);
+			if (z > m_zr)
+				z = m_zr;
+			else if (z < m_zl)
+				z = m_zl;
+			data[i][j] = Triple(xs.at(i), ys.at(j), z);
+		}
+	}
+	m_plot->loadFromData(data, columns, rows, false, false);
+	for (int i = 0; i < columns; i++)
+		delete [] data[i];
+	delete [] data;
+	return true;
 }
 
 Graph3D::Graph3D(const QString & name)
@@ -154,6 +227,12 @@ void Graph3D::createActions()
 	action_plot_wire_surface = new QAction(QIcon(QPixmap(":/grid_poly.xpm")), tr("3D Wire &Surface"), this);
 	actionManager()->addAction(action_plot_wire_surface, "action_plot_wire_surface");
 
+	action_plot_xyz_surface = new QAction(QIcon(QPixmap(":/grid_poly.xpm")), tr("3D Surface from &XYZ Columns..."), this);
+	actionManager()->addAction(action_plot_xyz_surface, "action_plot_xyz_surface");
+
+	action_surface_gridding = new QAction(tr("Surface &Gridding..."), this);
+	actionManager()->addAction(action_surface_gridding, "action_surface_gridding");
+
 // template for multisize icons:
 /*
 	icon_temp = new QIcon();
@@ -171,11 +250,15 @@ void Graph3D::connectActions()
 	connect(action_plot_wire_frame, SIGNAL(triggered()), this, SLOT(plot3DWireframe()));
 	connect(action_plot_polygons, SIGNAL(triggered()), this, SLOT(plot3DPolygons()));
 	connect(action_plot_wire_surface, SIGNAL(triggered()), this, SLOT(plot3DWireSurface()));
+	connect(action_plot_xyz_surface, SIGNAL(triggered()), this, SLOT(plot3DXYZSurface()));
+	connect(action_surface_gridding, SIGNAL(triggered()), this, SLOT(chooseGridding()));
 
 	m_view->addAction(action_plot_wire_frame);
 	m_view->addAction(action_plot_hidden_line);
 	m_view->addAction(action_plot_polygons);
 	m_view->addAction(action_plot_wire_surface);
+	m_view->addAction(action_plot_xyz_surface);
+	m_view->addAction(action_surface_gridding);
 }
 
 void Graph3D::initPlot()
@@ -240,6 +323,12 @@ void Graph3D::initPlot()
 		scaleType[j]=0;
 
 	pointStyle = None;
+	m_plot_type = Scatter;
+	m_gridding = Triangulation;
+	m_grid_columns = m_grid_rows = 100;
+	m_function_columns = 81;
+	m_function_rows = 61;
+	m_function_refinement = 2;
 	func = 0;
 	alpha = 1.0;
 	barsRad = 0.007;
@@ -299,7 +388,8 @@ void Graph3D::addFunction(const QString& s,double xl,double xr,double yl,
 
 	func= new UserFunction(s, *sp);
 
-	func->setMesh(41,31);
+	func->setMesh(m_function_columns, m_function_rows);
+	func->setRefinement(m_function_refinement);
 	func->setDomain(xl,xr,yl,yr);
 	func->setMinZ(zl);
 	func->setMaxZ(zr);
@@ -594,59 +684,23 @@ void Graph3D::changeDataColumn(Table* table, const QString& colName)
 void Graph3D::addData(Table* table, int xCol,int yCol,int zCol, int type)
 {
 	m_table=table;
-	int r = qMin(table->column(xCol)->rowCount(), qMin(table->column(yCol)->rowCount(), table->column(zCol)->rowCount()));
 
 	clearPlotAssociation();
 	plotAssociation.table = table;
 	plotAssociation.x_index = xCol;
 	plotAssociation.y_index = yCol;
 	plotAssociation.z_index = zCol;
+	m_plot_type = (PlotType)type;
 
-	int i,j,columns=0;
-	for ( i = 0; i < r; i++)
+	ScatteredData points;
+	points.setData(table->column(xCol), table->column(yCol), table->column(zCol));
+	if (!loadXYZData(points))
 	{
-// old code:
-/*
-		if (!table->text(i,xCol).isEmpty() && !table->text(i,yCol).isEmpty() && !table->text(i,zCol).isEmpty())
-			columns++;
-*/
-
-		columns++;
-	}
-
-	if (columns == 0)
-		columns++;
-
-	Qwt3D::Triple **data=allocateData(columns,columns);
-	for (j = 0; j < columns; j++)
-	{
-		int k=0;
-		for ( i = 0; i < r; i++)
-		{
-// old code:
-/*
-			if(!table->text(i,xCol).isEmpty() && !table->text(i,yCol).isEmpty() && !table->text(i,zCol).isEmpty())
-			{
-				double xv=table->cell(i,xCol);
-				double yv=table->cell(i,yCol);
-				double zv=table->cell(i,zCol);
-
-				data[k][j] = Triple(xv,yv,zv);
-				k++;
-			}
-*/
-				double xv = table->column(xCol)->valueAt(i);
-				double yv = table->column(yCol)->valueAt(i);
-				double zv = table->column(zCol)->valueAt(i);
-
-				data[k][j] = Triple(xv,yv,zv);
-				k++;
-		}
+		sp->setPlotStyle(NOPLOT);
+		update();
+		return;
 	}
 
-	sp->makeCurrent();
-	sp->loadFromData (data, columns, columns, false,false);
-
 	double start, end;
 	sp->coordinates()->axes[Z1].limits (start, end);
 	sp->legend()->setLimits(start, end);
@@ -664,6 +718,12 @@ void Graph3D::addData(Table* table, int xCol,int yCol,int zCol, int type)
 		legendOn=false;
 		sp->showColorLegend(legendOn);
 	}
+	else if (type == Surface)
+	{
+		sp->setPlotStyle(FILLEDMESH);
+		pointStyle=None;
+		style_ = FILLEDMESH;
+	}
 	else
 	{
 		sp->setPlotStyle(Bar3D(barsRad));
@@ -673,14 +733,12 @@ void Graph3D::addData(Table* table, int xCol,int yCol,int zCol, int type)
 
 	if (m_autoscale)
 		findBestLayout();
-	deleteData(data,columns);
 }
 
 void Graph3D::addData(Table* table, int xCol,int yCol,int zCol,
 		double xl, double xr, double yl, double yr, double zl, double zr)
 {
 	m_table=table;
-	int r = qMin(table->column(xCol)->rowCount(), qMin(table->column(yCol)->rowCount(), table->column(zCol)->rowCount()));
 
 	clearPlotAssociation();
 	plotAssociation.table = table;
@@ -688,76 +746,18 @@ void Graph3D::addData(Table* table, int xCol,int yCol,int zCol,
 	plotAssociation.y_index = yCol;
 	plotAssociation.z_index = zCol;
 
-	int i,j,columns=0;
-	double xv,yv;
-	for ( i = 0; i < r; i++)
+	ScatteredData points;
+	points.setData(table->column(xCol), table->column(yCol), table->column(zCol));
+	points.clip(xl, xr, yl, yr, zl, zr);
+	if (!loadXYZData(points))
 	{
-// old code:
-/*
-		if (!table->text(i,xCol).isEmpty() && !table->text(i,yCol).isEmpty() && !table->text(i,zCol).isEmpty())
-		{
-			xv=table->cell(i,xCol);
-			yv=table->cell(i,yCol);
-			if (xv >= xl && xv <= xr && yv >= yl && yv <= yr)
-				columns++;
-		}
-*/
-		xv = table->column(xCol)->valueAt(i);
-		yv = table->column(yCol)->valueAt(i);
-		if (xv >= xl && xv <= xr && yv >= yl && yv <= yr)
-			columns++;
-	}
-
-	if (columns == 0)
-		columns++;
-
-	Qwt3D::Triple **data=allocateData(columns,columns);
-	for (j = 0; j < columns; j++)
-	{
-		int k=0;
-		for ( i = 0; i < r; i++)
-		{
-// old code:
-/*
-			if (!table->text(i,xCol).isEmpty() && !table->text(i,yCol).isEmpty() && !table->text(i,zCol).isEmpty())
-			{
-				xv=table->cell(i,xCol);
-				yv=table->cell(i,yCol);
-				if (xv >= xl && xv <= xr && yv >= yl && yv <= yr)
-				{
-					double zv=table->cell(i,zCol);
-					if (zv > zr)
-						data[k][j] = Triple(xv,yv,zr);
-					else if (zv < zl)
-						data[k][j] = Triple(xv,yv,zl);
-					else
-						data[k][j] = Triple(xv,yv,zv);
-					k++;
-				}
-			}
-*/
-			xv = table->column(xCol)->valueAt(i);
-			yv = table->column(yCol)->valueAt(i);
-			if (xv >= xl && xv <= xr && yv >= yl && yv <= yr)
-			{
-				double zv = table->column(zCol)->valueAt(i);
-				if (zv > zr)
-					data[k][j] = Triple(xv,yv,zr);
-				else if (zv < zl)
-					data[k][j] = Triple(xv,yv,zl);
-				else
-					data[k][j] = Triple(xv,yv,zv);
-				k++;
-			}
-		}
+		sp->setPlotStyle(NOPLOT);
+		update();
+		return;
 	}
-	sp->makeCurrent();
-	sp->loadFromData (data, columns, columns, false, false);
 	sp->createCoordinateSystem(Triple(xl, yl, zl), Triple(xr, yr, zr));
 	sp->legend()->setLimits(zl, zr);
 	sp->legend()->setMajors(legendMajorTicks);
-
-	deleteData(data,columns);
 }
 
 void Graph3D::updateData(Table* table)
@@ -859,70 +859,100 @@ void Graph3D::updateDataXY(Table* table, int xCol, int yCol)
 
 void Graph3D::updateDataXYZ(Table* table, int xCol, int yCol, int zCol)
 {
-	int r = qMin(table->column(xCol)->rowCount(), qMin(table->column(yCol)->rowCount(), table->column(zCol)->rowCount()));
-
-	int i,j,columns=0;
-
-	for ( i = 0; i < r; i++)
+	ScatteredData points;
+	points.setData(table->column(xCol), table->column(yCol), table->column(zCol));
+	if (points.size() < 2)
 	{
-// old code:
-/*
-		if (!table->text(i,xCol).isEmpty() && !table->text(i,yCol).isEmpty() && !table->text(i,zCol).isEmpty())
-			columns++;
-*/
-		columns++;
+		sp->setPlotStyle(NOPLOT);
+		update();
+		return;
 	}
 
-	if (columns<2)
+	sp->makeCurrent();
+	resetNonEmptyStyle();
+
+	if (!loadXYZData(points))
 	{
 		sp->setPlotStyle(NOPLOT);
 		update();
 		return;
 	}
+	sp->legend()->setLimits(points.zMin(), points.zMax());
+	sp->legend()->setMajors(legendMajorTicks);
+}
 
-	Qwt3D::Triple **data=allocateData(columns,columns);
-	gsl_vector * z = gsl_vector_alloc (columns);
+bool Graph3D::loadXYZData(const ScatteredData& points)
+{
+	int n = points.size();
+	if (n < 1)
+		return false;
 
-	for ( j = 0; j < columns; j++)
-	{
-		int k=0;
-		for ( i = 0; i < r; i++)
+	sp->makeCurrent();
+	if (m_plot_type != Surface)
+	{// the point styles and trajectories only need the points, so two equal rows are enough
+		int columns = qMax(n, 2);
+		Qwt3D::Triple **data = allocateData(columns, 2);
+		for (int i = 0; i < columns; i++)
 		{
-// old code:
-/*
-			if (!table->text(i,xCol).isEmpty() && !table->text(i,yCol).isEmpty() && !table->text(i,zCol).isEmpty())
-			{
-				double xv=table->cell(i,xCol);
-				double yv=table->cell(i,yCol);
-				double zv=table->cell(i,zCol);
+			int k = qMin(i, n-1);
+			data[i][0] = data[i][1] = Triple(points.x(k), points.y(k), points.z(k));
+		}
+		sp->loadFromData(data, columns, 2, false, false);
+		deleteData(data, columns);
+		return true;
+	}
 
-				gsl_vector_set (z, k, zv);
-				data[k][j] = Triple(xv,yv,zv);
-				k++;
-			}
-*/
-			double xv = table->column(xCol)->valueAt(i);
-			double yv = table->column(yCol)->valueAt(i);
-			double zv = table->column(zCol)->valueAt(i);
+	if (m_gridding == Triangulation)
+	{
+		QVector<int> triangles = points.triangulate();
+		if (triangles.isEmpty())
+			return false;
 
-			gsl_vector_set (z, k, zv);
-			data[k][j] = Triple(xv,yv,zv);
-			k++;
+		Qwt3D::TripleField nodes(n);
+		for (int i = 0; i < n; i++)
+			nodes[i] = Triple(points.x(i), points.y(i), points.z(i));
+		Qwt3D::CellField cells(triangles.size()/3);
+		for (int i = 0; i < (int)cells.size(); i++)
+		{
+			Qwt3D::Cell cell(3);
+			for (int k = 0; k < 3; k++)
+				cell[k] = triangles.at(3*i + k);
+			cells[i] = cell;
 		}
+		sp->loadFromData(nodes, cells);
+		return true;
 	}
 
-	double minz=gsl_vector_min(z);
-	double maxz=gsl_vector_max(z);
-	gsl_vector_free (z);
-
-	sp->makeCurrent();
-	resetNonEmptyStyle();
+	ScatteredData::Method method = ScatteredData::NaturalNeighbour;
+	if (m_gridding == BinnedGrid)
+		method = ScatteredData::Binning;
+	else if (m_gridding == InverseDistanceGrid)
+		method = ScatteredData::InverseDistance;
+	QVector<double> z = points.resample(method, m_grid_columns, m_grid_rows,
+			points.xMin(), points.xMax(), points.yMin(), points.yMax());
+	if (z.isEmpty())
+		return false;
+
+	double **data = allocateMatrixData(m_grid_columns, m_grid_rows);
+	for (int i = 0; i < m_grid_columns; i++)
+		for (int j = 0; j < m_grid_rows; j++)
+			data[i][j] = z.at(i*m_grid_rows + j);
+	sp->loadFromData(data, m_grid_columns, m_grid_rows,
+			points.xMin(), points.xMax(), points.yMin(), points.yMax());
+	freeMatrixData(data, m_grid_columns);
+	return true;
+}
 
-	sp->loadFromData (data, columns, columns, false,false);
-	sp->legend()->setLimits(minz,maxz);
-	sp->legend()->setMajors(legendMajorTicks);
+void Graph3D::setGridding(Gridding method, int columns, int rows)
+{
+	if (m_gridding == method && m_grid_columns == columns && m_grid_rows == rows)
+		return;
 
-	deleteData(data,columns);
+	m_gridding = method;
+	m_grid_columns = qMax(columns, 2);
+	m_grid_rows = qMax(rows, 2);
+	if (m_plot_type == Surface && m_table && plotAssociation.z_index != -1)
+		updateData(m_table);
 }
 
 void Graph3D::updateMatrixData(Matrix* m)
@@ -1729,73 +1759,11 @@ void Graph3D::updateScales(double xl, double xr, double yl, double yr,double zl,
 void Graph3D::updateScales(double xl, double xr, double yl, double yr, double zl, double zr,
 		int xCol, int yCol, int zCol)
 {
-	int r = qMin(m_table->column(xCol)->rowCount(), qMin(m_table->column(yCol)->rowCount(), m_table->column(zCol)->rowCount()));
-	int i,j,columns=0;
-	double xv, yv, zv;
-	for ( i = 0; i < r; i++)
-	{
-// old code:
-/*
-		if (!m_table->text(i,xCol).isEmpty() && !m_table->text(i,yCol).isEmpty() && !m_table->text(i,zCol).isEmpty())
-		{
-			xv=m_table->cell(i,xCol);
-			yv=m_table->cell(i,yCol);
-			if (xv >= xl && xv <= xr && yv >= yl && yv <= yr)
-				columns++;
-		}
-*/
-		xv = m_table->column(xCol)->valueAt(i);
-		yv = m_table->column(yCol)->valueAt(i);
-		if (xv >= xl && xv <= xr && yv >= yl && yv <= yr)
-			columns++;
-	}
-
-	if (columns == 0)
-		columns++;
-
-	Qwt3D::Triple **data=allocateData(columns,columns);
-	for ( j = 0; j < columns; j++)
-	{
-		int k=0;
-		for ( i = 0; i < r; i++)
-		{
-// old code:
-/*
-			if (!m_table->text(i,xCol).isEmpty() && !m_table->text(i,yCol).isEmpty() && !m_table->text(i,zCol).isEmpty())
-			{
-				xv=m_table->cell(i,xCol);
-				yv=m_table->cell(i,yCol);
-				if (xv >= xl && xv <= xr && yv >= yl && yv <= yr )
-				{
-					zv=m_table->cell(i,zCol);
-					if (zv > zr)
-						data[k][j] = Triple(xv,yv,zr);
-					else if (zv < zl)
-						data[k][j] = Triple(xv,yv,zl);
-					else
-						data[k][j] = Triple(xv,yv,zv);
-					k++;
-				}
-			}
-*/
-			xv = m_table->column(xCol)->valueAt(i);
-			yv = m_table->column(yCol)->valueAt(i);
-			if (xv >= xl && xv <= xr && yv >= yl && yv <= yr )
-			{
-				zv = m_table->column(zCol)->valueAt(i);
-				if (zv > zr)
-					data[k][j] = Triple(xv,yv,zr);
-				else if (zv < zl)
-					data[k][j] = Triple(xv,yv,zl);
-				else
-					data[k][j] = Triple(xv,yv,zv);
-				k++;
-			}
-		}
-	}
-	sp->loadFromData (data, columns, columns, false,false);
+	ScatteredData points;
+	points.setData(m_table->column(xCol), m_table->column(yCol), m_table->column(zCol));
+	points.clip(xl, xr, yl, yr, zl, zr);
+	loadXYZData(points);
 	sp->createCoordinateSystem(Triple(xl, yl, zl), Triple(xr, yr, zr));
-	deleteData(data,columns);
 }
 
 void Graph3D::setTicks(const QStringList& options)
@@ -2752,6 +2720,21 @@ Qwt3D::COORDSTYLE Graph3D::coordStyle()
 	return sp->coordinates()->style();
 }
 
+void Graph3D::setFunctionMesh(int columns, int rows, int refinement)
+{
+	m_function_columns = qMax(columns, 3);
+	m_function_rows = qMax(rows, 3);
+	m_function_refinement = qMax(refinement, 0);
+	if (!func)
+		return;
+
+	sp->makeCurrent();
+	func->setMesh(m_function_columns, m_function_rows);
+	func->setRefinement(m_function_refinement);
+	func->create();
+	update();
+}
+
 QString Graph3D::formula()
 {
 	if (func)
@@ -3395,6 +3378,9 @@ bool Graph3D::fillProjectMenu(QMenu * menu)
 	menu->addAction(action_plot_hidden_line);
 	menu->addAction(action_plot_polygons);
 	menu->addAction(action_plot_wire_surface);
+	menu->addSeparator();
+	menu->addAction(action_plot_xyz_surface);
+	menu->addAction(action_surface_gridding);
 
 	return true;
 
@@ -3486,6 +3472,50 @@ void Graph3D::plot3DMatrix(int style)
 	RESET_CURSOR;
 }
 		
+void Graph3D::plot3DXYZSurface()
+{
+	Table * table = selectTable();
+	if (!table)
+		return;
+
+	int xcol = 0, ycol = 1, zcol = 2;
+	Gridding method = m_gridding;
+	int columns = m_grid_columns, rows = m_grid_rows;
+	if (!selectGridding(table, &xcol, &ycol, &zcol, &method, &columns, &rows))
+		return;
+
+	WAIT_CURSOR;
+
+	// set directly, setGridding() would reload a previous surface first
+	m_gridding = method;
+	m_grid_columns = qMax(columns, 2);
+	m_grid_rows = qMax(rows, 2);
+	addData(table, xcol, ycol, zcol, Surface);
+
+	sp->makeCurrent();
+	sp->updateGL();
+	m_view->update();
+
+	RESET_CURSOR;
+}
+
+void Graph3D::chooseGridding()
+{
+	Gridding method = m_gridding;
+	int columns = m_grid_columns, rows = m_grid_rows;
+	if (!selectGridding(0, 0, 0, 0, &method, &columns, &rows))
+		return;
+
+	WAIT_CURSOR;
+
+	setGridding(method, columns, rows);
+	sp->makeCurrent();
+	sp->updateGL();
+	m_view->update();
+
+	RESET_CURSOR;
+}
+		
 Matrix * Graph3D::selectMatrix()
 {
 	Project * prj = project();
@@ -3522,6 +3552,109 @@ Matrix * Graph3D::selectMatrix()
 		return 0;
 }
 
+Table * Graph3D::selectTable()
+{
+	Project * prj = project();
+	if (!prj) return 0;
+
+	QList<Table*> list = prj->children<Table>(Recursive);
+	if (list.isEmpty()) return 0;
+	
+	QDialog dialog;
+	QVBoxLayout layout(&dialog);
+	QLabel label(tr("Choose Table"));
+	QComboBox selection;
+	for (int i=0; i<list.size(); i++)
+		selection.addItem(list.at(i)->name(), i);
+
+	QDialogButtonBox button_box(&dialog);
+	button_box.setOrientation(Qt::Horizontal);
+	button_box.setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::NoButton|QDialogButtonBox::Ok);
+	QObject::connect(&button_box, SIGNAL(accepted()), &dialog, SLOT(accept()));
+	QObject::connect(&button_box, SIGNAL(rejected()), &dialog, SLOT(reject()));
+
+	layout.addWidget(&label);
+	layout.addWidget(&selection);
+	layout.addWidget(&button_box);
+
+	dialog.setWindowTitle(label.text());
+	if (dialog.exec() != QDialog::Accepted)
+		return 0;
+	int index = selection.currentIndex();
+	if (index >= 0 && index < list.size())
+		return list.at(index);
+	else
+		return 0;
+}
+
+bool Graph3D::selectGridding(Table * table, int * xcol, int * ycol, int * zcol,
+		Gridding * method, int * columns, int * rows)
+{
+	if (table && table->columnCount() < 3)
+	{
+		QMessageBox::warning(0, tr("Surface from XYZ Columns"),
+				tr("The table needs at least three columns."));
+		return false;
+	}
+
+	QDialog dialog;
+	QGridLayout layout(&dialog);
+	QComboBox column_boxes[3];
+	QString column_labels[3] = { tr("X column"), tr("Y column"), tr("Z column") };
+	int * column_indices[3] = { xcol, ycol, zcol };
+	int row = 0;
+	if (table)
+	{
+		for (int k=0; k<3; k++)
+		{
+			for (int i=0; i<table->columnCount(); i++)
+				column_boxes[k].addItem(table->column(i)->name());
+			column_boxes[k].setCurrentIndex(qMin(*column_indices[k], table->columnCount()-1));
+			layout.addWidget(new QLabel(column_labels[k], &dialog), row, 0);
+			layout.addWidget(&column_boxes[k], row++, 1);
+		}
+	}
+
+	QComboBox method_box;
+	method_box.addItem(tr("Delaunay triangulation"), Triangulation);
+	method_box.addItem(tr("Grid: average of the points in each cell"), BinnedGrid);
+	method_box.addItem(tr("Grid: inverse distance weighting"), InverseDistanceGrid);
+	method_box.addItem(tr("Grid: natural neighbour interpolation"), NaturalNeighbourGrid);
+	method_box.setCurrentIndex(method_box.findData(*method));
+	layout.addWidget(new QLabel(tr("Surface"), &dialog), row, 0);
+	layout.addWidget(&method_box, row++, 1);
+
+	// the resolution only applies to the grids
+	QSpinBox columns_box, rows_box;
+	columns_box.setRange(2, 2000);
+	columns_box.setValue(*columns);
+	rows_box.setRange(2, 2000);
+	rows_box.setValue(*rows);
+	layout.addWidget(new QLabel(tr("Grid columns"), &dialog), row, 0);
+	layout.addWidget(&columns_box, row++, 1);
+	layout.addWidget(new QLabel(tr("Grid rows"), &dialog), row, 0);
+	layout.addWidget(&rows_box, row++, 1);
+
+	QDialogButtonBox button_box(&dialog);
+	button_box.setOrientation(Qt::Horizontal);
+	button_box.setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::NoButton|QDialogButtonBox::Ok);
+	QObject::connect(&button_box, SIGNAL(accepted()), &dialog, SLOT(accept()));
+	QObject::connect(&button_box, SIGNAL(rejected()), &dialog, SLOT(reject()));
+	layout.addWidget(&button_box, row, 0, 1, 2);
+
+	dialog.setWindowTitle(table ? tr("Surface from XYZ Columns") : tr("Surface Gridding"));
+	if (dialog.exec() != QDialog::Accepted)
+		return false;
+
+	if (table)
+		for (int k=0; k<3; k++)
+			*column_indices[k] = column_boxes[k].currentIndex();
+	*method = (Gridding)method_box.itemData(method_box.currentIndex()).toInt();
+	*columns = columns_box.value();
+	*rows = rows_box.value();
+	return true;
+}
+
 /* ========================= static methods ======================= */
 ActionManager * Graph3D::action_manager = 0;
 
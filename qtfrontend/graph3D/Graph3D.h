@@ -36,10 +36,13 @@
 #include <QTimer>
 #include <QWidget>
 #include "core/AbstractPart.h"
+#include "FunctionMesh.h"
 
 class Table;
+class ScatteredData;
 class Matrix;
 class UserFunction;
+class MyParser;
 class ActionManager;
 
 class QEvent;
@@ -70,7 +73,9 @@ class Graph3D: public AbstractPart
 		Graph3D (const QString & name);
 		~Graph3D();
 
-		enum PlotType{Scatter=0, Trajectory = 1, Bars = 2};
+		enum PlotType{Scatter=0, Trajectory = 1, Bars = 2, Surface = 3};
+		//! How a Surface is made from scattered XYZ data (see ScatteredData)
+		enum Gridding{Triangulation=0, BinnedGrid=1, InverseDistanceGrid=2, NaturalNeighbourGrid=3};
 		enum PointStyle{None=0, Dots=1, VerticalBars=2, HairCross=3, Cones=4};
 
 		Qwt3D::SurfacePlot* sp;
@@ -134,10 +139,24 @@ class Graph3D: public AbstractPart
 		void changeMatrix(Matrix* m);
 		void changeDataColumn(Table* table, const QString& colName);
 
+		//! \name Gridding of XYZ data
+		//@{
+		//! Set how Surface plots of XYZ data are made; columns and rows apply to the resampling methods
+		void setGridding(Gridding method, int columns = 100, int rows = 100);
+		Gridding gridding(){return m_gridding;};
+		int gridColumns(){return m_grid_columns;};
+		int gridRows(){return m_grid_rows;};
+		//@}
+
 		//! \name User Functions
 		//@{
 		UserFunction* userFunction();
 		QString formula();
+		//! Set the initial mesh of function plots and how often it may be refined
+		void setFunctionMesh(int columns, int rows, int refinement);
+		int functionColumns(){return m_function_columns;};
+		int functionRows(){return m_function_rows;};
+		int functionRefinement(){return m_function_refinement;};
 		//@}
 
 		//! \name Event Handlers
@@ -385,8 +404,13 @@ class Graph3D: public AbstractPart
 		void plot3DPolygons();
 		void plot3DWireSurface();
 		void plot3DMatrix(int style);
+		//! Plot three columns of a table as a Surface, asking for the columns and the gridding
+		void plot3DXYZSurface();
+		//! Ask for the gridding of Surface plots of XYZ data (see setGridding())
+		void chooseGridding();
 
 		Matrix * selectMatrix();
+		Table * selectTable();
 
 	public:
 		static ActionManager * actionManager();
@@ -411,6 +435,16 @@ class Graph3D: public AbstractPart
 		static double** allocateMatrixData(int rows, int columns);
 		//! Free memory used for a matrix buffer
 		static void freeMatrixData(double **data, int rows);
+		//! Load XYZ data into the plot as points or as a surface (depending on m_plot_type)
+		/**
+		 * The size of the mesh depends on the number of points (points, triangulation)
+		 * or on the grid size (resampling), not on the square of the number of points.
+		 * Returns false if there is nothing to plot.
+		 */
+		bool loadXYZData(const ScatteredData& points);
+		//! Ask for the gridding and, unless 'table' is 0, for the x, y and z columns of a Surface
+		bool selectGridding(Table * table, int * xcol, int * ycol, int * zcol,
+				Gridding * method, int * columns, int * rows);
 
 		//! Wait this many msecs before redraw 3D plot (used for animations)
 		int animation_redraw_wait;
@@ -454,6 +488,12 @@ class Graph3D: public AbstractPart
 		bool crossHairSmooth, crossHairBoxed;
 		int conesQuality;
 		PointStyle pointStyle;
+		//! Type of the plot of XYZ data
+		PlotType m_plot_type;
+		Gridding m_gridding;
+		int m_grid_columns, m_grid_rows;
+		//! Mesh of function plots (see UserFunction)
+		int m_function_columns, m_function_rows, m_function_refinement;
 		Table *m_table;
 		Matrix *m_matrix;
 		Qwt3D::PLOTSTYLE style_;
@@ -465,9 +505,16 @@ class Graph3D: public AbstractPart
 		QAction * action_plot_hidden_line;
 		QAction * action_plot_polygons;
 		QAction * action_plot_wire_surface;
+		QAction * action_plot_xyz_surface;
+		QAction * action_surface_gridding;
 };
 
 //! Class for user defined functions
+/**
+ * The surface is evaluated by a FunctionMesh, which refines the mesh where the surface is
+ * curved and caches it: create() only evaluates the formula again after the domain, the
+ * mesh or the refinement changed, not for a new z range or any change of style.
+ */
 class UserFunction : public Function
 {
 	public:
@@ -477,8 +524,33 @@ class UserFunction : public Function
 		double operator()(double x, double y);
 		QString function(){return formula;};
 
+		//! \name Mesh
+		/**
+		 * These hide the (non-virtual) methods of Qwt3D::Function in order to keep track
+		 * of the cached mesh.
+		 */
+		//@{
+		void setMesh(unsigned int columns, unsigned int rows);
+		void setDomain(double xl, double xr, double yl, double yr);
+		void setMinZ(double z);
+		void setMaxZ(double z);
+		//! Set how often the intervals of the mesh may be halved where the surface is curved
+		void setRefinement(int levels){m_mesh.setRefinement(levels);};
+		int refinement(){return m_mesh.refinement();};
+		//@}
+
+		//! Load the surface into the plot (evaluating the formula only if the mesh changed)
+		bool create();
+
 	private:
 		QString formula;
+		SurfacePlot *m_plot;
+		//! Parser used by operator()
+		MyParser *m_parser;
+		double m_x, m_y;
+
+		double m_zl, m_zr;
+		FunctionMesh m_mesh;
 };
 
 #endif // Plot3D_H
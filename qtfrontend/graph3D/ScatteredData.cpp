@@ -0,0 +1,730 @@
+/***************************************************************************
+    File                 : ScatteredData.cpp
+    Project              : SciDAVis
+    Description          : Triangulation and gridding of scattered (x,y,z) data
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "ScatteredData.h"
+#include "core/AbstractColumn.h"
+#include "lib/ParallelFor.h"
+
+#include <QtAlgorithms>
+#include <QPair>
+
+#include <math.h>
+
+//! Average number of points per cell of the bucket grid used for nearest point queries
+static const int points_per_bucket = 2;
+//! Minimum number of grid columns handled by one thread in resample()
+static const int min_columns_per_thread = 8;
+
+//! False for NaN and infinite values
+static inline bool isFinite(double v)
+{
+	return v == v && v - v == 0;
+}
+
+/* ========================= nearest point queries ========================= */
+
+//! Points of the unit square sorted into a uniform grid of buckets, for nearest point queries
+class PointBuckets
+{
+	public:
+		PointBuckets(const QVector<double>& u, const QVector<double>& v)
+			: m_u(u), m_v(v)
+		{
+			int n = u.size();
+			m_size = qMax(1, (int)sqrt((double)n / points_per_bucket));
+			m_cell_start.fill(0, m_size * m_size + 1);
+			QVector<int> cells(n);
+			for (int i=0; i<n; i++)
+			{
+				cells[i] = cell(u.at(i)) * m_size + cell(v.at(i));
+				m_cell_start[cells.at(i)+1]++;
+			}
+			for (int c=0; c<m_size*m_size; c++)
+				m_cell_start[c+1] += m_cell_start.at(c);
+			QVector<int> next(m_cell_start);
+			m_points.resize(n);
+			for (int i=0; i<n; i++)
+				m_points[next[cells.at(i)]++] = i;
+		}
+
+		//! Find the 'k' points closest to (u,v)
+		/**
+		 * Stores the indices of the points sorted by distance in 'points' and their squared
+		 * distances in 'dist2' (both must have room for k entries); returns the number found.
+		 */
+		int nearest(double u, double v, int k, int * points, double * dist2) const
+		{
+			int found = 0;
+			int ci = cell(u), cj = cell(v);
+			double h = 1.0 / m_size;
+			for (int r=0; r<m_size; r++)
+			{
+				for (int i=qMax(0, ci-r); i<=qMin(m_size-1, ci+r); i++)
+				{
+					// the first and last row of the ring are complete, the others only have two cells
+					int step = (i == ci-r || i == ci+r) ? 1 : 2*r;
+					for (int j=cj-r; j<=cj+r; j+=step)
+						if (j >= 0 && j < m_size)
+							searchCell(i * m_size + j, u, v, k, points, dist2, &found);
+				}
+				// all points not looked at yet are at least r*h away
+				if (found == k && dist2[k-1] <= r*h * r*h)
+					break;
+			}
+			return found;
+		}
+
+		//! Return the point closest to (u,v) and store its squared distance in 'dist2'
+		int nearest(double u, double v, double * dist2) const
+		{
+			int point = -1;
+			nearest(u, v, 1, &point, dist2);
+			return point;
+		}
+
+	private:
+		//! Bucket row/column containing the coordinate t (clamped to the grid)
+		int cell(double t) const
+		{
+			int c = (int)(t * m_size);
+			return qBound(0, c, m_size-1);
+		}
+		//! Merge the points of cell c into the sorted list of the 'found' closest points
+		void searchCell(int c, double u, double v, int k, int * points, double * dist2, int * found) const
+		{
+			for (int p=m_cell_start.at(c); p<m_cell_start.at(c+1); p++)
+			{
+				int point = m_points.at(p);
+				double du = m_u.at(point) - u, dv = m_v.at(point) - v;
+				double d2 = du*du + dv*dv;
+				if (*found == k && d2 >= dist2[k-1])
+					continue;
+				int pos = (*found < k) ? (*found)++ : k-1;
+				while (pos > 0 && dist2[pos-1] > d2)
+				{
+					dist2[pos] = dist2[pos-1];
+					points[pos] = points[pos-1];
+					pos--;
+				}
+				dist2[pos] = d2;
+				points[pos] = point;
+			}
+		}
+
+		const QVector<double>& m_u;
+		const QVector<double>& m_v;
+		int m_size;
+		QVector<int> m_cell_start;
+		QVector<int> m_points;
+};
+
+/* ========================= triangulation ========================= */
+
+struct DelaunayTriangle
+{
+	//! Vertices in counter-clockwise order; v[0] is -1 for a deleted triangle
+	int v[3];
+	//! n[k] is the triangle on the other side of the edge opposite to v[k] (-1: none)
+	int n[3];
+};
+
+//! An edge on the boundary of the cavity of an inserted point
+struct CavityEdge
+{
+	int a, b;
+	//! Triangle on the outer side of the edge
+	int outer;
+	//! The triangle created for this edge
+	int triangle;
+};
+
+//! Incremental (Bowyer-Watson) Delaunay triangulation of points in the unit square
+class DelaunayTriangulation
+{
+	public:
+		DelaunayTriangulation(const QVector<double>& u, const QVector<double>& v)
+			: m_u(u), m_v(v), m_last(0)
+		{
+			// enclosing triangle, vertices u.size() ... u.size()+2
+			m_super = m_u.size();
+			m_u << -100 << 200 << -100;
+			m_v << -100 << -100 << 200;
+			DelaunayTriangle t = { { m_super, m_super+1, m_super+2 }, { -1, -1, -1 } };
+			m_triangles << t;
+			m_mark << 0;
+		}
+
+		//! Insert point p; returns false if it coincides with a vertex
+		bool insert(int p);
+		//! Return the triangles not touching the enclosing triangle (three vertices each)
+		QVector<int> triangles() const;
+
+	private:
+		double orient(int a, int b, int p) const
+		{
+			return (m_u.at(b) - m_u.at(a)) * (m_v.at(p) - m_v.at(a)) -
+				(m_v.at(b) - m_v.at(a)) * (m_u.at(p) - m_u.at(a));
+		}
+		//! Positive if p lies inside the circumcircle of triangle t
+		double inCircle(int t, int p) const
+		{
+			const DelaunayTriangle &tr = m_triangles.at(t);
+			double adx = m_u.at(tr.v[0]) - m_u.at(p), ady = m_v.at(tr.v[0]) - m_v.at(p);
+			double bdx = m_u.at(tr.v[1]) - m_u.at(p), bdy = m_v.at(tr.v[1]) - m_v.at(p);
+			double cdx = m_u.at(tr.v[2]) - m_u.at(p), cdy = m_v.at(tr.v[2]) - m_v.at(p);
+			return (adx*adx + ady*ady) * (bdx*cdy - cdx*bdy)
+				+ (bdx*bdx + bdy*bdy) * (cdx*ady - adx*cdy)
+				+ (cdx*cdx + cdy*cdy) * (adx*bdy - bdx*ady);
+		}
+		int locate(int p) const;
+		int newTriangle();
+
+		QVector<double> m_u, m_v;
+		QVector<DelaunayTriangle> m_triangles;
+		//! Per triangle: number of the insertion which put it into the cavity
+		QVector<int> m_mark;
+		QVector<int> m_free;
+		int m_super;
+		int m_last;
+};
+
+int DelaunayTriangulation::locate(int p) const
+{
+	// walk towards p, starting at the last triangle created; since the points are
+	// inserted along a space-filling curve the walks are short
+	int t = m_last;
+	int max_steps = m_triangles.size();
+	for (int step=0; step<max_steps; step++)
+	{
+		const DelaunayTriangle &tr = m_triangles.at(t);
+		int next = -1;
+		for (int k=0; k<3 && next<0; k++)
+		{
+			int e = (k + step) % 3; // vary the first edge tested so the walk can't cycle
+			if (orient(tr.v[(e+1)%3], tr.v[(e+2)%3], p) < 0)
+				next = tr.n[e];
+		}
+		if (next < 0)
+			return t;
+		t = next;
+	}
+	// only reached with badly conditioned input: search all triangles
+	for (t=0; t<m_triangles.size(); t++)
+	{
+		const DelaunayTriangle &tr = m_triangles.at(t);
+		if (tr.v[0] >= 0 && orient(tr.v[1], tr.v[2], p) >= 0 &&
+				orient(tr.v[2], tr.v[0], p) >= 0 && orient(tr.v[0], tr.v[1], p) >= 0)
+			return t;
+	}
+	return m_last;
+}
+
+int DelaunayTriangulation::newTriangle()
+{
+	if (!m_free.isEmpty())
+		return m_free.takeLast();
+	DelaunayTriangle t = { { -1, -1, -1 }, { -1, -1, -1 } };
+	m_triangles << t;
+	m_mark << 0;
+	return m_triangles.size() - 1;
+}
+
+bool DelaunayTriangulation::insert(int p)
+{
+	int start = locate(p);
+	for (int k=0; k<3; k++)
+	{
+		int q = m_triangles.at(start).v[k];
+		if (m_u.at(q) == m_u.at(p) && m_v.at(q) == m_v.at(p))
+			return false;
+	}
+
+	// collect the triangles whose circumcircle contains p
+	int stamp = p + 1;
+	QVector<int> cavity;
+	cavity << start;
+	m_mark[start] = stamp;
+	QVector<CavityEdge> boundary;
+	for (bool valid = false; !valid; )
+	{
+		for (int c=0; c<cavity.size(); c++)
+		{
+			const DelaunayTriangle &tr = m_triangles.at(cavity.at(c));
+			for (int k=0; k<3; k++)
+			{
+				int nb = tr.n[k];
+				if (nb >= 0 && m_mark.at(nb) != stamp && inCircle(nb, p) > 0)
+				{
+					m_mark[nb] = stamp;
+					cavity << nb;
+				}
+			}
+		}
+		// rounding errors may leave the cavity not star-shaped as seen from p;
+		// in that case grow it across the offending edges and try again
+		valid = true;
+		boundary.clear();
+		for (int c=0; c<cavity.size(); c++)
+		{
+			const DelaunayTriangle &tr = m_triangles.at(cavity.at(c));
+			for (int k=0; k<3; k++)
+			{
+				int nb = tr.n[k];
+				if (nb >= 0 && m_mark.at(nb) == stamp)
+					continue;
+				CavityEdge e = { tr.v[(k+1)%3], tr.v[(k+2)%3], nb, -1 };
+				if (orient(e.a, e.b, p) <= 0 && nb >= 0)
+				{
+					m_mark[nb] = stamp;
+					cavity << nb;
+					valid = false;
+				}
+				boundary << e;
+			}
+		}
+	}
+
+	foreach(int t, cavity)
+	{
+		m_triangles[t].v[0] = -1;
+		m_free << t;
+	}
+
+	// fan the boundary of the cavity around p
+	for (int i=0; i<boundary.size(); i++)
+	{
+		CavityEdge &e = boundary[i];
+		e.triangle = newTriangle();
+		DelaunayTriangle &tr = m_triangles[e.triangle];
+		tr.v[0] = e.a;
+		tr.v[1] = e.b;
+		tr.v[2] = p;
+		tr.n[2] = e.outer;
+		m_mark[e.triangle] = 0;
+		if (e.outer >= 0)
+		{
+			DelaunayTriangle &outer = m_triangles[e.outer];
+			// match the edge by its vertices: the index of the cavity triangle may be reused already
+			for (int k=0; k<3; k++)
+				if (outer.v[(k+1)%3] == e.b && outer.v[(k+2)%3] == e.a)
+					outer.n[k] = e.triangle;
+		}
+	}
+	for (int i=0; i<boundary.size(); i++)
+	{
+		DelaunayTriangle &tr = m_triangles[boundary.at(i).triangle];
+		for (int j=0; j<boundary.size(); j++)
+		{
+			if (boundary.at(j).a == tr.v[1]) // shares the edge b-p
+				tr.n[0] = boundary.at(j).triangle;
+			if (boundary.at(j).b == tr.v[0]) // shares the edge p-a
+				tr.n[1] = boundary.at(j).triangle;
+		}
+	}
+	m_last = boundary.first().triangle;
+	return true;
+}
+
+QVector<int> DelaunayTriangulation::triangles() const
+{
+	QVector<int> result;
+	foreach(const DelaunayTriangle& t, m_triangles)
+		if (t.v[0] >= 0 && t.v[0] < m_super && t.v[1] < m_super && t.v[2] < m_super)
+			result << t.v[0] << t.v[1] << t.v[2];
+	return result;
+}
+
+//! Position of (x,y) on a Hilbert curve through a 65536x65536 grid
+static quint32 hilbertIndex(quint32 x, quint32 y)
+{
+	const quint32 n = 1 << 16;
+	quint32 d = 0;
+	for (quint32 s = n/2; s > 0; s /= 2)
+	{
+		quint32 rx = (x & s) ? 1 : 0;
+		quint32 ry = (y & s) ? 1 : 0;
+		d += s * s * ((3 * rx) ^ ry);
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = n-1 - x;
+				y = n-1 - y;
+			}
+			qSwap(x, y);
+		}
+	}
+	return d;
+}
+
+//! Computes the Hilbert curve positions of a range of points
+class HilbertKernel
+{
+	public:
+		HilbertKernel(const QVector<double>& u, const QVector<double>& v, QVector< QPair<quint32, int> >& keys)
+			: m_u(u), m_v(v), m_keys(keys) {}
+		void operator()(int first, int last) const
+		{
+			for (int i=first; i<=last; i++)
+				m_keys[i] = qMakePair(hilbertIndex((quint32)(m_u.at(i) * 65535), (quint32)(m_v.at(i) * 65535)), i);
+		}
+	private:
+		const QVector<double>& m_u;
+		const QVector<double>& m_v;
+		QVector< QPair<quint32, int> >& m_keys;
+};
+
+/* ========================= resampling kernels ========================= */
+
+//! Geometry of the output grid of resample(), in coordinates scaled to the bounding box of the points
+struct GridGeometry
+{
+	int columns, rows;
+	double u0, v0, du, dv;
+	double u(int i) const { return u0 + i * du; }
+	double v(int j) const { return v0 + j * dv; }
+};
+
+//! Fills the nodes of a range of grid columns by inverse distance weighting
+class InverseDistanceKernel
+{
+	public:
+		InverseDistanceKernel(const PointBuckets& buckets, const QVector<double>& z, const GridGeometry& grid,
+				int neighbours, double power, QVector<double>& result)
+			: m_buckets(buckets), m_z(z), m_grid(grid), m_neighbours(neighbours), m_power(power), m_result(result) {}
+		void operator()(int first, int last) const
+		{
+			QVector<int> points(m_neighbours);
+			QVector<double> dist2(m_neighbours);
+			for (int i=first; i<=last; i++)
+				for (int j=0; j<m_grid.rows; j++)
+				{
+					int found = m_buckets.nearest(m_grid.u(i), m_grid.v(j), m_neighbours,
+							points.data(), dist2.data());
+					double sum = 0, weights = 0;
+					for (int k=0; k<found; k++)
+					{
+						if (dist2.at(k) == 0)
+						{
+							sum = m_z.at(points.at(k));
+							weights = 1;
+							break;
+						}
+						double w = pow(dist2.at(k), -0.5 * m_power);
+						sum += w * m_z.at(points.at(k));
+						weights += w;
+					}
+					m_result[i*m_grid.rows + j] = sum / weights;
+				}
+		}
+	private:
+		const PointBuckets& m_buckets;
+		const QVector<double>& m_z;
+		GridGeometry m_grid;
+		int m_neighbours;
+		double m_power;
+		QVector<double>& m_result;
+};
+
+//! Finds the closest point of each node of a range of grid columns
+/**
+ * If 'only_empty' is given, only the nodes for which it is 0 are handled.
+ */
+class NearestPointKernel
+{
+	public:
+		NearestPointKernel(const PointBuckets& buckets, const GridGeometry& grid,
+				QVector<int>& nearest, QVector<double>& dist2, const QVector<int> * only_empty = 0)
+			: m_buckets(buckets), m_grid(grid), m_nearest(nearest), m_dist2(dist2), m_only_empty(only_empty) {}
+		void operator()(int first, int last) const
+		{
+			for (int i=first; i<=last; i++)
+				for (int j=0; j<m_grid.rows; j++)
+				{
+					int node = i*m_grid.rows + j;
+					if (m_only_empty && m_only_empty->at(node) != 0)
+						continue;
+					m_nearest[node] = m_buckets.nearest(m_grid.u(i), m_grid.v(j), &m_dist2[node]);
+				}
+		}
+	private:
+		const PointBuckets& m_buckets;
+		GridGeometry m_grid;
+		QVector<int>& m_nearest;
+		QVector<double>& m_dist2;
+		const QVector<int> * m_only_empty;
+};
+
+//! Discrete Sibson interpolation for a range of grid columns
+/**
+ * Every node p spreads the value of its closest point to all nodes inside the circle
+ * around p through that point; the value of a node is the average of what it received.
+ * The kernel gathers the contributions to its own columns, so the threads don't share
+ * any output. The contributions of one circle to one column form a run of rows, which is
+ * added in constant time using difference arrays. Nodes on a point keep its value, even if
+ * they lie on the boundary of the circle of a node with another closest point.
+ */
+class NaturalNeighbourKernel
+{
+	public:
+		NaturalNeighbourKernel(const QVector<double>& z, const GridGeometry& grid,
+				const QVector<int>& nearest, const QVector<double>& dist2, int max_radius,
+				QVector<double>& result)
+			: m_z(z), m_grid(grid), m_nearest(nearest), m_dist2(dist2), m_max_radius(max_radius),
+			m_on_point(1e-12 * (grid.du*grid.du + grid.dv*grid.dv)), m_result(result) {}
+		void operator()(int first, int last) const
+		{
+			int rows = m_grid.rows;
+			QVector<double> sum((last - first + 1) * (rows + 1), 0.0);
+			QVector<int> count((last - first + 1) * (rows + 1), 0);
+			int from = qMax(0, first - m_max_radius), to = qMin(m_grid.columns - 1, last + m_max_radius);
+			for (int pi=from; pi<=to; pi++)
+				for (int pj=0; pj<rows; pj++)
+				{
+					int node = pi*rows + pj;
+					double r2 = m_dist2.at(node);
+					double value = m_z.at(m_nearest.at(node));
+					int reach = (int)(sqrt(r2) / m_grid.du);
+					for (int i=qMax(first, pi - reach); i<=qMin(last, pi + reach); i++)
+					{
+						double di = (i - pi) * m_grid.du;
+						int half = (int)(sqrt(qMax(0.0, r2 - di*di)) / m_grid.dv);
+						int j1 = qMax(0, pj - half), j2 = qMin(rows - 1, pj + half);
+						int base = (i - first) * (rows + 1);
+						sum[base + j1] += value;
+						sum[base + j2 + 1] -= value;
+						count[base + j1]++;
+						count[base + j2 + 1]--;
+					}
+				}
+			for (int i=first; i<=last; i++)
+			{
+				int base = (i - first) * (rows + 1);
+				double s = 0;
+				int c = 0;
+				for (int j=0; j<rows; j++)
+				{
+					s += sum.at(base + j);
+					c += count.at(base + j);
+					int node = i*rows + j;
+					m_result[node] = m_dist2.at(node) <= m_on_point ? m_z.at(m_nearest.at(node)) : s / c;
+				}
+			}
+		}
+	private:
+		const QVector<double>& m_z;
+		GridGeometry m_grid;
+		const QVector<int>& m_nearest;
+		const QVector<double>& m_dist2;
+		int m_max_radius;
+		//! Squared distance below which a node counts as lying on its closest point
+		double m_on_point;
+		QVector<double>& m_result;
+};
+
+/* ========================= ScatteredData ========================= */
+
+ScatteredData::ScatteredData()
+	: m_x_min(0), m_x_max(0), m_y_min(0), m_y_max(0), m_z_min(0), m_z_max(0),
+	m_idw_power(2.0), m_idw_neighbours(12)
+{
+}
+
+void ScatteredData::setData(const AbstractColumn *x, const AbstractColumn *y, const AbstractColumn *z)
+{
+	m_x.clear();
+	m_y.clear();
+	m_z.clear();
+	if (x && y && z)
+	{
+		ValueSpan xs = x->valueSpan(), ys = y->valueSpan(), zs = z->valueSpan();
+		int first = qMax(xs.first(), qMax(ys.first(), zs.first()));
+		int last = qMin(xs.rows().end(), qMin(ys.rows().end(), zs.rows().end()));
+		if (last >= first)
+		{
+			m_x.reserve(last - first + 1);
+			m_y.reserve(last - first + 1);
+			m_z.reserve(last - first + 1);
+		}
+		for (int row=first; row<=last; row++)
+		{
+			int i = row - xs.first(), j = row - ys.first(), k = row - zs.first();
+			if (xs.isInvalid(i) || ys.isInvalid(j) || zs.isInvalid(k))
+				continue;
+			double xv = xs.at(i), yv = ys.at(j), zv = zs.at(k);
+			if (!isFinite(xv) || !isFinite(yv) || !isFinite(zv))
+				continue;
+			m_x << xv;
+			m_y << yv;
+			m_z << zv;
+		}
+	}
+	updateLimits();
+}
+
+void ScatteredData::clip(double xl, double xr, double yl, double yr, double zl, double zr)
+{
+	int count = 0;
+	for (int i=0; i<m_x.size(); i++)
+	{
+		double xv = m_x.at(i), yv = m_y.at(i);
+		if (xv < xl || xv > xr || yv < yl || yv > yr)
+			continue;
+		m_x[count] = xv;
+		m_y[count] = yv;
+		m_z[count] = qBound(zl, m_z.at(i), zr);
+		count++;
+	}
+	m_x.resize(count);
+	m_y.resize(count);
+	m_z.resize(count);
+	updateLimits();
+}
+
+void ScatteredData::updateLimits()
+{
+	m_x_min = m_x_max = m_y_min = m_y_max = m_z_min = m_z_max = 0;
+	for (int i=0; i<m_x.size(); i++)
+	{
+		if (i == 0)
+		{
+			m_x_min = m_x_max = m_x.at(0);
+			m_y_min = m_y_max = m_y.at(0);
+			m_z_min = m_z_max = m_z.at(0);
+			continue;
+		}
+		m_x_min = qMin(m_x_min, m_x.at(i));
+		m_x_max = qMax(m_x_max, m_x.at(i));
+		m_y_min = qMin(m_y_min, m_y.at(i));
+		m_y_max = qMax(m_y_max, m_y.at(i));
+		m_z_min = qMin(m_z_min, m_z.at(i));
+		m_z_max = qMax(m_z_max, m_z.at(i));
+	}
+}
+
+//! Scale the points of 'data' to the unit square
+static void scaledCoordinates(const ScatteredData& data, QVector<double>& u, QVector<double>& v)
+{
+	double width = data.xMax() - data.xMin(), height = data.yMax() - data.yMin();
+	if (width <= 0) width = 1;
+	if (height <= 0) height = 1;
+	u.resize(data.size());
+	v.resize(data.size());
+	for (int i=0; i<data.size(); i++)
+	{
+		u[i] = (data.x(i) - data.xMin()) / width;
+		v[i] = (data.y(i) - data.yMin()) / height;
+	}
+}
+
+QVector<int> ScatteredData::triangulate() const
+{
+	if (size() < 3)
+		return QVector<int>();
+
+	QVector<double> u, v;
+	scaledCoordinates(*this, u, v);
+
+	QVector< QPair<quint32, int> > order(size());
+	parallelFor(0, size()-1, HilbertKernel(u, v, order), 100000);
+	qSort(order);
+
+	DelaunayTriangulation triangulation(u, v);
+	for (int i=0; i<order.size(); i++)
+		triangulation.insert(order.at(i).second);
+	return triangulation.triangles();
+}
+
+QVector<double> ScatteredData::resample(Method method, int columns, int rows,
+		double xl, double xr, double yl, double yr) const
+{
+	QVector<double> result;
+	if (size() < 1 || columns < 2 || rows < 2)
+		return result;
+	result.resize(columns * rows);
+
+	QVector<double> u, v;
+	scaledCoordinates(*this, u, v);
+	PointBuckets buckets(u, v);
+
+	double width = m_x_max - m_x_min, height = m_y_max - m_y_min;
+	if (width <= 0) width = 1;
+	if (height <= 0) height = 1;
+	GridGeometry grid;
+	grid.columns = columns;
+	grid.rows = rows;
+	grid.u0 = (xl - m_x_min) / width;
+	grid.v0 = (yl - m_y_min) / height;
+	grid.du = (xr - xl) / (columns - 1) / width;
+	grid.dv = (yr - yl) / (rows - 1) / height;
+	if (grid.du <= 0 || grid.dv <= 0)
+		return QVector<double>();
+
+	int nodes = columns * rows;
+	QVector<int> nearest(nodes, -1);
+	QVector<double> dist2(nodes, 0.0);
+	switch (method)
+	{
+		case Binning:
+			{
+				QVector<int> count(nodes, 0);
+				result.fill(0.0);
+				for (int p=0; p<size(); p++)
+				{
+					int i = (int)floor((u.at(p) - grid.u0) / grid.du + 0.5);
+					int j = (int)floor((v.at(p) - grid.v0) / grid.dv + 0.5);
+					if (i < 0 || i >= columns || j < 0 || j >= rows)
+						continue;
+					result[i*rows + j] += m_z.at(p);
+					count[i*rows + j]++;
+				}
+				parallelFor(0, columns-1, NearestPointKernel(buckets, grid, nearest, dist2, &count),
+						min_columns_per_thread);
+				for (int node=0; node<nodes; node++)
+					result[node] = count.at(node) ? result.at(node) / count.at(node) : m_z.at(nearest.at(node));
+				break;
+			}
+		case InverseDistance:
+			parallelFor(0, columns-1, InverseDistanceKernel(buckets, m_z, grid, m_idw_neighbours,
+						m_idw_power, result), min_columns_per_thread);
+			break;
+		case NaturalNeighbour:
+			{
+				parallelFor(0, columns-1, NearestPointKernel(buckets, grid, nearest, dist2),
+						min_columns_per_thread);
+				double max_dist2 = 0;
+				foreach(double d, dist2)
+					max_dist2 = qMax(max_dist2, d);
+				int max_radius = qMin(columns, (int)(sqrt(max_dist2) / grid.du) + 1);
+				parallelFor(0, columns-1, NaturalNeighbourKernel(m_z, grid, nearest, dist2, max_radius,
+							result), min_columns_per_thread);
+				break;
+			}
+	}
+	return result;
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+    File                 : ScatteredData.h
+    Project              : SciDAVis
+    Description          : Triangulation and gridding of scattered (x,y,z) data
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SCATTERED_DATA_H
+#define SCATTERED_DATA_H
+
+#include <QVector>
+
+class AbstractColumn;
+
+//! Scattered (x,y,z) points and the surfaces which can be made from them
+/**
+ * Graph3D can't plot an XYZ table directly as a surface: Qwt3D needs either a regular
+ * grid of z values or a mesh of cells. ScatteredData collects the valid rows of three
+ * columns and provides both:
+ *
+ * - triangulate() computes the Delaunay triangulation of the points (in coordinates
+ *   scaled to the bounding box, so the units of x and y don't matter). Points are
+ *   inserted in the order of a Hilbert curve, so the triangulation takes O(n log n).
+ * - resample() computes z values on a regular grid of a given resolution by averaging
+ *   the points in each grid cell (Binning), by inverse distance weighting of the
+ *   nearest points (InverseDistance) or by natural neighbour interpolation
+ *   (NaturalNeighbour, computed with the discrete Sibson method of Park et al.,
+ *   "Discrete Sibson interpolation", IEEE TVCG 12, 2006). The grid nodes are
+ *   distributed on all cores.
+ *
+ * The memory needed for the result depends on the number of points (triangulation)
+ * or on the grid resolution (resampling), never on the square of the number of points.
+ */
+class ScatteredData
+{
+	public:
+		enum Method { Binning = 0, InverseDistance = 1, NaturalNeighbour = 2 };
+
+		ScatteredData();
+
+		//! Collect the rows of the three columns which are valid and finite in all of them
+		void setData(const AbstractColumn *x, const AbstractColumn *y, const AbstractColumn *z);
+		//! Drop the points outside [xl,xr] x [yl,yr] and clamp z to [zl,zr]
+		void clip(double xl, double xr, double yl, double yr, double zl, double zr);
+
+		int size() const { return m_x.size(); }
+		double x(int i) const { return m_x.at(i); }
+		double y(int i) const { return m_y.at(i); }
+		double z(int i) const { return m_z.at(i); }
+
+		//! \name Bounding box of the points
+		//@{
+		double xMin() const { return m_x_min; }
+		double xMax() const { return m_x_max; }
+		double yMin() const { return m_y_min; }
+		double yMax() const { return m_y_max; }
+		double zMin() const { return m_z_min; }
+		double zMax() const { return m_z_max; }
+		//@}
+
+		//! Return the Delaunay triangulation of the points
+		/**
+		 * The result holds three point indices for each triangle, in counter-clockwise order.
+		 * Points with equal x and y are only used once.
+		 */
+		QVector<int> triangulate() const;
+
+		//! Return z values on a regular grid covering [xl,xr] x [yl,yr]
+		/**
+		 * The value of the node at (xl + i*(xr-xl)/(columns-1), yl + j*(yr-yl)/(rows-1))
+		 * is stored at index i*rows + j. Binning fills cells without points with the value
+		 * of the closest point. Returns an empty vector if there are no points or the grid
+		 * has less than two columns or rows.
+		 */
+		QVector<double> resample(Method method, int columns, int rows,
+				double xl, double xr, double yl, double yr) const;
+
+		//! \name Parameters of the inverse distance weighting
+		//@{
+		//! Set the exponent of the distance in the weights (default: 2)
+		void setInverseDistancePower(double power) { m_idw_power = power; }
+		double inverseDistancePower() const { return m_idw_power; }
+		//! Set the number of closest points taken into account (default: 12)
+		void setInverseDistanceNeighbours(int count) { m_idw_neighbours = qMax(1, count); }
+		int inverseDistanceNeighbours() const { return m_idw_neighbours; }
+		//@}
+
+	private:
+		void updateLimits();
+
+		QVector<double> m_x, m_y, m_z;
+		double m_x_min, m_x_max, m_y_min, m_y_max, m_z_min, m_z_max;
+		double m_idw_power;
+		int m_idw_neighbours;
+};
+
+#endif // ifndef SCATTERED_DATA_H
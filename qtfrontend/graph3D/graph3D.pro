@@ -18,7 +18,8 @@ HEADERS += \
 	Graph3DModule.h \
 	Bar3D.h \
 	Cone3D.h \
-	../core/MyParser.h
+	ScatteredData.h \
+	FunctionMesh.h \
 
 #	FunctionDialog3D.h \
 #	PlotDialog3D.h \
@@ -28,7 +29,8 @@ SOURCES += \
 	Graph3DModule.cpp \
 	Bar3D.cpp \
 	Cone3D.cpp \
-	../core/MyParser.cpp
+	ScatteredData.cpp \
+	FunctionMesh.cpp \
 	
 #	FunctionDialog3D.cpp \
 #	PlotDialog3D.cpp \
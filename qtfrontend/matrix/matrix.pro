@@ -29,6 +29,7 @@ SOURCES += \
 
 HEADERS += \
 	Matrix.h \
+	MatrixKernels.h \
 	MatrixModule.h \
 	MatrixView.h \
 	MatrixModel.h \
@@ -0,0 +1,64 @@
+/***************************************************************************
+    File                 : OpjColumnData.cpp
+    Project              : SciDAVis
+    Description          : Numeric data of an imported Origin column
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "OpjColumnData.h"
+
+#include <math.h>
+
+OpjColumnData::OpjColumnData(const QVector<double>& cells, int rows)
+	: m_values(qMax(rows, 0), 0.0)
+{
+	int n = qMin(cells.size(), rows);
+	int empty_start = -1;
+	for (int i=0; i<n; i++)
+	{
+		double value = cells.at(i);
+		if (isEmptyCell(value))
+		{
+			if (empty_start < 0)
+				empty_start = i;
+			continue;
+		}
+		if (empty_start >= 0)
+		{
+			m_empty_rows << Interval<int>(empty_start, i-1);
+			empty_start = -1;
+		}
+		m_values[i] = value;
+	}
+	// the empty cells at the end and the rows without cells form one interval
+	if (empty_start < 0)
+		empty_start = n;
+	if (empty_start < rows)
+		m_empty_rows << Interval<int>(empty_start, rows-1);
+}
+
+bool OpjColumnData::isEmptyCell(double value)
+{
+	return fabs(value) > 0 && fabs(value) < 2.0e-300;
+}
@@ -0,0 +1,65 @@
+/***************************************************************************
+    File                 : OpjColumnData.h
+    Project              : SciDAVis
+    Description          : Numeric data of an imported Origin column
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef OPJ_COLUMN_DATA_H
+#define OPJ_COLUMN_DATA_H
+
+#include "lib/Interval.h"
+
+#include <QVector>
+#include <QList>
+
+//! Numeric data of an Origin spreadsheet column, ready to be put into a Column in one go
+/**
+ * Origin stores empty cells as tiny denormal numbers. These, and the rows below the last
+ * cell of the column, become invalid rows with value 0, collected into intervals for
+ * Column::replaceValues().
+ */
+class OpjColumnData
+{
+	public:
+		//! Convert 'cells', the raw values of a column, for a table of 'rows' rows
+		/**
+		 * Cells beyond 'rows' are dropped.
+		 */
+		OpjColumnData(const QVector<double>& cells, int rows);
+
+		//! The values of all rows (0 for invalid ones)
+		const QVector<double>& values() const { return m_values; }
+		//! The invalid rows, in ascending order and not adjacent to each other
+		const QList< Interval<int> >& emptyRows() const { return m_empty_rows; }
+
+		//! Whether 'value' marks an empty cell
+		static bool isEmptyCell(double value);
+
+	private:
+		QVector<double> m_values;
+		QList< Interval<int> > m_empty_rows;
+};
+
+#endif // ifndef OPJ_COLUMN_DATA_H
@@ -27,6 +27,7 @@
  *                                                                         *
  ***************************************************************************/
 #include "OpjImporter.h"
+#include "OpjColumnData.h"
 #include <OPJFile.h>
 
 #include "matrix/Matrix.h"
@@ -35,11 +36,12 @@
 #include "note/Note.h"
 #include "graph/types/HistogramCurve.h"
 #include "table/Table.h"
+#include "core/column/Column.h"
 
 #include <QRegExp>
 #include <QMessageBox>
 #include <QDockWidget>
-#include <QLocale>
+#include <QUndoStack>
 #include <QDate>
 
 #define OBJECTXOFFSET 200
@@ -58,6 +60,8 @@ OpjImporter::OpjImporter(ApplicationWindow *app, const QString& filename) :
 		mw(app)
 {
 	xoffset=0;
+	// whole projects are opened in a new window, whose undo history should start after the import
+	import_project = !filename.endsWith(".ogm", Qt::CaseInsensitive) && !filename.endsWith(".ogw", Qt::CaseInsensitive);
 	OPJFile opj((const char *)filename.latin1());
 	parse_error = opj.Parse();
 	importTables(opj);
@@ -92,7 +96,7 @@ int OpjImporter::translateOrigin2SciDAVisLineStyle(int linestyle) {
 	return scidavisstyle;
 }
 
-bool OpjImporter::importTables(OPJFile opj)
+bool OpjImporter::importTables(OPJFile &opj)
 {
 	int visible_count=0;
 	int SciDAVis_scaling_factor=10; //in Origin width is measured in characters while in SciDAVis - pixels --- need to be accurate
@@ -128,24 +132,24 @@ bool OpjImporter::importTables(OPJFile opj)
 			else
 				table->setColPlotDesignation(j, SciDAVis::noDesignation);
 
-            double **d_cells = new double* [nr_cols];
-            for ( int i = 0; i < nr_cols; ++i)
-                d_cells[i] = new double [table->rowCount()];
-
-			for (int i=0; i<opj.numRows(s,j); i++){
-				if(strcmp(opj.colType(s,j),"LABEL")&&opj.colValueType(s,j)!=1){// number
-					double* val = (double*)opj.oData(s,j,i,true);
-					if(fabs(*val)>0 && fabs(*val)<2.0e-300)// empty entry
-						continue;
-
-                    table->setText(i, j, QLocale().toString(*val, 'g', 14));
-                    d_cells[j][i] = *val;
-				}
-				else// label? doesn't seem to work
-					table->setText(i, j, QString((char*)opj.oData(s,j,i)));
+			// fill the column in one go, without formatting the values as text
+			Column *column = table->column(j);
+			int rows = table->rowCount();
+			int n = qMin(opj.numRows(s,j), rows);
+			if(strcmp(opj.colType(s,j),"LABEL")&&opj.colValueType(s,j)!=1){// number
+				QVector<double> cells(n);
+				for (int i=0; i<n; i++)
+					cells[i] = *(double*)opj.oData(s,j,i,true);
+				OpjColumnData data(cells, rows);
+				column->replaceValues(0, data.values(), data.emptyRows());
+			}
+			else{// label? doesn't seem to work
+				QStringList texts;
+				for (int i=0; i<n; i++)
+					texts << QString((char*)opj.oData(s,j,i));
+				column->setColumnMode(SciDAVis::Text);
+				column->replaceTexts(0, texts);
 			}
-			//TODO: do we really need this?
-            //table->saveToMemory(d_cells);
 
 			QString format;
 			switch(opj.colValueType(s,j))
@@ -297,28 +301,12 @@ bool OpjImporter::importTables(OPJFile opj)
 				table->setDayFormat(format, j);
 				break;
 			}
-			// TODO: do we really need this?
-            //table->freeMemory();
-
-			/*for (int i=0; i<opj.numRows(s,j); i++)
-			{
-				if(strcmp(opj.colType(s,j),"LABEL")&&opj.colValueType(s,j)!=1)
-				{// number
-					double* val = (double*)opj.oData(s,j,i,true);
-					if(fabs(*val)>0 && fabs(*val)<2.0e-300)// empty entry
-						continue;
-
-                    //if (table->columnType(j) == SciDAVis::Date)
-                        //QMessageBox::about(0, "", QDate::fromJulianDay(int(*val)+1).toString("dd/MM/yyyy"));
-
-					table->setText(i, j, QLocale().toString(*val));
-				}
-				else// label? doesn't seem to work
-					table->setText(i, j, QString((char*)opj.oData(s,j,i)));
-			}*/
 		}
 
 
+		if (import_project && table->undoStack())
+			table->undoStack()->clear();
+
 		if(!(opj.spreadHidden(s)||opj.spreadLoose(s))||opj.Version()!=7.5)
 		{
 			table->showNormal();
@@ -344,20 +332,21 @@ bool OpjImporter::importTables(OPJFile opj)
 		matrix->setWindowLabel(opj.matrixLabel(s));
 		matrix->setFormula(opj.matrixFormula(s));
 		matrix->setColumnsWidth(opj.matrixWidth(s)*SciDAVis_scaling_factor);
-		matrix->table()->blockSignals(true);
-		for (int j=0; j<nr_cols; j++)
+		for (int j=0; j<nr_cols && nr_rows>0; j++)
 		{
+			QVector<double> values = matrix->columnCells(j, 0, nr_rows-1);
 			for (int i=0; i<nr_rows; i++)
 			{
 				double val = opj.matrixData(s,j,i);
 				if(fabs(val)>0 && fabs(val)<2.0e-300)// empty entry
 					continue;
 
-				matrix->setCell(i, j, val);
+				values[i] = val;
 			}
+			matrix->setColumnCells(j, 0, nr_rows-1, values);
 		}
-
-		matrix->saveCellsToMemory();
+		if (import_project && matrix->undoStack())
+			matrix->undoStack()->clear();
 
 		QChar f;
 		switch(opj.matrixValueTypeSpec(s))
@@ -374,7 +363,6 @@ bool OpjImporter::importTables(OPJFile opj)
 			break;
 		}
 		matrix->setNumericFormat(f, opj.matrixSignificantDigits(s));
-        matrix->table()->blockSignals(false);
 		matrix->showNormal();
 
 		//cascade the matrices
@@ -390,7 +378,7 @@ bool OpjImporter::importTables(OPJFile opj)
 	return true;
 }
 
-bool OpjImporter::importNotes(OPJFile opj)
+bool OpjImporter::importNotes(OPJFile &opj)
 {
 	int visible_count=0;
 	for (int n=0; n<opj.numNotes(); n++)
@@ -418,7 +406,7 @@ bool OpjImporter::importNotes(OPJFile opj)
 	return true;
 }
 
-bool OpjImporter::importGraphs(OPJFile opj)
+bool OpjImporter::importGraphs(OPJFile &opj)
 {
 	double pi=3.141592653589793;
 	int visible_count=0;
@@ -39,9 +39,9 @@ class OpjImporter
 public:
 	OpjImporter(ApplicationWindow *app, const QString& filename);
 
-	bool importTables (OPJFile opj);
-	bool importGraphs (OPJFile opj);
-	bool importNotes (OPJFile opj);
+	bool importTables (OPJFile &opj);
+	bool importGraphs (OPJFile &opj);
+	bool importNotes (OPJFile &opj);
 	int error(){return parse_error;};
 
 private:
@@ -50,6 +50,8 @@ private:
 	QString parseOriginTags(const QString &str);
 	int parse_error;
 	int xoffset;
+	//! Whether a whole project is imported (as opposed to single windows)
+	bool import_project;
 	ApplicationWindow *mw;
 };
 
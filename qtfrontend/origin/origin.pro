@@ -1,7 +1,7 @@
 include(../config.pri)
 TEMPLATE = lib
 CONFIG += plugin static
-INCLUDEPATH += .. ../core ../table ../matrix ../graph
+INCLUDEPATH += .. ../core ../table ../matrix ../graph ../../backend
 TARGET = ../$$qtLibraryTarget(scidavis_origin)
 QT += xml
 
@@ -19,7 +19,9 @@ SOURCES += ../3rdparty/liborigin/OPJFile.cpp
 
 HEADERS += \
 	OpjImporter.h \
+	OpjColumnData.h \
 
 SOURCES += \
 	OpjImporter.cpp \
+	OpjColumnData.cpp \
 
@@ -35,9 +35,14 @@
 #include "lib/ActionManager.h"
 #include "lib/macros.h"
 #include "table/SortDialog.h"
+#include "table/Histogram.h"
+#include "table/FormulaEvaluator.h"
+#include "core/BatchFit.h"
+#include "analysis/fit_gsl.h"
 
 #include "core/column/Column.h"
 #include "core/AbstractFilter.h"
+#include "core/Folder.h"
 #include "core/datatypes/SimpleCopyThroughFilter.h"
 #include "core/datatypes/Double2StringFilter.h"
 #include "core/datatypes/String2DoubleFilter.h"
@@ -71,6 +76,9 @@
 #include <QDialog>
 #include <QInputDialog>
 #include <QMenuBar>
+#include <QDialogButtonBox>
+
+#include <math.h>
 
 TableView::TableView(Table *table)
  : m_plot_menu(0), m_table(table)
@@ -836,6 +844,8 @@ QMenu * TableView::createColumnMenu(QMenu * append_to)
 	menu->addSeparator();
 
 	menu->addAction(action_statistics_columns);
+	menu->addAction(action_histogram_columns);
+	menu->addAction(action_fit_columns);
 
 	return menu;
 }
@@ -1072,8 +1082,47 @@ void TableView::setFormulaForSelection()
 
 void TableView::recalculateSelectedCells()
 {
-	// TODO
-	QMessageBox::information(0, "info", "not yet implemented");
+	if (selectedColumnCount() < 1) return;
+	int first = firstSelectedRow();
+	int last = lastSelectedRow();
+	if ( first < 0 ) return;
+
+	WAIT_CURSOR;
+	QStringList errors;
+	FormulaEvaluator evaluator(m_table);
+	m_table->beginMacro(tr("%1: recalculate cells").arg(m_table->name()));
+	QList<Column*> list = selectedColumns();
+	foreach(Column * col_ptr, list)
+	{
+		int col = m_table->indexOfChild<Column>(col_ptr);
+		foreach(Interval<int> interval, col_ptr->formulaIntervals())
+		{
+			Interval<int> rows = Interval<int>::intersection(interval, Interval<int>(first, last));
+			if (!rows.isValid()) continue;
+			if (!evaluator.compile(col_ptr->formula(rows.start())))
+			{
+				errors << QString("%1: %2").arg(col_ptr->name()).arg(evaluator.errorMessage());
+				continue;
+			}
+			// evaluate each run of selected rows in one go
+			for (int row=rows.start(); row<=rows.end(); )
+			{
+				if (!isCellSelected(row, col))
+				{
+					row++;
+					continue;
+				}
+				int start = row;
+				while (row <= rows.end() && isCellSelected(row, col))
+					row++;
+				evaluator.apply(col_ptr, Interval<int>(start, row-1));
+			}
+		}
+	}
+	m_table->endMacro();
+	RESET_CURSOR;
+	if (!errors.isEmpty())
+		QMessageBox::critical(this, tr("Error"), errors.join("\n"));
 }
 
 void TableView::fillSelectedCellsWithRowNumbers()
@@ -1307,6 +1356,149 @@ void TableView::statisticsOnSelectedColumns()
 	QMessageBox::information(0, "info", "not yet implemented");
 }
 
+void TableView::histogramOfSelectedColumns()
+{
+	WAIT_CURSOR;
+	foreach(Column *col, selectedColumns())
+	{
+		if (col->dataType() != SciDAVis::TypeDouble)
+			continue;
+		Histogram histogram;
+		histogram.update(col);
+		Table *result = histogram.resultTable(tr("Histogram of %1").arg(col->name()));
+		if (m_table->folder())
+			m_table->folder()->addChild(result);
+		else
+			delete result;
+	}
+	RESET_CURSOR;
+}
+
+void TableView::fitSelectedColumns()
+{
+	QList<int> y_columns;
+	for (int i=0; i<m_table->columnCount(); i++)
+		if (isColumnSelected(i) && m_table->column(i)->plotDesignation() == SciDAVis::Y &&
+				m_table->column(i)->dataType() == SciDAVis::TypeDouble)
+			y_columns << i;
+	int x_column = y_columns.isEmpty() ? -1 : m_table->colX(y_columns.first());
+	if (x_column < 0)
+	{
+		QMessageBox::warning(this, tr("Fit Function"),
+				tr("Please select one or more Y columns of a table with an X column."));
+		return;
+	}
+
+	QDialog dialog;
+	QGridLayout layout(&dialog);
+	QLineEdit formula_edit("a*x+b"), names_edit("a, b"), initial_edit("1, 1");
+	QSpinBox starts_box;
+	starts_box.setRange(1, 1000);
+	starts_box.setValue(1);
+	layout.addWidget(new QLabel(tr("f(x) ="), &dialog), 0, 0);
+	layout.addWidget(&formula_edit, 0, 1);
+	layout.addWidget(new QLabel(tr("Parameters"), &dialog), 1, 0);
+	layout.addWidget(&names_edit, 1, 1);
+	layout.addWidget(new QLabel(tr("Initial guesses"), &dialog), 2, 0);
+	layout.addWidget(&initial_edit, 2, 1);
+	// see BatchFit::setStarts()
+	layout.addWidget(new QLabel(tr("Starts per column"), &dialog), 3, 0);
+	layout.addWidget(&starts_box, 3, 1);
+
+	QDialogButtonBox button_box(&dialog);
+	button_box.setOrientation(Qt::Horizontal);
+	button_box.setStandardButtons(QDialogButtonBox::Cancel|QDialogButtonBox::Ok);
+	QObject::connect(&button_box, SIGNAL(accepted()), &dialog, SLOT(accept()));
+	QObject::connect(&button_box, SIGNAL(rejected()), &dialog, SLOT(reject()));
+	layout.addWidget(&button_box, 4, 0, 1, 2);
+
+	dialog.setWindowTitle(tr("Fit Function"));
+	if (dialog.exec() != QDialog::Accepted)
+		return;
+
+	QStringList names;
+	foreach(QString name, names_edit.text().split(",", QString::SkipEmptyParts))
+		names << name.trimmed();
+	QStringList initial_texts = initial_edit.text().split(",", QString::SkipEmptyParts);
+	int p = names.size();
+	QVector<double> initial(p, 1.0);
+	for (int i=0; i<p && i<initial_texts.size(); i++)
+		initial[i] = initial_texts.at(i).trimmed().toDouble();
+	if (p == 0)
+	{
+		QMessageBox::warning(this, tr("Fit Function"), tr("Please enter the names of the fit parameters."));
+		return;
+	}
+
+	WAIT_CURSOR;
+	FitSolver solver(user_f, user_df, user_fdf, user_d, p);
+	solver.setUserFunction(formula_edit.text(), names);
+	BatchFit batch(solver, initial);
+	batch.setStarts(starts_box.value());
+	Column *x_col = m_table->column(x_column);
+	foreach(int y_column, y_columns)
+	{
+		Column *y_col = m_table->column(y_column);
+		QVector<double> x, y;
+		int rows = qMin(x_col->rowCount(), y_col->rowCount());
+		for (int i=0; i<rows; i++)
+		{
+			if (x_col->isInvalid(i) || y_col->isInvalid(i) || x_col->isMasked(i) || y_col->isMasked(i))
+				continue;
+			x << x_col->valueAt(i);
+			y << y_col->valueAt(i);
+		}
+		batch.addDataset(y_col->name(), x, y);
+	}
+	batch.run();
+
+	// one row per column: the parameters with their standard errors, chi^2 per degree of freedom
+	int count = batch.datasetCount();
+	QStringList datasets, errors;
+	QVector< QVector<double> > values(2*p + 1, QVector<double>(count));
+	IntervalAttribute<bool> failed;
+	for (int d=0; d<count; d++)
+	{
+		const FitSolver::Result& r = batch.result(d);
+		datasets << batch.datasetName(d);
+		errors << r.error;
+		int dof = batch.datasetSize(d) - p;
+		if (r.parameters.size() != p || dof <= 0)
+		{
+			failed.setValue(d, true);
+			continue;
+		}
+		double chi_2_dof = r.chi_square/dof;
+		for (int i=0; i<p; i++)
+		{
+			values[2*i][d] = r.parameters.at(i);
+			values[2*i+1][d] = sqrt(r.covariance.at(i*p+i) * chi_2_dof);
+		}
+		values[2*p][d] = chi_2_dof;
+	}
+
+	Table *result = new Table(0, 0, 0, tr("Fit of %1").arg(m_table->name()));
+	Column *column = new Column(tr("Column"), datasets);
+	column->setPlotDesignation(SciDAVis::X);
+	result->addChild(column);
+	for (int i=0; i<p; i++)
+	{
+		column = new Column(names.at(i), values.at(2*i), failed);
+		column->setPlotDesignation(SciDAVis::Y);
+		result->addChild(column);
+		column = new Column(names.at(i) + " " + tr("Error"), values.at(2*i+1), failed);
+		column->setPlotDesignation(SciDAVis::yErr);
+		result->addChild(column);
+	}
+	result->addChild(new Column(tr("Chi^2/doF"), values.at(2*p), failed));
+	result->addChild(new Column(tr("Error"), errors));
+	if (m_table->folder())
+		m_table->folder()->addChild(result);
+	else
+		delete result;
+	RESET_CURSOR;
+}
+
 void TableView::statisticsOnSelectedRows()
 {
 	// TODO
@@ -1685,6 +1877,12 @@ void TableView::createActions()
 	action_statistics_columns = new QAction(QIcon(QPixmap(":/col_stat.xpm")), tr("Column Statisti&cs"), this);
 	actionManager()->addAction(action_statistics_columns, "statistics_columns"); 
 
+	action_histogram_columns = new QAction(tr("&Histogram"), this);
+	actionManager()->addAction(action_histogram_columns, "histogram_columns"); 
+
+	action_fit_columns = new QAction(tr("&Fit Function..."), this);
+	actionManager()->addAction(action_fit_columns, "fit_columns"); 
+
 	icon_temp = new QIcon();
 	icon_temp->addPixmap(QPixmap(":/16x16/column_format_type.png"));
 	icon_temp->addPixmap(QPixmap(":/32x32/column_format_type.png"));
@@ -1765,6 +1963,8 @@ void TableView::connectActions()
 	connect(action_normalize_selection, SIGNAL(triggered()), this, SLOT(normalizeSelection()));
 	connect(action_sort_columns, SIGNAL(triggered()), this, SLOT(sortSelectedColumns()));
 	connect(action_statistics_columns, SIGNAL(triggered()), this, SLOT(statisticsOnSelectedColumns()));
+	connect(action_histogram_columns, SIGNAL(triggered()), this, SLOT(histogramOfSelectedColumns()));
+	connect(action_fit_columns, SIGNAL(triggered()), this, SLOT(fitSelectedColumns()));
 	connect(action_type_format, SIGNAL(triggered()), this, SLOT(editTypeAndFormatOfSelectedColumns()));
 	connect(action_edit_description, SIGNAL(triggered()), this, SLOT(editDescriptionOfCurrentColumn()));
 	connect(action_insert_rows, SIGNAL(triggered()), this, SLOT(insertEmptyRows()));
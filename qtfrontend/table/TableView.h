@@ -227,6 +227,13 @@ class TableView : public QWidget
 		void normalizeSelection();
 		void sortSelectedColumns();
 		void statisticsOnSelectedColumns();
+		//! Create a table with the histogram of each selected column
+		void histogramOfSelectedColumns();
+		//! Fit a user-defined function to each selected Y column (see BatchFit)
+		/**
+		 * Creates a table with the fitted parameters and their errors, one row per column.
+		 */
+		void fitSelectedColumns();
 		void statisticsOnSelectedRows();
 		//! Insert rows depending on the selection
 		void insertEmptyRows();
@@ -392,6 +399,8 @@ class TableView : public QWidget
 		QAction * action_normalize_selection;
 		QAction * action_sort_columns;
 		QAction * action_statistics_columns;
+		QAction * action_histogram_columns;
+		QAction * action_fit_columns;
 		QAction * action_type_format;
 		QAction * action_edit_description;
 		//@}
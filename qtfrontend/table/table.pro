@@ -1,6 +1,6 @@
 include(../config.pri)
 TEMPLATE = lib
-CONFIG += plugin static
+CONFIG += plugin static exceptions
 DEPENDPATH += . .. ../../backend ../../backend/table ../core ../../backend/core
 INCLUDEPATH += .. ../../backend
 TARGET = ../$$qtLibraryTarget(scidavis_table)
@@ -21,6 +21,10 @@ HEADERS += \
 	TableItemDelegate.h \
 	TableModel.h \
 	Table.h \
+	RowSorter.h \
+	Histogram.h \
+	ColumnStatistics.h \
+	FormulaEvaluator.h \
 	SortDialog.h \
 	TableDoubleHeaderView.h \
 	TableCommentsHeaderModel.h  \
@@ -38,6 +42,10 @@ SOURCES += \
 	TableView.cpp \
 	TableItemDelegate.cpp \
 	Table.cpp \
+	RowSorter.cpp \
+	Histogram.cpp \
+	ColumnStatistics.cpp \
+	FormulaEvaluator.cpp \
 	TableModel.cpp \
 	SortDialog.cpp \
 	TableDoubleHeaderView.cpp \
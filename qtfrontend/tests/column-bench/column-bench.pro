@@ -0,0 +1,13 @@
+TEMPLATE = app
+TARGET = column-bench
+CONFIG += release console
+QT -= gui
+DEPENDPATH += . .. ../../../backend ../../../backend/lib
+INCLUDEPATH += . .. ../../../backend ../../../backend/lib
+
+HEADERS += \
+			  Interval.h \
+			  IntervalAttribute.h \
+			  RowBitmap.h \
+
+SOURCES += main.cpp \
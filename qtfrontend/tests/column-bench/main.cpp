@@ -0,0 +1,112 @@
+/***************************************************************************
+    File                 : main.cpp
+    Project              : SciDAVis
+    Description          : Micro-benchmark for the representations of IntervalAttribute<bool>
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "IntervalAttribute.h"
+#include <QTime>
+#include <QStringList>
+#include <QCoreApplication>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Usage: column-bench [rows] [scattered rows]
+ *
+ * Simulates a column with scattered invalid cells (e.g. sensor data with NaNs)
+ * and times the typical operations on it once with the interval list and once
+ * with the bitmap representation of IntervalAttribute<bool>.
+ */
+
+struct Timings
+{
+	int set, lookup, range_lookup, insert_remove, intervals;
+	int interval_count;
+};
+
+static Timings run(IntervalAttribute<bool>::Representation representation, int rows, int scattered)
+{
+	Timings result;
+	IntervalAttribute<bool> attribute;
+	attribute.setRepresentation(representation);
+	QTime timer;
+	srand(42);
+
+	// mark scattered rows invalid one at a time (like an import does)
+	timer.start();
+	for(int i=0; i<scattered; i++)
+		attribute.setValue(rand() % rows, true);
+	result.set = timer.elapsed();
+
+	// isInvalid(row) for every row (like a plotting or fitting loop does)
+	timer.start();
+	int count = 0;
+	for(int i=0; i<rows; i++)
+		if (attribute.isSet(i))
+			count++;
+	result.lookup = timer.elapsed();
+
+	timer.start();
+	for(int i=0; i<rows; i+=16)
+		if (attribute.isSet(Interval<int>(i, i+15)))
+			count++;
+	result.range_lookup = timer.elapsed();
+
+	timer.start();
+	for(int i=0; i<100; i++)
+	{
+		attribute.insertRows(rows / 2, 10);
+		attribute.removeRows(rows / 3, 10);
+	}
+	result.insert_remove = timer.elapsed();
+
+	timer.start();
+	result.interval_count = attribute.intervals().size();
+	result.intervals = timer.elapsed();
+
+	return result;
+}
+
+static void print(const char * name, const Timings& t)
+{
+	printf("%-14s %8d %8d %8d %8d %8d %10d\n", name, t.set, t.lookup, t.range_lookup,
+			t.insert_remove, t.intervals, t.interval_count);
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QStringList args = app.arguments();
+	int rows = args.size() > 1 ? args.at(1).toInt() : 10000000;
+	int scattered = args.size() > 2 ? args.at(2).toInt() : 50000;
+
+	printf("%d rows, %d scattered invalid rows; times in ms\n", rows, scattered);
+	printf("%-14s %8s %8s %8s %8s %8s %10s\n", "", "set", "isSet", "isSet(iv)", "ins/rem", "list", "intervals");
+	print("interval list", run(IntervalAttribute<bool>::IntervalList, rows, scattered));
+	print("bitmap", run(IntervalAttribute<bool>::Bitmap, rows, scattered));
+	print("adaptive", run(IntervalAttribute<bool>::Adaptive, rows, scattered));
+	return 0;
+}
@@ -10,14 +10,19 @@
 #include "Double2StringFilter.h"
 #include "DateTime2StringFilter.h"
 #include "String2DateTimeFilter.h"
+#include "ProjectArchive.h"
+#include "table/RowSorter.h"
 #include <QtGlobal>
 #include <QLocale>
 #include <QtDebug>
 #include <QUndoStack>
 #include <QStringList>
+#include <QTemporaryFile>
 #include <QApplication>
 #include <QMainWindow>
 
+#include <math.h>
+
 #define EPSILON (1e-6)
 
 class globals
@@ -124,7 +129,10 @@ class ColumnTest : public CppUnit::TestFixture {
 		CPPUNIT_TEST_SUITE(ColumnTest);
 		CPPUNIT_TEST(testGeneralMethods);
 		CPPUNIT_TEST(testIntervalAttributes);
+		CPPUNIT_TEST(testScatteredValidity);
+		CPPUNIT_TEST(testFormulaAttribute);
 		CPPUNIT_TEST(testDoubleColumn);
+		CPPUNIT_TEST(testValueSpan);
 		CPPUNIT_TEST(testStringColumn);
 		CPPUNIT_TEST(testDateTimeColumn);
 		CPPUNIT_TEST(testConversion);
@@ -133,6 +141,13 @@ class ColumnTest : public CppUnit::TestFixture {
 #endif
 		CPPUNIT_TEST(testUndo);
 		CPPUNIT_TEST(testSave);
+		CPPUNIT_TEST(testSaveBinary);
+		CPPUNIT_TEST(testPagedColumn);
+		CPPUNIT_TEST(testPermuteRows);
+		CPPUNIT_TEST(testSortMultiKey);
+		CPPUNIT_TEST(testSortDescending);
+		CPPUNIT_TEST(testSortInvalid);
+		CPPUNIT_TEST(testSortStable);
 		CPPUNIT_TEST_SUITE_END();
 	public:
 		void setUp() 
@@ -255,6 +270,69 @@ class ColumnTest : public CppUnit::TestFixture {
 			CPPUNIT_ASSERT(!column[10]->isInvalid(Interval<int>(1,1)));
 			CPPUNIT_ASSERT(!column[10]->isInvalid(Interval<int>(2,2)));
 		}
+/* ------------------------------------------------------------------------------ */
+		void testScatteredValidity() 
+		{
+			// every third row invalid: enough intervals to make the validity switch to a bitmap
+			for(int i=0; i<300; i+=3)
+				column[0]->setInvalid(i);
+			for(int i=0; i<300; i++)
+				CPPUNIT_ASSERT_EQUAL(i % 3 == 0, column[0]->isInvalid(i));
+			CPPUNIT_ASSERT_EQUAL(100, column[0]->invalidIntervals().size());
+			CPPUNIT_ASSERT_EQUAL(Interval<int>(297,297), column[0]->invalidIntervals().last());
+
+			column[0]->removeRows(1, 2);
+			CPPUNIT_ASSERT(column[0]->isInvalid(Interval<int>(0,1)));
+			CPPUNIT_ASSERT(!column[0]->isInvalid(2));
+			CPPUNIT_ASSERT_EQUAL(Interval<int>(0,1), column[0]->invalidIntervals().first());
+			column[0]->insertRows(1, 3);
+			CPPUNIT_ASSERT(column[0]->isInvalid(0));
+			CPPUNIT_ASSERT(!column[0]->isInvalid(Interval<int>(0,1)));
+			CPPUNIT_ASSERT(column[0]->isInvalid(4));
+			CPPUNIT_ASSERT(!column[0]->isInvalid(5));
+
+			column[0]->setInvalid(Interval<int>(0,400), false);
+			CPPUNIT_ASSERT(column[0]->invalidIntervals().isEmpty());
+
+			IntervalAttribute<bool> list, bitmap;
+			bitmap.setRepresentation(IntervalAttribute<bool>::Bitmap);
+			for(int i=0; i<100; i+=7)
+			{
+				list.setValue(Interval<int>(i, i+2), true);
+				bitmap.setValue(Interval<int>(i, i+2), true);
+			}
+			list.removeRows(5, 10);
+			bitmap.removeRows(5, 10);
+			CPPUNIT_ASSERT_EQUAL(list.intervals(), bitmap.intervals());
+		}
+/* ------------------------------------------------------------------------------ */
+		void testFormulaAttribute() 
+		{
+			// one formula per row
+			for(int i=0; i<100; i++)
+				column[0]->setFormula(i, QString("f%1").arg(i % 2));
+			CPPUNIT_ASSERT_EQUAL(100, column[0]->formulaIntervals().size());
+			CPPUNIT_ASSERT_EQUAL(QString("f1"), column[0]->formula(51));
+			CPPUNIT_ASSERT_EQUAL(QString(), column[0]->formula(100));
+
+			// equal formulas are merged, also across removed rows
+			column[0]->setFormula(Interval<int>(10,19), "g");
+			CPPUNIT_ASSERT_EQUAL(91, column[0]->formulaIntervals().size());
+			column[0]->removeRows(21, 1);
+			CPPUNIT_ASSERT_EQUAL(89, column[0]->formulaIntervals().size());
+			CPPUNIT_ASSERT_EQUAL(Interval<int>(20,21), column[0]->formulaIntervals().at(11));
+			CPPUNIT_ASSERT_EQUAL(QString("f0"), column[0]->formula(21));
+			// merging must not stop after the first merge
+			CPPUNIT_ASSERT_EQUAL(QString("f1"), column[0]->formula(98));
+
+			// inserted rows have no formula
+			column[0]->insertRows(15, 2);
+			CPPUNIT_ASSERT_EQUAL(QString("g"), column[0]->formula(14));
+			CPPUNIT_ASSERT_EQUAL(QString(), column[0]->formula(15));
+			CPPUNIT_ASSERT_EQUAL(QString(), column[0]->formula(16));
+			CPPUNIT_ASSERT_EQUAL(QString("g"), column[0]->formula(17));
+			CPPUNIT_ASSERT_EQUAL(QString("f0"), column[0]->formula(23));
+		}
 /* ------------------------------------------------------------------------------ */
 		void testDoubleColumn() 
 		{
@@ -320,6 +398,49 @@ class ColumnTest : public CppUnit::TestFixture {
 
 
 
+		}
+/* ------------------------------------------------------------------------------ */
+		void testValueSpan() 
+		{
+			// span over column storage
+			CPPUNIT_ASSERT(column[1]->rawValues() != 0);
+			ValueSpan span = column[1]->valueSpan();
+			CPPUNIT_ASSERT(!span.isMaterialized());
+			CPPUNIT_ASSERT_EQUAL(0, span.first());
+			CPPUNIT_ASSERT_EQUAL(3, span.size());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(1.1, span.at(0), EPSILON);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(3.3, span.data()[2], EPSILON);
+			CPPUNIT_ASSERT(span.hasInvalid());
+			CPPUNIT_ASSERT(!span.isInvalid(0));
+			CPPUNIT_ASSERT(span.isInvalid(1));
+			CPPUNIT_ASSERT(span.isInvalid(2));
+
+			// partial span, clipped to the rows containing data
+			span = column[1]->valueSpan(Interval<int>(2,10));
+			CPPUNIT_ASSERT_EQUAL(2, span.first());
+			CPPUNIT_ASSERT_EQUAL(1, span.size());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(3.3, span.at(0), EPSILON);
+			CPPUNIT_ASSERT(span.isInvalid(0));
+			CPPUNIT_ASSERT(column[10]->valueSpan(Interval<int>(5,10)).isEmpty());
+			CPPUNIT_ASSERT(!column[10]->valueSpan().hasInvalid());
+
+			// non-numeric columns don't expose their storage
+			CPPUNIT_ASSERT(column[3]->rawValues() == 0);
+
+			// filter outputs are materialized
+			const AbstractColumn * converted = column[1]->outputFilter()->output(0);
+			CPPUNIT_ASSERT(converted->rawValues() == 0);
+			double buffer[3];
+			column[10]->valuesAt(0, 3, buffer);
+			for(int i=0; i<3; i++)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(column[10]->valueAt(i), buffer[i], EPSILON);
+
+			// bulk copy keeps values and validity
+			column[0]->copy(column[1]);
+			span = column[0]->valueSpan();
+			CPPUNIT_ASSERT_EQUAL(3, span.size());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(2.2, span.at(1), EPSILON);
+			CPPUNIT_ASSERT(span.isInvalid(1));
 		}
 /* ------------------------------------------------------------------------------ */
 		void testStringColumn() 
@@ -997,6 +1118,292 @@ class ColumnTest : public CppUnit::TestFixture {
 			}
 			delete temp_col;	
 		}
+/* ------------------------------------------------------------------------------ */
+		void testSaveBinary() 
+		{
+			ColumnWrapper *temp_col = new ColumnWrapper("temp_col", SciDAVis::Numeric);
+
+			for(int i=0; i<11; i++)
+			{
+				QTemporaryFile file;
+				CPPUNIT_ASSERT(file.open());
+				ProjectArchive output;
+				QXmlStreamWriter writer(&output);
+				// alternate between raw and compressed blocks
+				CPPUNIT_ASSERT(output.beginWrite(&file, i % 2 ? -1 : 0));
+				column[i]->save(&writer);
+				CPPUNIT_ASSERT(output.endWrite());
+				file.close();
+
+				ProjectArchive input;
+				CPPUNIT_ASSERT(input.openArchive(file.fileName()));
+				XmlStreamReader reader(&input);
+				reader.readNext();
+				CPPUNIT_ASSERT(reader.isStartDocument());
+				reader.readNext();
+				CPPUNIT_ASSERT(temp_col->load(&reader));
+				CPPUNIT_ASSERT(column[i]->equalsDebug(temp_col));
+			}
+			delete temp_col;	
+		}
+/* ------------------------------------------------------------------------------ */
+		void testPagedColumn() 
+		{
+			QVector<double> values;
+			for(int i=0; i<20000; i++)
+				values << i * 0.5;
+			ColumnWrapper *big_col = new ColumnWrapper("big_col", values);
+			prj->addChild(big_col);
+			ColumnWrapper *temp_col = new ColumnWrapper("temp_col", SciDAVis::Numeric);
+
+			QTemporaryFile file;
+			CPPUNIT_ASSERT(file.open());
+			ProjectArchive output;
+			QXmlStreamWriter writer(&output);
+			CPPUNIT_ASSERT(output.beginWrite(&file));
+			big_col->save(&writer);
+			CPPUNIT_ASSERT(output.endWrite());
+			file.close();
+
+			QVariant use_mapping = Column::global("map_project_files");
+			for(int mapped=0; mapped<2; mapped++)
+			{
+				Column::setGlobal("map_project_files", bool(mapped));
+				ProjectArchive input;
+				CPPUNIT_ASSERT(input.openArchive(file.fileName()));
+				XmlStreamReader reader(&input);
+				reader.readNext();
+				reader.readNext();
+				CPPUNIT_ASSERT(temp_col->load(&reader));
+				CPPUNIT_ASSERT_EQUAL(20000, temp_col->rowCount());
+				CPPUNIT_ASSERT_EQUAL(9999.5, temp_col->valueAt(19999));
+				CPPUNIT_ASSERT_EQUAL(4096.0, temp_col->valueAt(8192));
+				CPPUNIT_ASSERT_EQUAL(1.5, temp_col->valueAt(3));
+				CPPUNIT_ASSERT_EQUAL(0.0, temp_col->valueAt(20000));
+				// without mapping, bulk access goes through the page cache chunk by chunk
+				if (!mapped)
+					CPPUNIT_ASSERT(temp_col->rawValues() == 0);
+				ValueSpan span = temp_col->valueSpan(Interval<int>(12000, 12999));
+				CPPUNIT_ASSERT_EQUAL(1000, span.size());
+				CPPUNIT_ASSERT_EQUAL(6000.0, span.at(0));
+				CPPUNIT_ASSERT_EQUAL(6499.5, span.at(999));
+				QVector<double> buffer(3);
+				temp_col->valuesAt(19998, 3, buffer.data());
+				CPPUNIT_ASSERT_EQUAL(9999.0, buffer.at(0));
+				CPPUNIT_ASSERT_EQUAL(9999.5, buffer.at(1));
+				CPPUNIT_ASSERT_EQUAL(0.0, buffer.at(2));
+				// editing reads the data into memory
+				temp_col->setValueAt(10000, -1.0);
+				CPPUNIT_ASSERT_EQUAL(-1.0, temp_col->valueAt(10000));
+				CPPUNIT_ASSERT_EQUAL(5000.5, temp_col->valueAt(10001));
+				CPPUNIT_ASSERT_EQUAL(20000, temp_col->rowCount());
+				CPPUNIT_ASSERT(temp_col->rawValues() != 0);
+			}
+			Column::setGlobal("map_project_files", use_mapping);
+			delete temp_col;
+		}
+/* ------------------------------------------------------------------------------ */
+		void testPermuteRows() 
+		{
+			QVector<int> permutation;
+			permutation << 2 << 0 << 1;
+			column[1]->setMasked(0);
+			column[3]->setFormula(Interval<int>(0,0), "foo");
+			column[1]->permuteRows(permutation);
+			column[3]->permuteRows(permutation);
+
+			CPPUNIT_ASSERT_EQUAL(column[1]->valueAt(0), 3.3);
+			CPPUNIT_ASSERT_EQUAL(column[1]->valueAt(1), 1.1);
+			CPPUNIT_ASSERT_EQUAL(column[1]->valueAt(2), 2.2);
+			CPPUNIT_ASSERT(column[1]->isInvalid(0));
+			CPPUNIT_ASSERT(!column[1]->isInvalid(1));
+			CPPUNIT_ASSERT(column[1]->isInvalid(2));
+			CPPUNIT_ASSERT(!column[1]->isMasked(0));
+			CPPUNIT_ASSERT(column[1]->isMasked(1));
+			CPPUNIT_ASSERT_EQUAL(column[3]->textAt(0), QString("qt4"));
+			CPPUNIT_ASSERT_EQUAL(column[3]->textAt(1), QString("foo"));
+			CPPUNIT_ASSERT_EQUAL(column[3]->formula(1), QString("foo"));
+			CPPUNIT_ASSERT(column[3]->formula(0).isEmpty());
+
+			QUndoStack * us = column[1]->undoStack();
+			us->undo();
+			us->undo();
+			CPPUNIT_ASSERT_EQUAL(column[1]->valueAt(0), 1.1);
+			CPPUNIT_ASSERT_EQUAL(column[1]->valueAt(2), 3.3);
+			CPPUNIT_ASSERT(!column[1]->isInvalid(0));
+			CPPUNIT_ASSERT(column[1]->isInvalid(2));
+			CPPUNIT_ASSERT(column[1]->isMasked(0));
+			CPPUNIT_ASSERT(!column[1]->isMasked(1));
+			CPPUNIT_ASSERT_EQUAL(column[3]->textAt(0), QString("foo"));
+			CPPUNIT_ASSERT_EQUAL(column[3]->formula(0), QString("foo"));
+		}
+
+		void testSortMultiKey()
+		{
+			QStringList groups;
+			groups << "b" << "a" << "b" << "a" << "c" << "a";
+			QVector<double> values;
+			values << 2.0 << 3.0 << 1.0 << 1.0 << 0.0 << 2.0;
+			Column group_col("group", groups);
+			Column value_col("value", values);
+
+			RowSorter sorter(6);
+			sorter.addKey(&group_col);
+			sorter.addKey(&value_col);
+			CPPUNIT_ASSERT_EQUAL(2, sorter.keyCount());
+			QVector<int> expected;
+			expected << 3 << 5 << 1 << 2 << 0 << 4;
+			CPPUNIT_ASSERT(sorter.permutation() == expected);
+
+			// the first key decides, the second one only breaks ties
+			RowSorter by_value(6);
+			by_value.addKey(&value_col);
+			by_value.addKey(&group_col);
+			expected.clear();
+			expected << 4 << 3 << 2 << 5 << 0 << 1;
+			CPPUNIT_ASSERT(by_value.permutation() == expected);
+
+			// applying the permutation sorts the columns
+			group_col.permuteRows(sorter.permutation());
+			value_col.permuteRows(sorter.permutation());
+			CPPUNIT_ASSERT_EQUAL(QString("a"), group_col.textAt(0));
+			CPPUNIT_ASSERT_EQUAL(QString("c"), group_col.textAt(5));
+			for (int i=1; i<6; i++)
+				CPPUNIT_ASSERT(group_col.textAt(i-1) < group_col.textAt(i)
+						|| (group_col.textAt(i-1) == group_col.textAt(i) && value_col.valueAt(i-1) <= value_col.valueAt(i)));
+		}
+
+		void testSortDescending()
+		{
+			QVector<double> values;
+			values << 1.5 << -2.0 << 7.0 << 0.0 << 7.0;
+			Column value_col("value", values);
+			QList<QDateTime> dates;
+			dates << QDateTime(QDate(2001,1,1), QTime(0,0)) << QDateTime(QDate(1999,5,5), QTime(12,0))
+				<< QDateTime(QDate(2001,1,1), QTime(0,0,0,1)) << QDateTime(QDate(1999,5,5), QTime(11,59));
+			Column date_col("date", dates);
+			QStringList texts;
+			texts << "pear" << "apple" << "quince" << "fig";
+			Column text_col("text", texts);
+
+			RowSorter values_sorter(5);
+			values_sorter.addKey(&value_col, false);
+			QVector<int> expected;
+			expected << 2 << 4 << 0 << 3 << 1;
+			CPPUNIT_ASSERT(values_sorter.permutation() == expected);
+
+			RowSorter dates_sorter(4);
+			dates_sorter.addKey(&date_col, false);
+			expected.clear();
+			expected << 2 << 0 << 1 << 3;
+			CPPUNIT_ASSERT(dates_sorter.permutation() == expected);
+
+			RowSorter texts_sorter(4);
+			texts_sorter.addKey(&text_col, false);
+			expected.clear();
+			expected << 2 << 0 << 3 << 1;
+			CPPUNIT_ASSERT(texts_sorter.permutation() == expected);
+
+			// descending first key, ascending second key
+			RowSorter mixed(5);
+			mixed.addKey(&value_col, false);
+			QVector<double> second;
+			second << 0.0 << 0.0 << 9.0 << 0.0 << 8.0;
+			Column second_col("second", second);
+			mixed.addKey(&second_col);
+			expected.clear();
+			expected << 4 << 2 << 0 << 3 << 1;
+			CPPUNIT_ASSERT(mixed.permutation() == expected);
+		}
+
+		void testSortInvalid()
+		{
+			QVector<double> values;
+			values << 3.0 << NAN << 1.0 << 2.0 << 0.5;
+			IntervalAttribute<bool> validity;
+			validity.setValue(Interval<int>(4,4));
+			Column value_col("value", values, validity);
+
+			// NaN, invalid cells and rows beyond the end of the column are invalid
+			RowSorter sorter(7);
+			sorter.addKey(&value_col);
+			QVector<int> expected;
+			expected << 2 << 3 << 0 << 1 << 4 << 5 << 6;
+			CPPUNIT_ASSERT(sorter.permutation() == expected);
+
+			// invalid cells stay at the end when sorting descending
+			RowSorter descending(7);
+			descending.addKey(&value_col, false);
+			expected.clear();
+			expected << 0 << 3 << 2 << 1 << 4 << 5 << 6;
+			CPPUNIT_ASSERT(descending.permutation() == expected);
+
+			sorter.setInvalidPlacement(RowSorter::InvalidFirst);
+			CPPUNIT_ASSERT_EQUAL(RowSorter::InvalidFirst, sorter.invalidPlacement());
+			expected.clear();
+			expected << 1 << 4 << 5 << 6 << 2 << 3 << 0;
+			CPPUNIT_ASSERT(sorter.permutation() == expected);
+
+			// rows invalid in the first key are ordered by the second key
+			QVector<double> second;
+			second << 0.0 << 5.0 << 0.0 << 0.0 << 4.0 << 6.0 << 3.0;
+			Column second_col("second", second);
+			RowSorter two_keys(7);
+			two_keys.addKey(&value_col);
+			two_keys.addKey(&second_col);
+			expected.clear();
+			expected << 2 << 3 << 0 << 6 << 4 << 1 << 5;
+			CPPUNIT_ASSERT(two_keys.permutation() == expected);
+
+			// invalid date-times
+			QList<QDateTime> dates;
+			dates << QDateTime(QDate(2001,1,1), QTime(0,0)) << QDateTime() << QDateTime(QDate(2000,1,1), QTime(0,0));
+			Column date_col("date", dates);
+			RowSorter dates_sorter(3);
+			dates_sorter.addKey(&date_col);
+			expected.clear();
+			expected << 2 << 0 << 1;
+			CPPUNIT_ASSERT(dates_sorter.permutation() == expected);
+		}
+
+		void testSortStable()
+		{
+			QVector<double> values;
+			values << 1.0 << 0.0 << 1.0 << 0.0 << 1.0 << 0.0;
+			Column value_col("value", values);
+			RowSorter sorter(6);
+			sorter.addKey(&value_col);
+			QVector<int> expected;
+			expected << 1 << 3 << 5 << 0 << 2 << 4;
+			CPPUNIT_ASSERT(sorter.permutation() == expected);
+			RowSorter descending(6);
+			descending.addKey(&value_col, false);
+			expected.clear();
+			expected << 0 << 2 << 4 << 1 << 3 << 5;
+			CPPUNIT_ASSERT(descending.permutation() == expected);
+
+			// enough rows to be sorted in several chunks which are merged afterwards
+			const int rows = 100000;
+			QVector<double> many(rows);
+			for (int i=0; i<rows; i++)
+				many[i] = (i*7919) % 13;
+			many[17] = NAN;
+			Column many_col("many", many);
+			RowSorter big(rows);
+			big.addKey(&many_col);
+			QVector<int> result = big.permutation();
+			CPPUNIT_ASSERT_EQUAL(rows, result.size());
+			CPPUNIT_ASSERT_EQUAL(17, result.at(rows-1));
+			QVector<bool> seen(rows, false);
+			for (int i=0; i<rows; i++) {
+				CPPUNIT_ASSERT(!seen.at(result.at(i)));
+				seen[result.at(i)] = true;
+			}
+			for (int i=1; i<rows-1; i++) {
+				double previous = many.at(result.at(i-1)), current = many.at(result.at(i));
+				CPPUNIT_ASSERT(previous < current || (previous == current && result.at(i-1) < result.at(i)));
+			}
+		}
 /* ------------------------------------------------------------------------------ */
 		void testMappingFilter()
 		{
@@ -0,0 +1,334 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "UndoPayload.h"
+#include "Project.h"
+#include "Column.h"
+
+#include <QVector>
+#include <QStringList>
+#include <QDateTime>
+#include <QUndoStack>
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+class UndoPayloadTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(UndoPayloadTest);
+		CPPUNIT_TEST(testPackValues);
+		CPPUNIT_TEST(testCompress);
+		CPPUNIT_TEST(testSwapOut);
+		CPPUNIT_TEST(testSwapFileReuse);
+		CPPUNIT_TEST(testFullCopyUndo);
+		CPPUNIT_TEST(testPartialCopyUndo);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		qint64 m_budget;
+
+		static double fromBits(quint64 bits)
+		{
+			double result;
+			memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		//! Compare bit by bit, so NaNs and the sign of zero count
+		static bool identical(const QVector<double> &a, const QVector<double> &b)
+		{
+			return a.size() == b.size()
+				&& (a.isEmpty() || memcmp(a.constData(), b.constData(), a.size() * sizeof(double)) == 0);
+		}
+
+		static QVector<double> smoothValues(int count, double offset)
+		{
+			QVector<double> values(count);
+			for (int i=0; i<count; i++)
+				values[i] = floor(1e4 * sin(offset + i * 1e-3)) / 100;
+			return values;
+		}
+
+		static QStringList someTexts(int count, const QString &prefix)
+		{
+			QStringList texts;
+			for (int i=0; i<count; i++)
+				texts << prefix + QString::number(i % 97);
+			return texts;
+		}
+
+		static QList<QDateTime> someDateTimes(int count)
+		{
+			QList<QDateTime> date_times;
+			QDateTime start(QDate(2008, 1, 1), QTime(12, 0, 0, 0));
+			for (int i=0; i<count; i++)
+				date_times << start.addSecs(3600 * i);
+			date_times << QDateTime();
+			return date_times;
+		}
+
+		static void checkColumn(const QVector<double> &expected, Column *column)
+		{
+			CPPUNIT_ASSERT_EQUAL(expected.size(), column->rowCount());
+			for (int i=0; i<expected.size(); i++)
+				CPPUNIT_ASSERT_EQUAL(expected.at(i), column->valueAt(i));
+		}
+
+		static void checkColumn(const QStringList &expected, Column *column)
+		{
+			CPPUNIT_ASSERT_EQUAL(expected.size(), column->rowCount());
+			for (int i=0; i<expected.size(); i++)
+				CPPUNIT_ASSERT(expected.at(i) == column->textAt(i));
+		}
+
+		static void checkColumn(const QList<QDateTime> &expected, Column *column)
+		{
+			CPPUNIT_ASSERT_EQUAL(expected.size(), column->rowCount());
+			for (int i=0; i<expected.size(); i++)
+				CPPUNIT_ASSERT(expected.at(i) == column->dateTimeAt(i));
+		}
+
+		//! Undo and redo the last command on 'stack' twice, checking 'column' in between
+		template<class T>
+		static void checkUndoRedo(QUndoStack *stack, Column *column, const T &before, const T &after)
+		{
+			for (int k=0; k<2; k++) {
+				stack->undo();
+				checkColumn(before, column);
+				stack->redo();
+				checkColumn(after, column);
+			}
+		}
+
+	public:
+		void setUp()
+		{
+			m_budget = UndoMemory::instance()->budget();
+		}
+
+		void tearDown()
+		{
+			UndoMemory::instance()->setBudget(m_budget);
+		}
+
+		void testPackValues()
+		{
+			QVector<double> values;
+			CPPUNIT_ASSERT(identical(values, UndoMemory::unpackValues(UndoMemory::packValues(values))));
+
+			values << 0.0 << -0.0 << 1.0 << -1.0 << NAN << -NAN << INFINITY << -INFINITY;
+			// a NaN with payload, the smallest normal and denormal numbers, the largest double
+			values << fromBits(Q_UINT64_C(0x7ff0000000000123)) << fromBits(Q_UINT64_C(0xfff8dead0000beef));
+			values << DBL_MIN << DBL_MIN / 2 << -DBL_MIN / 3 << fromBits(1) << -fromBits(1) << DBL_MAX << -DBL_MAX;
+			values << 0.0 << -0.0 << -0.0 << 0.0;
+			CPPUNIT_ASSERT(identical(values, UndoMemory::unpackValues(UndoMemory::packValues(values))));
+
+			// every byte position in use
+			QVector<double> random(1001);
+			quint64 bits = Q_UINT64_C(0x0123456789abcdef);
+			for (int i=0; i<random.size(); i++) {
+				bits = bits * Q_UINT64_C(6364136223846793005) + Q_UINT64_C(1442695040888963407);
+				random[i] = fromBits(bits);
+			}
+			CPPUNIT_ASSERT(identical(random, UndoMemory::unpackValues(UndoMemory::packValues(random))));
+
+			// smooth data shrinks considerably
+			QVector<double> smooth = smoothValues(10000, 0);
+			QByteArray packed = UndoMemory::packValues(smooth);
+			CPPUNIT_ASSERT(packed.size() < smooth.size() * int(sizeof(double)) / 2);
+			CPPUNIT_ASSERT(identical(smooth, UndoMemory::unpackValues(packed)));
+		}
+
+		void testCompress()
+		{
+			UndoMemory *memory = UndoMemory::instance();
+			memory->setBudget(qint64(1) << 30);
+			qint64 data_before = memory->dataSize(), disk_before = memory->diskUsage();
+
+			QVector<double> values = smoothValues(20000, 1);
+			QStringList texts = someTexts(2000, "text ");
+			QList<QDateTime> date_times = someDateTimes(2000);
+			UndoPayload value_payload, text_payload, date_time_payload;
+			value_payload.setValues(values, 0);
+			text_payload.setTexts(texts, 0);
+			date_time_payload.setDateTimes(date_times, 0);
+			CPPUNIT_ASSERT_EQUAL(values.size(), value_payload.count());
+			CPPUNIT_ASSERT_EQUAL(texts.size(), text_payload.count());
+			CPPUNIT_ASSERT_EQUAL(date_times.size(), date_time_payload.count());
+			qint64 data_size = memory->dataSize() - data_before;
+			CPPUNIT_ASSERT(data_size > 0);
+
+			// above half of the budget: compressed, but still in memory
+			memory->setBudget(data_size / 2);
+			CPPUNIT_ASSERT(memory->memoryUsage() <= memory->budget() / 2);
+			CPPUNIT_ASSERT(memory->memoryUsage() > 0);
+			CPPUNIT_ASSERT_EQUAL(disk_before, memory->diskUsage());
+			CPPUNIT_ASSERT_EQUAL(data_size, memory->dataSize() - data_before);
+			CPPUNIT_ASSERT(identical(values, value_payload.values()));
+			CPPUNIT_ASSERT(texts == text_payload.texts());
+			CPPUNIT_ASSERT(date_times == date_time_payload.dateTimes());
+
+			// asking for the wrong kind of data
+			CPPUNIT_ASSERT(value_payload.texts().isEmpty());
+			CPPUNIT_ASSERT(text_payload.dateTimes().isEmpty());
+			CPPUNIT_ASSERT(date_time_payload.values().isEmpty());
+
+			value_payload.clear();
+			CPPUNIT_ASSERT(value_payload.isEmpty());
+			CPPUNIT_ASSERT(value_payload.values().isEmpty());
+		}
+
+		void testSwapOut()
+		{
+			UndoMemory *memory = UndoMemory::instance();
+			memory->setBudget(0);
+			qint64 disk_before = memory->diskUsage();
+
+			QVector<double> values = smoothValues(20000, 2);
+			values[5] = NAN;
+			values[6] = -0.0;
+			values[7] = DBL_MIN / 4;
+			QStringList texts = someTexts(2000, "swapped ");
+			texts << QString() << "" << QString::fromUtf8("\xc3\xa4\xe2\x82\xac");
+			QList<QDateTime> date_times = someDateTimes(2000);
+			UndoPayload value_payload, text_payload, date_time_payload;
+			value_payload.setValues(values, 0);
+			text_payload.setTexts(texts, 0);
+			date_time_payload.setDateTimes(date_times, 0);
+
+			CPPUNIT_ASSERT_EQUAL(qint64(0), memory->memoryUsage());
+			CPPUNIT_ASSERT(memory->diskUsage() > disk_before);
+			CPPUNIT_ASSERT(memory->swapFileSize() >= memory->diskUsage());
+
+			// reading doesn't bring the data back into memory
+			for (int k=0; k<2; k++) {
+				CPPUNIT_ASSERT(identical(values, value_payload.values()));
+				CPPUNIT_ASSERT(texts == text_payload.texts());
+				CPPUNIT_ASSERT(date_times == date_time_payload.dateTimes());
+				CPPUNIT_ASSERT_EQUAL(qint64(0), memory->memoryUsage());
+			}
+
+			value_payload.clear();
+			text_payload.clear();
+			date_time_payload.clear();
+			CPPUNIT_ASSERT_EQUAL(disk_before, memory->diskUsage());
+		}
+
+		void testSwapFileReuse()
+		{
+			UndoMemory *memory = UndoMemory::instance();
+			memory->setBudget(0);
+			qint64 file_before = memory->swapFileSize();
+
+			QVector<double> first = smoothValues(10000, 3), second = smoothValues(10000, 4),
+					third = smoothValues(10000, 5);
+			UndoPayload a, b, c;
+			a.setValues(first, 0);
+			b.setValues(second, 0);
+			c.setValues(third, 0);
+			qint64 file_size = memory->swapFileSize();
+			CPPUNIT_ASSERT(file_size > file_before);
+
+			// a gap in the middle is filled by the next payload of at most the same size
+			b.clear();
+			CPPUNIT_ASSERT_EQUAL(file_size, memory->swapFileSize());
+			UndoPayload d;
+			d.setValues(second, 0);
+			CPPUNIT_ASSERT_EQUAL(file_size, memory->swapFileSize());
+			d.setValues(second.mid(0, 5000), 0);
+			CPPUNIT_ASSERT_EQUAL(file_size, memory->swapFileSize());
+			UndoPayload e;
+			e.setValues(second.mid(5000), 0);
+
+			CPPUNIT_ASSERT(identical(first, a.values()));
+			CPPUNIT_ASSERT(identical(third, c.values()));
+			CPPUNIT_ASSERT(identical(second.mid(0, 5000), d.values()));
+			CPPUNIT_ASSERT(identical(second.mid(5000), e.values()));
+
+			// the file shrinks once its end is free
+			e.clear();
+			c.clear();
+			CPPUNIT_ASSERT(memory->swapFileSize() < file_size);
+			a.clear();
+			d.clear();
+			CPPUNIT_ASSERT(memory->swapFileSize() <= file_before);
+		}
+
+		void testFullCopyUndo()
+		{
+			// the backups of the command only exist as payloads in between, here in the swap file
+			UndoMemory::instance()->setBudget(0);
+			Project project;
+			QUndoStack *stack = project.undoStack();
+
+			QVector<double> values = smoothValues(5000, 6), other_values = smoothValues(3000, 7);
+			Column *value_column = new Column("values", values);
+			Column *other_value_column = new Column("other values", other_values);
+			project.addChild(value_column);
+			project.addChild(other_value_column);
+			CPPUNIT_ASSERT(value_column->copy(other_value_column));
+			checkColumn(other_values, value_column);
+			CPPUNIT_ASSERT(UndoMemory::instance()->dataSize(stack) > 0);
+			CPPUNIT_ASSERT_EQUAL(qint64(0), UndoMemory::instance()->memoryUsage(stack));
+			checkUndoRedo(stack, value_column, values, other_values);
+
+			QStringList texts = someTexts(500, "a"), other_texts = someTexts(800, "b");
+			Column *text_column = new Column("texts", texts);
+			Column *other_text_column = new Column("other texts", other_texts);
+			project.addChild(text_column);
+			project.addChild(other_text_column);
+			CPPUNIT_ASSERT(text_column->copy(other_text_column));
+			checkUndoRedo(stack, text_column, texts, other_texts);
+
+			QList<QDateTime> date_times = someDateTimes(300), other_date_times = someDateTimes(100);
+			Column *date_time_column = new Column("date-times", date_times);
+			Column *other_date_time_column = new Column("other date-times", other_date_times);
+			project.addChild(date_time_column);
+			project.addChild(other_date_time_column);
+			CPPUNIT_ASSERT(date_time_column->copy(other_date_time_column));
+			checkUndoRedo(stack, date_time_column, date_times, other_date_times);
+		}
+
+		void testPartialCopyUndo()
+		{
+			UndoMemory::instance()->setBudget(0);
+			Project project;
+			QUndoStack *stack = project.undoStack();
+
+			QVector<double> values = smoothValues(5000, 8), source_values = smoothValues(3000, 9);
+			Column *value_column = new Column("values", values);
+			Column *source_value_column = new Column("source values", source_values);
+			project.addChild(value_column);
+			project.addChild(source_value_column);
+			CPPUNIT_ASSERT(value_column->copy(source_value_column, 1000, 4000, 2000));
+			QVector<double> copied_values = values.mid(0, 4000);
+			copied_values += source_values.mid(1000, 2000);
+			checkColumn(copied_values, value_column);
+			CPPUNIT_ASSERT_EQUAL(qint64(0), UndoMemory::instance()->memoryUsage(stack));
+			checkUndoRedo(stack, value_column, values, copied_values);
+
+			QStringList texts = someTexts(300, "a"), source_texts = someTexts(300, "b");
+			Column *text_column = new Column("texts", texts);
+			Column *source_text_column = new Column("source texts", source_texts);
+			project.addChild(text_column);
+			project.addChild(source_text_column);
+			CPPUNIT_ASSERT(text_column->copy(source_text_column, 0, 100, 50));
+			QStringList copied_texts = texts;
+			for (int i=0; i<50; i++)
+				copied_texts[100 + i] = source_texts.at(i);
+			checkUndoRedo(stack, text_column, texts, copied_texts);
+
+			QList<QDateTime> date_times = someDateTimes(100), source_date_times = someDateTimes(50);
+			Column *date_time_column = new Column("date-times", date_times);
+			Column *source_date_time_column = new Column("source date-times", source_date_times);
+			project.addChild(date_time_column);
+			project.addChild(source_date_time_column);
+			CPPUNIT_ASSERT(date_time_column->copy(source_date_time_column, 10, 0, 20));
+			QList<QDateTime> copied_date_times = date_times;
+			for (int i=0; i<20; i++)
+				copied_date_times[i] = source_date_times.at(10 + i);
+			checkUndoRedo(stack, date_time_column, date_times, copied_date_times);
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( UndoPayloadTest );
+
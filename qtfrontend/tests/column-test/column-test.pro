@@ -3,8 +3,8 @@ TARGET = column-test
 CONFIG += debug
 QT += xml network
 DEFINES += SUPPRESS_SCRIPTING_INIT
-DEPENDPATH += . .. ../.. ../../lib ../../core ../../core/datatypes ../../core/column ../../core/filters
-INCLUDEPATH += . .. ../.. ../../lib ../../core ../../core/datatypes ../../core/column ../../core/filters 
+DEPENDPATH += . .. ../.. ../../lib ../../core ../../core/datatypes ../../core/column ../../core/filters ../../../backend ../../../backend/core ../../../backend/core/column ../../../backend/core/datatypes ../../../backend/core/filters ../../../backend/lib ../../../backend/table
+INCLUDEPATH += . .. ../.. ../../lib ../../core ../../core/datatypes ../../core/column ../../core/filters ../../../backend ../../../backend/core ../../../backend/core/column ../../../backend/core/datatypes ../../../backend/core/filters ../../../backend/lib
 unix:LIBS += -lcppunit
 
 FORMS += \
@@ -22,6 +22,7 @@ HEADERS += \
 			  ColumnPrivate.h \
 			  columncommands.h \
 			  IntervalAttribute.h \
+			  ValueSpan.h \
 			  AbstractFilter.h \
 			  AbstractSimpleFilter.h \
 			  SimpleCopyThroughFilter.h \
@@ -46,6 +47,10 @@ HEADERS += \
 			  ProjectExplorer.h \
 			  AspectTreeModel.h \
 			  XmlStreamReader.h \
+			  ProjectArchive.h \
+			  PageCache.h \
+			  PagedDoubleData.h \
+			  UndoPayload.h \
 			  ScriptingEngineManager.h \
 			  ProjectConfigPage.h \
     		  ConfigPageWidget.h \
@@ -55,6 +60,7 @@ HEADERS += \
 			  ShortcutsDialog.h \
 			  ImportDialog.h \
 			  ExtensibleFileDialog.h \
+			  RowSorter.h \
 
 
 SOURCES += \
@@ -64,6 +70,7 @@ SOURCES += \
 			  String2DateTimeFilter.cpp \
 			  AbstractFilter.cpp \
 			  AbstractSimpleFilter.cpp \
+			  AbstractColumn.cpp \
 			  Column.cpp \
 			  ColumnPrivate.cpp \
 			  columncommands.cpp \
@@ -78,6 +85,10 @@ SOURCES += \
 			  ProjectExplorer.cpp \
 			  AspectTreeModel.cpp \
 			  XmlStreamReader.cpp \
+			  ProjectArchive.cpp \
+			  PageCache.cpp \
+			  PagedDoubleData.cpp \
+			  UndoPayload.cpp \
 			  ScriptingEngineManager.cpp \
 			  ProjectConfigPage.cpp \
     		  ConfigPageWidget.cpp \
@@ -87,6 +98,7 @@ SOURCES += \
 			  ShortcutsDialog.cpp \
 			  ImportDialog.cpp \
 			  ExtensibleFileDialog.cpp \
+			  RowSorter.cpp \
 
 # test cases
 HEADERS += \
@@ -94,6 +106,7 @@ HEADERS += \
 
 SOURCES += main.cpp \
 	ColumnTest.cpp \
+	UndoPayloadTest.cpp \
 	
 
 
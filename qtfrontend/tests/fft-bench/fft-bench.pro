@@ -0,0 +1,16 @@
+TEMPLATE = app
+TARGET = fft-bench
+CONFIG += release console
+QT -= gui
+DEPENDPATH += . .. ../../../backend ../../../backend/lib
+INCLUDEPATH += . .. ../../../backend ../../../backend/lib
+unix:LIBS += -lgsl -lgslcblas
+win32:INCLUDEPATH += c:/gsl/include
+win32:LIBS += c:/gsl/lib/libgsl.a c:/gsl/lib/libgslcblas.a
+
+HEADERS += \
+			  FourierTransform.h \
+			  ParallelFor.h \
+
+SOURCES += main.cpp \
+			  FourierTransform.cpp \
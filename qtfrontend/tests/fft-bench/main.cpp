@@ -0,0 +1,138 @@
+/***************************************************************************
+    File                 : main.cpp
+    Project              : SciDAVis
+    Description          : Benchmark for the cached FFT plans of FourierTransform
+    --------------------------------------------------------------------
+    Copyright            : (C) 2008 SciDAVis team
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *  This program is free software; you can redistribute it and/or modify   *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation; either version 2 of the License, or      *
+ *  (at your option) any later version.                                    *
+ *                                                                         *
+ *  This program is distributed in the hope that it will be useful,        *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the Free Software           *
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor,                    *
+ *   Boston, MA  02110-1301  USA                                           *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#include "FourierTransform.h"
+#include <QTime>
+#include <QStringList>
+#include <QCoreApplication>
+#include <gsl/gsl_fft_halfcomplex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Usage: fft-bench [repetitions]
+ *
+ * Times forward and inverse real transforms of typical lengths (powers of two, lengths
+ * with small prime factors and lengths with a large prime factor) in three ways: the way
+ * the analysis filters used to do it (allocating GSL wavetables for every call), the first
+ * use of a FourierTransform (which has to create the plan) and repeated use of a cached
+ * plan. The last line filters a batch of curves of equal length.
+ */
+
+static void fill(double * data, int n)
+{
+	for (int i=0; i<n; i++)
+		data[i] = sin(0.01 * i) + (rand() % 1000) / 1000.0;
+}
+
+static void gslRoundTrip(double * data, int n)
+{
+	gsl_fft_real_workspace *work = gsl_fft_real_workspace_alloc(n);
+	gsl_fft_real_wavetable *real = gsl_fft_real_wavetable_alloc(n);
+	gsl_fft_real_transform(data, 1, n, real, work);
+	gsl_fft_real_wavetable_free(real);
+	gsl_fft_halfcomplex_wavetable *hc = gsl_fft_halfcomplex_wavetable_alloc(n);
+	gsl_fft_halfcomplex_inverse(data, 1, n, hc, work);
+	gsl_fft_halfcomplex_wavetable_free(hc);
+	gsl_fft_real_workspace_free(work);
+}
+
+static void run(int n, int repetitions)
+{
+	double * data = new double[n];
+	fill(data, n);
+	QTime timer;
+
+	timer.start();
+	for (int i=0; i<repetitions; i++)
+		gslRoundTrip(data, n);
+	int gsl = timer.elapsed();
+
+	FourierTransform::clearCache();
+	timer.start();
+	{
+		FourierTransform fft(n);
+		fft.realForward(data);
+		fft.halfcomplexInverse(data);
+	}
+	int first = timer.elapsed();
+
+	timer.start();
+	for (int i=0; i<repetitions; i++)
+	{
+		FourierTransform fft(n);
+		fft.realForward(data);
+		fft.halfcomplexInverse(data);
+	}
+	int cached = timer.elapsed();
+
+	printf("%10d %6s %10d %10d %10d\n", n, FourierTransform::isFastSize(n) ? "yes" : "no",
+			gsl, first, cached);
+	delete[] data;
+}
+
+static void runBatch(int n, int curves)
+{
+	double * data = new double[n * curves];
+	fill(data, n * curves);
+	QTime timer;
+
+	timer.start();
+	for (int i=0; i<curves; i++)
+		gslRoundTrip(data + i * n, n);
+	int gsl = timer.elapsed();
+
+	timer.start();
+	FourierTransform fft(n);
+	fft.realForward(data, curves);
+	fft.halfcomplexInverse(data, curves);
+	int batch = timer.elapsed();
+
+	printf("%d curves of %d points: %d ms with GSL, %d ms as a batch\n", curves, n, gsl, batch);
+	delete[] data;
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QStringList args = app.arguments();
+	int repetitions = args.size() > 1 ? args.at(1).toInt() : 10;
+	srand(42);
+
+	static const int sizes[] = { 1024, 4096, 65536, 1 << 20, 1000, 6000, 100000, 1000000,
+		1009, 10007, 100003, 1000003, 2 * 49999 };
+
+	printf("forward and inverse real transforms, %d repetitions; times in ms\n", repetitions);
+	printf("%10s %6s %10s %10s %10s\n", "length", "fast", "GSL", "first use", "cached");
+	for (unsigned i=0; i<sizeof(sizes)/sizeof(int); i++)
+		run(sizes[i], repetitions);
+	runBatch(10000, 500);
+	return 0;
+}
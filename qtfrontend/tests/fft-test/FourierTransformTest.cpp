@@ -0,0 +1,217 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "FourierTransform.h"
+
+#include <gsl/gsl_fft_complex.h>
+#include <gsl/gsl_fft_real.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+
+#include <QVector>
+
+#include <math.h>
+#include <stdlib.h>
+
+class FourierTransformTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(FourierTransformTest);
+		CPPUNIT_TEST(testPowerOfTwo);
+		CPPUNIT_TEST(testSmooth);
+		CPPUNIT_TEST(testPrime);
+		CPPUNIT_TEST(testTwicePrime);
+		CPPUNIT_TEST(testLarge);
+		CPPUNIT_TEST(testMixedCalls);
+		CPPUNIT_TEST(testBatch);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		static QVector<double> randomValues(int count)
+		{
+			QVector<double> values(count);
+			for (int i=0; i<count; i++)
+				values[i] = (rand() % 20001)/1000.0 - 10;
+			return values;
+		}
+
+		//! The transforms computed by GSL's mixed-radix routines directly
+		static QVector<double> gslReal(QVector<double> data)
+		{
+			int n = data.size();
+			gsl_fft_real_wavetable * table = gsl_fft_real_wavetable_alloc(n);
+			gsl_fft_real_workspace * work = gsl_fft_real_workspace_alloc(n);
+			gsl_fft_real_transform(data.data(), 1, n, table, work);
+			gsl_fft_real_workspace_free(work);
+			gsl_fft_real_wavetable_free(table);
+			return data;
+		}
+
+		static QVector<double> gslHalfcomplexInverse(QVector<double> data)
+		{
+			int n = data.size();
+			gsl_fft_halfcomplex_wavetable * table = gsl_fft_halfcomplex_wavetable_alloc(n);
+			gsl_fft_real_workspace * work = gsl_fft_real_workspace_alloc(n);
+			gsl_fft_halfcomplex_inverse(data.data(), 1, n, table, work);
+			gsl_fft_real_workspace_free(work);
+			gsl_fft_halfcomplex_wavetable_free(table);
+			return data;
+		}
+
+		static QVector<double> gslComplex(QVector<double> data, bool inverse)
+		{
+			int n = data.size()/2;
+			gsl_fft_complex_wavetable * table = gsl_fft_complex_wavetable_alloc(n);
+			gsl_fft_complex_workspace * work = gsl_fft_complex_workspace_alloc(n);
+			if (inverse)
+				gsl_fft_complex_inverse(data.data(), 1, n, table, work);
+			else
+				gsl_fft_complex_forward(data.data(), 1, n, table, work);
+			gsl_fft_complex_workspace_free(work);
+			gsl_fft_complex_wavetable_free(table);
+			return data;
+		}
+
+		//! Compare 'result' with 'expected', relative to the largest value of 'expected'
+		static void checkEqual(const QVector<double> &expected, const QVector<double> &result)
+		{
+			CPPUNIT_ASSERT_EQUAL(expected.size(), result.size());
+			double scale = 1;
+			foreach(double value, expected)
+				scale = qMax(scale, fabs(value));
+			for (int i=0; i<expected.size(); i++)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.at(i), result.at(i), 1e-9*scale);
+		}
+
+		//! Compare all four transforms of length 'n' with GSL, the real ones first
+		void checkLength(int n)
+		{
+			FourierTransform fft(n);
+			CPPUNIT_ASSERT_EQUAL(n, fft.size());
+
+			QVector<double> real = randomValues(n);
+			QVector<double> result = real;
+			CPPUNIT_ASSERT(fft.realForward(result.data()));
+			checkEqual(gslReal(real), result);
+			QVector<double> halfcomplex = result;
+			CPPUNIT_ASSERT(fft.halfcomplexInverse(result.data()));
+			checkEqual(gslHalfcomplexInverse(halfcomplex), result);
+			checkEqual(real, result);
+
+			QVector<double> complex = randomValues(2*n);
+			result = complex;
+			CPPUNIT_ASSERT(fft.complexForward(result.data()));
+			checkEqual(gslComplex(complex, false), result);
+			CPPUNIT_ASSERT(fft.complexInverse(result.data()));
+			checkEqual(complex, result);
+			result = complex;
+			CPPUNIT_ASSERT(fft.complexInverse(result.data()));
+			checkEqual(gslComplex(complex, true), result);
+		}
+
+	public:
+		void setUp()
+		{
+			srand(1);
+			FourierTransform::clearCache();
+		}
+
+		void tearDown()
+		{
+			FourierTransform::clearCache();
+		}
+
+		void testPowerOfTwo()
+		{
+			int sizes[] = {1, 2, 4, 16, 256, 1024, 8192};
+			for (int i=0; i<7; i++)
+				checkLength(sizes[i]);
+		}
+
+		void testSmooth()
+		{
+			// 2*3*3*5*7, 3^5, 5^4, 7^3 and 2^3*3*5*7*11 (still mixed-radix in GSL)
+			int sizes[] = {630, 243, 625, 343, 9240, 3, 15};
+			for (int i=0; i<7; i++)
+				checkLength(sizes[i]);
+		}
+
+		void testPrime()
+		{
+			// 37 is short enough for GSL, the others use Bluestein's algorithm
+			int sizes[] = {37, 67, 97, 1009, 4099};
+			for (int i=0; i<5; i++)
+				checkLength(sizes[i]);
+		}
+
+		void testTwicePrime()
+		{
+			// real transforms of these lengths are computed from complex ones of half the length
+			int sizes[] = {74, 134, 2018, 8198};
+			for (int i=0; i<4; i++)
+				checkLength(sizes[i]);
+		}
+
+		void testLarge()
+		{
+			// split into rows and columns; 2^18 is also a large real transform
+			int sizes[] = {1 << 17, 2*3*5*7*1024, 1 << 18};
+			for (int i=0; i<3; i++)
+				checkLength(sizes[i]);
+		}
+
+		void testMixedCalls()
+		{
+			// real and complex calls alternating on one plan, starting with either kind
+			int sizes[] = {74, 2018, 1009};
+			for (int i=0; i<3; i++) {
+				for (int first_complex=0; first_complex<2; first_complex++) {
+					FourierTransform::clearCache();
+					int n = sizes[i];
+					FourierTransform fft(n);
+					QVector<double> real = randomValues(n), complex = randomValues(2*n);
+					QVector<double> real_result = real, complex_result = complex;
+					if (first_complex)
+						CPPUNIT_ASSERT(fft.complexForward(complex_result.data()));
+					for (int k=0; k<3; k++) {
+						real_result = real;
+						CPPUNIT_ASSERT(fft.realForward(real_result.data()));
+						checkEqual(gslReal(real), real_result);
+						complex_result = complex;
+						CPPUNIT_ASSERT(fft.complexForward(complex_result.data()));
+						checkEqual(gslComplex(complex, false), complex_result);
+						CPPUNIT_ASSERT(fft.halfcomplexInverse(real_result.data()));
+						checkEqual(real, real_result);
+						CPPUNIT_ASSERT(fft.complexInverse(complex_result.data()));
+						checkEqual(complex, complex_result);
+					}
+					// a second transform shares the plan and its pooled buffers
+					FourierTransform other(n);
+					complex_result = complex;
+					CPPUNIT_ASSERT(other.complexInverse(complex_result.data()));
+					checkEqual(gslComplex(complex, true), complex_result);
+				}
+			}
+		}
+
+		void testBatch()
+		{
+			int sizes[] = {630, 74, 1009};
+			for (int i=0; i<3; i++) {
+				int n = sizes[i], count = 5;
+				FourierTransform fft(n);
+				QVector<double> data = randomValues(n*count);
+				QVector<double> result = data;
+				CPPUNIT_ASSERT(fft.realForward(result.data(), count));
+				for (int k=0; k<count; k++) {
+					QVector<double> array(n), transformed(n);
+					for (int j=0; j<n; j++) {
+						array[j] = data.at(k*n + j);
+						transformed[j] = result.at(k*n + j);
+					}
+					checkEqual(gslReal(array), transformed);
+				}
+				CPPUNIT_ASSERT(fft.halfcomplexInverse(result.data(), count));
+				checkEqual(data, result);
+			}
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( FourierTransformTest );
+
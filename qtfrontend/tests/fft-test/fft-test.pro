@@ -0,0 +1,22 @@
+TEMPLATE = app
+TARGET = fft-test
+CONFIG += debug console exceptions
+QT -= gui
+DEPENDPATH += . .. ../../../backend ../../../backend/lib
+INCLUDEPATH += . .. ../../../backend ../../../backend/lib
+unix:LIBS += -lcppunit -lgsl -lgslcblas
+win32:INCLUDEPATH += c:/gsl/include
+win32:LIBS += c:/gsl/lib/libgsl.a c:/gsl/lib/libgslcblas.a
+
+# units used
+HEADERS += \
+			  FourierTransform.h \
+			  ParallelFor.h \
+
+SOURCES += \
+			  FourierTransform.cpp \
+
+# test cases
+SOURCES += main.cpp \
+	FourierTransformTest.cpp \
+
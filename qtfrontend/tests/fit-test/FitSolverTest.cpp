@@ -0,0 +1,183 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "FitSolver.h"
+#include "BatchFit.h"
+#include "analysis/fit_gsl.h"
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_math.h>
+
+#include <QVector>
+#include <QStringList>
+
+#include <math.h>
+
+class FitSolverTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(FitSolverTest);
+		CPPUNIT_TEST(testGaussLevenbergMarquardt);
+		CPPUNIT_TEST(testUserFunction);
+		CPPUNIT_TEST(testSimplex);
+		CPPUNIT_TEST(testFailures);
+		CPPUNIT_TEST(testBatch);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		QVector<double> x;
+
+		//! Values of gauss_f's model y0 + A*exp(-0.5*(x-xc)^2/w^2)
+		QVector<double> gauss(double y0, double A, double xc, double w)
+		{
+			QVector<double> y;
+			foreach(double xi, x)
+				y << y0 + A*exp(-0.5*(xi-xc)*(xi-xc)/(w*w));
+			return y;
+		}
+
+		void checkParameters(const FitSolver::Result& result, double y0, double A, double xc, double w)
+		{
+			CPPUNIT_ASSERT_EQUAL(4, result.parameters.size());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(y0, result.parameters.at(0), 1e-5);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(A, result.parameters.at(1), 1e-5);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(xc, result.parameters.at(2), 1e-5);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(w, fabs(result.parameters.at(3)), 1e-5);
+		}
+
+	public:
+		void setUp()
+		{
+			x.clear();
+			for (int i=0; i<=200; i++)
+				x << -3.0 + i*0.05;
+		}
+
+		void testGaussLevenbergMarquardt()
+		{
+			QVector<double> y = gauss(1.0, 5.0, 2.0, 0.8);
+			QVector<double> sigma(x.size(), 1.0);
+			double initial[4] = {0.5, 4.0, 1.5, 1.0};
+			FitSolver solver(gauss_f, gauss_df, gauss_fdf, gauss_d, 4);
+			solver.setTolerance(1e-10);
+			for (int a=FitSolver::ScaledLevenbergMarquardt; a<=FitSolver::UnscaledLevenbergMarquardt; a++)
+			{
+				solver.setAlgorithm(FitSolver::Algorithm(a));
+				FitSolver::Result result = solver.solve(x.size(), x.data(), y.data(), sigma.data(), initial);
+				CPPUNIT_ASSERT(result.error.isEmpty());
+				checkParameters(result, 1.0, 5.0, 2.0, 0.8);
+				CPPUNIT_ASSERT(result.chi_square < 1e-12);
+				CPPUNIT_ASSERT(result.iterations > 0);
+				CPPUNIT_ASSERT_EQUAL(16, result.covariance.size());
+			}
+		}
+
+		void testUserFunction()
+		{
+			QVector<double> y = gauss(1.0, 5.0, 2.0, 0.8);
+			QVector<double> sigma(x.size(), 1.0);
+			double initial[4] = {0.5, 4.0, 1.5, 1.0};
+			FitSolver solver(user_f, user_df, user_fdf, user_d, 4);
+			solver.setUserFunction("y0+A*exp(-0.5*(x-xc)^2/w^2)", QStringList() << "y0" << "A" << "xc" << "w");
+			solver.setTolerance(1e-10);
+			FitSolver::Result result = solver.solve(x.size(), x.data(), y.data(), sigma.data(), initial);
+			CPPUNIT_ASSERT(result.error.isEmpty());
+			checkParameters(result, 1.0, 5.0, 2.0, 0.8);
+		}
+
+		void testSimplex()
+		{
+			QVector<double> y;
+			foreach(double xi, x)
+				y << 2.0*xi - 1.0;
+			QVector<double> sigma(x.size(), 1.0);
+			double initial[2] = {1.0, 1.0};
+			FitSolver solver(user_f, user_df, user_fdf, user_d, 2);
+			solver.setUserFunction("a*x+b", QStringList() << "a" << "b");
+			solver.setAlgorithm(FitSolver::NelderMeadSimplex);
+			solver.setTolerance(1e-8);
+			solver.setMaximumIterations(10000);
+			FitSolver::Result result = solver.solve(x.size(), x.data(), y.data(), sigma.data(), initial);
+			CPPUNIT_ASSERT_EQUAL(2, result.parameters.size());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, result.parameters.at(0), 1e-4);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, result.parameters.at(1), 1e-4);
+		}
+
+		void testFailures()
+		{
+			QVector<double> y = gauss(1.0, 5.0, 2.0, 0.8);
+			QVector<double> sigma(x.size(), 1.0);
+
+			// the simplex can't be set up on a non-finite function value
+			double bad_initial[4] = {0.5, 4.0, 1.5, NAN};
+			FitSolver simplex(gauss_f, gauss_df, gauss_fdf, gauss_d, 4);
+			simplex.setAlgorithm(FitSolver::NelderMeadSimplex);
+			FitSolver::Result result = simplex.solve(x.size(), x.data(), y.data(), sigma.data(), bad_initial);
+			CPPUNIT_ASSERT(result.parameters.isEmpty());
+			CPPUNIT_ASSERT(result.status != GSL_SUCCESS);
+
+			// less points than parameters, or none at all, with either kind of solver
+			double initial[4] = {0.5, 4.0, 1.5, 1.0};
+			FitSolver lm(gauss_f, gauss_df, gauss_fdf, gauss_d, 4);
+			for (int n=0; n<4; n+=3)
+			{
+				result = lm.solve(n, x.data(), y.data(), sigma.data(), initial);
+				CPPUNIT_ASSERT(result.parameters.isEmpty());
+				CPPUNIT_ASSERT(result.status != GSL_SUCCESS);
+				CPPUNIT_ASSERT(!result.error.isEmpty());
+				result = simplex.solve(n, x.data(), y.data(), sigma.data(), initial);
+				CPPUNIT_ASSERT(result.parameters.isEmpty());
+				CPPUNIT_ASSERT(result.status != GSL_SUCCESS);
+				CPPUNIT_ASSERT(!result.error.isEmpty());
+			}
+
+			// parse errors
+			FitSolver user(user_f, user_df, user_fdf, user_d, 1);
+			user.setUserFunction("a*", QStringList() << "a");
+			result = user.solve(x.size(), x.data(), y.data(), sigma.data(), initial);
+			CPPUNIT_ASSERT(!result.error.isEmpty());
+			CPPUNIT_ASSERT(result.parameters.isEmpty());
+		}
+
+		void testBatch()
+		{
+			FitSolver solver(gauss_f, gauss_df, gauss_fdf, gauss_d, 4);
+			solver.setTolerance(1e-10);
+			QVector<double> initial;
+			initial << 0.5 << 4.0 << 2.0 << 1.0;
+			BatchFit batch(solver, initial);
+			batch.addDataset("first", x, gauss(1.0, 5.0, 1.5, 0.8));
+			batch.addDataset("second", x, gauss(0.0, 3.0, 2.5, 1.2));
+			batch.addDataset("third", x, gauss(0.5, 3.0, 2.0, 1.0));
+			// x is longer than y: extra points are dropped
+			batch.addDataset("short", x, gauss(1.0, 2.0, 2.0, 1.0).mid(0, 150));
+			CPPUNIT_ASSERT_EQUAL(4, batch.datasetCount());
+			CPPUNIT_ASSERT_EQUAL(QString("second"), batch.datasetName(1));
+			CPPUNIT_ASSERT_EQUAL(150, batch.datasetSize(3));
+			// too short and empty data sets fail on their own, without stopping the others
+			CPPUNIT_ASSERT(!batch.addDataset("too short", x.mid(0, 3), gauss(1.0, 2.0, 2.0, 1.0).mid(0, 3)));
+			CPPUNIT_ASSERT(!batch.addDataset("empty", QVector<double>(), QVector<double>()));
+			CPPUNIT_ASSERT_EQUAL(6, batch.datasetCount());
+
+			batch.run();
+			checkParameters(batch.result(0), 1.0, 5.0, 1.5, 0.8);
+			checkParameters(batch.result(1), 0.0, 3.0, 2.5, 1.2);
+			checkParameters(batch.result(2), 0.5, 3.0, 2.0, 1.0);
+			checkParameters(batch.result(3), 1.0, 2.0, 2.0, 1.0);
+			for (int d=4; d<6; d++)
+			{
+				CPPUNIT_ASSERT(batch.result(d).parameters.isEmpty());
+				CPPUNIT_ASSERT(!batch.result(d).error.isEmpty());
+			}
+			double single_chi_square = batch.result(0).chi_square;
+
+			// more starts never give a worse result, and are reproducible
+			batch.setStarts(6, 0.3);
+			batch.run();
+			checkParameters(batch.result(0), 1.0, 5.0, 1.5, 0.8);
+			CPPUNIT_ASSERT(batch.result(0).chi_square <= single_chi_square);
+			QVector<double> first_run = batch.result(1).parameters;
+			batch.run();
+			for (int i=0; i<4; i++)
+				CPPUNIT_ASSERT_EQUAL(first_run.at(i), batch.result(1).parameters.at(i));
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( FitSolverTest );
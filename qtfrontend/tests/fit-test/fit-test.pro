@@ -0,0 +1,26 @@
+TEMPLATE = app
+TARGET = fit-test
+CONFIG += debug console exceptions
+QT -= gui
+DEPENDPATH += . .. ../.. ../../analysis ../../../backend ../../../backend/core ../../../backend/lib
+INCLUDEPATH += . .. ../.. ../../../backend ../../../backend/core ../../../backend/lib
+unix:LIBS += -lcppunit -lmuparser -lgsl -lgslcblas
+
+# units used
+HEADERS += \
+			  FitSolver.h \
+			  BatchFit.h \
+			  fit_gsl.h \
+			  MyParser.h \
+			  ParallelFor.h \
+
+SOURCES += \
+			  FitSolver.cpp \
+			  BatchFit.cpp \
+			  fit_gsl.cpp \
+			  MyParser.cpp \
+
+# test cases
+SOURCES += main.cpp \
+	FitSolverTest.cpp \
+
@@ -0,0 +1,193 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "BoxStatistics.h"
+
+#include <qwt_data.h>
+#include <QVector>
+
+#include <algorithm>
+#include <math.h>
+
+class BoxStatisticsTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(BoxStatisticsTest);
+		CPPUNIT_TEST(testSummary);
+		CPPUNIT_TEST(testQuantiles);
+		CPPUNIT_TEST(testOrderStatistics);
+		CPPUNIT_TEST(testSmallSizes);
+		CPPUNIT_TEST(testUpdate);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		unsigned int seed;
+
+		double random() {
+			seed = seed * 1103515245u + 12345u;
+			return ((seed >> 8) & 0xffff) / 65536.0;
+		}
+
+		QVector<double> randomValues(int count, int distinct)
+		{
+			QVector<double> values(count);
+			for (int i=0; i<count; i++)
+				values[i] = floor(random()*distinct) - distinct/3;
+			return values;
+		}
+
+		//! Quantile of sorted values as computed by gsl_stats_quantile_from_sorted_data()
+		static double sortedQuantile(const QVector<double> &sorted, double f)
+		{
+			double index = f*(sorted.size() - 1);
+			int lower = int(floor(index));
+			double delta = index - lower;
+			if (lower + 1 >= sorted.size())
+				return sorted.at(lower);
+			return (1 - delta)*sorted.at(lower) + delta*sorted.at(lower + 1);
+		}
+
+		//! Query the quantiles of 'values' in the given order and compare them with sorting
+		void checkQuantiles(const QVector<double> &values, const QVector<double> &fractions)
+		{
+			BoxStatistics statistics;
+			statistics.update(QwtArrayData(QVector<double>(values.size(), 0.0), values));
+			QVector<double> sorted = values;
+			std::sort(sorted.begin(), sorted.end());
+			foreach(double f, fractions)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(sortedQuantile(sorted, f), statistics.quantile(f),
+						1e-9*(1 + fabs(sortedQuantile(sorted, f))));
+			// asking again returns the same values from the partially sorted copy
+			foreach(double f, fractions)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(sortedQuantile(sorted, f), statistics.quantile(f),
+						1e-9*(1 + fabs(sortedQuantile(sorted, f))));
+		}
+
+	public:
+		void setUp()
+		{
+			seed = 1;
+		}
+
+		void testSummary()
+		{
+			double y[] = {4, -2, 7.5, 1, 1, 10, -3};
+			QVector<double> values;
+			for (int i=0; i<7; i++)
+				values << y[i];
+			BoxStatistics statistics;
+			CPPUNIT_ASSERT(!statistics.isValid());
+			statistics.update(QwtArrayData(QVector<double>(7, 1.0), values));
+			CPPUNIT_ASSERT(statistics.isValid());
+			CPPUNIT_ASSERT_EQUAL(7, statistics.size());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(18.5/7, statistics.mean(), 1e-12);
+			double squares = 0;
+			foreach(double v, values)
+				squares += (v - 18.5/7)*(v - 18.5/7);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(sqrt(squares/6), statistics.standardDeviation(), 1e-12);
+			CPPUNIT_ASSERT_EQUAL(-3.0, statistics.minimum());
+			CPPUNIT_ASSERT_EQUAL(10.0, statistics.maximum());
+			CPPUNIT_ASSERT_EQUAL(-3.0, statistics.quantile(0));
+			CPPUNIT_ASSERT_EQUAL(10.0, statistics.quantile(1));
+			// sorted: -3 -2 1 1 4 7.5 10
+			CPPUNIT_ASSERT_EQUAL(1.0, statistics.quantile(0.5));
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.5, statistics.quantile(0.25), 1e-12);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(5.75, statistics.quantile(0.75), 1e-12);
+			// fractions outside of [0,1] are clamped
+			CPPUNIT_ASSERT_EQUAL(-3.0, statistics.quantile(-0.5));
+			CPPUNIT_ASSERT_EQUAL(10.0, statistics.quantile(2));
+		}
+
+		void testQuantiles()
+		{
+			// the fractions used for boxes and whiskers, in the order BoxCurve asks for them
+			double box[] = {0.5, 0.25, 0.75, 0.05, 0.95, 0.01, 0.99, 0.1, 0.9};
+			QVector<double> fractions;
+			for (int i=0; i<9; i++)
+				fractions << box[i];
+			int sizes[] = {3, 10, 101, 1000, 99999};
+			for (int s=0; s<5; s++) {
+				checkQuantiles(randomValues(sizes[s], 1000000), fractions);
+				// many equal values
+				checkQuantiles(randomValues(sizes[s], 5), fractions);
+			}
+
+			// random fractions in random order
+			QVector<double> values = randomValues(5000, 1000);
+			fractions.clear();
+			for (int i=0; i<200; i++)
+				fractions << random();
+			checkQuantiles(values, fractions);
+
+			// sorted and reversed input
+			std::sort(values.begin(), values.end());
+			checkQuantiles(values, fractions);
+			std::reverse(values.begin(), values.end());
+			checkQuantiles(values, fractions);
+		}
+
+		void testOrderStatistics()
+		{
+			QVector<double> values = randomValues(2000, 300);
+			BoxStatistics statistics;
+			statistics.update(QwtArrayData(QVector<double>(values.size(), 0.0), values));
+			QVector<double> sorted = values;
+			std::sort(sorted.begin(), sorted.end());
+			for (int i=0; i<500; i++) {
+				int rank = int(random()*values.size());
+				CPPUNIT_ASSERT_EQUAL(sorted.at(rank), statistics.orderStatistic(rank));
+			}
+			for (int rank=0; rank<values.size(); rank++)
+				CPPUNIT_ASSERT_EQUAL(sorted.at(rank), statistics.orderStatistic(rank));
+			// ranks outside of the values are clamped
+			CPPUNIT_ASSERT_EQUAL(sorted.first(), statistics.orderStatistic(-1));
+			CPPUNIT_ASSERT_EQUAL(sorted.last(), statistics.orderStatistic(values.size()));
+		}
+
+		void testSmallSizes()
+		{
+			BoxStatistics statistics;
+			statistics.update(QwtArrayData(QVector<double>(), QVector<double>()));
+			CPPUNIT_ASSERT(statistics.isValid());
+			CPPUNIT_ASSERT_EQUAL(0, statistics.size());
+			CPPUNIT_ASSERT_EQUAL(0.0, statistics.quantile(0.5));
+
+			statistics.update(QwtArrayData(QVector<double>(1, 0.0), QVector<double>(1, 3.0)));
+			CPPUNIT_ASSERT_EQUAL(3.0, statistics.quantile(0));
+			CPPUNIT_ASSERT_EQUAL(3.0, statistics.quantile(0.3));
+			CPPUNIT_ASSERT_EQUAL(3.0, statistics.quantile(1));
+			CPPUNIT_ASSERT_EQUAL(0.0, statistics.standardDeviation());
+
+			// maximum first and minimum last
+			QVector<double> values;
+			values << 2 << 1;
+			statistics.update(QwtArrayData(QVector<double>(2, 0.0), values));
+			CPPUNIT_ASSERT_EQUAL(1.0, statistics.quantile(0));
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, statistics.quantile(0.5), 1e-12);
+			CPPUNIT_ASSERT_EQUAL(2.0, statistics.quantile(1));
+			values.clear();
+			values << 5 << 3 << 4 << 1;
+			checkQuantiles(values, QVector<double>() << 0 << 0.2 << 0.5 << 0.7 << 1);
+		}
+
+		void testUpdate()
+		{
+			QVector<double> values = randomValues(1000, 100);
+			BoxStatistics statistics;
+			statistics.update(QwtArrayData(QVector<double>(values.size(), 0.0), values));
+			statistics.quantile(0.5);
+			statistics.quantile(0.9);
+			statistics.invalidate();
+			CPPUNIT_ASSERT(!statistics.isValid());
+
+			// ranks selected before must not survive an update with other values
+			values = randomValues(1500, 100000);
+			statistics.update(QwtArrayData(QVector<double>(values.size(), 0.0), values));
+			QVector<double> sorted = values;
+			std::sort(sorted.begin(), sorted.end());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(sortedQuantile(sorted, 0.5), statistics.quantile(0.5), 1e-9);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(sortedQuantile(sorted, 0.9), statistics.quantile(0.9), 1e-9);
+			CPPUNIT_ASSERT_EQUAL(sorted.first(), statistics.minimum());
+			CPPUNIT_ASSERT_EQUAL(sorted.last(), statistics.maximum());
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( BoxStatisticsTest );
+
@@ -0,0 +1,226 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "assertion_traits.h"
+
+#include "Project.h"
+#include "Column.h"
+#include "ColumnQwtData.h"
+
+#include <QVector>
+#include <QStringList>
+
+class ColumnQwtDataTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(ColumnQwtDataTest);
+		CPPUNIT_TEST(testContiguous);
+		CPPUNIT_TEST(testInvalidRows);
+		CPPUNIT_TEST(testTextAndTransposed);
+		CPPUNIT_TEST(testAppend);
+		CPPUNIT_TEST(testValidityChange);
+		CPPUNIT_TEST(testUnchangedPoints);
+		CPPUNIT_TEST(testDestroyedColumn);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void setUp()
+		{
+			prj = new Project();
+			QVector<double> x_values, y_values;
+			for (int i=0; i<100; i++) {
+				x_values << i * 0.5;
+				y_values << i * i;
+			}
+			x = new Column("x", x_values);
+			y = new Column("y", y_values);
+			prj->addChild(x);
+			prj->addChild(y);
+		}
+
+		void tearDown()
+		{
+			delete prj;
+		}
+
+	private:
+		Project *prj;
+		Column *x, *y;
+
+		void checkPoints(const ColumnQwtData& data, const QList<int>& rows)
+		{
+			CPPUNIT_ASSERT_EQUAL(rows.size(), (int)data.size());
+			for (int i=0; i<rows.size(); i++) {
+				CPPUNIT_ASSERT_EQUAL(rows.at(i), data.row(i));
+				CPPUNIT_ASSERT_EQUAL(x->valueAt(rows.at(i)), data.x(i));
+				CPPUNIT_ASSERT_EQUAL(y->valueAt(rows.at(i)), data.y(i));
+			}
+		}
+
+		QList<int> range(int first, int last)
+		{
+			QList<int> result;
+			for (int i=first; i<=last; i++)
+				result << i;
+			return result;
+		}
+
+	public:
+		void testContiguous()
+		{
+			ColumnQwtData all(x, y, 0, 1000);
+			checkPoints(all, range(0, 99));
+			ColumnQwtData part(x, y, 10, 19);
+			checkPoints(part, range(10, 19));
+			ColumnQwtData none(x, y, 200, 300);
+			CPPUNIT_ASSERT_EQUAL(0, (int)none.size());
+		}
+
+		void testInvalidRows()
+		{
+			x->setInvalid(Interval<int>(5, 7));
+			y->setInvalid(20);
+			ColumnQwtData data(x, y, 0, 29);
+			QList<int> rows = range(0, 4) + range(8, 19) + range(21, 29);
+			checkPoints(data, rows);
+
+			// invalid rows at the start only shift the block
+			ColumnQwtData shifted(x, y, 5, 15);
+			checkPoints(shifted, range(8, 15));
+
+			// the filter column drops rows, too
+			Column *filter = new Column("filter", QVector<double>(100, 1.0));
+			prj->addChild(filter);
+			filter->setInvalid(25);
+			ColumnQwtData filtered(x, y, 21, 29, filter);
+			checkPoints(filtered, range(21, 24) + range(26, 29));
+		}
+
+		void testTextAndTransposed()
+		{
+			QStringList labels;
+			labels << "a" << "b" << "c";
+			Column *text = new Column("text", labels);
+			prj->addChild(text);
+			ColumnQwtData data(text, y, 0, 99);
+			CPPUNIT_ASSERT_EQUAL(3, (int)data.size());
+			CPPUNIT_ASSERT_EQUAL(1.0, data.x(0));
+			CPPUNIT_ASSERT_EQUAL(3.0, data.x(2));
+			CPPUNIT_ASSERT_EQUAL(4.0, data.y(2));
+
+			ColumnQwtData transposed(x, y, 0, 99);
+			transposed.setTransposed(true);
+			CPPUNIT_ASSERT_EQUAL(y->valueAt(7), transposed.x(7));
+			CPPUNIT_ASSERT_EQUAL(x->valueAt(7), transposed.y(7));
+		}
+
+		void testAppend()
+		{
+			y->setInvalid(50);
+			ColumnQwtData data(x, y, 0, 1000);
+			checkPoints(data, range(0, 49) + range(51, 99));
+			CPPUNIT_ASSERT(data.refersTo(x, y, 0, 1000));
+			CPPUNIT_ASSERT(!data.refersTo(x, y, 1, 1000));
+			CPPUNIT_ASSERT(!data.refersTo(y, x, 0, 1000));
+
+			// valid rows appended
+			for (int i=100; i<110; i++) {
+				x->setValueAt(i, i * 0.5);
+				y->setValueAt(i, i * i);
+			}
+			CPPUNIT_ASSERT(data.update());
+			checkPoints(data, range(0, 49) + range(51, 109));
+
+			// invalid rows appended
+			for (int i=110; i<120; i++) {
+				x->setValueAt(i, i * 0.5);
+				y->setValueAt(i, i * i);
+			}
+			x->setInvalid(Interval<int>(112, 113));
+			CPPUNIT_ASSERT(data.update());
+			checkPoints(data, range(0, 49) + range(51, 111) + range(114, 119));
+
+			// a contiguous view stays contiguous
+			ColumnQwtData tail(x, y, 60, 1000);
+			x->setInvalid(Interval<int>(112, 113), false);
+			tail.update();
+			checkPoints(tail, range(60, 119));
+			x->setValueAt(120, 60.0);
+			y->setValueAt(120, 14400.0);
+			tail.update();
+			checkPoints(tail, range(60, 120));
+
+			// rows removed
+			x->removeRows(115, 6);
+			CPPUNIT_ASSERT(tail.update());
+			checkPoints(tail, range(60, 114));
+		}
+
+		void testValidityChange()
+		{
+			ColumnQwtData data(x, y, 0, 99);
+			checkPoints(data, range(0, 99));
+			y->setInvalid(Interval<int>(10, 19));
+			data.update();
+			checkPoints(data, range(0, 9) + range(20, 99));
+			y->setInvalid(Interval<int>(10, 19), false);
+			data.update();
+			checkPoints(data, range(0, 99));
+		}
+
+		void testUnchangedPoints()
+		{
+			y->setInvalid(5);
+			ColumnQwtData data(x, y, 0, 1000);
+			CPPUNIT_ASSERT_EQUAL(99, (int)data.size());
+
+			// nothing changed
+			data.update();
+			CPPUNIT_ASSERT_EQUAL(99, (int)data.unchangedPoints());
+
+			// appended rows leave all old points alone
+			x->setValueAt(100, 50.0);
+			y->setValueAt(100, 10000.0);
+			data.update();
+			CPPUNIT_ASSERT_EQUAL(100, (int)data.size());
+			CPPUNIT_ASSERT_EQUAL(99, (int)data.unchangedPoints());
+
+			// a changed value keeps the points before it (row 5 is not among them)
+			y->setValueAt(40, -1.0);
+			data.update();
+			CPPUNIT_ASSERT_EQUAL(39, (int)data.unchangedPoints());
+			CPPUNIT_ASSERT_EQUAL(-1.0, data.y(39));
+			x->replaceValues(2, QVector<double>(2, 1.0));
+			y->setValueAt(60, -2.0);
+			data.update();
+			CPPUNIT_ASSERT_EQUAL(2, (int)data.unchangedPoints());
+
+			// a validity change rebuilds everything
+			y->setInvalid(5, false);
+			data.update();
+			CPPUNIT_ASSERT_EQUAL(101, (int)data.size());
+			CPPUNIT_ASSERT_EQUAL(0, (int)data.unchangedPoints());
+
+			// a view of rows further down does not care about changes before them
+			ColumnQwtData tail(x, y, 50, 1000);
+			y->setValueAt(10, 3.0);
+			tail.update();
+			CPPUNIT_ASSERT_EQUAL(51, (int)tail.unchangedPoints());
+		}
+
+		void testDestroyedColumn()
+		{
+			// not part of the project, so nothing else refers to it
+			Column *z = new Column("z", QVector<double>(100, 2.0));
+			ColumnQwtData data(x, z, 0, 99);
+			QwtData *copy = data.copy();
+			CPPUNIT_ASSERT_EQUAL(100, (int)copy->size());
+			CPPUNIT_ASSERT_EQUAL(2.0, copy->y(99));
+			delete z;
+			CPPUNIT_ASSERT_EQUAL(0, (int)data.size());
+			CPPUNIT_ASSERT_EQUAL(0, (int)copy->size());
+			CPPUNIT_ASSERT(!data.update());
+			QwtData *late_copy = data.copy();
+			CPPUNIT_ASSERT_EQUAL(0, (int)late_copy->size());
+			delete late_copy;
+			delete copy;
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ColumnQwtDataTest );
@@ -0,0 +1,228 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "CurveDecimation.h"
+
+#include <qwt_data.h>
+#include <qwt_scale_map.h>
+#include <QVector>
+#include <QPolygon>
+#include <QtAlgorithms>
+
+#include <math.h>
+
+//! QwtData on two vectors which counts how often points are read
+class CountingData : public QwtData
+{
+	public:
+		CountingData(const QVector<double> &x, const QVector<double> &y) : m_x(x), m_y(y), m_reads(0) {}
+		virtual QwtData *copy() const { return new CountingData(m_x, m_y); }
+		virtual size_t size() const { return m_x.size(); }
+		virtual double x(size_t i) const { m_reads++; return m_x.at(i); }
+		virtual double y(size_t i) const { return m_y.at(i); }
+		int reads() const { return m_reads; }
+
+	private:
+		QVector<double> m_x, m_y;
+		mutable int m_reads;
+};
+
+class CurveDecimationTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(CurveDecimationTest);
+		CPPUNIT_TEST(testBruteForce);
+		CPPUNIT_TEST(testAppend);
+		CPPUNIT_TEST(testChangedPrefix);
+		CPPUNIT_TEST(testInvalidData);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		QVector<double> x, y;
+		QwtScaleMap x_map, y_map;
+		unsigned int seed;
+
+		double random() {
+			seed = seed * 1103515245u + 12345u;
+			return ((seed >> 8) & 0xffff) / 65536.0;
+		}
+
+		//! Append a random walk with non-decreasing X (some points share their X value)
+		void extend(int count)
+		{
+			for (int i=0; i<count; i++) {
+				double last_x = x.isEmpty() ? 0.0 : x.last(), last_y = y.isEmpty() ? 0.0 : y.last();
+				x << last_x + (random() < 0.1 ? 0.0 : random()*0.002);
+				y << last_y + random() - 0.5;
+			}
+		}
+
+		//! M4 polyline computed point by point, for the points chosen by CurveDecimation::polyline()
+		QPolygon bruteForce(int from, int to)
+		{
+			if (to < 0 || to >= x.size())
+				to = x.size() - 1;
+			double x1 = qMin(x_map.s1(), x_map.s2()), x2 = qMax(x_map.s1(), x_map.s2());
+			int first = qMax(from, int(qLowerBound(x.constBegin(), x.constEnd(), x1) - x.constBegin()) - 1);
+			int last = qMin(to, int(qUpperBound(x.constBegin(), x.constEnd(), x2) - x.constBegin()));
+			QPolygon result;
+			int i = first;
+			while (i <= last) {
+				int px = x_map.transform(x.at(i));
+				double min = y.at(i), max = y.at(i);
+				int j = i;
+				while (j+1 <= last && x_map.transform(x.at(j+1)) == px) {
+					j++;
+					min = qMin(min, y.at(j));
+					max = qMax(max, y.at(j));
+				}
+				result << QPoint(px, y_map.transform(y.at(i)));
+				if (j > i)
+					result << QPoint(px, y_map.transform(min)) << QPoint(px, y_map.transform(max))
+						<< QPoint(px, y_map.transform(y.at(j)));
+				i = j + 1;
+			}
+			return result;
+		}
+
+		void checkPolyline(const CurveDecimation &decimation, int from = 0, int to = -1)
+		{
+			QPolygon expected = bruteForce(from, to);
+			QPolygon actual = decimation.polyline(x_map, y_map, from, to);
+			CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+			for (int i=0; i<expected.size(); i++)
+				CPPUNIT_ASSERT(expected.at(i) == actual.at(i));
+		}
+
+		void checkViews(const CurveDecimation &decimation)
+		{
+			double end = x.last();
+			x_map.setScaleInterval(0.0, end);
+			checkPolyline(decimation);
+			checkPolyline(decimation, 1000, 7000);
+			// zoomed in, with parts of the curve left and right of the canvas
+			x_map.setScaleInterval(end*0.3, end*0.35);
+			checkPolyline(decimation);
+			// inverted axis
+			x_map.setScaleInterval(end*0.8, end*0.1);
+			checkPolyline(decimation);
+		}
+
+	public:
+		void setUp()
+		{
+			seed = 4711;
+			x.clear();
+			y.clear();
+			x_map.setPaintInterval(0, 299);
+			y_map.setPaintInterval(400, 0);
+			y_map.setScaleInterval(-100.0, 100.0);
+		}
+
+		void testBruteForce()
+		{
+			extend(20000);
+			CurveDecimation decimation;
+			CPPUNIT_ASSERT(decimation.needsUpdate(CountingData(x, y)));
+			CPPUNIT_ASSERT(decimation.update(CountingData(x, y)));
+			CPPUNIT_ASSERT(decimation.isValid());
+			CPPUNIT_ASSERT_EQUAL(20000, decimation.size());
+			CPPUNIT_ASSERT(!decimation.needsUpdate(CountingData(x, y)));
+			checkViews(decimation);
+			x_map.setScaleInterval(0.0, x.last());
+			CPPUNIT_ASSERT_EQUAL(20000, decimation.visiblePoints(x_map, 0, -1));
+			CPPUNIT_ASSERT(decimation.polyline(x_map, y_map, 0, -1).size() <= 4*300);
+		}
+
+		void testAppend()
+		{
+			extend(10000);
+			CurveDecimation decimation;
+			decimation.update(CountingData(x, y));
+
+			// only the appended points are read
+			for (int step=0; step<5; step++) {
+				int old_size = x.size();
+				extend(1000 + 37*step);
+				decimation.invalidate(old_size);
+				CPPUNIT_ASSERT(decimation.needsUpdate(CountingData(x, y)));
+				CountingData data(x, y);
+				CPPUNIT_ASSERT(decimation.update(data));
+				CPPUNIT_ASSERT_EQUAL(x.size() - old_size, data.reads());
+				CPPUNIT_ASSERT_EQUAL(x.size(), decimation.size());
+				checkViews(decimation);
+			}
+
+			// the same result as decimating everything at once
+			CurveDecimation fresh;
+			fresh.update(CountingData(x, y));
+			x_map.setScaleInterval(0.0, x.last());
+			CPPUNIT_ASSERT(fresh.polyline(x_map, y_map, 0, -1) == decimation.polyline(x_map, y_map, 0, -1));
+
+			// without invalidate(), a size change re-reads everything
+			int old_size = x.size();
+			extend(10);
+			CountingData data(x, y);
+			CPPUNIT_ASSERT(decimation.needsUpdate(data));
+			decimation.update(data);
+			CPPUNIT_ASSERT_EQUAL(old_size + 10, data.reads());
+			checkViews(decimation);
+		}
+
+		void testChangedPrefix()
+		{
+			extend(12000);
+			CurveDecimation decimation;
+			decimation.update(CountingData(x, y));
+
+			// a change in the middle: the points before it are kept
+			for (int i=5000; i<12000; i++)
+				y[i] += 3.0;
+			y[5000] = 90.0;
+			decimation.invalidate(5000);
+			CountingData data(x, y);
+			decimation.update(data);
+			CPPUNIT_ASSERT_EQUAL(7000, data.reads());
+			checkViews(decimation);
+
+			// several invalidations before an update: the smallest one counts
+			y[100] = -90.0;
+			decimation.invalidate(100);
+			decimation.invalidate(11000);
+			CountingData again(x, y);
+			decimation.update(again);
+			CPPUNIT_ASSERT_EQUAL(11900, again.reads());
+			checkViews(decimation);
+
+			// shrinking data
+			x.resize(3001);
+			y.resize(3001);
+			decimation.invalidate(3001);
+			CountingData shorter(x, y);
+			decimation.update(shorter);
+			CPPUNIT_ASSERT_EQUAL(0, shorter.reads());
+			CPPUNIT_ASSERT_EQUAL(3001, decimation.size());
+			checkViews(decimation);
+		}
+
+		void testInvalidData()
+		{
+			extend(1000);
+			CurveDecimation decimation;
+			QVector<double> decreasing = x;
+			decreasing[500] = -1.0;
+			CPPUNIT_ASSERT(!decimation.update(CountingData(decreasing, y)));
+			CPPUNIT_ASSERT(!decimation.isValid());
+			QVector<double> nan = y;
+			nan[10] = NAN;
+			CPPUNIT_ASSERT(!decimation.update(CountingData(x, nan)));
+			CPPUNIT_ASSERT(!decimation.isValid());
+
+			// an invalid state is never kept
+			CPPUNIT_ASSERT(decimation.update(CountingData(x, y)));
+			decimation.invalidate(1000);
+			CountingData data(x, y);
+			CPPUNIT_ASSERT(decimation.update(data));
+			CPPUNIT_ASSERT_EQUAL(0, data.reads());
+			checkViews(decimation);
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CurveDecimationTest );
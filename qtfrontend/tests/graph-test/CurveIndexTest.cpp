@@ -0,0 +1,182 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "CurveIndex.h"
+
+#include <qwt_data.h>
+#include <qwt_scale_map.h>
+#include <QVector>
+
+#include <math.h>
+
+//! QwtData on two vectors
+class VectorData : public QwtData
+{
+	public:
+		VectorData(const QVector<double> &x, const QVector<double> &y) : m_x(x), m_y(y) {}
+		virtual QwtData *copy() const { return new VectorData(m_x, m_y); }
+		virtual size_t size() const { return m_x.size(); }
+		virtual double x(size_t i) const { return m_x.at(i); }
+		virtual double y(size_t i) const { return m_y.at(i); }
+
+	private:
+		QVector<double> m_x, m_y;
+};
+
+class CurveIndexTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(CurveIndexTest);
+		CPPUNIT_TEST(testRandomPoints);
+		CPPUNIT_TEST(testDegenerate);
+		CPPUNIT_TEST(testUpdate);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		QwtScaleMap x_map, y_map;
+		unsigned int seed;
+
+		double random() {
+			seed = seed * 1103515245u + 12345u;
+			return ((seed >> 8) & 0xffff) / 65536.0;
+		}
+
+		//! Closest point by looking at every point, as closestPoint() should find it
+		int linearScan(const QwtData &data, int xpos, int ypos, double *dist2)
+		{
+			int result = -1;
+			for (size_t i=0; i<data.size(); i++) {
+				double dx = x_map.xTransform(data.x(i)) - xpos, dy = y_map.xTransform(data.y(i)) - ypos;
+				double d = dx*dx + dy*dy;
+				if (d == d && d < *dist2) {
+					*dist2 = d;
+					result = i;
+				}
+			}
+			return result;
+		}
+
+		//! Compare closestPoint() with linearScan() on a grid of mouse positions (some off the canvas)
+		void checkQueries(const CurveIndex &index, const QwtData &data)
+		{
+			double limits[] = {1e300, 400.0, 9.0, 0.25};
+			for (int xpos=-150; xpos<=650; xpos+=23)
+				for (int ypos=-100; ypos<=500; ypos+=19)
+					for (unsigned l=0; l<sizeof(limits)/sizeof(double); l++) {
+						double expected_dist = limits[l], dist = limits[l];
+						int expected = linearScan(data, xpos, ypos, &expected_dist);
+						int point = index.closestPoint(data, x_map, y_map, xpos, ypos, &dist);
+						CPPUNIT_ASSERT_EQUAL(expected < 0, point < 0);
+						if (expected < 0)
+							continue;
+						// several points may be equally close
+						CPPUNIT_ASSERT_DOUBLES_EQUAL(expected_dist, dist, 1e-9);
+						double dx = x_map.xTransform(data.x(point)) - xpos, dy = y_map.xTransform(data.y(point)) - ypos;
+						CPPUNIT_ASSERT_DOUBLES_EQUAL(dist, dx*dx + dy*dy, 1e-9);
+					}
+		}
+
+	public:
+		void setUp()
+		{
+			seed = 1234;
+			x_map.setPaintInterval(0, 499);
+			x_map.setScaleInterval(-10.0, 10.0);
+			// inverted, as for the y axis of a plot
+			y_map.setPaintInterval(399, 0);
+			y_map.setScaleInterval(0.0, 1000.0);
+		}
+
+		void testRandomPoints()
+		{
+			QVector<double> x, y;
+			for (int i=0; i<5000; i++) {
+				// a dense cluster, a sparse background and points beyond the visible range
+				if (i % 3 == 0) {
+					x << random()*0.5 + 2.0;
+					y << random()*20.0 + 500.0;
+				} else {
+					x << random()*40.0 - 20.0;
+					y << random()*2000.0 - 500.0;
+				}
+			}
+			// duplicates and values which are never found
+			x[10] = x[11];
+			y[10] = y[11];
+			x[20] = NAN;
+			y[21] = HUGE_VAL;
+			VectorData data(x, y);
+			CurveIndex index;
+			CPPUNIT_ASSERT(index.needsUpdate(data));
+			index.update(data);
+			CPPUNIT_ASSERT(!index.needsUpdate(data));
+			checkQueries(index, data);
+
+			// zoomed in
+			x_map.setScaleInterval(1.9, 2.3);
+			y_map.setScaleInterval(495.0, 530.0);
+			checkQueries(index, data);
+		}
+
+		void testDegenerate()
+		{
+			CurveIndex index;
+			double dist = 1e300;
+			VectorData empty((QVector<double>()), QVector<double>());
+			index.update(empty);
+			CPPUNIT_ASSERT_EQUAL(-1, index.closestPoint(empty, x_map, y_map, 10, 10, &dist));
+
+			// all points on a horizontal line, a vertical line, and in one spot
+			QVector<double> x, y;
+			for (int i=0; i<200; i++) {
+				x << i*0.1 - 10.0;
+				y << 300.0;
+			}
+			VectorData horizontal(x, y), vertical(y, x);
+			index.update(horizontal);
+			checkQueries(index, horizontal);
+			x_map.setScaleInterval(0.0, 1000.0);
+			y_map.setScaleInterval(-10.0, 10.0);
+			index.update(vertical);
+			checkQueries(index, vertical);
+
+			VectorData spot(QVector<double>(50, 1.0), QVector<double>(50, 2.0));
+			index.update(spot);
+			checkQueries(index, spot);
+
+			// no finite points at all
+			VectorData nan(QVector<double>(10, NAN), QVector<double>(10, 1.0));
+			index.update(nan);
+			dist = 1e300;
+			CPPUNIT_ASSERT_EQUAL(-1, index.closestPoint(nan, x_map, y_map, 10, 10, &dist));
+		}
+
+		void testUpdate()
+		{
+			QVector<double> x, y;
+			for (int i=0; i<100; i++) {
+				x << random()*20.0 - 10.0;
+				y << random()*1000.0;
+			}
+			CurveIndex index;
+			VectorData data(x, y);
+			index.update(data);
+
+			// a size change is noticed without invalidate()
+			x << 0.0;
+			y << 500.0;
+			VectorData more(x, y);
+			CPPUNIT_ASSERT(index.needsUpdate(more));
+			index.update(more);
+			checkQueries(index, more);
+
+			// other changes have to be reported
+			x[0] = 0.01;
+			y[0] = 501.0;
+			VectorData moved(x, y);
+			CPPUNIT_ASSERT(!index.needsUpdate(moved));
+			index.invalidate();
+			CPPUNIT_ASSERT(index.needsUpdate(moved));
+			index.update(moved);
+			checkQueries(index, moved);
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( CurveIndexTest );
@@ -0,0 +1,178 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "FunctionMesh.h"
+
+#include <QVector>
+
+#include <math.h>
+
+class FunctionMeshTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(FunctionMeshTest);
+		CPPUNIT_TEST(testPlane);
+		CPPUNIT_TEST(testRefinedValues);
+		CPPUNIT_TEST(testRefinedLines);
+		CPPUNIT_TEST(testCache);
+		CPPUNIT_TEST(testInvalidFormula);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		static double peak(double x, double y)
+		{
+			return exp(-50*(x*x + y*y));
+		}
+
+		static void setPeak(FunctionMesh &mesh, int levels)
+		{
+			mesh.setFormula("exp(-50*(x^2+y^2))");
+			mesh.setDomain(-1, 1, -1, 1);
+			mesh.setMesh(11, 11);
+			mesh.setZRange(0, 1);
+			mesh.setRefinement(levels);
+		}
+
+		static void checkSorted(const QVector<double> &lines)
+		{
+			for (int i=1; i<lines.size(); i++)
+				CPPUNIT_ASSERT(lines.at(i-1) < lines.at(i));
+		}
+
+		//! Whether 'lines' contains 'value' (up to rounding)
+		static bool containsLine(const QVector<double> &lines, double value)
+		{
+			foreach(double line, lines)
+				if (fabs(line - value) < 1e-12)
+					return true;
+			return false;
+		}
+
+		//! Smallest distance between neighbouring lines
+		static double minSpacing(const QVector<double> &lines)
+		{
+			double result = HUGE_VAL;
+			for (int i=1; i<lines.size(); i++)
+				result = qMin(result, lines.at(i) - lines.at(i-1));
+			return result;
+		}
+
+	public:
+		void testPlane()
+		{
+			// a plane is never refined
+			FunctionMesh mesh;
+			mesh.setFormula("2*x+3*y");
+			mesh.setDomain(0, 1, -1, 1);
+			mesh.setMesh(5, 3);
+			mesh.setZRange(-3, 5);
+			mesh.setRefinement(4);
+			CPPUNIT_ASSERT(mesh.update());
+			CPPUNIT_ASSERT_EQUAL(5, mesh.xs().size());
+			CPPUNIT_ASSERT_EQUAL(3, mesh.ys().size());
+			CPPUNIT_ASSERT_EQUAL(15, mesh.values().size());
+			CPPUNIT_ASSERT_EQUAL(15, mesh.evaluations());
+			CPPUNIT_ASSERT_EQUAL(0.0, mesh.xs().first());
+			CPPUNIT_ASSERT_EQUAL(1.0, mesh.xs().last());
+			CPPUNIT_ASSERT_EQUAL(-1.0, mesh.ys().first());
+			CPPUNIT_ASSERT_EQUAL(1.0, mesh.ys().last());
+			for (int i=0; i<5; i++)
+				for (int j=0; j<3; j++)
+					CPPUNIT_ASSERT_DOUBLES_EQUAL(2*mesh.xs().at(i) + 3*mesh.ys().at(j),
+							mesh.values().at(i*3 + j), 1e-12);
+		}
+
+		void testRefinedValues()
+		{
+			FunctionMesh mesh;
+			setPeak(mesh, 3);
+			CPPUNIT_ASSERT(mesh.update());
+			const QVector<double> &xs = mesh.xs(), &ys = mesh.ys();
+			CPPUNIT_ASSERT(xs.size() > 11);
+			CPPUNIT_ASSERT(ys.size() > 11);
+			CPPUNIT_ASSERT_EQUAL(xs.size() * ys.size(), mesh.values().size());
+			// every node is evaluated exactly once, whichever level added it
+			CPPUNIT_ASSERT_EQUAL(mesh.values().size(), mesh.evaluations());
+			// the merged values belong to the nodes they are stored for
+			for (int i=0; i<xs.size(); i++)
+				for (int j=0; j<ys.size(); j++)
+					CPPUNIT_ASSERT_DOUBLES_EQUAL(peak(xs.at(i), ys.at(j)),
+							mesh.values().at(i*ys.size() + j), 1e-12);
+		}
+
+		void testRefinedLines()
+		{
+			FunctionMesh mesh;
+			setPeak(mesh, 3);
+			CPPUNIT_ASSERT(mesh.update());
+			const QVector<double> &xs = mesh.xs(), &ys = mesh.ys();
+			checkSorted(xs);
+			checkSorted(ys);
+			// the initial lines are kept
+			for (int i=0; i<11; i++) {
+				CPPUNIT_ASSERT(containsLine(xs, -1 + i*0.2));
+				CPPUNIT_ASSERT(containsLine(ys, -1 + i*0.2));
+			}
+			// the peak gets all three levels, the flat border none
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2/8, minSpacing(xs), 1e-12);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2/8, minSpacing(ys), 1e-12);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, xs.at(1) - xs.at(0), 1e-12);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, xs.last() - xs.at(xs.size()-2), 1e-12);
+			// the function is symmetric, so is the mesh
+			CPPUNIT_ASSERT(xs == ys);
+			for (int i=0; i<xs.size(); i++)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(-xs.at(i), xs.at(xs.size()-1-i), 1e-12);
+
+			// one more level only adds lines
+			FunctionMesh finer;
+			setPeak(finer, 4);
+			CPPUNIT_ASSERT(finer.update());
+			CPPUNIT_ASSERT(finer.xs().size() > xs.size());
+			foreach(double x, xs)
+				CPPUNIT_ASSERT(containsLine(finer.xs(), x));
+		}
+
+		void testCache()
+		{
+			FunctionMesh mesh;
+			setPeak(mesh, 2);
+			CPPUNIT_ASSERT(mesh.update());
+			int evaluations = mesh.evaluations();
+			CPPUNIT_ASSERT(mesh.update());
+			CPPUNIT_ASSERT_EQUAL(evaluations, mesh.evaluations());
+
+			// the z range only affects the next evaluation
+			mesh.setZRange(0, 2);
+			mesh.setMesh(11, 11);
+			mesh.setRefinement(2);
+			CPPUNIT_ASSERT(mesh.update());
+			CPPUNIT_ASSERT_EQUAL(evaluations, mesh.evaluations());
+
+			mesh.setDomain(-2, 2, -1, 1);
+			CPPUNIT_ASSERT(mesh.update());
+			CPPUNIT_ASSERT(mesh.evaluations() > evaluations);
+			CPPUNIT_ASSERT_EQUAL(-2.0, mesh.xs().first());
+			CPPUNIT_ASSERT_EQUAL(2.0, mesh.xs().last());
+
+			evaluations = mesh.evaluations();
+			mesh.setRefinement(0);
+			CPPUNIT_ASSERT(mesh.update());
+			CPPUNIT_ASSERT_EQUAL(evaluations + 121, mesh.evaluations());
+			CPPUNIT_ASSERT_EQUAL(11, mesh.xs().size());
+		}
+
+		void testInvalidFormula()
+		{
+			FunctionMesh mesh;
+			mesh.setFormula("x+");
+			mesh.setDomain(0, 1, 0, 1);
+			mesh.setMesh(4, 4);
+			CPPUNIT_ASSERT(!mesh.update());
+			CPPUNIT_ASSERT(!mesh.error().isEmpty());
+			CPPUNIT_ASSERT_EQUAL(0, mesh.evaluations());
+
+			mesh.setFormula("2*x+3*y");
+			CPPUNIT_ASSERT(mesh.update());
+			CPPUNIT_ASSERT(mesh.error().isEmpty());
+			CPPUNIT_ASSERT_EQUAL(16, mesh.values().size());
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( FunctionMeshTest );
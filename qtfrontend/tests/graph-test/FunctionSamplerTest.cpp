@@ -0,0 +1,309 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "FunctionSampler.h"
+
+#include <QVector>
+#include <QStringList>
+
+#include <math.h>
+
+class FunctionSamplerTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(FunctionSamplerTest);
+		CPPUNIT_TEST(testUniform);
+		CPPUNIT_TEST(testCacheKey);
+		CPPUNIT_TEST(testInvalidFormula);
+		CPPUNIT_TEST(testAccuracy);
+		CPPUNIT_TEST(testDomainEdges);
+		CPPUNIT_TEST(testZoom);
+		CPPUNIT_TEST(testVisibleRange);
+		CPPUNIT_TEST(testLogarithmic);
+		CPPUNIT_TEST(testPolar);
+		CPPUNIT_TEST(testSampleLimit);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		static void setNormal(FunctionSampler &sampler, const QString &formula, double from, double to,
+				int points)
+		{
+			sampler.setFunction(FunctionSampler::Normal, "x", QStringList() << formula, from, to, points);
+		}
+
+		static void checkSorted(const FunctionSampler &sampler)
+		{
+			for (int i=1; i<sampler.size(); i++)
+				CPPUNIT_ASSERT(sampler.t().at(i-1) < sampler.t().at(i));
+		}
+
+		//! Largest distance of sin() from the polyline through the samples within [from, to]
+		/**
+		 * Measured perpendicular to the segments, in units of the plot size, which is
+		 * (to - from) wide and 'height' high.
+		 */
+		static double sineDeviation(const FunctionSampler &sampler, double from, double to, double height)
+		{
+			const QVector<double> &x = sampler.x(), &y = sampler.y();
+			double width = to - from;
+			double deviation = 0;
+			int j = 0;
+			for (int k=0; k<=100000; k++) {
+				double t = from + width * k / 100000;
+				while (j + 2 < x.size() && x.at(j+1) < t)
+					j++;
+				double ux = (x.at(j+1) - x.at(j)) / width, uy = (y.at(j+1) - y.at(j)) / height;
+				double vx = (t - x.at(j)) / width, vy = (sin(t) - y.at(j)) / height;
+				deviation = qMax(deviation, fabs(ux*vy - uy*vx) / sqrt(ux*ux + uy*uy));
+			}
+			return deviation;
+		}
+
+		//! Width of the segment where the samples of a step function jump from 0 to 1
+		static double jumpWidth(const FunctionSampler &sampler)
+		{
+			for (int i=0; i<sampler.size()-1; i++)
+				if (sampler.y().at(i) != sampler.y().at(i+1))
+					return sampler.x().at(i+1) - sampler.x().at(i);
+			return 0;
+		}
+
+	public:
+		void testUniform()
+		{
+			FunctionSampler sampler;
+			CPPUNIT_ASSERT(!sampler.isValid());
+			CPPUNIT_ASSERT(!sampler.sample());
+
+			// a straight line keeps its initial samples; each midpoint is evaluated once
+			setNormal(sampler, "x", 0, 1, 101);
+			CPPUNIT_ASSERT(sampler.sample());
+			CPPUNIT_ASSERT(sampler.isValid());
+			CPPUNIT_ASSERT_EQUAL(101, sampler.size());
+			CPPUNIT_ASSERT_EQUAL(101 + 100, sampler.evaluations());
+			for (int i=0; i<101; i++) {
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(i / 100.0, sampler.x().at(i), 1e-15);
+				CPPUNIT_ASSERT_EQUAL(sampler.x().at(i), sampler.y().at(i));
+			}
+			CPPUNIT_ASSERT_EQUAL(0.0, sampler.t().first());
+			CPPUNIT_ASSERT_EQUAL(1.0, sampler.t().last());
+		}
+
+		void testCacheKey()
+		{
+			FunctionSampler sampler;
+			setNormal(sampler, "sin(x)", 0, 10, 50);
+			CPPUNIT_ASSERT(sampler.sample());
+			QString key = sampler.key();
+			QVector<double> y = sampler.y();
+			int evaluations = sampler.evaluations();
+
+			// unchanged settings: nothing is evaluated
+			setNormal(sampler, "sin(x)", 0, 10, 50);
+			sampler.setLogarithmic(false, false);
+			CPPUNIT_ASSERT_EQUAL(key, sampler.key());
+			CPPUNIT_ASSERT(!sampler.sample());
+			CPPUNIT_ASSERT_EQUAL(evaluations, sampler.evaluations());
+			CPPUNIT_ASSERT(y == sampler.y());
+
+			// every setting is part of the key
+			setNormal(sampler, "cos(x)", 0, 10, 50);
+			CPPUNIT_ASSERT(!sampler.isValid());
+			CPPUNIT_ASSERT(sampler.key() != key);
+			CPPUNIT_ASSERT(sampler.sample());
+			CPPUNIT_ASSERT(sampler.evaluations() > evaluations);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, sampler.y().first(), 1e-15);
+
+			QStringList keys;
+			keys << key << sampler.key();
+			setNormal(sampler, "sin(x)", 0, 10.5, 50);
+			keys << sampler.key();
+			setNormal(sampler, "sin(x)", -1, 10, 50);
+			keys << sampler.key();
+			setNormal(sampler, "sin(x)", 0, 10, 51);
+			keys << sampler.key();
+			sampler.setFunction(FunctionSampler::Normal, "t", QStringList() << "sin(x)", 0, 10, 50);
+			keys << sampler.key();
+			sampler.setFunction(FunctionSampler::Parametric, "x", QStringList() << "sin(x)" << "x", 0, 10, 50);
+			keys << sampler.key();
+			setNormal(sampler, "sin(x)", 0, 10, 50);
+			sampler.setLogarithmic(true, false);
+			keys << sampler.key();
+			sampler.setLogarithmic(false, true);
+			keys << sampler.key();
+			for (int i=0; i<keys.size(); i++)
+				for (int j=i+1; j<keys.size(); j++)
+					CPPUNIT_ASSERT(keys.at(i) != keys.at(j));
+
+			// back to the first settings
+			sampler.setLogarithmic(false, false);
+			CPPUNIT_ASSERT_EQUAL(key, sampler.key());
+			CPPUNIT_ASSERT(sampler.sample());
+			CPPUNIT_ASSERT(y == sampler.y());
+		}
+
+		void testInvalidFormula()
+		{
+			FunctionSampler sampler;
+			setNormal(sampler, "sin(", 0, 1, 10);
+			CPPUNIT_ASSERT(!sampler.sample());
+			CPPUNIT_ASSERT(!sampler.isValid());
+			CPPUNIT_ASSERT(!sampler.refine(0, 1, 0, 1));
+
+			// fewer than two points
+			setNormal(sampler, "x", 0, 1, 1);
+			CPPUNIT_ASSERT(!sampler.sample());
+			CPPUNIT_ASSERT(!sampler.isValid());
+		}
+
+		void testAccuracy()
+		{
+			FunctionSampler sampler;
+			setNormal(sampler, "sin(x)", 0, 100, 100);
+			CPPUNIT_ASSERT(sampler.sample());
+			checkSorted(sampler);
+			// 100 points alone can't follow 16 periods; the tolerance is 1/1000 of the plot size
+			CPPUNIT_ASSERT(sampler.size() > 200);
+			CPPUNIT_ASSERT(sineDeviation(sampler, 0, 100, 2) < 2e-3);
+			CPPUNIT_ASSERT(sampler.size() < 5000);
+		}
+
+		void testDomainEdges()
+		{
+			FunctionSampler sampler;
+			setNormal(sampler, "sqrt(x)", -1, 1, 10);
+			CPPUNIT_ASSERT(sampler.sample());
+			checkSorted(sampler);
+			int first = 0;
+			while (first < sampler.size() && !(sampler.y().at(first) == sampler.y().at(first)))
+				first++;
+			CPPUNIT_ASSERT(first > 0 && first < sampler.size());
+			// the edge is found to within the smallest segment, a millionth of the range
+			CPPUNIT_ASSERT(sampler.x().at(first) >= 0);
+			CPPUNIT_ASSERT(sampler.x().at(first) < 1e-5);
+			CPPUNIT_ASSERT(sampler.x().at(first-1) > -1e-5);
+		}
+
+		void testZoom()
+		{
+			FunctionSampler sampler;
+			setNormal(sampler, "sin(x)", 0, 100, 20);
+			CPPUNIT_ASSERT(sampler.sample());
+			QVector<double> t = sampler.t(), x = sampler.x(), y = sampler.y();
+
+			// zooming in refines the visible part against the smaller view
+			int evaluations = sampler.evaluations();
+			CPPUNIT_ASSERT(sampler.refine(10.5, 11, -1, -0.8));
+			CPPUNIT_ASSERT(sampler.evaluations() > evaluations);
+			CPPUNIT_ASSERT(sineDeviation(sampler, 10.5, 11, 0.2) < 2e-3);
+			checkSorted(sampler);
+
+			// all previous samples are kept, and the ones outside of the view are unchanged
+			int j = 0;
+			for (int i=0; i<t.size(); i++) {
+				while (sampler.t().at(j) < t.at(i))
+					j++;
+				CPPUNIT_ASSERT_EQUAL(t.at(i), sampler.t().at(j));
+				CPPUNIT_ASSERT_EQUAL(y.at(i), sampler.y().at(j));
+			}
+			int outside = 0, outside_before = 0;
+			for (int i=0; i<sampler.size(); i++)
+				if (sampler.x().at(i) > 20)
+					outside++;
+			for (int i=0; i<x.size(); i++)
+				if (x.at(i) > 20)
+					outside_before++;
+			CPPUNIT_ASSERT_EQUAL(outside_before, outside);
+
+			// the same view again: nothing to do
+			evaluations = sampler.evaluations();
+			CPPUNIT_ASSERT(!sampler.refine(10.5, 11, -1, -0.8));
+			CPPUNIT_ASSERT_EQUAL(evaluations, sampler.evaluations());
+
+			// a view without any part of the curve
+			CPPUNIT_ASSERT(!sampler.refine(200, 300, -1, 1));
+			CPPUNIT_ASSERT_EQUAL(evaluations, sampler.evaluations());
+		}
+
+		void testVisibleRange()
+		{
+			// the smallest segment depends on the visible range, not on the initial spacing
+			FunctionSampler sampler;
+			setNormal(sampler, "x >= 0.3137", 0, 1, 100);
+			CPPUNIT_ASSERT(sampler.sample());
+			double width = jumpWidth(sampler);
+			CPPUNIT_ASSERT(width > 0 && width <= 2.0 / (1 << 20));
+			CPPUNIT_ASSERT(width > 1e-9);
+
+			CPPUNIT_ASSERT(sampler.refine(0.3136, 0.3138, -0.5, 1.5));
+			checkSorted(sampler);
+			width = jumpWidth(sampler);
+			CPPUNIT_ASSERT(width > 0 && width < 1e-9);
+			for (int i=0; i<sampler.size(); i++)
+				CPPUNIT_ASSERT_EQUAL(sampler.x().at(i) >= 0.3137 ? 1.0 : 0.0, sampler.y().at(i));
+
+			// zooming in further goes on, until the segments can't be halved any more
+			for (int k=0; k<6; k++) {
+				int size = sampler.size();
+				if (!sampler.refine(0.3137 - width, 0.3137 + width, -0.5, 1.5))
+					break;
+				CPPUNIT_ASSERT(sampler.size() > size);
+				width = jumpWidth(sampler);
+			}
+			CPPUNIT_ASSERT(width > 0 && width < 1e-15);
+		}
+
+		void testLogarithmic()
+		{
+			// equally spaced on a logarithmic axis
+			FunctionSampler sampler;
+			setNormal(sampler, "x", 1, 1000, 31);
+			sampler.setLogarithmic(true, true);
+			CPPUNIT_ASSERT(sampler.sample());
+			CPPUNIT_ASSERT_EQUAL(31, sampler.size());
+			double expected[] = {1, 10, 100, 1000};
+			for (int i=0; i<4; i++)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], sampler.x().at(10*i), 1e-12 * expected[i]);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, sampler.axisX(100), 1e-15);
+			CPPUNIT_ASSERT(!(sampler.axisY(-1) == sampler.axisY(-1)));
+
+			// on a linear y axis, the line bends
+			sampler.setLogarithmic(true, false);
+			CPPUNIT_ASSERT(sampler.sample());
+			CPPUNIT_ASSERT(sampler.size() > 31);
+			checkSorted(sampler);
+
+			// a range including 0 is sampled linearly
+			setNormal(sampler, "x", 0, 1000, 4);
+			CPPUNIT_ASSERT(sampler.sample());
+			int found = 0;
+			for (int i=0; i<sampler.size(); i++)
+				if (sampler.t().at(i) == 1000.0/3 || sampler.t().at(i) == 2000.0/3)
+					found++;
+			CPPUNIT_ASSERT_EQUAL(2, found);
+		}
+
+		void testPolar()
+		{
+			FunctionSampler sampler;
+			sampler.setFunction(FunctionSampler::Polar, "t", QStringList() << "1" << "t", 0, 2*M_PI, 10);
+			CPPUNIT_ASSERT(sampler.sample());
+			CPPUNIT_ASSERT(sampler.size() > 10);
+			checkSorted(sampler);
+			for (int i=0; i<sampler.size(); i++) {
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, hypot(sampler.x().at(i), sampler.y().at(i)), 1e-12);
+				if (i > 0)
+					CPPUNIT_ASSERT(sampler.t().at(i) - sampler.t().at(i-1) < 0.2);
+			}
+		}
+
+		void testSampleLimit()
+		{
+			FunctionSampler sampler;
+			setNormal(sampler, "sin(1/x)", 1e-4, 1, 100);
+			CPPUNIT_ASSERT(sampler.sample());
+			checkSorted(sampler);
+			CPPUNIT_ASSERT(sampler.size() <= 1 << 16);
+			CPPUNIT_ASSERT(sampler.size() > 1000);
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( FunctionSamplerTest );
+
@@ -0,0 +1,360 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Column.h"
+#include "ScatteredData.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+class ScatteredDataTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(ScatteredDataTest);
+		CPPUNIT_TEST(testSetData);
+		CPPUNIT_TEST(testKnownTriangulations);
+		CPPUNIT_TEST(testRandomTriangulation);
+		CPPUNIT_TEST(testDuplicatePoints);
+		CPPUNIT_TEST(testCollinearPoints);
+		CPPUNIT_TEST(testBinning);
+		CPPUNIT_TEST(testInverseDistance);
+		CPPUNIT_TEST(testNaturalNeighbour);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		QVector<double> xs, ys, zs;
+
+		void addPoint(double x, double y, double z)
+		{
+			xs << x;
+			ys << y;
+			zs << z;
+		}
+
+		void clearPoints()
+		{
+			xs.clear();
+			ys.clear();
+			zs.clear();
+		}
+
+		//! Load the points added with addPoint() through three columns
+		void load(ScatteredData &data)
+		{
+			Column x("x", xs), y("y", ys), z("z", zs);
+			data.setData(&x, &y, &z);
+		}
+
+		static double orientation(const ScatteredData &data, int a, int b, int c)
+		{
+			return (data.x(b) - data.x(a)) * (data.y(c) - data.y(a))
+				- (data.y(b) - data.y(a)) * (data.x(c) - data.x(a));
+		}
+
+		//! Positive if 'p' is inside the circumcircle of the counter-clockwise triangle a, b, c
+		static double inCircle(const ScatteredData &data, int a, int b, int c, int p)
+		{
+			double adx = data.x(a) - data.x(p), ady = data.y(a) - data.y(p);
+			double bdx = data.x(b) - data.x(p), bdy = data.y(b) - data.y(p);
+			double cdx = data.x(c) - data.x(p), cdy = data.y(c) - data.y(p);
+			return (adx*adx + ady*ady) * (bdx*cdy - cdx*bdy)
+				+ (bdx*bdx + bdy*bdy) * (cdx*ady - adx*cdy)
+				+ (cdx*cdx + cdy*cdy) * (adx*bdy - bdx*ady);
+		}
+
+		//! Number of corners of the convex hull (without points in the middle of an edge)
+		static int hullSize(const ScatteredData &data)
+		{
+			QVector<int> order;
+			for (int i=0; i<data.size(); i++)
+				order << i;
+			PointOrder less(data);
+			std::sort(order.begin(), order.end(), less);
+			// Andrew's monotone chain, lower and upper hull
+			QVector<int> hull(2*order.size());
+			int k = 0;
+			for (int i=0; i<order.size(); i++) {
+				while (k >= 2 && orientation(data, hull.at(k-2), hull.at(k-1), order.at(i)) <= 0)
+					k--;
+				hull[k++] = order.at(i);
+			}
+			for (int i=order.size()-2, lower=k+1; i>=0; i--) {
+				while (k >= lower && orientation(data, hull.at(k-2), hull.at(k-1), order.at(i)) <= 0)
+					k--;
+				hull[k++] = order.at(i);
+			}
+			return k - 1;
+		}
+
+		struct PointOrder
+		{
+			PointOrder(const ScatteredData &data) : m_data(data) {}
+			bool operator()(int a, int b) const
+			{
+				return m_data.x(a) < m_data.x(b) || (m_data.x(a) == m_data.x(b) && m_data.y(a) < m_data.y(b));
+			}
+			const ScatteredData &m_data;
+		};
+
+		//! Check orientation, the empty circumcircles and the covered area of a triangulation
+		void checkTriangulation(const ScatteredData &data, const QVector<int> &triangles, double hull_area)
+		{
+			CPPUNIT_ASSERT_EQUAL(0, triangles.size() % 3);
+			double area = 0;
+			for (int t=0; t<triangles.size(); t+=3) {
+				int a = triangles.at(t), b = triangles.at(t+1), c = triangles.at(t+2);
+				CPPUNIT_ASSERT(a >= 0 && a < data.size() && b >= 0 && b < data.size() && c >= 0 && c < data.size());
+				double o = orientation(data, a, b, c);
+				CPPUNIT_ASSERT(o > 0);
+				area += o/2;
+				for (int p=0; p<data.size(); p++)
+					if (p != a && p != b && p != c)
+						CPPUNIT_ASSERT(inCircle(data, a, b, c, p) <= 1e-12);
+			}
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(hull_area, area, 1e-9*hull_area);
+		}
+
+		//! Put the points on some of the nodes of a (size+1) x (size+1) grid over [0,1]^2
+		void gridPoints(int size, int step)
+		{
+			clearPoints();
+			for (int i=0; i<=size; i+=step)
+				for (int j=0; j<=size; j+=step)
+					addPoint(double(i)/size, double(j)/size, (i*7 + j*j) % 11 - 5.0);
+		}
+
+	public:
+		void setUp()
+		{
+			srand(1);
+			clearPoints();
+		}
+
+		void testSetData()
+		{
+			addPoint(1, 1, 1);
+			addPoint(NAN, 2, 2);
+			addPoint(2, 3, INFINITY);
+			addPoint(3, -1, 4);
+			addPoint(0, 2, 0.5);
+			ScatteredData data;
+			load(data);
+			CPPUNIT_ASSERT_EQUAL(3, data.size());
+			CPPUNIT_ASSERT_EQUAL(3.0, data.x(1));
+			CPPUNIT_ASSERT_EQUAL(0.0, data.xMin());
+			CPPUNIT_ASSERT_EQUAL(3.0, data.xMax());
+			CPPUNIT_ASSERT_EQUAL(-1.0, data.yMin());
+			CPPUNIT_ASSERT_EQUAL(2.0, data.yMax());
+			CPPUNIT_ASSERT_EQUAL(4.0, data.zMax());
+
+			// invalid rows are dropped as well
+			Column x("x", xs), y("y", ys), z("z", zs);
+			y.setInvalid(0);
+			data.setData(&x, &y, &z);
+			CPPUNIT_ASSERT_EQUAL(2, data.size());
+
+			data.clip(0, 2, -10, 10, 0, 1);
+			CPPUNIT_ASSERT_EQUAL(1, data.size());
+			CPPUNIT_ASSERT_EQUAL(0.5, data.z(0));
+		}
+
+		void testKnownTriangulations()
+		{
+			ScatteredData data;
+			load(data);
+			CPPUNIT_ASSERT(data.triangulate().isEmpty());
+
+			// a single triangle, given clockwise
+			addPoint(0, 0, 1);
+			addPoint(0, 1, 2);
+			addPoint(1, 0, 3);
+			load(data);
+			QVector<int> triangles = data.triangulate();
+			CPPUNIT_ASSERT_EQUAL(3, triangles.size());
+			checkTriangulation(data, triangles, 0.5);
+
+			// square with its center: four triangles around the center
+			addPoint(1, 1, 4);
+			addPoint(0.5, 0.5, 5);
+			load(data);
+			triangles = data.triangulate();
+			CPPUNIT_ASSERT_EQUAL(12, triangles.size());
+			CPPUNIT_ASSERT_EQUAL(4, (int)std::count(triangles.begin(), triangles.end(), 4));
+			checkTriangulation(data, triangles, 1);
+
+			// a regular grid (with four points on every circumcircle): two triangles per cell
+			gridPoints(12, 1);
+			load(data);
+			triangles = data.triangulate();
+			CPPUNIT_ASSERT_EQUAL(3 * 2*12*12, triangles.size());
+			checkTriangulation(data, triangles, 1);
+		}
+
+		void testRandomTriangulation()
+		{
+			for (int i=0; i<600; i++)
+				addPoint(rand() / (RAND_MAX + 1.0), rand() / (RAND_MAX + 1.0), i);
+			ScatteredData data;
+			load(data);
+			QVector<int> triangles = data.triangulate();
+			// Euler: a triangulation of n points with h on the hull has 2n - 2 - h triangles
+			CPPUNIT_ASSERT_EQUAL(2*data.size() - 2 - hullSize(data), triangles.size()/3);
+
+			double hull_area = 0;
+			for (int t=0; t<triangles.size(); t+=3)
+				hull_area += orientation(data, triangles.at(t), triangles.at(t+1), triangles.at(t+2))/2;
+			checkTriangulation(data, triangles, hull_area);
+
+			// every point is a corner of some triangle
+			QVector<int> used(data.size(), 0);
+			foreach(int p, triangles)
+				used[p]++;
+			CPPUNIT_ASSERT_EQUAL(0, (int)std::count(used.begin(), used.end(), 0));
+
+			// the triangulation doesn't depend on the units of x and y
+			for (int i=0; i<xs.size(); i++) {
+				xs[i] *= 1e6;
+				ys[i] *= 1e-3;
+			}
+			ScatteredData scaled;
+			load(scaled);
+			CPPUNIT_ASSERT_EQUAL(triangles.size(), scaled.triangulate().size());
+		}
+
+		void testDuplicatePoints()
+		{
+			gridPoints(6, 1);
+			int n = xs.size();
+			// repeat some points, with other z values
+			for (int i=0; i<n; i+=3)
+				addPoint(xs.at(i), ys.at(i), 100);
+			ScatteredData data;
+			load(data);
+			QVector<int> triangles = data.triangulate();
+			CPPUNIT_ASSERT_EQUAL(3 * 2*6*6, triangles.size());
+			checkTriangulation(data, triangles, 1);
+			// each location is used once
+			for (int i=0; i<n; i+=3) {
+				int count = std::count(triangles.begin(), triangles.end(), i)
+					+ std::count(triangles.begin(), triangles.end(), n + i/3);
+				CPPUNIT_ASSERT(count > 0);
+				CPPUNIT_ASSERT(std::count(triangles.begin(), triangles.end(), i) == 0
+						|| std::count(triangles.begin(), triangles.end(), n + i/3) == 0);
+			}
+
+			// all points equal
+			clearPoints();
+			for (int i=0; i<5; i++)
+				addPoint(1, 2, i);
+			load(data);
+			CPPUNIT_ASSERT(data.triangulate().isEmpty());
+		}
+
+		void testCollinearPoints()
+		{
+			for (int i=0; i<20; i++)
+				addPoint(i, 2*i + 1, i);
+			ScatteredData data;
+			load(data);
+			CPPUNIT_ASSERT(data.triangulate().isEmpty());
+
+			// one point beside the line: a fan of 19 triangles
+			addPoint(30, 0, 0);
+			load(data);
+			QVector<int> triangles = data.triangulate();
+			CPPUNIT_ASSERT_EQUAL(3 * 19, triangles.size());
+			CPPUNIT_ASSERT_EQUAL(19, (int)std::count(triangles.begin(), triangles.end(), 20));
+			checkTriangulation(data, triangles, 0.5 * fabs(orientation(data, 0, 19, 20)));
+
+			// collinear points on the hull of a square
+			clearPoints();
+			for (int i=0; i<=10; i++) {
+				addPoint(i, 0, 0);
+				addPoint(i, 10, 0);
+				if (i > 0 && i < 10) {
+					addPoint(0, i, 0);
+					addPoint(10, i, 0);
+				}
+			}
+			addPoint(4.5, 5.5, 1);
+			load(data);
+			triangles = data.triangulate();
+			// 2n - 2 - h with all 40 boundary points on the hull
+			CPPUNIT_ASSERT_EQUAL(3 * (2*41 - 2 - 40), triangles.size());
+			checkTriangulation(data, triangles, 100);
+		}
+
+		void testBinning()
+		{
+			gridPoints(20, 2);
+			// a second point in the cell of node (8,8)
+			addPoint(0.41, 0.39, 20);
+			ScatteredData data;
+			load(data);
+			QVector<double> z = data.resample(ScatteredData::Binning, 21, 21, 0, 1, 0, 1);
+			CPPUNIT_ASSERT_EQUAL(21*21, z.size());
+			for (int p=0; p<xs.size()-1; p++) {
+				int i = int(floor(xs.at(p)*20 + 0.5)), j = int(floor(ys.at(p)*20 + 0.5));
+				double expected = zs.at(p);
+				if (i == 8 && j == 8)
+					expected = (zs.at(p) + 20) / 2;
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, z.at(i*21 + j), 1e-12);
+			}
+			// empty cells take the value of the closest point, here (0,0) or (0,2)
+			CPPUNIT_ASSERT(z.at(0*21 + 1) == zs.at(0) || z.at(0*21 + 1) == zs.at(1));
+			CPPUNIT_ASSERT_EQUAL(20.0, z.at(9*21 + 8));
+
+			CPPUNIT_ASSERT(data.resample(ScatteredData::Binning, 1, 21, 0, 1, 0, 1).isEmpty());
+			ScatteredData empty;
+			CPPUNIT_ASSERT(empty.resample(ScatteredData::Binning, 10, 10, 0, 1, 0, 1).isEmpty());
+		}
+
+		void testInverseDistance()
+		{
+			gridPoints(20, 2);
+			ScatteredData data;
+			load(data);
+			QVector<double> z = data.resample(ScatteredData::InverseDistance, 21, 21, 0, 1, 0, 1);
+			CPPUNIT_ASSERT_EQUAL(21*21, z.size());
+			for (int p=0; p<xs.size(); p++) {
+				int i = int(floor(xs.at(p)*20 + 0.5)), j = int(floor(ys.at(p)*20 + 0.5));
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(zs.at(p), z.at(i*21 + j), 1e-9);
+			}
+			// between the points, the values stay within the range of z
+			foreach(double value, z)
+				CPPUNIT_ASSERT(value >= data.zMin() - 1e-12 && value <= data.zMax() + 1e-12);
+
+			// with one neighbour, every node gets the value of its closest point
+			data.setInverseDistanceNeighbours(1);
+			z = data.resample(ScatteredData::InverseDistance, 11, 11, 0, 1, 0, 1);
+			for (int p=0; p<xs.size(); p++)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(zs.at(p), z.at(int(floor(xs.at(p)*10 + 0.5))*11
+							+ int(floor(ys.at(p)*10 + 0.5))), 1e-9);
+		}
+
+		void testNaturalNeighbour()
+		{
+			gridPoints(20, 4);
+			ScatteredData data;
+			load(data);
+			QVector<double> z = data.resample(ScatteredData::NaturalNeighbour, 21, 21, 0, 1, 0, 1);
+			CPPUNIT_ASSERT_EQUAL(21*21, z.size());
+			for (int p=0; p<xs.size(); p++) {
+				int i = int(floor(xs.at(p)*20 + 0.5)), j = int(floor(ys.at(p)*20 + 0.5));
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(zs.at(p), z.at(i*21 + j), 1e-9);
+			}
+			foreach(double value, z)
+				CPPUNIT_ASSERT(value >= data.zMin() - 1e-12 && value <= data.zMax() + 1e-12);
+
+			// a constant stays constant
+			for (int p=0; p<zs.size(); p++)
+				zs[p] = 3;
+			load(data);
+			z = data.resample(ScatteredData::NaturalNeighbour, 30, 17, 0, 1, 0, 1);
+			foreach(double value, z)
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, value, 1e-12);
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ScatteredDataTest );
+
@@ -0,0 +1,137 @@
+TEMPLATE = app
+TARGET = graph-test
+CONFIG += debug
+QT += xml network
+DEFINES += SUPPRESS_SCRIPTING_INIT
+DEPENDPATH += . .. ../.. ../../lib ../../core ../../core/datatypes ../../core/column ../../core/filters ../../graph ../../graph3D ../../../backend ../../../backend/core ../../../backend/core/column ../../../backend/core/datatypes ../../../backend/core/filters ../../../backend/lib
+INCLUDEPATH += . .. ../.. ../../lib ../../core ../../core/datatypes ../../core/column ../../core/filters ../../graph ../../graph3D ../../../backend ../../../backend/core ../../../backend/core/column ../../../backend/core/datatypes ../../../backend/core/filters ../../../backend/lib
+unix:LIBS += -lcppunit -lmuparser -lgsl -lgslcblas
+# Qwt as in config.pri
+unix:INCLUDEPATH += ../../3rdparty/qwt/src
+unix:LIBS += ../../3rdparty/qwt/lib/libqwt.a
+win32:INCLUDEPATH += c:/qwt-5.0.2/include
+win32:LIBS += c:/qwt-5.0.2/lib/libqwt.a
+
+FORMS += \
+	ProjectConfigPage.ui \
+
+# units used
+HEADERS += \
+			  globals.h \
+			  AbstractAspect.h \
+			  aspectcommands.h \
+			  AspectPrivate.h \
+			  Interval.h \
+			  AbstractColumn.h \
+			  Column.h \
+			  ColumnPrivate.h \
+			  columncommands.h \
+			  IntervalAttribute.h \
+			  ValueSpan.h \
+			  AbstractFilter.h \
+			  AbstractSimpleFilter.h \
+			  SimpleCopyThroughFilter.h \
+			  DateTime2DoubleFilter.h \
+			  DateTime2StringFilter.h \
+			  DayOfWeek2DoubleFilter.h \
+			  Double2DateTimeFilter.h \
+			  Double2DayOfWeekFilter.h \
+			  Double2MonthFilter.h \
+			  Double2StringFilter.h \
+			  Month2DoubleFilter.h \
+			  String2DateTimeFilter.h \
+			  String2DayOfWeekFilter.h \
+			  String2DoubleFilter.h \
+			  String2MonthFilter.h \
+#			  SimpleMappingFilter.h \
+			  Project.h \
+			  Folder.h \
+			  ProjectWindow.h \
+			  AbstractPart.h \
+			  PartMdiView.h \
+			  ProjectExplorer.h \
+			  AspectTreeModel.h \
+			  XmlStreamReader.h \
+			  ProjectArchive.h \
+			  PageCache.h \
+			  PagedDoubleData.h \
+			  UndoPayload.h \
+			  ScriptingEngineManager.h \
+			  ProjectConfigPage.h \
+    		  ConfigPageWidget.h \
+			  ShortcutsDialogModel.h \
+			  RecordShortcutDelegate.h \
+			  ActionManager.h \
+			  ShortcutsDialog.h \
+			  ImportDialog.h \
+			  ExtensibleFileDialog.h \
+			  BoxStatistics.h \
+			  ColumnQwtData.h \
+			  CurveDecimation.h \
+			  CurveIndex.h \
+			  ScatteredData.h \
+			  FunctionMesh.h \
+			  FunctionSampler.h \
+			  MyParser.h \
+			  ParallelFor.h \
+
+
+SOURCES += \
+			  AbstractAspect.cpp \
+			  AspectPrivate.cpp \
+			  globals.cpp \
+			  String2DateTimeFilter.cpp \
+			  AbstractFilter.cpp \
+			  AbstractSimpleFilter.cpp \
+			  AbstractColumn.cpp \
+			  Column.cpp \
+			  ColumnPrivate.cpp \
+			  columncommands.cpp \
+#			  SimpleMappingFilter.cpp \
+			  DateTime2StringFilter.cpp \
+			  Double2StringFilter.cpp \
+			  Project.cpp \
+			  Folder.cpp \
+			  ProjectWindow.cpp \
+			  AbstractPart.cpp \
+			  PartMdiView.cpp \
+			  ProjectExplorer.cpp \
+			  AspectTreeModel.cpp \
+			  XmlStreamReader.cpp \
+			  ProjectArchive.cpp \
+			  PageCache.cpp \
+			  PagedDoubleData.cpp \
+			  UndoPayload.cpp \
+			  ScriptingEngineManager.cpp \
+			  ProjectConfigPage.cpp \
+    		  ConfigPageWidget.cpp \
+			  ShortcutsDialogModel.cpp \
+			  RecordShortcutDelegate.cpp \
+			  ActionManager.cpp \
+			  ShortcutsDialog.cpp \
+			  ImportDialog.cpp \
+			  ExtensibleFileDialog.cpp \
+			  BoxStatistics.cpp \
+			  ColumnQwtData.cpp \
+			  CurveDecimation.cpp \
+			  CurveIndex.cpp \
+			  ScatteredData.cpp \
+			  FunctionMesh.cpp \
+			  FunctionSampler.cpp \
+			  MyParser.cpp \
+
+# test cases
+HEADERS += \
+	assertion_traits.h \
+
+SOURCES += main.cpp \
+	BoxStatisticsTest.cpp \
+	ColumnQwtDataTest.cpp \
+	CurveDecimationTest.cpp \
+	CurveIndexTest.cpp \
+	ScatteredDataTest.cpp \
+	FunctionMeshTest.cpp \
+	FunctionSamplerTest.cpp \
+	
+
+
@@ -0,0 +1,104 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "MatrixKernels.h"
+#include "ParallelFor.h"
+
+#include <QVector>
+
+class MatrixKernelsTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(MatrixKernelsTest);
+		CPPUNIT_TEST(testSquareTranspose);
+		CPPUNIT_TEST(testTranspose);
+		CPPUNIT_TEST(testMirrorColumns);
+		CPPUNIT_TEST(testMirrorRows);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		//! Column-major storage with 'stride' >= 'rows'; padding cells are set to -1
+		QVector<double> filled(int rows, int cols, int stride)
+		{
+			QVector<double> data(cols*stride, -1.0);
+			for (int j=0; j<cols; j++)
+				for (int i=0; i<rows; i++)
+					data[j*stride + i] = value(i, j);
+			return data;
+		}
+
+		static double value(int row, int col) { return row*1000.0 + col; }
+
+		void checkPadding(const QVector<double>& data, int rows, int cols, int stride)
+		{
+			for (int j=0; j<cols; j++)
+				for (int i=rows; i<stride; i++)
+					CPPUNIT_ASSERT_EQUAL(-1.0, data.at(j*stride + i));
+		}
+
+	public:
+		void testSquareTranspose()
+		{
+			// sizes below, at and above a multiple of the block size; strides larger than the size
+			int sizes[] = {1, 5, matrix_block_size, matrix_block_size+1, 3*matrix_block_size-7, 200};
+			for (unsigned s=0; s<sizeof(sizes)/sizeof(int); s++) {
+				int n = sizes[s];
+				int stride = n + 13;
+				int blocks = (n + matrix_block_size - 1)/matrix_block_size;
+				for (int chunk=1; chunk<=blocks; chunk+=2) {
+					QVector<double> data = filled(n, n, stride);
+					parallelFor(0, blocks-1, MatrixSquareTransposeKernel(data.data(), stride, n), chunk);
+					for (int j=0; j<n; j++)
+						for (int i=0; i<n; i++)
+							CPPUNIT_ASSERT_EQUAL(value(j, i), data.at(j*stride + i));
+					checkPadding(data, n, n, stride);
+				}
+			}
+		}
+
+		void testTranspose()
+		{
+			int shapes[][2] = {{1, 7}, {7, 1}, {3, 100}, {100, 3}, {45, 70}, {70, 45}};
+			for (unsigned s=0; s<sizeof(shapes)/sizeof(shapes[0]); s++) {
+				int rows = shapes[s][0], cols = shapes[s][1];
+				int stride = rows + 5;
+				QVector<double> source = filled(rows, cols, stride);
+				QVector<double> dest(rows*cols, -2.0);
+				parallelFor(0, cols-1, MatrixTransposeKernel(source.constData(), stride, rows, dest.data(), cols), 1);
+				// source column j is destination row j
+				for (int j=0; j<cols; j++)
+					for (int i=0; i<rows; i++)
+						CPPUNIT_ASSERT_EQUAL(value(i, j), dest.at(i*cols + j));
+				checkPadding(source, rows, cols, stride);
+			}
+		}
+
+		void testMirrorColumns()
+		{
+			int shapes[][2] = {{1, 1}, {4, 2}, {4, 7}, {9, 8}, {50, 33}};
+			for (unsigned s=0; s<sizeof(shapes)/sizeof(shapes[0]); s++) {
+				int rows = shapes[s][0], cols = shapes[s][1];
+				int stride = rows + 3;
+				QVector<double> data = filled(rows, cols, stride);
+				parallelFor(0, cols/2 - 1, MatrixMirrorColumnsKernel(data.data(), stride, rows, cols), 1);
+				for (int j=0; j<cols; j++)
+					for (int i=0; i<rows; i++)
+						CPPUNIT_ASSERT_EQUAL(value(i, cols-1-j), data.at(j*stride + i));
+				checkPadding(data, rows, cols, stride);
+			}
+		}
+
+		void testMirrorRows()
+		{
+			int shapes[][2] = {{1, 1}, {2, 4}, {7, 4}, {8, 9}, {33, 50}};
+			for (unsigned s=0; s<sizeof(shapes)/sizeof(shapes[0]); s++) {
+				int rows = shapes[s][0], cols = shapes[s][1];
+				int stride = rows + 3;
+				QVector<double> data = filled(rows, cols, stride);
+				parallelFor(0, cols-1, MatrixMirrorRowsKernel(data.data(), stride, rows), 1);
+				for (int j=0; j<cols; j++)
+					for (int i=0; i<rows; i++)
+						CPPUNIT_ASSERT_EQUAL(value(rows-1-i, j), data.at(j*stride + i));
+				checkPadding(data, rows, cols, stride);
+			}
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( MatrixKernelsTest );
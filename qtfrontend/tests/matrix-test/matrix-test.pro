@@ -0,0 +1,17 @@
+TEMPLATE = app
+TARGET = matrix-test
+CONFIG += debug console
+QT -= gui
+DEPENDPATH += . .. ../../../backend ../../../backend/matrix ../../../backend/lib
+INCLUDEPATH += . .. ../../../backend ../../../backend/matrix ../../../backend/lib
+unix:LIBS += -lcppunit
+
+# units used
+HEADERS += \
+			  MatrixKernels.h \
+			  ParallelFor.h \
+
+# test cases
+SOURCES += main.cpp \
+	MatrixKernelsTest.cpp \
+
@@ -0,0 +1,163 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OPJFile.h"
+
+#include <QTemporaryFile>
+#include <QByteArray>
+
+#include <stdlib.h>
+
+class OPJReaderTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(OPJReaderTest);
+		CPPUNIT_TEST(testOpen);
+		CPPUNIT_TEST(testShortRead);
+		CPPUNIT_TEST(testSeek);
+		CPPUNIT_TEST(testLikeStdio);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		QTemporaryFile *m_file;
+		QByteArray m_file_name;
+
+		//! Replace the contents of m_file by 'size' bytes 0, 1, 2, ...
+		void writeFile(int size)
+		{
+			QByteArray data(size, 0);
+			for (int i=0; i<size; i++)
+				data[i] = char(i);
+			m_file->resize(0);
+			m_file->seek(0);
+			m_file->write(data);
+			m_file->flush();
+		}
+
+		const char *fileName() const
+		{
+			return m_file_name.constData();
+		}
+
+	public:
+		void setUp()
+		{
+			m_file = new QTemporaryFile();
+			m_file->open();
+			m_file_name = m_file->fileName().toLocal8Bit();
+			srand(1);
+		}
+
+		void tearDown()
+		{
+			delete m_file;
+		}
+
+		void testOpen()
+		{
+			OPJReader reader;
+			CPPUNIT_ASSERT(!reader.open((m_file_name + ".missing").constData()));
+
+			writeFile(0);
+			CPPUNIT_ASSERT(reader.open(fileName()));
+			char buffer[4];
+			CPPUNIT_ASSERT_EQUAL((size_t)0, reader.read(buffer, 1, 4));
+			CPPUNIT_ASSERT_EQUAL(0L, reader.tell());
+			CPPUNIT_ASSERT_EQUAL(0, reader.seek(0, SEEK_END));
+			CPPUNIT_ASSERT_EQUAL(0L, reader.tell());
+
+			// opening again starts at the beginning
+			writeFile(5);
+			CPPUNIT_ASSERT_EQUAL(0, reader.seek(3, SEEK_SET));
+			CPPUNIT_ASSERT(reader.open(fileName()));
+			CPPUNIT_ASSERT_EQUAL(0L, reader.tell());
+			CPPUNIT_ASSERT_EQUAL((size_t)4, reader.read(buffer, 1, 4));
+			CPPUNIT_ASSERT_EQUAL(3, (int)buffer[3]);
+		}
+
+		void testShortRead()
+		{
+			writeFile(10);
+			OPJReader reader;
+			CPPUNIT_ASSERT(reader.open(fileName()));
+			char buffer[12];
+			memset(buffer, -1, sizeof(buffer));
+
+			// like fread(), only complete elements count, but all bytes are consumed
+			CPPUNIT_ASSERT_EQUAL((size_t)2, reader.read(buffer, 4, 3));
+			CPPUNIT_ASSERT_EQUAL(10L, reader.tell());
+			for (int i=0; i<10; i++)
+				CPPUNIT_ASSERT_EQUAL(i, (int)buffer[i]);
+			CPPUNIT_ASSERT_EQUAL(-1, (int)buffer[10]);
+
+			// nothing left
+			CPPUNIT_ASSERT_EQUAL((size_t)0, reader.read(buffer, 1, 1));
+			CPPUNIT_ASSERT_EQUAL(10L, reader.tell());
+
+			// empty requests don't move
+			CPPUNIT_ASSERT_EQUAL(0, reader.seek(2, SEEK_SET));
+			CPPUNIT_ASSERT_EQUAL((size_t)0, reader.read(buffer, 0, 3));
+			CPPUNIT_ASSERT_EQUAL((size_t)0, reader.read(buffer, 3, 0));
+			CPPUNIT_ASSERT_EQUAL(2L, reader.tell());
+		}
+
+		void testSeek()
+		{
+			writeFile(10);
+			OPJReader reader;
+			CPPUNIT_ASSERT(reader.open(fileName()));
+			char c = 0;
+
+			CPPUNIT_ASSERT_EQUAL(0, reader.seek(-3, SEEK_END));
+			CPPUNIT_ASSERT_EQUAL(7L, reader.tell());
+			CPPUNIT_ASSERT_EQUAL((size_t)1, reader.read(&c, 1, 1));
+			CPPUNIT_ASSERT_EQUAL(7, (int)c);
+
+			CPPUNIT_ASSERT_EQUAL(0, reader.seek(-5, SEEK_CUR));
+			CPPUNIT_ASSERT_EQUAL(3L, reader.tell());
+			CPPUNIT_ASSERT_EQUAL((size_t)1, reader.read(&c, 1, 1));
+			CPPUNIT_ASSERT_EQUAL(3, (int)c);
+
+			// seeking before the start fails and keeps the position
+			CPPUNIT_ASSERT(reader.seek(-5, SEEK_CUR) != 0);
+			CPPUNIT_ASSERT_EQUAL(4L, reader.tell());
+			CPPUNIT_ASSERT(reader.seek(-11, SEEK_END) != 0);
+			CPPUNIT_ASSERT(reader.seek(-1, SEEK_SET) != 0);
+			CPPUNIT_ASSERT_EQUAL(4L, reader.tell());
+
+			// seeking beyond the end is allowed, reading there isn't
+			CPPUNIT_ASSERT_EQUAL(0, reader.seek(5, SEEK_END));
+			CPPUNIT_ASSERT_EQUAL(15L, reader.tell());
+			CPPUNIT_ASSERT_EQUAL((size_t)0, reader.read(&c, 1, 1));
+			CPPUNIT_ASSERT_EQUAL(15L, reader.tell());
+			CPPUNIT_ASSERT_EQUAL(0, reader.seek(-6, SEEK_CUR));
+			CPPUNIT_ASSERT_EQUAL((size_t)1, reader.read(&c, 1, 1));
+			CPPUNIT_ASSERT_EQUAL(9, (int)c);
+		}
+
+		void testLikeStdio()
+		{
+			// random reads and seeks give the same results as on the file itself
+			writeFile(1000);
+			OPJReader reader;
+			CPPUNIT_ASSERT(reader.open(fileName()));
+			FILE *file = fopen(fileName(), "rb");
+			CPPUNIT_ASSERT(file);
+			int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+			for (int k=0; k<10000; k++) {
+				if (rand() % 2) {
+					size_t size = 1 + rand() % 8, count = rand() % 4;
+					char expected[32], actual[32];
+					memset(expected, 0, sizeof(expected));
+					memset(actual, 0, sizeof(actual));
+					CPPUNIT_ASSERT_EQUAL(fread(expected, size, count, file), reader.read(actual, size, count));
+					CPPUNIT_ASSERT(memcmp(expected, actual, sizeof(expected)) == 0);
+				} else {
+					long offset = rand() % 1200 - 100;
+					int w = whence[rand() % 3];
+					CPPUNIT_ASSERT_EQUAL(fseek(file, offset, w) == 0, reader.seek(offset, w) == 0);
+				}
+				CPPUNIT_ASSERT_EQUAL(ftell(file), reader.tell());
+			}
+			fclose(file);
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( OPJReaderTest );
@@ -0,0 +1,96 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "OpjColumnData.h"
+
+#include <QVector>
+#include <QList>
+
+class OpjColumnDataTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(OpjColumnDataTest);
+		CPPUNIT_TEST(testEmptyCell);
+		CPPUNIT_TEST(testNoEmptyCells);
+		CPPUNIT_TEST(testEmptyCells);
+		CPPUNIT_TEST(testMoreCellsThanRows);
+		CPPUNIT_TEST(testNoCells);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		//! The value Origin stores for empty cells
+		static double empty()
+		{
+			return 1e-307;
+		}
+
+		static void checkInterval(const Interval<int> &interval, int start, int end)
+		{
+			CPPUNIT_ASSERT_EQUAL(start, interval.start());
+			CPPUNIT_ASSERT_EQUAL(end, interval.end());
+		}
+
+	public:
+		void testEmptyCell()
+		{
+			CPPUNIT_ASSERT(OpjColumnData::isEmptyCell(empty()));
+			CPPUNIT_ASSERT(OpjColumnData::isEmptyCell(-empty()));
+			CPPUNIT_ASSERT(!OpjColumnData::isEmptyCell(0.0));
+			CPPUNIT_ASSERT(!OpjColumnData::isEmptyCell(1e-200));
+			CPPUNIT_ASSERT(!OpjColumnData::isEmptyCell(-3.5));
+		}
+
+		void testNoEmptyCells()
+		{
+			QVector<double> cells;
+			cells << 1 << 0 << -2;
+			OpjColumnData data(cells, 3);
+			CPPUNIT_ASSERT(data.values() == cells);
+			CPPUNIT_ASSERT(data.emptyRows().isEmpty());
+		}
+
+		void testEmptyCells()
+		{
+			// empty cells at the start, in runs in the middle and at the end, plus rows without cells
+			QVector<double> cells;
+			cells << empty() << 1 << empty() << empty() << 2 << empty() << 3 << empty();
+			OpjColumnData data(cells, 10);
+			double expected[] = {0, 1, 0, 0, 2, 0, 3, 0, 0, 0};
+			CPPUNIT_ASSERT_EQUAL(10, data.values().size());
+			for (int i=0; i<10; i++)
+				CPPUNIT_ASSERT_EQUAL(expected[i], data.values().at(i));
+			const QList< Interval<int> > &empty_rows = data.emptyRows();
+			CPPUNIT_ASSERT_EQUAL(4, empty_rows.size());
+			checkInterval(empty_rows.at(0), 0, 0);
+			checkInterval(empty_rows.at(1), 2, 3);
+			checkInterval(empty_rows.at(2), 5, 5);
+			// the trailing empty cell merges with the rows without cells
+			checkInterval(empty_rows.at(3), 7, 9);
+		}
+
+		void testMoreCellsThanRows()
+		{
+			QVector<double> cells;
+			cells << 1 << empty() << empty() << 4;
+			OpjColumnData data(cells, 2);
+			CPPUNIT_ASSERT_EQUAL(2, data.values().size());
+			CPPUNIT_ASSERT_EQUAL(1.0, data.values().at(0));
+			CPPUNIT_ASSERT_EQUAL(1, data.emptyRows().size());
+			checkInterval(data.emptyRows().at(0), 1, 1);
+
+			OpjColumnData full(cells, 3);
+			CPPUNIT_ASSERT_EQUAL(1, full.emptyRows().size());
+			checkInterval(full.emptyRows().at(0), 1, 2);
+		}
+
+		void testNoCells()
+		{
+			OpjColumnData data(QVector<double>(), 4);
+			CPPUNIT_ASSERT(data.values() == QVector<double>(4, 0.0));
+			CPPUNIT_ASSERT_EQUAL(1, data.emptyRows().size());
+			checkInterval(data.emptyRows().at(0), 0, 3);
+
+			OpjColumnData none(QVector<double>(), 0);
+			CPPUNIT_ASSERT(none.values().isEmpty());
+			CPPUNIT_ASSERT(none.emptyRows().isEmpty());
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( OpjColumnDataTest );
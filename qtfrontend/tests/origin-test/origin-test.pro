@@ -0,0 +1,23 @@
+TEMPLATE = app
+TARGET = origin-test
+CONFIG += debug console exceptions
+QT -= gui
+DEPENDPATH += . .. ../../origin ../../3rdparty/liborigin ../../../backend ../../../backend/lib
+INCLUDEPATH += . .. ../../origin ../../3rdparty/liborigin ../../../backend ../../../backend/lib
+unix:LIBS += -lcppunit
+
+# units used
+HEADERS += \
+			  OPJFile.h \
+			  OpjColumnData.h \
+			  Interval.h \
+
+SOURCES += \
+			  OPJFile.cpp \
+			  OpjColumnData.cpp \
+
+# test cases
+SOURCES += main.cpp \
+	OPJReaderTest.cpp \
+	OpjColumnDataTest.cpp \
+
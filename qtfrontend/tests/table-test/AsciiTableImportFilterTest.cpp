@@ -0,0 +1,294 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "table/AsciiTableImportFilter.h"
+#include "table/Table.h"
+#include "core/column/Column.h"
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QDateTime>
+#include <QLocale>
+
+class AsciiTableImportFilterTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(AsciiTableImportFilterTest);
+		CPPUNIT_TEST(testNumbers);
+		CPPUNIT_TEST(testSeparator);
+		CPPUNIT_TEST(testHeader);
+		CPPUNIT_TEST(testTypeDetection);
+		CPPUNIT_TEST(testLateMismatch);
+		CPPUNIT_TEST(testQuotedFields);
+		CPPUNIT_TEST(testRaggedRows);
+		CPPUNIT_TEST(testWhitespace);
+		CPPUNIT_TEST(testLineEndings);
+		CPPUNIT_TEST(testEmptyInput);
+		CPPUNIT_TEST(testChunks);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		AsciiTableImportFilter *m_filter;
+		Table *m_table;
+
+		//! Import 'data' with m_filter into m_table
+		void import(const QByteArray &data)
+		{
+			delete m_table;
+			QByteArray copy = data;
+			QBuffer buffer(&copy);
+			buffer.open(QIODevice::ReadOnly);
+			m_table = static_cast<Table *>(m_filter->importAspect(&buffer));
+			CPPUNIT_ASSERT(m_table);
+		}
+
+		void checkColumn(int index, const QString &name, SciDAVis::ColumnMode mode)
+		{
+			Column *column = m_table->column(index);
+			CPPUNIT_ASSERT(column);
+			CPPUNIT_ASSERT(column->name() == name);
+			CPPUNIT_ASSERT_EQUAL(mode, column->columnMode());
+		}
+
+		void checkValue(int column, int row, double value)
+		{
+			CPPUNIT_ASSERT(!m_table->column(column)->isInvalid(row));
+			CPPUNIT_ASSERT_EQUAL(value, m_table->column(column)->valueAt(row));
+		}
+
+		void checkText(int column, int row, const QString &text)
+		{
+			CPPUNIT_ASSERT(m_table->column(column)->textAt(row) == text);
+		}
+
+	public:
+		void setUp()
+		{
+			// the number parser uses the decimal point of the default locale
+			QLocale::setDefault(QLocale::c());
+			m_filter = new AsciiTableImportFilter();
+			m_table = 0;
+		}
+
+		void tearDown()
+		{
+			delete m_table;
+			delete m_filter;
+		}
+
+		void testNumbers()
+		{
+			import("x\ty\n1\t2.5\n-2\t-3e2\n+0.125\t1E-3\n12345678901234567890\t.5\n");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->columnCount());
+			CPPUNIT_ASSERT_EQUAL(4, m_table->rowCount());
+			checkColumn(0, "x", SciDAVis::Numeric);
+			checkColumn(1, "y", SciDAVis::Numeric);
+			CPPUNIT_ASSERT_EQUAL(SciDAVis::X, m_table->column(0)->plotDesignation());
+			CPPUNIT_ASSERT_EQUAL(SciDAVis::Y, m_table->column(1)->plotDesignation());
+			checkValue(0, 0, 1);
+			checkValue(1, 0, 2.5);
+			checkValue(0, 1, -2);
+			checkValue(1, 1, -300);
+			checkValue(0, 2, 0.125);
+			checkValue(1, 2, 0.001);
+			// too many digits for the fast path
+			checkValue(0, 3, 12345678901234567890.0);
+			checkValue(1, 3, 0.5);
+		}
+
+		void testSeparator()
+		{
+			CPPUNIT_ASSERT(m_filter->separator() == "\\t");
+			m_filter->set_separator(",");
+			import("a,b,c\n1,2,3\n");
+			CPPUNIT_ASSERT_EQUAL(3, m_table->columnCount());
+			checkColumn(2, "c", SciDAVis::Numeric);
+			checkValue(2, 0, 3);
+
+			// tabs are no separators now
+			import("a\tb,c\n1\t2,3\n");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->columnCount());
+			checkColumn(0, "a\tb", SciDAVis::Text);
+			checkText(0, 0, "1\t2");
+			checkValue(1, 0, 3);
+
+			// separators of several characters
+			m_filter->set_separator(" | ");
+			import("a | b\n1 | 2|3\n");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->columnCount());
+			checkValue(0, 0, 1);
+			checkText(1, 0, "2|3");
+
+			m_filter->set_separator("\\t");
+			CPPUNIT_ASSERT(m_filter->separator() == "\\t");
+			import("a\tb\n1\t2\n");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->columnCount());
+		}
+
+		void testHeader()
+		{
+			m_filter->set_first_row_names_columns(false);
+			import("1\t2\n3\t4\n");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->rowCount());
+			checkColumn(0, "1", SciDAVis::Numeric);
+			checkColumn(1, "2", SciDAVis::Numeric);
+			checkValue(0, 0, 1);
+			checkValue(1, 1, 4);
+
+			// ignored lines come before the column names
+			m_filter->set_first_row_names_columns(true);
+			m_filter->set_ignored_lines(2);
+			import("comment\n\nx\ty\n5\t6\n");
+			CPPUNIT_ASSERT_EQUAL(1, m_table->rowCount());
+			checkColumn(0, "x", SciDAVis::Numeric);
+			checkValue(1, 0, 6);
+		}
+
+		void testTypeDetection()
+		{
+			import("n\td\tt\n1\t2008-01-02T03:04:05\tfoo\n\t2008-12-31 23:59:00\t2\n3\t\tbar\n");
+			CPPUNIT_ASSERT_EQUAL(3, m_table->rowCount());
+			checkColumn(0, "n", SciDAVis::Numeric);
+			checkColumn(1, "d", SciDAVis::DateTime);
+			checkColumn(2, "t", SciDAVis::Text);
+			// blank cells are invalid, but don't change the type
+			CPPUNIT_ASSERT(m_table->column(0)->isInvalid(1));
+			checkValue(0, 2, 3);
+			CPPUNIT_ASSERT(m_table->column(1)->dateTimeAt(0) == QDateTime(QDate(2008, 1, 2), QTime(3, 4, 5)));
+			CPPUNIT_ASSERT(m_table->column(1)->dateTimeAt(1) == QDateTime(QDate(2008, 12, 31), QTime(23, 59)));
+			CPPUNIT_ASSERT(m_table->column(1)->isInvalid(2));
+			checkText(2, 1, "2");
+
+			m_filter->set_detect_types(false);
+			import("n\td\n1\t2008-01-02\n");
+			checkColumn(0, "n", SciDAVis::Text);
+			checkColumn(1, "d", SciDAVis::Text);
+			checkText(0, 0, "1");
+		}
+
+		void testLateMismatch()
+		{
+			// a cell beyond the sample used for type detection makes its column text, keeping all cells
+			QByteArray data("a\tb\n");
+			for (int i=0; i<5000; i++)
+				data += QByteArray::number(i) + "\t" + (i == 4000 ? QByteArray("x") : QByteArray::number(2*i)) + "\n";
+			import(data);
+			CPPUNIT_ASSERT_EQUAL(5000, m_table->rowCount());
+			checkColumn(0, "a", SciDAVis::Numeric);
+			checkColumn(1, "b", SciDAVis::Text);
+			checkValue(0, 4999, 4999);
+			checkText(1, 3999, "7998");
+			checkText(1, 4000, "x");
+			checkText(1, 4999, "9998");
+		}
+
+		void testQuotedFields()
+		{
+			// like the filter it replaces, this one doesn't treat quotes specially: quoted cells are
+			// kept as they are, and separators within quotes still split cells
+			m_filter->set_separator(",");
+			import("\"name\",\"value\"\n\"a\",\"1.5\"\n\"b, c\",2\n");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->columnCount());
+			checkColumn(0, "\"name\"", SciDAVis::Text);
+			checkColumn(1, "\"value\"", SciDAVis::Text);
+			checkText(0, 0, "\"a\"");
+			checkText(1, 0, "\"1.5\"");
+			checkText(0, 1, "\"b");
+			checkText(1, 1, " c\"");
+		}
+
+		void testRaggedRows()
+		{
+			// missing cells are invalid, surplus cells are dropped
+			import("a\tb\tc\n1\t2\t3\n4\n5\t6\t7\t8\n\n9\t10\n");
+			CPPUNIT_ASSERT_EQUAL(3, m_table->columnCount());
+			CPPUNIT_ASSERT_EQUAL(5, m_table->rowCount());
+			for (int c=0; c<3; c++)
+				checkColumn(c, QString(QChar('a' + c)), SciDAVis::Numeric);
+			checkValue(0, 1, 4);
+			CPPUNIT_ASSERT(m_table->column(1)->isInvalid(1));
+			CPPUNIT_ASSERT(m_table->column(2)->isInvalid(1));
+			checkValue(2, 2, 7);
+			for (int c=0; c<3; c++)
+				CPPUNIT_ASSERT(m_table->column(c)->isInvalid(3));
+			checkValue(1, 4, 10);
+			CPPUNIT_ASSERT(m_table->column(2)->isInvalid(4));
+
+			// the same for text columns
+			import("a\tb\nfoo\n\tbar\n");
+			checkColumn(0, "a", SciDAVis::Text);
+			checkColumn(1, "b", SciDAVis::Text);
+			CPPUNIT_ASSERT(m_table->column(1)->isInvalid(0));
+			checkText(1, 0, "");
+			checkText(1, 1, "bar");
+		}
+
+		void testWhitespace()
+		{
+			m_filter->set_separator(" ");
+			m_filter->set_simplify_whitespace(true);
+			import("  x   y \n 1    2\n\t3 \t 4  \n");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->columnCount());
+			CPPUNIT_ASSERT_EQUAL(2, m_table->rowCount());
+			checkColumn(0, "x", SciDAVis::Numeric);
+			checkValue(0, 1, 3);
+			checkValue(1, 1, 4);
+
+			m_filter->set_simplify_whitespace(false);
+			m_filter->set_separator(",");
+			m_filter->set_trim_whitespace(true);
+			import(" x , y \n foo bar , 2 \n");
+			checkColumn(0, "x ", SciDAVis::Text);
+			checkText(0, 0, "foo bar ");
+			checkValue(1, 0, 2);
+		}
+
+		void testLineEndings()
+		{
+			// UTF-8 byte order mark, CRLF line breaks and no line break at the end
+			import("\xEF\xBB\xBFx\ty\r\n1\t2\r\n3\t4");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->rowCount());
+			checkColumn(0, "x", SciDAVis::Numeric);
+			checkColumn(1, "y", SciDAVis::Numeric);
+			checkValue(1, 0, 2);
+			checkValue(1, 1, 4);
+		}
+
+		void testEmptyInput()
+		{
+			import("");
+			CPPUNIT_ASSERT_EQUAL(0, m_table->rowCount());
+
+			import("x\ty\n");
+			CPPUNIT_ASSERT_EQUAL(2, m_table->columnCount());
+			CPPUNIT_ASSERT_EQUAL(0, m_table->rowCount());
+			checkColumn(1, "y", SciDAVis::Numeric);
+
+			m_filter->set_ignored_lines(5);
+			import("x\ty\n1\t2\n");
+			CPPUNIT_ASSERT_EQUAL(0, m_table->rowCount());
+		}
+
+		void testChunks()
+		{
+			// more than one chunk; rows and invalid cells have to line up across chunk borders
+			QByteArray data("a\tb\n");
+			int rows = 1000000;
+			for (int i=0; i<rows; i++)
+				data += QByteArray::number(i) + (i % 1000 == 999 ? QByteArray("\n") : "\t" + QByteArray::number(i % 7) + "\n");
+			CPPUNIT_ASSERT(data.size() > (8 << 20));
+			import(data);
+			CPPUNIT_ASSERT_EQUAL(rows, m_table->rowCount());
+			checkColumn(0, "a", SciDAVis::Numeric);
+			checkColumn(1, "b", SciDAVis::Numeric);
+			Column *a = m_table->column(0), *b = m_table->column(1);
+			for (int i=0; i<rows; i++) {
+				CPPUNIT_ASSERT_EQUAL(double(i), a->valueAt(i));
+				if (i % 1000 == 999)
+					CPPUNIT_ASSERT(b->isInvalid(i));
+				else {
+					CPPUNIT_ASSERT(!b->isInvalid(i));
+					CPPUNIT_ASSERT_EQUAL(double(i % 7), b->valueAt(i));
+				}
+			}
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( AsciiTableImportFilterTest );
@@ -0,0 +1,341 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "table/ColumnStatistics.h"
+#include "core/column/Column.h"
+#include "lib/ValueSpan.h"
+
+#include <QVector>
+#include <QList>
+
+#include <math.h>
+#include <stdlib.h>
+
+//! Statistics of a set of values computed with two passes in long double precision
+struct TwoPassStatistics
+{
+	TwoPassStatistics(const QVector<double>& values, int first_row = 0)
+		: count(0), min_row(-1), max_row(-1)
+	{
+		long double sum = 0;
+		foreach(double value, values)
+			if (value == value)
+			{
+				count++;
+				sum += value;
+			}
+		mean = count > 0 ? double(sum / count) : NAN;
+		long double m2 = 0, m3 = 0, m4 = 0;
+		for (int i=0; i<values.size(); i++)
+		{
+			double value = values.at(i);
+			if (value != value) continue;
+			long double delta = (long double)value - sum / count;
+			m2 += delta*delta;
+			m3 += delta*delta*delta;
+			m4 += delta*delta*delta*delta;
+			if (min_row < 0 || value < values.at(min_row - first_row)) min_row = first_row + i;
+			if (max_row < 0 || value > values.at(max_row - first_row)) max_row = first_row + i;
+		}
+		variance = count > 1 ? double(m2 / (count - 1)) : NAN;
+		skewness = double(sqrtl(count) * m3 / powl(m2, 1.5L));
+		kurtosis = double(count * m4 / (m2*m2) - 3);
+	}
+
+	int count;
+	double mean, variance, skewness, kurtosis;
+	int min_row, max_row;
+};
+
+class ColumnStatisticsTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(ColumnStatisticsTest);
+		CPPUNIT_TEST(testAdd);
+		CPPUNIT_TEST(testMerge);
+		CPPUNIT_TEST(testMergeEmpty);
+		CPPUNIT_TEST(testColumn);
+		CPPUNIT_TEST(testChangedBlocks);
+		CPPUNIT_TEST(testChangeLogOverflow);
+		CPPUNIT_TEST(testSpanChecksums);
+		CPPUNIT_TEST(testSeveralColumns);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		static const int ROWS = 10*ColumnStatistics::BlockSize + 100;
+
+		static QVector<double> randomValues(int count, double offset)
+		{
+			QVector<double> values(count);
+			for (int i=0; i<count; i++)
+			{
+				// skewed distribution, so the third and fourth moments are not trivial
+				double x = (rand() + 1.0) / (RAND_MAX + 2.0);
+				values[i] = offset - log(x) * 3.0;
+			}
+			return values;
+		}
+
+		static void checkClose(double expected, double actual, double tolerance)
+		{
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, actual, tolerance * (1 + fabs(expected)));
+		}
+
+		void check(const TwoPassStatistics& expected, const StatisticsAccumulator& actual, double tolerance = 1e-10)
+		{
+			CPPUNIT_ASSERT_EQUAL(expected.count, actual.count());
+			checkClose(expected.mean, actual.mean(), tolerance);
+			checkClose(expected.variance, actual.variance(), tolerance);
+			checkClose(expected.skewness, actual.skewness(), 1e3*tolerance);
+			checkClose(expected.kurtosis, actual.kurtosis(), 1e3*tolerance);
+			CPPUNIT_ASSERT_EQUAL(expected.min_row, actual.minimumRow());
+			CPPUNIT_ASSERT_EQUAL(expected.max_row, actual.maximumRow());
+		}
+
+		//! Check the statistics of 'column' against the two-pass reference
+		void checkColumn(const ColumnStatistics& statistics, const Column * column)
+		{
+			QVector<double> values(column->rowCount());
+			for (int row=0; row<values.size(); row++)
+				values[row] = column->isInvalid(row) ? NAN : column->valueAt(row);
+			check(TwoPassStatistics(values), statistics.result());
+		}
+
+	public:
+		void setUp()
+		{
+			srand(1);
+		}
+
+		void testAdd()
+		{
+			QVector<double> values = randomValues(10000, 1e6);
+			StatisticsAccumulator accumulator;
+			for (int i=0; i<values.size(); i++)
+				accumulator.add(values.at(i), i);
+			check(TwoPassStatistics(values), accumulator, 1e-8);
+			CPPUNIT_ASSERT_EQUAL(0, accumulator.firstRow());
+			CPPUNIT_ASSERT_EQUAL(values.size()-1, accumulator.lastRow());
+		}
+
+		void testMerge()
+		{
+			// parts of very different sizes, with a large offset against cancellation
+			QVector<double> values = randomValues(50000, 1e8);
+			int splits[] = {0, 1, 2, 17, 1000, 1001, 30000, 49999, 50000};
+			QList<StatisticsAccumulator> parts;
+			for (int k=0; k+1<9; k++)
+			{
+				StatisticsAccumulator part;
+				for (int i=splits[k]; i<splits[k+1]; i++)
+					part.add(values.at(i), i);
+				parts << part;
+			}
+
+			// merge from the left, from the right and pairwise
+			StatisticsAccumulator left, right;
+			for (int k=0; k<parts.size(); k++)
+				left.merge(parts.at(k));
+			for (int k=parts.size()-1; k>=0; k--)
+				right.merge(parts.at(k));
+			QList<StatisticsAccumulator> level = parts;
+			while (level.size() > 1)
+			{
+				QList<StatisticsAccumulator> next;
+				for (int k=0; k<level.size(); k+=2)
+				{
+					StatisticsAccumulator pair = level.at(k);
+					if (k+1 < level.size())
+						pair.merge(level.at(k+1));
+					next << pair;
+				}
+				level = next;
+			}
+
+			TwoPassStatistics expected(values);
+			check(expected, left, 1e-8);
+			check(expected, right, 1e-8);
+			check(expected, level.at(0), 1e-8);
+			CPPUNIT_ASSERT_EQUAL(0, right.firstRow());
+			CPPUNIT_ASSERT_EQUAL(49999, right.lastRow());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(left.sum(), right.sum(), 1e-6*fabs(left.sum()));
+		}
+
+		void testMergeEmpty()
+		{
+			StatisticsAccumulator empty, single, accumulator;
+			accumulator.merge(empty);
+			CPPUNIT_ASSERT(accumulator.isEmpty());
+			CPPUNIT_ASSERT(isnan(accumulator.mean()));
+			CPPUNIT_ASSERT_EQUAL(-1, accumulator.minimumRow());
+
+			single.add(5.0, 7);
+			accumulator.merge(single);
+			accumulator.merge(empty);
+			CPPUNIT_ASSERT_EQUAL(1, accumulator.count());
+			CPPUNIT_ASSERT_EQUAL(5.0, accumulator.mean());
+			CPPUNIT_ASSERT(isnan(accumulator.variance()));
+			CPPUNIT_ASSERT_EQUAL(7, accumulator.minimumRow());
+			CPPUNIT_ASSERT_EQUAL(7, accumulator.maximumRow());
+
+			// equal extrema: the first row wins regardless of the merge order
+			StatisticsAccumulator later;
+			later.add(5.0, 3);
+			accumulator.merge(later);
+			CPPUNIT_ASSERT_EQUAL(3, accumulator.minimumRow());
+			CPPUNIT_ASSERT_EQUAL(3, accumulator.maximumRow());
+			CPPUNIT_ASSERT_EQUAL(0.0, accumulator.variance());
+		}
+
+		void testColumn()
+		{
+			QVector<double> values = randomValues(ROWS, 1000);
+			values[5] = NAN;
+			Column column("column", values);
+			column.setInvalid(Interval<int>(100, 5000));
+			ColumnStatistics statistics;
+			statistics.update(&column);
+			checkColumn(statistics, &column);
+			CPPUNIT_ASSERT_EQUAL(ROWS - 4901 - 1, statistics.result().count());
+
+			// empty and missing columns
+			Column empty("empty", QVector<double>());
+			statistics.update(&empty);
+			CPPUNIT_ASSERT(statistics.result().isEmpty());
+			statistics.update((const AbstractColumn *)0);
+			CPPUNIT_ASSERT(statistics.result().isEmpty());
+		}
+
+		void testChangedBlocks()
+		{
+			const int B = ColumnStatistics::BlockSize;
+			Column column("column", randomValues(ROWS, 10));
+			ColumnStatistics statistics;
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(11, statistics.recomputedBlocks());
+
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(0, statistics.recomputedBlocks());
+
+			column.setValueAt(3*B + 17, -50);
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(1, statistics.recomputedBlocks());
+			checkColumn(statistics, &column);
+			CPPUNIT_ASSERT_EQUAL(3*B + 17, statistics.result().minimumRow());
+
+			// rows across three blocks
+			column.replaceValues(2*B - 1, randomValues(B + 2, 20));
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(3, statistics.recomputedBlocks());
+			checkColumn(statistics, &column);
+
+			column.setInvalid(Interval<int>(7*B, 7*B + 9));
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(1, statistics.recomputedBlocks());
+			checkColumn(statistics, &column);
+
+			// setting a value it already had is caught by the checksum
+			column.setValueAt(5*B, column.valueAt(5*B));
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(0, statistics.recomputedBlocks());
+
+			// appending touches the last block and adds one
+			column.replaceValues(ROWS, randomValues(B, 10));
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(2, statistics.recomputedBlocks());
+			checkColumn(statistics, &column);
+
+			// removing a row moves all following rows
+			column.removeRows(4*B + 3, 1);
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(8, statistics.recomputedBlocks());
+			checkColumn(statistics, &column);
+
+			// another column is checked through the checksums
+			Column copy("copy", QVector<double>());
+			copy.copy(&column);
+			statistics.update(&copy);
+			CPPUNIT_ASSERT_EQUAL(0, statistics.recomputedBlocks());
+			checkColumn(statistics, &copy);
+		}
+
+		void testChangeLogOverflow()
+		{
+			const int B = ColumnStatistics::BlockSize;
+			Column column("column", randomValues(ROWS, 10));
+			ColumnStatistics statistics;
+			statistics.update(&column);
+
+			// more changes than the column keeps track of
+			for (int k=0; k<200; k++)
+				column.setValueAt(6*B + k, k);
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(1, statistics.recomputedBlocks());
+			checkColumn(statistics, &column);
+
+			statistics.invalidate();
+			statistics.update(&column);
+			CPPUNIT_ASSERT_EQUAL(11, statistics.recomputedBlocks());
+			checkColumn(statistics, &column);
+		}
+
+		void testSpanChecksums()
+		{
+			const int B = ColumnStatistics::BlockSize;
+			QVector<double> values = randomValues(ROWS, 0);
+			ColumnStatistics statistics;
+			statistics.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(11, statistics.recomputedBlocks());
+			check(TwoPassStatistics(values), statistics.result());
+
+			values[9*B + 1] = 1e6;
+			values[B] = NAN;
+			statistics.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(2, statistics.recomputedBlocks());
+			check(TwoPassStatistics(values), statistics.result());
+			CPPUNIT_ASSERT_EQUAL(9*B + 1, statistics.result().maximumRow());
+
+			QList< Interval<int> > invalid;
+			invalid << Interval<int>(4*B + 5, 4*B + 5);
+			ValueSpan span(0, values);
+			span.setInvalid(invalid);
+			statistics.update(span);
+			CPPUNIT_ASSERT_EQUAL(1, statistics.recomputedBlocks());
+			values[4*B + 5] = NAN;
+			check(TwoPassStatistics(values), statistics.result());
+
+			// a span starting elsewhere starts over
+			QVector<double> tail(values.size() - 100);
+			for (int i=0; i<tail.size(); i++)
+				tail[i] = values.at(100 + i);
+			statistics.update(ValueSpan(100, tail));
+			CPPUNIT_ASSERT_EQUAL(10, statistics.recomputedBlocks());
+			check(TwoPassStatistics(tail, 100), statistics.result());
+		}
+
+		void testSeveralColumns()
+		{
+			QList<Column *> columns;
+			QList<const AbstractColumn *> sources;
+			QList<ColumnStatistics *> statistics;
+			for (int i=0; i<5; i++)
+			{
+				columns << new Column(QString("c%1").arg(i), randomValues(ROWS/(i+1), i*100));
+				sources << columns.last();
+				statistics << new ColumnStatistics();
+			}
+			ColumnStatistics::update(statistics, sources);
+			for (int i=0; i<5; i++)
+				checkColumn(*statistics.at(i), columns.at(i));
+
+			columns.at(2)->setValueAt(10, 1e5);
+			ColumnStatistics::update(statistics, sources);
+			for (int i=0; i<5; i++)
+			{
+				CPPUNIT_ASSERT_EQUAL(i == 2 ? 1 : 0, statistics.at(i)->recomputedBlocks());
+				checkColumn(*statistics.at(i), columns.at(i));
+			}
+			qDeleteAll(statistics);
+			qDeleteAll(columns);
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ColumnStatisticsTest );
+
@@ -0,0 +1,378 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "assertion_traits.h"
+
+#include "table/FormulaEvaluator.h"
+#include "table/Table.h"
+#include "core/Project.h"
+#include "core/MyParser.h"
+#include "core/column/Column.h"
+
+#include <QtGlobal>
+#include <QLocale>
+#include <QUndoStack>
+#include <QStringList>
+#include <QDateTime>
+
+#include <math.h>
+
+//! More rows than one evaluation chunk (see FormulaEvaluator.cpp), so several threads are used
+static const int ROWS = 3*4096 + 17;
+
+class FormulaEvaluatorTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(FormulaEvaluatorTest);
+		CPPUNIT_TEST(testColumnReferences);
+		CPPUNIT_TEST(testTableReferences);
+		CPPUNIT_TEST(testErrors);
+		CPPUNIT_TEST(testSerialEvaluation);
+		CPPUNIT_TEST(testInvalidRows);
+		CPPUNIT_TEST(testMissingRows);
+		CPPUNIT_TEST(testApplyValues);
+		CPPUNIT_TEST(testApplyTexts);
+		CPPUNIT_TEST(testApplyDateTimes);
+		CPPUNIT_TEST_SUITE_END();
+
+	public:
+		void setUp()
+		{
+			QVector<double> a(ROWS), b(ROWS), short_values(ROWS/2), x(10);
+			for (int i=0; i<ROWS; i++)
+			{
+				a[i] = i*0.25 - 100;
+				b[i] = cos(i*0.01)*1000;
+			}
+			for (int i=0; i<short_values.size(); i++)
+				short_values[i] = i;
+			for (int i=0; i<x.size(); i++)
+				x[i] = i*i;
+
+			prj = new Project();
+			prj->setName("project");
+			table = new Table(0, 0, 0, "table1");
+			prj->addChild(table);
+			column_a = new Column("A", a);
+			column_b = new Column("B", b);
+			column_short = new Column("Short", short_values);
+			column_result = new Column("Result", QVector<double>(ROWS, 0.0));
+			table->addChild(column_a);
+			table->addChild(column_b);
+			table->addChild(column_short);
+			table->addChild(column_result);
+
+			other = new Table(0, 0, 0, "data");
+			prj->addChild(other);
+			column_x = new Column("X", x);
+			other->addChild(column_x);
+			prj->undoStack()->clear();
+		}
+
+		void tearDown()
+		{
+			delete prj;
+		}
+
+	private:
+		Project *prj;
+		Table *table, *other;
+		Column *column_a, *column_b, *column_short, *column_result, *column_x;
+
+		bool compiles(const QString& formula, const AbstractColumn *first, const AbstractColumn *second = 0)
+		{
+			FormulaEvaluator evaluator(table);
+			if (!evaluator.compile(formula))
+				return false;
+			QList<const AbstractColumn *> expected;
+			expected << first;
+			if (second) expected << second;
+			return evaluator.columns() == expected;
+		}
+
+		//! Evaluate "sin(col(A))^2 + i*col(B) - sqrt(abs(col(A)))" row by row with one parser
+		QVector<double> serialEvaluation(int first, int last)
+		{
+			MyParser parser;
+			double a, b, row_number;
+			parser.DefineVar("a", &a);
+			parser.DefineVar("b", &b);
+			parser.DefineVar("i", &row_number);
+			parser.SetExpr("sin(a)^2 + i*b - sqrt(abs(a))");
+			QVector<double> result;
+			for (int row=first; row<=last; row++)
+			{
+				a = column_a->valueAt(row);
+				b = column_b->valueAt(row);
+				row_number = row + 1;
+				result << parser.Eval();
+			}
+			return result;
+		}
+
+		//! Check that 'invalid_rows' are exactly the rows for which 'expected' is true
+		template<class Predicate> void checkInvalid(const QList< Interval<int> >& invalid_rows, Interval<int> rows, Predicate expected)
+		{
+			QVector<bool> invalid(rows.end() - rows.start() + 1, false);
+			foreach(Interval<int> i, invalid_rows)
+			{
+				CPPUNIT_ASSERT(rows.contains(i));
+				for (int row=i.start(); row<=i.end(); row++)
+					invalid[row - rows.start()] = true;
+			}
+			for (int row=rows.start(); row<=rows.end(); row++)
+				CPPUNIT_ASSERT_EQUAL(expected(row), bool(invalid.at(row - rows.start())));
+		}
+
+		struct AboveShortColumn
+		{
+			bool operator()(int row) const { return row >= ROWS/2; }
+		};
+		struct InvalidInB
+		{
+			bool operator()(int row) const { return (row >= 10 && row <= 19) || row == 5000 || row == ROWS-1; }
+		};
+
+	public:
+		void testColumnReferences()
+		{
+			CPPUNIT_ASSERT(compiles("col(\"A\")", column_a));
+			CPPUNIT_ASSERT(compiles("col(A)", column_a));
+			CPPUNIT_ASSERT(compiles("col(2)", column_b));
+			CPPUNIT_ASSERT(compiles("col( 4 )", column_result));
+			CPPUNIT_ASSERT(compiles("col(A) + col(\"B\")*2", column_a, column_b));
+			// several references to one column share a variable
+			CPPUNIT_ASSERT(compiles("col(B) - col(2) + col(\"B\")", column_b));
+			CPPUNIT_ASSERT(compiles("col(1)*sin(col(\"Short\")) + i", column_a, column_short));
+			// a column named like a number wins over the column number
+			column_short->setName("1");
+			CPPUNIT_ASSERT(compiles("col(1)", column_short));
+			CPPUNIT_ASSERT(compiles("col(\"1\")", column_short));
+
+			FormulaEvaluator evaluator(table);
+			CPPUNIT_ASSERT(evaluator.compile("col(A) + col(2)/col(\"A\")"));
+			CPPUNIT_ASSERT(evaluator.isCompiled());
+			CPPUNIT_ASSERT_EQUAL(QString("_col0 + _col1/_col0"), evaluator.expression());
+			// string literals are not scanned for references
+			CPPUNIT_ASSERT(!evaluator.compile("col(A) + \"col(B)\""));
+			CPPUNIT_ASSERT(!evaluator.isCompiled());
+		}
+
+		void testTableReferences()
+		{
+			CPPUNIT_ASSERT(compiles("tablecol(\"data\", \"X\")", column_x));
+			CPPUNIT_ASSERT(compiles("tablecol(\"data\", X)", column_x));
+			CPPUNIT_ASSERT(compiles("tablecol(\"data\", 1)", column_x));
+			CPPUNIT_ASSERT(compiles("tablecol(\"table1\", 2)", column_b));
+			CPPUNIT_ASSERT(compiles("col(B) + tablecol(\"table1\", \"B\")", column_b));
+			CPPUNIT_ASSERT(compiles("col(A)*tablecol(\"data\", \"X\")", column_a, column_x));
+
+			FormulaEvaluator evaluator(table);
+			QVector<double> values;
+			QList< Interval<int> > invalid_rows;
+			CPPUNIT_ASSERT(evaluator.compile("tablecol(\"data\", \"X\") + col(A)"));
+			evaluator.evaluate(Interval<int>(0, 19), &values, &invalid_rows);
+			CPPUNIT_ASSERT_EQUAL(20, values.size());
+			for (int row=0; row<10; row++)
+				CPPUNIT_ASSERT_EQUAL(row*row + column_a->valueAt(row), values.at(row));
+			// the other table has only 10 rows
+			CPPUNIT_ASSERT_EQUAL(1, invalid_rows.size());
+			CPPUNIT_ASSERT(invalid_rows.at(0) == Interval<int>(10, 19));
+		}
+
+		void testErrors()
+		{
+			const char * formulas[] = {
+				"",
+				"  ",
+				"col(\"missing\")",
+				"col(missing)",
+				"col(0)",
+				"col(5)",
+				"col()",
+				"col(A, 2)",
+				"col(\"A\"",
+				"tablecol(\"missing\", \"X\")",
+				"tablecol(data, \"X\")",
+				"tablecol(\"data\", \"A\")",
+				"tablecol(\"data\", 2)",
+				"tablecol(\"data\")",
+				"col(A) +",
+				"unknown(col(A))",
+				"col(A) + y",
+			};
+			FormulaEvaluator evaluator(table);
+			for (unsigned k=0; k<sizeof(formulas)/sizeof(formulas[0]); k++)
+			{
+				CPPUNIT_ASSERT(!evaluator.compile(formulas[k]));
+				CPPUNIT_ASSERT(!evaluator.isCompiled());
+				CPPUNIT_ASSERT(!evaluator.errorMessage().isEmpty());
+			}
+
+			// nothing is evaluated or written after a failed compile()
+			QVector<double> values(3, 1.0);
+			evaluator.evaluate(Interval<int>(0, 9), &values);
+			CPPUNIT_ASSERT(values.isEmpty());
+			evaluator.apply(column_result, Interval<int>(0, 9));
+			CPPUNIT_ASSERT_EQUAL(0, prj->undoStack()->count());
+
+			CPPUNIT_ASSERT(evaluator.compile("col(A)"));
+			CPPUNIT_ASSERT(evaluator.errorMessage().isEmpty());
+		}
+
+		void testSerialEvaluation()
+		{
+			FormulaEvaluator evaluator(table);
+			CPPUNIT_ASSERT(evaluator.compile("sin(col(A))^2 + i*col(\"B\") - sqrt(abs(col(1)))"));
+
+			Interval<int> ranges[] = {
+				Interval<int>(0, ROWS-1),
+				Interval<int>(0, 0),
+				Interval<int>(4095, 4097),
+				Interval<int>(123, ROWS-500),
+			};
+			for (int r=0; r<4; r++)
+			{
+				QVector<double> values;
+				QList< Interval<int> > invalid_rows;
+				evaluator.evaluate(ranges[r], &values, &invalid_rows);
+				QVector<double> expected = serialEvaluation(ranges[r].start(), ranges[r].end());
+				CPPUNIT_ASSERT_EQUAL(expected.size(), values.size());
+				for (int k=0; k<values.size(); k++)
+					CPPUNIT_ASSERT_EQUAL(expected.at(k), values.at(k));
+				CPPUNIT_ASSERT(invalid_rows.isEmpty());
+			}
+		}
+
+		void testInvalidRows()
+		{
+			column_b->setInvalid(Interval<int>(10, 19));
+			column_b->setInvalid(5000);
+			column_b->setInvalid(ROWS-1);
+
+			FormulaEvaluator evaluator(table);
+			CPPUNIT_ASSERT(evaluator.compile("col(A) + col(B)"));
+			QVector<double> values;
+			QList< Interval<int> > invalid_rows;
+			Interval<int> rows(0, ROWS-1);
+			evaluator.evaluate(rows, &values, &invalid_rows);
+			checkInvalid(invalid_rows, rows, InvalidInB());
+			for (int row=0; row<ROWS; row++)
+				if (InvalidInB()(row))
+					CPPUNIT_ASSERT(isnan(values.at(row)));
+				else
+					CPPUNIT_ASSERT_EQUAL(column_a->valueAt(row) + column_b->valueAt(row), values.at(row));
+
+			// rows which don't reference the invalid cells are fine
+			CPPUNIT_ASSERT(evaluator.compile("col(A)*2"));
+			evaluator.evaluate(rows, &values, &invalid_rows);
+			CPPUNIT_ASSERT(invalid_rows.isEmpty());
+		}
+
+		void testMissingRows()
+		{
+			FormulaEvaluator evaluator(table);
+			CPPUNIT_ASSERT(evaluator.compile("col(A) - col(Short)"));
+			QVector<double> values;
+			QList< Interval<int> > invalid_rows;
+			Interval<int> rows(0, ROWS-1);
+			evaluator.evaluate(rows, &values, &invalid_rows);
+			CPPUNIT_ASSERT_EQUAL(ROWS, values.size());
+			checkInvalid(invalid_rows, rows, AboveShortColumn());
+			for (int row=0; row<ROWS/2; row++)
+				CPPUNIT_ASSERT_EQUAL(column_a->valueAt(row) - row, values.at(row));
+
+			// rows beyond the end of all columns
+			CPPUNIT_ASSERT(evaluator.compile("col(A) + i"));
+			evaluator.evaluate(Interval<int>(ROWS-2, ROWS+5), &values, &invalid_rows);
+			CPPUNIT_ASSERT_EQUAL(8, values.size());
+			CPPUNIT_ASSERT_EQUAL(column_a->valueAt(ROWS-1) + ROWS, values.at(1));
+			CPPUNIT_ASSERT_EQUAL(1, invalid_rows.size());
+			CPPUNIT_ASSERT(invalid_rows.at(0) == Interval<int>(ROWS, ROWS+5));
+
+			// a formula without references works for every row
+			CPPUNIT_ASSERT(evaluator.compile("2*i"));
+			evaluator.evaluate(Interval<int>(ROWS, ROWS+9), &values, &invalid_rows);
+			CPPUNIT_ASSERT(invalid_rows.isEmpty());
+			CPPUNIT_ASSERT_EQUAL(2.0*(ROWS+1), values.at(0));
+		}
+
+		void testApplyValues()
+		{
+			column_b->setInvalid(Interval<int>(10, 19));
+			prj->undoStack()->clear();
+
+			FormulaEvaluator evaluator(table);
+			CPPUNIT_ASSERT(evaluator.compile("col(B) - col(A)"));
+			evaluator.apply(column_result, Interval<int>(5, ROWS-1));
+			CPPUNIT_ASSERT_EQUAL(1, prj->undoStack()->count());
+			CPPUNIT_ASSERT_EQUAL(ROWS, column_result->rowCount());
+			for (int row=0; row<5; row++)
+				CPPUNIT_ASSERT_EQUAL(0.0, column_result->valueAt(row));
+			for (int row=5; row<ROWS; row++)
+			{
+				bool invalid = row >= 10 && row <= 19;
+				CPPUNIT_ASSERT_EQUAL(invalid, column_result->isInvalid(row));
+				if (!invalid)
+					CPPUNIT_ASSERT_EQUAL(column_b->valueAt(row) - column_a->valueAt(row), column_result->valueAt(row));
+			}
+
+			prj->undoStack()->undo();
+			CPPUNIT_ASSERT_EQUAL(ROWS, column_result->rowCount());
+			CPPUNIT_ASSERT(column_result->invalidIntervals().isEmpty());
+			for (int row=0; row<ROWS; row++)
+				CPPUNIT_ASSERT_EQUAL(0.0, column_result->valueAt(row));
+		}
+
+		void testApplyTexts()
+		{
+			QStringList texts;
+			for (int row=0; row<100; row++)
+				texts << "text";
+			Column *column = new Column("Text", texts);
+			table->addChild(column);
+			prj->undoStack()->clear();
+
+			FormulaEvaluator evaluator(table);
+			CPPUNIT_ASSERT(evaluator.compile("col(Short)/4"));
+			evaluator.apply(column, Interval<int>(0, ROWS-1));
+			CPPUNIT_ASSERT_EQUAL(1, prj->undoStack()->count());
+			CPPUNIT_ASSERT_EQUAL(ROWS, column->rowCount());
+			QLocale locale;
+			for (int row=0; row<ROWS; row++)
+				if (row < ROWS/2)
+				{
+					CPPUNIT_ASSERT(!column->isInvalid(row));
+					CPPUNIT_ASSERT_EQUAL(locale.toString(row/4.0, 'g', 14), column->textAt(row));
+				}
+				else
+					CPPUNIT_ASSERT(column->isInvalid(row));
+
+			prj->undoStack()->undo();
+			CPPUNIT_ASSERT_EQUAL(100, column->rowCount());
+			CPPUNIT_ASSERT(column->invalidIntervals().isEmpty());
+			CPPUNIT_ASSERT_EQUAL(QString("text"), column->textAt(99));
+		}
+
+		void testApplyDateTimes()
+		{
+			QList<QDateTime> dates;
+			for (int row=0; row<20; row++)
+				dates << QDateTime(QDate(2000, 1, 1), QTime(0, 0));
+			Column *column = new Column("Date", dates);
+			table->addChild(column);
+			prj->undoStack()->clear();
+
+			// Julian day 2451545 is 2000-01-01, the fraction is added to noon
+			FormulaEvaluator evaluator(table);
+			CPPUNIT_ASSERT(evaluator.compile("2451545 + i + 0.25"));
+			evaluator.apply(column, Interval<int>(0, 9));
+			CPPUNIT_ASSERT_EQUAL(1, prj->undoStack()->count());
+			CPPUNIT_ASSERT_EQUAL(20, column->rowCount());
+			for (int row=0; row<10; row++)
+				CPPUNIT_ASSERT(QDateTime(QDate(2000, 1, 2 + row), QTime(18, 0)) == column->dateTimeAt(row));
+			CPPUNIT_ASSERT(QDateTime(QDate(2000, 1, 1), QTime(0, 0)) == column->dateTimeAt(10));
+
+			prj->undoStack()->undo();
+			CPPUNIT_ASSERT(QDateTime(QDate(2000, 1, 1), QTime(0, 0)) == column->dateTimeAt(0));
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( FormulaEvaluatorTest );
+
@@ -0,0 +1,287 @@
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "table/Histogram.h"
+#include "table/Table.h"
+#include "core/column/Column.h"
+#include "lib/ValueSpan.h"
+
+#include <QVector>
+
+#include <math.h>
+#include <stdlib.h>
+
+class HistogramTest : public CppUnit::TestFixture {
+		CPPUNIT_TEST_SUITE(HistogramTest);
+		CPPUNIT_TEST(testUserBins);
+		CPPUNIT_TEST(testTinyUserBins);
+		CPPUNIT_TEST(testFreedmanDiaconis);
+		CPPUNIT_TEST(testInvalidRows);
+		CPPUNIT_TEST(testResultTable);
+		CPPUNIT_TEST(testRebin);
+		CPPUNIT_TEST(testAppend);
+		CPPUNIT_TEST(testChangeAndRemove);
+		CPPUNIT_TEST_SUITE_END();
+
+	private:
+		static QVector<double> randomValues(int count)
+		{
+			QVector<double> values(count);
+			for (int i=0; i<count; i++)
+				values[i] = (rand() % 100000)/1000.0 - 20;
+			return values;
+		}
+
+		//! Check the counts of 'histogram' against counting 'values' into its bins one by one
+		void checkCounts(const Histogram &histogram, const QVector<double> &values)
+		{
+			QVector<int> expected(histogram.binCount(), 0);
+			int valid = 0;
+			foreach(double value, values) {
+				if (value != value)
+					continue;
+				valid++;
+				double bin = floor((value - histogram.begin())/histogram.binSize());
+				if (bin >= 0 && bin < histogram.binCount())
+					expected[int(bin)]++;
+			}
+			CPPUNIT_ASSERT_EQUAL(valid, histogram.valueCount());
+			for (int i=0; i<histogram.binCount(); i++)
+				CPPUNIT_ASSERT_EQUAL(expected.at(i), histogram.count(i));
+		}
+
+		//! Check that 'histogram' equals a histogram binning 'values' from scratch
+		void checkFresh(const Histogram &histogram, const QVector<double> &values)
+		{
+			Histogram fresh;
+			if (histogram.binningRule() == Histogram::UserBins)
+				fresh.setBins(histogram.begin(), histogram.end() - histogram.binSize(), histogram.binSize());
+			else
+				fresh.setBinningRule(histogram.binningRule());
+			fresh.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(fresh.begin(), histogram.begin());
+			CPPUNIT_ASSERT_EQUAL(fresh.binSize(), histogram.binSize());
+			CPPUNIT_ASSERT(fresh.counts() == histogram.counts());
+			CPPUNIT_ASSERT_EQUAL(fresh.valueCount(), histogram.valueCount());
+			CPPUNIT_ASSERT_EQUAL(fresh.minimum(), histogram.minimum());
+			CPPUNIT_ASSERT_EQUAL(fresh.maximum(), histogram.maximum());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(fresh.mean(), histogram.mean(), 1e-9);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(fresh.standardDeviation(), histogram.standardDeviation(), 1e-9);
+		}
+
+	public:
+		void setUp()
+		{
+			srand(1);
+		}
+
+		void testUserBins()
+		{
+			double data[] = {0.5, 1.5, 1.7, 2.0, 9.99, -1, 11, 1.0};
+			QVector<double> values;
+			for (unsigned i=0; i<sizeof(data)/sizeof(double); i++)
+				values << data[i];
+
+			Histogram histogram;
+			histogram.setBins(0, 9, 1);
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(10, histogram.binCount());
+			CPPUNIT_ASSERT_EQUAL(0.0, histogram.begin());
+			CPPUNIT_ASSERT_EQUAL(10.0, histogram.end());
+			int expected[] = {1, 3, 1, 0, 0, 0, 0, 0, 0, 1};
+			for (int i=0; i<10; i++)
+				CPPUNIT_ASSERT_EQUAL(expected[i], histogram.count(i));
+			// values outside of the bins still count for the statistics
+			CPPUNIT_ASSERT_EQUAL(8, histogram.valueCount());
+			CPPUNIT_ASSERT_EQUAL(-1.0, histogram.minimum());
+			CPPUNIT_ASSERT_EQUAL(11.0, histogram.maximum());
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(26.69/8, histogram.mean(), 1e-12);
+		}
+
+		void testTinyUserBins()
+		{
+			QVector<double> values;
+			values << 0.5 << 1e300;
+			Histogram histogram;
+			// more bins than fit into an int
+			histogram.setBins(0, 1, 1e-12);
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(1000000, histogram.binCount());
+			CPPUNIT_ASSERT_EQUAL(2, histogram.valueCount());
+			histogram.setBins(0, 1e300, 1e-300);
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(1000000, histogram.binCount());
+		}
+
+		void testFreedmanDiaconis()
+		{
+			// 0..999: IQR 500, 2*500/1000^(1/3) = 100
+			QVector<double> values(1000);
+			for (int i=0; i<1000; i++)
+				values[i] = 999 - i;
+			Histogram histogram;
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(Histogram::FreedmanDiaconis, histogram.binningRule());
+			CPPUNIT_ASSERT_EQUAL(100.0, histogram.binSize());
+			CPPUNIT_ASSERT_EQUAL(0.0, histogram.begin());
+			CPPUNIT_ASSERT_EQUAL(10, histogram.binCount());
+			for (int i=0; i<10; i++)
+				CPPUNIT_ASSERT_EQUAL(100, histogram.count(i));
+
+			// more than 75% equal values: IQR 0, falls back to Scott's rule
+			values.fill(5.0);
+			values[0] = 0;
+			values[1] = 10;
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT(histogram.binSize() > 0);
+			checkCounts(histogram, values);
+
+			// random values across several partial histograms
+			values = randomValues(300000);
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT(histogram.binCount() > 1);
+			checkCounts(histogram, values);
+		}
+
+		void testInvalidRows()
+		{
+			QVector<double> values = randomValues(1000);
+			QList< Interval<int> > invalid;
+			invalid << Interval<int>(10, 19) << Interval<int>(500, 500);
+			ValueSpan span(0, values);
+			span.setInvalid(invalid);
+			for (int i=10; i<20; i++)
+				values[i] = NAN;
+			values[500] = NAN;
+
+			Histogram histogram;
+			histogram.update(span);
+			CPPUNIT_ASSERT_EQUAL(989, histogram.valueCount());
+			checkCounts(histogram, values);
+		}
+
+		void testResultTable()
+		{
+			double data[] = {0.5, 1.5, 1.7, 3.2, 3.9, 3.1, 0.1, 2.5};
+			QVector<double> values;
+			for (unsigned i=0; i<sizeof(data)/sizeof(double); i++)
+				values << data[i];
+			Histogram histogram;
+			histogram.setBins(0, 3, 1);
+			histogram.update(ValueSpan(0, values));
+
+			Table *table = histogram.resultTable("bins");
+			CPPUNIT_ASSERT_EQUAL(4, table->columnCount());
+			Column *bins = table->column(0), *quantity = table->column(1), *sum = table->column(2),
+				*percent = table->column(3);
+			CPPUNIT_ASSERT_EQUAL(4, bins->rowCount());
+			double expected_quantity[] = {2, 2, 1, 3};
+			double expected_sum[] = {2, 4, 5, 8};
+			for (int i=0; i<4; i++) {
+				CPPUNIT_ASSERT_EQUAL(double(i), bins->valueAt(i));
+				CPPUNIT_ASSERT_EQUAL(expected_quantity[i], quantity->valueAt(i));
+				CPPUNIT_ASSERT_EQUAL(expected_sum[i], sum->valueAt(i));
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(expected_sum[i]/8*100, percent->valueAt(i), 1e-12);
+			}
+			CPPUNIT_ASSERT_EQUAL(100.0, percent->valueAt(3));
+			delete table;
+
+			// values outside of the bins don't count for the percentages
+			values << -5 << 20;
+			histogram.update(ValueSpan(0, values));
+			table = histogram.resultTable("bins");
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(25.0, table->column(3)->valueAt(0), 1e-12);
+			CPPUNIT_ASSERT_EQUAL(100.0, table->column(3)->valueAt(3));
+			delete table;
+		}
+
+		void testRebin()
+		{
+			QVector<double> values = randomValues(100000);
+			Histogram histogram;
+			histogram.setBins(-20, 80, 10);
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(11, histogram.binCount());
+			checkCounts(histogram, values);
+
+			// changing the bins forgets the cached values
+			histogram.setBins(0, 50, 2.5);
+			CPPUNIT_ASSERT_EQUAL(0, histogram.binCount());
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(21, histogram.binCount());
+			CPPUNIT_ASSERT_EQUAL(2.5, histogram.binSize());
+			checkCounts(histogram, values);
+
+			Histogram::BinningRule rules[] = {Histogram::Sturges, Histogram::Scott, Histogram::FreedmanDiaconis};
+			for (int r=0; r<3; r++) {
+				histogram.setBinningRule(rules[r]);
+				histogram.update(ValueSpan(0, values));
+				checkCounts(histogram, values);
+				checkFresh(histogram, values);
+			}
+			// Sturges: ceil(log2(100000))+1 = 18 bins of 100/18 before rounding
+			histogram.setBinningRule(Histogram::Sturges);
+			histogram.update(ValueSpan(0, values));
+			CPPUNIT_ASSERT_EQUAL(5.0, histogram.binSize());
+		}
+
+		void testAppend()
+		{
+			QVector<double> values = randomValues(200000);
+			Histogram user, automatic;
+			user.setBins(-10, 70, 0.5);
+			user.update(ValueSpan(0, values));
+			automatic.update(ValueSpan(0, values));
+			double size = automatic.binSize();
+
+			// a few appended rows are moved into the existing bins
+			values += randomValues(1000);
+			user.update(ValueSpan(0, values));
+			automatic.update(ValueSpan(0, values));
+			checkFresh(user, values);
+			checkCounts(automatic, values);
+			CPPUNIT_ASSERT_EQUAL(size, automatic.binSize());
+
+			// values beyond the range widen the bins
+			values << 1000.0 << -1000.0;
+			user.update(ValueSpan(0, values));
+			automatic.update(ValueSpan(0, values));
+			checkFresh(user, values);
+			checkFresh(automatic, values);
+			CPPUNIT_ASSERT_EQUAL(-1000.0, automatic.minimum());
+			CPPUNIT_ASSERT(automatic.begin() <= -1000.0);
+			CPPUNIT_ASSERT(automatic.end() > 1000.0);
+
+			// appending many rows at once bins everything again
+			values += randomValues(150000);
+			user.update(ValueSpan(0, values));
+			automatic.update(ValueSpan(0, values));
+			checkFresh(user, values);
+			checkFresh(automatic, values);
+		}
+
+		void testChangeAndRemove()
+		{
+			QVector<double> values = randomValues(100000);
+			Histogram histogram;
+			histogram.setBins(-20, 80, 1);
+			histogram.update(ValueSpan(0, values));
+
+			for (int k=0; k<100; k++)
+				values[rand() % values.size()] = (rand() % 100000)/1000.0 - 20;
+			histogram.update(ValueSpan(0, values));
+			checkFresh(histogram, values);
+
+			// removing the minimum recomputes the range
+			int min_row = 0;
+			for (int i=1; i<values.size(); i++)
+				if (values.at(i) < values.at(min_row))
+					min_row = i;
+			values[min_row] = values.last();
+			values.resize(values.size() - 500);
+			histogram.update(ValueSpan(0, values));
+			checkFresh(histogram, values);
+		}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( HistogramTest );
+
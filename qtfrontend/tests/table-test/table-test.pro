@@ -1,11 +1,11 @@
 TEMPLATE = app
 TARGET = table-test
-CONFIG += debug
+CONFIG += debug exceptions
 QT += xml network
 DEFINES += SUPPRESS_SCRIPTING_INIT
-DEPENDPATH += . ../.. ../../lib ../../core ../../core/datatypes ../../core/filters ../../core/column ../../table ..
-INCLUDEPATH += . ../.. ../../lib ../../core ../../core/datatypes ../../core/filters ../../core/column ../../table ..
-unix:LIBS += -lcppunit
+DEPENDPATH += . ../.. ../../lib ../../core ../../core/datatypes ../../core/filters ../../core/column ../../table .. ../../../backend ../../../backend/core ../../../backend/core/column ../../../backend/core/datatypes ../../../backend/core/filters ../../../backend/lib ../../../backend/table
+INCLUDEPATH += . ../.. ../../lib ../../core ../../core/datatypes ../../core/filters ../../core/column ../../table .. ../../../backend ../../../backend/core ../../../backend/core/column ../../../backend/core/datatypes ../../../backend/core/filters ../../../backend/lib ../../../backend/table
+unix:LIBS += -lcppunit -lmuparser -lgsl -lgslcblas
 QMAKE_CXX = distcc
 
 RESOURCES += \
@@ -27,6 +27,8 @@ HEADERS += \
 			  ColumnPrivate.h \
 			  columncommands.h \
 			  IntervalAttribute.h \
+			  ValueSpan.h \
+			  ParallelFor.h \
 			  AbstractFilter.h \
 			  AbstractSimpleFilter.h \
 			  SimpleCopyThroughFilter.h \
@@ -46,6 +48,11 @@ HEADERS += \
 			  TableItemDelegate.h \
 			  TableModel.h \
 			  Table.h \
+			  RowSorter.h \
+			  Histogram.h \
+			  ColumnStatistics.h \
+			  FormulaEvaluator.h \
+			  MyParser.h \
 			  tablecommands.h \
 			  assertion_traits.h\
 			  AbstractScriptingEngine.h \
@@ -67,9 +74,15 @@ HEADERS += \
 			  ShortcutsDialog.h \
 			  ConfigPageWidget.h \
 			  XmlStreamReader.h \
+			  ProjectArchive.h \
+			  PageCache.h \
+			  PagedDoubleData.h \
+			  UndoPayload.h \
 			  ProjectConfigPage.h \
 			  ScriptingEngineManager.h \
 			  ImportDialog.h \
+			  AbstractImportFilter.h \
+			  AsciiTableImportFilter.h \
 			  ExtensibleFileDialog.h \
 
 
@@ -85,6 +98,11 @@ SOURCES += \
 			  TableView.cpp \
 			  TableItemDelegate.cpp \
 			  Table.cpp \
+			  RowSorter.cpp \
+			  Histogram.cpp \
+			  ColumnStatistics.cpp \
+			  FormulaEvaluator.cpp \
+			  MyParser.cpp \
 			  tablecommands.cpp \
 			  TableModel.cpp \
 			  AbstractScriptingEngine.cpp \
@@ -101,6 +119,7 @@ SOURCES += \
 			  String2DateTimeFilter.cpp \
 			  Double2StringFilter.cpp \
 			  AbstractSimpleFilter.cpp \
+			  AbstractColumn.cpp \
 			  AbstractPart.cpp \
 			  PartMdiView.cpp \
 			  ShortcutsDialogModel.cpp \
@@ -109,14 +128,23 @@ SOURCES += \
 			  ShortcutsDialog.cpp \
 			  ConfigPageWidget.cpp \
 			  XmlStreamReader.cpp \
+			  ProjectArchive.cpp \
+			  PageCache.cpp \
+			  PagedDoubleData.cpp \
+			  UndoPayload.cpp \
 			  ProjectConfigPage.cpp \
 			  ScriptingEngineManager.cpp \
 			  ImportDialog.cpp \
+			  AsciiTableImportFilter.cpp \
 			  ExtensibleFileDialog.cpp \
 
 
 SOURCES += main.cpp \
 	TableTest.cpp \
+	HistogramTest.cpp \
+	FormulaEvaluatorTest.cpp \
+	ColumnStatisticsTest.cpp \
+	AsciiTableImportFilterTest.cpp \
 	
 
 
@@ -2,4 +2,11 @@ TEMPLATE = subdirs
 
 SUBDIRS = aspect-test \
 		   column-test \
+		   column-bench \
+		   fft-bench \
+		   fft-test \
+		   fit-test \
+		   graph-test \
+		   matrix-test \
+		   origin-test \
 		   table-test